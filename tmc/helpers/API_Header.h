@@ -8,12 +8,50 @@
 #ifndef TMC_API_HEADER_H_
 #define TMC_API_HEADER_H_
 
+#include "Features.h"
 #include "Config.h"
 #include "Macros.h"
 #include "Constants.h"
 #include "Bits.h"
 #include "CRC.h"
+#include "Async.h"
+#include "Sequence.h"
+#include "ByteOrder.h"
+#include "FixedMath.h"
+#include "BufferPool.h"
+#include "Transfer.h"
+#include "RampProfile.h"
+#include "UnitConversion.h"
 #include "RegisterAccess.h"
+#include "RegisterDescriptor.h"
+#include "WriteOrder.h"
+#include "Lock.h"
+#include "RegisterDriver.h"
+#include "RegisterImage.h"
+#include "Scheduler.h"
+#include "BusPlan.h"
+#include "ICInterface.h"
+#include "Enumeration.h"
+#include "ConfigEngine.h"
+#include "CommandQueue.h"
+#include "Snapshot.h"
+#include "LoadStream.h"
+#include "TelemetryExport.h"
+#include "Homing.h"
+#include "CoolStepTune.h"
+#include "ChopperPlan.h"
+#include "CurrentProfile.h"
+#include "ThermalDerating.h"
+#include "AdcTelemetry.h"
+#include "ConfigProfile.h"
+#include "HostProtocol.h"
+#include "RegisterLog.h"
+#include "RegisterView.h"
+#include "UART.h"
+#include "SPI.h"
+#include "FaultReaction.h"
+#include "Instrumentation.h"
+#include "ResetState.h"
 #include <stdlib.h>
 #include "Types.h"
 
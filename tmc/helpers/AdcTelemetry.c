@@ -0,0 +1,77 @@
+/*
+ * AdcTelemetry.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "AdcTelemetry.h"
+
+void tmc_adcTelemetry_init(TMCAdcTelemetryTypeDef *adc)
+{
+	tmc_snapshot_init(&adc->snapshot);
+	adc->tick            = 0;
+	adc->interval        = 0;
+	adc->supplyMin       = 0;
+	adc->supplyMax       = 0;
+	adc->temperatureMax  = 0;
+	adc->events          = 0;
+	adc->callback        = NULL;
+}
+
+void tmc_adcTelemetry_setLimits(TMCAdcTelemetryTypeDef *adc, int32_t supplyMin, int32_t supplyMax, int32_t temperatureMax)
+{
+	adc->supplyMin       = supplyMin;
+	adc->supplyMax       = supplyMax;
+	adc->temperatureMax  = temperatureMax;
+}
+
+// Convert the raw 13 bit ADC fields
+void tmc_adcTelemetry_decode(uint16_t supply, uint16_t ain, uint16_t temperature, int32_t *values)
+{
+	values[TMC_ADC_SUPPLY]       = ((uint32_t) supply * TMC_ADC_SUPPLY_FACTOR) >> 16;
+	values[TMC_ADC_AIN]          = ((uint32_t) ain * TMC_ADC_AIN_FACTOR) >> 16;
+	values[TMC_ADC_TEMPERATURE]  = ((int64_t) ((int32_t) temperature - TMC_ADC_TEMPERATURE_OFFSET) * TMC_ADC_TEMPERATURE_FACTOR) / 65536;
+}
+
+bool tmc_adcTelemetry_due(TMCAdcTelemetryTypeDef *adc, uint32_t tick)
+{
+	return adc->interval && ((tick - adc->tick) >= adc->interval);
+}
+
+// Event [flag] with hysteresis: set above [limit], cleared below limit - hysteresis
+static uint8_t limitEvent(uint8_t events, uint8_t flag, int32_t value, int32_t limit, int32_t hysteresis)
+{
+	if(limit == 0)
+		return 0;
+
+	if(value > limit)
+		return flag;
+
+	if(value > limit - hysteresis)
+		return events & flag;
+
+	return 0;
+}
+
+void tmc_adcTelemetry_update(TMCAdcTelemetryTypeDef *adc, void *ic, uint16_t supply, uint16_t ain, uint16_t temperature, uint32_t tick)
+{
+	int32_t values[TMC_ADC_VALUE_COUNT];
+	uint8_t events;
+
+	tmc_adcTelemetry_decode(supply, ain, temperature, values);
+	tmc_snapshot_publish(&adc->snapshot, values, TMC_ADC_VALUE_COUNT, tick);
+	adc->tick = tick;
+
+	// The undervoltage check is mirrored to use the same hysteresis helper
+	events = limitEvent(adc->events, TMC_ADC_EVENT_UNDERVOLTAGE, -values[TMC_ADC_SUPPLY], -adc->supplyMin, TMC_ADC_SUPPLY_HYSTERESIS)
+	       | limitEvent(adc->events, TMC_ADC_EVENT_OVERVOLTAGE, values[TMC_ADC_SUPPLY], adc->supplyMax, TMC_ADC_SUPPLY_HYSTERESIS)
+	       | limitEvent(adc->events, TMC_ADC_EVENT_OVERTEMPERATURE, values[TMC_ADC_TEMPERATURE], adc->temperatureMax, TMC_ADC_TEMPERATURE_HYSTERESIS);
+
+	if(events != adc->events)
+	{
+		adc->events = events;
+		if(adc->callback)
+			adc->callback(ic, events, values);
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ * AdcTelemetry.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Decoded ADC telemetry of the TMC2240/TMC5240 (ADC_VSUPPLY_AIN, ADC_TEMP).
+ *
+ *  The periodic job of the IC reads both ADC registers every [interval] ticks,
+ *  converts them with fixed-point factors and publishes the values in a
+ *  snapshot (Snapshot.h). Consumers read the snapshot, e.g. with
+ *  tmc2240_readAdc(), without any bus access.
+ *
+ *  Optional limits raise events for derating: Whenever the set of active
+ *  events changes, the callback is called with the new set and the values.
+ *  An event clears once its value is back inside the limit by the hysteresis.
+ *
+ *  Conversions (datasheet):
+ *    VS   [mV]       = ADC_VSUPPLY * 9.732
+ *    AIN  [mV]       = ADC_AIN * 0.3052
+ *    Temp [0.01 °C]  = (ADC_TEMP - 2038) * 100 / 7.7
+ */
+
+#ifndef TMC_HELPERS_ADCTELEMETRY_H_
+#define TMC_HELPERS_ADCTELEMETRY_H_
+
+#include "Types.h"
+#include "Snapshot.h"
+
+// Conversion factors in 16.16 fixed point
+#define TMC_ADC_SUPPLY_FACTOR       637796  // 9.732 mV per LSB
+#define TMC_ADC_AIN_FACTOR          20001   // 0.3052 mV per LSB
+#define TMC_ADC_TEMPERATURE_FACTOR  851118  // 100 / 7.7 centi-°C per LSB
+#define TMC_ADC_TEMPERATURE_OFFSET  2038
+
+// Hysteresis of the limit events
+#define TMC_ADC_SUPPLY_HYSTERESIS       250  // mV
+#define TMC_ADC_TEMPERATURE_HYSTERESIS  500  // centi-°C
+
+typedef enum {
+	TMC_ADC_SUPPLY,       // mV
+	TMC_ADC_AIN,          // mV
+	TMC_ADC_TEMPERATURE,  // centi-°C
+	TMC_ADC_VALUE_COUNT
+} TMCAdcValue;
+
+// Limit events
+#define TMC_ADC_EVENT_UNDERVOLTAGE     0x01
+#define TMC_ADC_EVENT_OVERVOLTAGE      0x02
+#define TMC_ADC_EVENT_OVERTEMPERATURE  0x04
+
+// Called by the periodic job with the IC, the active events and the converted values
+typedef void (*tmc_adc_callback)(void *ic, uint8_t events, const int32_t *values);
+
+typedef struct
+{
+	TMCSnapshot snapshot;      // TMC_ADC_VALUE_COUNT values
+	uint32_t tick;             // Tick of the last capture
+	uint16_t interval;         // Ticks between captures, 0: off
+	int32_t supplyMin;         // Limits, 0: off
+	int32_t supplyMax;
+	int32_t temperatureMax;
+	uint8_t events;            // Active limit events
+	tmc_adc_callback callback;
+} TMCAdcTelemetryTypeDef;
+
+void tmc_adcTelemetry_init(TMCAdcTelemetryTypeDef *adc);
+void tmc_adcTelemetry_setLimits(TMCAdcTelemetryTypeDef *adc, int32_t supplyMin, int32_t supplyMax, int32_t temperatureMax);
+void tmc_adcTelemetry_decode(uint16_t supply, uint16_t ain, uint16_t temperature, int32_t *values);
+
+// Used by the periodic job of the IC
+bool tmc_adcTelemetry_due(TMCAdcTelemetryTypeDef *adc, uint32_t tick);
+void tmc_adcTelemetry_update(TMCAdcTelemetryTypeDef *adc, void *ic, uint16_t supply, uint16_t ain, uint16_t temperature, uint32_t tick);
+
+#endif /* TMC_HELPERS_ADCTELEMETRY_H_ */
@@ -0,0 +1,54 @@
+/*
+ * Async.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "Async.h"
+
+// Prepare a request for a new transfer.
+// Returns NULL if the request is still pending.
+TMCAsyncRequestTypeDef *tmc_asyncStart(TMCAsyncRequestTypeDef *request, void *ic, uint8_t channel, uint8_t address, int32_t value, tmc_async_callback callback, void *userData)
+{
+	if(request->state == TMC_ASYNC_PENDING)
+		return NULL;
+
+	request->state     = TMC_ASYNC_PENDING;
+	request->ic        = ic;
+	request->channel   = channel;
+	request->address   = address;
+	request->value     = value;
+	request->step      = 0;
+	request->callback  = callback;
+	request->userData  = userData;
+
+	return request;
+}
+
+// Mark a request as finished and notify the user
+void tmc_asyncFinish(TMCAsyncRequestTypeDef *request, TMCAsyncState state)
+{
+	request->state = state;
+
+	if(request->callback)
+		request->callback(request);
+
+#ifdef TMC_ASYNC_OS_HOOKS
+	tmc_os_signal(request->channel);
+#endif
+}
+
+// Wait until a started request is finished.
+// Returns the final state of the request.
+TMCAsyncState tmc_asyncWait(TMCAsyncRequestTypeDef *request)
+{
+	while(request->state == TMC_ASYNC_PENDING)
+	{
+#ifdef TMC_ASYNC_OS_HOOKS
+		tmc_os_wait(request->channel);
+#endif
+	}
+
+	return request->state;
+}
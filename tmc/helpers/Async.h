@@ -0,0 +1,77 @@
+/*
+ * Async.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Request handles for the optional non-blocking transport.
+ *
+ *  Drivers supporting it (enabled per IC, e.g. with TMC5160_ASYNC) expect an
+ *  additional tmcXXXX_readWriteArrayAsync() wrapper from the application. That
+ *  wrapper starts the transfer and returns immediately. Once the reply has been
+ *  written back to the data buffer, the application calls complete(context),
+ *  typically from the DMA or SPI/UART interrupt.
+ *
+ *  The request structure is provided by the caller and must stay valid until the
+ *  request is no longer pending. Do not access an IC with the blocking functions
+ *  while one of its requests is pending.
+ *
+ *  A task that needs the result before continuing calls tmc_asyncWait() after
+ *  starting the request. With TMC_ASYNC_OS_HOOKS, the task sleeps in tmc_os_wait()
+ *  until tmc_asyncFinish() calls tmc_os_signal() from the completion interrupt,
+ *  e.g. using a binary semaphore per channel. The CPU is free for other tasks
+ *  for the duration of the transfer, about 1ms for a UART read at 115200 baud.
+ *  Without the hooks, tmc_asyncWait() spins on the request state.
+ */
+
+#ifndef TMC_HELPERS_ASYNC_H_
+#define TMC_HELPERS_ASYNC_H_
+
+#include "Types.h"
+
+// Uncomment to let tmc_asyncWait() block on tmc_os_wait() instead of spinning
+//#define TMC_ASYNC_OS_HOOKS
+
+#ifdef TMC_ASYNC_OS_HOOKS
+// => OS wrapper
+// Block the calling task until tmc_os_signal() is called for [channel].
+// Returning early is allowed, the request state is checked again.
+extern void tmc_os_wait(uint8_t channel);
+// Wake the task waiting on [channel]. Called from the completion context (interrupt).
+extern void tmc_os_signal(uint8_t channel);
+// <= OS wrapper
+#endif
+
+typedef enum {
+	TMC_ASYNC_IDLE,     // Request not started yet
+	TMC_ASYNC_PENDING,  // Transfer(s) in progress
+	TMC_ASYNC_DONE,     // Finished, value is valid
+	TMC_ASYNC_ERROR     // Finished, reply was invalid
+} TMCAsyncState;
+
+typedef struct TMCAsyncRequestTypeDef TMCAsyncRequestTypeDef;
+
+// Completion handler passed to the transport wrapper
+typedef void (*tmc_async_complete)(void *context);
+
+// User callback, called once the driver has processed the reply
+typedef void (*tmc_async_callback)(TMCAsyncRequestTypeDef *request);
+
+struct TMCAsyncRequestTypeDef
+{
+	volatile TMCAsyncState state;
+	uint8_t data[12];    // Datagram buffer handed to the transport, fits a UART read with echo
+	uint8_t channel;
+	uint8_t address;
+	uint8_t step;        // Driver internal transfer counter
+	int32_t value;       // Value to write / value read
+	void *ic;            // IC object the request belongs to
+	tmc_async_callback callback;
+	void *userData;
+};
+
+TMCAsyncRequestTypeDef *tmc_asyncStart(TMCAsyncRequestTypeDef *request, void *ic, uint8_t channel, uint8_t address, int32_t value, tmc_async_callback callback, void *userData);
+void tmc_asyncFinish(TMCAsyncRequestTypeDef *request, TMCAsyncState state);
+TMCAsyncState tmc_asyncWait(TMCAsyncRequestTypeDef *request);
+
+#endif /* TMC_HELPERS_ASYNC_H_ */
@@ -0,0 +1,51 @@
+/*
+ * BufferPool.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "BufferPool.h"
+
+// [memory] holds blockCount * TMC_BUFFER_BLOCK_SIZE bytes, see TMC_BUFFER_POOL_MEMORY().
+// [freeList] holds blockCount bytes.
+void tmc_pool_init(TMCBufferPool *pool, uint8_t *memory, uint8_t *freeList, uint8_t blockCount)
+{
+	pool->memory      = memory;
+	pool->freeList    = freeList;
+	pool->blockCount  = blockCount;
+	pool->freeCount   = blockCount;
+
+	for(uint8_t i = 0; i < blockCount; i++)
+		freeList[i] = blockCount - 1 - i;
+}
+
+// Returns NULL if all blocks are in use
+uint8_t *tmc_pool_alloc(TMCBufferPool *pool)
+{
+	uint8_t *block = NULL;
+
+	TMC_BUFFER_POOL_ENTER();
+
+	if(pool->freeCount > 0)
+		block = &pool->memory[(size_t) pool->freeList[--pool->freeCount] * TMC_BUFFER_BLOCK_SIZE];
+
+	TMC_BUFFER_POOL_EXIT();
+
+	return block;
+}
+
+void tmc_pool_free(TMCBufferPool *pool, uint8_t *block)
+{
+	size_t index = (size_t) (block - pool->memory) / TMC_BUFFER_BLOCK_SIZE;
+
+	if(index >= pool->blockCount)
+		return;
+
+	TMC_BUFFER_POOL_ENTER();
+
+	if(pool->freeCount < pool->blockCount)
+		pool->freeList[pool->freeCount++] = index;
+
+	TMC_BUFFER_POOL_EXIT();
+}
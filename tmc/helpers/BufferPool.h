@@ -0,0 +1,74 @@
+/*
+ * BufferPool.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Fixed size block allocator for datagram buffers.
+ *
+ *  DMA engines behind a data cache (e.g. Cortex-M7) can only use buffers that
+ *  start and end on a cache line and lie in DMA reachable memory. Stack arrays
+ *  do not, so the transport would have to copy every frame. A pool hands out
+ *  blocks of TMC_BUFFER_BLOCK_SIZE bytes, aligned to TMC_BUFFER_ALIGNMENT, from
+ *  memory declared with TMC_BUFFER_POOL_MEMORY(). Defining TMC_DMA_SECTION places
+ *  that memory in the given linker section, e.g.
+ *
+ *    #define TMC_DMA_SECTION ".dma_buffer"
+ *
+ *  Allocating and freeing a block is O(1) and does not use the heap.
+ *
+ *  With TMC_TRANSFER_POOL the transfer lists take their datagram buffers from
+ *  tmc_transfer_pool and return them once the list has been executed, see
+ *  tmc/helpers/Transfer.h. A pool shared by tasks or interrupts needs
+ *  TMC_BUFFER_POOL_ENTER()/TMC_BUFFER_POOL_EXIT() to be defined, e.g. to mask
+ *  interrupts.
+ */
+
+#ifndef TMC_HELPERS_BUFFERPOOL_H_
+#define TMC_HELPERS_BUFFERPOOL_H_
+
+#include "Types.h"
+
+// Cache line size of the target
+#ifndef TMC_BUFFER_ALIGNMENT
+#define TMC_BUFFER_ALIGNMENT 32
+#endif
+
+// Size of one block, has to be a multiple of TMC_BUFFER_ALIGNMENT
+#ifndef TMC_BUFFER_BLOCK_SIZE
+#define TMC_BUFFER_BLOCK_SIZE TMC_BUFFER_ALIGNMENT
+#endif
+
+// Maximum amount of blocks in one pool
+#define TMC_BUFFER_POOL_MAX_BLOCKS 255
+
+#ifndef TMC_BUFFER_POOL_ENTER
+#define TMC_BUFFER_POOL_ENTER()
+#define TMC_BUFFER_POOL_EXIT()
+#endif
+
+#ifdef TMC_DMA_SECTION
+#define TMC_DMA_BUFFER __attribute__((section(TMC_DMA_SECTION), aligned(TMC_BUFFER_ALIGNMENT)))
+#else
+#define TMC_DMA_BUFFER __attribute__((aligned(TMC_BUFFER_ALIGNMENT)))
+#endif
+
+// Declare the memory of a pool with [blocks] blocks
+#define TMC_BUFFER_POOL_MEMORY(name, blocks) \
+	uint8_t name[(blocks) * TMC_BUFFER_BLOCK_SIZE] TMC_DMA_BUFFER
+
+typedef struct
+{
+	uint8_t *memory;
+	uint8_t *freeList;   // Stack of free block indices, one byte per block
+	uint8_t blockCount;
+	uint8_t freeCount;
+} TMCBufferPool;
+
+#define tmc_pool_available(pool)  ((pool)->freeCount)
+
+void tmc_pool_init(TMCBufferPool *pool, uint8_t *memory, uint8_t *freeList, uint8_t blockCount);
+uint8_t *tmc_pool_alloc(TMCBufferPool *pool);
+void tmc_pool_free(TMCBufferPool *pool, uint8_t *block);
+
+#endif /* TMC_HELPERS_BUFFERPOOL_H_ */
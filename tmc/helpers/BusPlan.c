@@ -0,0 +1,91 @@
+/*
+ * BusPlan.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "BusPlan.h"
+#include "Macros.h"
+
+#define SPI_DATAGRAM_BITS    40
+#define UART_BITS_PER_BYTE   10
+#define UART_WRITE_BYTES     8
+#define UART_REQUEST_BYTES   4
+#define UART_REPLY_BYTES     8
+
+// Time of [bits] bit times on the bus [ns]
+static uint32_t bitTime(const TMCBusPlanBus *bus, uint32_t bits)
+{
+	if(bus->bitRate == 0)
+		return 0;
+
+	return (uint32_t) (((uint64_t) bits * 1000000000 + bus->bitRate - 1) / bus->bitRate);
+}
+
+// SENDDELAY 0-1: 8 bit times, 2-3: 3*8 bit times, ... 14-15: 15*8 bit times
+static uint32_t sendDelayBits(uint8_t sendDelay)
+{
+	return 8 * ((sendDelay & 0x0F) | 1);
+}
+
+uint32_t tmc_busPlan_writeTime(const TMCBusPlanBus *bus)
+{
+	if(bus->type == TMC_BUS_PLAN_UART)
+		return bitTime(bus, UART_WRITE_BYTES * UART_BITS_PER_BYTE) + bus->overhead;
+
+	return bitTime(bus, SPI_DATAGRAM_BITS) + bus->overhead;
+}
+
+uint32_t tmc_busPlan_readTime(const TMCBusPlanBus *bus, uint8_t count)
+{
+	if(count == 0)
+		return 0;
+
+	if(bus->type == TMC_BUS_PLAN_UART)
+	{
+		uint32_t bits = (UART_REQUEST_BYTES + UART_REPLY_BYTES) * UART_BITS_PER_BYTE + sendDelayBits(bus->sendDelay);
+
+		return count * (bitTime(bus, bits) + bus->overhead);
+	}
+
+	return (count + 1) * (bitTime(bus, SPI_DATAGRAM_BITS) + bus->overhead);
+}
+
+void tmc_busPlan_evaluate(const TMCBusPlanBus *buses, uint8_t busCount, const TMCBusPlanAxis *axes, uint8_t axisCount, TMCBusPlanResult *results)
+{
+	uint8_t i, j;
+
+	for(i = 0; i < busCount; i++)
+	{
+		const TMCBusPlanBus *bus = &buses[i];
+		uint32_t write = tmc_busPlan_writeTime(bus);
+		uint64_t busy = 0;      // Bus time per second [ns]
+		uint64_t loop = 0;      // Bus time of one loop over all axes [ns]
+		uint64_t setpoints = 0;
+		uint32_t longest = write;
+
+		for(j = 0; j < axisCount; j++)
+		{
+			const TMCBusPlanAxis *axis = &axes[j];
+			uint32_t setpoint, telemetry;
+
+			if(axis->bus != i)
+				continue;
+
+			setpoint   = axis->setpointWrites * write;
+			telemetry  = tmc_busPlan_readTime(bus, axis->telemetryReads);
+
+			busy       += (uint64_t) axis->setpointRate * setpoint + (uint64_t) axis->telemetryRate * telemetry;
+			loop       += setpoint + telemetry;
+			setpoints  += setpoint;
+
+			// A telemetry poll is not interrupted, a setpoint may have to wait for it
+			longest = MAX(longest, telemetry);
+		}
+
+		results[i].utilisation      = (uint32_t) MIN(busy / 1000000, UINT32_MAX);
+		results[i].setpointLatency  = (uint32_t) MIN(setpoints + longest, UINT32_MAX);
+		results[i].maxLoopRate      = (loop) ? (uint32_t) (1000000000 / loop) : 0;
+	}
+}
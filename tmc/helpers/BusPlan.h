@@ -0,0 +1,73 @@
+/*
+ * BusPlan.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Bus capacity planning from a machine description.
+ *
+ *  Each bus is described by its type, bit rate and per-transfer overhead (chip
+ *  select gap, host driver latency). For UART buses the SENDDELAY of the slaves
+ *  is also given. Each axis is described by its bus, its setpoint rate and
+ *  writes per setpoint, and its telemetry rate and registers per poll.
+ *  tmc_busPlan_evaluate() computes the following per bus, without hardware:
+ *  - Utilisation in permille. Above 1000 the bus can not keep up.
+ *  - Worst case setpoint latency: The longest transaction already on the bus
+ *    (a locked telemetry poll) plus the setpoints of all axes of the bus. This is the order tmc_scheduler_run()
+ *    serves them in (Scheduler.h).
+ *  - Maximum loop rate: The rate at which every axis of the bus can send one
+ *    setpoint and one telemetry poll per loop.
+ *
+ *  Transfer model:
+ *  - SPI: 40 bit datagrams. A write is one datagram. n registers are read with
+ *    n+1 pipelined datagrams (see tmc_spi_readIntBatch()).
+ *  - UART: 10 bits per byte. A write is an 8 byte datagram. A read is a 4 byte
+ *    request, the SENDDELAY and an 8 byte reply, one register at a time.
+ *
+ *  The model counts bus time only. Compare the results with the histograms of
+ *  Instrumentation.h on the target to calibrate the overhead per transfer.
+ */
+
+#ifndef TMC_HELPERS_BUSPLAN_H_
+#define TMC_HELPERS_BUSPLAN_H_
+
+#include "Types.h"
+
+typedef enum {
+	TMC_BUS_PLAN_SPI,
+	TMC_BUS_PLAN_UART
+} TMCBusPlanType;
+
+typedef struct
+{
+	TMCBusPlanType type;
+	uint32_t bitRate;   // SCK frequency or baud rate [Hz]
+	uint32_t overhead;  // Per transfer [ns]
+	uint8_t sendDelay;  // SENDDELAY of the UART slaves
+} TMCBusPlanBus;
+
+typedef struct
+{
+	uint8_t bus;              // Index into the bus list
+	uint32_t setpointRate;    // [Hz]
+	uint8_t setpointWrites;   // Register writes per setpoint, e.g. 2 for VMAX and XTARGET
+	uint32_t telemetryRate;   // [Hz]
+	uint8_t telemetryReads;   // Registers read per telemetry poll
+} TMCBusPlanAxis;
+
+typedef struct
+{
+	uint32_t utilisation;      // [1/1000]
+	uint32_t setpointLatency;  // Worst case [ns]
+	uint32_t maxLoopRate;      // [Hz], 0: no axis on the bus
+} TMCBusPlanResult;
+
+// Bus time of a single register write and of reading [count] registers [ns]
+uint32_t tmc_busPlan_writeTime(const TMCBusPlanBus *bus);
+uint32_t tmc_busPlan_readTime(const TMCBusPlanBus *bus, uint8_t count);
+
+// Evaluate the machine, [results] holds one entry per bus.
+// Axes with a bus index out of range are ignored.
+void tmc_busPlan_evaluate(const TMCBusPlanBus *buses, uint8_t busCount, const TMCBusPlanAxis *axes, uint8_t axisCount, TMCBusPlanResult *results);
+
+#endif /* TMC_HELPERS_BUSPLAN_H_ */
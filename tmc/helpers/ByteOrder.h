@@ -0,0 +1,54 @@
+/*
+ * ByteOrder.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Conversion of register values to and from the big endian byte order of the
+ *  datagrams. GCC and Clang compile the little endian variant to a single
+ *  unaligned load or store plus a byte reverse (REV on ARM, BSWAP on x86).
+ *  Other compilers fall back to shifting the bytes.
+ */
+
+#ifndef TMC_HELPERS_BYTEORDER_H_
+#define TMC_HELPERS_BYTEORDER_H_
+
+#include "Types.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define TMC_BSWAP32(x) __builtin_bswap32(x)
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define TMC_BSWAP32(x) (x)
+#endif
+
+// Read the big endian 32 bit value starting at [data]
+static inline int32_t tmc_unpackInt32(const uint8_t *data)
+{
+#ifdef TMC_BSWAP32
+	uint32_t value;
+
+	memcpy(&value, data, sizeof(value));
+
+	return TMC_BSWAP32(value);
+#else
+	return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+#endif
+}
+
+// Store [value] big endian starting at [data]
+static inline void tmc_packInt32(uint8_t *data, int32_t value)
+{
+#ifdef TMC_BSWAP32
+	uint32_t swapped = TMC_BSWAP32((uint32_t) value);
+
+	memcpy(data, &swapped, sizeof(swapped));
+#else
+	data[0] = ((uint32_t) value >> 24) & 0xFF;
+	data[1] = ((uint32_t) value >> 16) & 0xFF;
+	data[2] = ((uint32_t) value >> 8) & 0xFF;
+	data[3] = (uint32_t) value & 0xFF;
+#endif
+}
+
+#endif /* TMC_HELPERS_BYTEORDER_H_ */
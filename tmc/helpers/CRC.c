@@ -22,21 +22,181 @@
  *  this algorithm could probably be speed up by preparing a 2- or 4-bit lookup table
  *  to speed up the actual table generation.
  *
- *  (1): For compile-time CRC tables, just fill the table(s) by initializing CRCTables[] to the proper values.
+ *  The CRC engine is selected at compile time in CRC.h, all engines share the same API:
+ *    default                 byte-wise 256 entry lookup table per index
+ *    TMC_CRC8_ENGINE_FLASH   constant lookup table for the Trinamic UART CRC, nothing to initialize
+ *    TMC_CRC8_ENGINE_NIBBLE  two 16 entry lookup tables per index
+ *    TMC_CRC8_ENGINE_SLICE4  four 256 entry lookup tables per index, four bytes per step
+ *
+ *  (1): For compile-time CRC tables, either select TMC_CRC8_ENGINE_FLASH or
+ *       fill the table(s) by initializing CRCTables[] to the proper values.
  *  (2): Tested by toggling a GPIO pin, generating a table in-between and measuring the GPIO pulse width.
  */
 
 #include "CRC.h"
+#include "Macros.h"
+
+static uint8_t flipByte(uint8_t value);
+
+#ifdef TMC_CRC_BACKEND
+static const TMCCRCBackend *backend = NULL;
+
+void tmc_CRC_setBackend(const TMCCRCBackend *crcBackend)
+{
+	backend = crcBackend;
+}
+
+// Return the result of the hardware unit, if it accepts the calculation
+#define CRC8_BACKEND(data, bytes, polynomial, isReflected) \
+	do { \
+		uint8_t hwResult; \
+		if(backend && backend->crc8 && backend->crc8(data, bytes, polynomial, isReflected, &hwResult)) \
+			return hwResult; \
+	} while(0)
+#else
+#define CRC8_BACKEND(data, bytes, polynomial, isReflected)
+#endif
+
+#if defined(TMC_CRC8_ENGINE_FLASH)
+
+// Lookup table for polynomial 0x07, reflected - as generated by tmc_fillCRC8Table(0x07, true, x)
+static const uint8_t CRCTable[256] =
+{
+	0x00, 0x91, 0xE3, 0x72, 0x07, 0x96, 0xE4, 0x75, 0x0E, 0x9F, 0xED, 0x7C, 0x09, 0x98, 0xEA, 0x7B,
+	0x1C, 0x8D, 0xFF, 0x6E, 0x1B, 0x8A, 0xF8, 0x69, 0x12, 0x83, 0xF1, 0x60, 0x15, 0x84, 0xF6, 0x67,
+	0x38, 0xA9, 0xDB, 0x4A, 0x3F, 0xAE, 0xDC, 0x4D, 0x36, 0xA7, 0xD5, 0x44, 0x31, 0xA0, 0xD2, 0x43,
+	0x24, 0xB5, 0xC7, 0x56, 0x23, 0xB2, 0xC0, 0x51, 0x2A, 0xBB, 0xC9, 0x58, 0x2D, 0xBC, 0xCE, 0x5F,
+	0x70, 0xE1, 0x93, 0x02, 0x77, 0xE6, 0x94, 0x05, 0x7E, 0xEF, 0x9D, 0x0C, 0x79, 0xE8, 0x9A, 0x0B,
+	0x6C, 0xFD, 0x8F, 0x1E, 0x6B, 0xFA, 0x88, 0x19, 0x62, 0xF3, 0x81, 0x10, 0x65, 0xF4, 0x86, 0x17,
+	0x48, 0xD9, 0xAB, 0x3A, 0x4F, 0xDE, 0xAC, 0x3D, 0x46, 0xD7, 0xA5, 0x34, 0x41, 0xD0, 0xA2, 0x33,
+	0x54, 0xC5, 0xB7, 0x26, 0x53, 0xC2, 0xB0, 0x21, 0x5A, 0xCB, 0xB9, 0x28, 0x5D, 0xCC, 0xBE, 0x2F,
+	0xE0, 0x71, 0x03, 0x92, 0xE7, 0x76, 0x04, 0x95, 0xEE, 0x7F, 0x0D, 0x9C, 0xE9, 0x78, 0x0A, 0x9B,
+	0xFC, 0x6D, 0x1F, 0x8E, 0xFB, 0x6A, 0x18, 0x89, 0xF2, 0x63, 0x11, 0x80, 0xF5, 0x64, 0x16, 0x87,
+	0xD8, 0x49, 0x3B, 0xAA, 0xDF, 0x4E, 0x3C, 0xAD, 0xD6, 0x47, 0x35, 0xA4, 0xD1, 0x40, 0x32, 0xA3,
+	0xC4, 0x55, 0x27, 0xB6, 0xC3, 0x52, 0x20, 0xB1, 0xCA, 0x5B, 0x29, 0xB8, 0xCD, 0x5C, 0x2E, 0xBF,
+	0x90, 0x01, 0x73, 0xE2, 0x97, 0x06, 0x74, 0xE5, 0x9E, 0x0F, 0x7D, 0xEC, 0x99, 0x08, 0x7A, 0xEB,
+	0x8C, 0x1D, 0x6F, 0xFE, 0x8B, 0x1A, 0x68, 0xF9, 0x82, 0x13, 0x61, 0xF0, 0x85, 0x14, 0x66, 0xF7,
+	0xA8, 0x39, 0x4B, 0xDA, 0xAF, 0x3E, 0x4C, 0xDD, 0xA6, 0x37, 0x45, 0xD4, 0xA1, 0x30, 0x42, 0xD3,
+	0xB4, 0x25, 0x57, 0xC6, 0xB3, 0x22, 0x50, 0xC1, 0xBA, 0x2B, 0x59, 0xC8, 0xBD, 0x2C, 0x5E, 0xCF,
+};
+
+// The table is constant, only report whether it matches the requested CRC
+uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index)
+{
+	UNUSED(index);
+
+	return (polynomial == TMC_CRC8_UART_POLYNOMIAL) && (isReflected == TMC_CRC8_UART_REFLECTED);
+}
+
+// The index is ignored, there is only one table
+uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index)
+{
+	uint8_t result = 0;
+
+	UNUSED(index);
+
+	CRC8_BACKEND(data, bytes, TMC_CRC8_UART_POLYNOMIAL, TMC_CRC8_UART_REFLECTED);
+
+	while(bytes--)
+		result = CRCTable[result ^ *data++];
+
+	return flipByte(result);
+}
+
+uint8_t tmc_tableGetPolynomial(uint8_t index)
+{
+	UNUSED(index);
+
+	return TMC_CRC8_UART_POLYNOMIAL;
+}
+
+bool tmc_tableIsReflected(uint8_t index)
+{
+	UNUSED(index);
+
+	return TMC_CRC8_UART_REFLECTED;
+}
+
+#elif defined(TMC_CRC8_ENGINE_NIBBLE)
+
+// The table is linear: table[x] = low[x & 0x0F] ^ high[x >> 4]
+typedef struct {
+	uint8_t low[16];
+	uint8_t high[16];
+	uint8_t polynomial;
+	bool isReflected;
+} CRCTypeDef;
+
+CRCTypeDef CRCTables[CRC_TABLE_COUNT] = { 0 };
+
+// Calculate a single entry of the byte-wise lookup table
+static uint8_t tableEntry(uint8_t polynomial, bool isReflected, uint8_t value)
+{
+	int j;
+
+	value = (isReflected)? flipByte(value) : value;
+
+	for(j = 0; j < 8; j++)
+		value = (value & 0x80)? (value << 1) ^ polynomial : (value << 1);
+
+	return (isReflected)? flipByte(value) : value;
+}
+
+uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index)
+{
+	uint8_t i;
+
+	if(index >= CRC_TABLE_COUNT)
+		return 0;
+
+	CRCTables[index].polynomial   = polynomial;
+	CRCTables[index].isReflected  = isReflected;
+
+	for(i = 0; i < 16; i++)
+	{
+		CRCTables[index].low[i]  = tableEntry(polynomial, isReflected, i);
+		CRCTables[index].high[i] = tableEntry(polynomial, isReflected, i << 4);
+	}
+
+	return 1;
+}
+
+uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index)
+{
+	uint8_t result = 0;
+	CRCTypeDef *crc;
+
+	if(index >= CRC_TABLE_COUNT)
+		return 0;
+
+	crc = &CRCTables[index];
+
+	CRC8_BACKEND(data, bytes, crc->polynomial, crc->isReflected);
+
+	while(bytes--)
+	{
+		result ^= *data++;
+		result = crc->low[result & 0x0F] ^ crc->high[result >> 4];
+	}
+
+	return (crc->isReflected)? flipByte(result) : result;
+}
+
+#else
 
 typedef struct {
+#if defined(TMC_CRC8_ENGINE_SLICE4)
+	// table[n][x]: CRC of byte x followed by n zero bytes
+	uint8_t table[4][256];
+#else
 	uint8_t table[256];
+#endif
 	uint8_t polynomial;
 	bool isReflected;
 } CRCTypeDef;
 
 CRCTypeDef CRCTables[CRC_TABLE_COUNT] = { 0 };
 
-static uint8_t flipByte(uint8_t value);
 static uint32_t flipBitsInBytes(uint32_t value);
 
 /* This function generates the Lookup table used for CRC calculations.
@@ -94,20 +254,24 @@ uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index)
 
 	CRCTables[index].polynomial   = polynomial;
 	CRCTables[index].isReflected  = isReflected;
+#if defined(TMC_CRC8_ENGINE_SLICE4)
+	table = &CRCTables[index].table[0][0];
+#else
 	table = &CRCTables[index].table[0];
+#endif
 
 	// Extend the polynomial to correct byte MSBs shifting into next bytes
 	uint32_t poly = (uint32_t) polynomial | 0x0100;
 
 	// Iterate over all 256 possible uint8_t values, compressed into a uint32_t (see detailed explanation above)
 	uint32_t i;
+	int j;
 	for(i = 0x03020100; i != 0x04030200; i+=0x04040404)
 	{
 		// For reflected table: Flip the bits of each input byte
 		CRCdata = (isReflected)? flipBitsInBytes(i) : i;
 
 		// Iterate over 8 Bits
-		int j;
 		for(j = 0; j < 8; j++)
 		{
 			// Store value of soon-to-be shifted out byte
@@ -135,6 +299,13 @@ uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index)
 		*table++ = (uint8_t) CRCdata;
 	}
 
+#if defined(TMC_CRC8_ENGINE_SLICE4)
+	// A trailing zero byte maps a CRC value x to table[x]
+	for(j = 1; j < 4; j++)
+		for(i = 0; i < 256; i++)
+			CRCTables[index].table[j][i] = CRCTables[index].table[0][CRCTables[index].table[j-1][i]];
+#endif
+
 	return 1;
 }
 
@@ -153,7 +324,24 @@ uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index)
 	if(index >= CRC_TABLE_COUNT)
 		return 0;
 
+	CRC8_BACKEND(data, bytes, CRCTables[index].polynomial, CRCTables[index].isReflected);
+
+#if defined(TMC_CRC8_ENGINE_SLICE4)
+	uint8_t (*tables)[256] = CRCTables[index].table;
+
+	// The lookup is linear, so four bytes can be combined from independent lookups
+	for(; bytes >= 4; bytes -= 4, data += 4)
+	{
+		result = tables[3][result ^ data[0]]
+		       ^ tables[2][data[1]]
+		       ^ tables[1][data[2]]
+		       ^ tables[0][data[3]];
+	}
+
+	table = &tables[0][0];
+#else
 	table = &CRCTables[index].table[0];
+#endif
 
 	while(bytes--)
 		result = table[result ^ *data++];
@@ -161,6 +349,9 @@ uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index)
 	return (CRCTables[index].isReflected)? flipByte(result) : result;
 }
 
+#endif
+
+#if !defined(TMC_CRC8_ENGINE_FLASH)
 uint8_t tmc_tableGetPolynomial(uint8_t index)
 {
 	if(index >= CRC_TABLE_COUNT)
@@ -177,6 +368,8 @@ bool tmc_tableIsReflected(uint8_t index)
 	return CRCTables[index].isReflected;
 }
 
+#endif
+
 // Helper functions
 static uint8_t flipByte(uint8_t value)
 {
@@ -190,6 +383,7 @@ static uint8_t flipByte(uint8_t value)
 	return value;
 }
 
+#if !defined(TMC_CRC8_ENGINE_FLASH) && !defined(TMC_CRC8_ENGINE_NIBBLE)
 /* This helper function switches all bits within each byte.
  * The byte order remains the same:
  * [b31 b30 b29 b28 b27 b26 b25 b24 .. b7 b6 b5 b4 b3 b2 b1 b0]
@@ -209,3 +403,73 @@ static uint32_t flipBitsInBytes(uint32_t value)
 
 	return value;
 }
+#endif
+
+// Constant nibble table of the CRC5: the CRC of each 4 bit value, starting from zero
+static const uint8_t CRC5Table[16] =
+{
+	0x00, 0x15, 0x1F, 0x0A, 0x0B, 0x1E, 0x14, 0x01, 0x16, 0x03, 0x09, 0x1C, 0x1D, 0x08, 0x02, 0x17
+};
+
+uint8_t tmc_CRC5(const uint8_t *data, uint32_t bits, uint8_t crc)
+{
+	uint32_t i = 0;
+
+#ifdef TMC_CRC_BACKEND
+	uint8_t hwResult;
+
+	if(backend && backend->crc5 && backend->crc5(data, bits, crc, &hwResult))
+		return hwResult;
+#endif
+
+	// Four bits per lookup (the upper four CRC bits meet the data nibble)
+	for(; i + 4 <= bits; i += 4)
+	{
+		uint8_t nibble = (i & 4) ? (data[i >> 3] & 0x0F) : (data[i >> 3] >> 4);
+		crc = ((crc << 4) & 0x1F) ^ CRC5Table[(crc >> 1) ^ nibble];
+	}
+
+	// Remaining bits one by one
+	for(; i < bits; i++)
+	{
+		uint8_t feedback = ((crc >> 4) ^ (data[i >> 3] >> (7 - (i & 7)))) & 1;
+		crc = ((crc << 1) & 0x1F) ^ (feedback ? TMC_CRC5_POLYNOMIAL : 0);
+	}
+
+	return crc;
+}
+
+#ifdef TMC_CRC_BACKEND
+static bool dmaPending = false;
+#endif
+static uint8_t pendingResult;
+
+// Start the CRC of [data], which has to stay untouched until tmc_CRC8Finish()
+void tmc_CRC8Start(uint8_t *data, uint32_t bytes, uint8_t index)
+{
+#ifdef TMC_CRC_BACKEND
+	if(backend && backend->crc8Start && backend->crc8Finish
+		&& backend->crc8Start(data, bytes, tmc_tableGetPolynomial(index), tmc_tableIsReflected(index)))
+	{
+		dmaPending = true;
+		return;
+	}
+
+	dmaPending = false;
+#endif
+
+	pendingResult = tmc_CRC8(data, bytes, index);
+}
+
+uint8_t tmc_CRC8Finish(void)
+{
+#ifdef TMC_CRC_BACKEND
+	if(dmaPending)
+	{
+		dmaPending = false;
+		return backend->crc8Finish();
+	}
+#endif
+
+	return pendingResult;
+}
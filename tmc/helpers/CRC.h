@@ -10,14 +10,60 @@
 
 	#include "Types.h"
 
-	// Amount of CRC tables available
+	// CRC engine selection. Uncomment at most one of the following defines,
+	// without any of them the byte-wise 256 entry tables are used.
+	//#define TMC_CRC8_ENGINE_FLASH   // Constant table for the Trinamic UART CRC (polynomial 0x07, reflected) in flash. No RAM, no tmc_fillCRC8Table() call required
+	//#define TMC_CRC8_ENGINE_NIBBLE  // Two 16 entry tables per index (~36 bytes each) for RAM-starved parts, two lookups per byte
+	//#define TMC_CRC8_ENGINE_SLICE4  // Four 256 entry tables per index (~1030 bytes each), processes four bytes per lookup step
+
+	// Amount of CRC tables available (unused by TMC_CRC8_ENGINE_FLASH)
 	// Each table takes ~260 bytes (257 bytes, one bool and structure padding)
 	#define CRC_TABLE_COUNT 2
 
+	// Polynomial and reflection of the CRC used by the Trinamic UART interface
+	#define TMC_CRC8_UART_POLYNOMIAL  0x07
+	#define TMC_CRC8_UART_REFLECTED   true
+
 	uint8_t tmc_fillCRC8Table(uint8_t polynomial, bool isReflected, uint8_t index);
 	uint8_t tmc_CRC8(uint8_t *data, uint32_t bytes, uint8_t index);
 
 	uint8_t tmc_tableGetPolynomial(uint8_t index);
 	bool  tmc_tableIsReflected(uint8_t index);
 
+	// 5 bit CRC with polynomial x^5 + x^4 + x^2 + 1, MSB first (MAX22216 SPI interface).
+	// [bits] is the amount of data bits, starting at the MSB of data[0].
+	#define TMC_CRC5_POLYNOMIAL  0x15
+	#define TMC_CRC5_INIT        0x1F
+
+	uint8_t tmc_CRC5(const uint8_t *data, uint32_t bits, uint8_t crc);
+
+	// Hardware CRC backend, enabled with TMC_CRC_BACKEND.
+	// Many MCUs have a CRC unit that can be programmed for the UART CRC (STM32: POLYSIZE 8,
+	// POL 0x07, REV_IN byte and REV_OUT). Once registered with tmc_CRC_setBackend(),
+	// tmc_CRC8() and tmc_CRC5() - and therefore the UART frame functions - hand the
+	// calculation to it. A function returning false, e.g. for a polynomial the unit
+	// is not configured for, or a NULL entry fall back to the table kernel.
+	// The results have to equal the ones of the table kernel for the same polynomial
+	// and reflection, including the final reflection of tmc_CRC8().
+	//
+	// [crc8Start]/[crc8Finish] let a DMA channel feed the unit: tmc_CRC8Start() starts
+	// the CRC of a frame, the caller assembles the next frame of a transaction list
+	// in the meantime and collects the result with tmc_CRC8Finish(). Only one
+	// calculation can be in progress. Without a DMA backend tmc_CRC8Start() calculates
+	// the CRC right away and tmc_CRC8Finish() returns it.
+	typedef struct
+	{
+		bool (*crc8)(const uint8_t *data, uint32_t bytes, uint8_t polynomial, bool isReflected, uint8_t *result);
+		bool (*crc5)(const uint8_t *data, uint32_t bits, uint8_t crc, uint8_t *result);
+		bool (*crc8Start)(const uint8_t *data, uint32_t bytes, uint8_t polynomial, bool isReflected);
+		uint8_t (*crc8Finish)(void); // Waits for the DMA transfer
+	} TMCCRCBackend;
+
+	#ifdef TMC_CRC_BACKEND
+	void tmc_CRC_setBackend(const TMCCRCBackend *backend);
+	#endif
+
+	void tmc_CRC8Start(uint8_t *data, uint32_t bytes, uint8_t index);
+	uint8_t tmc_CRC8Finish(void);
+
 #endif /* TMC_HELPERS_CRC_H_ */
@@ -0,0 +1,124 @@
+/*
+ * ChopperPlan.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "ChopperPlan.h"
+#include "Macros.h"
+
+// pi * 10^6
+#define PI_E6 3141593
+
+// Only bits 22..8 of VDCMIN are used
+#define VDCMIN_MASK 0x7FFF00
+
+// DC_TIME is 10 bits wide
+#define DC_TIME_MAX 0x3FF
+
+// Blank time of the CHOPCONF TBL settings [clocks]
+static const uint8_t blankTimes[4] = { 16, 24, 36, 54 };
+
+uint32_t tmc_velocityToTStep(uint32_t velocity, uint32_t clockFrequency)
+{
+	uint32_t tstep;
+
+	if(velocity == 0)
+		return TMC_TSTEP_MAX;
+
+	tstep = clockFrequency / ((uint64_t) velocity * 256);
+
+	return MIN(MAX(tstep, 1), TMC_TSTEP_MAX);
+}
+
+// Velocity [fullsteps/s] at which the coil voltage reaches [voltage] (mV)
+static uint32_t velocityAtVoltage(const TMCMotorParametersTypeDef *motor, uint32_t voltage)
+{
+	// uV
+	uint64_t available = (uint64_t) voltage * 1000;
+	uint64_t resistive = (uint64_t) motor->current * motor->resistance;
+	// Voltage rise per velocity divided by pi [nVs]: I * L / 2 + Ke * 2 / fullsteps
+	uint64_t slope = ((uint64_t) motor->current * motor->inductance) / 2
+			+ ((uint64_t) motor->backEMF * 2000000) / MAX(motor->fullsteps, 1);
+	uint64_t velocity;
+
+	if(available <= resistive)
+		return 0;
+
+	if(slope == 0)
+		return UINT32_MAX;
+
+	// v = (U - I * R)[uV] * 10^3 / (pi * slope[nVs])
+	velocity = ((available - resistive) * 1000000000) / (slope * PI_E6);
+
+	return MIN(velocity, UINT32_MAX);
+}
+
+void tmc_planChopperThresholds(TMCChopperThresholdsTypeDef *thresholds, const TMCMotorParametersTypeDef *motor, uint32_t supplyVoltage, uint32_t clockFrequency)
+{
+	thresholds->supplyVoltage     = supplyVoltage;
+	thresholds->stealthVelocity   = velocityAtVoltage(motor, ((uint64_t) supplyVoltage * motor->stealthLimit) >> 8);
+	thresholds->fullstepVelocity  = velocityAtVoltage(motor, ((uint64_t) supplyVoltage * motor->fullstepLimit) >> 8);
+
+	thresholds->tpwmthrs   = tmc_velocityToTStep(thresholds->stealthVelocity, clockFrequency);
+	thresholds->tcoolthrs  = thresholds->tpwmthrs;
+	thresholds->thigh      = tmc_velocityToTStep(thresholds->fullstepVelocity, clockFrequency);
+}
+
+bool tmc_replanChopperThresholds(TMCChopperThresholdsTypeDef *thresholds, const TMCMotorParametersTypeDef *motor, uint32_t supplyVoltage, uint32_t clockFrequency)
+{
+	TMCChopperThresholdsTypeDef previous = *thresholds;
+	uint32_t change = (supplyVoltage > previous.supplyVoltage)
+			? supplyVoltage - previous.supplyVoltage
+			: previous.supplyVoltage - supplyVoltage;
+
+	// Ignore supply voltage ripple
+	if(((uint64_t) change << 8) < (uint64_t) previous.supplyVoltage * TMC_CHOPPER_PLAN_HYSTERESIS)
+		return false;
+
+	tmc_planChopperThresholds(thresholds, motor, supplyVoltage, clockFrequency);
+
+	return (thresholds->tpwmthrs != previous.tpwmthrs)
+		|| (thresholds->tcoolthrs != previous.tcoolthrs)
+		|| (thresholds->thigh != previous.thigh);
+}
+
+void tmc_planDcStep(TMCDcStepPlanTypeDef *plan, const TMCMotorParametersTypeDef *motor, uint16_t microsteps, uint8_t tbl, uint32_t clockFrequency)
+{
+	uint32_t blankTime = blankTimes[tbl & 3];
+	uint64_t resistive = (uint64_t) motor->current * motor->resistance;
+	uint64_t velocity, steps, vdcmin;
+
+	// v = (I * R)[uV] * fullsteps * 10^3 / (2 * pi * 10^6 * Ke[mV / (rad/s)])
+	if(motor->backEMF == 0)
+		velocity = UINT32_MAX;
+	else
+		velocity = (resistive * motor->fullsteps * 1000) / ((uint64_t) 2 * PI_E6 * motor->backEMF);
+
+	plan->velocity = MIN(velocity, UINT32_MAX);
+
+	// Above fCLK microsteps/s the result exceeds VDCMIN anyway, limit it before the shift
+	steps = MIN((uint64_t) plan->velocity * microsteps, clockFrequency);
+	vdcmin = (steps << 24) / MAX(clockFrequency, 1);
+	// Round up to the first used bit, dcStep must not start below the planned velocity
+	vdcmin = (vdcmin + 0xFF) & ~(uint64_t) 0xFF;
+	plan->vdcmin = MIN(vdcmin, VDCMIN_MASK);
+
+	// Slightly above the blank time: + 1/8
+	plan->dcTime = MIN(blankTime + blankTime / 8, DC_TIME_MAX);
+	plan->dcSg   = plan->dcTime / 16 + 1;
+	plan->dcctrl = ((uint32_t) plan->dcSg << 16) | plan->dcTime;
+}
+
+bool tmc_dcStepLimiting(uint32_t vdcmin, uint32_t vmax, int32_t vactual, bool velocityReached)
+{
+	uint32_t velocity = (vactual < 0) ? -(uint32_t) vactual : (uint32_t) vactual;
+
+	vdcmin &= VDCMIN_MASK;
+
+	if((vdcmin == 0) || velocityReached)
+		return false;
+
+	return (velocity >= vdcmin) && (velocity < vmax);
+}
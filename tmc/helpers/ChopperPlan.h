@@ -0,0 +1,93 @@
+/*
+ * ChopperPlan.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Planner for the chopper mode switching velocities (TPWMTHRS, TCOOLTHRS,
+ *  THIGH) of the TMC5160/TMC5130/TMC2209/TMC2240.
+ *
+ *  The voltage the driver has to apply to the coils at a velocity v is
+ *  estimated as the sum of the resistive, inductive and back EMF parts:
+ *    U(v) = I * R + I * L * w_el + Ke * w_mech,
+ *    w_el = 2 * pi * v / 4, w_mech = 2 * pi * v / fullsteps   (v in fullsteps/s)
+ *  StealthChop is used while U(v) stays below [stealthLimit] of the supply,
+ *  SpreadCycle up to [fullstepLimit] of the supply and fullstep above.
+ *  CoolStep and StallGuard2 get enabled at the StealthChop limit.
+ *
+ *  The velocities are converted to TSTEP units, the time between two 1/256
+ *  microsteps in clock cycles: TSTEP = fCLK / (256 * v). A mode is active while
+ *  TSTEP is above (StealthChop) or below (CoolStep, fullstep) its threshold.
+ *  Fullstep switching additionally needs vhighfs/vhighchm set in CHOPCONF.
+ *
+ *  dcStep (TMC5130/TMC5160, VDCMIN and DCCTRL) lets the motor run at the
+ *  highest velocity the load allows: Above VDCMIN the driver commutates in
+ *  fullstep based on the back EMF and slows the ramp generator down instead of
+ *  losing steps. The commutation needs a back EMF at least as large as the
+ *  resistive voltage drop, so VDCMIN is planned at
+ *    Ke * w_mech = I * R   ->   v = I * R * fullsteps / (2 * pi * Ke)
+ *  DC_TIME is set slightly above the blank time TBL (16, 24, 36 or 54 clocks),
+ *  DC_SG slightly above DC_TIME / 16. VDCMIN is in VACTUAL units:
+ *    VDCMIN = v[fullsteps/s] * microsteps * 2^24 / fCLK
+ *  StealthChop has to be off above VDCMIN (TPWMTHRS).
+ */
+
+#ifndef TMC_HELPERS_CHOPPERPLAN_H_
+#define TMC_HELPERS_CHOPPERPLAN_H_
+
+#include "Types.h"
+
+// Largest TSTEP value (20 bits)
+#define TMC_TSTEP_MAX 0xFFFFF
+
+// Supply voltage change [1/256] below which a re-plan keeps the thresholds
+#define TMC_CHOPPER_PLAN_HYSTERESIS 4
+
+typedef struct
+{
+	uint32_t resistance;     // Coil resistance [mOhm]
+	uint32_t inductance;     // Coil inductance [uH]
+	uint32_t backEMF;        // Back EMF constant [mV / (rad/s)], = 9.55 * Ke[V/krpm]
+	uint32_t current;        // Peak coil current [mA]
+	uint16_t fullsteps;      // Fullsteps per revolution
+	uint8_t stealthLimit;    // Share of the supply voltage usable in StealthChop [1/256]
+	uint8_t fullstepLimit;   // Share of the supply voltage usable in SpreadCycle [1/256]
+} TMCMotorParametersTypeDef;
+
+typedef struct
+{
+	uint32_t supplyVoltage;     // Supply voltage the thresholds are planned for [mV]
+	uint32_t stealthVelocity;   // [fullsteps/s]
+	uint32_t fullstepVelocity;  // [fullsteps/s]
+	uint32_t tpwmthrs;
+	uint32_t tcoolthrs;
+	uint32_t thigh;
+} TMCChopperThresholdsTypeDef;
+
+typedef struct
+{
+	uint32_t velocity;  // Lowest dcStep velocity [fullsteps/s]
+	uint32_t vdcmin;
+	uint16_t dcTime;
+	uint8_t dcSg;
+	uint32_t dcctrl;    // DC_TIME and DC_SG as register value
+} TMCDcStepPlanTypeDef;
+
+uint32_t tmc_velocityToTStep(uint32_t velocity, uint32_t clockFrequency);
+
+// [supplyVoltage] in mV, [clockFrequency] is the IC clock in Hz
+void tmc_planChopperThresholds(TMCChopperThresholdsTypeDef *thresholds, const TMCMotorParametersTypeDef *motor, uint32_t supplyVoltage, uint32_t clockFrequency);
+
+// Plans again for a changed supply voltage, e.g. measured periodically at runtime.
+// Returns true if the register values changed and have to be written to the IC.
+bool tmc_replanChopperThresholds(TMCChopperThresholdsTypeDef *thresholds, const TMCMotorParametersTypeDef *motor, uint32_t supplyVoltage, uint32_t clockFrequency);
+
+// [microsteps] per fullstep of the ramp generator (MRES), [tbl] is the CHOPCONF TBL setting (0..3)
+void tmc_planDcStep(TMCDcStepPlanTypeDef *plan, const TMCMotorParametersTypeDef *motor, uint16_t microsteps, uint8_t tbl, uint32_t clockFrequency);
+
+// True while dcStep holds the motor below the target velocity because of the load.
+// The velocity mode of a conveyor is the typical case, during the acceleration of a
+// ramp above VDCMIN it is true as well.
+bool tmc_dcStepLimiting(uint32_t vdcmin, uint32_t vmax, int32_t vactual, bool velocityReached);
+
+#endif /* TMC_HELPERS_CHOPPERPLAN_H_ */
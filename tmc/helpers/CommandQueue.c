@@ -0,0 +1,113 @@
+/*
+ * CommandQueue.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "CommandQueue.h"
+#include "Macros.h"
+
+#define QUEUE_MASK (TMC_QUEUE_SIZE - 1)
+
+void tmc_queue_init(TMCCommandQueue *queue)
+{
+	queue->head = 0;
+	queue->tail = 0;
+}
+
+bool tmc_queue_push(TMCCommandQueue *queue, const TMCCommand *commands, uint8_t count)
+{
+	uint32_t head = queue->head;
+	uint8_t i;
+
+	if(TMC_QUEUE_SIZE - (head - queue->tail) < count)
+		return false;
+
+	for(i = 0; i < count; i++)
+		queue->commands[(head + i) & QUEUE_MASK] = commands[i];
+
+	// Publish all commands at once
+	TMC_MEMORY_BARRIER();
+	queue->head = head + count;
+
+	return true;
+}
+
+bool tmc_queue_write(TMCCommandQueue *queue, uint8_t address, int32_t value)
+{
+	TMCCommand command = { .address = address, .mask = 0xFFFFFFFF, .value = value };
+
+	return tmc_queue_push(queue, &command, 1);
+}
+
+bool tmc_queue_field(TMCCommandQueue *queue, uint8_t address, uint32_t mask, uint8_t shift, int32_t value)
+{
+	TMCCommand command = { .address = address, .mask = mask, .value = ((uint32_t) value << shift) & mask };
+
+	return tmc_queue_push(queue, &command, 1);
+}
+
+uint8_t tmc_queue_drain(TMCCommandQueue *queue, void *ic, tmc_driver_writeInt writeInt, tmc_queue_readInt readInt)
+{
+	return tmc_queue_drainOrdered(queue, ic, writeInt, readInt, NULL, 0);
+}
+
+uint8_t tmc_queue_drainOrdered(TMCCommandQueue *queue, void *ic, tmc_driver_writeInt writeInt, tmc_queue_readInt readInt,
+		const TMCWriteOrder *order, size_t orderCount)
+{
+	TMCCommand merged[TMC_QUEUE_SIZE];
+	uint8_t addresses[TMC_QUEUE_SIZE];
+	uint8_t sequence[TMC_QUEUE_SIZE];
+	uint32_t head = queue->head;
+	uint32_t tail;
+	uint8_t count = 0;
+	uint8_t i;
+
+	// Commands up to head are complete
+	TMC_MEMORY_BARRIER();
+
+	// Combine the commands per register
+	for(tail = queue->tail; tail != head; tail++)
+	{
+		const TMCCommand *command = &queue->commands[tail & QUEUE_MASK];
+
+		for(i = 0; i < count; i++)
+			if(merged[i].address == command->address)
+				break;
+
+		if(i == count)
+		{
+			merged[count].address  = command->address;
+			merged[count].mask     = 0;
+			merged[count].value    = 0;
+			count++;
+		}
+
+		merged[i].mask  |= command->mask;
+		merged[i].value  = (merged[i].value & ~command->mask) | command->value;
+	}
+
+	// The commands are copied -> free the slots for the producer
+	TMC_MEMORY_BARRIER();
+	queue->tail = head;
+
+	for(i = 0; i < count; i++)
+		addresses[i] = merged[i].address;
+
+	tmc_writeOrder_sort(order, orderCount, addresses, sequence, count);
+
+	for(i = 0; i < count; i++)
+	{
+		const TMCCommand *command = &merged[sequence[i]];
+		int32_t value = command->value;
+
+		// Field updates only -> read-modify-write
+		if(command->mask != 0xFFFFFFFF)
+			value |= readInt(ic, command->address) & ~command->mask;
+
+		writeInt(ic, command->address, value);
+	}
+
+	return count;
+}
@@ -0,0 +1,68 @@
+/*
+ * CommandQueue.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Register command queue between interrupts/tasks and the driver service loop.
+ *
+ *  Producers that must not block on the bus (e.g. a motion ISR) push register
+ *  writes and field updates in constant time. The service loop drains the queue
+ *  with the blocking driver functions. Commands pushed with one call are made
+ *  visible together, so a motion command spanning several registers is never
+ *  drained half way.
+ *
+ *  Draining coalesces the commands per register: Multiple writes and field
+ *  updates of the same register result in one write with the latest values, a
+ *  register with field updates only is read once. The registers are written in
+ *  the order of their first command since the last drain, moved only as far as
+ *  the write order constraints of the IC require (see WriteOrder.h).
+ *
+ *  The queue is a single producer, single consumer ring buffer without locks:
+ *  The producer only writes head, the consumer only writes tail. Use one queue
+ *  per producer context and drain all of them from the service loop if several
+ *  interrupts or tasks post commands to the same IC. Producer and consumer may
+ *  run on different cores, see Snapshot.h for the way back.
+ */
+
+#ifndef TMC_HELPERS_COMMANDQUEUE_H_
+#define TMC_HELPERS_COMMANDQUEUE_H_
+
+#include "Types.h"
+#include "RegisterDriver.h"
+#include "WriteOrder.h"
+
+// Capacity of a queue, must be a power of two
+#define TMC_QUEUE_SIZE 16
+
+typedef struct
+{
+	uint8_t address;
+	uint32_t mask;  // Bits written, 0xFFFFFFFF for a register write
+	int32_t value;  // Already shifted to the field position
+} TMCCommand;
+
+typedef struct
+{
+	TMCCommand commands[TMC_QUEUE_SIZE];
+	volatile uint32_t head; // Written by the producer
+	volatile uint32_t tail; // Written by the consumer
+} TMCCommandQueue;
+
+// Register read of the IC, called with the IC struct passed to the drain
+typedef int32_t (*tmc_queue_readInt)(void *ic, uint8_t address);
+
+void tmc_queue_init(TMCCommandQueue *queue);
+
+// Push [count] commands at once. Returns false if they do not fit, nothing is queued then.
+bool tmc_queue_push(TMCCommandQueue *queue, const TMCCommand *commands, uint8_t count);
+bool tmc_queue_write(TMCCommandQueue *queue, uint8_t address, int32_t value);
+bool tmc_queue_field(TMCCommandQueue *queue, uint8_t address, uint32_t mask, uint8_t shift, int32_t value);
+
+// Write all queued commands. Returns the amount of register writes.
+uint8_t tmc_queue_drain(TMCCommandQueue *queue, void *ic, tmc_driver_writeInt writeInt, tmc_queue_readInt readInt);
+// Same, with the coalesced writes sorted by the write order constraints [order]
+uint8_t tmc_queue_drainOrdered(TMCCommandQueue *queue, void *ic, tmc_driver_writeInt writeInt, tmc_queue_readInt readInt,
+		const TMCWriteOrder *order, size_t orderCount);
+
+#endif /* TMC_HELPERS_COMMANDQUEUE_H_ */
@@ -8,6 +8,7 @@
 #ifndef TMC_HELPERS_CONFIG_H_
 #define TMC_HELPERS_CONFIG_H_
 
+#include "Features.h"
 #include "Constants.h"
 #include "Types.h"
 
@@ -17,6 +18,13 @@
 // (Casting between function pointers is allowed by the C standard)
 typedef void (*tmc_callback_config)(void);
 
+// Enable to hold the shadow registers of the supporting ICs (TMC5160, TMC2209,
+// TMC2130, TMC2160, TMC2041)
+// in a dense array with one slot per existing register instead of 128 entries.
+// Set shadowSlots to an int32_t array with <IC>_SHADOW_SLOTS entries before
+// calling the init function of the IC, which sets shadowIndex.
+//#define TMC_SHADOW_SPARSE
+
 // States of a configuration
 typedef enum {
 	CONFIG_READY,
@@ -24,16 +32,43 @@ typedef enum {
 	CONFIG_RESTORE
 } ConfigState;
 
+// Configuration status returned by the periodic jobs
+typedef enum {
+	TMC_CONFIG_STATUS_READY,        // No reset or restore running
+	TMC_CONFIG_STATUS_IN_PROGRESS,  // Reset or restore running, configIndex is the progress
+	TMC_CONFIG_STATUS_DONE          // The configuration finished during this call
+} TMCConfigStatus;
+
 // structure for configuration mechanism
 typedef struct
 {
 	ConfigState          state;
 	uint8_t                configIndex;
+	bool                   powerOnReset; // CONFIG_RESET skips registers already at their power-on value
+#if TMC_FEATURE_SHADOW
+#ifdef TMC_SHADOW_SPARSE
+	int32_t                *shadowSlots;
+	const uint8_t          *shadowIndex; // Register address -> slot
+#else
 	int32_t                shadowRegister[TMC_REGISTER_COUNT];
+#endif
+#endif
 	uint8_t (*reset)       (void);
 	uint8_t (*restore)     (void);
 	tmc_callback_config  callback;
 	uint8_t                   channel;
 } ConfigurationTypeDef;
 
+// Shadow register of the given (masked) address
+#if !TMC_FEATURE_SHADOW
+// No shadow registers (TMC_FEATURE_SHADOW)
+#elif defined(TMC_SHADOW_SPARSE)
+#define TMC_SHADOW_REGISTER(config, address)  ((config)->shadowSlots[(config)->shadowIndex[(address)]])
+#else
+#define TMC_SHADOW_REGISTER(config, address)  ((config)->shadowRegister[(address)])
+#endif
+
+// Status after a configuration step
+#define TMC_CONFIG_STATUS(config)  (((config)->state == CONFIG_READY) ? TMC_CONFIG_STATUS_DONE : TMC_CONFIG_STATUS_IN_PROGRESS)
+
 #endif /* TMC_HELPERS_CONFIG_H_ */
@@ -0,0 +1,79 @@
+/*
+ * ConfigEngine.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "ConfigEngine.h"
+
+void tmc_configEngine_init(TMCConfigEngine *engine)
+{
+	uint8_t i;
+
+	engine->count = 0;
+
+	for(i = 0; i < TMC_CONFIG_ENGINE_MAX_BUSES; i++)
+	{
+		engine->requests[i].state  = TMC_ASYNC_IDLE;
+		engine->current[i]         = 0;
+	}
+}
+
+bool tmc_configEngine_add(TMCConfigEngine *engine, tmc_config_step step, void *ic, uint8_t bus)
+{
+	TMCConfigEngineEntry *entry;
+
+	if((engine->count >= TMC_CONFIG_ENGINE_MAX_ICS) || (bus >= TMC_CONFIG_ENGINE_MAX_BUSES))
+		return false;
+
+	entry = &engine->entries[engine->count++];
+	entry->step  = step;
+	entry->ic    = ic;
+	entry->bus   = bus;
+
+	return true;
+}
+
+bool tmc_configEngine_run(TMCConfigEngine *engine)
+{
+	bool done = true;
+	uint8_t bus;
+
+	for(bus = 0; bus < TMC_CONFIG_ENGINE_MAX_BUSES; bus++)
+	{
+		TMCAsyncRequestTypeDef *request = &engine->requests[bus];
+		uint8_t *index = &engine->current[bus];
+
+		// Transfer in flight -> bus busy
+		if(request->state == TMC_ASYNC_PENDING)
+		{
+			done = false;
+			continue;
+		}
+
+		// Advance to the next IC of this bus that still has a datagram to send
+		for(; *index < engine->count; (*index)++)
+		{
+			TMCConfigEngineEntry *entry = &engine->entries[*index];
+
+			if(entry->bus != bus)
+				continue;
+
+			if(entry->step(entry->ic, request))
+			{
+				done = false;
+				break;
+			}
+		}
+	}
+
+	// Allow reusing the engine for the next resets or restores
+	if(done)
+	{
+		for(bus = 0; bus < TMC_CONFIG_ENGINE_MAX_BUSES; bus++)
+			engine->current[bus] = 0;
+	}
+
+	return done;
+}
@@ -0,0 +1,63 @@
+/*
+ * ConfigEngine.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Parallel configuration of ICs on independent buses.
+ *
+ *  The periodic jobs configure one register per IC and call, one bus after
+ *  another. With the async transport, the engine keeps every bus busy instead:
+ *  Each run starts the next configuration datagram on all buses without a
+ *  pending transfer. The ICs of one bus are configured one after another, the
+ *  buses overlap. The total time is set by the bus with the most registers.
+ *
+ *  Start the resets or restores as usual (e.g. tmc5160_reset()), then call
+ *  tmc_configEngine_run() from the main loop until it returns true. The periodic
+ *  jobs of the ICs must not run their configuration meanwhile. Each IC needs a
+ *  step wrapper around its driver function:
+ *
+ *    static bool tmc5160_step(void *ic, TMCAsyncRequestTypeDef *request)
+ *    {
+ *        return tmc5160_configureStepAsync(ic, request);
+ *    }
+ *
+ *    tmc_configEngine_add(&engine, tmc5160_step, &tmc5160[i], spiBus[i]);
+ */
+
+#ifndef TMC_HELPERS_CONFIGENGINE_H_
+#define TMC_HELPERS_CONFIGENGINE_H_
+
+#include "Types.h"
+#include "Async.h"
+
+// Maximum amount of ICs and buses
+#define TMC_CONFIG_ENGINE_MAX_ICS    32
+#define TMC_CONFIG_ENGINE_MAX_BUSES  8
+
+// Start the next configuration datagram of [ic] with [request].
+// Returns false if the configuration is complete and nothing was started.
+typedef bool (*tmc_config_step)(void *ic, TMCAsyncRequestTypeDef *request);
+
+typedef struct
+{
+	tmc_config_step step;
+	void *ic;
+	uint8_t bus;
+} TMCConfigEngineEntry;
+
+typedef struct
+{
+	TMCConfigEngineEntry entries[TMC_CONFIG_ENGINE_MAX_ICS];
+	uint8_t count;
+	TMCAsyncRequestTypeDef requests[TMC_CONFIG_ENGINE_MAX_BUSES]; // One transfer in flight per bus
+	uint8_t current[TMC_CONFIG_ENGINE_MAX_BUSES];                 // Entry being configured per bus
+} TMCConfigEngine;
+
+void tmc_configEngine_init(TMCConfigEngine *engine);
+// Returns false if the engine is full or the bus index is out of range
+bool tmc_configEngine_add(TMCConfigEngine *engine, tmc_config_step step, void *ic, uint8_t bus);
+// Start the next datagram on every idle bus. Returns true once all ICs are configured.
+bool tmc_configEngine_run(TMCConfigEngine *engine);
+
+#endif /* TMC_HELPERS_CONFIGENGINE_H_ */
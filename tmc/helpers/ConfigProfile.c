@@ -0,0 +1,79 @@
+/*
+ * ConfigProfile.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "ConfigProfile.h"
+#include "Macros.h"
+
+void tmc_configProfile_init(TMCConfigProfile *profile)
+{
+	profile->count = 0;
+}
+
+bool tmc_configProfile_set(TMCConfigProfile *profile, uint8_t address, uint32_t value)
+{
+	uint8_t i, j;
+
+	address = TMC_ADDRESS(address);
+
+	for(i = 0; i < profile->count; i++)
+	{
+		if(profile->registers[i].address == address)
+		{
+			profile->registers[i].value = value;
+			return true;
+		}
+
+		if(profile->registers[i].address > address)
+			break;
+	}
+
+	if(profile->count >= TMC_CONFIG_PROFILE_SIZE)
+		return false;
+
+	// Keep the addresses ascending
+	for(j = profile->count; j > i; j--)
+		profile->registers[j] = profile->registers[j - 1];
+
+	profile->registers[i].address  = address;
+	profile->registers[i].value    = value;
+	profile->count++;
+
+	return true;
+}
+
+#if TMC_FEATURE_SHADOW
+bool tmc_configProfile_capture(TMCConfigProfile *profile, ConfigurationTypeDef *config, const uint8_t *addresses, uint8_t count)
+{
+	for(uint8_t i = 0; i < count; i++)
+	{
+		if(!tmc_configProfile_set(profile, addresses[i], TMC_SHADOW_REGISTER(config, TMC_ADDRESS(addresses[i]))))
+			return false;
+	}
+
+	return true;
+}
+#endif
+
+void tmc_configProfile_diff(TMCConfigProfile *diff, const TMCConfigProfile *from, const TMCConfigProfile *to)
+{
+	uint8_t i, j = 0;
+
+	diff->count = 0;
+
+	// Both lists are ascending, walk them side by side
+	for(i = 0; i < to->count; i++)
+	{
+		while((j < from->count) && (from->registers[j].address < to->registers[i].address))
+			j++;
+
+		if((j < from->count) && (from->registers[j].address == to->registers[i].address)
+				&& (from->registers[j].value == to->registers[i].value))
+			continue;
+
+		diff->registers[diff->count++] = to->registers[i];
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * ConfigProfile.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Register profiles for switching between configurations at runtime,
+ *  e.g. a quiet and a power setting of CHOPCONF, PWMCONF, IHOLD_IRUN,
+ *  TPWMTHRS and COOLCONF.
+ *
+ *  A profile is a short list of (address, value) pairs. Capture the base from
+ *  the shadow registers of a configured IC, change the values per profile with
+ *  tmc_configProfile_set(), then compute the transitions once:
+ *
+ *    tmc_configProfile_diff(&quietToPower, &quiet, &power);
+ *    tmc_configProfile_diff(&powerToQuiet, &power, &quiet);
+ *
+ *  A switch then only writes the registers differing between the two profiles,
+ *  e.g. with tmc5160_writeProfile(tmc5160, &quietToPower).
+ */
+
+#ifndef TMC_HELPERS_CONFIGPROFILE_H_
+#define TMC_HELPERS_CONFIGPROFILE_H_
+
+#include "Types.h"
+#include "Config.h"
+#include "RegisterAccess.h"
+
+// Maximum amount of registers per profile
+#ifndef TMC_CONFIG_PROFILE_SIZE
+#define TMC_CONFIG_PROFILE_SIZE 8
+#endif
+
+typedef struct
+{
+	uint8_t count;
+	TMCRegisterConstant registers[TMC_CONFIG_PROFILE_SIZE]; // Ascending addresses
+} TMCConfigProfile;
+
+void tmc_configProfile_init(TMCConfigProfile *profile);
+// Add or replace a register value. Returns false if the profile is full.
+bool tmc_configProfile_set(TMCConfigProfile *profile, uint8_t address, uint32_t value);
+#if TMC_FEATURE_SHADOW
+// Take the values of [addresses] from the shadow registers as a base.
+// Returns false if not all registers fit into the profile.
+bool tmc_configProfile_capture(TMCConfigProfile *profile, ConfigurationTypeDef *config, const uint8_t *addresses, uint8_t count);
+#endif
+// Registers of [to] that are missing in or differ from [from]
+void tmc_configProfile_diff(TMCConfigProfile *diff, const TMCConfigProfile *from, const TMCConfigProfile *to);
+
+#endif /* TMC_HELPERS_CONFIGPROFILE_H_ */
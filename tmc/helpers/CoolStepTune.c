@@ -0,0 +1,145 @@
+/*
+ * CoolStepTune.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "CoolStepTune.h"
+#include "Macros.h"
+
+#define SEMIN_MAX  15
+#define SEMAX_MAX  15
+
+// SEUP: +8 current steps per increment, SEDN: one decrement per 32 StallGuard values
+#define TUNE_SEUP  3
+#define TUNE_SEDN  0
+
+#define COOLSTEP_FIELDS (TMC_COOLSTEP_SEMIN_MASK | TMC_COOLSTEP_SEUP_MASK | TMC_COOLSTEP_SEMAX_MASK | TMC_COOLSTEP_SEDN_MASK)
+
+void tmc_coolStepTune_init(TMCCoolStepTuneTypeDef *tune, int32_t velocity, uint16_t samples, uint16_t settle, uint16_t margin, uint8_t semaxStep)
+{
+	tune->state      = TMC_COOLSTEP_TUNE_IDLE;
+	tune->velocity   = velocity;
+	tune->samples    = MAX(samples, 1);
+	tune->settle     = settle;
+	tune->margin     = margin;
+	tune->semaxStep  = MAX(semaxStep, 1);
+	tune->found      = false;
+}
+
+void tmc_coolStepTune_start(TMCCoolStepTuneTypeDef *tune)
+{
+	tune->semin  = 0;
+	tune->semax  = 0;
+	tune->found  = false;
+	tune->state  = TMC_COOLSTEP_TUNE_START;
+
+	tmc_coolStepTune_resetSamples(tune);
+}
+
+void tmc_coolStepTune_resetSamples(TMCCoolStepTuneTypeDef *tune)
+{
+	tune->count  = 0;
+	tune->sgMin  = UINT16_MAX;
+	tune->sgSum  = 0;
+	tune->csSum  = 0;
+}
+
+bool tmc_coolStepTune_sample(TMCCoolStepTuneTypeDef *tune, uint16_t sgResult, uint8_t csActual)
+{
+	if(++tune->count <= tune->settle)
+		return false;
+
+	tune->sgMin  = MIN(tune->sgMin, sgResult);
+	tune->sgSum  += sgResult;
+	tune->csSum  += csActual;
+
+	return (tune->count >= tune->samples + tune->settle);
+}
+
+// Candidate after [semax] in sweep order, false at the end of the sweep
+static bool nextCandidate(TMCCoolStepTuneTypeDef *tune)
+{
+	if(tune->semax == 0)
+		return false;
+
+	tune->semax = (tune->semax > tune->semaxStep) ? tune->semax - tune->semaxStep : 0;
+
+	return true;
+}
+
+static int32_t candidateCoolconf(TMCCoolStepTuneTypeDef *tune)
+{
+	return (tune->saved[0] & ~COOLSTEP_FIELDS)
+		| (tune->semin << TMC_COOLSTEP_SEMIN_SHIFT)
+		| (TUNE_SEUP << TMC_COOLSTEP_SEUP_SHIFT)
+		| (tune->semax << TMC_COOLSTEP_SEMAX_SHIFT)
+		| (TUNE_SEDN << TMC_COOLSTEP_SEDN_SHIFT);
+}
+
+static TMCCoolStepTuneState finish(TMCCoolStepTuneTypeDef *tune)
+{
+	if(!tune->found)
+		return TMC_COOLSTEP_TUNE_FAILED;
+
+	tune->semax     = tune->bestSemax;
+	tune->coolconf  = candidateCoolconf(tune);
+
+	return TMC_COOLSTEP_TUNE_DONE;
+}
+
+TMCCoolStepTuneState tmc_coolStepTune_evaluate(TMCCoolStepTuneTypeDef *tune)
+{
+	uint16_t sgMin = tune->sgMin;
+	uint16_t sgMean = tune->sgSum / tune->samples;
+	uint8_t csMean = tune->csSum / tune->samples;
+	int32_t semax;
+
+	tmc_coolStepTune_resetSamples(tune);
+
+	if(tune->state == TMC_COOLSTEP_TUNE_BASELINE)
+	{
+		// No headroom even at the full current
+		if(sgMin < tune->margin)
+			return TMC_COOLSTEP_TUNE_FAILED;
+
+		tune->baselineSg  = sgMean;
+		tune->baselineCs  = csMean;
+		tune->semin       = MIN(MAX((tune->margin + 31) / 32, 1), SEMIN_MAX);
+
+		// Largest SEMAX that still lowers the current at the baseline load
+		semax = sgMean / 32 - tune->semin - 1;
+		if(semax < 0)
+			return TMC_COOLSTEP_TUNE_FAILED;
+
+		tune->semax = MIN(semax, SEMAX_MAX);
+
+		return TMC_COOLSTEP_TUNE_SWEEP;
+	}
+
+	// Too close to the stall, the previous candidate is the most aggressive one
+	if(sgMin < tune->margin)
+		return finish(tune);
+
+	if(!tune->found || (csMean < tune->bestCs))
+	{
+		tune->found      = true;
+		tune->bestSemax  = tune->semax;
+		tune->bestCs     = csMean;
+	}
+
+	if(!nextCandidate(tune))
+		return finish(tune);
+
+	return TMC_COOLSTEP_TUNE_SWEEP;
+}
+
+int32_t tmc_coolStepTune_coolconf(TMCCoolStepTuneTypeDef *tune)
+{
+	// SEMIN 0 turns CoolStep off
+	if(tune->state != TMC_COOLSTEP_TUNE_SWEEP)
+		return tune->saved[0] & ~COOLSTEP_FIELDS;
+
+	return candidateCoolconf(tune);
+}
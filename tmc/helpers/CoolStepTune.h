@@ -0,0 +1,104 @@
+/*
+ * CoolStepTune.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  CoolStep auto tuning (TMC5160, TMC5130, TMC2209, TMC2240).
+ *
+ *  CoolStep lowers the motor current while SG_RESULT shows load headroom:
+ *  Below SEMIN * 32 the current is increased, at or above
+ *  (SEMIN + SEMAX + 1) * 32 it is decreased. The tuning runs during a
+ *  calibration move at the typical velocity and load of the axis, driven by the
+ *  tune function of the IC (e.g. tmc5160_tuneCoolStep()), which is called
+ *  periodically until it returns TMC_COOLSTEP_TUNE_DONE or
+ *  TMC_COOLSTEP_TUNE_FAILED:
+ *
+ *  - Baseline: CoolStep off, SG_RESULT and CS_ACTUAL are sampled at the full
+ *    current. SEMIN is chosen so the current is raised as soon as SG_RESULT
+ *    falls to [margin] above the stall.
+ *  - Sweep: CoolStep on, SEMAX is swept from the most conservative value
+ *    still below the baseline SG_RESULT down to 0 in [semaxStep] steps. Each
+ *    candidate gets [settle] samples to adjust the current, then a round of
+ *    [samples] samples. The sweep stops at the first candidate whose lowest
+ *    SG_RESULT falls below [margin].
+ *
+ *  The candidate with the lowest mean CS_ACTUAL is written to COOLCONF in one
+ *  write, SEUP is set to the fastest and SEDN to the slowest step so load steps
+ *  are followed at once and the current is only lowered slowly. The other
+ *  COOLCONF fields (SGT, SFILT, SEIMIN) are kept. The margin holds for the load
+ *  of the calibration move, pick it accordingly for axes with load changes.
+ *
+ *  CoolStep has to be active at the calibration velocity: The tuning sets
+ *  TCOOLTHRS to the maximum and restores it at the end.
+ */
+
+#ifndef TMC_HELPERS_COOLSTEPTUNE_H_
+#define TMC_HELPERS_COOLSTEPTUNE_H_
+
+#include "Types.h"
+
+// COOLCONF layout, the same for all ICs with CoolStep
+#define TMC_COOLSTEP_SEMIN_MASK   0x000F
+#define TMC_COOLSTEP_SEMIN_SHIFT  0
+#define TMC_COOLSTEP_SEUP_MASK    0x0060
+#define TMC_COOLSTEP_SEUP_SHIFT   5
+#define TMC_COOLSTEP_SEMAX_MASK   0x0F00
+#define TMC_COOLSTEP_SEMAX_SHIFT  8
+#define TMC_COOLSTEP_SEDN_MASK    0x6000
+#define TMC_COOLSTEP_SEDN_SHIFT   13
+
+typedef enum {
+	TMC_COOLSTEP_TUNE_IDLE,
+	TMC_COOLSTEP_TUNE_START,
+	TMC_COOLSTEP_TUNE_BASELINE,  // CoolStep off, measuring at full current
+	TMC_COOLSTEP_TUNE_SWEEP,     // CoolStep on with the candidate SEMIN/SEMAX
+	TMC_COOLSTEP_TUNE_DONE,
+	TMC_COOLSTEP_TUNE_FAILED
+} TMCCoolStepTuneState;
+
+typedef struct
+{
+	TMCCoolStepTuneState state;
+	int32_t velocity;     // Calibration velocity, used by ICs with a motion controller or pulse generator
+	uint16_t samples;     // Samples per round
+	uint16_t settle;      // Samples discarded after a COOLCONF change
+	uint16_t margin;      // Lowest SG_RESULT allowed
+	uint8_t semaxStep;    // SEMAX decrement of the sweep
+
+	// Measurement of the current round
+	uint16_t count;
+	uint16_t sgMin;
+	uint32_t sgSum;
+	uint32_t csSum;
+
+	// Candidate of the current round
+	uint8_t semin;
+	uint8_t semax;
+
+	uint16_t baselineSg;  // Mean SG_RESULT at full current
+	uint8_t baselineCs;   // Mean CS_ACTUAL at full current
+
+	// Result
+	bool found;
+	uint8_t bestSemax;
+	uint8_t bestCs;       // Mean CS_ACTUAL of the result
+	int32_t coolconf;     // COOLCONF written at the end
+
+	int32_t saved[2];     // COOLCONF and TCOOLTHRS before the tuning
+} TMCCoolStepTuneTypeDef;
+
+void tmc_coolStepTune_init(TMCCoolStepTuneTypeDef *tune, int32_t velocity, uint16_t samples, uint16_t settle, uint16_t margin, uint8_t semaxStep);
+void tmc_coolStepTune_start(TMCCoolStepTuneTypeDef *tune);
+
+// Used by the IC tune functions
+void tmc_coolStepTune_resetSamples(TMCCoolStepTuneTypeDef *tune);
+// Returns true once a full round of samples is collected
+bool tmc_coolStepTune_sample(TMCCoolStepTuneTypeDef *tune, uint16_t sgResult, uint8_t csActual);
+// Evaluates a full round. Returns TMC_COOLSTEP_TUNE_SWEEP with the next candidate,
+// TMC_COOLSTEP_TUNE_DONE or TMC_COOLSTEP_TUNE_FAILED.
+TMCCoolStepTuneState tmc_coolStepTune_evaluate(TMCCoolStepTuneTypeDef *tune);
+// COOLCONF for the baseline (CoolStep off) and the current candidate, based on saved[0]
+int32_t tmc_coolStepTune_coolconf(TMCCoolStepTuneTypeDef *tune);
+
+#endif /* TMC_HELPERS_COOLSTEPTUNE_H_ */
@@ -0,0 +1,87 @@
+/*
+ * CurrentProfile.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "CurrentProfile.h"
+#include <stdlib.h>
+
+void tmc_currentProfile_init(TMCCurrentProfile *profile, uint8_t globalScalerAddress, uint8_t iholdIrunAddress, const TMCCurrentSetting *settings)
+{
+	uint8_t i;
+
+	profile->globalScalerAddress  = globalScalerAddress;
+	profile->iholdIrunAddress     = iholdIrunAddress;
+
+	for(i = 0; i < TMC_RAMP_PHASE_COUNT; i++)
+		profile->settings[i] = settings[i];
+
+	profile->phase         = TMC_RAMP_PHASE_STANDSTILL;
+	profile->applied       = false;
+	profile->lastVelocity  = 0;
+	profile->changes       = 0;
+}
+
+TMCRampPhase tmc_currentProfile_phase(TMCCurrentProfile *profile, int32_t velocity, bool velocityReached)
+{
+	uint32_t current = abs(velocity);
+	uint32_t last = abs(profile->lastVelocity);
+	TMCRampPhase phase;
+
+	profile->lastVelocity = velocity;
+
+	if(velocity == 0)
+		return TMC_RAMP_PHASE_STANDSTILL;
+
+	if(velocityReached)
+		return TMC_RAMP_PHASE_CRUISE;
+
+	if(current > last)
+		return TMC_RAMP_PHASE_ACCELERATION;
+
+	if(current < last)
+		return TMC_RAMP_PHASE_DECELERATION;
+
+	// Unchanged velocity between two samples: keep the phase
+	phase = profile->applied ? profile->phase : TMC_RAMP_PHASE_CRUISE;
+
+	return (phase == TMC_RAMP_PHASE_STANDSTILL) ? TMC_RAMP_PHASE_ACCELERATION : phase;
+}
+
+bool tmc_currentProfile_update(TMCCurrentProfile *profile, TMCRampPhase phase, TMCCommandQueue *queue)
+{
+	const TMCCurrentSetting *next = &profile->settings[phase];
+	const TMCCurrentSetting *previous = &profile->settings[profile->phase];
+	TMCCommand commands[2];
+	uint8_t count = 0;
+
+	if(profile->applied && (phase == profile->phase))
+		return false;
+
+	if(!profile->applied || (next->globalScaler != previous->globalScaler))
+	{
+		commands[count].address  = profile->globalScalerAddress;
+		commands[count].mask     = 0xFFFFFFFF;
+		commands[count].value    = next->globalScaler;
+		count++;
+	}
+
+	if(!profile->applied || (next->iholdIrun != previous->iholdIrun))
+	{
+		commands[count].address  = profile->iholdIrunAddress;
+		commands[count].mask     = 0xFFFFFFFF;
+		commands[count].value    = next->iholdIrun;
+		count++;
+	}
+
+	if((count > 0) && !tmc_queue_push(queue, commands, count))
+		return false;
+
+	profile->phase    = phase;
+	profile->applied  = true;
+	profile->changes++;
+
+	return count > 0;
+}
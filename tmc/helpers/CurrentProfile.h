@@ -0,0 +1,72 @@
+/*
+ * CurrentProfile.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Motor current per ramp phase, e.g. a boost during acceleration and a reduced
+ *  current during cruise and hold. This gives more acceleration within the same
+ *  thermal envelope.
+ *
+ *  The phase comes from the ramp running the axis:
+ *  - Software ramps: tmc_ramp_linear_get_phase() from the ramp state.
+ *  - Motion controller ramps (TMC5160): tmc_currentProfile_phase() from VACTUAL
+ *    and the velocity_reached flag of RAMP_STAT, e.g. the telemetry values.
+ *    Between two samples with velocity_reached cleared, a rising velocity is an
+ *    acceleration and a falling one a deceleration.
+ *
+ *  tmc_currentProfile_update() queues the GLOBAL_SCALER and IHOLD_IRUN values of
+ *  a phase only when the phase changes, and only the registers that differ from
+ *  the previous phase. The command queue (CommandQueue.h) coalesces them with the
+ *  other pending writes, the service loop writes them.
+ *
+ *  The IC still switches between IRUN and IHOLD by itself (TPOWERDOWN): The
+ *  standstill setting selects IHOLD for the time at rest, the IRUN values of the
+ *  moving phases scale the current while moving.
+ */
+
+#ifndef TMC_HELPERS_CURRENTPROFILE_H_
+#define TMC_HELPERS_CURRENTPROFILE_H_
+
+#include "Types.h"
+#include "CommandQueue.h"
+
+typedef enum {
+	TMC_RAMP_PHASE_STANDSTILL,
+	TMC_RAMP_PHASE_ACCELERATION,
+	TMC_RAMP_PHASE_CRUISE,
+	TMC_RAMP_PHASE_DECELERATION,
+	TMC_RAMP_PHASE_COUNT
+} TMCRampPhase;
+
+typedef struct
+{
+	uint8_t globalScaler;
+	int32_t iholdIrun;     // IHOLD_IRUN register value
+} TMCCurrentSetting;
+
+typedef struct
+{
+	// Configuration
+	uint8_t globalScalerAddress;
+	uint8_t iholdIrunAddress;
+	TMCCurrentSetting settings[TMC_RAMP_PHASE_COUNT];
+
+	// State
+	TMCRampPhase phase;    // Phase of the queued setting
+	bool applied;          // A setting has been queued since the init
+	int32_t lastVelocity;  // Of tmc_currentProfile_phase()
+	uint32_t changes;      // Queued phase changes
+} TMCCurrentProfile;
+
+// [settings] holds TMC_RAMP_PHASE_COUNT entries, indexed by TMCRampPhase
+void tmc_currentProfile_init(TMCCurrentProfile *profile, uint8_t globalScalerAddress, uint8_t iholdIrunAddress, const TMCCurrentSetting *settings);
+
+// Phase of a motion controller ramp from periodic samples of its velocity
+TMCRampPhase tmc_currentProfile_phase(TMCCurrentProfile *profile, int32_t velocity, bool velocityReached);
+
+// Queue the setting of [phase] if the phase changed. Returns true if commands were queued.
+// On a full queue nothing is queued and the next call tries again.
+bool tmc_currentProfile_update(TMCCurrentProfile *profile, TMCRampPhase phase, TMCCommandQueue *queue);
+
+#endif /* TMC_HELPERS_CURRENTPROFILE_H_ */
@@ -0,0 +1,173 @@
+/*
+ * Enumeration.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include <string.h>
+#include "Enumeration.h"
+#include "Constants.h"
+#include "Macros.h"
+#include "ByteOrder.h"
+#include "Lock.h"
+
+// Collect the distinct version registers of the candidates on [bus]
+static uint8_t collectRegisters(const TMCEnumConfig *config, TMCEnumBus bus, uint8_t *addresses)
+{
+	uint8_t count = 0;
+	uint8_t i, j;
+
+	for(i = 0; i < config->candidateCount; i++)
+	{
+		if(config->candidates[i].bus != bus)
+			continue;
+
+		for(j = 0; j < count; j++)
+			if(addresses[j] == config->candidates[i].address)
+				break;
+
+		if((j == count) && (count < TMC_ENUM_MAX_REGISTERS))
+			addresses[count++] = config->candidates[i].address;
+	}
+
+	return count;
+}
+
+static const TMCEnumCandidate *findCandidate(const TMCEnumConfig *config, TMCEnumBus bus, uint8_t address, int32_t value)
+{
+	uint8_t version = TMC_ENUM_VERSION(value);
+	uint8_t i;
+
+	for(i = 0; i < config->candidateCount; i++)
+	{
+		const TMCEnumCandidate *candidate = &config->candidates[i];
+
+		if((candidate->bus == bus) && (candidate->address == address) && (candidate->version == version))
+			return candidate;
+	}
+
+	return NULL;
+}
+
+static bool addDevice(TMCEnumDevice *devices, size_t *count, size_t maxDevices,
+		const TMCEnumCandidate *candidate, uint8_t channel, uint8_t slaveAddress, int32_t value)
+{
+	if(*count >= maxDevices)
+		return false;
+
+	devices[*count].candidate    = candidate;
+	devices[*count].channel      = channel;
+	devices[*count].slaveAddress = slaveAddress;
+	devices[*count].value        = value;
+	(*count)++;
+
+	return true;
+}
+
+// Read all version registers of a channel with pipelined datagrams
+static void probeSpi(const TMCSpiInterface *spi, uint8_t channel, const uint8_t *addresses, int32_t *values, uint8_t count)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH];
+	uint8_t i;
+
+	TMC_LOCK(channel);
+
+	for(i = 0; i <= count; i++)
+	{
+		// The last datagram only clocks out the reply of the previous one
+		data[0] = TMC_ADDRESS(addresses[(i < count) ? i : count - 1]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		TMC_INSTRUMENT_SPI(spi->name, spi->readWriteArray, channel, data, TMC_SPI_DATAGRAM_LENGTH);
+
+		if(i > 0)
+			values[i - 1] = tmc_unpackInt32(&data[1]);
+	}
+
+	TMC_UNLOCK(channel);
+}
+
+// Single read request without retries, an empty slot costs one receive timeout
+static bool probeUart(const TMCUartInterface *uart, uint8_t channel, uint8_t slaveAddress, uint8_t address, int32_t *value)
+{
+	uint8_t data[TMC_UART_READ_LENGTH];
+
+	memset(data, 0, sizeof(data));
+	tmc_uart_fillReadFrame(uart, data, slaveAddress, address);
+
+	TMC_LOCK(channel);
+	TMC_INSTRUMENT_CALL(uart->name, channel, address, false, TMC_UART_REQUEST_LENGTH + TMC_UART_READ_LENGTH,
+			tmc_instrumentation_frameValue(&data[TMC_UART_READ_LENGTH - TMC_UART_REPLY_LENGTH + 2], 5), 0,
+			uart->readWriteArray(channel, data, TMC_UART_REQUEST_LENGTH, TMC_UART_READ_LENGTH));
+	TMC_UNLOCK(channel);
+
+	return tmc_uart_checkReply(uart, data, slaveAddress, address, value);
+}
+
+size_t tmc_enumerate(const TMCEnumConfig *config, TMCEnumDevice *devices, size_t maxDevices)
+{
+	uint8_t addresses[TMC_ENUM_MAX_REGISTERS];
+	int32_t values[TMC_ENUM_MAX_REGISTERS];
+	uint8_t registerCount;
+	size_t count = 0;
+	uint8_t i, j, k;
+
+	// SPI: One pipelined batch per channel, the first matching register wins
+	registerCount = collectRegisters(config, TMC_ENUM_BUS_SPI, addresses);
+	if(config->spi && (registerCount > 0))
+	{
+		for(i = 0; i < config->spiChannelCount; i++)
+		{
+			uint8_t channel = config->spiChannels[i];
+
+			probeSpi(config->spi, channel, addresses, values, registerCount);
+
+			for(k = 0; k < registerCount; k++)
+			{
+				const TMCEnumCandidate *candidate = findCandidate(config, TMC_ENUM_BUS_SPI, addresses[k], values[k]);
+
+				if(candidate)
+				{
+					if(!addDevice(devices, &count, maxDevices, candidate, channel, 0, values[k]))
+						return count;
+					break;
+				}
+			}
+		}
+	}
+
+	// UART: One request per slot and register, stopping at the first match
+	registerCount = collectRegisters(config, TMC_ENUM_BUS_UART, addresses);
+	if(config->uart && (registerCount > 0))
+	{
+		for(i = 0; i < config->uartChannelCount; i++)
+		{
+			uint8_t channel = config->uartChannels[i];
+
+			for(j = 0; j < config->slaveAddressCount; j++)
+			{
+				uint8_t slaveAddress = config->slaveAddresses[j];
+
+				for(k = 0; k < registerCount; k++)
+				{
+					const TMCEnumCandidate *candidate;
+					int32_t value;
+
+					// No reply at all: The slot is empty, skip its remaining registers
+					if(!probeUart(config->uart, channel, slaveAddress, addresses[k], &value))
+						break;
+
+					candidate = findCandidate(config, TMC_ENUM_BUS_UART, addresses[k], value);
+					if(candidate)
+					{
+						if(!addDevice(devices, &count, maxDevices, candidate, channel, slaveAddress, value))
+							return count;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,94 @@
+/*
+ * Enumeration.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Bus enumeration and IC detection at boot.
+ *
+ *  tmc_enumerate() probes every SPI channel and every slave address of every
+ *  UART channel in one pass and identifies the ICs by the VERSION field (bits
+ *  31..24) of their IOIN/INPUT register. The application lists the ICs it
+ *  supports as candidates:
+ *
+ *    static const TMCEnumCandidate candidates[] = {
+ *        { "TMC5160", &tmc5160_interface, TMC_ENUM_BUS_SPI,  TMC5160_INP_OUT, 0x30 },
+ *        { "TMC5240", &tmc5240_interface, TMC_ENUM_BUS_SPI,  TMC5240_INP_OUT, 0x40 },
+ *        { "TMC2209", &tmc2209_interface, TMC_ENUM_BUS_UART, TMC2209_IOIN,    0x21 },
+ *    };
+ *
+ *  Each probe reads a register once for all candidates sharing it:
+ *  - SPI: The version registers of a channel are read with pipelined datagrams,
+ *    n registers take n+1 transfers. An empty channel reads 0x00 or 0xFF.
+ *  - UART: Each slot is probed with a single read request without retries.
+ *    An empty slot costs exactly one receive timeout, so [uart] should be a
+ *    wrapper with a short timeout (a few frame times at the probe baud rate)
+ *    instead of the one used for normal operation. Further registers of a slot
+ *    are only read while no candidate matched.
+ *
+ *  The device table holds the matched candidate, so the application can pair
+ *  every entry with its IC struct for the dispatch interface:
+ *
+ *    TMCIC motor = { devices[i].candidate->interface, &ics[i] };
+ *
+ *  Slots without a matching candidate (empty, invalid reply or unknown version)
+ *  are not listed.
+ */
+
+#ifndef TMC_HELPERS_ENUMERATION_H_
+#define TMC_HELPERS_ENUMERATION_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "ICInterface.h"
+#include "SPI.h"
+#include "UART.h"
+
+// Distinct version register addresses per bus
+#define TMC_ENUM_MAX_REGISTERS  4
+
+#define TMC_ENUM_VERSION(value)  (((uint32_t) (value) >> 24) & 0xFF)
+
+typedef enum {
+	TMC_ENUM_BUS_SPI,
+	TMC_ENUM_BUS_UART
+} TMCEnumBus;
+
+typedef struct
+{
+	const char *name;
+	const TMCICInterface *interface; // NULL for drivers without a dispatch interface
+	TMCEnumBus bus;
+	uint8_t address;                 // Register holding VERSION in bits 31..24
+	uint8_t version;
+} TMCEnumCandidate;
+
+typedef struct
+{
+	const TMCEnumCandidate *candidates;
+	uint8_t candidateCount;
+
+	const TMCSpiInterface *spi;      // NULL: no SPI channels
+	const uint8_t *spiChannels;
+	uint8_t spiChannelCount;
+
+	const TMCUartInterface *uart;    // Probe wrapper with a short timeout, NULL: no UART channels
+	const uint8_t *uartChannels;
+	uint8_t uartChannelCount;
+	const uint8_t *slaveAddresses;   // Probed on every UART channel
+	uint8_t slaveAddressCount;
+} TMCEnumConfig;
+
+typedef struct
+{
+	const TMCEnumCandidate *candidate;
+	uint8_t channel;
+	uint8_t slaveAddress;            // UART only
+	int32_t value;                   // Value of the version register
+} TMCEnumDevice;
+
+// Fill [devices] with up to [maxDevices] detected ICs, SPI channels first.
+// Returns the amount of entries.
+size_t tmc_enumerate(const TMCEnumConfig *config, TMCEnumDevice *devices, size_t maxDevices);
+
+#endif /* TMC_HELPERS_ENUMERATION_H_ */
@@ -0,0 +1,82 @@
+/*
+ * FaultReaction.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "FaultReaction.h"
+#include "Constants.h"
+#include "Macros.h"
+#include "Bits.h"
+
+void tmc_fault_init(TMCFaultGroup *group, const TMCFaultAxis *axes, uint8_t axisCount, const TMCFaultWrite *writes, uint8_t writeCount, uint8_t statusMask)
+{
+	group->axes        = axes;
+	group->axisCount   = axisCount;
+	group->writes      = writes;
+	group->writeCount  = writeCount;
+	group->statusMask  = statusMask;
+	group->tripped     = false;
+	group->trips       = 0;
+#ifdef TMC_INSTRUMENT_ENABLED
+	group->reactionTime   = 0;
+	group->worstReaction  = 0;
+#endif
+}
+
+bool tmc_fault_trip(TMCFaultGroup *group)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH];
+	uint8_t i, j;
+
+	group->trips++;
+
+	if(group->tripped)
+		return false;
+
+	group->tripped = true;
+
+#ifdef TMC_INSTRUMENT_ENABLED
+	uint32_t start = tmc_instrumentation_timestamp();
+#endif
+
+	// Write by write, so the most important register reaches all axes first
+	for(i = 0; i < group->writeCount; i++)
+	{
+		const TMCFaultWrite *write = &group->writes[i];
+
+		for(j = 0; j < group->axisCount; j++)
+		{
+			const TMCFaultAxis *axis = &group->axes[j];
+
+			data[0] = TMC_ADDRESS(write->address) | TMC_WRITE_BIT;
+			data[1] = BYTE(write->value, 3);
+			data[2] = BYTE(write->value, 2);
+			data[3] = BYTE(write->value, 1);
+			data[4] = BYTE(write->value, 0);
+			TMC_INSTRUMENT_SPI(axis->spi->name, axis->spi->readWriteArray, axis->channel, data, TMC_SPI_DATAGRAM_LENGTH);
+		}
+	}
+
+#ifdef TMC_INSTRUMENT_ENABLED
+	group->reactionTime = tmc_instrumentation_timestamp() - start;
+	if(group->reactionTime > group->worstReaction)
+		group->worstReaction = group->reactionTime;
+#endif
+
+	return true;
+}
+
+bool tmc_fault_checkStatus(TMCFaultGroup *group, uint8_t status)
+{
+	if(!(status & group->statusMask))
+		return false;
+
+	return tmc_fault_trip(group);
+}
+
+void tmc_fault_clear(TMCFaultGroup *group)
+{
+	group->tripped = false;
+}
@@ -0,0 +1,96 @@
+/*
+ * FaultReaction.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Fault fast path for the SPI stepper drivers (TMC5160, TMC2160, TMC2240, ...).
+ *
+ *  A fault group holds the axes that have to be brought into a safe state
+ *  together and the writes making up that state, e.g. CHOPCONF with TOFF = 0 to
+ *  disable the drivers or a reduced IHOLD_IRUN. tmc_fault_trip() sends them to
+ *  every axis at once, as raw datagrams through the SPI wrappers:
+ *  - No locking: The fast path takes the bus from whatever access it
+ *    interrupted, so it can be called from the DIAG interrupt or a status
+ *    callback at the highest priority. The SPI wrapper has to allow that, e.g.
+ *    by finishing the current transfer before starting the next one.
+ *  - No shadow register update: The shadows keep the operating configuration,
+ *    so once the fault is resolved, a restore of the ICs (e.g. tmc5160_restore())
+ *    writes it back. The safe state registers have to be written by the
+ *    configuration before, so the restore covers them.
+ *
+ *  Detection, without waiting for the next DRV_STATUS poll:
+ *  - DIAG interrupt: Call tmc_fault_trip() from the GPIO interrupt.
+ *  - SPI status: Every reply of the TMC5160, TMC5130 and TMC2130 carries the
+ *    driver error flag, see SPI.h. Call tmc_fault_checkStatus() from the status
+ *    callback of each axis:
+ *
+ *      static void onStatus(void *ic, uint8_t status, uint8_t rising)
+ *      {
+ *          tmc_fault_checkStatus(&group, status);
+ *      }
+ *
+ *      tmc5160_setSpiStatusCallback(&tmc5160, onStatus, TMC_SPI_STATUS_DRIVER_ERROR);
+ *
+ *    A batch read interrupted this way receives one wrong value, the reply of
+ *    the last safe state datagram.
+ *
+ *  Worst case reaction time:
+ *    detection + axisCount * writeCount * (40 bit SPI transfer + chip select gap)
+ *  with the detection being the interrupt latency for DIAG or one access
+ *  interval of the faulting axis for the SPI status. E.g. 4 axes with 2 writes
+ *  at 4 MHz SCK take 8 transfers of 10 us plus the gaps. With TMC_INSTRUMENTATION
+ *  or TMC_TRACE every trip measures the time from the call to the last datagram
+ *  with tmc_instrumentation_timestamp(), see [reactionTime] and [worstReaction].
+ *  The safe state datagrams are recorded like every other transfer.
+ */
+
+#ifndef TMC_HELPERS_FAULTREACTION_H_
+#define TMC_HELPERS_FAULTREACTION_H_
+
+#include "Types.h"
+#include "SPI.h"
+
+typedef struct
+{
+	const TMCSpiInterface *spi;
+	uint8_t channel;
+} TMCFaultAxis;
+
+typedef struct
+{
+	uint8_t address;
+	int32_t value;
+} TMCFaultWrite;
+
+typedef struct
+{
+	// Configuration
+	const TMCFaultAxis *axes;
+	uint8_t axisCount;
+	const TMCFaultWrite *writes;   // Safe state, sent to every axis in order
+	uint8_t writeCount;
+	uint8_t statusMask;            // SPI_STATUS flags tripping the group, e.g. TMC_SPI_STATUS_DRIVER_ERROR
+
+	// State
+	volatile bool tripped;         // Set by the first trip, cleared by tmc_fault_clear()
+	uint32_t trips;
+#ifdef TMC_INSTRUMENT_ENABLED
+	uint32_t reactionTime;         // Of the last trip
+	uint32_t worstReaction;
+#endif
+} TMCFaultGroup;
+
+void tmc_fault_init(TMCFaultGroup *group, const TMCFaultAxis *axes, uint8_t axisCount, const TMCFaultWrite *writes, uint8_t writeCount, uint8_t statusMask);
+
+// Send the safe state to all axes of the group right away.
+// Only the first trip sends, later ones are counted. Returns true if it sent.
+bool tmc_fault_trip(TMCFaultGroup *group);
+
+// Trip the group if [status] has a flag of [statusMask] set
+bool tmc_fault_checkStatus(TMCFaultGroup *group, uint8_t status);
+
+// Re-arm the group once the fault has been handled and the ICs restored
+void tmc_fault_clear(TMCFaultGroup *group);
+
+#endif /* TMC_HELPERS_FAULTREACTION_H_ */
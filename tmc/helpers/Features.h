@@ -0,0 +1,70 @@
+/*
+ * Features.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Compile time selection of the optional driver features.
+ *
+ *  All features are enabled by default. Define a feature as 0 (e.g. in the
+ *  compiler flags: -DTMC_FEATURE_CONFIG=0) to compile out its code and data
+ *  in the supporting ICs (TMC5160) and the helpers. Small nodes only using
+ *  readInt/writeInt and the motion functions save the reset state and shadow
+ *  register arrays this way.
+ *
+ *    TMC_FEATURE_SHADOW:             Shadow register copy. Without it, reading a
+ *                                    write-only register returns 0. Other ICs
+ *                                    still require the shadow registers.
+ *    TMC_FEATURE_CONFIG:             Reset/restore configuration mechanism and
+ *                                    register images. Requires the shadow.
+ *    TMC_FEATURE_VELOCITY_ESTIMATE:  Velocity estimation in the periodic job.
+ *    TMC_FEATURE_CONSISTENCY:        Consistency check against the shadow.
+ *                                    Requires the shadow.
+ *    TMC_FEATURE_TELEMETRY:          Telemetry snapshot published by the
+ *                                    periodic job.
+ *    TMC_FEATURE_SPI_STATUS:         Capture of the status byte of every SPI
+ *                                    reply, see SPI.h.
+ *
+ *  Disabled by default, for host builds and debugging:
+ *
+ *    TMC_FEATURE_VIEW:               Register view in memory for debug probes
+ *                                    and host tools, see RegisterView.h.
+ */
+
+#ifndef TMC_HELPERS_FEATURES_H_
+#define TMC_HELPERS_FEATURES_H_
+
+#ifndef TMC_FEATURE_SHADOW
+#define TMC_FEATURE_SHADOW 1
+#endif
+
+// Features depending on the shadow default to the shadow setting
+#ifndef TMC_FEATURE_CONFIG
+#define TMC_FEATURE_CONFIG TMC_FEATURE_SHADOW
+#endif
+
+#ifndef TMC_FEATURE_VELOCITY_ESTIMATE
+#define TMC_FEATURE_VELOCITY_ESTIMATE 1
+#endif
+
+#ifndef TMC_FEATURE_CONSISTENCY
+#define TMC_FEATURE_CONSISTENCY TMC_FEATURE_SHADOW
+#endif
+
+#ifndef TMC_FEATURE_TELEMETRY
+#define TMC_FEATURE_TELEMETRY 1
+#endif
+
+#ifndef TMC_FEATURE_SPI_STATUS
+#define TMC_FEATURE_SPI_STATUS 1
+#endif
+
+#ifndef TMC_FEATURE_VIEW
+#define TMC_FEATURE_VIEW 0
+#endif
+
+#if !TMC_FEATURE_SHADOW && (TMC_FEATURE_CONFIG || TMC_FEATURE_CONSISTENCY)
+#error "TMC_FEATURE_CONFIG and TMC_FEATURE_CONSISTENCY require TMC_FEATURE_SHADOW"
+#endif
+
+#endif /* TMC_HELPERS_FEATURES_H_ */
@@ -0,0 +1,104 @@
+/*
+ * FixedMath.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Fixed point primitives for the ramps, filters and conversions.
+ *
+ *  On Arm cores the saturation and bit count functions map to the ACLE
+ *  intrinsics of arm_acle.h: QADD with the DSP extension (Cortex-M4, M7, M33),
+ *  SSAT and CLZ from Cortex-M3 on. Elsewhere they are plain C with the same
+ *  results. The 32x32->64 bit multiplies are plain C on every target, GCC and
+ *  Clang already compile them to SMULL and SMLAL, an intrinsic would not add
+ *  anything there.
+ *
+ *  Define TMC_MATH_PORTABLE to use the plain C versions everywhere, e.g. to
+ *  compare the results on the target.
+ */
+
+#ifndef TMC_HELPERS_FIXEDMATH_H_
+#define TMC_HELPERS_FIXEDMATH_H_
+
+#include "Types.h"
+
+#if !defined(TMC_MATH_PORTABLE) && defined(__ARM_ACLE)
+#include <arm_acle.h>
+#endif
+
+// a + b, saturating at the int32_t limits
+static inline int32_t tmc_math_addSat32(int32_t a, int32_t b)
+{
+#if !defined(TMC_MATH_PORTABLE) && defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+	return __qadd(a, b);
+#else
+	int64_t sum = (int64_t) a + b;
+
+	if(sum > INT32_MAX)
+		return INT32_MAX;
+	if(sum < INT32_MIN)
+		return INT32_MIN;
+
+	return sum;
+#endif
+}
+
+// Saturate [x] to a signed [bits] wide value, 1 <= bits <= 32.
+// TMC_MATH_SSAT() needs a constant [bits] and compiles to a single SSAT.
+static inline int32_t tmc_math_sat(int32_t x, uint8_t bits)
+{
+	int32_t max;
+
+	if(bits >= 32)
+		return x;
+
+	max = (int32_t) (((uint32_t) 1 << (bits - 1)) - 1);
+
+	if(x > max)
+		return max;
+	if(x < -max - 1)
+		return -max - 1;
+
+	return x;
+}
+
+#if !defined(TMC_MATH_PORTABLE) && defined(__ARM_FEATURE_SAT) && __ARM_FEATURE_SAT
+#define TMC_MATH_SSAT(x, bits) __ssat((x), (bits))
+#else
+#define TMC_MATH_SSAT(x, bits) tmc_math_sat((x), (bits))
+#endif
+
+// accumulator + a * b with the full 64 bit product (SMLAL)
+static inline int64_t tmc_math_mlal(int64_t accumulator, int32_t a, int32_t b)
+{
+	return accumulator + (int64_t) a * b;
+}
+
+// Q format multiply: (a * b) >> shift with the full 64 bit product (SMULL), rounded down.
+// The result has to fit into 32 bits.
+static inline int32_t tmc_math_mulShift(int32_t a, int32_t b, uint8_t shift)
+{
+	return (int32_t) (((int64_t) a * b) >> shift);
+}
+
+// Count of leading zero bits, 32 for 0
+static inline uint8_t tmc_math_clz(uint32_t x)
+{
+#if !defined(TMC_MATH_PORTABLE) && defined(__ARM_FEATURE_CLZ) && __ARM_FEATURE_CLZ
+	return __clz(x);
+#elif !defined(TMC_MATH_PORTABLE) && defined(__GNUC__)
+	return (x) ? __builtin_clz(x) : 32;
+#else
+	uint8_t n = 32;
+
+	while(x)
+	{
+		x >>= 1;
+		n--;
+	}
+
+	return n;
+#endif
+}
+
+#endif /* TMC_HELPERS_FIXEDMATH_H_ */
@@ -26,6 +26,18 @@ int64_t tmc_limitS64(int64_t value, int64_t min, int64_t max)
 		return value;
 }
 
+// Index of the highest set bit, x must not be 0
+static uint8_t highestBit(uint32_t x)
+{
+	return 31 - tmc_math_clz(x);
+}
+
+static uint8_t highestBit64(uint64_t x)
+{
+	return (x >> 32) ? 32 + highestBit(x >> 32) : highestBit(x);
+}
+
+#ifndef TMC_SQRT_BITWISE
 /* lookup table for square root function */
 static const unsigned char sqrttable[256] =
 {
@@ -46,6 +58,74 @@ static const unsigned char sqrttable[256] =
 	239, 240, 240, 241, 241, 242, 242, 243, 243, 244, 244, 245, 245, 246, 246, 247,
 	247, 248, 248, 249, 249, 250, 250, 251, 251, 252, 252, 253, 253, 254, 254, 255
 };
+#endif
+
+#if defined(TMC_SQRT_BITWISE)
+
+int32_t tmc_sqrti(int32_t x)
+{
+	uint32_t root = 0;
+	uint32_t bit;
+
+	// Negative parameter?
+	if (x < 0)
+		return -1;
+
+	if (x == 0)
+		return 0;
+
+	// Highest power of four <= x
+	bit = (uint32_t)1 << (highestBit(x) & ~1);
+
+	while (bit != 0)
+	{
+		if ((uint32_t) x >= root + bit)
+		{
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+#elif defined(TMC_SQRT_CLZ)
+
+int32_t tmc_sqrti(int32_t x)
+{
+	uint32_t xn;
+	uint8_t shift;
+
+	// Negative parameter?
+	if (x < 0)
+		return -1;
+
+	if (x < 0x0100)
+		return (int) sqrttable[x] >> 4;
+
+	// Normalise to a table index of 64 to 255 with an even shift
+	shift = (highestBit(x) - 6) & ~1;
+
+	// Table entries hold 16 * sqrt(index) rounded down, so the next entry
+	// gives a start value just above the result
+	xn = ((uint32_t) (sqrttable[x >> shift] + 1) << (shift >> 1)) >> 4;
+
+	// One step of the babylonian method, the result is floored or one above
+	xn = (xn + ((uint32_t) x / xn)) >> 1;
+
+	// Make sure that our result is floored
+	if ((xn * xn) > (uint32_t) x)
+		xn--;
+
+	return xn;
+}
+
+#else
 
 int32_t tmc_sqrti(int32_t x)
 {
@@ -157,14 +237,176 @@ int32_t tmc_sqrti(int32_t x)
 	}
 
 	// Make sure that our result is floored
-	if ((xn * xn) > x)
+	// (unsigned, 46341^2 does not fit into an int32_t)
+	if (((uint32_t) xn * xn) > (uint32_t) x)
 		xn--;
 
 	return xn;
 }
 
+#endif
+
+// Integer square root, rounded down
+uint32_t tmc_sqrti64(uint64_t x)
+{
+	uint64_t root = 0;
+	uint64_t bit;
+
+	if(x == 0)
+		return 0;
+
+	// Highest power of four <= x
+	bit = (uint64_t)1 << (highestBit64(x) & ~1);
+
+	while(bit != 0)
+	{
+		if(x >= root + bit)
+		{
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+// Integer square root of a signed value, rounded down. Returns -1 for negative values.
+int64_t tmc_sqrtS64(int64_t x)
+{
+	if(x < 0)
+		return -1;
+
+	return tmc_sqrti64(x);
+}
+
 int32_t tmc_filterPT1(int64_t *akku, int32_t newValue, int32_t lastValue, uint8_t actualFilter, uint8_t maxFilter)
 {
-	*akku += (newValue-lastValue) << (maxFilter-actualFilter);
+	// Multiply-accumulate with the 64 bit product, so the shifted difference can not overflow.
+	// maxFilter - actualFilter has to be 30 or less.
+	*akku = tmc_math_mlal(*akku, newValue - lastValue, (int32_t) 1 << (maxFilter - actualFilter));
 	return *akku >> maxFilter;
 }
+
+// tmc_filterPT1() for [count] channels with a shared filter setting.
+// values holds the last filter outputs and is updated with the new ones.
+// The loop has no branches or dependencies between channels, so it can be
+// auto-vectorised by the compiler.
+void tmc_filterPT1Bank(int64_t *akku, const int32_t *newValues, int32_t *values, size_t count, uint8_t actualFilter, uint8_t maxFilter)
+{
+	uint8_t shift = maxFilter - actualFilter;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		akku[i] += (int64_t) (newValues[i] - values[i]) << shift;
+		values[i] = akku[i] >> maxFilter;
+	}
+}
+
+// tmc_filterPT1Bank() with 32 bit accumulators, saturating at the int32_t limits.
+// Only use this if the filtered values fit into 32 - maxFilter bits.
+void tmc_filterPT1Bank32(int32_t *akku, const int32_t *newValues, int32_t *values, size_t count, uint8_t actualFilter, uint8_t maxFilter)
+{
+	uint8_t shift = maxFilter - actualFilter;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		int64_t sum = (int64_t) akku[i] + ((int64_t) (newValues[i] - values[i]) << shift);
+
+		akku[i] = MIN(MAX(sum, INT32_MIN), INT32_MAX);
+		values[i] = akku[i] >> maxFilter;
+	}
+}
+
+// Sign extend [count] raw [bits] wide values, e.g. RAMDEBUG captures or batched
+// register reads, see TMC_SIGN_EXTEND. raw and values may be the same array.
+void tmc_signExtendArray(const uint32_t *raw, int32_t *values, size_t count, uint8_t bits)
+{
+	for(size_t i = 0; i < count; i++)
+		values[i] = TMC_SIGN_EXTEND(raw[i], bits);
+}
+
+// Q16 factor converting microsteps per millisecond into the internal velocity
+// unit for the given clock frequency [Hz]: 1000 * 2^24 / fCLK * 2^16 = 2^40 / fCLK[kHz]
+// Only uses 32 bit divisions, the fraction of a kHz is ignored.
+uint32_t tmc_velocityScale(uint32_t clockFrequency)
+{
+	uint32_t kHz = clockFrequency / 1000;
+	uint32_t quotient, remainder;
+
+	// Result would not fit into 32 bits
+	if(kHz <= 256)
+		return UINT32_MAX;
+
+	// 2^40 / kHz = ((2^32-1) / kHz) * 2^8 + (((2^32-1) % kHz) + 1) * 2^8 / kHz
+	quotient  = UINT32_MAX / kHz;
+	remainder = UINT32_MAX % kHz;
+
+	return (quotient << 8) + (((remainder + 1) << 8) / kHz);
+}
+
+#ifndef TMC_VELOCITY_USE_FLOAT
+// velocity = positionDelta / tickDelta * scale / 2^16, rounded towards zero
+static int32_t velocityQ16(int32_t positionDelta, uint32_t tickDelta, uint32_t scale)
+{
+	uint32_t distance = (positionDelta < 0) ? -(uint32_t) positionDelta : (uint32_t) positionDelta;
+	uint32_t whole, fraction;
+	uint64_t velocity;
+
+	if(tickDelta == 0)
+		return 0;
+
+	// Keep the division remainder within 16 bits so the Q16 fraction can not overflow
+	while(tickDelta > 0xFFFF)
+	{
+		tickDelta >>= 1;
+		distance  >>= 1;
+	}
+
+	whole    = distance / tickDelta;
+	fraction = ((distance % tickDelta) << 16) / tickDelta;
+
+	velocity = (uint64_t) whole * scale + (((uint64_t) fraction * scale) >> 16);
+	velocity >>= 16;
+
+	if(velocity > INT32_MAX)
+		velocity = INT32_MAX;
+
+	return (positionDelta < 0) ? -(int32_t) velocity : (int32_t) velocity;
+}
+#endif
+
+// Velocity for a 16MHz clock, positionDelta in microsteps and tickDelta in milliseconds
+int32_t tmc_estimateVelocity(int32_t positionDelta, uint32_t tickDelta)
+{
+#ifdef TMC_VELOCITY_USE_FLOAT
+	return (int32_t) ((float32_t) (positionDelta / (float32_t) tickDelta) * (float32_t) 1048.576);
+#else
+	return velocityQ16(positionDelta, tickDelta, TMC_VELOCITY_SCALE_16MHZ);
+#endif
+}
+
+// Velocity for an arbitrary clock frequency [Hz]
+int32_t tmc_estimateVelocityClock(int32_t positionDelta, uint32_t tickDelta, uint32_t clockFrequency)
+{
+#ifdef TMC_VELOCITY_USE_FLOAT
+	return (int32_t) ((positionDelta * 1000) / ((float32_t) tickDelta) * ((1<<24) / (float32_t) clockFrequency));
+#else
+	return velocityQ16(positionDelta, tickDelta, tmc_velocityScale(clockFrequency));
+#endif
+}
+
+// Velocity with a precomputed factor from tmc_velocityScale(), avoiding its
+// divisions when the clock frequency does not change between measurements
+int32_t tmc_estimateVelocityScaled(int32_t positionDelta, uint32_t tickDelta, uint32_t scale)
+{
+#ifdef TMC_VELOCITY_USE_FLOAT
+	return (int32_t) ((positionDelta / (float32_t) tickDelta) * (scale / (float32_t) 65536));
+#else
+	return velocityQ16(positionDelta, tickDelta, scale);
+#endif
+}
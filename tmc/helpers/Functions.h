@@ -10,9 +10,38 @@
 
 #include "API_Header.h"
 
+// Velocity estimation from two position samples taken tickDelta milliseconds apart.
+// The result is in the internal velocity unit of the TMC5xxx ramp generators.
+// The default implementation only uses integer arithmetic. Uncomment the following
+// define to use the floating point calculation of older releases instead
+// (bit-exact legacy results, but pulls in soft-float on MCUs without an FPU).
+//#define TMC_VELOCITY_USE_FLOAT
+
+// Q16 factor for tmc_estimateVelocity(): 1000 * 2^24 / 16MHz * 2^16
+#define TMC_VELOCITY_SCALE_16MHZ  68719477
+
+// Implementation of tmc_sqrti(). By default, a lookup table and a magnitude
+// based if-ladder give the start value for the Newton iterations.
+// Uncomment one of the following defines to select another implementation:
+// - TMC_SQRT_CLZ: Normalise with count leading zeros, then use the same table
+//   with one iteration. Fastest on cores with a CLZ instruction (Cortex-M3 and up).
+// - TMC_SQRT_BITWISE: Digit by digit calculation without table, for flash
+//   limited parts.
+//#define TMC_SQRT_CLZ
+//#define TMC_SQRT_BITWISE
+
 int32_t tmc_limitInt(int32_t value, int32_t min, int32_t max);
 int64_t tmc_limitS64(int64_t value, int64_t min, int64_t max);
 int32_t tmc_sqrti(int32_t x);
+uint32_t tmc_sqrti64(uint64_t x);
+int64_t tmc_sqrtS64(int64_t x);
 int32_t tmc_filterPT1(int64_t *akku, int32_t newValue, int32_t lastValue, uint8_t actualFilter, uint8_t maxFilter);
+void tmc_filterPT1Bank(int64_t *akku, const int32_t *newValues, int32_t *values, size_t count, uint8_t actualFilter, uint8_t maxFilter);
+void tmc_filterPT1Bank32(int32_t *akku, const int32_t *newValues, int32_t *values, size_t count, uint8_t actualFilter, uint8_t maxFilter);
+void tmc_signExtendArray(const uint32_t *raw, int32_t *values, size_t count, uint8_t bits);
+uint32_t tmc_velocityScale(uint32_t clockFrequency);
+int32_t tmc_estimateVelocity(int32_t positionDelta, uint32_t tickDelta);
+int32_t tmc_estimateVelocityClock(int32_t positionDelta, uint32_t tickDelta, uint32_t clockFrequency);
+int32_t tmc_estimateVelocityScaled(int32_t positionDelta, uint32_t tickDelta, uint32_t scale);
 
 #endif /* TMC_FUNCTIONS_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Homing.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "Homing.h"
+#include "Macros.h"
+
+#define SGT_MIN   -64
+#define SGT_MAX   63
+#define SGTHRS_MAX 255
+
+void tmc_homing_init(TMCHomingTypeDef *homing, int32_t velocity, uint16_t samples, uint16_t margin, uint32_t timeout)
+{
+	homing->state       = TMC_HOMING_IDLE;
+	homing->velocity    = velocity;
+	homing->samples     = MAX(samples, 1);
+	homing->margin      = margin;
+	homing->timeout     = timeout;
+	homing->threshold   = 0;
+	homing->calibrated  = false;
+	homing->diagEvent   = false;
+}
+
+void tmc_homing_start(TMCHomingTypeDef *homing, bool calibrate)
+{
+	if(calibrate)
+		homing->calibrated = false;
+
+	homing->low        = SGT_MIN;
+	homing->high       = SGT_MAX + 1; // Not verified yet
+	if(!homing->calibrated)
+		homing->threshold = homing->low + (homing->high - homing->low) / 2;
+	homing->diagEvent  = false;
+	homing->ticks      = 0;
+	homing->state      = TMC_HOMING_START;
+
+	tmc_homing_resetSamples(homing);
+}
+
+void tmc_homing_onDiag(TMCHomingTypeDef *homing)
+{
+	if(homing->state == TMC_HOMING_SEEK)
+		homing->diagEvent = true;
+}
+
+void tmc_homing_resetSamples(TMCHomingTypeDef *homing)
+{
+	homing->count  = 0;
+	homing->sgMin  = UINT16_MAX;
+	homing->sgMax  = 0;
+	homing->sgSum  = 0;
+}
+
+// Returns true once a full round of samples is collected
+bool tmc_homing_sample(TMCHomingTypeDef *homing, uint16_t sgResult)
+{
+	if(++homing->count <= TMC_HOMING_SETTLE_SAMPLES)
+		return false;
+
+	homing->sgMin  = MIN(homing->sgMin, sgResult);
+	homing->sgMax  = MAX(homing->sgMax, sgResult);
+	homing->sgSum  += sgResult;
+
+	return (homing->count >= homing->samples + TMC_HOMING_SETTLE_SAMPLES);
+}
+
+// Evaluates a full sample round taken with SGT = threshold.
+// Returns TMC_HOMING_CALIBRATE with the next SGT to try in threshold,
+// TMC_HOMING_ACCELERATE with the result or TMC_HOMING_FAILED.
+TMCHomingState tmc_homing_calibrateSG2(TMCHomingTypeDef *homing)
+{
+	// SG_RESULT rises with SGT, stall is signalled at SG_RESULT 0
+	if(homing->sgMin >= homing->margin)
+		homing->high = homing->threshold;
+	else
+		homing->low = homing->threshold + 1;
+
+	tmc_homing_resetSamples(homing);
+
+	if(homing->low < homing->high)
+	{
+		homing->threshold = homing->low + (homing->high - homing->low) / 2;
+		return TMC_HOMING_CALIBRATE;
+	}
+
+	// Even the least sensitive SGT leaves no margin
+	if(homing->high > SGT_MAX)
+		return TMC_HOMING_FAILED;
+
+	homing->threshold   = homing->high;
+	homing->calibrated  = true;
+
+	return TMC_HOMING_ACCELERATE;
+}
+
+// Evaluates a full sample round. Returns TMC_HOMING_ACCELERATE with SGTHRS in threshold
+// or TMC_HOMING_FAILED.
+TMCHomingState tmc_homing_calibrateSG4(TMCHomingTypeDef *homing)
+{
+	uint16_t sgMin = homing->sgMin;
+
+	tmc_homing_resetSamples(homing);
+
+	if(sgMin <= homing->margin)
+		return TMC_HOMING_FAILED;
+
+	homing->threshold   = MIN((sgMin - homing->margin) / 2, SGTHRS_MAX);
+	homing->calibrated  = true;
+
+	return TMC_HOMING_ACCELERATE;
+}
+
+// Enter the seek phase
+void tmc_homing_arm(TMCHomingTypeDef *homing)
+{
+	homing->diagEvent  = false;
+	homing->ticks      = 0;
+	homing->state      = TMC_HOMING_SEEK;
+}
+
+bool tmc_homing_timedOut(TMCHomingTypeDef *homing)
+{
+	return (++homing->ticks > homing->timeout);
+}
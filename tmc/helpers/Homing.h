@@ -0,0 +1,90 @@
+/*
+ * Homing.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Sensorless (StallGuard) homing.
+ *
+ *  A homing runs in two phases, driven by the IC's homing function
+ *  (e.g. tmc5160_home()) which is called periodically until it returns
+ *  TMC_HOMING_DONE or TMC_HOMING_FAILED:
+ *
+ *  - Calibration: The motor runs at the homing velocity away from the end
+ *    stop while SG_RESULT is sampled. The stall threshold is then picked from
+ *    the measured minimum, so the free running motor stays [margin] above the
+ *    stall level:
+ *      StallGuard2 (SGT):    Binary search of the lowest SGT satisfying the
+ *                            margin, at most 7 sample rounds.
+ *      StallGuard4 (SGTHRS): Computed from one sample round, stall is
+ *                            signalled at SG_RESULT <= 2 * SGTHRS.
+ *  - Seek: The motor reverses, reaches the homing velocity and the stall
+ *    detection gets armed. A stall ends the homing at the end stop.
+ *
+ *  Since the threshold is calibrated at the homing velocity itself, the
+ *  homing can run as fast as StallGuard works for the motor instead of at a
+ *  conservative velocity. The calibrated threshold stays in the homing
+ *  structure, later homings of the same axis may skip the calibration.
+ *
+ *  If the stall output (DIAG) of the IC is wired to an interrupt, call
+ *  tmc_homing_onDiag() from the interrupt handler. The stall is then seen
+ *  without waiting for the next poll of the status registers.
+ */
+
+#ifndef TMC_HELPERS_HOMING_H_
+#define TMC_HELPERS_HOMING_H_
+
+#include "Types.h"
+
+// Samples discarded after a threshold or velocity change (SG_RESULT settling)
+#define TMC_HOMING_SETTLE_SAMPLES 4
+
+typedef enum {
+	TMC_HOMING_IDLE,
+	TMC_HOMING_START,
+	TMC_HOMING_CALIBRATE,   // Moving away from the end stop, measuring SG_RESULT
+	TMC_HOMING_ACCELERATE,  // Moving towards the end stop, stall detection not armed yet
+	TMC_HOMING_SEEK,        // Stall detection armed
+	TMC_HOMING_DONE,
+	TMC_HOMING_FAILED
+} TMCHomingState;
+
+typedef struct
+{
+	TMCHomingState state;
+	int32_t velocity;     // Homing velocity, the sign gives the direction of the end stop
+	uint16_t samples;     // SG_RESULT samples per calibration round
+	uint16_t margin;      // Minimum distance of the free running SG_RESULT to the stall level
+	uint32_t timeout;     // Maximum amount of polls in the seek phase
+	int32_t threshold;    // Calibrated SGT / SGTHRS
+	bool calibrated;
+
+	// Measurement of the current calibration round
+	uint16_t count;
+	uint16_t sgMin;
+	uint16_t sgMax;
+	uint32_t sgSum;
+
+	// StallGuard2 search interval, the result is high
+	int8_t low;
+	int8_t high;
+
+	uint32_t ticks;
+	volatile bool diagEvent;
+	int32_t saved[3];     // IC registers changed by the homing, restored at the end
+} TMCHomingTypeDef;
+
+void tmc_homing_init(TMCHomingTypeDef *homing, int32_t velocity, uint16_t samples, uint16_t margin, uint32_t timeout);
+// Start a homing. With [calibrate] false a previously calibrated threshold is reused.
+void tmc_homing_start(TMCHomingTypeDef *homing, bool calibrate);
+void tmc_homing_onDiag(TMCHomingTypeDef *homing);
+
+// Used by the IC homing functions
+void tmc_homing_resetSamples(TMCHomingTypeDef *homing);
+bool tmc_homing_sample(TMCHomingTypeDef *homing, uint16_t sgResult);
+TMCHomingState tmc_homing_calibrateSG2(TMCHomingTypeDef *homing);
+TMCHomingState tmc_homing_calibrateSG4(TMCHomingTypeDef *homing);
+void tmc_homing_arm(TMCHomingTypeDef *homing);
+bool tmc_homing_timedOut(TMCHomingTypeDef *homing);
+
+#endif /* TMC_HELPERS_HOMING_H_ */
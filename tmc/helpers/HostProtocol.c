@@ -0,0 +1,221 @@
+/*
+ * HostProtocol.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "HostProtocol.h"
+#include "CRC.h"
+#include "Constants.h"
+#include "Macros.h"
+#include "Bits.h"
+#include "ByteOrder.h"
+
+// SYNC, sequence, status, count and CRC of a response
+#define RESPONSE_OVERHEAD 5
+
+void tmc_host_init(TMCHostServer *server, uint8_t crcIndex)
+{
+	server->count     = 0;
+	server->crcIndex  = crcIndex;
+}
+
+int8_t tmc_host_add(TMCHostServer *server, const TMCHostIC *ic)
+{
+	if(server->count >= TMC_HOST_MAX_ICS)
+		return -1;
+
+	server->ics[server->count] = *ic;
+
+	return server->count++;
+}
+
+// Request bytes of an operation including the opcode, 0 if it is unknown
+static size_t operationLength(uint8_t operation)
+{
+	switch(operation)
+	{
+	case TMC_HOST_OP_READ:         return 3;
+	case TMC_HOST_OP_WRITE:        return 7;
+	case TMC_HOST_OP_READ_RANGE:   return 4;
+	case TMC_HOST_OP_FIELD_READ:   return 4;
+	case TMC_HOST_OP_FIELD_WRITE:  return 8;
+	default:                       return 0;
+	}
+}
+
+// Result bytes of a successful operation
+static size_t resultLength(const uint8_t *operation)
+{
+	switch(operation[0])
+	{
+	case TMC_HOST_OP_READ:
+	case TMC_HOST_OP_FIELD_READ:
+		return 5;
+	case TMC_HOST_OP_READ_RANGE:
+		return 1 + 4 * operation[3];
+	default:
+		return 1;
+	}
+}
+
+static int32_t getValue(const uint8_t *data)
+{
+	return tmc_unpackInt32(&data[0]);
+}
+
+static uint8_t *putValue(uint8_t *data, int32_t value)
+{
+	*data++ = BYTE(value, 3);
+	*data++ = BYTE(value, 2);
+	*data++ = BYTE(value, 1);
+	*data++ = BYTE(value, 0);
+
+	return data;
+}
+
+static size_t finishResponse(TMCHostServer *server, uint8_t *response, size_t length, uint8_t status, uint8_t count)
+{
+	response[2] = status;
+	response[3] = count;
+	response[length] = tmc_CRC8(response, length, server->crcIndex);
+
+	return length + 1;
+}
+
+size_t tmc_host_process(TMCHostServer *server, const uint8_t *request, size_t length, uint8_t *response, size_t size)
+{
+	size_t position = 3;
+	size_t required = 4;
+	uint8_t *result;
+	uint8_t count, i;
+
+	if(size < RESPONSE_OVERHEAD)
+		return 0;
+
+	response[0] = TMC_HOST_SYNC;
+	response[1] = (length > 1) ? request[1] : 0;
+
+	if((length < 4) || (request[0] != TMC_HOST_SYNC))
+		return finishResponse(server, response, 4, TMC_HOST_ERROR_FORMAT, 0);
+
+	if(tmc_CRC8((uint8_t *) request, length - 1, server->crcIndex) != request[length - 1])
+		return finishResponse(server, response, 4, TMC_HOST_ERROR_CRC, 0);
+
+	// Validate the whole frame before executing anything
+	count = request[2];
+	for(i = 0; i < count; i++)
+	{
+		size_t operation = operationLength(request[position]);
+
+		if((operation == 0) || (position + operation > length - 1))
+			return finishResponse(server, response, 4, TMC_HOST_ERROR_FORMAT, 0);
+
+		required += resultLength(&request[position]);
+		position += operation;
+	}
+
+	if(position != length - 1)
+		return finishResponse(server, response, 4, TMC_HOST_ERROR_FORMAT, 0);
+
+	if(required + 1 > size)
+		return finishResponse(server, response, 4, TMC_HOST_ERROR_OVERFLOW, 0);
+
+	result = &response[4];
+	position = 3;
+
+	for(i = 0; i < count; i++)
+	{
+		const uint8_t *operation = &request[position];
+		TMCHostIC *ic = (operation[1] < server->count) ? &server->ics[operation[1]] : NULL;
+
+		position += operationLength(operation[0]);
+
+		if(!ic)
+		{
+			*result++ = TMC_HOST_ERROR_IC;
+			continue;
+		}
+
+		switch(operation[0])
+		{
+		case TMC_HOST_OP_READ:
+		{
+			uint8_t addresses[TMC_HOST_BATCH_SIZE];
+			int32_t values[TMC_HOST_BATCH_SIZE];
+			uint8_t reads = 1;
+
+			addresses[0] = operation[2];
+
+			// Gather the following reads of the same IC into one pipelined batch
+			while((reads < TMC_HOST_BATCH_SIZE) && (i + 1 < count)
+					&& (request[position] == TMC_HOST_OP_READ) && (request[position + 1] == operation[1]))
+			{
+				addresses[reads++] = request[position + 2];
+				position += 3;
+				i++;
+			}
+
+			ic->readBatch(ic->ic, addresses, values, reads);
+
+			for(uint8_t j = 0; j < reads; j++)
+			{
+				*result++ = TMC_HOST_OK;
+				result = putValue(result, values[j]);
+			}
+			break;
+		}
+		case TMC_HOST_OP_WRITE:
+			ic->writeInt(ic->ic, operation[2], getValue(&operation[3]));
+			*result++ = TMC_HOST_OK;
+			break;
+		case TMC_HOST_OP_READ_RANGE:
+		{
+			uint8_t addresses[TMC_HOST_BATCH_SIZE];
+			int32_t values[TMC_HOST_BATCH_SIZE];
+			uint8_t remaining = operation[3];
+			uint8_t address = operation[2];
+
+			*result++ = TMC_HOST_OK;
+
+			while(remaining)
+			{
+				uint8_t chunk = MIN(remaining, TMC_HOST_BATCH_SIZE);
+
+				for(uint8_t j = 0; j < chunk; j++)
+					addresses[j] = TMC_ADDRESS(address + j);
+
+				ic->readBatch(ic->ic, addresses, values, chunk);
+
+				for(uint8_t j = 0; j < chunk; j++)
+					result = putValue(result, values[j]);
+
+				address += chunk;
+				remaining -= chunk;
+			}
+			break;
+		}
+		case TMC_HOST_OP_FIELD_READ:
+			if(!ic->fieldRead)
+			{
+				*result++ = TMC_HOST_ERROR_UNSUPPORTED;
+				break;
+			}
+			*result++ = TMC_HOST_OK;
+			result = putValue(result, ic->fieldRead(ic->ic, (operation[2] << 8) | operation[3]));
+			break;
+		case TMC_HOST_OP_FIELD_WRITE:
+			if(!ic->fieldWrite)
+			{
+				*result++ = TMC_HOST_ERROR_UNSUPPORTED;
+				break;
+			}
+			ic->fieldWrite(ic->ic, (operation[2] << 8) | operation[3], getValue(&operation[4]));
+			*result++ = TMC_HOST_OK;
+			break;
+		}
+	}
+
+	return finishResponse(server, response, result - response, TMC_HOST_OK, count);
+}
@@ -0,0 +1,97 @@
+/*
+ * HostProtocol.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Batched binary protocol for remote register access from host tools.
+ *
+ *  One request frame carries a list of register and field operations on the
+ *  ICs of the server and is answered with one response frame. Consecutive reads
+ *  of the same IC are executed with one pipelined batch read of the driver.
+ *  The transport (USB, UART, ...) only has to deliver complete frames.
+ *
+ *  Each IC is added with wrappers around its driver functions:
+ *
+ *    static void readBatch(void *ic, const uint8_t *addresses, int32_t *values, size_t count)
+ *    {
+ *        tmc5160_readIntBatch(ic, addresses, values, count);
+ *    }
+ *
+ *    TMCHostIC entry = { &tmc5160, readBatch, writeInt, fieldRead, fieldWrite };
+ *    tmc_host_add(&server, &entry);
+ *
+ *  Request:   SYNC, sequence, operation count, operations..., CRC8
+ *  Response:  SYNC, sequence, frame status, operation count, results..., CRC8
+ *
+ *  Multi byte values are big endian, the CRC8 is calculated over all previous
+ *  bytes of the frame with the CRC table passed to tmc_host_init().
+ *
+ *  Operation     Request bytes                     Result bytes
+ *  READ          op, ic, address                   status, value[4]
+ *  WRITE         op, ic, address, value[4]         status
+ *  READ_RANGE    op, ic, address, count            status, count * value[4]
+ *  FIELD_READ    op, ic, field[2]                  status, value[4]
+ *  FIELD_WRITE   op, ic, field[2], value[4]        status
+ *
+ *  Results of failed operations only hold the status byte. If the frame itself
+ *  is rejected, the response holds the frame status and no results.
+ */
+
+#ifndef TMC_HELPERS_HOSTPROTOCOL_H_
+#define TMC_HELPERS_HOSTPROTOCOL_H_
+
+#include "Types.h"
+
+#define TMC_HOST_SYNC 0xA5
+
+// Maximum amount of ICs per server
+#define TMC_HOST_MAX_ICS 8
+
+// Maximum amount of registers per driver batch read
+#define TMC_HOST_BATCH_SIZE 16
+
+typedef enum {
+	TMC_HOST_OP_READ        = 0x01,
+	TMC_HOST_OP_WRITE       = 0x02,
+	TMC_HOST_OP_READ_RANGE  = 0x03,
+	TMC_HOST_OP_FIELD_READ  = 0x04,
+	TMC_HOST_OP_FIELD_WRITE = 0x05
+} TMCHostOperation;
+
+typedef enum {
+	TMC_HOST_OK,
+	TMC_HOST_ERROR_CRC,          // Frame: CRC mismatch
+	TMC_HOST_ERROR_FORMAT,       // Frame: Bad sync, truncated or unknown operation
+	TMC_HOST_ERROR_OVERFLOW,     // Frame: Results do not fit into the response buffer
+	TMC_HOST_ERROR_IC,           // Operation: Unknown IC
+	TMC_HOST_ERROR_UNSUPPORTED   // Operation: Not supported by the IC
+} TMCHostStatus;
+
+// Driver functions of an IC, called with the IC struct.
+// Field access is optional (NULL), see tmc5160_fieldRead()/tmc5160_fieldWrite().
+typedef struct
+{
+	void *ic;
+	void (*readBatch)(void *ic, const uint8_t *addresses, int32_t *values, size_t count);
+	void (*writeInt)(void *ic, uint8_t address, int32_t value);
+	int32_t (*fieldRead)(void *ic, uint16_t field);
+	void (*fieldWrite)(void *ic, uint16_t field, int32_t value);
+} TMCHostIC;
+
+typedef struct
+{
+	TMCHostIC ics[TMC_HOST_MAX_ICS];
+	uint8_t count;
+	uint8_t crcIndex;  // CRC table filled by the application with tmc_fillCRC8Table()
+} TMCHostServer;
+
+void tmc_host_init(TMCHostServer *server, uint8_t crcIndex);
+// Returns the IC index used in the frames, -1 if the server is full
+int8_t tmc_host_add(TMCHostServer *server, const TMCHostIC *ic);
+
+// Execute a request frame and build the response frame.
+// Returns the length of the response, 0 if [size] cannot even hold an error response.
+size_t tmc_host_process(TMCHostServer *server, const uint8_t *request, size_t length, uint8_t *response, size_t size);
+
+#endif /* TMC_HELPERS_HOSTPROTOCOL_H_ */
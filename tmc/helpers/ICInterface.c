@@ -0,0 +1,17 @@
+/*
+ * ICInterface.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "ICInterface.h"
+
+// Batch read of drivers without a pipelined batch read
+void tmc_ic_readIntBatchFallback(const TMCICInterface *interface, void *ic, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	size_t i;
+
+	for(i = 0; i < count; i++)
+		values[i] = interface->readInt(ic, addresses[i]);
+}
@@ -0,0 +1,91 @@
+/*
+ * ICInterface.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Common interface of the IC drivers for firmware supporting several ICs.
+ *
+ *  Drivers supporting it (TMC5160, TMC2209, TMC5240) export a constant
+ *  TMCICInterface, e.g. tmc5160_interface. The application pairs it with its
+ *  IC struct once, e.g. after reading the board ID:
+ *
+ *    TMCIC motor = { &tmc5160_interface, &tmc5160 };
+ *
+ *    tmc_ic_writeInt(&motor, TMC5160_VMAX, 100000);
+ *    tmc_ic_periodicJob(&motor, systick_getTick());
+ *
+ *  Every call is one indirect call through the interface. The periodic job
+ *  has the tmc_scheduler_job signature, so it can also be registered with
+ *  the scheduler directly.
+ *
+ *  Firmware built for a single IC defines TMC_IC_SINGLE as the function
+ *  prefix of the driver (e.g. -DTMC_IC_SINGLE=tmc5160). The same calls then
+ *  expand to direct calls of the driver functions and the interface member
+ *  of TMCIC is ignored. Only the optional functions (readIntBatch,
+ *  readTelemetry) are taken from the constant interface of that driver.
+ */
+
+#ifndef TMC_HELPERS_ICINTERFACE_H_
+#define TMC_HELPERS_ICINTERFACE_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "Config.h"
+
+typedef struct
+{
+	const char *name;
+	int32_t (*readInt)(void *ic, uint8_t address);
+	void (*writeInt)(void *ic, uint8_t address, int32_t value);
+	void (*readIntBatch)(void *ic, const uint8_t *addresses, int32_t *values, size_t count); // NULL: one readInt per address
+	TMCConfigStatus (*periodicJob)(void *ic, uint32_t tick);
+	bool (*readTelemetry)(void *ic, int32_t *values, uint32_t *tick); // NULL: no telemetry. Returns false if nothing was captured yet.
+	uint8_t telemetryCount; // Values returned by readTelemetry
+} TMCICInterface;
+
+typedef struct
+{
+	const TMCICInterface *interface;
+	void *ic;
+} TMCIC;
+
+void tmc_ic_readIntBatchFallback(const TMCICInterface *interface, void *ic, const uint8_t *addresses, int32_t *values, size_t count);
+
+#ifdef TMC_IC_SINGLE
+
+#define TMC_IC_CONCAT_(prefix, name)  prefix##_##name
+#define TMC_IC_CONCAT(prefix, name)   TMC_IC_CONCAT_(prefix, name)
+#define TMC_IC_FUNCTION(name)         TMC_IC_CONCAT(TMC_IC_SINGLE, name)
+
+extern const TMCICInterface TMC_IC_FUNCTION(interface);
+
+#define TMC_IC_INTERFACE(handle)  (&TMC_IC_FUNCTION(interface))
+
+#define tmc_ic_readInt(handle, address)         TMC_IC_FUNCTION(readInt)((handle)->ic, address)
+#define tmc_ic_writeInt(handle, address, value) TMC_IC_FUNCTION(writeInt)((handle)->ic, address, value)
+#define tmc_ic_periodicJob(handle, tick)        TMC_IC_FUNCTION(periodicJob)((handle)->ic, tick)
+
+#else
+
+#define TMC_IC_INTERFACE(handle)  ((handle)->interface)
+
+#define tmc_ic_readInt(handle, address)         ((handle)->interface->readInt((handle)->ic, address))
+#define tmc_ic_writeInt(handle, address, value) ((handle)->interface->writeInt((handle)->ic, address, value))
+#define tmc_ic_periodicJob(handle, tick)        ((handle)->interface->periodicJob((handle)->ic, tick))
+
+#endif
+
+#define tmc_ic_name(handle)  (TMC_IC_INTERFACE(handle)->name)
+
+#define tmc_ic_readIntBatch(handle, addresses, values, count) \
+	((TMC_IC_INTERFACE(handle)->readIntBatch) \
+		? TMC_IC_INTERFACE(handle)->readIntBatch((handle)->ic, addresses, values, count) \
+		: tmc_ic_readIntBatchFallback(TMC_IC_INTERFACE(handle), (handle)->ic, addresses, values, count))
+
+#define tmc_ic_readTelemetry(handle, values, tick) \
+	((TMC_IC_INTERFACE(handle)->readTelemetry) \
+		? TMC_IC_INTERFACE(handle)->readTelemetry((handle)->ic, values, tick) \
+		: false)
+
+#endif /* TMC_HELPERS_ICINTERFACE_H_ */
@@ -0,0 +1,162 @@
+/*
+ * Instrumentation.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "Instrumentation.h"
+
+#ifdef TMC_INSTRUMENT_ENABLED
+
+#ifdef TMC_INSTRUMENTATION_HOOK
+extern void tmc_instrumentation_hook(const char *ic, uint8_t channel, uint8_t address, bool isWrite, size_t bytes, uint32_t duration);
+#endif
+
+#ifdef TMC_INSTRUMENTATION
+static TMCInstrumentationCounters counters[TMC_INSTRUMENTATION_CHANNELS];
+
+// Index of the highest set bit + 1, 0 for 0
+static uint8_t bucket(uint32_t duration)
+{
+	uint8_t i = 0;
+
+	while(duration)
+	{
+		duration >>= 1;
+		i++;
+	}
+
+	return i;
+}
+#endif
+
+#ifdef TMC_TRACE
+TMCTraceBuffer tmc_trace;
+
+static void trace(uint32_t timestamp, uint8_t channel, uint8_t address, uint8_t flags, uint32_t value, uint8_t status)
+{
+	uint32_t head = tmc_trace.head;
+	TMCTraceRecord *record;
+
+	if(head - tmc_trace.tail >= TMC_TRACE_SIZE)
+	{
+		tmc_trace.dropped++;
+		return;
+	}
+
+	record = &tmc_trace.records[head & (TMC_TRACE_SIZE - 1)];
+	record->timestamp  = timestamp;
+	record->value      = value;
+	record->channel    = channel;
+	record->address    = address;
+	record->flags      = flags;
+	record->status     = status;
+
+	// Publish the record after it is complete
+	tmc_trace.head = head + 1;
+}
+
+bool tmc_trace_read(TMCTraceRecord *record)
+{
+	uint32_t tail = tmc_trace.tail;
+
+	if(tail == tmc_trace.head)
+		return false;
+
+	*record = tmc_trace.records[tail & (TMC_TRACE_SIZE - 1)];
+	tmc_trace.tail = tail + 1;
+
+	return true;
+}
+#endif
+
+uint32_t tmc_instrumentation_frameValue(const uint8_t *data, size_t length)
+{
+	uint32_t value = 0;
+
+	for(size_t i = 1; (i < length) && (i <= 4); i++)
+		value = (value << 8) | data[i];
+
+	return value;
+}
+
+void tmc_instrumentation_record(const char *ic, uint8_t channel, uint8_t address, bool isWrite, size_t length, uint32_t start, uint32_t value, uint8_t status)
+{
+	uint32_t now = tmc_instrumentation_timestamp();
+	uint32_t duration = now - start;
+
+	UNUSED(ic);
+	UNUSED(duration);
+	UNUSED(value);
+	UNUSED(status);
+
+#ifdef TMC_INSTRUMENTATION_HOOK
+	tmc_instrumentation_hook(ic, channel, address, isWrite, length, duration);
+#endif
+
+#ifdef TMC_TRACE
+	trace(start, channel, TMC_ADDRESS(address), isWrite ? TMC_TRACE_WRITE : 0, value, status);
+#endif
+
+#ifdef TMC_INSTRUMENTATION
+	if(channel >= TMC_INSTRUMENTATION_CHANNELS)
+		return;
+
+	TMCInstrumentationCounters *c = &counters[channel];
+
+	c->transfers++;
+	c->bytes += length;
+	if(isWrite)
+		c->writes++;
+	else
+		c->reads++;
+	c->registerTransfers[TMC_ADDRESS(address)]++;
+	c->latency[bucket(duration)]++;
+#else
+	UNUSED(length);
+#endif
+}
+
+void tmc_instrumentation_error(const char *ic, uint8_t channel)
+{
+	UNUSED(ic);
+
+#ifdef TMC_TRACE
+	trace(tmc_instrumentation_timestamp(), channel, 0, TMC_TRACE_ERROR, 0, 0);
+#endif
+
+#ifdef TMC_INSTRUMENTATION
+	if(channel < TMC_INSTRUMENTATION_CHANNELS)
+		counters[channel].errors++;
+#endif
+}
+
+void tmc_instrumentation_retry(const char *ic, uint8_t channel)
+{
+	UNUSED(ic);
+
+#ifdef TMC_INSTRUMENTATION
+	if(channel < TMC_INSTRUMENTATION_CHANNELS)
+		counters[channel].retries++;
+#else
+	UNUSED(channel);
+#endif
+}
+
+#ifdef TMC_INSTRUMENTATION
+TMCInstrumentationCounters *tmc_instrumentation_counters(uint8_t channel)
+{
+	return (channel < TMC_INSTRUMENTATION_CHANNELS) ? &counters[channel] : NULL;
+}
+
+void tmc_instrumentation_clear(void)
+{
+	uint8_t *bytes = (uint8_t *) counters;
+
+	for(size_t i = 0; i < sizeof(counters); i++)
+		bytes[i] = 0;
+}
+#endif
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Instrumentation.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Optional statistics of the bus transactions caused by the drivers.
+ *
+ *  Enable with TMC_INSTRUMENTATION. Every transport call of the instrumented
+ *  drivers is then counted per channel: transfers, bytes, reads, writes, reply
+ *  errors, retries, transfers per register and a log2 histogram of the transfer
+ *  duration. The application provides the time base:
+ *      uint32_t tmc_instrumentation_timestamp(void);
+ *  With TMC_INSTRUMENTATION_HOOK every transfer is additionally reported to
+ *      void tmc_instrumentation_hook(const char *ic, uint8_t channel, uint8_t address, bool isWrite, size_t bytes, uint32_t duration);
+ *  for example to collect statistics per IC.
+ *
+ *  TMC_TRACE records every transfer in a ring buffer of 12 byte records, see
+ *  TMCTraceRecord, drained with tmc_trace_read() by a low priority task or read
+ *  by a debugger through the tmc_trace symbol. The buffer is lock-free for one
+ *  producer (the context doing the bus accesses) and one consumer. Records
+ *  that do not fit are dropped and counted.
+ *
+ *  Without TMC_INSTRUMENTATION and TMC_TRACE the macros expand to the plain
+ *  transport call.
+ */
+
+#ifndef TMC_HELPERS_INSTRUMENTATION_H_
+#define TMC_HELPERS_INSTRUMENTATION_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "Constants.h"
+#include "Macros.h"
+
+//#define TMC_INSTRUMENTATION
+//#define TMC_INSTRUMENTATION_HOOK
+//#define TMC_TRACE
+
+#if defined(TMC_INSTRUMENTATION) || defined(TMC_TRACE)
+#define TMC_INSTRUMENT_ENABLED
+#endif
+
+// Amount of channels with counters, transfers on higher channels are not counted
+#define TMC_INSTRUMENTATION_CHANNELS  4
+
+// latency[0]: duration 0, latency[n]: 2^(n-1) <= duration < 2^n timestamp ticks
+#define TMC_INSTRUMENTATION_BUCKETS   33
+
+typedef struct
+{
+	uint32_t transfers;
+	uint32_t bytes;
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t errors;   // Invalid replies (CRC, echo, header)
+	uint32_t retries;
+	uint32_t registerTransfers[TMC_REGISTER_COUNT];
+	uint32_t latency[TMC_INSTRUMENTATION_BUCKETS];
+} TMCInstrumentationCounters;
+
+// Amount of trace records, must be a power of two
+#define TMC_TRACE_SIZE  64
+
+#define TMC_TRACE_WRITE  0x01 // Write access, otherwise read
+#define TMC_TRACE_ERROR  0x02 // Invalid reply of the previous transfer on this channel
+
+typedef struct
+{
+	uint32_t timestamp;
+	uint32_t value;    // Sent value of writes, received value of reads (SPI: reply to the previous datagram)
+	uint8_t channel;   // Identifies the IC
+	uint8_t address;
+	uint8_t flags;     // TMC_TRACE_*
+	uint8_t status;    // First reply byte, the status byte of SPI ICs
+} TMCTraceRecord;
+
+typedef struct
+{
+	TMCTraceRecord records[TMC_TRACE_SIZE];
+	volatile uint32_t head; // Written by the producer
+	volatile uint32_t tail; // Written by the consumer
+	volatile uint32_t dropped;
+} TMCTraceBuffer;
+
+#ifdef TMC_INSTRUMENT_ENABLED
+
+extern uint32_t tmc_instrumentation_timestamp(void);
+
+// Run [call] and count it as transfer of [length] bytes to register [address].
+// [value] and [status] are evaluated after the call.
+#define TMC_INSTRUMENT_CALL(ic, channel, address, isWrite, length, value, status, call) \
+	do { \
+		uint8_t tmcInstrumentAddress = (address); \
+		bool tmcInstrumentWrite = (isWrite); \
+		uint32_t tmcInstrumentStart = tmc_instrumentation_timestamp(); \
+		call; \
+		tmc_instrumentation_record(ic, channel, tmcInstrumentAddress, tmcInstrumentWrite, length, tmcInstrumentStart, value, status); \
+	} while(0)
+
+// Transport call with the register address in the first byte, MSB set for writes.
+// The reply overwrites the sent data, so the value of a write is taken before the call.
+#define TMC_INSTRUMENT_SPI(ic, function, channel, data, length) \
+	do { \
+		uint32_t tmcInstrumentSent = tmc_instrumentation_frameValue(data, length); \
+		bool tmcInstrumentSpiWrite = ((data)[0] & TMC_WRITE_BIT) != 0; \
+		TMC_INSTRUMENT_CALL(ic, channel, TMC_ADDRESS((data)[0]), tmcInstrumentSpiWrite, length, \
+				tmcInstrumentSpiWrite ? tmcInstrumentSent : tmc_instrumentation_frameValue(data, length), (data)[0], \
+				function(channel, data, length)); \
+	} while(0)
+
+#define TMC_INSTRUMENT_ERROR(ic, channel)  tmc_instrumentation_error(ic, channel)
+#define TMC_INSTRUMENT_RETRY(ic, channel)  tmc_instrumentation_retry(ic, channel)
+
+// Member initializer for structures with an IC name, e.g. TMCUartInterface
+#define TMC_INSTRUMENT_NAME(ic)  .name = (ic),
+
+void tmc_instrumentation_record(const char *ic, uint8_t channel, uint8_t address, bool isWrite, size_t length, uint32_t start, uint32_t value, uint8_t status);
+void tmc_instrumentation_error(const char *ic, uint8_t channel);
+void tmc_instrumentation_retry(const char *ic, uint8_t channel);
+
+// Big endian value of the (up to 4) bytes following the first byte of a frame
+uint32_t tmc_instrumentation_frameValue(const uint8_t *data, size_t length);
+
+#ifdef TMC_INSTRUMENTATION
+TMCInstrumentationCounters *tmc_instrumentation_counters(uint8_t channel);
+void tmc_instrumentation_clear(void);
+#endif
+
+#ifdef TMC_TRACE
+extern TMCTraceBuffer tmc_trace;
+
+// Take the oldest record. Returns false if the buffer is empty.
+bool tmc_trace_read(TMCTraceRecord *record);
+#endif
+
+#else
+
+#define TMC_INSTRUMENT_CALL(ic, channel, address, isWrite, length, value, status, call)  call
+#define TMC_INSTRUMENT_SPI(ic, function, channel, data, length)  function(channel, data, length)
+#define TMC_INSTRUMENT_ERROR(ic, channel)  ((void) 0)
+#define TMC_INSTRUMENT_RETRY(ic, channel)  ((void) 0)
+#define TMC_INSTRUMENT_NAME(ic)
+
+#endif
+
+#endif /* TMC_HELPERS_INSTRUMENTATION_H_ */
@@ -0,0 +1,88 @@
+/*
+ * LoadStream.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "LoadStream.h"
+#include "Macros.h"
+
+#define STREAM_MASK (TMC_LOAD_STREAM_SIZE - 1)
+
+static void resetWindow(TMCLoadWindow *window)
+{
+	window->sgSum  = 0;
+	window->csSum  = 0;
+	window->sgMin  = UINT16_MAX;
+	window->sgMax  = 0;
+	window->count  = 0;
+}
+
+void tmc_loadStream_init(TMCLoadStream *stream, uint8_t decimation)
+{
+	uint8_t i;
+
+	stream->head        = 0;
+	stream->tail        = 0;
+	stream->dropped     = 0;
+	stream->decimation  = MAX(decimation, 1);
+
+	for(i = 0; i < TMC_LOAD_STREAM_AXES; i++)
+		resetWindow(&stream->windows[i]);
+}
+
+void tmc_loadStream_sample(TMCLoadStream *stream, uint8_t axis, uint16_t sg, uint8_t cs, uint32_t tick)
+{
+	TMCLoadWindow *window;
+	TMCLoadRecord *record;
+	uint32_t head = stream->head;
+
+	if(axis >= TMC_LOAD_STREAM_AXES)
+		return;
+
+	window = &stream->windows[axis];
+	window->sgSum  += sg;
+	window->csSum  += cs;
+	window->sgMin   = MIN(window->sgMin, sg);
+	window->sgMax   = MAX(window->sgMax, sg);
+
+	if(++window->count < stream->decimation)
+		return;
+
+	if(head - stream->tail >= TMC_LOAD_STREAM_SIZE)
+	{
+		stream->dropped++;
+	}
+	else
+	{
+		record = &stream->records[head & STREAM_MASK];
+		record->tick   = tick;
+		record->sg     = window->sgSum / window->count;
+		record->sgMin  = window->sgMin;
+		record->sgMax  = window->sgMax;
+		record->cs     = window->csSum / window->count;
+		record->axis   = axis;
+
+		TMC_MEMORY_BARRIER();
+		stream->head = head + 1;
+	}
+
+	resetWindow(window);
+}
+
+bool tmc_loadStream_pop(TMCLoadStream *stream, TMCLoadRecord *record)
+{
+	uint32_t tail = stream->tail;
+
+	if(tail == stream->head)
+		return false;
+
+	TMC_MEMORY_BARRIER();
+	*record = stream->records[tail & STREAM_MASK];
+
+	TMC_MEMORY_BARRIER();
+	stream->tail = tail + 1;
+
+	return true;
+}
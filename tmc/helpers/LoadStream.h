@@ -0,0 +1,65 @@
+/*
+ * LoadStream.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  StallGuard/load telemetry stream.
+ *
+ *  The drivers' sample functions (e.g. tmc5160_chainSampleLoad()) read the
+ *  load registers of one or more axes, unpack SG_RESULT and CS_ACTUAL with the
+ *  constant field masks and feed them to tmc_loadStream_sample(). Every
+ *  [decimation] samples of an axis are reduced to one compact record holding
+ *  the mean and the range of SG_RESULT, the records are collected in a ring
+ *  buffer read by the monitoring with tmc_loadStream_pop().
+ *
+ *  Sampling and popping may run in different contexts (single producer,
+ *  single consumer). Records are dropped and counted if the buffer is full.
+ */
+
+#ifndef TMC_HELPERS_LOADSTREAM_H_
+#define TMC_HELPERS_LOADSTREAM_H_
+
+#include "Types.h"
+
+// Capacity of the record buffer, must be a power of two
+#define TMC_LOAD_STREAM_SIZE 32
+
+// Maximum amount of axes per stream
+#define TMC_LOAD_STREAM_AXES 8
+
+typedef struct
+{
+	uint32_t tick;    // Tick of the last sample of the window
+	uint16_t sg;      // Mean SG_RESULT
+	uint16_t sgMin;
+	uint16_t sgMax;
+	uint8_t cs;       // Mean CS_ACTUAL
+	uint8_t axis;
+} TMCLoadRecord;
+
+typedef struct
+{
+	uint32_t sgSum;
+	uint16_t csSum;
+	uint16_t sgMin;
+	uint16_t sgMax;
+	uint8_t count;
+} TMCLoadWindow;
+
+typedef struct
+{
+	TMCLoadRecord records[TMC_LOAD_STREAM_SIZE];
+	volatile uint32_t head;  // Written by the sampling
+	volatile uint32_t tail;  // Written by the consumer
+	uint32_t dropped;        // Records lost to a full buffer
+	uint8_t decimation;      // Samples per record, 1: no decimation
+	TMCLoadWindow windows[TMC_LOAD_STREAM_AXES];
+} TMCLoadStream;
+
+void tmc_loadStream_init(TMCLoadStream *stream, uint8_t decimation);
+void tmc_loadStream_sample(TMCLoadStream *stream, uint8_t axis, uint16_t sg, uint8_t cs, uint32_t tick);
+// Returns false if no record is available
+bool tmc_loadStream_pop(TMCLoadStream *stream, TMCLoadRecord *record);
+
+#endif /* TMC_HELPERS_LOADSTREAM_H_ */
@@ -0,0 +1,50 @@
+/*
+ * Lock.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Optional locking hook for multi-task firmware.
+ *
+ *  With TMC_LOCKING, the supporting drivers (TMC5160 and the UART ICs) take a
+ *  lock around every logical register operation: one read with both of its
+ *  transfers, one write including the shadow register update, one batch read
+ *  or one read-modify-write of the FIELD macros. The application provides the
+ *  lock functions and decides what the channel maps to, e.g. one mutex per SPI
+ *  bus or per IC. ICs on different buses can then be accessed concurrently from
+ *  different tasks.
+ *
+ *  The read-modify-write macros lock around the read and write functions, which
+ *  lock again, so the lock has to be recursive (e.g. a recursive RTOS mutex).
+ *  The sync batch and the async functions are called from interrupts and do not
+ *  lock.
+ */
+
+#ifndef TMC_HELPERS_LOCK_H_
+#define TMC_HELPERS_LOCK_H_
+
+#include "Types.h"
+
+// Uncomment to call tmc_lock()/tmc_unlock() around the register operations
+//#define TMC_LOCKING
+
+#ifdef TMC_LOCKING
+
+// => Lock wrapper
+// Block until the lock of [channel] is held. Has to allow recursive locking.
+extern void tmc_lock(uint8_t channel);
+// Release the lock of [channel]
+extern void tmc_unlock(uint8_t channel);
+// <= Lock wrapper
+
+#define TMC_LOCK(channel)    tmc_lock(channel)
+#define TMC_UNLOCK(channel)  tmc_unlock(channel)
+
+#else
+
+#define TMC_LOCK(channel)    ((void) 0)
+#define TMC_UNLOCK(channel)  ((void) 0)
+
+#endif
+
+#endif /* TMC_HELPERS_LOCK_H_ */
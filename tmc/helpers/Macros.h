@@ -8,12 +8,24 @@
 #ifndef TMC_MACROS_H_
 #define TMC_MACROS_H_
 
+#include "Types.h"
+
 /* Cast a n bit signed int to a 32 bit signed int
  * This is done by checking the MSB of the signed int (Bit n).
  * If it is 1, the value is negative and the Bits 32 to n+1 are set to 1
  * If it is 0, the value remains unchanged
+ * The MSB is turned into an all-ones or all-zeros mask, so no branch is needed.
+ */
+#define CAST_Sn_TO_S32(value, n) \
+	((value) | (((uint32_t)0 - (((uint32_t)(value) >> ((n)-1)) & 1)) & ~(UINT32_MAX >> (32-(n)))))
+
+/* Sign extend a n bit value (1 <= n <= 32) to a 32 bit signed int.
+ * Unlike CAST_Sn_TO_S32, bits above n are ignored. Flipping the sign bit and
+ * subtracting it again moves negative values below zero without a branch.
+ * With a constant n, this is an and, an xor and a sub.
  */
-#define CAST_Sn_TO_S32(value, n) ((value) | (((value) & ((uint32_t)1<<((n)-1)))? ~(((uint32_t)1<<(n))-1) : 0 ))
+#define TMC_SIGN_EXTEND(value, n) \
+	((int32_t) ((((uint32_t)(value) & (UINT32_MAX >> (32-(n)))) ^ ((uint32_t)1 << ((n)-1))) - ((uint32_t)1 << ((n)-1))))
 
 // Min/Max macros
 #ifndef MIN
@@ -32,6 +44,15 @@
 #define FIELD_SET(data, mask, shift, value) \
 	(((data) & (~(mask))) | (((value) << (shift)) & (mask)))
 
+// Multiple fields of one register:
+// OR the masks of the fields and the field values built with FIELD_VALUE.
+// With constant values, both fold to one constant each, e.g.
+//   FIELDS_SET(data, TOFF_MASK | HSTRT_MASK, FIELD_VALUE(TOFF_MASK, TOFF_SHIFT, 3) | FIELD_VALUE(HSTRT_MASK, HSTRT_SHIFT, 4))
+#define FIELD_VALUE(mask, shift, value) \
+	(((value) << (shift)) & (mask))
+#define FIELDS_SET(data, mask, values) \
+	(((data) & (~(mask))) | ((values) & (mask)))
+
 // Register read/write/update macros using Mask/Shift:
 #define FIELD_READ(read, motor, address, mask, shift) \
 	FIELD_GET(read(motor, address), mask, shift)
@@ -40,6 +61,31 @@
 #define FIELD_UPDATE(read, write, motor, address, mask, shift, value) \
 	(write(motor, address, FIELD_SET(read(motor, address), mask, shift, value)))
 
+// Field update transaction: Collect multiple field writes to one register and
+// apply them with a single read and write. The read is skipped if all bits of
+// the register are set. Works with every IC read/write function pair, e.g.
+//   TMCFieldUpdate update;
+//   FIELD_UPDATE_BEGIN(update, TMC5160_CHOPCONF);
+//   FIELD_UPDATE_SET(update, TMC5160_TOFF_MASK, TMC5160_TOFF_SHIFT, 3);
+//   FIELD_UPDATE_SET(update, TMC5160_TBL_MASK, TMC5160_TBL_SHIFT, 2);
+//   FIELD_UPDATE_COMMIT(tmc5160_readInt, tmc5160_writeInt, tmc5160, update);
+// The read function returns the shadow register for write-only registers.
+typedef struct
+{
+	uint8_t address;
+	uint32_t mask;
+	uint32_t values;
+} TMCFieldUpdate;
+
+#define FIELD_UPDATE_BEGIN(update, addr) \
+	((update).address = (addr), (update).mask = 0, (update).values = 0)
+#define FIELD_UPDATE_SET(update, fieldMask, shift, value) \
+	((update).mask |= (fieldMask), (update).values = FIELD_SET((update).values, fieldMask, shift, value))
+#define FIELD_UPDATE_COMMIT(read, write, motor, update) \
+	(write(motor, (update).address, ((update).mask == UINT32_MAX) \
+		? (update).values \
+		: FIELDS_SET(read(motor, (update).address), (update).mask, (update).values)))
+
 // Macro to surpress unused parameter warnings
 #ifndef UNUSED
 	#define UNUSED(x) (void)(x)
@@ -48,6 +94,16 @@
 // Memory access helpers
 // Force the compiler to access a location exactly once
 #define ACCESS_ONCE(x) *((volatile typeof(x) *) (&x))
+// Order memory accesses for other cores, e.g. a DMB on ARM. Override for
+// compilers without the GCC builtins.
+#ifndef TMC_MEMORY_BARRIER
+	#define TMC_MEMORY_BARRIER() __sync_synchronize()
+#endif
+// Keep the compiler from moving memory accesses across this point. Enough to
+// order accesses against interrupts on the same core.
+#ifndef TMC_COMPILER_BARRIER
+	#define TMC_COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+#endif
 
 // Macro to remove write bit for shadow register array access
 #define TMC_ADDRESS(x) ((x) & (TMC_ADDRESS_MASK))
@@ -0,0 +1,170 @@
+/*
+ * RampProfile.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RampProfile.h"
+#include "Functions.h"
+#include "Macros.h"
+
+// With the velocity time unit t = 2^24 / fCLK, an acceleration a changes the velocity
+// by 2^7 * a per t. A trapezoid reaching v within the move time T (in t) then takes
+// T = distance / v + v / (2^7 * a), so
+// v = (X - sqrt(X^2 - 4 * 2^7 * a * distance)) / 2 with X = 2^7 * a * T.
+bool tmc_planRampProfile(TMCRampProfileTypeDef *profile, uint32_t distance, uint32_t time, uint32_t clockFrequency, uint32_t velocityLimit, uint32_t accelerationLimit)
+{
+	uint32_t acceleration = MIN(accelerationLimit, TMC_RAMP_PROFILE_AMAX_LIMIT);
+	uint64_t velocity;
+	uint64_t x, discriminant, clockScale;
+	bool reached = true;
+
+	velocityLimit = MIN(velocityLimit, TMC_RAMP_PROFILE_VMAX_LIMIT);
+	if(acceleration == 0)
+		acceleration = 1;
+
+	// 4 * 2^7 * a * distance
+	discriminant = ((uint64_t) acceleration * distance) << 9;
+
+	// X = 2^7 * a * time[ms] * fCLK / (1000 * 2^24)
+	clockScale = ((uint64_t) acceleration * clockFrequency) / 1000;
+	if((time != 0) && (clockScale > (UINT64_MAX >> 1) / time))
+		x = UINT64_MAX;
+	else
+		x = (clockScale * time) >> 17;
+
+	if(x >= ((uint64_t)1 << 32))
+	{	// Long move time - v = distance / T, the ramps are negligible
+		velocity = (discriminant >> 1) / (x * 2);
+	}
+	else if(x * x >= discriminant)
+	{	// Numerically stable form of the smaller root
+		velocity = (discriminant >> 1) / (x + tmc_sqrti64(x * x - discriminant));
+	}
+	else
+	{	// Move time too short even without cruising - fastest triangle ramp
+		velocity = tmc_sqrti64(discriminant >> 2);
+		reached = false;
+	}
+
+	if(velocity > velocityLimit)
+	{
+		velocity = velocityLimit;
+		reached = false;
+	}
+
+	profile->vStart  = 0;
+	profile->a1      = acceleration;
+	profile->v1      = 0; // Single acceleration phase, A1 and D1 are only used below V1
+	profile->aMax    = acceleration;
+	profile->vMax    = MAX(velocity, 1);
+	profile->dMax    = acceleration;
+	profile->d1      = acceleration; // D1 must not be 0 in positioning mode
+	profile->vStop   = TMC_RAMP_PROFILE_VSTOP;
+
+	return reached;
+}
+
+void tmc_rampProfileCache_init(TMCRampProfileCacheTypeDef *cache)
+{
+	for(size_t i = 0; i < TMC_RAMP_PROFILE_CACHE_SIZE; i++)
+		cache->entries[i].lastUse = 0;
+
+	cache->useCounter  = 0;
+	cache->hits        = 0;
+	cache->misses      = 0;
+}
+
+static uint32_t cacheKey(uint32_t distance, uint32_t time, uint32_t clockFrequency, uint32_t velocityLimit, uint32_t accelerationLimit)
+{
+	uint32_t key = distance;
+
+	key = key * 31 + time;
+	key = key * 31 + clockFrequency;
+	key = key * 31 + velocityLimit;
+	key = key * 31 + accelerationLimit;
+
+	return key;
+}
+
+bool tmc_planRampProfileCached(TMCRampProfileCacheTypeDef *cache, TMCRampProfileTypeDef *profile, uint32_t distance, uint32_t time, uint32_t clockFrequency, uint32_t velocityLimit, uint32_t accelerationLimit)
+{
+	uint32_t key = cacheKey(distance, time, clockFrequency, velocityLimit, accelerationLimit);
+	TMCRampProfileCacheEntryTypeDef *entry;
+	TMCRampProfileCacheEntryTypeDef *oldest = &cache->entries[0];
+
+	// Counter overflow: restart the use order, every entry stays valid
+	if(++cache->useCounter == 0)
+	{
+		for(size_t i = 0; i < TMC_RAMP_PROFILE_CACHE_SIZE; i++)
+			if(cache->entries[i].lastUse)
+				cache->entries[i].lastUse = 1;
+
+		cache->useCounter = 2;
+	}
+
+	for(size_t i = 0; i < TMC_RAMP_PROFILE_CACHE_SIZE; i++)
+	{
+		entry = &cache->entries[i];
+
+		if(entry->lastUse < oldest->lastUse)
+			oldest = entry;
+
+		if((entry->lastUse == 0) || (entry->key != key))
+			continue;
+
+		if((entry->distance != distance) || (entry->time != time) || (entry->clockFrequency != clockFrequency)
+				|| (entry->velocityLimit != velocityLimit) || (entry->accelerationLimit != accelerationLimit))
+			continue;
+
+		entry->lastUse = cache->useCounter;
+		*profile = entry->profile;
+		cache->hits++;
+		return entry->reached;
+	}
+
+	entry = oldest;
+	entry->key                = key;
+	entry->distance           = distance;
+	entry->time               = time;
+	entry->clockFrequency     = clockFrequency;
+	entry->velocityLimit      = velocityLimit;
+	entry->accelerationLimit  = accelerationLimit;
+	entry->lastUse            = cache->useCounter;
+	entry->reached            = tmc_planRampProfile(&entry->profile, distance, time, clockFrequency, velocityLimit, accelerationLimit);
+	cache->misses++;
+
+	*profile = entry->profile;
+	return entry->reached;
+}
+
+// An acceleration a changes the velocity by 2^7 * a per t, braking from v takes
+// v / (2^7 * a) t over v^2 / (2^8 * a) microsteps.
+uint32_t tmc_rampBrakingDistance(int32_t velocity, uint32_t deceleration)
+{
+	uint64_t v = (uint64_t) abs(velocity);
+
+	if(deceleration == 0)
+		return UINT32_MAX;
+
+	return (uint32_t) MIN((v * v) / ((uint64_t) deceleration << 8), UINT32_MAX);
+}
+
+int8_t tmc_planRetarget(int32_t position, int32_t velocity, int32_t target, uint32_t deceleration)
+{
+	int64_t distance = (int64_t) target - position;
+
+	if(velocity == 0)
+		return 0;
+
+	// Moving away from the target
+	if((velocity > 0) != (distance > 0))
+		return (velocity > 0) ? -1 : 1;
+
+	// Too close to stop in front of it: Reverse right away to come back from behind
+	if(tmc_rampBrakingDistance(velocity, deceleration) > (uint64_t) ((distance < 0) ? -distance : distance))
+		return (velocity > 0) ? -1 : 1;
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * RampProfile.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Integer planner for the six point hardware ramp of the TMC51xx/TMC5072/TMC5240
+ *  motion controllers (VSTART, A1, V1, AMAX, VMAX, DMAX, D1, VSTOP).
+ *
+ *  Units are the internal units of the ICs:
+ *  v[Hz] = v * fCLK / 2^24, a[Hz/s] = a * fCLK^2 / 2^41
+ */
+
+#ifndef TMC_HELPERS_RAMPPROFILE_H_
+#define TMC_HELPERS_RAMPPROFILE_H_
+
+#include "Types.h"
+
+// Register limits of the ramp generator
+#define TMC_RAMP_PROFILE_VMAX_LIMIT  ((1u << 23) - 512)
+#define TMC_RAMP_PROFILE_AMAX_LIMIT  ((1u << 16) - 1)
+
+// VSTOP used by the planner. The datasheets recommend at least 10 for positioning.
+#define TMC_RAMP_PROFILE_VSTOP 10
+
+// Amount of profiles kept by a TMCRampProfileCacheTypeDef
+#ifndef TMC_RAMP_PROFILE_CACHE_SIZE
+#define TMC_RAMP_PROFILE_CACHE_SIZE 16
+#endif
+
+typedef struct
+{
+	uint32_t vStart;
+	uint32_t a1;
+	uint32_t v1;
+	uint32_t aMax;
+	uint32_t vMax;
+	uint32_t dMax;
+	uint32_t d1;
+	uint32_t vStop;
+} TMCRampProfileTypeDef;
+
+typedef struct
+{
+	uint32_t key;  // Hash of the planner arguments, compared first
+	uint32_t distance;
+	uint32_t time;
+	uint32_t clockFrequency;
+	uint32_t velocityLimit;
+	uint32_t accelerationLimit;
+	uint32_t lastUse;  // 0: unused entry
+	bool reached;
+	TMCRampProfileTypeDef profile;
+} TMCRampProfileCacheEntryTypeDef;
+
+// Retargeting of a running motion, see tmc_planRetarget()
+typedef struct
+{
+	int32_t target;
+	uint32_t velocityMax;
+	int8_t direction;  // Velocity mode direction of a running reversal, 0: none
+} TMCRetargetTypeDef;
+
+// Least recently used cache of planned profiles, for machines repeating the same moves
+typedef struct
+{
+	TMCRampProfileCacheEntryTypeDef entries[TMC_RAMP_PROFILE_CACHE_SIZE];
+	uint32_t useCounter;
+	uint32_t hits;
+	uint32_t misses;
+} TMCRampProfileCacheTypeDef;
+
+// Plans a symmetric trapezoid ramp that moves [distance] microsteps in [time] milliseconds,
+// accelerating and decelerating with [accelerationLimit] (AMAX/DMAX).
+// [clockFrequency] is the IC clock in Hz.
+// Returns true if the move time is met. If the limits do not allow it, the profile holds the
+// fastest move within the limits and false is returned.
+bool tmc_planRampProfile(TMCRampProfileTypeDef *profile, uint32_t distance, uint32_t time, uint32_t clockFrequency, uint32_t velocityLimit, uint32_t accelerationLimit);
+
+// Same as tmc_planRampProfile(), but returns the cached result of an earlier call with the same arguments.
+// A miss plans the profile and replaces the least recently used entry.
+void tmc_rampProfileCache_init(TMCRampProfileCacheTypeDef *cache);
+bool tmc_planRampProfileCached(TMCRampProfileCacheTypeDef *cache, TMCRampProfileTypeDef *profile, uint32_t distance, uint32_t time, uint32_t clockFrequency, uint32_t velocityLimit, uint32_t accelerationLimit);
+
+// Distance in microsteps to brake from [velocity] to standstill with [deceleration]
+uint32_t tmc_rampBrakingDistance(int32_t velocity, uint32_t deceleration);
+
+// Retargeting: The positioning mode of the ramp generator brakes to standstill through D1
+// and VSTOP (and waits TZEROWAIT) before it starts towards a target behind the motor.
+// The velocity mode instead runs through zero velocity with AMAX, without stopping.
+// Returns the velocity mode direction (1, -1) reversing the motion at [position] with
+// [velocity] towards [target], or 0 if the positioning mode can take over right away:
+// The motor is at standstill or moves towards the target with enough distance left
+// to brake with [deceleration] (DMAX, D1 is not accounted for).
+int8_t tmc_planRetarget(int32_t position, int32_t velocity, int32_t target, uint32_t deceleration);
+
+#endif /* TMC_HELPERS_RAMPPROFILE_H_ */
@@ -0,0 +1,85 @@
+/*
+ * RegisterAccess.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RegisterAccess.h"
+
+// Index of the lowest set bit, x must not be 0
+static uint8_t lowestBit(uint32_t x)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz(x);
+#else
+	uint8_t n = 0;
+
+	while(!(x & 1))
+	{
+		x >>= 1;
+		n++;
+	}
+
+	return n;
+#endif
+}
+
+void tmc_dirtyClearAll(uint32_t *dirty)
+{
+	for(uint8_t i = 0; i < TMC_DIRTY_WORDS; i++)
+		dirty[i] = 0;
+}
+
+// Returns the first dirty register address >= address, -1 if there is none
+int32_t tmc_dirtyNext(const uint32_t *dirty, uint32_t address)
+{
+	uint32_t word = address >> 5;
+	uint32_t bits;
+
+	if(word >= TMC_DIRTY_WORDS)
+		return -1;
+
+	// Ignore the addresses below the start address in the first word
+	bits = dirty[word] & (UINT32_MAX << (address & 0x1F));
+
+	while(!bits)
+	{
+		if(++word == TMC_DIRTY_WORDS)
+			return -1;
+
+		bits = dirty[word];
+	}
+
+	return (word << 5) | lowestBit(bits);
+}
+
+uint32_t tmc_getRegisterConstant(const TMCRegisterConstant *constants, size_t count, uint8_t address)
+{
+	for(size_t i = 0; (i < count) && (constants[i].address <= address); i++)
+	{
+		if(constants[i].address == address)
+			return constants[i].value;
+	}
+
+	return 0;
+}
+
+#if TMC_FEATURE_SHADOW
+void tmc_fillShadowRegisters(ConfigurationTypeDef *config, const uint8_t *registerAccess, const uint32_t *dirty,
+		const TMCRegisterConstant *constants, size_t count)
+{
+	for(size_t i = 0; i < count; i++)
+	{
+		uint8_t address = constants[i].address;
+
+		if(!TMC_IS_PRESET(registerAccess[address]) || TMC_IS_DIRTY(registerAccess[address]))
+			continue;
+
+		if(dirty && TMC_DIRTY_TEST(dirty, address))
+			continue;
+
+		TMC_SHADOW_REGISTER(config, address) = constants[i].value;
+	}
+}
+#endif
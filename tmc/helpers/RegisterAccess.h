@@ -20,6 +20,11 @@
 #ifndef TMC_HELPERS_REGISTERACCESS_H
 #define TMC_HELPERS_REGISTERACCESS_H
 
+#include <stddef.h>
+#include "Config.h"
+#include "Constants.h"
+#include "Types.h"
+
 // Register access bits
 /* Lower nibble is used for read/write, higher nibble is used for
  * special case registers. This makes it easy to identify the read/write
@@ -55,6 +60,45 @@
 #define TMC_IS_PRESET(x)      ((x) & TMC_ACCESS_HW_PRESET)
 #define TMC_IS_RESETTABLE(x)  (((x) & (TMC_ACCESS_W_PRESET)) == TMC_ACCESS_WRITE) // Write bit set, Hardware preset bit not set
 #define TMC_IS_RESTORABLE(x)  (((x) & TMC_ACCESS_WRITE) && (!(x & TMC_ACCESS_HW_PRESET) || (x & TMC_ACCESS_DIRTY))) // Write bit set, if it's a hardware preset register, it needs to be dirty
+#define TMC_IS_CACHEABLE(x)   (((x) & (TMC_ACCESS_WRITE | TMC_ACCESS_DIRTY | TMC_ACCESS_RW_SPECIAL | TMC_ACCESS_FLAGS)) == (TMC_ACCESS_WRITE | TMC_ACCESS_DIRTY)) // Written before and no special or flag semantics -> shadow register holds the written value
+
+// Dirty bitmap
+// Enable to track the registers written since the last reset in a bitmap of the
+// supporting ICs (TMC5160, TMC2209) instead of the TMC_ACCESS_DIRTY bit.
+// The access permissions are then used directly from the constant default table
+// and a restore only visits the written registers.
+//#define TMC_DIRTY_BITMAP
+
+#define TMC_DIRTY_WORDS  (TMC_REGISTER_COUNT / 32)
+
+// One bitmap word is shared by 32 registers, so setting a bit has to be atomic:
+// A plain read-modify-write interrupted by a write to another register of the
+// same word loses the bit set by the interrupt. Override for cores without
+// atomic instructions (e.g. Cortex-M0), for example by disabling interrupts.
+#ifndef TMC_ATOMIC_OR
+#define TMC_ATOMIC_OR(word, bits)  ((void) __atomic_fetch_or(&(word), (bits), __ATOMIC_RELAXED))
+#endif
+
+#define TMC_DIRTY_SET(dirty, address)   TMC_ATOMIC_OR((dirty)[(address) >> 5], (uint32_t)1 << ((address) & 0x1F))
+#define TMC_DIRTY_TEST(dirty, address)  (((dirty)[(address) >> 5] >> ((address) & 0x1F)) & 1)
+
+void tmc_dirtyClearAll(uint32_t *dirty);
+int32_t tmc_dirtyNext(const uint32_t *dirty, uint32_t address);
+
+// Read cache
+// A register max age table holds one entry per register: the amount of ticks
+// a read value may be reused, 0 disables caching for that register.
+// Flag registers (read to clear) are only cached with TMC_CACHE_ALLOW_FLAGS set.
+#define TMC_CACHE_ALLOW_FLAGS  0x80
+#define TMC_CACHE_MAX_AGE(x)   ((x) & 0x7F)
+
+typedef struct
+{
+	uint8_t address;
+	bool valid;
+	uint32_t tick;
+	int32_t value;
+} TMCReadCacheEntry;
 
 // Struct for listing registers that have constant contents which we cannot
 // obtain by reading them due to the register not being read-back.
@@ -64,6 +108,18 @@ typedef struct
 	uint32_t value;
 } TMCRegisterConstant;
 
+// Value of [address] in a constant list, 0 if it is not listed
+uint32_t tmc_getRegisterConstant(const TMCRegisterConstant *constants, size_t count, uint8_t address);
+
+// Write the register constants of hardware preset registers that have not been
+// written yet (no dirty bit) to the shadow registers. Only the constant list is
+// walked, so this takes one step per constant.
+// With TMC_DIRTY_BITMAP, pass the dirty bitmap of the IC, otherwise NULL.
+#if TMC_FEATURE_SHADOW
+void tmc_fillShadowRegisters(ConfigurationTypeDef *config, const uint8_t *registerAccess, const uint32_t *dirty,
+		const TMCRegisterConstant *constants, size_t count);
+#endif
+
 // Helper define:
 // Most register permission arrays are initialized with 128 values.
 // In those fields its quite hard to have an easy overview of available
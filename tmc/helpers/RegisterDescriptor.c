@@ -0,0 +1,84 @@
+/*
+ * RegisterDescriptor.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RegisterDescriptor.h"
+
+int32_t tmc_field_get(TMCFieldDescriptor field, uint32_t value)
+{
+	uint8_t width = TMC_FIELD_WIDTH(field);
+
+	value = (value & TMC_FIELD_MASK(field)) >> TMC_FIELD_SHIFT(field);
+
+	// Sign extend
+	if(TMC_FIELD_IS_SIGNED(field) && (width < 32) && (value & (1u << (width - 1))))
+		value |= ~0u << width;
+
+	return (int32_t) value;
+}
+
+uint32_t tmc_field_set(TMCFieldDescriptor field, uint32_t value, int32_t fieldValue)
+{
+	uint32_t mask = TMC_FIELD_MASK(field);
+
+	return (value & ~mask) | (((uint32_t) fieldValue << TMC_FIELD_SHIFT(field)) & mask);
+}
+
+size_t tmc_field_find(const TMCFieldDescriptor *fields, size_t count, uint8_t address)
+{
+	size_t low = 0;
+	size_t high = count;
+
+	// Lower bound of the address in the ascending table
+	while(low < high)
+	{
+		size_t middle = (low + high) / 2;
+
+		if(TMC_FIELD_ADDRESS(fields[middle]) < address)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return ((low < count) && (TMC_FIELD_ADDRESS(fields[low]) == address)) ? low : count;
+}
+
+uint32_t tmc_field_clearMask(const TMCFieldDescriptor *fields, size_t count, uint8_t address)
+{
+	uint32_t mask = 0;
+
+	for(size_t i = tmc_field_find(fields, count, address); (i < count) && (TMC_FIELD_ADDRESS(fields[i]) == address); i++)
+	{
+		if(TMC_FIELD_IS_CLEARABLE(fields[i]))
+			mask |= TMC_FIELD_MASK(fields[i]);
+	}
+
+	return mask;
+}
+
+// FNV-1a, the seed selects one of a family of hash functions
+static uint32_t nameHash(const char *name, uint32_t seed)
+{
+	uint32_t hash = 2166136261u ^ seed;
+
+	while(*name)
+	{
+		hash ^= (uint8_t) *name++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+int32_t tmc_field_lookup(const TMCFieldNameIndex *index, const char *name)
+{
+	uint32_t hash = nameHash(name, 0);
+	uint16_t displacement = index->displacements[hash % index->bucketCount];
+	const TMCFieldNameSlot *slot = &index->slots[nameHash(name, displacement + 1u) % index->slotCount];
+
+	// Unknown names also land on some slot
+	return (slot->hash == hash) ? slot->field : -1;
+}
@@ -0,0 +1,75 @@
+/*
+ * RegisterDescriptor.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Packed field descriptors for runtime access to the register fields of an IC.
+ *
+ *  The IC descriptor headers (e.g. TMC5160_Descriptors.h) are generated from the
+ *  field headers and the register access tables. They hold one 32 bit word per
+ *  field, ascending by register address and shift, and an enum naming the index
+ *  of each field:
+ *
+ *    int32_t sgt = tmc_field_get(tmc5160_fieldDescriptors[TMC5160_FIELD_SGT], coolconf);
+ *
+ *  Remote tooling addresses fields by name instead. A generated minimal perfect
+ *  hash maps "REGISTER.FIELD" to the field index in constant time, without
+ *  storing the names: tmc_field_lookup() hashes the name twice (bucket and
+ *  slot) and compares the stored name hash of the slot.
+ *
+ *  The register metadata (access, reset and power-on values) stays in the
+ *  tables of the IC headers.
+ *
+ *  Encoding:
+ *    Bits  0 -  6: Register address
+ *    Bits  7 - 11: Shift
+ *    Bits 12 - 16: Width - 1
+ *    Bit  17:      Signed (two's complement)
+ *    Bit  18:      Write 1 to clear (flag register field)
+ */
+
+#ifndef TMC_HELPERS_REGISTERDESCRIPTOR_H_
+#define TMC_HELPERS_REGISTERDESCRIPTOR_H_
+
+#include "Types.h"
+
+typedef uint32_t TMCFieldDescriptor;
+
+#define TMC_FIELD(address, shift, width, isSigned, isClearable) \
+	((TMCFieldDescriptor) ((address) | ((shift) << 7) | (((width) - 1) << 12) | ((isSigned) << 17) | ((isClearable) << 18)))
+
+#define TMC_FIELD_ADDRESS(field)    ((uint8_t) ((field) & 0x7F))
+#define TMC_FIELD_SHIFT(field)      ((uint8_t) (((field) >> 7) & 0x1F))
+#define TMC_FIELD_WIDTH(field)      ((uint8_t) ((((field) >> 12) & 0x1F) + 1))
+#define TMC_FIELD_IS_SIGNED(field)  (((field) >> 17) & 1)
+#define TMC_FIELD_IS_CLEARABLE(field)  (((field) >> 18) & 1)
+#define TMC_FIELD_MASK(field)       ((uint32_t) ((0xFFFFFFFFu >> (32 - TMC_FIELD_WIDTH(field))) << TMC_FIELD_SHIFT(field)))
+
+typedef struct
+{
+	uint32_t hash;   // FNV-1a hash of the name
+	uint16_t field;  // Index into the descriptor table
+} TMCFieldNameSlot;
+
+typedef struct
+{
+	const uint16_t *displacements;  // Slot hash seed per bucket
+	uint8_t bucketCount;
+	const TMCFieldNameSlot *slots;
+	uint16_t slotCount;
+} TMCFieldNameIndex;
+
+// Index of the field named [name], e.g. "CHOPCONF.TOFF". -1 if it is unknown.
+int32_t tmc_field_lookup(const TMCFieldNameIndex *index, const char *name);
+
+// Field value of a register value, sign extended for signed fields
+int32_t tmc_field_get(TMCFieldDescriptor field, uint32_t value);
+// Register value with the field replaced by [fieldValue]
+uint32_t tmc_field_set(TMCFieldDescriptor field, uint32_t value, int32_t fieldValue);
+// Index of the first field of [address], [count] if the register has no fields
+size_t tmc_field_find(const TMCFieldDescriptor *fields, size_t count, uint8_t address);
+// Mask of the write-to-clear fields of [address]
+uint32_t tmc_field_clearMask(const TMCFieldDescriptor *fields, size_t count, uint8_t address);
+
+#endif /* TMC_HELPERS_REGISTERDESCRIPTOR_H_ */
@@ -0,0 +1,151 @@
+/*
+ * RegisterDriver.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RegisterDriver.h"
+
+#if TMC_FEATURE_CONFIG
+
+void tmc_driver_init(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t channel,
+		uint8_t *registerAccess, int32_t *registerResetState, const int32_t *resetState)
+{
+	config->callback     = NULL;
+	config->channel      = channel;
+	config->configIndex   = 0;
+	config->powerOnReset  = false;
+	config->state         = CONFIG_READY;
+
+	for(size_t i = 0; i < driver->registerCount; i++)
+	{
+		registerAccess[i] = driver->defaultRegisterAccess[i];
+
+		// NULL: The IC references the constant reset state instead of copying it
+		if(registerResetState)
+			registerResetState[i] = resetState[i];
+	}
+}
+
+uint8_t tmc_driver_reset(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t *registerAccess)
+{
+	if(config->state != CONFIG_READY)
+		return false;
+
+	// Reset the dirty bits and wipe the shadow registers
+	for(size_t i = 0; i < driver->registerCount; i++)
+	{
+		registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+		TMC_SHADOW_REGISTER(config, i) = 0;
+	}
+
+	config->state         = CONFIG_RESET;
+	config->configIndex   = 0;
+	config->powerOnReset  = false;
+
+	return true;
+}
+
+// Reset right after the IC powered up: Registers whose reset value matches the
+// power-on value are only set in the shadow registers instead of being written.
+// Falls back to a full reset for ICs without a power-on value list.
+uint8_t tmc_driver_resetFromPowerOn(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t *registerAccess)
+{
+	if(!tmc_driver_reset(driver, config, registerAccess))
+		return false;
+
+	config->powerOnReset = (driver->powerOnValues != NULL);
+
+	return true;
+}
+
+uint8_t tmc_driver_restore(ConfigurationTypeDef *config)
+{
+	if(config->state != CONFIG_READY)
+		return false;
+
+	config->state        = CONFIG_RESTORE;
+	config->configIndex  = 0;
+
+	return true;
+}
+
+void tmc_driver_setRegisterResetState(const TMCRegisterDriver *driver, int32_t *registerResetState, const int32_t *resetState)
+{
+	for(size_t i = 0; i < driver->registerCount; i++)
+		registerResetState[i] = resetState[i];
+}
+
+void tmc_driver_fillShadowRegisters(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, const uint8_t *registerAccess)
+{
+	tmc_fillShadowRegisters(config, registerAccess, NULL, driver->constants, driver->constantCount);
+}
+
+// A register in the power-on state needs no write during a restore: Either the
+// IC lost its configuration and powered up with that value, or it still holds it.
+static bool isPowerOnValue(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t address)
+{
+	if(!driver->powerOnValues)
+		return false;
+
+	return TMC_SHADOW_REGISTER(config, address) == (int32_t) tmc_getRegisterConstant(driver->powerOnValues, driver->powerOnCount, address);
+}
+
+bool tmc_driver_writeConfiguration(const TMCRegisterDriver *driver, void *ic, ConfigurationTypeDef *config,
+		const uint8_t *registerAccess, const int32_t *registerResetState)
+{
+	uint8_t *ptr = &config->configIndex;
+	const uint8_t *registers;
+	size_t registerCount;
+	bool restore = (config->state == CONFIG_RESTORE) && driver->restorableRegisters;
+
+	if(restore)
+	{
+		registers      = driver->restorableRegisters;
+		registerCount  = driver->restorableCount;
+		// Skip hardware preset registers that have not been written yet and
+		// registers holding their power-on value
+		while((*ptr < registerCount)
+				&& (!TMC_IS_RESTORABLE(registerAccess[registers[*ptr]]) || isPowerOnValue(driver, config, registers[*ptr])))
+			(*ptr)++;
+	}
+	else
+	{
+		registers      = driver->resettableRegisters;
+		registerCount  = driver->resettableCount;
+		while(config->powerOnReset && (*ptr < registerCount))
+		{
+			uint8_t address = registers[*ptr];
+
+			if(registerResetState[address] != (int32_t) tmc_getRegisterConstant(driver->powerOnValues, driver->powerOnCount, address))
+				break;
+
+			TMC_SHADOW_REGISTER(config, address) = registerResetState[address];
+			(*ptr)++;
+		}
+	}
+
+	// Finished configuration
+	if(*ptr >= registerCount)
+		return true;
+
+	uint8_t address = registers[*ptr];
+	driver->writeInt(ic, address, (restore) ? TMC_SHADOW_REGISTER(config, address) : registerResetState[address]);
+	(*ptr)++;
+
+	return false;
+}
+
+bool tmc_driver_checkWriteOrder(const TMCRegisterDriver *driver)
+{
+	if(!tmc_writeOrder_check(driver->writeOrder, driver->writeOrderCount, driver->resettableRegisters, driver->resettableCount))
+		return false;
+
+	if(!driver->restorableRegisters)
+		return true;
+
+	return tmc_writeOrder_check(driver->writeOrder, driver->writeOrderCount, driver->restorableRegisters, driver->restorableCount);
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * RegisterDriver.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Generic core of the register based IC drivers.
+ *  The init, reset, restore and configuration mechanism is the same for all
+ *  ICs with a shadow register copy, a register access table and a register
+ *  reset state. The IC files describe themselves with a constant
+ *  TMCRegisterDriver and keep their public functions as thin wrappers.
+ */
+
+#ifndef TMC_HELPERS_REGISTERDRIVER_H_
+#define TMC_HELPERS_REGISTERDRIVER_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "Config.h"
+#include "RegisterAccess.h"
+#include "WriteOrder.h"
+
+// Register write of the IC, called with the IC struct passed to the core
+typedef void (*tmc_driver_writeInt)(void *ic, uint8_t address, int32_t value);
+
+typedef struct
+{
+	uint8_t registerCount;
+	const uint8_t *defaultRegisterAccess;
+	const uint8_t *resettableRegisters;
+	uint8_t resettableCount;
+	const uint8_t *restorableRegisters; // NULL: a restore writes the reset state
+	uint8_t restorableCount;
+	const TMCRegisterConstant *constants;
+	uint8_t constantCount;
+	const TMCRegisterConstant *powerOnValues; // Non-zero power-on values, NULL: unknown. A restore skips registers holding them.
+	uint8_t powerOnCount;
+	const TMCWriteOrder *writeOrder; // Write order constraints, NULL: none. See WriteOrder.h.
+	uint8_t writeOrderCount;
+	tmc_driver_writeInt writeInt;
+} TMCRegisterDriver;
+
+void tmc_driver_init(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t channel,
+		uint8_t *registerAccess, int32_t *registerResetState, const int32_t *resetState);
+uint8_t tmc_driver_reset(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t *registerAccess);
+uint8_t tmc_driver_resetFromPowerOn(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, uint8_t *registerAccess);
+uint8_t tmc_driver_restore(ConfigurationTypeDef *config);
+void tmc_driver_setRegisterResetState(const TMCRegisterDriver *driver, int32_t *registerResetState, const int32_t *resetState);
+void tmc_driver_fillShadowRegisters(const TMCRegisterDriver *driver, ConfigurationTypeDef *config, const uint8_t *registerAccess);
+
+// Configure the next register of a reset or restore.
+// Returns true once all registers are written. The IC then calls its callback
+// and sets the configuration state to CONFIG_READY.
+bool tmc_driver_writeConfiguration(const TMCRegisterDriver *driver, void *ic, ConfigurationTypeDef *config,
+		const uint8_t *registerAccess, const int32_t *registerResetState);
+
+// Returns true if the reset and restore register lists respect the write order
+// constraints of the driver. The configuration walks the lists in their order,
+// skipping registers never changes it.
+bool tmc_driver_checkWriteOrder(const TMCRegisterDriver *driver);
+
+#endif /* TMC_HELPERS_REGISTERDRIVER_H_ */
@@ -0,0 +1,216 @@
+/*
+ * RegisterImage.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RegisterImage.h"
+#include "RegisterAccess.h"
+#include "Bits.h"
+
+#if TMC_FEATURE_CONFIG
+
+// Bitwise CRC, images are only checked once at boot - no table needed
+static uint16_t crc16(const uint8_t *data, size_t length)
+{
+	uint16_t crc = 0xFFFF;
+	size_t i;
+	uint8_t bit;
+
+	for(i = 0; i < length; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+		for(bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+
+	return crc;
+}
+
+static bool isDirty(const uint8_t *registerAccess, const uint32_t *dirty, uint8_t address)
+{
+	if(!TMC_IS_WRITABLE(registerAccess[address]))
+		return false;
+
+	return (dirty) ? TMC_DIRTY_TEST(dirty, address) : TMC_IS_DIRTY(registerAccess[address]);
+}
+
+size_t tmc_image_save(const ConfigurationTypeDef *config, const uint8_t *registerAccess, const uint32_t *dirty,
+		uint8_t registerCount, uint16_t id, uint8_t *image, size_t size)
+{
+	size_t length = 5;
+	uint8_t count = 0;
+	uint8_t address;
+	uint16_t crc;
+
+	if(size < TMC_IMAGE_SIZE(0))
+		return 0;
+
+	for(address = 0; address < registerCount; address++)
+	{
+		if(!isDirty(registerAccess, dirty, address))
+			continue;
+
+		if(length + 5 + 2 > size)
+			return 0;
+
+		uint32_t value = TMC_SHADOW_REGISTER(config, address);
+
+		image[length++] = address;
+		image[length++] = BYTE(value, 0);
+		image[length++] = BYTE(value, 1);
+		image[length++] = BYTE(value, 2);
+		image[length++] = BYTE(value, 3);
+		count++;
+	}
+
+	image[0] = TMC_IMAGE_MAGIC;
+	image[1] = TMC_IMAGE_VERSION;
+	image[2] = BYTE(id, 0);
+	image[3] = BYTE(id, 1);
+	image[4] = count;
+
+	crc = crc16(image, length);
+	image[length++] = BYTE(crc, 0);
+	image[length++] = BYTE(crc, 1);
+
+	return length;
+}
+
+// Check the framing shared by register images and reset state blobs
+static bool checkFrame(const uint8_t *image, size_t size, uint8_t magic, uint16_t id, uint8_t registerCount)
+{
+	size_t length, i;
+	uint8_t count;
+
+	if(size < TMC_IMAGE_SIZE(0))
+		return false;
+
+	if((image[0] != magic) || (image[1] != TMC_IMAGE_VERSION)
+	|| (image[2] != BYTE(id, 0)) || (image[3] != BYTE(id, 1)))
+		return false;
+
+	count = image[4];
+	length = TMC_IMAGE_SIZE(count);
+	if(length > size)
+		return false;
+
+	if(crc16(image, length - 2) != (image[length - 2] | ((uint16_t)image[length - 1] << 8)))
+		return false;
+
+	for(i = 0; i < count; i++)
+		if(image[5 + 5 * i] >= registerCount)
+			return false;
+
+	return true;
+}
+
+static uint32_t entryValue(const uint8_t *entry)
+{
+	return ((uint32_t)entry[4] << 24) | ((uint32_t)entry[3] << 16) | ((uint32_t)entry[2] << 8) | entry[1];
+}
+
+bool tmc_image_check(const uint8_t *image, size_t size, uint16_t id, uint8_t registerCount)
+{
+	return checkFrame(image, size, TMC_IMAGE_MAGIC, id, registerCount);
+}
+
+bool tmc_image_load(const uint8_t *image, size_t size, uint16_t id,
+		ConfigurationTypeDef *config, uint8_t *registerAccess, uint32_t *dirty, uint8_t registerCount)
+{
+	size_t i;
+
+	if(!tmc_image_check(image, size, id, registerCount))
+		return false;
+
+	for(i = 0; i < image[4]; i++)
+	{
+		const uint8_t *entry = &image[5 + 5 * i];
+		uint8_t address = entry[0];
+
+		TMC_SHADOW_REGISTER(config, address) = entryValue(entry);
+
+		if(dirty)
+			TMC_DIRTY_SET(dirty, address);
+		else
+			registerAccess[address] |= TMC_ACCESS_DIRTY;
+	}
+
+	return true;
+}
+
+size_t tmc_resetBlob_build(const int32_t *resetState, const int32_t *defaults, uint8_t registerCount, uint16_t id, uint8_t *blob, size_t size)
+{
+	size_t length = 5;
+	uint8_t count = 0;
+	uint8_t address;
+	uint16_t crc;
+
+	if(size < TMC_IMAGE_SIZE(0))
+		return 0;
+
+	for(address = 0; address < registerCount; address++)
+	{
+		uint32_t value = resetState[address];
+
+		if(value == (uint32_t) defaults[address])
+			continue;
+
+		if(length + 5 + 2 > size)
+			return 0;
+
+		blob[length++] = address;
+		blob[length++] = BYTE(value, 0);
+		blob[length++] = BYTE(value, 1);
+		blob[length++] = BYTE(value, 2);
+		blob[length++] = BYTE(value, 3);
+		count++;
+	}
+
+	blob[0] = TMC_RESET_BLOB_MAGIC;
+	blob[1] = TMC_IMAGE_VERSION;
+	blob[2] = BYTE(id, 0);
+	blob[3] = BYTE(id, 1);
+	blob[4] = count;
+
+	crc = crc16(blob, length);
+	blob[length++] = BYTE(crc, 0);
+	blob[length++] = BYTE(crc, 1);
+
+	return length;
+}
+
+bool tmc_resetBlob_check(const uint8_t *blob, size_t size, uint16_t id, uint8_t registerCount)
+{
+	return checkFrame(blob, size, TMC_RESET_BLOB_MAGIC, id, registerCount);
+}
+
+bool tmc_resetBlob_apply(const uint8_t *blob, size_t size, uint16_t id, int32_t *resetState, uint8_t registerCount)
+{
+	size_t i;
+
+	if(!tmc_resetBlob_check(blob, size, id, registerCount))
+		return false;
+
+	for(i = 0; i < blob[4]; i++)
+		resetState[blob[5 + 5 * i]] = entryValue(&blob[5 + 5 * i]);
+
+	return true;
+}
+
+bool tmc_resetBlob_load(const uint8_t *blob, size_t size, uint16_t id, TMCResetStateTypeDef *state, uint8_t registerCount)
+{
+	size_t i;
+
+	if(!tmc_resetBlob_check(blob, size, id, registerCount) || (blob[4] > TMC_RESET_STATE_OVERRIDES))
+		return false;
+
+	state->count = 0;
+	for(i = 0; i < blob[4]; i++)
+		tmc_resetState_set(state, blob[5 + 5 * i], entryValue(&blob[5 + 5 * i]));
+
+	return true;
+}
+
+#endif
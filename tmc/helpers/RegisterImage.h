@@ -0,0 +1,72 @@
+/*
+ * RegisterImage.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Persistent snapshot of the written configuration of an IC.
+ *
+ *  The image holds the registers written since the last reset (dirty registers)
+ *  and is meant to be stored in flash or EEPROM provided by the application.
+ *  After an MCU reset, loading the image sets up the shadow registers and dirty
+ *  tracking again, so the regular restore mechanism of the IC can write the
+ *  configuration back in one burst (e.g. tmc5160_configureBurst(tmc5160, 0)),
+ *  instead of running the reset and the application configuration again.
+ *
+ *  Layout, multi-byte values little endian:
+ *    0      TMC_IMAGE_MAGIC
+ *    1      TMC_IMAGE_VERSION
+ *    2..3   IC id, chosen by the driver (e.g. 5160)
+ *    4      Amount of registers n
+ *    5..    n entries: address (1 byte), value (4 bytes)
+ *    last   CRC16 (CCITT, polynomial 0x1021, init 0xFFFF) of all preceding bytes
+ *
+ *  Reset state blobs use the same layout with TMC_RESET_BLOB_MAGIC. Their
+ *  entries are the reset values differing from the default reset table of the
+ *  IC, so per-machine tuning of a few registers takes a few bytes in flash or
+ *  in a host download instead of a 512 byte reset table.
+ */
+
+#ifndef TMC_HELPERS_REGISTERIMAGE_H_
+#define TMC_HELPERS_REGISTERIMAGE_H_
+
+#include "Types.h"
+#include "Config.h"
+#include "ResetState.h"
+
+#define TMC_IMAGE_MAGIC    0x54 // 'T'
+#define TMC_IMAGE_VERSION  1
+
+#define TMC_RESET_BLOB_MAGIC  0x52 // 'R'
+
+// Size of an image holding [count] registers
+#define TMC_IMAGE_SIZE(count)  (5 + 5 * (count) + 2)
+
+// Write the image of the dirty writable registers to [image].
+// With TMC_DIRTY_BITMAP, pass the dirty bitmap of the IC, otherwise NULL.
+// Returns the size of the image, 0 if it does not fit into [size] bytes.
+size_t tmc_image_save(const ConfigurationTypeDef *config, const uint8_t *registerAccess, const uint32_t *dirty,
+		uint8_t registerCount, uint16_t id, uint8_t *image, size_t size);
+
+// Returns true if the image is intact and belongs to the IC [id]
+bool tmc_image_check(const uint8_t *image, size_t size, uint16_t id, uint8_t registerCount);
+
+// Check the image and copy its values to the shadow registers, marking them dirty.
+// With TMC_DIRTY_BITMAP, pass the dirty bitmap of the IC and NULL as registerAccess,
+// otherwise the register access array of the IC and NULL as dirty.
+// Nothing is changed if the image is invalid or belongs to a different IC.
+// Returns false if the image was rejected.
+bool tmc_image_load(const uint8_t *image, size_t size, uint16_t id,
+		ConfigurationTypeDef *config, uint8_t *registerAccess, uint32_t *dirty, uint8_t registerCount);
+
+// Build a reset state blob of the values of [resetState] that differ from [defaults].
+// Returns the size of the blob, 0 if it does not fit into [size] bytes.
+size_t tmc_resetBlob_build(const int32_t *resetState, const int32_t *defaults, uint8_t registerCount, uint16_t id, uint8_t *blob, size_t size);
+bool tmc_resetBlob_check(const uint8_t *blob, size_t size, uint16_t id, uint8_t registerCount);
+// Write the values of the blob into a full reset table
+bool tmc_resetBlob_apply(const uint8_t *blob, size_t size, uint16_t id, int32_t *resetState, uint8_t registerCount);
+// Replace the overrides of a compact reset state (TMC_RESET_STATE_CONST) with the values
+// of the blob. The blob is rejected if it holds more than TMC_RESET_STATE_OVERRIDES values.
+bool tmc_resetBlob_load(const uint8_t *blob, size_t size, uint16_t id, TMCResetStateTypeDef *state, uint8_t registerCount);
+
+#endif /* TMC_HELPERS_REGISTERIMAGE_H_ */
@@ -0,0 +1,163 @@
+/*
+ * RegisterLog.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RegisterLog.h"
+#include "Macros.h"
+
+// Unsigned LEB128: 7 bits per byte, least significant group first
+static uint8_t *putVarint(uint8_t *data, uint8_t *end, uint32_t value)
+{
+	do
+	{
+		if(data >= end)
+			return NULL;
+
+		*data++ = (value & 0x7F) | ((value > 0x7F) ? 0x80 : 0);
+		value >>= 7;
+	} while(value);
+
+	return data;
+}
+
+static const uint8_t *getVarint(const uint8_t *data, const uint8_t *end, uint32_t *value)
+{
+	uint8_t shift;
+
+	*value = 0;
+
+	for(shift = 0; shift < 35; shift += 7)
+	{
+		if(data >= end)
+			return NULL;
+
+		*value |= (uint32_t) (*data & 0x7F) << shift;
+
+		if(!(*data++ & 0x80))
+			return data;
+	}
+
+	return NULL;
+}
+
+void tmc_log_initEncoder(TMCRegisterLogEncoder *encoder, uint8_t count, uint16_t keyframeInterval)
+{
+	encoder->count             = MIN(count, TMC_REGISTER_COUNT);
+	encoder->keyframeInterval  = keyframeInterval;
+	encoder->sinceKeyframe     = 0;
+	encoder->keyframe          = true;
+
+	for(uint8_t i = 0; i < TMC_REGISTER_COUNT; i++)
+		encoder->previous[i] = 0;
+}
+
+void tmc_log_requestKeyframe(TMCRegisterLogEncoder *encoder)
+{
+	encoder->keyframe = true;
+}
+
+size_t tmc_log_encode(TMCRegisterLogEncoder *encoder, const int32_t *values, uint8_t *record, size_t size)
+{
+	uint8_t *end = record + size;
+	uint8_t *data;
+	bool keyframe = encoder->keyframe
+			|| (encoder->keyframeInterval && (encoder->sinceKeyframe >= encoder->keyframeInterval));
+	uint8_t entries = 0;
+	int16_t last = -1;
+	uint8_t i;
+
+	for(i = 0; i < encoder->count; i++)
+	{
+		if(values[i] != (keyframe ? 0 : encoder->previous[i]))
+			entries++;
+	}
+
+	if(size < 1)
+		return 0;
+
+	record[0] = keyframe ? TMC_LOG_KEYFRAME : 0;
+	data = putVarint(&record[1], end, entries);
+
+	for(i = 0; data && (i < encoder->count); i++)
+	{
+		uint32_t difference = values[i] ^ (keyframe ? 0 : encoder->previous[i]);
+
+		if(!difference)
+			continue;
+
+		data = putVarint(data, end, i - last - 1);
+		if(data)
+			data = putVarint(data, end, difference);
+		last = i;
+	}
+
+	if(!data)
+		return 0;
+
+	// Only a complete record becomes the new base
+	for(i = 0; i < encoder->count; i++)
+		encoder->previous[i] = values[i];
+
+	encoder->keyframe = false;
+	encoder->sinceKeyframe = keyframe ? 0 : encoder->sinceKeyframe + 1;
+
+	return data - record;
+}
+
+void tmc_log_initDecoder(TMCRegisterLogDecoder *decoder, uint8_t count)
+{
+	decoder->count   = MIN(count, TMC_REGISTER_COUNT);
+	decoder->synced  = false;
+
+	for(uint8_t i = 0; i < TMC_REGISTER_COUNT; i++)
+		decoder->values[i] = 0;
+}
+
+size_t tmc_log_decode(TMCRegisterLogDecoder *decoder, const uint8_t *record, size_t length)
+{
+	const uint8_t *end = record + length;
+	const uint8_t *data;
+	uint32_t entries, gap, difference;
+	int32_t values[TMC_REGISTER_COUNT];
+	uint32_t address = 0;
+	bool keyframe;
+
+	if(length < 2)
+		return 0;
+
+	keyframe = record[0] & TMC_LOG_KEYFRAME;
+	data = getVarint(&record[1], end, &entries);
+
+	for(uint8_t i = 0; i < TMC_REGISTER_COUNT; i++)
+		values[i] = keyframe ? 0 : decoder->values[i];
+
+	for(uint32_t i = 0; data && (i < entries); i++)
+	{
+		data = getVarint(data, end, &gap);
+		if(data)
+			data = getVarint(data, end, &difference);
+
+		address += gap;
+		if(!data || (address >= decoder->count))
+			return 0;
+
+		values[address++] ^= difference;
+	}
+
+	if(!data)
+		return 0;
+
+	// Deltas are meaningless without a base
+	if(keyframe || decoder->synced)
+	{
+		for(uint8_t i = 0; i < TMC_REGISTER_COUNT; i++)
+			decoder->values[i] = values[i];
+
+		decoder->synced = true;
+	}
+
+	return data - record;
+}
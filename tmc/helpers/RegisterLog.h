@@ -0,0 +1,61 @@
+/*
+ * RegisterLog.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Delta compressed register snapshots for diagnostic logging.
+ *
+ *  The encoder keeps the previous snapshot of one IC and emits a record with
+ *  only the registers changed since. Every keyframeInterval records (and after
+ *  tmc_log_requestKeyframe()) a keyframe holding all non-zero registers is
+ *  emitted instead, so a decoder can start in the middle of a log.
+ *
+ *  Record:  header, varint entry count, entries...
+ *  Entry:   varint address gap (address - previous entry address - 1),
+ *           varint (value XOR previous value)
+ *  Header:  TMC_LOG_KEYFRAME for a keyframe (XOR against an all zero map)
+ *
+ *  The decoder is plain C as well, so the same file builds the host tool.
+ */
+
+#ifndef TMC_HELPERS_REGISTERLOG_H_
+#define TMC_HELPERS_REGISTERLOG_H_
+
+#include "Types.h"
+#include "Constants.h"
+
+#define TMC_LOG_KEYFRAME 0x01
+
+// Largest record of [count] registers: header, entry count and 6 bytes per entry
+#define TMC_LOG_RECORD_MAX(count) (3 + 6 * (count))
+
+typedef struct
+{
+	int32_t previous[TMC_REGISTER_COUNT];
+	uint8_t count;             // Registers per snapshot, addresses 0 to count - 1
+	uint16_t keyframeInterval; // Records between keyframes, 0: only the first and requested ones
+	uint16_t sinceKeyframe;
+	bool keyframe;             // Next record is a keyframe
+} TMCRegisterLogEncoder;
+
+typedef struct
+{
+	int32_t values[TMC_REGISTER_COUNT]; // The reconstructed register map
+	uint8_t count;
+	bool synced;                        // A keyframe has been decoded
+} TMCRegisterLogDecoder;
+
+void tmc_log_initEncoder(TMCRegisterLogEncoder *encoder, uint8_t count, uint16_t keyframeInterval);
+void tmc_log_requestKeyframe(TMCRegisterLogEncoder *encoder);
+// Encode the snapshot [values] (count registers) into [record].
+// Returns the record length, 0 if it does not fit into [size]. The snapshot then is not
+// taken as the new base and the next call encodes against the same previous snapshot.
+size_t tmc_log_encode(TMCRegisterLogEncoder *encoder, const int32_t *values, uint8_t *record, size_t size);
+
+void tmc_log_initDecoder(TMCRegisterLogDecoder *decoder, uint8_t count);
+// Apply one record to the map. Delta records before the first keyframe are skipped.
+// Returns the length of the record, 0 if it is malformed or truncated.
+size_t tmc_log_decode(TMCRegisterLogDecoder *decoder, const uint8_t *record, size_t length);
+
+#endif /* TMC_HELPERS_REGISTERLOG_H_ */
@@ -0,0 +1,60 @@
+/*
+ * RegisterView.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "RegisterView.h"
+#include "Macros.h"
+
+void tmc_view_init(TMCRegisterView *view, uint16_t id, uint8_t registerCount, const uint8_t *access)
+{
+	uint8_t i;
+
+	view->sequence = 1;
+	TMC_MEMORY_BARRIER();
+
+	view->magic          = TMC_VIEW_MAGIC;
+	view->version        = TMC_VIEW_VERSION;
+	view->id             = id;
+	view->size           = sizeof(TMCRegisterView);
+	view->registerCount  = MIN(registerCount, TMC_REGISTER_COUNT);
+	view->reserved       = 0;
+
+	for(i = 0; i < TMC_REGISTER_COUNT / 32; i++)
+	{
+		view->valid[i]    = 0;
+		view->written[i]  = 0;
+	}
+
+	for(i = 0; i < TMC_REGISTER_COUNT; i++)
+	{
+		view->values[i] = 0;
+		view->access[i] = (i < view->registerCount) ? access[i] : 0;
+	}
+
+	TMC_MEMORY_BARRIER();
+	view->sequence = 2;
+}
+
+void tmc_view_store(TMCRegisterView *view, uint8_t address, int32_t value, bool written)
+{
+	uint32_t bit = 1u << (address % 32);
+
+	if(address >= view->registerCount)
+		return;
+
+	view->sequence++;
+	TMC_MEMORY_BARRIER();
+
+	view->values[address] = value;
+	view->valid[address / 32] |= bit;
+	if(written)
+		view->written[address / 32] |= bit;
+	else
+		view->written[address / 32] &= ~bit;
+
+	TMC_MEMORY_BARRIER();
+	view->sequence++;
+}
@@ -0,0 +1,60 @@
+/*
+ * RegisterView.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Register view of an IC in memory, for debug probes and host tools.
+ *
+ *  With TMC_FEATURE_VIEW, the supporting drivers (TMC5160) store every value
+ *  written to or read from the IC in an attached view. A probe or tool reads
+ *  the whole state with one memory read, e.g. from the address of the view
+ *  symbol in the map file. The layout is fixed and free of padding, the
+ *  header identifies the IC and version for the tools:
+ *
+ *    Offset  Size  Content
+ *    0       4     TMC_VIEW_MAGIC
+ *    4       2     TMC_VIEW_VERSION
+ *    6       2     IC id (e.g. 5160, same as the register images)
+ *    8       2     Size of the view in bytes
+ *    10      1     Amount of registers n
+ *    11      1     Reserved
+ *    12      4     Sequence, odd while the driver updates the view
+ *    16      16    Valid bitmap, register holds a value
+ *    32      16    Written bitmap, value was written (else read)
+ *    48      4*n   Values
+ *    48+4*n  n     Register access table (RegisterAccess.h)
+ *
+ *  Multi byte values are in the byte order of the MCU. Copies taken while the
+ *  sequence was odd or changed during the copy have to be retried.
+ */
+
+#ifndef TMC_HELPERS_REGISTERVIEW_H_
+#define TMC_HELPERS_REGISTERVIEW_H_
+
+#include "Types.h"
+#include "Constants.h"
+
+#define TMC_VIEW_MAGIC    0x56434D54 // "TMCV" in memory on little endian MCUs
+#define TMC_VIEW_VERSION  1
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t id;
+	uint16_t size;
+	uint8_t registerCount;
+	uint8_t reserved;
+	volatile uint32_t sequence;
+	volatile uint32_t valid[TMC_REGISTER_COUNT / 32];
+	volatile uint32_t written[TMC_REGISTER_COUNT / 32];
+	volatile int32_t values[TMC_REGISTER_COUNT];
+	uint8_t access[TMC_REGISTER_COUNT];
+} TMCRegisterView;
+
+void tmc_view_init(TMCRegisterView *view, uint16_t id, uint8_t registerCount, const uint8_t *access);
+// Store a value read from or written to the IC
+void tmc_view_store(TMCRegisterView *view, uint8_t address, int32_t value, bool written);
+
+#endif /* TMC_HELPERS_REGISTERVIEW_H_ */
@@ -0,0 +1,128 @@
+/*
+ * ResetState.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "ResetState.h"
+
+void tmc_resetState_init(TMCResetStateTypeDef *state, const int32_t *table)
+{
+	state->table      = table;
+	state->diff       = NULL;
+	state->diffCount  = 0;
+	state->count      = 0;
+}
+
+// Constant reset value of an address: The diff list entry or the table value
+static int32_t baseValue(const TMCResetStateTypeDef *state, uint8_t address)
+{
+	uint8_t i;
+
+	for(i = 0; (i < state->diffCount) && (state->diff[i].address <= address); i++)
+	{
+		if(state->diff[i].address == address)
+			return (int32_t) state->diff[i].value;
+	}
+
+	return state->table[address];
+}
+
+// Use a constant list of values differing from the table, e.g. composed with
+// TMC_RESET_OVERRIDE(). The list has to stay valid, previous overrides are dropped.
+void tmc_resetState_setDiff(TMCResetStateTypeDef *state, const TMCRegisterConstant *diff, size_t count)
+{
+	state->diff       = diff;
+	state->diffCount  = count;
+	state->count      = 0;
+}
+
+// Change a single reset value.
+// Returns false if the value differs from the table and the override list is full.
+bool tmc_resetState_set(TMCResetStateTypeDef *state, uint8_t address, int32_t value)
+{
+	uint8_t i, j;
+
+	// Find the position of the address in the sorted override list
+	for(i = 0; (i < state->count) && (state->overrides[i].address < address); i++);
+
+	if((i < state->count) && (state->overrides[i].address == address))
+	{
+		if(value != baseValue(state, address))
+		{
+			state->overrides[i].value = value;
+			return true;
+		}
+
+		// Back to the constant value - drop the override
+		state->count--;
+		for(j = i; j < state->count; j++)
+			state->overrides[j] = state->overrides[j+1];
+
+		return true;
+	}
+
+	// Unchanged value - nothing to store
+	if(value == baseValue(state, address))
+		return true;
+
+	if(state->count == TMC_RESET_STATE_OVERRIDES)
+		return false;
+
+	for(j = state->count; j > i; j--)
+		state->overrides[j] = state->overrides[j-1];
+
+	state->overrides[i].address  = address;
+	state->overrides[i].value    = value;
+	state->count++;
+
+	return true;
+}
+
+// Change all reset values.
+// Values that differ from the table (or diff list) are stored as overrides. If more values
+// differ than fit the override list, resetState becomes the new table instead,
+// in that case it has to stay valid.
+void tmc_resetState_setAll(TMCResetStateTypeDef *state, const int32_t *resetState, size_t count)
+{
+	size_t i;
+	uint8_t changes = 0;
+
+	if(resetState == state->table)
+	{
+		tmc_resetState_init(state, resetState);
+		return;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		if(resetState[i] == baseValue(state, i))
+			continue;
+
+		if(changes == TMC_RESET_STATE_OVERRIDES)
+		{
+			tmc_resetState_init(state, resetState);
+			return;
+		}
+
+		state->overrides[changes].address  = i;
+		state->overrides[changes].value    = resetState[i];
+		changes++;
+	}
+
+	state->count = changes;
+}
+
+int32_t tmc_resetState_get(const TMCResetStateTypeDef *state, uint8_t address)
+{
+	uint8_t i;
+
+	for(i = 0; (i < state->count) && (state->overrides[i].address <= address); i++)
+	{
+		if(state->overrides[i].address == address)
+			return state->overrides[i].value;
+	}
+
+	return baseValue(state, address);
+}
@@ -0,0 +1,76 @@
+/*
+ * ResetState.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Compact storage for the register reset values of an IC.
+ *  Instead of a 128 entry copy per IC, the reset state points to a constant
+ *  table (e.g. the default reset values in flash) and only holds the values
+ *  that differ from it in a small override list.
+ *
+ *  Customized reset values can be composed from named fields at compile time,
+ *  so they end up in flash without hand-computed constants or a RAM copy:
+ *
+ *    static const TMCRegisterConstant resetDiff[] =
+ *    {
+ *        TMC_RESET_OVERRIDE(TMC5160_CHOPCONF, TMC5160_RESET_CHOPCONF,
+ *                TMC_RESET_MASK(TMC5160_TOFF) | TMC_RESET_MASK(TMC5160_TBL),
+ *                TMC_RESET_FIELD(TMC5160_TOFF, 5) | TMC_RESET_FIELD(TMC5160_TBL, 2)),
+ *    };
+ *
+ *  A field value that does not fit its mask fails to compile. The same macros
+ *  can initialize a complete table with designated initializers instead. A
+ *  constant diff list is used with tmc_resetState_setDiff(): The reset state
+ *  then only keeps a pointer to it, on top of the default table.
+ */
+
+#ifndef TMC_HELPERS_RESETSTATE_H_
+#define TMC_HELPERS_RESETSTATE_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "RegisterAccess.h"
+#include "Macros.h"
+
+// Enable to replace the registerResetState array of the supporting ICs
+// (TMC5160, TMC5072, TMC4361A, TMC2209) with a TMCResetStateTypeDef.
+// The table passed to init and setRegisterResetState then has to stay valid.
+//#define TMC_RESET_STATE_CONST
+
+// Amount of reset values that can differ from the constant table
+#define TMC_RESET_STATE_OVERRIDES 8
+
+// Value of [value] in a field given by its mask and shift.
+// The array size turns negative and fails to compile if [value] does not fit the field.
+#define TMC_FIELD_CHECKED(mask, shift, value) \
+	(0 * sizeof(char[((uint32_t) (value) & ~((uint32_t) (mask) >> (shift))) ? -1 : 1]) \
+		+ FIELD_VALUE((uint32_t) (mask), shift, (uint32_t) (value)))
+
+// Named field of the Fields.h headers, e.g. TMC_RESET_FIELD(TMC5160_TOFF, 3)
+#define TMC_RESET_FIELD(field, value)  TMC_FIELD_CHECKED(field##_MASK, field##_SHIFT, value)
+#define TMC_RESET_MASK(field)          ((uint32_t) field##_MASK)
+
+// Replace the fields in [masks] of [resetValue] with [values]
+#define TMC_RESET_COMPOSE(resetValue, masks, values)  ((int32_t) FIELDS_SET((uint32_t) (resetValue), (masks), (values)))
+
+// Entry of a constant diff list
+#define TMC_RESET_OVERRIDE(address, resetValue, masks, values) \
+	{ (address), (uint32_t) TMC_RESET_COMPOSE(resetValue, masks, values) }
+
+typedef struct
+{
+	const int32_t *table;  // Constant reset values
+	const TMCRegisterConstant *diff; // Constant values replacing table entries, NULL: none. Use ascending addresses!
+	uint8_t diffCount;
+	uint8_t count;         // Used override entries
+	TMCRegisterConstant overrides[TMC_RESET_STATE_OVERRIDES]; // Use ascending addresses!
+} TMCResetStateTypeDef;
+
+void tmc_resetState_init(TMCResetStateTypeDef *state, const int32_t *table);
+void tmc_resetState_setDiff(TMCResetStateTypeDef *state, const TMCRegisterConstant *diff, size_t count);
+bool tmc_resetState_set(TMCResetStateTypeDef *state, uint8_t address, int32_t value);
+void tmc_resetState_setAll(TMCResetStateTypeDef *state, const int32_t *resetState, size_t count);
+int32_t tmc_resetState_get(const TMCResetStateTypeDef *state, uint8_t address);
+
+#endif /* TMC_HELPERS_RESETSTATE_H_ */
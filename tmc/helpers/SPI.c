@@ -0,0 +1,90 @@
+/*
+ * SPI.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "SPI.h"
+#include "Constants.h"
+#include "Macros.h"
+#include "Bits.h"
+#include "ByteOrder.h"
+#include "Lock.h"
+#include "RegisterAccess.h"
+
+static void transfer(const TMCSpiInterface *spi, uint8_t channel, uint8_t *data)
+{
+	TMC_INSTRUMENT_SPI(spi->name, spi->readWriteArray, channel, data, TMC_SPI_DATAGRAM_LENGTH);
+}
+
+static int32_t replyValue(const uint8_t *data)
+{
+	return tmc_unpackInt32(&data[1]);
+}
+
+void tmc_spi_writeInt(const TMCSpiInterface *spi, uint8_t channel, uint8_t address, int32_t value)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH] = { address | TMC_WRITE_BIT, BYTE(value, 3), BYTE(value, 2), BYTE(value, 1), BYTE(value, 0) };
+
+	TMC_LOCK(channel);
+	transfer(spi, channel, data);
+	TMC_UNLOCK(channel);
+}
+
+int32_t tmc_spi_readInt(const TMCSpiInterface *spi, uint8_t channel, uint8_t address)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH] = { TMC_ADDRESS(address), 0, 0, 0, 0 };
+
+	TMC_LOCK(channel);
+	transfer(spi, channel, data);
+
+	data[0] = TMC_ADDRESS(address);
+	data[1] = data[2] = data[3] = data[4] = 0;
+	transfer(spi, channel, data);
+	TMC_UNLOCK(channel);
+
+	return replyValue(data);
+}
+
+void tmc_spi_readIntBatch(const TMCSpiInterface *spi, ConfigurationTypeDef *config, const uint8_t *registerAccess,
+		const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t channel = config->channel;
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	TMC_LOCK(channel);
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		if(registerAccess && !TMC_IS_READABLE(registerAccess[address]))
+		{
+			values[i] = TMC_SHADOW_REGISTER(config, address);
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		transfer(spi, channel, data);
+
+		if(pending < count)
+			values[pending] = replyValue(data);
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		transfer(spi, channel, data);
+		values[pending] = replyValue(data);
+	}
+
+	TMC_UNLOCK(channel);
+}
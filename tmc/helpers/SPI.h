@@ -0,0 +1,120 @@
+/*
+ * SPI.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Datagram engine of the 40 bit SPI interface shared by the SPI ICs.
+ *
+ *  Every datagram is an address byte (MSB set for writes) and 4 data bytes,
+ *  MSB first. The reply to a read request is only sent with the following
+ *  datagram, so a single read takes two transfers. tmc_spi_readIntBatch()
+ *  pipelines the requests: Each one clocks out the reply of the previous one,
+ *  reading [count] registers with count+1 transfers.
+ *
+ *  The first byte of every reply is the SPI_STATUS of the IC (reset flag,
+ *  driver error, StallGuard, standstill and on the TMC5xxx the ramp flags).
+ *  Drivers supporting it (TMC5160, TMC5130, TMC2130) keep the last one in a
+ *  TMCSpiStatus, so it is available without a GSTAT or RAMP_STAT read. The
+ *  optional callback is called for the flags in [edgeMask] that got set.
+ *  Define TMC_SPI_STATUS_TIMESTAMP() (e.g. as systick_getTick()) to stamp the
+ *  captures, otherwise [tick] counts them.
+ *
+ *  Sample timestamps
+ *  Define TMC_SAMPLE_TIMESTAMP() as a free running high resolution timer (e.g. a
+ *  1 MHz timer counter) and TMC_SAMPLE_TIMESTAMP_PER_MS as its counts per
+ *  millisecond. Drivers supporting it (TMC5160) then stamp their register reads
+ *  with the time the read request was sent, when the IC latches the value.
+ *  The velocity estimate and the telemetry use that instant instead of the tick
+ *  of the periodic job, which is off by the bus contention in between. It also
+ *  stamps the status captures, unless TMC_SPI_STATUS_TIMESTAMP() is defined.
+ */
+
+#ifndef TMC_HELPERS_SPI_H_
+#define TMC_HELPERS_SPI_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "Config.h"
+#include "Features.h"
+#include "Instrumentation.h"
+
+#if defined(TMC_SAMPLE_TIMESTAMP) && !defined(TMC_SAMPLE_TIMESTAMP_PER_MS)
+#error "TMC_SAMPLE_TIMESTAMP requires TMC_SAMPLE_TIMESTAMP_PER_MS"
+#endif
+
+#if defined(TMC_SAMPLE_TIMESTAMP) && !defined(TMC_SPI_STATUS_TIMESTAMP)
+#define TMC_SPI_STATUS_TIMESTAMP()  TMC_SAMPLE_TIMESTAMP()
+#endif
+
+#define TMC_SPI_DATAGRAM_LENGTH  5
+
+// Send [length] bytes stored in the [data] array and overwrite [data] with the reply
+typedef void (*tmc_spi_readWriteArray)(uint8_t channel, uint8_t *data, size_t length);
+
+// SPI wrapper of an IC
+typedef struct
+{
+	tmc_spi_readWriteArray readWriteArray;
+#ifdef TMC_INSTRUMENT_ENABLED
+	const char *name; // Set with TMC_INSTRUMENT_NAME()
+#endif
+} TMCSpiInterface;
+
+// SPI_STATUS bits
+#define TMC_SPI_STATUS_RESET_FLAG        0x01
+#define TMC_SPI_STATUS_DRIVER_ERROR      0x02
+#define TMC_SPI_STATUS_SG2               0x04
+#define TMC_SPI_STATUS_STANDSTILL        0x08
+#define TMC_SPI_STATUS_VELOCITY_REACHED  0x10  // TMC5xxx only
+#define TMC_SPI_STATUS_POSITION_REACHED  0x20  // TMC5xxx only
+#define TMC_SPI_STATUS_STOP_L            0x40  // TMC5xxx only
+#define TMC_SPI_STATUS_STOP_R            0x80  // TMC5xxx only
+
+// Called with the IC, the captured status and the flags that got set
+typedef void (*tmc_spi_statusCallback)(void *ic, uint8_t status, uint8_t rising);
+
+typedef struct
+{
+	uint8_t status;    // Last captured SPI_STATUS
+	uint8_t edgeMask;  // Flags reported to the callback when they get set
+	bool valid;        // Set by the first capture
+	uint32_t tick;     // Time of the last capture, see TMC_SPI_STATUS_TIMESTAMP()
+	tmc_spi_statusCallback callback; // NULL: none
+} TMCSpiStatus;
+
+#if TMC_FEATURE_SPI_STATUS
+// Store the status byte of a reply. Flags already set at the first capture count as set.
+static inline void tmc_spi_captureStatus(TMCSpiStatus *spiStatus, void *ic, uint8_t status)
+{
+	uint8_t rising = status & spiStatus->edgeMask;
+
+	if(spiStatus->valid)
+		rising &= ~spiStatus->status;
+
+	spiStatus->status  = status;
+	spiStatus->valid   = true;
+#ifdef TMC_SPI_STATUS_TIMESTAMP
+	spiStatus->tick    = TMC_SPI_STATUS_TIMESTAMP();
+#else
+	spiStatus->tick++;
+#endif
+
+	if(rising && spiStatus->callback)
+		spiStatus->callback(ic, status, rising);
+}
+#else
+#define tmc_spi_captureStatus(spiStatus, ic, status)  ((void) 0)
+#endif
+
+void tmc_spi_writeInt(const TMCSpiInterface *spi, uint8_t channel, uint8_t address, int32_t value);
+int32_t tmc_spi_readInt(const TMCSpiInterface *spi, uint8_t channel, uint8_t address);
+
+// Read the registers at [addresses] with pipelined datagrams.
+// Registers without TMC_ACCESS_READ in [registerAccess] are not transferred,
+// their value is taken from the shadow registers of [config] instead.
+// Pass NULL as [registerAccess] for ICs without an access table.
+void tmc_spi_readIntBatch(const TMCSpiInterface *spi, ConfigurationTypeDef *config, const uint8_t *registerAccess,
+		const uint8_t *addresses, int32_t *values, size_t count);
+
+#endif /* TMC_HELPERS_SPI_H_ */
@@ -0,0 +1,114 @@
+/*
+ * Scheduler.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "Scheduler.h"
+
+void tmc_scheduler_init(TMCScheduler *scheduler, uint32_t budget, tmc_scheduler_callback configured)
+{
+	uint8_t i;
+
+	scheduler->count       = 0;
+	scheduler->budget      = budget;
+	scheduler->configured  = configured;
+
+	for(i = 0; i < TMC_PRIORITY_COUNT; i++)
+		scheduler->next[i] = 0;
+}
+
+bool tmc_scheduler_add(TMCScheduler *scheduler, tmc_scheduler_job job, void *ic, ConfigurationTypeDef *config,
+		TMCPriority priority, uint8_t cost)
+{
+	TMCSchedulerEntry *entry;
+
+	if(scheduler->count >= TMC_SCHEDULER_MAX_JOBS)
+		return false;
+
+	entry = &scheduler->entries[scheduler->count++];
+	entry->job   = job;
+	entry->ic        = ic;
+	entry->config    = config;
+	entry->priority  = priority;
+	entry->cost      = cost;
+
+	return true;
+}
+
+// Update the cost estimate of all jobs of an IC
+void tmc_scheduler_setCost(TMCScheduler *scheduler, void *ic, uint8_t cost)
+{
+	uint8_t i;
+
+	for(i = 0; i < scheduler->count; i++)
+		if(scheduler->entries[i].ic == ic)
+			scheduler->entries[i].cost = cost;
+}
+
+// Class of an entry in this tick
+static TMCPriority priorityOf(const TMCSchedulerEntry *entry)
+{
+	if(entry->config && (entry->config->state != CONFIG_READY))
+		return TMC_PRIORITY_BACKGROUND;
+
+	return entry->priority;
+}
+
+uint8_t tmc_scheduler_run(TMCScheduler *scheduler, uint32_t tick)
+{
+	uint32_t used = 0;
+	uint8_t ran = 0;
+	bool finished = false;
+	bool exhausted = false;
+	uint8_t priority;
+
+	for(priority = 0; (priority < TMC_PRIORITY_COUNT) && !exhausted; priority++)
+	{
+		uint8_t index = scheduler->next[priority];
+		uint8_t visited;
+
+		for(visited = 0; visited < scheduler->count; visited++)
+		{
+			TMCSchedulerEntry *entry = &scheduler->entries[index];
+
+			if(priorityOf(entry) == priority)
+			{
+				// Budget used up -> continue with this job next tick
+				if((priority != TMC_PRIORITY_SETPOINT) && ran && (used + entry->cost > scheduler->budget))
+				{
+					exhausted = true;
+					break;
+				}
+
+				if(entry->job(entry->ic, tick) == TMC_CONFIG_STATUS_DONE)
+					finished = true;
+				used += entry->cost;
+				ran++;
+			}
+
+			if(++index >= scheduler->count)
+				index = 0;
+		}
+
+		scheduler->next[priority] = index;
+	}
+
+	// A configuration finished -> check if it was the last one running
+	if(finished && scheduler->configured && tmc_scheduler_isConfigured(scheduler))
+		scheduler->configured(scheduler);
+
+	return ran;
+}
+
+bool tmc_scheduler_isConfigured(TMCScheduler *scheduler)
+{
+	uint8_t i;
+
+	for(i = 0; i < scheduler->count; i++)
+		if(scheduler->entries[i].config && (scheduler->entries[i].config->state != CONFIG_READY))
+			return false;
+
+	return true;
+}
@@ -0,0 +1,111 @@
+/*
+ * Scheduler.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Cooperative scheduler for the periodic jobs of many ICs.
+ *
+ *  Every IC registers its periodic job together with an estimate of the bus
+ *  transactions one call costs. tmc_scheduler_run() is called once per tick and
+ *  runs jobs until the transaction budget of the tick is used up. The next tick
+ *  continues with the following job, so all ICs are served round robin and the
+ *  worst case time per tick stays bounded, no matter how many ICs are resetting
+ *  or restoring at once.
+ *
+ *  The jobs are called with the current tick. ICs skipped in a tick run later
+ *  with a larger tick difference, which the drivers already account for.
+ *
+ *  The job takes the IC struct as void pointer, so the typed periodic job of a
+ *  driver needs a small wrapper:
+ *
+ *    static TMCConfigStatus tmc5160_job(void *ic, uint32_t tick)
+ *    {
+ *        return tmc5160_periodicJob(ic, tick);
+ *    }
+ *
+ *    tmc_scheduler_add(&scheduler, tmc5160_job, &tmc5160, tmc5160.config, TMC_PRIORITY_TELEMETRY, 2);
+ *
+ *  Once the last running reset or restore of the registered ICs finishes, the
+ *  configured callback is called within tmc_scheduler_run(). Higher layers can
+ *  start motion right away instead of waiting a fixed time after power up.
+ *
+ *  Every job has a priority class. Each tick serves the classes in order:
+ *  All setpoint jobs run, regardless of the budget. Telemetry and background
+ *  jobs then share the remaining budget, telemetry first. A job whose IC is
+ *  running a reset or restore counts as background, so a configuration only
+ *  uses the bus time left over. Configurations proceed one register per
+ *  call, so they never delay the next tick's setpoints by more than one
+ *  datagram. Register the service routine of a command queue as a setpoint
+ *  job to get time critical writes like XTARGET out first:
+ *
+ *    static TMCConfigStatus tmc5160_setpoints(void *ic, uint32_t tick)
+ *    {
+ *        UNUSED(tick);
+ *        tmc5160_serviceQueue(ic, &setpointQueue);
+ *        return TMC_CONFIG_STATUS_READY;
+ *    }
+ *
+ *    tmc_scheduler_add(&scheduler, tmc5160_setpoints, &tmc5160, NULL, TMC_PRIORITY_SETPOINT, 3);
+ *
+ *  Drivers with a split periodic job (TMC5160, TMC5130, TMC5240, TMC5072, TMC2590,
+ *  TMC2660) document the worst case accesses of both parts. Register the
+ *  periodicJobFast() part as telemetry job and the periodicJobBackground() part,
+ *  which runs the configuration, as background job with separate estimates.
+ */
+
+#ifndef TMC_HELPERS_SCHEDULER_H_
+#define TMC_HELPERS_SCHEDULER_H_
+
+#include "Types.h"
+#include "Config.h"
+
+// Maximum amount of registered jobs
+#define TMC_SCHEDULER_MAX_JOBS 32
+
+typedef TMCConfigStatus (*tmc_scheduler_job)(void *ic, uint32_t tick);
+
+// Priority classes, highest first
+typedef enum {
+	TMC_PRIORITY_SETPOINT,    // Real time setpoints, always run
+	TMC_PRIORITY_TELEMETRY,   // Status polling
+	TMC_PRIORITY_BACKGROUND,  // Bulk work, runs with the remaining budget
+	TMC_PRIORITY_COUNT
+} TMCPriority;
+
+typedef struct TMCScheduler TMCScheduler;
+
+typedef void (*tmc_scheduler_callback)(TMCScheduler *scheduler);
+
+typedef struct
+{
+	tmc_scheduler_job job;
+	void *ic;
+	ConfigurationTypeDef *config; // NULL: Not included in the configured event
+	TMCPriority priority;         // Background while a configuration is running
+	uint8_t cost;                 // Estimated bus transactions per call
+} TMCSchedulerEntry;
+
+struct TMCScheduler
+{
+	TMCSchedulerEntry entries[TMC_SCHEDULER_MAX_JOBS];
+	uint8_t count;
+	uint8_t next[TMC_PRIORITY_COUNT]; // Entry of each class to start the next tick with
+	uint32_t budget; // Bus transactions per tick
+	tmc_scheduler_callback configured; // Called when all ICs finished configuring, may be NULL
+};
+
+void tmc_scheduler_init(TMCScheduler *scheduler, uint32_t budget, tmc_scheduler_callback configured);
+bool tmc_scheduler_add(TMCScheduler *scheduler, tmc_scheduler_job job, void *ic, ConfigurationTypeDef *config,
+		TMCPriority priority, uint8_t cost);
+void tmc_scheduler_setCost(TMCScheduler *scheduler, void *ic, uint8_t cost);
+
+// Run the jobs of one tick. At least one job is run per call, even if its
+// cost exceeds the budget. Setpoint jobs using up the whole budget starve the
+// lower classes. Returns the amount of jobs run.
+uint8_t tmc_scheduler_run(TMCScheduler *scheduler, uint32_t tick);
+
+// True if no registered IC has a reset or restore running
+bool tmc_scheduler_isConfigured(TMCScheduler *scheduler);
+
+#endif /* TMC_HELPERS_SCHEDULER_H_ */
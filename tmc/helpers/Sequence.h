@@ -0,0 +1,146 @@
+/*
+ * Sequence.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Stackless sequences over the non-blocking transport.
+ *
+ *  Multi-step procedures (encoder initialization, homing, profile switching)
+ *  otherwise need a hand-written state machine or block on every transfer.
+ *  A sequence is written as straight code instead. Each TMC_SEQ_AWAIT() starts
+ *  an asynchronous request and returns to the caller while the transfer is in
+ *  progress. The next call of the sequence function resumes right after it:
+ *
+ *    typedef struct
+ *    {
+ *        TMCSequence seq;
+ *        TMCAsyncRequestTypeDef request;
+ *        TMC5160TypeDef *ic;
+ *        uint8_t version;
+ *    } ReadVersion;
+ *
+ *    // Returns true once finished
+ *    bool readVersion(ReadVersion *job, uint32_t tick)
+ *    {
+ *        TMC_SEQ_BEGIN(&job->seq);
+ *
+ *        TMC_SEQ_AWAIT(&job->seq, &job->request,
+ *                tmc5160_writeIntAsync(job->ic, &job->request, TMC5160_GSTAT, 0x07, NULL, NULL));
+ *        TMC_SEQ_SLEEP(&job->seq, tick, 10);
+ *        TMC_SEQ_AWAIT(&job->seq, &job->request,
+ *                tmc5160_readIntAsync(job->ic, &job->request, TMC5160_INP_OUT, NULL, NULL));
+ *
+ *        if(job->request.state == TMC_ASYNC_ERROR)
+ *            TMC_SEQ_EXIT(&job->seq);
+ *
+ *        job->version = TMC_ENUM_VERSION(job->request.value);
+ *
+ *        TMC_SEQ_END(&job->seq);
+ *    }
+ *
+ *  Any amount of sequences can be interleaved on one thread by calling their
+ *  functions in turn, e.g. from the scheduler. A sequence only costs its
+ *  TMCSequence and the request it awaits, there is no stack per sequence.
+ *
+ *  The resume point is a switch label, so the usual restrictions apply:
+ *  - Local variables do not keep their value across a wait, keep the state in
+ *    the job struct.
+ *  - No switch statement may enclose a wait inside the sequence body.
+ *  - Only one wait per source line.
+ *
+ *  The macros are plain C and compile as C++ as well, so C++ firmware can wrap
+ *  a sequence function in its own task type.
+ */
+
+#ifndef TMC_HELPERS_SEQUENCE_H_
+#define TMC_HELPERS_SEQUENCE_H_
+
+#include "Types.h"
+#include "Async.h"
+
+typedef struct
+{
+	uint32_t resume; // Resume point, 0: start
+	uint32_t timer;  // Start tick of TMC_SEQ_SLEEP()
+} TMCSequence;
+
+#define TMC_SEQUENCE_FINISHED  0xFFFFFFFFu
+
+// The waits fall through into their resume label on the first pass
+#if defined(__GNUC__) && (__GNUC__ >= 7)
+#define TMC_SEQ_FALLTHROUGH  __attribute__((fallthrough))
+#else
+#define TMC_SEQ_FALLTHROUGH  ((void) 0)
+#endif
+
+#define TMC_SEQ_INIT(seq)      ((seq)->resume = 0)
+#define TMC_SEQ_RUNNING(seq)   (((seq)->resume != 0) && ((seq)->resume != TMC_SEQUENCE_FINISHED))
+#define TMC_SEQ_FINISHED(seq)  ((seq)->resume == TMC_SEQUENCE_FINISHED)
+
+#define TMC_SEQ_BEGIN(seq) \
+	switch((seq)->resume) \
+	{ \
+	case TMC_SEQUENCE_FINISHED: \
+		return true; \
+	case 0:
+
+#define TMC_SEQ_END(seq) \
+	} \
+	(seq)->resume = TMC_SEQUENCE_FINISHED; \
+	return true
+
+// Finish the sequence early
+#define TMC_SEQ_EXIT(seq) \
+	do { \
+		(seq)->resume = TMC_SEQUENCE_FINISHED; \
+		return true; \
+	} while(0)
+
+// Return to the caller, continue with the next call
+#define TMC_SEQ_YIELD(seq) \
+	do { \
+		(seq)->resume = __LINE__ * 2; \
+		return false; \
+	case __LINE__ * 2:; \
+	} while(0)
+
+// Return to the caller until [condition] is true. It is evaluated again on every call.
+#define TMC_SEQ_WAIT_UNTIL(seq, condition) \
+	do { \
+		(seq)->resume = __LINE__ * 2; \
+		TMC_SEQ_FALLTHROUGH; \
+	case __LINE__ * 2: \
+		if(!(condition)) \
+			return false; \
+	} while(0)
+
+// Wait until [ticks] have passed since reaching this line
+#define TMC_SEQ_SLEEP(seq, tick, ticks) \
+	do { \
+		(seq)->timer = (tick); \
+		(seq)->resume = __LINE__ * 2; \
+		TMC_SEQ_FALLTHROUGH; \
+	case __LINE__ * 2: \
+		if((uint32_t) ((tick) - (seq)->timer) < (uint32_t) (ticks)) \
+			return false; \
+	} while(0)
+
+// Start an asynchronous request with [start], which returns NULL while the
+// request is still busy with a previous transfer, then wait for its completion.
+// The result is in [request]->state and [request]->value afterwards.
+#define TMC_SEQ_AWAIT(seq, request, start) \
+	do { \
+		(seq)->resume = __LINE__ * 2; \
+		TMC_SEQ_FALLTHROUGH; \
+	case __LINE__ * 2: \
+		if(!(start)) \
+			return false; \
+		(seq)->resume = __LINE__ * 2 + 1; \
+		TMC_SEQ_FALLTHROUGH; \
+	case __LINE__ * 2 + 1: \
+		if((request)->state == TMC_ASYNC_PENDING) \
+			return false; \
+	} while(0)
+
+#endif /* TMC_HELPERS_SEQUENCE_H_ */
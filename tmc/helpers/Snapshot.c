@@ -0,0 +1,87 @@
+/*
+ * Snapshot.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "Snapshot.h"
+#include "Macros.h"
+
+void tmc_snapshot_init(TMCSnapshot *snapshot)
+{
+	uint8_t i;
+
+	snapshot->sequence  = 0;
+	snapshot->tick      = 0;
+	snapshot->timestamp = 0;
+
+	for(i = 0; i < TMC_SNAPSHOT_SIZE; i++)
+		snapshot->values[i] = 0;
+}
+
+void tmc_snapshot_publish(TMCSnapshot *snapshot, const int32_t *values, uint8_t count, uint32_t tick)
+{
+	tmc_snapshot_publishStamped(snapshot, values, count, tick, tick);
+}
+
+void tmc_snapshot_publishStamped(TMCSnapshot *snapshot, const int32_t *values, uint8_t count, uint32_t tick, uint32_t timestamp)
+{
+	uint32_t sequence = snapshot->sequence;
+	uint8_t i;
+
+	count = MIN(count, TMC_SNAPSHOT_SIZE);
+
+	// Odd sequence: update in progress
+	snapshot->sequence = sequence + 1;
+	TMC_MEMORY_BARRIER();
+
+	snapshot->tick = tick;
+	snapshot->timestamp = timestamp;
+	for(i = 0; i < count; i++)
+		snapshot->values[i] = values[i];
+
+	TMC_MEMORY_BARRIER();
+	snapshot->sequence = sequence + 2;
+}
+
+bool tmc_snapshot_tryRead(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick)
+{
+	return tmc_snapshot_tryReadStamped(snapshot, values, count, tick, NULL);
+}
+
+bool tmc_snapshot_tryReadStamped(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick, uint32_t *timestamp)
+{
+	uint32_t sequence = snapshot->sequence;
+	uint8_t i;
+
+	if(sequence & 1)
+		return false;
+
+	count = MIN(count, TMC_SNAPSHOT_SIZE);
+
+	TMC_MEMORY_BARRIER();
+
+	if(tick)
+		*tick = snapshot->tick;
+	if(timestamp)
+		*timestamp = snapshot->timestamp;
+	for(i = 0; i < count; i++)
+		values[i] = snapshot->values[i];
+
+	TMC_MEMORY_BARRIER();
+
+	return (snapshot->sequence == sequence);
+}
+
+void tmc_snapshot_read(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick)
+{
+	while(!tmc_snapshot_tryRead(snapshot, values, count, tick))
+		;
+}
+
+void tmc_snapshot_readStamped(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick, uint32_t *timestamp)
+{
+	while(!tmc_snapshot_tryReadStamped(snapshot, values, count, tick, timestamp))
+		;
+}
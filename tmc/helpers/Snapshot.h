@@ -0,0 +1,58 @@
+/*
+ * Snapshot.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Seqlock protected telemetry snapshots.
+ *
+ *  Meant for firmware where one core (or task) owns the buses and the ICs and
+ *  other cores only run application logic. The owner publishes the registers
+ *  it reads periodically, readers take a consistent copy without ever blocking
+ *  the owner: The writer increments the sequence before and after updating the
+ *  values, a reader retries if the sequence was odd or changed during its copy.
+ *  Every snapshot carries the tick it was captured at, so readers can tell how
+ *  old the values are. Stamped snapshots additionally carry the high resolution
+ *  sampling instant of the values (TMC_SAMPLE_TIMESTAMP(), see SPI.h), for
+ *  estimators that must not see the jitter of the capturing job.
+ *
+ *  Commands travel the other way through a command queue (CommandQueue.h) per
+ *  requesting core, drained by the owner, e.g. with tmc5160_serviceQueue().
+ *
+ *  There is exactly one writer per snapshot. The snapshot has to be placed in
+ *  memory shared and coherent between the cores (e.g. not cached on a Cortex-M7
+ *  core without cache maintenance).
+ */
+
+#ifndef TMC_HELPERS_SNAPSHOT_H_
+#define TMC_HELPERS_SNAPSHOT_H_
+
+#include "Types.h"
+
+// Maximum amount of values per snapshot
+#define TMC_SNAPSHOT_SIZE 8
+
+typedef struct
+{
+	volatile uint32_t sequence; // Odd while the writer updates the values
+	volatile uint32_t tick;     // Capture tick of the values
+	volatile uint32_t timestamp; // Sampling instant of the values, the tick if not stamped
+	volatile int32_t values[TMC_SNAPSHOT_SIZE];
+} TMCSnapshot;
+
+void tmc_snapshot_init(TMCSnapshot *snapshot);
+
+// Writer side, never blocks
+void tmc_snapshot_publish(TMCSnapshot *snapshot, const int32_t *values, uint8_t count, uint32_t tick);
+void tmc_snapshot_publishStamped(TMCSnapshot *snapshot, const int32_t *values, uint8_t count, uint32_t tick, uint32_t timestamp);
+
+// Copy [count] values and their capture tick (tick may be NULL).
+// Returns false if the writer interfered, values and tick are undefined then.
+bool tmc_snapshot_tryRead(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick);
+// Copy [count] values, retrying until the copy is consistent
+void tmc_snapshot_read(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick);
+// As above, also copying the sampling instant (timestamp may be NULL)
+bool tmc_snapshot_tryReadStamped(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick, uint32_t *timestamp);
+void tmc_snapshot_readStamped(const TMCSnapshot *snapshot, int32_t *values, uint8_t count, uint32_t *tick, uint32_t *timestamp);
+
+#endif /* TMC_HELPERS_SNAPSHOT_H_ */
@@ -0,0 +1,245 @@
+/*
+ * TelemetryExport.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "TelemetryExport.h"
+#include "Macros.h"
+
+#define FRAME_MASK (TMC_TELEMETRY_FRAMES - 1)
+
+// Unsigned LEB128 of the zigzag mapped value: small differences of either sign take few bytes
+static uint8_t *putZigzag(uint8_t *data, int32_t value)
+{
+	uint32_t zigzag = ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+
+	do
+	{
+		*data++ = (zigzag & 0x7F) | ((zigzag > 0x7F) ? 0x80 : 0);
+		zigzag >>= 7;
+	} while(zigzag);
+
+	return data;
+}
+
+static const uint8_t *getZigzag(const uint8_t *data, const uint8_t *end, int32_t *value)
+{
+	uint32_t zigzag = 0;
+	uint8_t shift;
+
+	for(shift = 0; shift < 35; shift += 7)
+	{
+		if(data >= end)
+			return NULL;
+
+		zigzag |= (uint32_t) (*data & 0x7F) << shift;
+
+		if(!(*data++ & 0x80))
+		{
+			*value = (int32_t) (zigzag >> 1) ^ -(int32_t) (zigzag & 1);
+			return data;
+		}
+	}
+
+	return NULL;
+}
+
+static uint8_t *putLE(uint8_t *data, uint32_t value, uint8_t bytes)
+{
+	while(bytes--)
+	{
+		*data++ = value & 0xFF;
+		value >>= 8;
+	}
+
+	return data;
+}
+
+static uint32_t getLE(const uint8_t *data, uint8_t bytes)
+{
+	uint32_t value = 0;
+
+	while(bytes--)
+		value = (value << 8) | data[bytes];
+
+	return value;
+}
+
+static void completeFrame(TMCTelemetryExport *stream)
+{
+	uint8_t *frame = stream->frames[stream->head & FRAME_MASK];
+	uint16_t i;
+
+	for(i = stream->length; i < TMC_TELEMETRY_FRAME_SIZE; i++)
+		frame[i] = 0;
+
+	// Publish the frame before the index
+	TMC_MEMORY_BARRIER();
+	stream->head++;
+
+	stream->sequence++;
+	stream->length = 0;
+}
+
+void tmc_telemetry_init(TMCTelemetryExport *stream)
+{
+	stream->head      = 0;
+	stream->tail      = 0;
+	stream->dropped   = 0;
+	stream->sequence  = 0;
+	stream->length    = 0;
+	stream->timestamp = 0;
+	stream->axesSeen  = 0;
+}
+
+bool tmc_telemetry_push(TMCTelemetryExport *stream, const TMCTelemetryRecord *record)
+{
+	uint8_t *frame, *data;
+	int32_t position;
+
+	if(record->axis >= TMC_TELEMETRY_AXES)
+		return false;
+
+	if(stream->length && (stream->length + TMC_TELEMETRY_RECORD_MAX > TMC_TELEMETRY_FRAME_SIZE))
+		completeFrame(stream);
+
+	// The frame being filled takes a slot of the ring as well
+	if(stream->head - stream->tail >= TMC_TELEMETRY_FRAMES)
+	{
+		stream->dropped++;
+		return false;
+	}
+
+	frame = stream->frames[stream->head & FRAME_MASK];
+
+	if(!stream->length)
+	{
+		putLE(&frame[0], stream->sequence, 2);
+		frame[2] = 0;
+		frame[3] = TMC_TELEMETRY_VERSION;
+		putLE(&frame[4], record->timestamp, 4);
+
+		stream->length     = TMC_TELEMETRY_HEADER_SIZE;
+		stream->timestamp  = record->timestamp;
+		stream->axesSeen   = 0;
+	}
+
+	position = record->position;
+	if(stream->axesSeen & (1 << record->axis))
+		position -= stream->positions[record->axis];
+
+	data = &frame[stream->length];
+	*data++ = record->axis;
+	data = putZigzag(data, record->timestamp - stream->timestamp);
+	data = putZigzag(data, position);
+	data = putLE(data, record->velocity, 4);
+	data = putLE(data, record->sg, 2);
+	data = putLE(data, record->current, 1);
+	data = putLE(data, (uint16_t) record->temperature, 2);
+	data = putLE(data, record->faults, 2);
+
+	frame[2]++;
+	stream->length = data - frame;
+	stream->timestamp = record->timestamp;
+	stream->positions[record->axis] = record->position;
+	stream->axesSeen |= 1 << record->axis;
+
+	return true;
+}
+
+void tmc_telemetry_flush(TMCTelemetryExport *stream)
+{
+	if(stream->length)
+		completeFrame(stream);
+}
+
+const uint8_t *tmc_telemetry_peek(TMCTelemetryExport *stream)
+{
+	uint32_t tail = stream->tail;
+
+	if(stream->head == tail)
+		return NULL;
+
+	TMC_MEMORY_BARRIER();
+
+	return stream->frames[tail & FRAME_MASK];
+}
+
+void tmc_telemetry_release(TMCTelemetryExport *stream)
+{
+	if(stream->head == stream->tail)
+		return;
+
+	TMC_MEMORY_BARRIER();
+	stream->tail++;
+}
+
+void tmc_telemetry_initDecoder(TMCTelemetryDecoder *decoder)
+{
+	decoder->sequence  = 0;
+	decoder->synced    = false;
+	decoder->lost      = 0;
+}
+
+int32_t tmc_telemetry_decode(TMCTelemetryDecoder *decoder, const uint8_t *frame, size_t length, TMCTelemetryRecord *records, uint8_t maxRecords)
+{
+	const uint8_t *end = frame + length;
+	const uint8_t *data = &frame[TMC_TELEMETRY_HEADER_SIZE];
+	int32_t positions[TMC_TELEMETRY_AXES];
+	uint8_t axesSeen = 0;
+	uint32_t timestamp;
+	uint16_t sequence;
+	uint8_t count, i;
+
+	if(length < TMC_TELEMETRY_HEADER_SIZE || frame[3] != TMC_TELEMETRY_VERSION)
+		return -1;
+
+	sequence   = getLE(&frame[0], 2);
+	count      = MIN(frame[2], maxRecords);
+	timestamp  = getLE(&frame[4], 4);
+
+	for(i = 0; i < count; i++)
+	{
+		TMCTelemetryRecord *record = &records[i];
+		int32_t difference;
+
+		if(data >= end)
+			return -1;
+
+		record->axis = *data++;
+		if(record->axis >= TMC_TELEMETRY_AXES)
+			return -1;
+
+		data = getZigzag(data, end, &difference);
+		if(!data)
+			return -1;
+		timestamp += difference;
+		record->timestamp = timestamp;
+
+		data = getZigzag(data, end, &difference);
+		if(!data || (end - data < 11))
+			return -1;
+		if(axesSeen & (1 << record->axis))
+			difference += positions[record->axis];
+		record->position = difference;
+		positions[record->axis] = difference;
+		axesSeen |= 1 << record->axis;
+
+		record->velocity     = getLE(&data[0], 4);
+		record->sg           = getLE(&data[4], 2);
+		record->current      = data[6];
+		record->temperature  = (int16_t) getLE(&data[7], 2);
+		record->faults       = getLE(&data[9], 2);
+		data += 11;
+	}
+
+	if(decoder->synced)
+		decoder->lost += (uint16_t) (sequence - decoder->sequence);
+
+	decoder->sequence  = sequence + 1;
+	decoder->synced    = true;
+
+	return count;
+}
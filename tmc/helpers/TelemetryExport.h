@@ -0,0 +1,114 @@
+/*
+ * TelemetryExport.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Binary telemetry stream for the host.
+ *
+ *  The capture (e.g. tmc5160_telemetryRecord() on a telemetry snapshot)
+ *  fills one record per axis and sample, tmc_telemetry_push() packs it into the
+ *  current frame. Frames have a fixed size (TMC_TELEMETRY_FRAME_SIZE, e.g. one
+ *  USB full speed packet), completed frames are collected in a ring buffer.
+ *  The transport takes the oldest frame with tmc_telemetry_peek(), sends it as
+ *  it is (e.g. by DMA) and hands it back with tmc_telemetry_release(). There is
+ *  no formatting on the MCU, a record costs a few byte stores.
+ *
+ *  Frame, all values little endian, unused bytes at the end are zero:
+ *    uint16  sequence     Incremented per frame, the host detects lost frames
+ *    uint8   recordCount
+ *    uint8   version      TMC_TELEMETRY_VERSION
+ *    uint32  timestamp    Capture timestamp of the first record
+ *    records...
+ *  Record:
+ *    uint8   axis
+ *    varint  timestamp    zigzag, difference to the previous record of the frame
+ *    varint  position     zigzag, difference to the previous record of the same
+ *                         axis in the frame, absolute for the first one
+ *    int32   velocity
+ *    uint16  sg
+ *    uint8   current
+ *    int16   temperature
+ *    uint16  faults
+ *  Varints are unsigned LEB128 as in RegisterLog.h. Every frame decodes on its
+ *  own, a lost frame only loses its records.
+ *
+ *  Pushing and taking frames may run in different contexts (single producer,
+ *  single consumer). Records are dropped and counted if the ring is full.
+ *
+ *  The decoder is plain C as well, so the same file builds the host tool.
+ */
+
+#ifndef TMC_HELPERS_TELEMETRYEXPORT_H_
+#define TMC_HELPERS_TELEMETRYEXPORT_H_
+
+#include "Types.h"
+
+#define TMC_TELEMETRY_VERSION 1
+
+// Bytes per frame, at least TMC_TELEMETRY_HEADER_SIZE + TMC_TELEMETRY_RECORD_MAX
+#define TMC_TELEMETRY_FRAME_SIZE 64
+
+// Frames in the ring buffer, must be a power of two
+#define TMC_TELEMETRY_FRAMES 8
+
+// Maximum amount of axes per stream
+#define TMC_TELEMETRY_AXES 8
+
+#define TMC_TELEMETRY_HEADER_SIZE 8
+// Largest record: axis, two 5 byte varints and the fixed fields
+#define TMC_TELEMETRY_RECORD_MAX (1 + 5 + 5 + 11)
+
+typedef struct
+{
+	uint32_t timestamp;   // Capture timestamp, e.g. the snapshot timestamp
+	int32_t position;
+	int32_t velocity;
+	int16_t temperature;  // Application defined unit, 0 if unknown
+	uint16_t faults;      // IC specific status flags
+	uint16_t sg;
+	uint8_t current;
+	uint8_t axis;
+} TMCTelemetryRecord;
+
+typedef struct
+{
+	uint8_t frames[TMC_TELEMETRY_FRAMES][TMC_TELEMETRY_FRAME_SIZE];
+	volatile uint32_t head;  // Frames completed, written by the producer
+	volatile uint32_t tail;  // Frames released, written by the consumer
+	uint32_t dropped;        // Records lost to a full ring
+
+	// Frame being filled, frames[head]
+	uint16_t sequence;
+	uint16_t length;         // 0: no record yet
+	uint32_t timestamp;      // Of the previous record
+	int32_t positions[TMC_TELEMETRY_AXES]; // Of the previous record per axis
+	uint8_t axesSeen;        // Axes with a record in the frame
+} TMCTelemetryExport;
+
+typedef struct
+{
+	uint16_t sequence;    // Expected sequence of the next frame
+	bool synced;
+	uint32_t lost;        // Frames missing between decoded ones
+} TMCTelemetryDecoder;
+
+void tmc_telemetry_init(TMCTelemetryExport *stream);
+
+// Producer side. Returns false if the record was dropped.
+bool tmc_telemetry_push(TMCTelemetryExport *stream, const TMCTelemetryRecord *record);
+// Complete the current frame early, e.g. when the capture rate is low
+void tmc_telemetry_flush(TMCTelemetryExport *stream);
+
+// Consumer side. The oldest complete frame (TMC_TELEMETRY_FRAME_SIZE bytes), NULL if none.
+// It stays valid until tmc_telemetry_release().
+const uint8_t *tmc_telemetry_peek(TMCTelemetryExport *stream);
+void tmc_telemetry_release(TMCTelemetryExport *stream);
+
+// Host side
+void tmc_telemetry_initDecoder(TMCTelemetryDecoder *decoder);
+// Decode one frame into up to [maxRecords] records.
+// Returns the amount of records, -1 if the frame is malformed.
+int32_t tmc_telemetry_decode(TMCTelemetryDecoder *decoder, const uint8_t *frame, size_t length, TMCTelemetryRecord *records, uint8_t maxRecords);
+
+#endif /* TMC_HELPERS_TELEMETRYEXPORT_H_ */
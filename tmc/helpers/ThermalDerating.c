@@ -0,0 +1,108 @@
+/*
+ * ThermalDerating.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "ThermalDerating.h"
+#include "Macros.h"
+
+void tmc_thermal_init(TMCThermalDerating *thermal)
+{
+	thermal->temperature  = 0;
+	thermal->trend        = 0;
+	thermal->sampleTick   = 0;
+	thermal->valid        = false;
+	thermal->scale        = TMC_THERMAL_SCALE_FULL;
+}
+
+// Move the scale towards [target] by at most slewRate
+static bool slewScale(TMCThermalDerating *thermal, int32_t target)
+{
+	int32_t scale = thermal->scale;
+
+	target = MAX(target, thermal->minScale);
+	target = MIN(target, TMC_THERMAL_SCALE_FULL);
+
+	if(target < scale)
+		scale = MAX(target, scale - thermal->slewRate);
+	else
+		scale = MIN(target, scale + thermal->slewRate);
+
+	if(scale == thermal->scale)
+		return false;
+
+	thermal->scale = scale;
+
+	return true;
+}
+
+bool tmc_thermal_updateTemperature(TMCThermalDerating *thermal, int32_t temperature)
+{
+	int32_t divisor = 1 << thermal->filterShift;
+	int32_t previous = thermal->temperature;
+	int32_t predicted, range, target;
+
+	if(!thermal->valid)
+	{
+		thermal->temperature  = temperature;
+		thermal->trend        = 0;
+		thermal->valid        = true;
+	}
+	else
+	{
+		thermal->temperature  += (temperature - thermal->temperature) / divisor;
+		thermal->trend        += ((thermal->temperature - previous) - thermal->trend) / divisor;
+	}
+
+	// Only a rising temperature is extrapolated, the derating does not end early
+	predicted = thermal->temperature + MAX(thermal->trend, 0) * thermal->lookahead;
+	range = MAX(thermal->deratingLimit - thermal->deratingStart, 1);
+
+	if(predicted <= thermal->deratingStart)
+		target = TMC_THERMAL_SCALE_FULL;
+	else if(predicted >= thermal->deratingLimit)
+		target = thermal->minScale;
+	else
+		target = TMC_THERMAL_SCALE_FULL - ((int64_t) (predicted - thermal->deratingStart) * (TMC_THERMAL_SCALE_FULL - thermal->minScale)) / range;
+
+	return slewScale(thermal, target);
+}
+
+bool tmc_thermal_updateLevel(TMCThermalDerating *thermal, uint8_t level)
+{
+	int32_t scale = thermal->scale;
+
+	// Each exceeded threshold speeds up the derating, the higher ones are close to the shutdown
+	if(level)
+		scale = MAX(scale - (int32_t) thermal->slewRate * level, thermal->minScale);
+	else
+		scale = MIN(scale + 1, TMC_THERMAL_SCALE_FULL);
+
+	if(scale == thermal->scale)
+		return false;
+
+	thermal->scale = scale;
+
+	return true;
+}
+
+uint8_t tmc_thermal_globalScaler(const TMCThermalDerating *thermal)
+{
+	uint32_t base = (thermal->base == 0) ? 256 : thermal->base;
+	uint32_t value = (base * thermal->scale) >> 8;
+
+	if(value >= 256)
+		return 0;
+
+	return MAX(value, TMC_THERMAL_GLOBAL_SCALER_MIN);
+}
+
+uint8_t tmc_thermal_irun(const TMCThermalDerating *thermal)
+{
+	// IRUN n is a current of (n + 1) / 32
+	uint32_t value = ((thermal->base + 1) * (uint32_t) thermal->scale) >> 8;
+
+	return (value > 0) ? value - 1 : 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * ThermalDerating.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Thermal current derating: Instead of a fixed worst case current, the motor
+ *  runs at the full current until the driver gets warm and is scaled down
+ *  smoothly before the overtemperature shutdown.
+ *
+ *  Two inputs, depending on the IC:
+ *  - Temperature (TMC2240/TMC5240, ADC_TEMP via AdcTelemetry.h):
+ *    The measurement is low pass filtered together with its change per update.
+ *    The derating follows the temperature extrapolated [lookahead] updates into
+ *    the future, linearly from 256 at [deratingStart] down to [minScale] at
+ *    [deratingLimit].
+ *  - Warning level (TMC5160/TMC2209, DRV_STATUS otpw/ot, t120/t143/t150/t157):
+ *    The amount of temperature thresholds exceeded. The scale is integrated
+ *    down by [slewRate] per update and level while a threshold is exceeded and
+ *    recovers by 1 per update without one. It settles at the highest current
+ *    that keeps the driver around the prewarning threshold.
+ *  Apart from the higher warning levels, the scale changes by at most
+ *  [slewRate] per update.
+ *
+ *  The drivers apply the scale to GLOBAL_SCALER (tmc_thermal_globalScaler()) or
+ *  to IRUN if the IC has no global scaler (tmc_thermal_irun()). [base] is the
+ *  value without derating.
+ */
+
+#ifndef TMC_HELPERS_THERMALDERATING_H_
+#define TMC_HELPERS_THERMALDERATING_H_
+
+#include "Types.h"
+
+// Scale without derating [1/256]
+#define TMC_THERMAL_SCALE_FULL 256
+
+// Lowest GLOBAL_SCALER value allowed for operation, 0 is full scale
+#define TMC_THERMAL_GLOBAL_SCALER_MIN 32
+
+typedef struct
+{
+	// Configuration
+	int32_t deratingStart;   // [centi-°C]
+	int32_t deratingLimit;   // [centi-°C], reaching minScale
+	uint8_t minScale;        // Lowest scale [1/256]
+	uint8_t slewRate;        // Largest scale change per update [1/256]
+	uint8_t filterShift;     // Low pass of temperature and trend: 1 / 2^filterShift per update
+	uint8_t lookahead;       // Updates the temperature trend is extrapolated
+	uint16_t base;           // GLOBAL_SCALER (0: 256) or IRUN without derating
+
+	// State
+	int32_t temperature;     // Filtered [centi-°C]
+	int32_t trend;           // Filtered change per update [centi-°C]
+	uint32_t sampleTick;     // Tick of the last processed sample
+	bool valid;              // A temperature has been processed
+	uint16_t scale;          // Current scale [1/256]
+} TMCThermalDerating;
+
+void tmc_thermal_init(TMCThermalDerating *thermal);
+
+// Process one temperature measurement [centi-°C]. Returns true if the scale changed.
+bool tmc_thermal_updateTemperature(TMCThermalDerating *thermal, int32_t temperature);
+
+// Process the amount of exceeded warning thresholds. Returns true if the scale changed.
+bool tmc_thermal_updateLevel(TMCThermalDerating *thermal, uint8_t level);
+
+// Derated register values of [base]
+uint8_t tmc_thermal_globalScaler(const TMCThermalDerating *thermal);
+uint8_t tmc_thermal_irun(const TMCThermalDerating *thermal);
+
+#endif /* TMC_HELPERS_THERMALDERATING_H_ */
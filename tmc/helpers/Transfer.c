@@ -0,0 +1,142 @@
+/*
+ * Transfer.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "Transfer.h"
+#include "Macros.h"
+
+#ifdef TMC_TRANSFER_POOL
+static TMC_BUFFER_POOL_MEMORY(poolMemory, TMC_TRANSFER_POOL);
+static uint8_t poolFreeList[TMC_TRANSFER_POOL];
+
+TMCBufferPool tmc_transfer_pool = { .memory = NULL };
+
+static void poolInit(void)
+{
+	TMC_BUFFER_POOL_ENTER();
+
+	if(!tmc_transfer_pool.memory)
+		tmc_pool_init(&tmc_transfer_pool, poolMemory, poolFreeList, TMC_TRANSFER_POOL);
+
+	TMC_BUFFER_POOL_EXIT();
+}
+#endif
+
+void tmc_transfer_init(TMCTransferList *list, uint8_t channel, tmc_transfer_execute_fn execute)
+{
+	list->count    = 0;
+	list->channel  = channel;
+	list->execute  = execute;
+
+#ifdef TMC_TRANSFER_POOL
+	if(!tmc_transfer_pool.memory)
+		poolInit();
+#endif
+}
+
+// Append a transfer using the preallocated buffer of its slot or a block of tmc_transfer_pool.
+// Returns the zeroed buffer for the caller to fill in the datagram,
+// NULL if the list is full, the pool is exhausted or the datagram is too long.
+uint8_t *tmc_transfer_append(TMCTransferList *list, size_t length, uint8_t flags, tmc_transfer_decode decode, void *context)
+{
+	uint8_t *data;
+
+	if(tmc_transfer_isFull(list) || (length > TMC_TRANSFER_DATAGRAM_SIZE))
+		return NULL;
+
+#ifdef TMC_TRANSFER_POOL
+	data = tmc_pool_alloc(&tmc_transfer_pool);
+	if(!data)
+		return NULL;
+
+	flags |= TMC_TRANSFER_POOLED;
+#else
+	data = list->buffers[list->count];
+#endif
+	for(size_t i = 0; i < length; i++)
+		data[i] = 0;
+
+	tmc_transfer_appendBuffer(list, data, length, flags, decode, context);
+
+	return data;
+}
+
+// Append a transfer using a buffer of the caller, which must stay valid until the list is executed.
+bool tmc_transfer_appendBuffer(TMCTransferList *list, uint8_t *data, size_t length, uint8_t flags, tmc_transfer_decode decode, void *context)
+{
+	TMCTransfer *transfer;
+
+	if(tmc_transfer_isFull(list))
+		return false;
+
+	transfer = &list->transfers[list->count++];
+	transfer->data     = data;
+	transfer->length   = length;
+	transfer->flags    = flags;
+	transfer->decode   = decode;
+	transfer->context  = context;
+
+	return true;
+}
+
+// Append a 5 byte register datagram: [address] followed by [value] in big endian byte order
+uint8_t *tmc_transfer_appendDatagram(TMCTransferList *list, uint8_t address, int32_t value, tmc_transfer_decode decode, void *context)
+{
+	uint8_t *data = tmc_transfer_append(list, 5, 0, decode, context);
+
+	if(data)
+	{
+		data[0] = address;
+		tmc_packInt32(&data[1], value);
+	}
+
+	return data;
+}
+
+// Decode callback for register datagrams, stores the value of the reply in the int32_t pointed to by [context]
+void tmc_transfer_decodeInt32(void *context, const uint8_t *data, size_t length)
+{
+	UNUSED(length);
+
+	*(int32_t *) context = tmc_unpackInt32(&data[1]);
+}
+
+// Send all appended transfers in one submission, decode the replies and empty the list.
+// The buffers keep their replies until the next append.
+// Blocks from tmc_transfer_pool are returned after decoding.
+void tmc_transfer_execute(TMCTransferList *list)
+{
+	size_t count = list->count;
+
+	if(count == 0)
+		return;
+
+	list->execute(list->channel, list->transfers, count);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		TMCTransfer *transfer = &list->transfers[i];
+
+		if(transfer->decode)
+			transfer->decode(transfer->context, transfer->data, transfer->length);
+	}
+
+	tmc_transfer_clear(list);
+}
+
+// Drop all appended transfers without sending them
+void tmc_transfer_clear(TMCTransferList *list)
+{
+#ifdef TMC_TRANSFER_POOL
+	for(size_t i = 0; i < list->count; i++)
+	{
+		if(list->transfers[i].flags & TMC_TRANSFER_POOLED)
+			tmc_pool_free(&tmc_transfer_pool, list->transfers[i].data);
+	}
+#endif
+
+	list->count = 0;
+}
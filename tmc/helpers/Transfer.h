@@ -0,0 +1,110 @@
+/*
+ * Transfer.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Datagram lists for the optional batched SPI transport.
+ *
+ *  Drivers supporting it (enabled per IC, e.g. with TMC5160_TRANSFER_BATCH)
+ *  append all datagrams of one access to a TMCTransferList instead of calling
+ *  tmcXXXX_readWriteArray() once per datagram. tmc_transfer_execute() hands the
+ *  list to a tmcXXXX_readWriteBatch() wrapper from the application, which sends
+ *  the transfers in order and overwrites each data buffer with its reply.
+ *  The chip select is deasserted between the transfers, unless a transfer is
+ *  flagged with TMC_TRANSFER_CS_HOLD to frame it together with the next one.
+ *  Afterwards the decode callbacks of the transfers are called with the replies.
+ *
+ *  The list preallocates one datagram buffer per transfer, so building it needs
+ *  neither heap memory nor buffers from the caller. The wrapper may map it onto
+ *  a DMA descriptor chain, a single ioctl or one UART burst. Defining
+ *  TMC_TRANSFER_POOL as an amount of blocks takes the buffers from the
+ *  DMA capable tmc_transfer_pool instead (see tmc/helpers/BufferPool.h), so the
+ *  wrapper can hand them to the DMA without copying. Size the pool for the
+ *  lists in use at the same time, TMC_TRANSFER_BATCH_SIZE blocks each.
+ *
+ *  On hosts where every transfer costs a system call this submits a whole
+ *  access at once. A Linux spidev implementation maps the list onto one
+ *  SPI_IOC_MESSAGE(count) ioctl:
+ *
+ *    void tmc5160_readWriteBatch(uint8_t channel, TMCTransfer *transfers, size_t count)
+ *    {
+ *        struct spi_ioc_transfer messages[TMC_TRANSFER_BATCH_SIZE] = { 0 };
+ *
+ *        for(size_t i = 0; i < count; i++)
+ *        {
+ *            messages[i].tx_buf     = (uintptr_t) transfers[i].data;
+ *            messages[i].rx_buf     = (uintptr_t) transfers[i].data;
+ *            messages[i].len        = transfers[i].length;
+ *            messages[i].cs_change  = (i + 1 < count) && !(transfers[i].flags & TMC_TRANSFER_CS_HOLD);
+ *        }
+ *
+ *        ioctl(spiFd[channel], SPI_IOC_MESSAGE(count), messages);
+ *    }
+ */
+
+#ifndef TMC_HELPERS_TRANSFER_H_
+#define TMC_HELPERS_TRANSFER_H_
+
+#include "Types.h"
+#include "BufferPool.h"
+#include "ByteOrder.h"
+
+// Maximum amount of transfers a driver passes in one call
+#ifndef TMC_TRANSFER_BATCH_SIZE
+#define TMC_TRANSFER_BATCH_SIZE 8
+#endif
+
+// Size of the preallocated datagram buffers of a TMCTransferList
+#ifndef TMC_TRANSFER_DATAGRAM_SIZE
+#define TMC_TRANSFER_DATAGRAM_SIZE 8
+#endif
+
+// Transfer flags
+#define TMC_TRANSFER_CS_HOLD  0x01 // Keep the chip select asserted until the next transfer
+#define TMC_TRANSFER_POOLED   0x80 // Buffer allocated from tmc_transfer_pool, set by tmc_transfer_append()
+
+// Called by tmc_transfer_execute() with the reply of a transfer
+typedef void (*tmc_transfer_decode)(void *context, const uint8_t *data, size_t length);
+
+typedef struct
+{
+	uint8_t *data;  // Sent and overwritten with the reply
+	size_t length;
+	uint8_t flags;
+	tmc_transfer_decode decode;  // May be NULL
+	void *context;
+} TMCTransfer;
+
+// Transport executing a whole list, e.g. tmc5160_readWriteBatch()
+typedef void (*tmc_transfer_execute_fn)(uint8_t channel, TMCTransfer *transfers, size_t count);
+
+typedef struct
+{
+	TMCTransfer transfers[TMC_TRANSFER_BATCH_SIZE];
+#ifndef TMC_TRANSFER_POOL
+	uint8_t buffers[TMC_TRANSFER_BATCH_SIZE][TMC_TRANSFER_DATAGRAM_SIZE];
+#endif
+	size_t count;
+	uint8_t channel;
+	tmc_transfer_execute_fn execute;
+} TMCTransferList;
+
+#ifdef TMC_TRANSFER_POOL
+#if TMC_BUFFER_BLOCK_SIZE < TMC_TRANSFER_DATAGRAM_SIZE
+#error "TMC_BUFFER_BLOCK_SIZE is smaller than TMC_TRANSFER_DATAGRAM_SIZE"
+#endif
+extern TMCBufferPool tmc_transfer_pool;
+#endif
+
+#define tmc_transfer_isFull(list)  ((list)->count >= TMC_TRANSFER_BATCH_SIZE)
+
+void tmc_transfer_init(TMCTransferList *list, uint8_t channel, tmc_transfer_execute_fn execute);
+uint8_t *tmc_transfer_append(TMCTransferList *list, size_t length, uint8_t flags, tmc_transfer_decode decode, void *context);
+bool tmc_transfer_appendBuffer(TMCTransferList *list, uint8_t *data, size_t length, uint8_t flags, tmc_transfer_decode decode, void *context);
+uint8_t *tmc_transfer_appendDatagram(TMCTransferList *list, uint8_t address, int32_t value, tmc_transfer_decode decode, void *context);
+void tmc_transfer_decodeInt32(void *context, const uint8_t *data, size_t length);
+void tmc_transfer_execute(TMCTransferList *list);
+void tmc_transfer_clear(TMCTransferList *list);
+
+#endif /* TMC_HELPERS_TRANSFER_H_ */
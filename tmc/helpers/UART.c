@@ -0,0 +1,254 @@
+/*
+ * UART.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include <string.h>
+#include "UART.h"
+#include "Constants.h"
+#include "Macros.h"
+#include "Bits.h"
+#include "ByteOrder.h"
+#include "Lock.h"
+
+static inline uint8_t crc8(const TMCUartInterface *uart, uint8_t *data, size_t length)
+{
+#ifdef TMC_CRC8_ENGINE_FLASH
+	UNUSED(uart);
+	return tmc_CRC8(data, length, 0);
+#else
+	return uart->crc(data, length);
+#endif
+}
+
+void tmc_uart_fillWriteFrame(const TMCUartInterface *uart, uint8_t *data, uint8_t slaveAddress, uint8_t address, int32_t value)
+{
+	data[0] = TMC_UART_SYNC;
+	data[1] = slaveAddress;
+	data[2] = address | TMC_WRITE_BIT;
+	tmc_packInt32(&data[3], value);
+	data[7] = crc8(uart, data, 7);
+}
+
+void tmc_uart_fillReadFrame(const TMCUartInterface *uart, uint8_t *data, uint8_t slaveAddress, uint8_t address)
+{
+	data[0] = TMC_UART_SYNC;
+	data[1] = slaveAddress;
+	data[2] = TMC_ADDRESS(address);
+	data[3] = crc8(uart, data, 3);
+}
+
+bool tmc_uart_checkReply(const TMCUartInterface *uart, uint8_t *data, uint8_t slaveAddress, uint8_t address, int32_t *value)
+{
+	uint32_t header;
+
+#ifdef TMC_UART_ECHO
+	uint8_t request[TMC_UART_REQUEST_LENGTH];
+
+	tmc_uart_fillReadFrame(uart, request, slaveAddress, address);
+	if(memcmp(data, request, TMC_UART_REQUEST_LENGTH) != 0)
+		return false;
+
+	data += TMC_UART_REQUEST_LENGTH;
+#else
+	UNUSED(slaveAddress);
+#endif
+
+	// Compare the whole header at once, the CRC is only calculated for a matching header
+	header = ((uint32_t) data[0] << 16) | ((uint32_t) data[1] << 8) | data[2];
+
+	if(header != (((uint32_t) TMC_UART_SYNC << 16) | ((uint32_t) TMC_UART_MASTER_ADDRESS << 8) | TMC_ADDRESS(address)))
+		return false;
+
+	if(data[7] != crc8(uart, data, 7))
+		return false;
+
+	*value = tmc_unpackInt32(&data[3]);
+
+	return true;
+}
+
+bool tmc_uart_checkWriteEcho(const TMCUartInterface *uart, const uint8_t *data, uint8_t slaveAddress, uint8_t address, int32_t value)
+{
+#ifdef TMC_UART_ECHO
+	uint8_t request[TMC_UART_WRITE_LENGTH];
+
+	tmc_uart_fillWriteFrame(uart, request, slaveAddress, address, value);
+
+	return memcmp(data, request, TMC_UART_WRITE_LENGTH) == 0;
+#else
+	UNUSED(uart);
+	UNUSED(data);
+	UNUSED(slaveAddress);
+	UNUSED(address);
+	UNUSED(value);
+
+	return true;
+#endif
+}
+
+bool tmc_uart_writeInt(const TMCUartInterface *uart, uint8_t channel, uint8_t slaveAddress, uint8_t address, int32_t value)
+{
+	uint8_t data[TMC_UART_WRITE_LENGTH];
+	bool valid;
+
+	tmc_uart_fillWriteFrame(uart, data, slaveAddress, address, value);
+
+	TMC_LOCK(channel);
+	TMC_INSTRUMENT_CALL(uart->name, channel, address, true, TMC_UART_WRITE_LENGTH + TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH), value, 0,
+			uart->readWriteArray(channel, data, TMC_UART_WRITE_LENGTH, TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH)));
+	TMC_UNLOCK(channel);
+
+	valid = tmc_uart_checkWriteEcho(uart, data, slaveAddress, address, value);
+	if(!valid)
+		TMC_INSTRUMENT_ERROR(uart->name, channel);
+
+	return valid;
+}
+
+// Returns false and a value of 0 if the reply is invalid
+bool tmc_uart_readInt(const TMCUartInterface *uart, uint8_t channel, uint8_t slaveAddress, uint8_t address, int32_t *value)
+{
+	uint8_t data[TMC_UART_READ_LENGTH];
+	uint8_t attempt;
+
+	TMC_LOCK(channel);
+
+	for(attempt = 0; attempt <= TMC_UART_READ_RETRIES; attempt++)
+	{
+		if(attempt)
+			TMC_INSTRUMENT_RETRY(uart->name, channel);
+
+		// The reply overwrote the request, build it again for every attempt
+		memset(data, 0, sizeof(data));
+		tmc_uart_fillReadFrame(uart, data, slaveAddress, address);
+		TMC_INSTRUMENT_CALL(uart->name, channel, address, false, TMC_UART_REQUEST_LENGTH + TMC_UART_READ_LENGTH,
+				tmc_instrumentation_frameValue(&data[TMC_UART_READ_LENGTH - TMC_UART_REPLY_LENGTH + 2], 5), 0,
+				uart->readWriteArray(channel, data, TMC_UART_REQUEST_LENGTH, TMC_UART_READ_LENGTH));
+
+		if(tmc_uart_checkReply(uart, data, slaveAddress, address, value))
+		{
+			TMC_UNLOCK(channel);
+			return true;
+		}
+
+		TMC_INSTRUMENT_ERROR(uart->name, channel);
+	}
+
+	TMC_UNLOCK(channel);
+
+	*value = 0;
+	return false;
+}
+
+// Write SLAVECONF of all slaves with one transfer.
+// Returns false if the echo shows a collision.
+static bool writeSlaveConf(const TMCUartInterface *uart, uint8_t channel, const uint8_t *slaveAddresses, uint8_t count, int32_t slaveconf)
+{
+	uint8_t data[TMC_UART_WRITE_LENGTH * TMC_UART_LINK_NODES];
+	bool valid = true;
+	uint8_t i;
+
+	for(i = 0; i < count; i++)
+		tmc_uart_fillWriteFrame(uart, &data[TMC_UART_WRITE_LENGTH * i], slaveAddresses[i], TMC_UART_SLAVECONF, slaveconf);
+
+	TMC_LOCK(channel);
+	TMC_INSTRUMENT_CALL(uart->name, channel, TMC_UART_SLAVECONF, true, (TMC_UART_WRITE_LENGTH + TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH)) * count, slaveconf, 0,
+			uart->readWriteArray(channel, data, TMC_UART_WRITE_LENGTH * count, TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH * count)));
+	TMC_UNLOCK(channel);
+
+	for(i = 0; i < count; i++)
+		if(!tmc_uart_checkWriteEcho(uart, &data[TMC_UART_WRITE_LENGTH * i], slaveAddresses[i], TMC_UART_SLAVECONF, slaveconf))
+			valid = false;
+
+	return valid;
+}
+
+// Probe one SENDDELAY at the current baud rate. The first SLAVECONF write
+// switches the slaves to the delay, so the IFCNT reads afterwards already
+// use it. The second write has to increment every IFCNT.
+static bool probeLink(const TMCUartInterface *uart, uint8_t channel, const uint8_t *slaveAddresses, uint8_t count,
+		uint8_t sendDelay, uint8_t probeReads)
+{
+	int32_t slaveconf = (int32_t) sendDelay << TMC_UART_SENDDELAY_SHIFT;
+	int32_t ifcnt[TMC_UART_LINK_NODES];
+	int32_t value;
+	uint8_t i, read;
+
+	if(!writeSlaveConf(uart, channel, slaveAddresses, count, slaveconf))
+		return false;
+
+	for(i = 0; i < count; i++)
+		if(!tmc_uart_readInt(uart, channel, slaveAddresses[i], TMC_UART_IFCNT, &ifcnt[i]))
+			return false;
+
+	if(!writeSlaveConf(uart, channel, slaveAddresses, count, slaveconf))
+		return false;
+
+	for(i = 0; i < count; i++)
+	{
+		for(read = 0; read < probeReads; read++)
+		{
+			if(!tmc_uart_readInt(uart, channel, slaveAddresses[i], TMC_UART_IFCNT, &value))
+				return false;
+
+			if((value & 0xFF) != ((ifcnt[i] + 1) & 0xFF))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool tmc_uart_tuneLink(TMCUartLink *link, const TMCUartInterface *uart, uint8_t channel, const uint8_t *slaveAddresses, uint8_t count)
+{
+	// Replies of several slaves need SENDDELAY >= 2 on a shared line.
+	// Odd values give the same delay as the even value below.
+	uint8_t minimumDelay = (count > 1) ? 2 : 0;
+
+	link->channel  = channel;
+	link->errors   = 0;
+
+	if((count == 0) || (count > TMC_UART_LINK_NODES) || (link->baudrateCount == 0))
+		return false;
+
+	for(link->baudrateIndex = 0; link->baudrateIndex < link->baudrateCount; link->baudrateIndex++)
+	{
+		link->setBaudrate(channel, link->baudrates[link->baudrateIndex]);
+
+		for(link->sendDelay = minimumDelay; link->sendDelay <= 14; link->sendDelay += 2)
+		{
+			if(probeLink(uart, channel, slaveAddresses, count, link->sendDelay, MAX(link->probeReads, 1)))
+				return true;
+		}
+	}
+
+	// Nothing worked: Stay with the slowest baud rate and the longest delay
+	link->baudrateIndex = link->baudrateCount - 1;
+	link->sendDelay     = 14;
+
+	return false;
+}
+bool tmc_uart_linkReply(TMCUartLink *link, bool valid)
+{
+	if(valid)
+	{
+		link->errors = 0;
+		return false;
+	}
+
+	if((link->errorLimit == 0) || (++link->errors < link->errorLimit))
+		return false;
+
+	link->errors = 0;
+
+	if(link->baudrateIndex + 1 >= link->baudrateCount)
+		return false;
+
+	link->baudrateIndex++;
+	link->setBaudrate(link->channel, link->baudrates[link->baudrateIndex]);
+
+	return true;
+}
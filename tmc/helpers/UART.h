@@ -0,0 +1,134 @@
+/*
+ * UART.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Datagram engine of the single wire UART interface shared by the UART ICs.
+ *  Requests and replies are contiguous byte buffers, so the board wrapper can
+ *  send a request and receive its reply with a single (DMA) transfer.
+ *
+ *  Write request: sync, slave address, register address | write bit, 4 data bytes (MSB first), CRC
+ *  Read request:  sync, slave address, register address, CRC
+ *  Read reply:    sync, master address, register address, 4 data bytes (MSB first), CRC
+ *
+ *  Single wire boards receive every sent byte back before the reply. With
+ *  TMC_UART_ECHO the reply wait covers the echo as well: A read receives the echo
+ *  and the reply with one transfer, and the echo is compared against the request
+ *  before the reply is looked at. An echo mismatch means another node drove the
+ *  line at the same time, so collisions fail without waiting for a CRC error.
+ */
+
+#ifndef TMC_HELPERS_UART_H_
+#define TMC_HELPERS_UART_H_
+
+#include <stddef.h>
+#include "Types.h"
+#include "CRC.h"
+#include "Instrumentation.h"
+
+#define TMC_UART_SYNC            0x05
+#define TMC_UART_MASTER_ADDRESS  0xFF
+
+#define TMC_UART_WRITE_LENGTH    8
+#define TMC_UART_REQUEST_LENGTH  4
+#define TMC_UART_REPLY_LENGTH    8
+
+// Uncomment if the transport receives the echo of the sent bytes (single wire UART).
+// The readLength passed to the readWriteArray wrapper then includes the echo.
+//#define TMC_UART_ECHO
+
+// Bytes received back for [length] sent bytes
+#ifdef TMC_UART_ECHO
+#define TMC_UART_ECHO_LENGTH(length)  (length)
+#else
+#define TMC_UART_ECHO_LENGTH(length)  0
+#endif
+
+// Receive length and buffer size of a complete read
+#define TMC_UART_READ_LENGTH     (TMC_UART_ECHO_LENGTH(TMC_UART_REQUEST_LENGTH) + TMC_UART_REPLY_LENGTH)
+
+// Amount of repeated read requests after an invalid reply, 0 disables retrying.
+// Retries are counted by the instrumentation (TMC_INSTRUMENT_RETRY).
+#ifndef TMC_UART_READ_RETRIES
+#define TMC_UART_READ_RETRIES  2
+#endif
+
+// Send [writeLength] bytes of [data], then receive [readLength] bytes into [data]
+typedef void (*tmc_uart_readWriteArray)(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
+typedef uint8_t (*tmc_uart_crc)(uint8_t *data, size_t length);
+
+// UART wrapper of an IC. With TMC_CRC8_ENGINE_FLASH the constant CRC table is
+// used directly and [crc] may be NULL.
+typedef struct
+{
+	tmc_uart_readWriteArray readWriteArray;
+	tmc_uart_crc crc;
+#ifdef TMC_INSTRUMENT_ENABLED
+	const char *name; // Set with TMC_INSTRUMENT_NAME()
+#endif
+} TMCUartInterface;
+
+void tmc_uart_fillWriteFrame(const TMCUartInterface *uart, uint8_t *data, uint8_t slaveAddress, uint8_t address, int32_t value);
+void tmc_uart_fillReadFrame(const TMCUartInterface *uart, uint8_t *data, uint8_t slaveAddress, uint8_t address);
+
+// Validate the received data of a read of [address] (echo and reply) and store its value.
+// Returns false on an echo mismatch or a wrong sync nibble, master address, register address or CRC.
+bool tmc_uart_checkReply(const TMCUartInterface *uart, uint8_t *data, uint8_t slaveAddress, uint8_t address, int32_t *value);
+
+// Compare the received echo of a write frame. Always true without TMC_UART_ECHO.
+bool tmc_uart_checkWriteEcho(const TMCUartInterface *uart, const uint8_t *data, uint8_t slaveAddress, uint8_t address, int32_t value);
+
+// Returns false if the echo shows a collision
+bool tmc_uart_writeInt(const TMCUartInterface *uart, uint8_t channel, uint8_t slaveAddress, uint8_t address, int32_t value);
+
+// Read [address], repeating the request up to TMC_UART_READ_RETRIES times on an invalid reply.
+// Returns false if no valid reply was received, [value] is 0 then.
+bool tmc_uart_readInt(const TMCUartInterface *uart, uint8_t channel, uint8_t slaveAddress, uint8_t address, int32_t *value);
+
+// Link tuning
+// The ICs detect the baud rate from the sync nibble of every request and wait
+// SENDDELAY bit times before replying. tmc_uart_tuneLink() searches the fastest
+// baud rate of a candidate list, and the shortest SENDDELAY at that rate, for
+// which all slaves of a channel answer reliably. Each candidate is probed with
+// IFCNT reads: A SLAVECONF write sent to all slaves in one transfer has to
+// increment every IFCNT, and all following probe reads have to be valid.
+// Afterwards, the driver reports every checked read with tmc_uart_linkReply().
+// After [errorLimit] consecutive invalid replies, the link falls back to the
+// next slower baud rate. SENDDELAY is kept, it does not depend on the baud rate.
+
+// IFCNT and SLAVECONF of all single wire UART ICs
+#define TMC_UART_IFCNT             0x02
+#define TMC_UART_SLAVECONF         0x03
+#define TMC_UART_SENDDELAY_SHIFT   8
+
+// Maximum amount of slaves on one channel
+#define TMC_UART_LINK_NODES        4
+
+// Switch the host UART of [channel] to [baudrate]
+typedef void (*tmc_uart_setBaudrate)(uint8_t channel, uint32_t baudrate);
+
+typedef struct
+{
+	// Configuration
+	const uint32_t *baudrates;         // Candidates, fastest first
+	uint8_t baudrateCount;
+	tmc_uart_setBaudrate setBaudrate;
+	uint8_t probeReads;                // Reads per slave and candidate
+	uint8_t errorLimit;                // Consecutive invalid replies before falling back, 0: never
+
+	// State
+	uint8_t channel;
+	uint8_t baudrateIndex;             // Current entry of baudrates
+	uint8_t sendDelay;                 // Current SENDDELAY of all slaves
+	uint8_t errors;                    // Consecutive invalid replies
+} TMCUartLink;
+
+// Returns false if no candidate worked. The link then uses the slowest baud rate
+// and the longest SENDDELAY.
+bool tmc_uart_tuneLink(TMCUartLink *link, const TMCUartInterface *uart, uint8_t channel, const uint8_t *slaveAddresses, uint8_t count);
+
+// Count a checked read on the link. Returns true if the link fell back to a slower baud rate.
+bool tmc_uart_linkReply(TMCUartLink *link, bool valid);
+
+#endif /* TMC_HELPERS_UART_H_ */
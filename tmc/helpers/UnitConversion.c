@@ -0,0 +1,144 @@
+/*
+ * UnitConversion.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "UnitConversion.h"
+#include "ChopperPlan.h"
+#include "Functions.h"
+#include "Macros.h"
+
+// factor = 2^numeratorShift / divisor, with a binary long division
+static void reciprocalFactor(TMCUnitFactor *factor, uint8_t numeratorShift, uint64_t divisor)
+{
+	uint64_t remainder = 1;
+	uint8_t bits = 0;
+	uint8_t i;
+
+	if(divisor == 0)
+	{
+		factor->multiplier  = 0;
+		factor->shift       = 0;
+		return;
+	}
+
+	// 2^(bits-1) < divisor <= 2^bits
+	while((bits < 63) && ((remainder << bits) < divisor))
+		bits++;
+
+	// 2^(bits+31) / divisor lies within 2^31..2^32-1
+	remainder  = (1ULL << bits) - divisor;
+	factor->multiplier = 1;
+
+	for(i = 0; i < 31; i++)
+	{
+		remainder <<= 1;
+		factor->multiplier <<= 1;
+		if(remainder >= divisor)
+		{
+			remainder -= divisor;
+			factor->multiplier |= 1;
+		}
+	}
+
+	factor->shift = bits + 31 - numeratorShift;
+}
+
+// factor = value / 2^denominatorShift
+static void scaleFactor(TMCUnitFactor *factor, uint64_t value, uint8_t denominatorShift)
+{
+	int8_t shift = denominatorShift;
+
+	if(value == 0)
+	{
+		factor->multiplier  = 0;
+		factor->shift       = 0;
+		return;
+	}
+
+	// Normalize into 2^31..2^32-1
+	while(value >= (1ULL << 32))
+	{
+		value >>= 1;
+		shift--;
+	}
+	while(value < (1ULL << 31))
+	{
+		value <<= 1;
+		shift++;
+	}
+
+	factor->multiplier  = value;
+	factor->shift       = MAX(shift, 0);
+}
+
+void tmc_units_init(TMCUnitConversion *units, uint32_t clockFrequency)
+{
+	uint64_t clockSquared = (uint64_t) clockFrequency * clockFrequency;
+
+	units->clockFrequency = clockFrequency;
+
+	reciprocalFactor(&units->velocityToVMax, 24, clockFrequency);
+	scaleFactor(&units->vMaxToVelocity, clockFrequency, 24);
+	reciprocalFactor(&units->accelerationToAMax, 41, clockSquared);
+	scaleFactor(&units->aMaxToAcceleration, clockSquared, 41);
+
+	units->velocityScale = tmc_velocityScale(clockFrequency);
+}
+
+uint32_t tmc_units_apply(const TMCUnitFactor *factor, uint32_t value)
+{
+	uint64_t result = (uint64_t) value * factor->multiplier;
+
+	if(factor->shift == 0)
+		return (result > UINT32_MAX) ? UINT32_MAX : result;
+
+	if(factor->shift > 64)
+		return 0;
+
+	result = ((result >> (factor->shift - 1)) + 1) >> 1;
+
+	return (result > UINT32_MAX) ? UINT32_MAX : result;
+}
+
+uint32_t tmc_units_velocityToTStep(const TMCUnitConversion *units, uint32_t velocity)
+{
+	if(velocity == 0)
+		return TMC_TSTEP_MAX;
+
+	return MIN(MAX(units->clockFrequency / velocity, 1), TMC_TSTEP_MAX);
+}
+
+uint32_t tmc_units_tStepToVelocity(const TMCUnitConversion *units, uint32_t tstep)
+{
+	if(tstep == 0)
+		return 0;
+
+	return units->clockFrequency / tstep;
+}
+
+void tmc_units_toRampProfile(const TMCUnitConversion *units, const TMCRampProfileTypeDef *physical, TMCRampProfileTypeDef *profile)
+{
+	profile->vStart  = MIN(tmc_units_velocityToVMax(units, physical->vStart), TMC_RAMP_PROFILE_VMAX_LIMIT);
+	profile->a1      = MIN(tmc_units_accelerationToAMax(units, physical->a1), TMC_RAMP_PROFILE_AMAX_LIMIT);
+	profile->v1      = MIN(tmc_units_velocityToVMax(units, physical->v1), TMC_RAMP_PROFILE_VMAX_LIMIT);
+	profile->aMax    = MIN(tmc_units_accelerationToAMax(units, physical->aMax), TMC_RAMP_PROFILE_AMAX_LIMIT);
+	profile->vMax    = MIN(tmc_units_velocityToVMax(units, physical->vMax), TMC_RAMP_PROFILE_VMAX_LIMIT);
+	profile->dMax    = MIN(tmc_units_accelerationToAMax(units, physical->dMax), TMC_RAMP_PROFILE_AMAX_LIMIT);
+	profile->d1      = MIN(tmc_units_accelerationToAMax(units, physical->d1), TMC_RAMP_PROFILE_AMAX_LIMIT);
+	profile->vStop   = MIN(tmc_units_velocityToVMax(units, physical->vStop), TMC_RAMP_PROFILE_VMAX_LIMIT);
+}
+
+void tmc_units_fromRampProfile(const TMCUnitConversion *units, const TMCRampProfileTypeDef *profile, TMCRampProfileTypeDef *physical)
+{
+	physical->vStart  = tmc_units_vMaxToVelocity(units, profile->vStart);
+	physical->a1      = tmc_units_aMaxToAcceleration(units, profile->a1);
+	physical->v1      = tmc_units_vMaxToVelocity(units, profile->v1);
+	physical->aMax    = tmc_units_aMaxToAcceleration(units, profile->aMax);
+	physical->vMax    = tmc_units_vMaxToVelocity(units, profile->vMax);
+	physical->dMax    = tmc_units_aMaxToAcceleration(units, profile->dMax);
+	physical->d1      = tmc_units_aMaxToAcceleration(units, profile->d1);
+	physical->vStop   = tmc_units_vMaxToVelocity(units, profile->vStop);
+}
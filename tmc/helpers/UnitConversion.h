@@ -0,0 +1,76 @@
+/*
+ * UnitConversion.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Clock aware conversion between physical units and the internal units of the
+ *  TMC5xxx motion controllers:
+ *    VMAX  = v[usteps/s] * 2^24 / fCLK
+ *    AMAX  = a[usteps/s^2] * 2^41 / fCLK^2   (also A1, DMAX, D1)
+ *    TSTEP = fCLK / v[usteps/s]              (also TPWMTHRS, TCOOLTHRS, THIGH)
+ *
+ *  TSTEP counts clock cycles per 1/256 microstep, so its velocities are in
+ *  1/256 microsteps per second regardless of MRES.
+ *
+ *  tmc_units_init() calculates the factors for one clock frequency, once. Each
+ *  VMAX/AMAX conversion is then one 32x32 bit multiplication into 64 bits and a
+ *  shift: The factors are stored as a normalized 32 bit multiplier (Q32 like,
+ *  2^31 <= multiplier < 2^32) and the shift belonging to it. TSTEP is inversely
+ *  proportional to the velocity and needs one 32 bit division.
+ */
+
+#ifndef TMC_HELPERS_UNITCONVERSION_H_
+#define TMC_HELPERS_UNITCONVERSION_H_
+
+#include "Types.h"
+#include "RampProfile.h"
+
+// The 16 MHz internal clock of most motion controllers
+#define TMC_UNITS_DEFAULT_CLOCK 16000000
+
+// result = value * multiplier / 2^shift
+typedef struct
+{
+	uint32_t multiplier;
+	uint8_t shift;
+} TMCUnitFactor;
+
+typedef struct
+{
+	uint32_t clockFrequency;
+	TMCUnitFactor velocityToVMax;
+	TMCUnitFactor vMaxToVelocity;
+	TMCUnitFactor accelerationToAMax;
+	TMCUnitFactor aMaxToAcceleration;
+	uint32_t velocityScale; // Factor for tmc_estimateVelocityScaled(), see tmc_velocityScale()
+} TMCUnitConversion;
+
+// Source of the velocity kept by the periodic job of the motion controllers
+typedef enum {
+	TMC_VELOCITY_SOURCE_ESTIMATE,  // Derivative of XACTUAL (default)
+	TMC_VELOCITY_SOURCE_VACTUAL,   // VACTUAL register of the ramp generator
+	TMC_VELOCITY_SOURCE_NONE       // No velocity, no bus access
+} TMCVelocitySource;
+
+void tmc_units_init(TMCUnitConversion *units, uint32_t clockFrequency);
+
+// Rounded, saturated at UINT32_MAX
+uint32_t tmc_units_apply(const TMCUnitFactor *factor, uint32_t value);
+
+#define tmc_units_velocityToVMax(units, velocity)          tmc_units_apply(&(units)->velocityToVMax, velocity)
+#define tmc_units_vMaxToVelocity(units, vMax)              tmc_units_apply(&(units)->vMaxToVelocity, vMax)
+#define tmc_units_accelerationToAMax(units, acceleration)  tmc_units_apply(&(units)->accelerationToAMax, acceleration)
+#define tmc_units_aMaxToAcceleration(units, aMax)          tmc_units_apply(&(units)->aMaxToAcceleration, aMax)
+
+// Limited to 1..TMC_TSTEP_MAX, a velocity of 0 gives TMC_TSTEP_MAX
+uint32_t tmc_units_velocityToTStep(const TMCUnitConversion *units, uint32_t velocity);
+// A TSTEP of 0 gives 0
+uint32_t tmc_units_tStepToVelocity(const TMCUnitConversion *units, uint32_t tstep);
+
+// Convert a whole ramp parameter set. [physical] holds velocities in usteps/s and
+// accelerations in usteps/s^2, the internal values are limited to the register ranges.
+void tmc_units_toRampProfile(const TMCUnitConversion *units, const TMCRampProfileTypeDef *physical, TMCRampProfileTypeDef *profile);
+void tmc_units_fromRampProfile(const TMCUnitConversion *units, const TMCRampProfileTypeDef *profile, TMCRampProfileTypeDef *physical);
+
+#endif /* TMC_HELPERS_UNITCONVERSION_H_ */
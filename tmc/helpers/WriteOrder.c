@@ -0,0 +1,74 @@
+/*
+ * WriteOrder.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "WriteOrder.h"
+
+// Position of [address] in the sequence, [count] if it is not written
+static uint8_t findInSequence(const uint8_t *addresses, const uint8_t *sequence, uint8_t count, uint8_t address)
+{
+	uint8_t i;
+
+	for(i = 0; i < count; i++)
+		if(addresses[sequence[i]] == address)
+			break;
+
+	return i;
+}
+
+void tmc_writeOrder_sort(const TMCWriteOrder *order, size_t orderCount, const uint8_t *addresses, uint8_t *sequence, uint8_t count)
+{
+	uint8_t pass, i;
+	size_t j;
+	bool moved = true;
+
+	for(i = 0; i < count; i++)
+		sequence[i] = i;
+
+	// Every pass settles at least one register for acyclic constraints
+	for(pass = 0; moved && (pass < count); pass++)
+	{
+		moved = false;
+
+		for(j = 0; j < orderCount; j++)
+		{
+			uint8_t before = findInSequence(addresses, sequence, count, order[j].before);
+			uint8_t after  = findInSequence(addresses, sequence, count, order[j].after);
+			uint8_t index;
+
+			if((before == count) || (after == count) || (before < after))
+				continue;
+
+			// Move [before] right in front of [after]
+			index = sequence[before];
+			for(i = before; i > after; i--)
+				sequence[i] = sequence[i - 1];
+			sequence[after] = index;
+
+			moved = true;
+		}
+	}
+}
+
+bool tmc_writeOrder_check(const TMCWriteOrder *order, size_t orderCount, const uint8_t *addresses, size_t count)
+{
+	size_t i, j;
+
+	for(j = 0; j < orderCount; j++)
+	{
+		bool afterSeen = false;
+
+		for(i = 0; i < count; i++)
+		{
+			if(addresses[i] == order[j].after)
+				afterSeen = true;
+			else if((addresses[i] == order[j].before) && afterSeen)
+				return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,43 @@
+/*
+ * WriteOrder.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Write order constraints between registers of an IC.
+ *
+ *  Some registers only take effect correctly if others were written before,
+ *  e.g. the motor current (GLOBAL_SCALER, IHOLD_IRUN) and the driver strength
+ *  (DRV_CONF) have to be set before CHOPCONF enables the driver with TOFF > 0.
+ *  The IC headers list these pairs in a constant table, e.g. tmc5160_writeOrder.
+ *  Every engine writing several registers in one go respects them:
+ *  - The command queue (CommandQueue.h) sorts the coalesced writes of a drain
+ *    with tmc_writeOrder_sort(), see tmc_queue_drainOrdered().
+ *  - The configuration walks the fixed register lists of the IC headers. Their
+ *    order is checked with tmc_writeOrder_check(), see tmc_driver_checkWriteOrder().
+ *  All other registers may be written in any order, so the engines are free to
+ *  merge and batch them.
+ */
+
+#ifndef TMC_HELPERS_WRITEORDER_H_
+#define TMC_HELPERS_WRITEORDER_H_
+
+#include "Types.h"
+
+// [before] has to be written before [after] if both are written together
+typedef struct
+{
+	uint8_t before;
+	uint8_t after;
+} TMCWriteOrder;
+
+// Write sequence of [count] registers at [addresses]: [sequence] receives the
+// indices into [addresses] in write order. Registers are only moved as far as a
+// constraint requires, everything else keeps its order. Cyclic constraints are
+// not resolved, the sequence then holds one of the orders tried.
+void tmc_writeOrder_sort(const TMCWriteOrder *order, size_t orderCount, const uint8_t *addresses, uint8_t *sequence, uint8_t count);
+
+// Returns true if the registers at [addresses] are written in an allowed order
+bool tmc_writeOrder_check(const TMCWriteOrder *order, size_t orderCount, const uint8_t *addresses, size_t count);
+
+#endif /* TMC_HELPERS_WRITEORDER_H_ */
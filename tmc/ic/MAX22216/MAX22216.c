@@ -8,6 +8,8 @@
 
 // => UART wrapper
 extern void max22216_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define max22216_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("MAX22216", max22216_readWriteArray, channel, data, length)
 // <= UART wrapper
 
 // => CRC wrapper
@@ -17,18 +19,7 @@ extern void max22216_readWriteArray(uint8_t channel, uint8_t *data, size_t lengt
 // length in bits
 uint8_t max22216_CRC(uint8_t *data, size_t length)
 {
-	uint8_t crc = 0b11111;
-	uint8_t crc_old;
-	for(size_t i = 0; i < length; i++) {
-		crc_old = crc;
-		crc = FIELD_SET(crc, (1 << 5), 5, FIELD_GET(crc_old, (1 << 4), 4));
-		crc = FIELD_SET(crc, (1 << 4), 4, FIELD_GET(crc_old, (1 << 3), 3) ^ FIELD_GET(crc_old, (1 << 4), 4) ^ FIELD_GET(data[i / 8], (1 << (7 - (i % 8))), 7 - (i % 8)));
-		crc = FIELD_SET(crc, (1 << 3), 3, FIELD_GET(crc_old, (1 << 2), 2));
-		crc = FIELD_SET(crc, (1 << 2), 2, FIELD_GET(crc_old, (1 << 1), 1) ^ FIELD_GET(crc_old, (1 << 4), 4) ^ FIELD_GET(data[i / 8], (1 << (7 - (i % 8))), 7 - (i % 8)));
-		crc = FIELD_SET(crc, (1 << 1), 1, FIELD_GET(crc_old, 1, 0));
-		crc = FIELD_SET(crc, 1, 0, FIELD_GET(crc_old, (1 << 4), 4) ^ FIELD_GET(data[i / 8], (1 << (7 - (i % 8))), 7 - (i % 8)));
-	}
-	return (crc & 0x1F);
+	return tmc_CRC5(data, length, TMC_CRC5_INIT);
 }
 
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
@@ -45,6 +36,13 @@ void max22216_writeDatagram(MAX22216TypeDef *max22216, uint8_t address, uint8_t
 
 void max22216_writeInt(MAX22216TypeDef *max22216, uint8_t address, int16_t value)
 {
+	// Writing the dependency register directly makes the written value the one to keep
+	if((max22216->depState != MAX22216_DEP_NONE) && (TMC_ADDRESS(address) == max22216->depAddress))
+	{
+		max22216->depValue = value;
+		max22216->depState = MAX22216_DEP_VALID;
+	}
+
 	max22216_writeDatagram(max22216, address, BYTE(value, 1), BYTE(value, 0));
 }
 
@@ -67,6 +65,67 @@ int32_t max22216_readInt(MAX22216TypeDef *max22216, uint8_t address)
 	return _8_16(data[1], data[2]);
 }
 
+// Registers of the telemetry snapshot, in the order of the burst
+static const uint8_t telemetryAddresses[] =
+{
+	MAX22216_I_DC_0, MAX22216_I_DC_1, MAX22216_I_DC_2, MAX22216_I_DC_3,
+	MAX22216_STATUS, MAX22216_FAULT0, MAX22216_FAULT1
+};
+
+// Each datagram clocks out the reply to the previous one, so the burst takes
+// one transfer more than it reads registers instead of two per register.
+bool max22216_readTelemetry(MAX22216TypeDef *max22216, MAX22216TelemetryTypeDef *telemetry)
+{
+	uint16_t values[ARRAY_SIZE(telemetryAddresses)];
+	uint8_t data[4];
+	size_t length = (max22216->crc_en) ? 4 : 3;
+	bool valid = true;
+	size_t i;
+
+	for(i = 0; i <= ARRAY_SIZE(telemetryAddresses); i++)
+	{
+		// The last datagram only fetches the reply of the previous one
+		data[0] = telemetryAddresses[MIN(i, ARRAY_SIZE(telemetryAddresses) - 1)];
+		data[1] = data[2] = data[3] = 0;
+		if(max22216->crc_en)
+			data[3] = max22216_CRC(&data[0], 27);
+		max22216_readWriteArray(max22216->channel, &data[0], length);
+
+		if(i == 0)
+			continue;
+
+		if(max22216->crc_en && ((data[3] & 0x1F) != max22216_CRC(&data[0], 27)))
+			valid = false;
+
+		values[i - 1] = _8_16(data[1], data[2]);
+	}
+
+	for(i = 0; i < MAX22216_CHANNELS; i++)
+		telemetry->current[i] = values[i];
+
+	telemetry->status  = values[4];
+	telemetry->fault0  = values[5];
+	telemetry->fault1  = values[6];
+
+	// FAULT0 holds OCP, HHF, OLF and DPM of the channels in groups of four bits,
+	// FAULT1 IND in bits 0..3 and RES in bits 7..10
+	for(i = 0; i < MAX22216_CHANNELS; i++)
+	{
+		uint8_t faults = 0;
+
+		if(telemetry->fault0 & (MAX22216_OCP0_MASK << i))  faults |= MAX22216_CHANNEL_OCP;
+		if(telemetry->fault0 & (MAX22216_HHF0_MASK << i))  faults |= MAX22216_CHANNEL_HHF;
+		if(telemetry->fault0 & (MAX22216_OLF0_MASK << i))  faults |= MAX22216_CHANNEL_OLF;
+		if(telemetry->fault0 & (MAX22216_DPM0_MASK << i))  faults |= MAX22216_CHANNEL_DPM;
+		if(telemetry->fault1 & (MAX22216_IND0_MASK << i))  faults |= MAX22216_CHANNEL_IND;
+		if(telemetry->fault1 & (MAX22216_RES0_MASK << i))  faults |= MAX22216_CHANNEL_RES;
+
+		telemetry->faults[i] = faults;
+	}
+
+	return valid;
+}
+
 void max22216_writeInt_UART(MAX22216TypeDef *max22216, uint8_t address, int32_t value)
 {
 	uint8_t data[8];
@@ -113,20 +172,83 @@ int32_t max22216_readInt_UART(MAX22216TypeDef *max22216, uint8_t address)
 	return _8_32(data[3], data[4], data[5], data[6]);
 }
 
+// Set the dependency register, remembering the value to restore
+static void setDep(MAX22216TypeDef *max22216, uint8_t dep_address, int32_t dep_value)
+{
+	dep_address = TMC_ADDRESS(dep_address);
+
+	if((max22216->depState != MAX22216_DEP_NONE) && (max22216->depAddress != dep_address))
+	{
+		max22216_restoreDep(max22216);
+		max22216->depState = MAX22216_DEP_NONE;
+	}
+
+	if(max22216->depState == MAX22216_DEP_NONE)
+	{
+		max22216->depAddress = dep_address;
+		max22216->depValue = max22216_readInt(max22216, dep_address);
+		max22216->depState = MAX22216_DEP_VALID;
+	}
+
+	if(max22216->depValue == dep_value)
+		return;
+
+	if(max22216->depState == MAX22216_DEP_VALID)
+	{
+		max22216->depRestore = max22216->depValue;
+		max22216->depState = MAX22216_DEP_CHANGED;
+	}
+	else if(max22216->depRestore == dep_value)
+	{
+		max22216->depState = MAX22216_DEP_VALID;
+	}
+
+	max22216_writeDatagram(max22216, dep_address, BYTE(dep_value, 1), BYTE(dep_value, 0));
+	max22216->depValue = dep_value;
+}
+
+void max22216_restoreDep(MAX22216TypeDef *max22216)
+{
+	if(max22216->depState != MAX22216_DEP_CHANGED)
+		return;
+
+	max22216_writeDatagram(max22216, max22216->depAddress, BYTE(max22216->depRestore, 1), BYTE(max22216->depRestore, 0));
+	max22216->depValue = max22216->depRestore;
+	max22216->depState = MAX22216_DEP_VALID;
+}
+
+void max22216_writeIntDepBatch(MAX22216TypeDef *max22216, const uint8_t *addresses, const int32_t *values, size_t count, uint8_t dep_address, int32_t dep_value, bool restore)
+{
+	setDep(max22216, dep_address, dep_value);
+
+	for(size_t i = 0; i < count; i++)
+		max22216_writeInt(max22216, addresses[i], values[i]);
+
+	if(restore)
+		max22216_restoreDep(max22216);
+}
+
+void max22216_readIntDepBatch(MAX22216TypeDef *max22216, const uint8_t *addresses, int32_t *values, size_t count, uint8_t dep_address, int32_t dep_value, bool restore)
+{
+	setDep(max22216, dep_address, dep_value);
+
+	for(size_t i = 0; i < count; i++)
+		values[i] = max22216_readInt(max22216, addresses[i]);
+
+	if(restore)
+		max22216_restoreDep(max22216);
+}
+
 void max22216_writeIntDep(MAX22216TypeDef *max22216, uint8_t address, int32_t value, uint8_t dep_address, int32_t dep_value)
 {
-	int32_t old = max22216_readInt(max22216, dep_address);
-	max22216_writeInt(max22216, dep_address, dep_value);
-	max22216_writeInt(max22216, address, value);
-	max22216_writeInt(max22216, dep_address, old);
+	max22216_writeIntDepBatch(max22216, &address, &value, 1, dep_address, dep_value, true);
 }
 
 int32_t max22216_readIntDep(MAX22216TypeDef *max22216, uint8_t address, uint8_t dep_address, int32_t dep_value)
 {
-	int32_t old = max22216_readInt(max22216, dep_address);
-	max22216_writeInt(max22216, dep_address, dep_value);
-	int32_t value = max22216_readInt(max22216, address);
-	max22216_writeInt(max22216, dep_address, old);
+	int32_t value;
+
+	max22216_readIntDepBatch(max22216, &address, &value, 1, dep_address, dep_value, true);
 	return value;
 }
 
@@ -135,6 +257,7 @@ void max22216_init(MAX22216TypeDef *max22216, uint8_t channel)
 	max22216->slaveAddress = channel;
 	max22216->channel = channel;
 	max22216->crc_en = 0;
+	max22216->depState = MAX22216_DEP_NONE;
 }
 
 uint8_t max22216_getSlaveAddress(const MAX22216TypeDef *max22216)
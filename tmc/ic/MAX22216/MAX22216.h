@@ -18,23 +18,70 @@
 	FIELD_GET(max22216_readInt(tdef, address), mask, shift)
 #define MAX22216_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(max22216_writeInt(tdef, address, FIELD_SET(max22216_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define MAX22216_FIELDS_WRITE(tdef, address, mask, values) \
+	(max22216_writeInt(tdef, address, FIELDS_SET(max22216_readInt(tdef, address), mask, values)))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
 	uint8_t channel;
 	uint8_t slaveAddress;
 	uint8_t crc_en;
+
+	// Shadow of the dependency (selector) register of the *IntDep functions
+	uint8_t depState;    // MAX22216_DEP_*
+	uint8_t depAddress;
+	int32_t depValue;    // Current value of depAddress
+	int32_t depRestore;  // Value before the first batch changed it
 } MAX22216TypeDef;
 
+// Telemetry snapshot of the four channels, see max22216_readTelemetry()
+#define MAX22216_CHANNELS  4
+
+// Decoded faults of a channel
+#define MAX22216_CHANNEL_OCP  0x01  // Overcurrent
+#define MAX22216_CHANNEL_HHF  0x02  // Hit current not reached
+#define MAX22216_CHANNEL_OLF  0x04  // Open load
+#define MAX22216_CHANNEL_DPM  0x08  // Plunger movement not detected
+#define MAX22216_CHANNEL_IND  0x10  // Inductance out of range
+#define MAX22216_CHANNEL_RES  0x20  // Resistance out of range
+
+typedef struct {
+	uint16_t current[MAX22216_CHANNELS]; // I_DC of each channel
+	uint8_t faults[MAX22216_CHANNELS];   // MAX22216_CHANNEL_* flags
+	uint16_t status;                     // STATUS
+	uint16_t fault0;                     // FAULT0
+	uint16_t fault1;                     // FAULT1
+} MAX22216TelemetryTypeDef;
+
+#define MAX22216_DEP_NONE     0  // No shadow
+#define MAX22216_DEP_VALID    1  // depValue is the register value
+#define MAX22216_DEP_CHANGED  2  // depValue was set by a batch, depRestore is pending
+
 uint8_t max22216_CRC(uint8_t *data, size_t length);
 
 void max22216_writeDatagram(MAX22216TypeDef *max22216, uint8_t address, uint8_t x1, uint8_t x2);
 void max22216_writeInt(MAX22216TypeDef *max22216, uint8_t address, int16_t value);
 int32_t max22216_readInt(MAX22216TypeDef *max22216, uint8_t address);
 
+// Read the currents and the status and fault registers of all channels with one
+// pipelined burst. Returns false if a reply CRC did not match (only checked with
+// crc_en), the snapshot is incomplete then. Reading FAULT0/FAULT1 clears their
+// latched bits like a max22216_readInt() does.
+bool max22216_readTelemetry(MAX22216TypeDef *max22216, MAX22216TelemetryTypeDef *telemetry);
+
 void max22216_writeIntDep(MAX22216TypeDef *max22216, uint8_t address, int32_t value, uint8_t dep_address, int32_t dep_value);
 int32_t max22216_readIntDep(MAX22216TypeDef *max22216, uint8_t address, uint8_t dep_address, int32_t dep_value);
 
+// Access [count] registers that all need dep_address set to dep_value.
+// The dependency register is only written if it does not hold dep_value yet. With [restore]
+// set, its previous value is written back afterwards. Without, it is kept for the next batch
+// and restored by a batch with [restore] set, by a batch with another dependency register
+// or by max22216_restoreDep().
+void max22216_writeIntDepBatch(MAX22216TypeDef *max22216, const uint8_t *addresses, const int32_t *values, size_t count, uint8_t dep_address, int32_t dep_value, bool restore);
+void max22216_readIntDepBatch(MAX22216TypeDef *max22216, const uint8_t *addresses, int32_t *values, size_t count, uint8_t dep_address, int32_t dep_value, bool restore);
+void max22216_restoreDep(MAX22216TypeDef *max22216);
+
 void max22216_init(MAX22216TypeDef *max22216, uint8_t channel);
 
 uint8_t max22216_getSlaveAddress(const MAX22216TypeDef *max22216);
@@ -9,6 +9,8 @@
 
 // => SPI wrapper
 extern void tmc2041_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc2041_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC2041", tmc2041_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
 void tmc2041_writeDatagram(TMC2041TypeDef *tmc2041, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
@@ -20,7 +22,7 @@ void tmc2041_writeDatagram(TMC2041TypeDef *tmc2041, uint8_t address, uint8_t x1,
 
 	// Write to the shadow register and mark the register dirty
 	address = address & ~TMC2041_WRITE_BIT;
-	tmc2041->config->shadowRegister[address] = value;
+	TMC_SHADOW_REGISTER(tmc2041->config, address) = value;
 	tmc2041->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
@@ -35,7 +37,7 @@ int32_t tmc2041_readInt(TMC2041TypeDef *tmc2041, uint8_t address)
 
 	// register not readable -> shadow register copy
 	if(!TMC_IS_READABLE(tmc2041->registerAccess[address]))
-		return tmc2041->config->shadowRegister[address];
+		return TMC_SHADOW_REGISTER(tmc2041->config, address);
 
 	uint8_t data[5];
 
@@ -45,59 +47,65 @@ int32_t tmc2041_readInt(TMC2041TypeDef *tmc2041, uint8_t address)
 	data[0] = address;
 	tmc2041_readWriteArray(tmc2041->config->channel, &data[0], 5);
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+	return tmc_unpackInt32(&data[1]);
 }
 
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2041_writeInt(ic, address, value);
+}
+
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC2041_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2041_defaultRegisterAccess,
+	.resettableRegisters    = tmc2041_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2041_resettableRegisters),
+	.restorableRegisters    = tmc2041_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2041_restorableRegisters),
+	.constants              = NULL,
+	.constantCount          = 0,
+	.writeInt               = writeRegister,
+};
+
 void tmc2041_init(TMC2041TypeDef *tmc2041, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
 {
 	tmc2041->config = config;
 
-	tmc2041->config->callback     = NULL;
-	tmc2041->config->channel      = channel;
-	tmc2041->config->configIndex  = 0;
-	tmc2041->config->state        = CONFIG_READY;
+#ifdef TMC_SHADOW_SPARSE
+	tmc2041->config->shadowIndex = tmc2041_shadowIndex;
+#endif
 
-	int i;
-	for(i = 0; i < TMC2041_REGISTER_COUNT; i++)
-	{
-		tmc2041->registerAccess[i]      = tmc2041_defaultRegisterAccess[i];
-		tmc2041->registerResetState[i]  = registerResetState[i];
-	}
+#ifdef TMC2041_CONFIGURE_ONCE
+	tmc_driver_init(&driver, tmc2041->config, channel, tmc2041->registerAccess, NULL, registerResetState);
+	tmc2041->registerResetState = registerResetState;
+
+	// Write the whole configuration right away instead of one register per periodic job
+	tmc2041_reset(tmc2041);
+	tmc2041_configureBurst(tmc2041, 0);
+#else
+	tmc_driver_init(&driver, tmc2041->config, channel, tmc2041->registerAccess, tmc2041->registerResetState, registerResetState);
+#endif
 }
 
 uint8_t tmc2041_reset(TMC2041TypeDef *tmc2041)
 {
-	if(tmc2041->config->state != CONFIG_READY)
-		return 0;
-
-	int i;
-
-	// Reset the dirty bits
-	for(i = 0; i < TMC2041_REGISTER_COUNT; i++)
-		tmc2041->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-
-	tmc2041->config->state        = CONFIG_RESET;
-	tmc2041->config->configIndex  = 0;
-
-	return 1;
+	return tmc_driver_reset(&driver, tmc2041->config, tmc2041->registerAccess);
 }
 
 uint8_t tmc2041_restore(TMC2041TypeDef *tmc2041)
 {
-	if(tmc2041->config->state != CONFIG_READY)
-		return 0;
-
-	tmc2041->config->state        = CONFIG_RESTORE;
-	tmc2041->config->configIndex  = 0;
-
-	return 1;
+	return tmc_driver_restore(tmc2041->config);
 }
 
 void tmc2041_setRegisterResetState(TMC2041TypeDef *tmc2041, const int32_t *resetState)
 {
-	uint32_t i;
-	for(i = 0; i < TMC2041_REGISTER_COUNT; i++)
-		tmc2041->registerResetState[i] = resetState[i];
+#ifdef TMC2041_CONFIGURE_ONCE
+	tmc2041->registerResetState = resetState;
+#else
+	tmc_driver_setRegisterResetState(&driver, tmc2041->registerResetState, resetState);
+#endif
 }
 
 void tmc2041_setCallback(TMC2041TypeDef *tmc2041, tmc2041_callback callback)
@@ -107,46 +115,48 @@ void tmc2041_setCallback(TMC2041TypeDef *tmc2041, tmc2041_callback callback)
 
 static void writeConfiguration(TMC2041TypeDef *tmc2041)
 {
-	uint8_t *ptr = &tmc2041->config->configIndex;
-	const int32_t *settings;
+	if(!tmc_driver_writeConfiguration(&driver, tmc2041, tmc2041->config, tmc2041->registerAccess, tmc2041->registerResetState))
+		return;
 
-	if(tmc2041->config->state == CONFIG_RESTORE)
+	// Finished configuration
+	if(tmc2041->config->callback)
 	{
-		settings = tmc2041->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2041_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2041->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-	else
-	{
-		settings = tmc2041->registerResetState;
-		// Find the next restorable register
-		while((*ptr < TMC2041_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2041->registerAccess[*ptr]))
-			(*ptr)++;
+		((tmc2041_callback)tmc2041->config->callback)(tmc2041, tmc2041->config->state);
 	}
 
-	if(*ptr < TMC2041_REGISTER_COUNT)
+	tmc2041->config->state = CONFIG_READY;
+}
+
+TMCConfigStatus tmc2041_periodicJob(TMC2041TypeDef *tmc2041, uint32_t tick)
+{
+	UNUSED(tick);
+
+	if(tmc2041->config->state != CONFIG_READY)
 	{
-		tmc2041_writeInt(tmc2041, *ptr, settings[*ptr]);
-		(*ptr)++;
+		writeConfiguration(tmc2041);
+		return TMC_CONFIG_STATUS(tmc2041->config);
 	}
-	else // Finished configuration
-	{
-		if(tmc2041->config->callback)
-			((tmc2041_callback)tmc2041->config->callback)(tmc2041, tmc2041->config->state);
 
-		tmc2041->config->state = CONFIG_READY;
-	}
+	return TMC_CONFIG_STATUS_READY;
 }
 
-void tmc2041_periodicJob(TMC2041TypeDef *tmc2041, uint32_t tick)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2041_configureBurst(TMC2041TypeDef *tmc2041, uint32_t maxSteps)
 {
-	UNUSED(tick);
+	uint32_t step;
 
-	if(tmc2041->config->state != CONFIG_READY)
+	for(step = 0; tmc2041->config->state != CONFIG_READY; step++)
 	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
 		writeConfiguration(tmc2041);
-		return;
 	}
+
+	return (tmc2041->config->state == CONFIG_READY);
 }
 
@@ -18,11 +18,24 @@
 	FIELD_GET(tmc2041_readInt(tdef, address), mask, shift)
 #define TMC2041_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc2041_writeInt(tdef, address, FIELD_SET(tmc2041_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC2041_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc2041_writeInt(tdef, address, FIELDS_SET(tmc2041_readInt(tdef, address), mask, values)))
+
+// Uncomment to configure the IC only once, e.g. when it is driven by STEP/DIR
+// afterwards: tmc2041_init() writes the reset state in one burst and keeps a
+// pointer to it instead of a 512 byte copy. Combine with TMC_SHADOW_SPARSE
+// to shrink the shadow registers to the existing ones as well.
+//#define TMC2041_CONFIGURE_ONCE
 
 typedef struct
 {
 	ConfigurationTypeDef *config;
+#ifdef TMC2041_CONFIGURE_ONCE
+	const int32_t *registerResetState; // Constant table passed to tmc2041_init()
+#else
 	int32_t registerResetState[TMC2041_REGISTER_COUNT];
+#endif
 	uint8_t registerAccess[TMC2041_REGISTER_COUNT];
 } TMC2041TypeDef;
 
@@ -56,6 +69,40 @@ static const uint8_t tmc2041_defaultRegisterAccess[TMC2041_REGISTER_COUNT] = {
 	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 0x01, 0x01, 0x03, 0x02, ____, 0x01  // 0x70 - 0x7F
 };
 
+// Shadow register slots (only used with TMC_SHADOW_SPARSE)
+// Derived from tmc2041_defaultRegisterAccess - keep both in sync.
+// Registers without access share the unused slot 0.
+#define TMC2041_SHADOW_SLOTS 18
+
+static const uint8_t tmc2041_shadowIndex[TMC2041_REGISTER_COUNT] =
+{
+//	0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	0x01, 0x02, 0x03, 0x04, 0x05, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x00 - 0x0F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x10 - 0x1F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x20 - 0x2F
+	0x06, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x30 - 0x3F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x40 - 0x4F
+	0x07, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x50 - 0x5F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 0x08, 0x09, 0x0A, 0x0B, ____, 0x0C, // 0x60 - 0x6F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 0x0D, 0x0E, 0x0F, 0x10, ____, 0x11  // 0x70 - 0x7F
+};
+
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2041_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2041_resettableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x30, 0x50, 0x6C, 0x6D, 0x7C, 0x7D
+};
+
+static const uint8_t tmc2041_restorableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x30, 0x50, 0x6C, 0x6D, 0x7C, 0x7D
+};
+
 static const int32_t tmc2041_defaultRegisterResetState[TMC2041_REGISTER_COUNT] = {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
 	R00, 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 0x00 - 0x0F
@@ -85,6 +132,7 @@ uint8_t tmc2041_reset(TMC2041TypeDef *tmc2041);
 uint8_t tmc2041_restore(TMC2041TypeDef *tmc2041);
 void tmc2041_setRegisterResetState(TMC2041TypeDef *tmc2041, const int32_t *resetState);
 void tmc2041_setCallback(TMC2041TypeDef *tmc2041, tmc2041_callback callback);
-void tmc2041_periodicJob(TMC2041TypeDef *tmc2041, uint32_t tick);
+TMCConfigStatus tmc2041_periodicJob(TMC2041TypeDef *tmc2041, uint32_t tick);
+uint8_t tmc2041_configureBurst(TMC2041TypeDef *tmc2041, uint32_t maxSteps);
 
 #endif /* TMC_IC_TMC2041_H_ */
@@ -11,19 +11,25 @@
 // Send [length] bytes stored in the [data] array over SPI and overwrite [data]
 // with the reply. The first byte sent/received is data[0].
 extern void tmc2130_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc2130_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC2130", tmc2130_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
+// Keep the SPI_STATUS byte of a reply, see tmc/helpers/SPI.h
+#define captureStatus(tmc2130, status)  tmc_spi_captureStatus(&(tmc2130)->spiStatus, tmc2130, status)
+
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
 void tmc2130_writeDatagram(TMC2130TypeDef *tmc2130, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
 	uint8_t data[5] = { address | TMC2130_WRITE_BIT, x1, x2, x3, x4 };
 	tmc2130_readWriteArray(tmc2130->config->channel, &data[0], 5);
+	captureStatus(tmc2130, data[0]);
 
 	int32_t value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
 
 	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
-	tmc2130->config->shadowRegister[address] = value;
+	TMC_SHADOW_REGISTER(tmc2130->config, address) = value;
 	tmc2130->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
@@ -40,7 +46,7 @@ int32_t tmc2130_readInt(TMC2130TypeDef *tmc2130, uint8_t address)
 
 	// register not readable -> shadow register copy
 	if(!TMC_IS_READABLE(tmc2130->registerAccess[address]))
-		return tmc2130->config->shadowRegister[address];
+		return TMC_SHADOW_REGISTER(tmc2130->config, address);
 
 	uint8_t data[5] = { 0, 0, 0, 0, 0 };
 
@@ -49,107 +55,253 @@ int32_t tmc2130_readInt(TMC2130TypeDef *tmc2130, uint8_t address)
 
 	data[0] = address;
 	tmc2130_readWriteArray(tmc2130->config->channel, &data[0], 5);
+	captureStatus(tmc2130, data[0]);
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+	return tmc_unpackInt32(&data[1]);
 }
 
-// Initialize a TMC2130 IC.
-// This function requires:
-//     - channel: The channel index, which will be sent back in the SPI callback
-//     - tmc2130_config: A ConfigurationTypeDef struct, which will be used by the IC
-//     - registerResetState: An int32_t array with 128 elements. This holds the values to be used for a reset.
-void tmc2130_init(TMC2130TypeDef *tmc2130, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc2130_readIntBatch(TMC2130TypeDef *tmc2130, const uint8_t *addresses, int32_t *values, size_t count)
 {
-	tmc2130->config               = config;
-	tmc2130->config->callback     = NULL;
-	tmc2130->config->channel      = channel;
-	tmc2130->config->configIndex  = 0;
-	tmc2130->config->state        = CONFIG_READY;
-
+	uint8_t data[5];
 	size_t i;
-	for(i = 0; i < TMC2130_REGISTER_COUNT; i++)
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc2130->registerAccess[address]))
+		{
+			values[i] = TMC_SHADOW_REGISTER(tmc2130->config, address);
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc2130_readWriteArray(tmc2130->config->channel, &data[0], 5);
+		captureStatus(tmc2130, data[0]);
+
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
 	{
-		tmc2130->registerAccess[i]      = tmc2130_defaultRegisterAccess[i];
-		tmc2130->registerResetState[i]  = registerResetState[i];
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc2130_readWriteArray(tmc2130->config->channel, &data[0], 5);
+		captureStatus(tmc2130, data[0]);
+		values[pending] = tmc_unpackInt32(&data[1]);
 	}
 }
 
-// Fill the shadow registers of hardware preset non-readable registers
-// Only needed if you want to 'read' those registers e.g to display the value
-// in the TMCL IDE register browser
-void tmc2130_fillShadowRegisters(TMC2130TypeDef *tmc2130)
+// Daisy chain access
+// The frame holds one datagram per IC. The datagram sent first is shifted the
+// furthest and ends up in the last IC of the chain, the reply of the last IC
+// is also received first. All ICs are accessed with a single transfer.
+
+// Initialize a chain of [count] ICs sharing the chip select of [channel].
+// ics[0] is the IC connected to the MCU's SDO, ics[count-1] the one connected to its SDI.
+void tmc2130_chainInit(TMC2130ChainTypeDef *chain, uint8_t channel, TMC2130TypeDef **ics, uint8_t count)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc2130_RegisterConstants) == 0)
-		return;
+	chain->channel = channel;
+	chain->count   = MIN(count, TMC2130_CHAIN_MAX);
 
-	size_t i, j;
-	for(i = 0, j = 0; i < TMC2130_REGISTER_COUNT; i++)
+	for(uint8_t i = 0; i < chain->count; i++)
+		chain->ics[i] = ics[i];
+}
+
+// Write values[i] to addresses[i] of IC i, for all ICs of the chain in one transfer
+void tmc2130_chainWriteInt(TMC2130ChainTypeDef *chain, const uint8_t *addresses, const int32_t *values)
+{
+	uint8_t data[5 * TMC2130_CHAIN_MAX];
+	uint8_t i;
+
+	for(i = 0; i < chain->count; i++)
 	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc2130->registerAccess[i] != TMC_ACCESS_W_PRESET)
-			continue;
+		uint8_t *datagram = &data[5 * (chain->count - 1 - i)];
+		datagram[0] = addresses[i] | TMC2130_WRITE_BIT;
+		tmc_packInt32(&datagram[1], values[i]);
+	}
 
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc2130_RegisterConstants) && (tmc2130_RegisterConstants[j].address < i))
-			j++;
+	tmc2130_readWriteArray(chain->channel, &data[0], 5 * chain->count);
 
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc2130_RegisterConstants))
-			break;
+	for(i = 0; i < chain->count; i++)
+	{
+		captureStatus(chain->ics[i], data[5 * (chain->count - 1 - i)]);
 
-		// If we have an entry for our current address, write the constant
-		if(tmc2130_RegisterConstants[j].address == i)
-		{
-			tmc2130->config->shadowRegister[i] = tmc2130_RegisterConstants[j].value;
-		}
+		// Write to the shadow register and mark the register dirty
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+		TMC_SHADOW_REGISTER(chain->ics[i]->config, address) = values[i];
+		chain->ics[i]->registerAccess[address] |= TMC_ACCESS_DIRTY;
 	}
 }
 
-// Reset the TMC5130
-uint8_t tmc2130_reset(TMC2130TypeDef *tmc2130)
+// Write the same value to the same register of all ICs of the chain in one transfer
+void tmc2130_chainWriteIntAll(TMC2130ChainTypeDef *chain, uint8_t address, int32_t value)
 {
-	if(tmc2130->config->state != CONFIG_READY)
-		return false;
+	uint8_t addresses[TMC2130_CHAIN_MAX];
+	int32_t values[TMC2130_CHAIN_MAX];
 
-	// Reset the dirty bits
-	size_t i;
-	for(i = 0; i < TMC2130_REGISTER_COUNT; i++)
+	for(uint8_t i = 0; i < chain->count; i++)
 	{
-		tmc2130->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc2130->config->shadowRegister[i] = 0;
+		addresses[i] = address;
+		values[i]    = value;
 	}
 
-	tmc2130->config->state        = CONFIG_RESET;
-	tmc2130->config->configIndex  = 0;
+	tmc2130_chainWriteInt(chain, addresses, values);
+}
+
+// Read addresses[i] of IC i into values[i] for all ICs of the chain.
+// Takes two transfers, as the replies are sent with the following frame.
+// Registers that are not readable are taken from the shadow registers.
+void tmc2130_chainReadInt(TMC2130ChainTypeDef *chain, const uint8_t *addresses, int32_t *values)
+{
+	uint8_t data[5 * TMC2130_CHAIN_MAX];
+	uint8_t i, pass;
+
+	for(pass = 0; pass < 2; pass++)
+	{
+		for(i = 0; i < chain->count; i++)
+		{
+			uint8_t *datagram = &data[5 * (chain->count - 1 - i)];
+			datagram[0] = TMC_ADDRESS(addresses[i]);
+			datagram[1] = datagram[2] = datagram[3] = datagram[4] = 0;
+		}
+
+		tmc2130_readWriteArray(chain->channel, &data[0], 5 * chain->count);
+	}
+
+	for(i = 0; i < chain->count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+		uint8_t *datagram = &data[5 * (chain->count - 1 - i)];
+
+		captureStatus(chain->ics[i], datagram[0]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(chain->ics[i]->registerAccess[address]))
+			values[i] = TMC_SHADOW_REGISTER(chain->ics[i]->config, address);
+		else
+			values[i] = tmc_unpackInt32(&datagram[1]);
+	}
+}
+
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2130_writeInt(ic, address, value);
+}
+
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC2130_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2130_defaultRegisterAccess,
+	.resettableRegisters    = tmc2130_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2130_resettableRegisters),
+	.restorableRegisters    = tmc2130_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2130_restorableRegisters),
+	.constants              = tmc2130_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc2130_RegisterConstants),
+	.writeOrder             = tmc2130_writeOrder,
+	.writeOrderCount        = ARRAY_SIZE(tmc2130_writeOrder),
+	.writeInt               = writeRegister,
+};
+
+// Initialize a TMC2130 IC.
+// This function requires:
+//     - channel: The channel index, which will be sent back in the SPI callback
+//     - tmc2130_config: A ConfigurationTypeDef struct, which will be used by the IC
+//     - registerResetState: An int32_t array with 128 elements. This holds the values to be used for a reset.
+//       With TMC2130_CONFIGURE_ONCE it has to stay valid, it is referenced instead of copied.
+void tmc2130_init(TMC2130TypeDef *tmc2130, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
+{
+#if TMC_FEATURE_SPI_STATUS
+	tmc2130->spiStatus.status    = 0;
+	tmc2130->spiStatus.edgeMask  = 0;
+	tmc2130->spiStatus.valid     = false;
+	tmc2130->spiStatus.tick      = 0;
+	tmc2130->spiStatus.callback  = NULL;
+#endif
+
+	tmc2130->config = config;
+#ifdef TMC_SHADOW_SPARSE
+	tmc2130->config->shadowIndex = tmc2130_shadowIndex;
+#endif
+
+#ifdef TMC2130_CONFIGURE_ONCE
+	tmc_driver_init(&driver, tmc2130->config, channel, tmc2130->registerAccess, NULL, registerResetState);
+	tmc2130->registerResetState = registerResetState;
+
+	// Write the whole configuration right away instead of one register per periodic job
+	tmc2130_reset(tmc2130);
+	tmc2130_configureBurst(tmc2130, 0);
+#else
+	tmc_driver_init(&driver, tmc2130->config, channel, tmc2130->registerAccess, tmc2130->registerResetState, registerResetState);
+#endif
+}
+
+#if TMC_FEATURE_SPI_STATUS
+// SPI_STATUS of the last reply (TMC_SPI_STATUS_* flags), taken from the transfers
+// that happen anyway. [tick] receives the capture time, may be NULL.
+// Returns 0 before the first transfer.
+uint8_t tmc2130_getSpiStatus(TMC2130TypeDef *tmc2130, uint32_t *tick)
+{
+	if(tick)
+		*tick = tmc2130->spiStatus.tick;
+
+	return tmc2130->spiStatus.status;
+}
+
+// Call [callback] from the transfer that captures a set flag of [edgeMask].
+// The callback runs in the context of the transfer and must not access the IC.
+void tmc2130_setSpiStatusCallback(TMC2130TypeDef *tmc2130, tmc_spi_statusCallback callback, uint8_t edgeMask)
+{
+	tmc2130->spiStatus.callback  = callback;
+	tmc2130->spiStatus.edgeMask  = edgeMask;
+}
+#endif
 
-	return true;
+// Fill the shadow registers of hardware preset non-readable registers
+// Only needed if you want to 'read' those registers e.g to display the value
+// in the TMCL IDE register browser
+void tmc2130_fillShadowRegisters(TMC2130TypeDef *tmc2130)
+{
+	tmc_driver_fillShadowRegisters(&driver, tmc2130->config, tmc2130->registerAccess);
+}
+
+// Reset the TMC5130
+uint8_t tmc2130_reset(TMC2130TypeDef *tmc2130)
+{
+	return tmc_driver_reset(&driver, tmc2130->config, tmc2130->registerAccess);
 }
 
 // Restore the TMC5130 to the state stored in the shadow registers.
 // This can be used to recover the IC configuration after a VM power loss.
 uint8_t tmc2130_restore(TMC2130TypeDef *tmc2130)
 {
-	if(tmc2130->config->state != CONFIG_READY)
-		return false;
-
-	tmc2130->config->state        = CONFIG_RESTORE;
-	tmc2130->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_restore(tmc2130->config);
 }
 
 // Change the values the IC will be configured with when performing a reset.
 void tmc2130_setRegisterResetState(TMC2130TypeDef *tmc2130, const int32_t *resetState)
 {
-	size_t i;
-	for(i = 0; i < TMC2130_REGISTER_COUNT; i++)
-	{
-		tmc2130->registerResetState[i] = resetState[i];
-	}
+#ifdef TMC2130_CONFIGURE_ONCE
+	tmc2130->registerResetState = resetState;
+#else
+	tmc_driver_setRegisterResetState(&driver, tmc2130->registerResetState, resetState);
+#endif
 }
 
 // Register a function to be called after completion of the configuration mechanism
@@ -161,51 +313,48 @@ void tmc2130_setCallback(TMC2130TypeDef *tmc2130, tmc2130_callback callback)
 // Helper function: Configure the next register.
 static void writeConfiguration(TMC2130TypeDef *tmc2130)
 {
-	uint8_t *ptr = &tmc2130->config->configIndex;
-	const int32_t *settings;
+	if(!tmc_driver_writeConfiguration(&driver, tmc2130, tmc2130->config, tmc2130->registerAccess, tmc2130->registerResetState))
+		return;
 
-	if(tmc2130->config->state == CONFIG_RESTORE)
+	// Finished configuration
+	if(tmc2130->config->callback)
 	{
-		settings = tmc2130->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2130_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2130->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
-	else
-	{
-		settings = tmc2130->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2130_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2130->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		((tmc2130_callback)tmc2130->config->callback)(tmc2130, tmc2130->config->state);
 	}
 
-	if(*ptr < TMC2130_REGISTER_COUNT)
-	{
-		tmc2130_writeInt(tmc2130, *ptr, settings[*ptr]);
-		(*ptr)++;
-	}
-	else // Finished configuration
-	{
-		if(tmc2130->config->callback)
-		{
-			((tmc2130_callback)tmc2130->config->callback)(tmc2130, tmc2130->config->state);
-		}
-
-		tmc2130->config->state = CONFIG_READY;
-	}
+	tmc2130->config->state = CONFIG_READY;
 }
 
 // Call this periodically
-void tmc2130_periodicJob(TMC2130TypeDef *tmc2130, uint32_t tick)
+TMCConfigStatus tmc2130_periodicJob(TMC2130TypeDef *tmc2130, uint32_t tick)
 {
 	UNUSED(tick);
 
 	if(tmc2130->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc2130);
+		return TMC_CONFIG_STATUS(tmc2130->config);
+	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2130_configureBurst(TMC2130TypeDef *tmc2130, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc2130->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc2130);
 	}
+
+	return (tmc2130->config->state == CONFIG_READY);
 }
@@ -18,17 +18,44 @@
 	FIELD_GET(tmc2130_readInt(tdef, address), mask, shift)
 #define TMC2130_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc2130_writeInt(tdef, address, FIELD_SET(tmc2130_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC2130_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc2130_writeInt(tdef, address, FIELDS_SET(tmc2130_readInt(tdef, address), mask, values)))
 
 // Typedefs
+// Uncomment to configure the IC only once, e.g. when it is driven by STEP/DIR
+// afterwards: tmc2130_init() writes the reset state in one burst and keeps a
+// pointer to it instead of a 512 byte copy. Combine with TMC_SHADOW_SPARSE
+// to shrink the shadow registers to the existing ones as well.
+//#define TMC2130_CONFIGURE_ONCE
+
 typedef struct
 {
 	ConfigurationTypeDef *config;
+#ifdef TMC2130_CONFIGURE_ONCE
+	const int32_t *registerResetState; // Constant table passed to tmc2130_init()
+#else
 	int32_t registerResetState[TMC2130_REGISTER_COUNT];
+#endif
 	uint8_t registerAccess[TMC2130_REGISTER_COUNT];
+#if TMC_FEATURE_SPI_STATUS
+	TMCSpiStatus spiStatus;  // SPI_STATUS of the last reply, see tmc2130_getSpiStatus()
+#endif
 } TMC2130TypeDef;
 
 typedef void (*tmc2130_callback)(TMC2130TypeDef*, ConfigState);
 
+// Maximum amount of ICs in one daisy chain
+#define TMC2130_CHAIN_MAX 8
+
+// ICs daisy chained on one chip select
+typedef struct
+{
+	uint8_t channel;
+	uint8_t count;
+	TMC2130TypeDef *ics[TMC2130_CHAIN_MAX];
+} TMC2130ChainTypeDef;
+
 // Default Register values
 #define R10 0x00071703  // IHOLD_IRUN
 #define R6C 0x000101D5  // CHOPCONF
@@ -71,6 +98,48 @@ static const uint8_t tmc2130_defaultRegisterAccess[TMC2130_REGISTER_COUNT] =
 	0x42, 0x01, 0x02, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Shadow register slots (only used with TMC_SHADOW_SPARSE)
+// Derived from tmc2130_defaultRegisterAccess - keep both in sync.
+// Registers without access share the unused slot 0.
+#define TMC2130_SHADOW_SLOTS 32
+
+static const uint8_t tmc2130_shadowIndex[TMC2130_REGISTER_COUNT] =
+{
+//	0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	0x01, 0x02, ____, ____, 0x03, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x00 - 0x0F
+	0x04, 0x05, 0x06, 0x07, 0x08, 0x09, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x10 - 0x1F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 0x0A, ____, ____, // 0x20 - 0x2F
+	____, ____, ____, 0x0B, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x30 - 0x3F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x40 - 0x4F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x50 - 0x5F
+	0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, // 0x60 - 0x6F
+	0x1C, 0x1D, 0x1E, 0x1F, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
+};
+
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2130_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2130_resettableRegisters[] =
+{
+	0x00, 0x10, 0x11, 0x13, 0x14, 0x15, 0x2D, 0x33, 0x6C, 0x6D, 0x6E, 0x72
+};
+
+static const uint8_t tmc2130_restorableRegisters[] =
+{
+	0x00, 0x10, 0x11, 0x13, 0x14, 0x15, 0x2D, 0x33, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+	0x68, 0x69, 0x6C, 0x6D, 0x6E, 0x70, 0x72
+};
+
+// Write order constraints, see WriteOrder.h. The motor current has to be set
+// before CHOPCONF enables the driver.
+static const TMCWriteOrder tmc2130_writeOrder[] =
+{
+	{ TMC2130_IHOLD_IRUN, TMC2130_CHOPCONF },
+};
+
 // Register constants (only required for 0x42 registers, since we do not have
 // any way to find out the content but want to hold the actual value in the
 // shadow register so an application (i.e. the TMCL IDE) can still display
@@ -99,6 +168,12 @@ static const TMCRegisterConstant tmc2130_RegisterConstants[] =
 void tmc2130_writeDatagram(TMC2130TypeDef *tmc2130, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc2130_writeInt(TMC2130TypeDef *tmc2130, uint8_t address, int32_t value);
 int32_t tmc2130_readInt(TMC2130TypeDef *tmc2130, uint8_t address);
+void tmc2130_readIntBatch(TMC2130TypeDef *tmc2130, const uint8_t *addresses, int32_t *values, size_t count);
+
+void tmc2130_chainInit(TMC2130ChainTypeDef *chain, uint8_t channel, TMC2130TypeDef **ics, uint8_t count);
+void tmc2130_chainWriteInt(TMC2130ChainTypeDef *chain, const uint8_t *addresses, const int32_t *values);
+void tmc2130_chainWriteIntAll(TMC2130ChainTypeDef *chain, uint8_t address, int32_t value);
+void tmc2130_chainReadInt(TMC2130ChainTypeDef *chain, const uint8_t *addresses, int32_t *values);
 
 void tmc2130_init(TMC2130TypeDef *tmc2130, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
 void tmc2130_fillShadowRegisters(TMC2130TypeDef *tmc2130);
@@ -106,6 +181,11 @@ uint8_t tmc2130_reset(TMC2130TypeDef *tmc2130);
 uint8_t tmc2130_restore(TMC2130TypeDef *tmc2130);
 void tmc2130_setRegisterResetState(TMC2130TypeDef *tmc2130, const int32_t *resetState);
 void tmc2130_setCallback(TMC2130TypeDef *tmc2130, tmc2130_callback callback);
-void tmc2130_periodicJob(TMC2130TypeDef *tmc2130, uint32_t tick);
+#if TMC_FEATURE_SPI_STATUS
+uint8_t tmc2130_getSpiStatus(TMC2130TypeDef *tmc2130, uint32_t *tick);
+void tmc2130_setSpiStatusCallback(TMC2130TypeDef *tmc2130, tmc_spi_statusCallback callback, uint8_t edgeMask);
+#endif
+TMCConfigStatus tmc2130_periodicJob(TMC2130TypeDef *tmc2130, uint32_t tick);
+uint8_t tmc2130_configureBurst(TMC2130TypeDef *tmc2130, uint32_t maxSteps);
 
 #endif /* TMC_IC_TMC2130_H_ */
@@ -9,6 +9,8 @@
 
 // => SPI wrapper
 extern void tmc2160_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc2160_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC2160", tmc2160_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
@@ -21,7 +23,7 @@ void tmc2160_writeDatagram(TMC2160TypeDef *tmc2160, uint8_t address, uint8_t x1,
 
 	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
-	tmc2160->config->shadowRegister[address] = value;
+	TMC_SHADOW_REGISTER(tmc2160->config, address) = value;
 	tmc2160->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
@@ -36,7 +38,7 @@ int32_t tmc2160_readInt(TMC2160TypeDef *tmc2160, uint8_t address)
 
 	// register not readable -> shadow register copy
 	if(!TMC_IS_READABLE(tmc2160->registerAccess[address]))
-		return tmc2160->config->shadowRegister[address];
+		return TMC_SHADOW_REGISTER(tmc2160->config, address);
 
 	uint8_t data[5];
 
@@ -46,89 +48,116 @@ int32_t tmc2160_readInt(TMC2160TypeDef *tmc2160, uint8_t address)
 	data[0] = address;
 	tmc2160_readWriteArray(tmc2160->config->channel, &data[0], 5);
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+	return tmc_unpackInt32(&data[1]);
 }
 
-void tmc2160_init(TMC2160TypeDef *tmc2160, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc2160_readIntBatch(TMC2160TypeDef *tmc2160, const uint8_t *addresses, int32_t *values, size_t count)
 {
-	tmc2160->config = config;
-
-	tmc2160->config->callback     = NULL;
-	tmc2160->config->channel      = channel;
-	tmc2160->config->configIndex  = 0;
-	tmc2160->config->state        = CONFIG_READY;
+	uint8_t data[5];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
 
-	int i;
-	for(i = 0; i < TMC2160_REGISTER_COUNT; i++)
+	for(i = 0; i < count; i++)
 	{
-		tmc2160->registerAccess[i]      = tmc2160_defaultRegisterAccess[i];
-		tmc2160->registerResetState[i]  = registerResetState[i];
-	}
-}
+		uint8_t address = TMC_ADDRESS(addresses[i]);
 
-void tmc2160_fillShadowRegisters(TMC2160TypeDef *tmc2160)
-{
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc2160_RegisterConstants) == 0)
-		return;
-
-	size_t i, j;
-	for (i = 0, j = 0; i < TMC2160_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc2160->registerAccess[i] != TMC_ACCESS_W_PRESET)
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc2160->registerAccess[address]))
+		{
+			values[i] = TMC_SHADOW_REGISTER(tmc2160->config, address);
 			continue;
+		}
 
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc2160_RegisterConstants) && (tmc2160_RegisterConstants[j].address < i))
-			j++;
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc2160_readWriteArray(tmc2160->config->channel, &data[0], 5);
 
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc2160_RegisterConstants))
-			break;
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+
+		pending = i;
+	}
 
-		// If we have an entry for our current address, write the constant
-		if(tmc2160_RegisterConstants[j].address == i)
-			tmc2160->config->shadowRegister[i] = tmc2160_RegisterConstants[j].value;
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc2160_readWriteArray(tmc2160->config->channel, &data[0], 5);
+		values[pending] = tmc_unpackInt32(&data[1]);
 	}
 }
 
-uint8_t tmc2160_reset(TMC2160TypeDef *tmc2160)
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
 {
-	if(tmc2160->config->state != CONFIG_READY)
-		return false;
+	tmc2160_writeInt(ic, address, value);
+}
 
-	int i;
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC2160_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2160_defaultRegisterAccess,
+	.resettableRegisters    = tmc2160_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2160_resettableRegisters),
+	.restorableRegisters    = tmc2160_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2160_restorableRegisters),
+	.constants              = tmc2160_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc2160_RegisterConstants),
+	.writeOrder             = tmc2160_writeOrder,
+	.writeOrderCount        = ARRAY_SIZE(tmc2160_writeOrder),
+	.writeInt               = writeRegister,
+};
 
-	// Reset the dirty bits
-	for(i = 0; i < TMC2160_REGISTER_COUNT; i++)
-		tmc2160->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+void tmc2160_init(TMC2160TypeDef *tmc2160, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
+{
+	tmc2160->config = config;
+
+#ifdef TMC_SHADOW_SPARSE
+	tmc2160->config->shadowIndex = tmc2160_shadowIndex;
+#endif
 
-	tmc2160->config->state        = CONFIG_RESET;
-	tmc2160->config->configIndex  = 0;
+#ifdef TMC2160_CONFIGURE_ONCE
+	tmc_driver_init(&driver, tmc2160->config, channel, tmc2160->registerAccess, NULL, registerResetState);
+	tmc2160->registerResetState = registerResetState;
 
-	return true;
+	// Write the whole configuration right away instead of one register per periodic job
+	tmc2160_reset(tmc2160);
+	tmc2160_configureBurst(tmc2160, 0);
+#else
+	tmc_driver_init(&driver, tmc2160->config, channel, tmc2160->registerAccess, tmc2160->registerResetState, registerResetState);
+#endif
 }
 
-uint8_t tmc2160_restore(TMC2160TypeDef *tmc2160)
+void tmc2160_fillShadowRegisters(TMC2160TypeDef *tmc2160)
 {
-	if(tmc2160->config->state != CONFIG_READY)
-		return false;
+	tmc_driver_fillShadowRegisters(&driver, tmc2160->config, tmc2160->registerAccess);
+}
 
-	tmc2160->config->state        = CONFIG_RESTORE;
-	tmc2160->config->configIndex  = 0;
+uint8_t tmc2160_reset(TMC2160TypeDef *tmc2160)
+{
+	return tmc_driver_reset(&driver, tmc2160->config, tmc2160->registerAccess);
+}
 
-	return true;
+uint8_t tmc2160_restore(TMC2160TypeDef *tmc2160)
+{
+	return tmc_driver_restore(tmc2160->config);
 }
 
 void tmc2160_setRegisterResetState(TMC2160TypeDef *tmc2160, const int32_t *resetState)
 {
-	uint32_t i;
-	for(i = 0; i < TMC2160_REGISTER_COUNT; i++)
-		tmc2160->registerResetState[i] = resetState[i];
+#ifdef TMC2160_CONFIGURE_ONCE
+	tmc2160->registerResetState = resetState;
+#else
+	tmc_driver_setRegisterResetState(&driver, tmc2160->registerResetState, resetState);
+#endif
 }
 
 void tmc2160_setCallback(TMC2160TypeDef *tmc2160, tmc2160_callback callback)
@@ -138,43 +167,48 @@ void tmc2160_setCallback(TMC2160TypeDef *tmc2160, tmc2160_callback callback)
 
 static void writeConfiguration(TMC2160TypeDef *tmc2160)
 {
-	uint8_t *ptr = &tmc2160->config->configIndex;
-	const int32_t *settings;
+	if(!tmc_driver_writeConfiguration(&driver, tmc2160, tmc2160->config, tmc2160->registerAccess, tmc2160->registerResetState))
+		return;
 
-	if(tmc2160->config->state == CONFIG_RESTORE)
+	// Finished configuration
+	if(tmc2160->config->callback)
 	{
-		settings = tmc2160->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2160_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2160->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-	else
-	{
-		settings = tmc2160->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2160_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2160->registerAccess[*ptr]))
-			(*ptr)++;
+		((tmc2160_callback)tmc2160->config->callback)(tmc2160, tmc2160->config->state);
 	}
 
-	if(*ptr < TMC2160_REGISTER_COUNT)
+	tmc2160->config->state = CONFIG_READY;
+}
+
+TMCConfigStatus tmc2160_periodicJob(TMC2160TypeDef *tmc2160, uint32_t tick)
+{
+	UNUSED(tick);
+
+	if(tmc2160->config->state != CONFIG_READY)
 	{
-		tmc2160_writeInt(tmc2160, *ptr, settings[*ptr]);
-		(*ptr)++;
+		writeConfiguration(tmc2160);
+		return TMC_CONFIG_STATUS(tmc2160->config);
 	}
-	else // Finished configuration
-	{
-		if(tmc2160->config->callback)
-			((tmc2160_callback)tmc2160->config->callback)(tmc2160, tmc2160->config->state);
 
-		tmc2160->config->state = CONFIG_READY;
-	}
+	return TMC_CONFIG_STATUS_READY;
 }
 
-void tmc2160_periodicJob(TMC2160TypeDef *tmc2160, uint32_t tick)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2160_configureBurst(TMC2160TypeDef *tmc2160, uint32_t maxSteps)
 {
-	UNUSED(tick);
+	uint32_t step;
+
+	for(step = 0; tmc2160->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
 
-	if(tmc2160->config->state != CONFIG_READY)
 		writeConfiguration(tmc2160);
+	}
+
+	return (tmc2160->config->state == CONFIG_READY);
 }
 
@@ -18,11 +18,24 @@
 	FIELD_GET(tmc2160_readInt(tdef, address), mask, shift)
 #define TMC2160_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc2160_writeInt(tdef, address, FIELD_SET(tmc2160_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC2160_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc2160_writeInt(tdef, address, FIELDS_SET(tmc2160_readInt(tdef, address), mask, values)))
+
+// Uncomment to configure the IC only once, e.g. when it is driven by STEP/DIR
+// afterwards: tmc2160_init() writes the reset state in one burst and keeps a
+// pointer to it instead of a 512 byte copy. Combine with TMC_SHADOW_SPARSE
+// to shrink the shadow registers to the existing ones as well.
+//#define TMC2160_CONFIGURE_ONCE
 
 typedef struct
 {
 	ConfigurationTypeDef *config;
+#ifdef TMC2160_CONFIGURE_ONCE
+	const int32_t *registerResetState; // Constant table passed to tmc2160_init()
+#else
 	int32_t registerResetState[TMC2160_REGISTER_COUNT];
+#endif
 	uint8_t registerAccess[TMC2160_REGISTER_COUNT];
 } TMC2160TypeDef;
 
@@ -72,6 +85,54 @@ static const uint8_t tmc2160_defaultRegisterAccess[TMC2160_REGISTER_COUNT] =
 	0x02, 0x01, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Shadow register slots (only used with TMC_SHADOW_SPARSE)
+// Derived from tmc2160_defaultRegisterAccess - keep both in sync.
+// Registers without access share the unused slot 0.
+#define TMC2160_SHADOW_SLOTS 64
+
+static const uint8_t tmc2160_shadowIndex[TMC2160_REGISTER_COUNT] =
+{
+//	0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, ____, ____, ____, // 0x00 - 0x0F
+	0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x10 - 0x1F
+	0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, ____, ____, // 0x20 - 0x2F
+	____, ____, ____, 0x22, 0x23, 0x24, 0x25, ____, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, ____, ____, // 0x30 - 0x3F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x40 - 0x4F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x50 - 0x5F
+	0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, // 0x60 - 0x6F
+	0x3C, 0x3D, 0x3E, 0x3F, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
+};
+
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2160_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2160_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x05, 0x06, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20, 0x21, 0x23, 0x24,
+	0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x33, 0x34, 0x35, 0x38, 0x39, 0x3A, 0x3B, 0x3D,
+	0x6C, 0x6D, 0x6E, 0x70
+};
+
+static const uint8_t tmc2160_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20,
+	0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x33, 0x34, 0x35, 0x38, 0x39,
+	0x3A, 0x3B, 0x3D, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x6E,
+	0x70
+};
+
+// Write order constraints, see WriteOrder.h. The driver strength and the motor
+// current have to be set before CHOPCONF enables the driver.
+static const TMCWriteOrder tmc2160_writeOrder[] =
+{
+	{ TMC2160_DRV_CONF, TMC2160_CHOPCONF },
+	{ TMC2160_GLOBAL_SCALER, TMC2160_CHOPCONF },
+	{ TMC2160_IHOLD_IRUN, TMC2160_CHOPCONF },
+};
+
 static const int32_t tmc2160_defaultRegisterResetState[TMC2160_REGISTER_COUNT] =
 {
 //	0,   1,   2,   3,   4,   5,   6,   7,   8,   9,   A,   B,   C,   D,   E,   F
@@ -115,6 +176,7 @@ static const TMCRegisterConstant tmc2160_RegisterConstants[] =
 void tmc2160_writeDatagram(TMC2160TypeDef *tmc2160, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc2160_writeInt(TMC2160TypeDef *tmc2160, uint8_t address, int32_t value);
 int32_t tmc2160_readInt(TMC2160TypeDef *tmc2160, uint8_t address);
+void tmc2160_readIntBatch(TMC2160TypeDef *tmc2160, const uint8_t *addresses, int32_t *values, size_t count);
 
 void tmc2160_init(TMC2160TypeDef *tmc2160, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
 void tmc2160_fillShadowRegisters(TMC2160TypeDef *tmc2160);
@@ -122,6 +184,7 @@ uint8_t tmc2160_reset(TMC2160TypeDef *tmc2160);
 uint8_t tmc2160_restore(TMC2160TypeDef *tmc2160);
 void tmc2160_setRegisterResetState(TMC2160TypeDef *tmc2160, const int32_t *resetState);
 void tmc2160_setCallback(TMC2160TypeDef *tmc2160, tmc2160_callback callback);
-void tmc2160_periodicJob(TMC2160TypeDef *tmc2160, uint32_t tick);
+TMCConfigStatus tmc2160_periodicJob(TMC2160TypeDef *tmc2160, uint32_t tick);
+uint8_t tmc2160_configureBurst(TMC2160TypeDef *tmc2160, uint32_t maxSteps);
 
 #endif /* TMC_IC_TMC2160_H_ */
@@ -6,29 +6,31 @@
  */
 
 #include "TMC2208.h"
+#include "TMC2208_Fields.h"
 
 // => UART wrapper
 extern void tmc2208_readWriteArray(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
 // <= UART wrapper
 
 // => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc2208_CRC8 NULL
+#else
 extern uint8_t tmc2208_CRC8(uint8_t *data, size_t length);
+#endif
 // <= CRC wrapper
 
-void tmc2208_writeInt(TMC2208TypeDef *tmc2208, uint8_t address, int32_t value)
+static const TMCUartInterface uart =
 {
-	uint8_t data[8];
-
-	data[0] = 0x05;
-	data[1] = 0;
-	data[2] = address | TMC_WRITE_BIT;
-	data[3] = (value >> 24) & 0xFF;
-	data[4] = (value >> 16) & 0xFF;
-	data[5] = (value >> 8 ) & 0xFF;
-	data[6] = (value      ) & 0xFF;
-	data[7] = tmc2208_CRC8(data, 7);
+	.readWriteArray  = tmc2208_readWriteArray,
+	.crc             = tmc2208_CRC8,
+	TMC_INSTRUMENT_NAME("TMC2208")
+};
 
-	tmc2208_readWriteArray(tmc2208->config->channel, &data[0], 8, 0);
+void tmc2208_writeInt(TMC2208TypeDef *tmc2208, uint8_t address, int32_t value)
+{
+	tmc_uart_writeInt(&uart, tmc2208->config->channel, 0, address, value);
 
 	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
@@ -36,113 +38,106 @@ void tmc2208_writeInt(TMC2208TypeDef *tmc2208, uint8_t address, int32_t value)
 	tmc2208->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
-int32_t tmc2208_readInt(TMC2208TypeDef *tmc2208, uint8_t address)
+// Read an integer from the given address.
+// Returns false if no valid reply was received after TMC_UART_READ_RETRIES retries.
+bool tmc2208_readIntChecked(TMC2208TypeDef *tmc2208, uint8_t address, int32_t *value)
 {
-	uint8_t data[8] = { 0 };
-
 	address = TMC_ADDRESS(address);
 
 	if (!TMC_IS_READABLE(tmc2208->registerAccess[address]))
-		return tmc2208->config->shadowRegister[address];
-
-	data[0] = 0x05;
-	data[1] = 0;
-	data[2] = address;
-	data[3] = tmc2208_CRC8(data, 3);
-
-	tmc2208_readWriteArray(tmc2208->config->channel, data, 4, 8);
+	{
+		*value = tmc2208->config->shadowRegister[address];
+		return true;
+	}
 
-	// Byte 0: Sync nibble correct?
-	if (data[0] != 0x05)
-		return 0;
+	return tmc_uart_readInt(&uart, tmc2208->config->channel, 0, address, value);
+}
 
-	// Byte 1: Master address correct?
-	if (data[1] != 0xFF)
-		return 0;
+int32_t tmc2208_readInt(TMC2208TypeDef *tmc2208, uint8_t address)
+{
+	int32_t value;
 
-	// Byte 2: Address correct?
-	if (data[2] != address)
-		return 0;
+	// An invalid reply reads as 0
+	tmc2208_readIntChecked(tmc2208, address, &value);
 
-	// Byte 7: CRC correct?
-	if (data[7] != tmc2208_CRC8(data, 7))
-		return 0;
+	return value;
+}
 
-	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2208_writeInt(ic, address, value);
 }
 
-void tmc2208_init(TMC2208TypeDef *tmc2208, uint8_t channel, ConfigurationTypeDef *tmc2208_config, const int32_t *registerResetState)
+static const TMCRegisterDriver driver =
 {
-	tmc2208->config               = tmc2208_config;
-	tmc2208->config->callback     = NULL;
-	tmc2208->config->channel      = channel;
-	tmc2208->config->configIndex  = 0;
-	tmc2208->config->state        = CONFIG_READY;
+	.registerCount          = TMC2208_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2208_defaultRegisterAccess,
+	.resettableRegisters    = tmc2208_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2208_resettableRegisters),
+	.restorableRegisters    = tmc2208_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2208_restorableRegisters),
+	.constants              = NULL,
+	.constantCount          = 0,
+	.writeInt               = writeRegister,
+};
 
-	for(size_t i = 0; i < TMC2208_REGISTER_COUNT; i++)
-	{
-		tmc2208->registerAccess[i]      = tmc2208_defaultRegisterAccess[i];
-		tmc2208->registerResetState[i]  = registerResetState[i];
-	}
+void tmc2208_init(TMC2208TypeDef *tmc2208, uint8_t channel, ConfigurationTypeDef *tmc2208_config, const int32_t *registerResetState)
+{
+	tmc2208->config = tmc2208_config;
+	tmc_driver_init(&driver, tmc2208->config, channel, tmc2208->registerAccess, tmc2208->registerResetState, registerResetState);
 }
 
 static void writeConfiguration(TMC2208TypeDef *tmc2208)
 {
-	uint8_t *ptr = &tmc2208->config->configIndex;
-	const int32_t *settings;
-
-	if(tmc2208->config->state == CONFIG_RESTORE)
-	{
-		settings = tmc2208->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2208_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2208->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
-	else
-	{
-		settings = tmc2208->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2208_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2208->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
+	if(!tmc_driver_writeConfiguration(&driver, tmc2208, tmc2208->config, tmc2208->registerAccess, tmc2208->registerResetState))
+		return;
 
-	if(*ptr < TMC2208_REGISTER_COUNT)
+	// Finished configuration
+	if(tmc2208->config->callback)
 	{
-		tmc2208_writeInt(tmc2208, *ptr, settings[*ptr]);
-		(*ptr)++;
+		((tmc2208_callback)tmc2208->config->callback)(tmc2208, tmc2208->config->state);
 	}
-	else // Finished configuration
-	{
-		if(tmc2208->config->callback)
-		{
-			((tmc2208_callback)tmc2208->config->callback)(tmc2208, tmc2208->config->state);
-		}
 
-		tmc2208->config->state = CONFIG_READY;
-	}
+	tmc2208->config->state = CONFIG_READY;
 }
 
-void tmc2208_periodicJob(TMC2208TypeDef *tmc2208, uint32_t tick)
+TMCConfigStatus tmc2208_periodicJob(TMC2208TypeDef *tmc2208, uint32_t tick)
 {
 	UNUSED(tick);
 
 	if(tmc2208->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc2208);
-		return;
+		return TMC_CONFIG_STATUS(tmc2208->config);
 	}
+
+	return TMC_CONFIG_STATUS_READY;
 }
 
-void tmc2208_setRegisterResetState(TMC2208TypeDef *tmc2208, const int32_t *resetState)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2208_configureBurst(TMC2208TypeDef *tmc2208, uint32_t maxSteps)
 {
-	for(size_t i = 0; i < TMC2208_REGISTER_COUNT; i++)
+	uint32_t step;
+
+	for(step = 0; tmc2208->config->state != CONFIG_READY; step++)
 	{
-		tmc2208->registerResetState[i] = resetState[i];
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc2208);
 	}
+
+	return (tmc2208->config->state == CONFIG_READY);
+}
+
+void tmc2208_setRegisterResetState(TMC2208TypeDef *tmc2208, const int32_t *resetState)
+{
+	tmc_driver_setRegisterResetState(&driver, tmc2208->registerResetState, resetState);
 }
 
 void tmc2208_setCallback(TMC2208TypeDef *tmc2208, tmc2208_callback callback)
@@ -152,33 +147,134 @@ void tmc2208_setCallback(TMC2208TypeDef *tmc2208, tmc2208_callback callback)
 
 uint8_t tmc2208_reset(TMC2208TypeDef *tmc2208)
 {
-	if(tmc2208->config->state != CONFIG_READY)
-		return false;
+	return tmc_driver_reset(&driver, tmc2208->config, tmc2208->registerAccess);
+}
+
+// OTP aware reset
+// The OTP bytes select the power-on values of some write-only registers. OTP_READ and
+// the readable registers are read back once to find the registers already holding their
+// reset value, only the others are written. The remaining configuration is written
+// right away, like tmc2208_configureBurst(tmc2208, 0).
+
+// Power-on value of IHOLD_IRUN and TPWMTHRS as selected by the OTP bytes
+static int32_t otpPowerOnValue(uint8_t address, int32_t otp)
+{
+	static const uint8_t iholdDelay[]  = { 1, 2, 4, 8 };
+	static const uint8_t ihold[]       = { 16, 2, 8, 24 };
+	static const uint16_t tpwmthrs[]    = { 0, 200, 300, 400, 500, 800, 1200, 4000 };
+
+	if(address == TMC2208_TPWMTHRS)
+		return tpwmthrs[(otp >> 13) & 0x07]; // OTP1.5..7
 
-	// Reset the dirty bits and wipe the shadow registers
-	for(size_t i = 0; i < TMC2208_REGISTER_COUNT; i++)
+	// IRUN = 31, IHOLD from OTP2.5..6, IHOLDDELAY from OTP2.3..4
+	return (iholdDelay[(otp >> 19) & 0x03] << 16) | (31 << 8) | ihold[(otp >> 21) & 0x03];
+}
+
+// Current value of the given register after power-on.
+// Returns false if the register could not be read.
+static bool powerOnValue(TMC2208TypeDef *tmc2208, uint8_t address, int32_t otp, int32_t *value)
+{
+	if(TMC_IS_READABLE(tmc2208->registerAccess[address]))
+		return tmc2208_readIntChecked(tmc2208, address, value);
+
+	switch(address)
 	{
-		tmc2208->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc2208->config->shadowRegister[i] = 0;
+	case TMC2208_IHOLD_IRUN:
+	case TMC2208_TPWMTHRS:
+		*value = otpPowerOnValue(address, otp);
+		break;
+	case TMC2208_TPOWERDOWN:
+		*value = 20;
+		break;
+	default: // SLAVECONF, OTP_PROG, VACTUAL, ...
+		*value = 0;
+		break;
 	}
 
-	tmc2208->config->state        = CONFIG_RESET;
-	tmc2208->config->configIndex  = 0;
-
 	return true;
 }
 
-uint8_t tmc2208_restore(TMC2208TypeDef *tmc2208)
+// Reset right after power-on, writing only the registers that differ from the
+// OTP-applied power-on values. If a read back fails, the remaining registers are
+// written by the periodic job as with tmc2208_reset().
+uint8_t tmc2208_resetFromOTP(TMC2208TypeDef *tmc2208)
 {
-	if(tmc2208->config->state != CONFIG_READY)
+	int32_t otp, value;
+	size_t i;
+
+	if(!tmc2208_reset(tmc2208))
 		return false;
 
-	tmc2208->config->state        = CONFIG_RESTORE;
-	tmc2208->config->configIndex  = 0;
+	if(!tmc2208_readIntChecked(tmc2208, TMC2208_OTP_READ, &otp))
+		return true;
+
+	for(i = 0; i < driver.resettableCount; i++)
+	{
+		uint8_t address = tmc2208_resettableRegisters[i];
+		int32_t target = tmc2208->registerResetState[address];
+
+		if(!powerOnValue(tmc2208, address, otp, &value))
+		{
+			tmc2208->config->configIndex = i;
+			return true;
+		}
+
+		if(value != target)
+		{
+			tmc2208_writeInt(tmc2208, address, target);
+		}
+		else
+		{	// Only keep the shadow register, the power-on value is restored by the IC itself
+			tmc2208->config->shadowRegister[address] = target;
+		}
+	}
+
+	// Finish the configuration
+	tmc2208->config->configIndex = driver.resettableCount;
+	writeConfiguration(tmc2208);
 
 	return true;
 }
 
+// Program one bit of the OTP image at end-of-line.
+// Compares OTP byte [byte] (0..2) against [image] and starts programming the lowest
+// bit still missing. Call again after at least 10ms, until it returns 0.
+// Returns the amount of bits left to program including the one just started, or -1
+// if OTP_READ could not be read or the OTP holds bits not set in [image]
+// (OTP bits can not be cleared).
+int32_t tmc2208_programOTP(TMC2208TypeDef *tmc2208, uint8_t byte, uint8_t image)
+{
+	int32_t otp;
+	uint8_t missing;
+	uint8_t bit;
+	int32_t count = 0;
+
+	if((byte > 2) || !tmc2208_readIntChecked(tmc2208, TMC2208_OTP_READ, &otp))
+		return -1;
+
+	otp = (otp >> (8 * byte)) & 0xFF;
+	if(otp & ~image)
+		return -1;
+
+	missing = image & ~otp;
+	if(!missing)
+		return 0;
+
+	for(bit = 0; !(missing & (1 << bit)); bit++);
+
+	for(; missing; missing &= missing - 1)
+		count++;
+
+	tmc2208_writeInt(tmc2208, TMC2208_OTP_PROG, (0xBD << TMC2208_OTPMAGIC_SHIFT) | (byte << TMC2208_OTPBYTE_SHIFT) | bit);
+
+	return count;
+}
+
+uint8_t tmc2208_restore(TMC2208TypeDef *tmc2208)
+{
+	return tmc_driver_restore(tmc2208->config);
+}
+
 uint8_t tmc2208_get_slave(TMC2208TypeDef *tmc2208)
 {
 	UNUSED(tmc2208);
@@ -49,6 +49,22 @@ static const uint8_t tmc2208_defaultRegisterAccess[TMC2208_REGISTER_COUNT] =
 	0x03, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2208_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2208_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
+static const uint8_t tmc2208_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
 static const int32_t tmc2208_defaultRegisterResetState[TMC2208_REGISTER_COUNT] =
 {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
@@ -72,13 +88,17 @@ static const int32_t tmc2208_defaultRegisterResetState[TMC2208_REGISTER_COUNT] =
 
 void tmc2208_writeInt(TMC2208TypeDef *tmc2208, uint8_t address, int32_t value);
 int32_t tmc2208_readInt(TMC2208TypeDef *tmc2208, uint8_t address);
+bool tmc2208_readIntChecked(TMC2208TypeDef *tmc2208, uint8_t address, int32_t *value);
 
 void tmc2208_init(TMC2208TypeDef *tmc2208, uint8_t channel, ConfigurationTypeDef *tmc2208_config, const int32_t *registerResetState);
 uint8_t tmc2208_reset(TMC2208TypeDef *tmc2208);
+uint8_t tmc2208_resetFromOTP(TMC2208TypeDef *tmc2208);
+int32_t tmc2208_programOTP(TMC2208TypeDef *tmc2208, uint8_t byte, uint8_t image);
 uint8_t tmc2208_restore(TMC2208TypeDef *tmc2208);
 void tmc2208_setRegisterResetState(TMC2208TypeDef *tmc2208, const int32_t *resetState);
 void tmc2208_setCallback(TMC2208TypeDef *tmc2208, tmc2208_callback callback);
-void tmc2208_periodicJob(TMC2208TypeDef *tmc2208, uint32_t tick);
+TMCConfigStatus tmc2208_periodicJob(TMC2208TypeDef *tmc2208, uint32_t tick);
+uint8_t tmc2208_configureBurst(TMC2208TypeDef *tmc2208, uint32_t maxSteps);
 
 uint8_t tmc2208_get_slave(TMC2208TypeDef *tmc2208);
 void tmc2208_set_slave(TMC2208TypeDef *tmc2208, uint8_t slave);
@@ -11,110 +11,427 @@
 extern void tmc2209_readWriteArray(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
 // <= UART wrapper
 
+#ifdef TMC2209_ASYNC
+// => Async UART wrapper
+// Start sending [writeLength] bytes stored in the [data] array and return immediately.
+// Once [readLength] reply bytes have been written to [data], call complete(context).
+extern void tmc2209_readWriteArrayAsync(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength, tmc_async_complete complete, void *context);
+// <= Async UART wrapper
+#endif
+
 // => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc2209_CRC8 NULL
+#else
 extern uint8_t tmc2209_CRC8(uint8_t *data, size_t length);
+#endif
 // <= CRC wrapper
 
-void tmc2209_writeInt(TMC2209TypeDef *tmc2209, uint8_t address, int32_t value)
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc2209_readWriteArray,
+	.crc             = tmc2209_CRC8,
+	TMC_INSTRUMENT_NAME("TMC2209")
+};
+
+// Mark a register as written since the last reset.
+// Called after storing the shadow value: Any context seeing the dirty mark also
+// sees the value. The mark only touches the register's own access byte, or the
+// shared bitmap word with an atomic OR.
+static void markDirty(TMC2209TypeDef *tmc2209, uint8_t address)
 {
-	uint8_t data[8];
+	TMC_COMPILER_BARRIER();
 
-	data[0] = 0x05;
-	data[1] = tmc2209->slaveAddress;
-	data[2] = address | TMC_WRITE_BIT;
-	data[3] = (value >> 24) & 0xFF;
-	data[4] = (value >> 16) & 0xFF;
-	data[5] = (value >> 8 ) & 0xFF;
-	data[6] = (value      ) & 0xFF;
-	data[7] = tmc2209_CRC8(data, 7);
+#ifdef TMC_DIRTY_BITMAP
+	// Only writable registers are restored, so only those need tracking
+	if(TMC_IS_WRITABLE(tmc2209->registerAccess[address]))
+		TMC_DIRTY_SET(tmc2209->dirty, address);
+#else
+	tmc2209->registerAccess[address] |= TMC_ACCESS_DIRTY;
+#endif
+}
 
-	tmc2209_readWriteArray(tmc2209->config->channel, &data[0], 8, 0);
+void tmc2209_writeInt(TMC2209TypeDef *tmc2209, uint8_t address, int32_t value)
+{
+	tmc_uart_writeInt(&uart, tmc2209->config->channel, tmc2209->slaveAddress, address, value);
 
 	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
-	tmc2209->config->shadowRegister[address] = value;
-	tmc2209->registerAccess[address] |= TMC_ACCESS_DIRTY;
+	TMC_SHADOW_REGISTER(tmc2209->config, address) = value;
+	markDirty(tmc2209, address);
 }
 
-int32_t tmc2209_readInt(TMC2209TypeDef *tmc2209, uint8_t address)
+// Read an integer from the given address.
+// Returns false if no valid reply was received after TMC_UART_READ_RETRIES retries.
+bool tmc2209_readIntChecked(TMC2209TypeDef *tmc2209, uint8_t address, int32_t *value)
 {
-	uint8_t data[8] = { 0 };
+	bool valid;
 
 	address = TMC_ADDRESS(address);
 
 	if (!TMC_IS_READABLE(tmc2209->registerAccess[address]))
-		return tmc2209->config->shadowRegister[address];
+	{
+		*value = TMC_SHADOW_REGISTER(tmc2209->config, address);
+		return true;
+	}
 
-	data[0] = 0x05;
-	data[1] = tmc2209->slaveAddress;
-	data[2] = address;
-	data[3] = tmc2209_CRC8(data, 3);
+	valid = tmc_uart_readInt(&uart, tmc2209->config->channel, tmc2209->slaveAddress, address, value);
 
-	tmc2209_readWriteArray(tmc2209->config->channel, data, 4, 8);
+	if(tmc2209->link)
+		tmc_uart_linkReply(tmc2209->link, valid);
 
-	// Byte 0: Sync nibble correct?
-	if (data[0] != 0x05)
-		return 0;
+	return valid;
+}
 
-	// Byte 1: Master address correct?
-	if (data[1] != 0xFF)
-		return 0;
+// Tune the baud rate and SENDDELAY of all ICs on one channel, see tmc_uart_tuneLink().
+// The ICs then report their reads to [link] and fall back to slower baud rates on errors.
+// Returns false if no candidate worked.
+bool tmc2209_tuneLink(TMCUartLink *link, TMC2209TypeDef **ics, uint8_t count)
+{
+	uint8_t slaveAddresses[TMC_UART_LINK_NODES];
+	bool tuned;
+	uint8_t i;
 
-	// Byte 2: Address correct?
-	if (data[2] != address)
-		return 0;
+	if((count == 0) || (count > TMC_UART_LINK_NODES))
+		return false;
 
-	// Byte 7: CRC correct?
-	if (data[7] != tmc2209_CRC8(data, 7))
-		return 0;
+	for(i = 0; i < count; i++)
+		slaveAddresses[i] = ics[i]->slaveAddress;
+
+	tuned = tmc_uart_tuneLink(link, &uart, ics[0]->config->channel, slaveAddresses, count);
+
+	// Keep SENDDELAY in the shadow, so a restore writes it again
+	for(i = 0; i < count; i++)
+	{
+		TMC_SHADOW_REGISTER(ics[i]->config, TMC_UART_SLAVECONF) = (int32_t) link->sendDelay << TMC_UART_SENDDELAY_SHIFT;
+		markDirty(ics[i], TMC_UART_SLAVECONF);
+		ics[i]->link = link;
+	}
+
+	return tuned;
+}
+
+int32_t tmc2209_readInt(TMC2209TypeDef *tmc2209, uint8_t address)
+{
+	int32_t value;
+
+	// An invalid reply reads as 0
+	tmc2209_readIntChecked(tmc2209, address, &value);
+
+	return value;
+}
+
+// Multi-node bus
+// Queues register accesses for all ICs sharing one UART channel.
+// Consecutive writes are sent back-to-back as one transfer and confirmed with one
+// IFCNT read per IC afterwards, instead of checking every single write.
+
+void tmc2209_busInit(TMC2209BusTypeDef *bus, uint8_t channel)
+{
+	bus->channel = channel;
+	bus->count   = 0;
+
+	for(uint8_t i = 0; i < TMC2209_BUS_NODES; i++)
+		bus->ifcnt[i] = -1;
+}
+
+static bool busQueue(TMC2209BusTypeDef *bus, TMC2209TypeDef *tmc2209, uint8_t address, int32_t value, int32_t *result)
+{
+	TMC2209BusEntryTypeDef *entry;
+
+	if((bus->count >= TMC2209_BUS_QUEUE_LENGTH) || (tmc2209->slaveAddress >= TMC2209_BUS_NODES))
+		return false;
+
+	entry = &bus->queue[bus->count++];
+	entry->tmc2209 = tmc2209;
+	entry->address = address;
+	entry->value   = value;
+	entry->result  = result;
+
+	return true;
+}
+
+// Queue a write of [value] to [address]. Returns false if the queue is full.
+bool tmc2209_busQueueWrite(TMC2209BusTypeDef *bus, TMC2209TypeDef *tmc2209, uint8_t address, int32_t value)
+{
+	return busQueue(bus, tmc2209, TMC_ADDRESS(address) | TMC_WRITE_BIT, value, NULL);
+}
 
-	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+// Queue a read of [address]. The value is stored in [value] by tmc2209_busFlush().
+// Returns false if the queue is full.
+bool tmc2209_busQueueRead(TMC2209BusTypeDef *bus, TMC2209TypeDef *tmc2209, uint8_t address, int32_t *value)
+{
+	return busQueue(bus, tmc2209, TMC_ADDRESS(address), 0, value);
+}
+
+// Send the writes queued[first..last) in one transfer.
+// Returns a bitmask of the slave addresses with a collision in the echo.
+static uint8_t busSendWrites(TMC2209BusTypeDef *bus, size_t first, size_t last)
+{
+	uint8_t collisions = 0;
+	uint8_t data[TMC_UART_WRITE_LENGTH * TMC2209_BUS_QUEUE_LENGTH];
+	size_t i;
+
+	for(i = first; i < last; i++)
+	{
+		TMC2209BusEntryTypeDef *entry = &bus->queue[i];
+		tmc_uart_fillWriteFrame(&uart, &data[TMC_UART_WRITE_LENGTH * (i - first)], entry->tmc2209->slaveAddress, entry->address, entry->value);
+	}
+
+	// Counted as one write transfer to the first register of the run
+	TMC_INSTRUMENT_CALL("TMC2209", bus->channel, bus->queue[first].address, true, (TMC_UART_WRITE_LENGTH + TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH)) * (last - first),
+			bus->queue[first].value, 0,
+			tmc2209_readWriteArray(bus->channel, &data[0], TMC_UART_WRITE_LENGTH * (last - first), TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH * (last - first))));
+
+	for(i = first; i < last; i++)
+	{
+		// Write to the shadow register and mark the register dirty
+		TMC2209BusEntryTypeDef *entry = &bus->queue[i];
+		uint8_t address = TMC_ADDRESS(entry->address);
+		TMC_SHADOW_REGISTER(entry->tmc2209->config, address) = entry->value;
+		markDirty(entry->tmc2209, address);
+
+		if(!tmc_uart_checkWriteEcho(&uart, &data[TMC_UART_WRITE_LENGTH * (i - first)], entry->tmc2209->slaveAddress, entry->address, entry->value))
+			collisions |= 1 << entry->tmc2209->slaveAddress;
+	}
+
+	return collisions;
 }
 
+// Send all queued accesses in queue order and empty the queue.
+// Returns a bitmask of the slave addresses whose writes could not be confirmed
+// by their IFCNT register or collided on the line, 0 if all writes arrived.
+// The IFCNT values are cached between flushes. Writes with tmc2209_writeInt()
+// in between flushes are not counted and get reported as failed once.
+uint8_t tmc2209_busFlush(TMC2209BusTypeDef *bus)
+{
+	TMC2209TypeDef *nodes[TMC2209_BUS_NODES] = { NULL };
+	uint8_t writes[TMC2209_BUS_NODES] = { 0 };
+	uint8_t failed = 0;
+	size_t i, first;
+
+	// Collect the nodes receiving writes and get their current write counters
+	for(i = 0; i < bus->count; i++)
+	{
+		TMC2209BusEntryTypeDef *entry = &bus->queue[i];
+		uint8_t node = entry->tmc2209->slaveAddress;
+
+		if(!(entry->address & TMC_WRITE_BIT))
+			continue;
+
+		nodes[node] = entry->tmc2209;
+		writes[node]++;
+
+		if(bus->ifcnt[node] < 0)
+			bus->ifcnt[node] = tmc2209_readInt(entry->tmc2209, TMC2209_IFCNT) & 0xFF;
+	}
+
+	// Send runs of consecutive writes back-to-back, reads in between keep their order
+	for(i = 0, first = 0; i <= bus->count; i++)
+	{
+		if((i < bus->count) && (bus->queue[i].address & TMC_WRITE_BIT))
+			continue;
+
+		if(first < i)
+			failed |= busSendWrites(bus, first, i);
+
+		if(i < bus->count)
+			*bus->queue[i].result = tmc2209_readInt(bus->queue[i].tmc2209, bus->queue[i].address);
+
+		first = i + 1;
+	}
+
+	// Confirm the writes with one IFCNT read per node
+	for(i = 0; i < TMC2209_BUS_NODES; i++)
+	{
+		if(!nodes[i])
+			continue;
+
+		int16_t ifcnt = tmc2209_readInt(nodes[i], TMC2209_IFCNT) & 0xFF;
+
+		if(ifcnt != ((bus->ifcnt[i] + writes[i]) & 0xFF))
+			failed |= 1 << i;
+
+		bus->ifcnt[i] = ifcnt;
+	}
+
+	bus->count = 0;
+
+	return failed;
+}
+
+#ifdef TMC2209_ASYNC
+static void writeIntAsyncComplete(void *context)
+{
+	TMCAsyncRequestTypeDef *request = context;
+	TMC2209TypeDef *tmc2209 = request->ic;
+
+	if(!tmc_uart_checkWriteEcho(&uart, request->data, tmc2209->slaveAddress, request->address, request->value))
+	{
+		tmc_asyncFinish(request, TMC_ASYNC_ERROR);
+		return;
+	}
+
+	// Write to the shadow register and mark the register dirty
+	TMC_SHADOW_REGISTER(tmc2209->config, request->address) = request->value;
+	markDirty(tmc2209, request->address);
+
+	tmc_asyncFinish(request, TMC_ASYNC_DONE);
+}
+
+// Non-blocking tmc2209_writeInt(). The shadow register is updated once the transfer completed.
+// Returns the request handle or NULL if [request] is still pending.
+TMCAsyncRequestTypeDef *tmc2209_writeIntAsync(TMC2209TypeDef *tmc2209, TMCAsyncRequestTypeDef *request, uint8_t address, int32_t value, tmc_async_callback callback, void *userData)
+{
+	uint8_t *data = &request->data[0];
+
+	if(!tmc_asyncStart(request, tmc2209, tmc2209->config->channel, TMC_ADDRESS(address), value, callback, userData))
+		return NULL;
+
+	tmc_uart_fillWriteFrame(&uart, data, tmc2209->slaveAddress, address, value);
+
+	tmc2209_readWriteArrayAsync(request->channel, data, TMC_UART_WRITE_LENGTH, TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH), writeIntAsyncComplete, request);
+
+	return request;
+}
+
+static void readIntAsyncComplete(void *context)
+{
+	TMCAsyncRequestTypeDef *request = context;
+	TMC2209TypeDef *tmc2209 = request->ic;
+	uint8_t *data = &request->data[0];
+
+	if(!tmc_uart_checkReply(&uart, data, tmc2209->slaveAddress, request->address, &request->value))
+	{
+		TMC_INSTRUMENT_ERROR("TMC2209", request->channel);
+		request->value = 0;
+		tmc_asyncFinish(request, TMC_ASYNC_ERROR);
+		return;
+	}
+
+	tmc_asyncFinish(request, TMC_ASYNC_DONE);
+}
+
+// Non-blocking tmc2209_readInt(). The value is stored in request->value once the request is done.
+// Registers that are not readable complete immediately with the shadow register value.
+// An invalid reply finishes the request with TMC_ASYNC_ERROR.
+// Returns the request handle or NULL if [request] is still pending.
+TMCAsyncRequestTypeDef *tmc2209_readIntAsync(TMC2209TypeDef *tmc2209, TMCAsyncRequestTypeDef *request, uint8_t address, tmc_async_callback callback, void *userData)
+{
+	uint8_t *data = &request->data[0];
+
+	address = TMC_ADDRESS(address);
+
+	if(!tmc_asyncStart(request, tmc2209, tmc2209->config->channel, address, 0, callback, userData))
+		return NULL;
+
+	if (!TMC_IS_READABLE(tmc2209->registerAccess[address]))
+	{
+		request->value = TMC_SHADOW_REGISTER(tmc2209->config, address);
+		tmc_asyncFinish(request, TMC_ASYNC_DONE);
+		return request;
+	}
+
+	tmc_uart_fillReadFrame(&uart, data, tmc2209->slaveAddress, address);
+
+	tmc2209_readWriteArrayAsync(request->channel, data, TMC_UART_REQUEST_LENGTH, TMC_UART_READ_LENGTH, readIntAsyncComplete, request);
+
+	return request;
+}
+#endif
+
 void tmc2209_init(TMC2209TypeDef *tmc2209, uint8_t channel, uint8_t slaveAddress, ConfigurationTypeDef *tmc2209_config, const int32_t *registerResetState)
 {
 	tmc2209->slaveAddress = slaveAddress;
+	tmc2209->link = NULL;
+	tmc2209->gstat        = 0;
+	tmc2209->drvStatus    = 0;
 
 	tmc2209->config               = tmc2209_config;
 	tmc2209->config->callback     = NULL;
 	tmc2209->config->channel      = channel;
 	tmc2209->config->configIndex  = 0;
 	tmc2209->config->state        = CONFIG_READY;
+#ifdef TMC_SHADOW_SPARSE
+	tmc2209->config->shadowIndex  = tmc2209_shadowIndex;
+#endif
 
 	for(size_t i = 0; i < TMC2209_REGISTER_COUNT; i++)
 	{
+#ifndef TMC_DIRTY_BITMAP
 		tmc2209->registerAccess[i]      = tmc2209_defaultRegisterAccess[i];
+#endif
+#ifndef TMC_RESET_STATE_CONST
 		tmc2209->registerResetState[i]  = registerResetState[i];
+#endif
 	}
+
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_init(&tmc2209->registerResetState, registerResetState);
+#endif
+
+#ifdef TMC_DIRTY_BITMAP
+	tmc2209->registerAccess = tmc2209_defaultRegisterAccess;
+	tmc_dirtyClearAll(tmc2209->dirty);
+#endif
+}
+
+// Reset value of the given register
+static int32_t resetValue(TMC2209TypeDef *tmc2209, uint8_t address)
+{
+#ifdef TMC_RESET_STATE_CONST
+	return tmc_resetState_get(&tmc2209->registerResetState, address);
+#else
+	return tmc2209->registerResetState[address];
+#endif
 }
 
 static void writeConfiguration(TMC2209TypeDef *tmc2209)
 {
 	uint8_t *ptr = &tmc2209->config->configIndex;
-	const int32_t *settings;
+	const uint8_t *registers;
+	size_t registerCount;
 
 	if(tmc2209->config->state == CONFIG_RESTORE)
 	{
-		settings = tmc2209->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2209_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2209->registerAccess[*ptr]))
+#ifdef TMC_DIRTY_BITMAP
+		// Only the registers written since the last reset are restored,
+		// the configuration index holds the next address to check.
+		int32_t address = tmc_dirtyNext(tmc2209->dirty, *ptr);
+
+		registers      = NULL;
+		registerCount  = 0; // Nothing left to restore: Finish below
+		if(address >= 0)
+		{
+			tmc2209_writeInt(tmc2209, address, TMC_SHADOW_REGISTER(tmc2209->config, address));
+			*ptr = address + 1;
+			return;
+		}
+#else
+		registers      = tmc2209_restorableRegisters;
+		registerCount  = ARRAY_SIZE(tmc2209_restorableRegisters);
+		// Skip hardware preset registers that have not been written yet
+		while((*ptr < registerCount) && !TMC_IS_RESTORABLE(tmc2209->registerAccess[registers[*ptr]]))
 		{
 			(*ptr)++;
 		}
+#endif
 	}
 	else
 	{
-		settings = tmc2209->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2209_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2209->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		registers      = tmc2209_resettableRegisters;
+		registerCount  = ARRAY_SIZE(tmc2209_resettableRegisters);
 	}
 
-	if(*ptr < TMC2209_REGISTER_COUNT)
+	if(*ptr < registerCount)
 	{
-		tmc2209_writeInt(tmc2209, *ptr, settings[*ptr]);
+		uint8_t address = registers[*ptr];
+		int32_t value = (tmc2209->config->state == CONFIG_RESTORE)
+				? TMC_SHADOW_REGISTER(tmc2209->config, address)
+				: resetValue(tmc2209, address);
+
+		tmc2209_writeInt(tmc2209, address, value);
 		(*ptr)++;
 	}
 	else // Finished configuration
@@ -128,21 +445,263 @@ static void writeConfiguration(TMC2209TypeDef *tmc2209)
 	}
 }
 
-void tmc2209_periodicJob(TMC2209TypeDef *tmc2209, uint32_t tick)
+TMCConfigStatus tmc2209_periodicJob(TMC2209TypeDef *tmc2209, uint32_t tick)
 {
 	UNUSED(tick);
 
 	if(tmc2209->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc2209);
-		return;
+		return TMC_CONFIG_STATUS(tmc2209->config);
+	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2209_configureBurst(TMC2209TypeDef *tmc2209, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc2209->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc2209);
+	}
+
+	return (tmc2209->config->state == CONFIG_READY);
+}
+
+// Event driven status
+// DIAG signals driver errors and StallGuard stalls. Call this from the GPIO interrupt
+// instead of polling GSTAT and DRV_STATUS periodically. Latched GSTAT flags found set
+// are written back to clear them.
+// Returns false if a status register could not be read over UART.
+bool tmc2209_onInterrupt(TMC2209TypeDef *tmc2209)
+{
+	if(!tmc2209_readIntChecked(tmc2209, TMC2209_GSTAT, &tmc2209->gstat))
+		return false;
+
+	if(tmc2209->gstat & TMC2209_GSTAT_EVENTS)
+		tmc2209_writeInt(tmc2209, TMC2209_GSTAT, tmc2209->gstat & TMC2209_GSTAT_EVENTS);
+
+	return tmc2209_readIntChecked(tmc2209, TMC2209_DRVSTATUS, &tmc2209->drvStatus);
+}
+
+// Sample SG_RESULT and CS_ACTUAL into [stream] as [axis], see tmc/helpers/LoadStream.h.
+// The UART ICs hold SG_RESULT in its own register, taking two reads per sample.
+// Returns false if a register could not be read, no sample is added then.
+bool tmc2209_sampleLoad(TMC2209TypeDef *tmc2209, TMCLoadStream *stream, uint8_t axis, uint32_t tick)
+{
+	int32_t sgResult, drvStatus;
+
+	if(!tmc2209_readIntChecked(tmc2209, TMC2209_SG_RESULT, &sgResult))
+		return false;
+
+	if(!tmc2209_readIntChecked(tmc2209, TMC2209_DRVSTATUS, &drvStatus))
+		return false;
+
+	tmc_loadStream_sample(stream, axis, sgResult & 0x3FF,
+			FIELD_GET(drvStatus, TMC2209_CS_ACTUAL_MASK, TMC2209_CS_ACTUAL_SHIFT), tick);
+
+	return true;
+}
+
+// Write planned chopper thresholds, see tmc_planChopperThresholds().
+// The TMC2209 has no fullstep switching, THIGH is not used.
+void tmc2209_writeChopperThresholds(TMC2209TypeDef *tmc2209, const TMCChopperThresholdsTypeDef *thresholds)
+{
+	TMC_LOCK(tmc2209->config->channel);
+
+	tmc2209_writeInt(tmc2209, TMC2209_TPWMTHRS, thresholds->tpwmthrs);
+	tmc2209_writeInt(tmc2209, TMC2209_TCOOLTHRS, thresholds->tcoolthrs);
+
+	TMC_UNLOCK(tmc2209->config->channel);
+}
+
+// Thermal derating from the DRV_STATUS temperature comparators, see
+// tmc/helpers/ThermalDerating.h. The TMC2209 has no global scaler, IRUN is derated.
+// Call it periodically. Returns true if IHOLD_IRUN was written.
+bool tmc2209_thermalUpdate(TMC2209TypeDef *tmc2209, TMCThermalDerating *thermal)
+{
+	int32_t drvStatus = tmc2209_readInt(tmc2209, TMC2209_DRVSTATUS);
+	uint8_t level = 0;
+
+	if(drvStatus & TMC2209_T157_MASK)
+		level = 4;
+	else if(drvStatus & TMC2209_T150_MASK)
+		level = 3;
+	else if(drvStatus & TMC2209_T143_MASK)
+		level = 2;
+	else if(drvStatus & (TMC2209_T120_MASK | TMC2209_OTPW_MASK))
+		level = 1;
+
+	if(!tmc_thermal_updateLevel(thermal, level))
+		return false;
+
+	TMC2209_FIELD_UPDATE(tmc2209, TMC2209_IHOLD_IRUN, TMC2209_IRUN_MASK, TMC2209_IRUN_SHIFT, tmc_thermal_irun(thermal));
+
+	return true;
+}
+
+// Sensorless homing with StallGuard4, see tmc/helpers/Homing.h.
+// The motor is moved with the internal pulse generator (VACTUAL), StallGuard4 requires
+// StealthChop to be enabled. Poll periodically after tmc_homing_start() until
+// TMC_HOMING_DONE or TMC_HOMING_FAILED is returned. Without a DIAG interrupt the stall
+// is detected by polling SG_RESULT, so the poll rate limits the homing velocity.
+static void homingFinish(TMC2209TypeDef *tmc2209, TMCHomingTypeDef *homing, TMCHomingState state)
+{
+	tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, 0);
+	tmc2209_writeInt(tmc2209, TMC2209_TCOOLTHRS, homing->saved[0]);
+
+	homing->state = state;
+}
+
+TMCHomingState tmc2209_home(TMC2209TypeDef *tmc2209, TMCHomingTypeDef *homing)
+{
+	int32_t sgResult;
+
+	switch(homing->state)
+	{
+	case TMC_HOMING_START:
+		if(!tmc2209_readIntChecked(tmc2209, TMC2209_TCOOLTHRS, &homing->saved[0]))
+			break;
+
+		// StallGuard active at every velocity of the homing
+		tmc2209_writeInt(tmc2209, TMC2209_TCOOLTHRS, 0xFFFFF);
+
+		if(homing->calibrated)
+		{
+			tmc2209_writeInt(tmc2209, TMC2209_SGTHRS, homing->threshold);
+			tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, homing->velocity);
+			homing->state = TMC_HOMING_ACCELERATE;
+		}
+		else
+		{
+			// No stall output during the calibration
+			tmc2209_writeInt(tmc2209, TMC2209_SGTHRS, 0);
+			tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, -homing->velocity);
+			homing->state = TMC_HOMING_CALIBRATE;
+		}
+		break;
+	case TMC_HOMING_CALIBRATE:
+		if(!tmc2209_readIntChecked(tmc2209, TMC2209_SG_RESULT, &sgResult))
+			break;
+
+		if(!tmc_homing_sample(homing, sgResult & 0x3FF))
+			break;
+
+		homing->state = tmc_homing_calibrateSG4(homing);
+		if(homing->state == TMC_HOMING_FAILED)
+		{
+			homingFinish(tmc2209, homing, TMC_HOMING_FAILED);
+			break;
+		}
+
+		tmc2209_writeInt(tmc2209, TMC2209_SGTHRS, homing->threshold);
+		tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, homing->velocity);
+		break;
+	case TMC_HOMING_ACCELERATE:
+		// VACTUAL has no ramp, wait for SG_RESULT to settle after the reversal
+		if(++homing->count < TMC_HOMING_SETTLE_SAMPLES)
+			break;
+
+		tmc_homing_resetSamples(homing);
+		tmc_homing_arm(homing);
+		break;
+	case TMC_HOMING_SEEK:
+		if(homing->diagEvent)
+		{
+			homingFinish(tmc2209, homing, TMC_HOMING_DONE);
+			break;
+		}
+
+		if(tmc2209_readIntChecked(tmc2209, TMC2209_SG_RESULT, &sgResult) && ((sgResult & 0x3FF) <= 2 * homing->threshold))
+			homingFinish(tmc2209, homing, TMC_HOMING_DONE);
+		else if(tmc_homing_timedOut(homing))
+			homingFinish(tmc2209, homing, TMC_HOMING_FAILED);
+		break;
+	default:
+		break;
 	}
+
+	return homing->state;
+}
+
+// CoolStep auto tuning, see tmc/helpers/CoolStepTune.h.
+// The motor is moved with the internal pulse generator (VACTUAL) at the calibration velocity
+// and stopped at the end. Poll periodically after tmc_coolStepTune_start() until
+// TMC_COOLSTEP_TUNE_DONE or TMC_COOLSTEP_TUNE_FAILED is returned. On a failure the
+// previous COOLCONF is kept.
+static void coolStepTuneFinish(TMC2209TypeDef *tmc2209, TMCCoolStepTuneTypeDef *tune, TMCCoolStepTuneState state)
+{
+	TMC_LOCK(tmc2209->config->channel);
+
+	tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, 0);
+	tmc2209_writeInt(tmc2209, TMC2209_COOLCONF, (state == TMC_COOLSTEP_TUNE_DONE) ? tune->coolconf : tune->saved[0]);
+	tmc2209_writeInt(tmc2209, TMC2209_TCOOLTHRS, tune->saved[1]);
+
+	TMC_UNLOCK(tmc2209->config->channel);
+
+	tune->state = state;
+}
+
+TMCCoolStepTuneState tmc2209_tuneCoolStep(TMC2209TypeDef *tmc2209, TMCCoolStepTuneTypeDef *tune)
+{
+	int32_t sgResult, drvStatus;
+	TMCCoolStepTuneState state;
+
+	switch(tune->state)
+	{
+	case TMC_COOLSTEP_TUNE_START:
+		if(!tmc2209_readIntChecked(tmc2209, TMC2209_COOLCONF, &tune->saved[0]) || !tmc2209_readIntChecked(tmc2209, TMC2209_TCOOLTHRS, &tune->saved[1]))
+			break;
+
+		// CoolStep active at every velocity of the tuning, off for the baseline
+		tmc2209_writeInt(tmc2209, TMC2209_TCOOLTHRS, 0xFFFFF);
+		tune->state = TMC_COOLSTEP_TUNE_BASELINE;
+		tmc2209_writeInt(tmc2209, TMC2209_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, tune->velocity);
+		break;
+	case TMC_COOLSTEP_TUNE_BASELINE:
+	case TMC_COOLSTEP_TUNE_SWEEP:
+		if(!tmc2209_readIntChecked(tmc2209, TMC2209_SG_RESULT, &sgResult) || !tmc2209_readIntChecked(tmc2209, TMC2209_DRVSTATUS, &drvStatus))
+			break;
+
+		if(!tmc_coolStepTune_sample(tune, sgResult & 0x3FF, FIELD_GET(drvStatus, TMC2209_CS_ACTUAL_MASK, TMC2209_CS_ACTUAL_SHIFT)))
+			break;
+
+		state = tmc_coolStepTune_evaluate(tune);
+		if(state != TMC_COOLSTEP_TUNE_SWEEP)
+		{
+			coolStepTuneFinish(tmc2209, tune, state);
+			break;
+		}
+
+		tune->state = state;
+		tmc2209_writeInt(tmc2209, TMC2209_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		break;
+	default:
+		break;
+	}
+
+	return tune->state;
 }
 
 void tmc2209_setRegisterResetState(TMC2209TypeDef *tmc2209, const int32_t *resetState)
 {
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_setAll(&tmc2209->registerResetState, resetState, TMC2209_REGISTER_COUNT);
+#else
 	for(size_t i = 0; i < TMC2209_REGISTER_COUNT; i++)
 		tmc2209->registerResetState[i] = resetState[i];
+#endif
 }
 
 void tmc2209_setCallback(TMC2209TypeDef *tmc2209, tmc2209_callback callback)
@@ -158,16 +717,149 @@ uint8_t tmc2209_reset(TMC2209TypeDef *tmc2209)
 	// Reset the dirty bits and wipe the shadow registers
 	for(size_t i = 0; i < TMC2209_REGISTER_COUNT; i++)
 	{
+#ifndef TMC_DIRTY_BITMAP
 		tmc2209->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+#endif
+#ifndef TMC_SHADOW_SPARSE
 		tmc2209->config->shadowRegister[i] = 0;
+#endif
 	}
 
+#ifdef TMC_SHADOW_SPARSE
+	for(size_t i = 0; i < TMC2209_SHADOW_SLOTS; i++)
+		tmc2209->config->shadowSlots[i] = 0;
+#endif
+
+#ifdef TMC_DIRTY_BITMAP
+	tmc_dirtyClearAll(tmc2209->dirty);
+#endif
+
 	tmc2209->config->state        = CONFIG_RESET;
 	tmc2209->config->configIndex  = 0;
 
 	return true;
 }
 
+// OTP aware reset
+// The OTP bytes select the power-on values of some write-only registers. OTP_READ and
+// the readable registers are read back once to find the registers already holding their
+// reset value, only the others are written. The remaining configuration is written
+// right away, like tmc2209_configureBurst(tmc2209, 0).
+
+// Power-on value of IHOLD_IRUN and TPWMTHRS as selected by the OTP bytes
+static int32_t otpPowerOnValue(uint8_t address, int32_t otp)
+{
+	static const uint8_t iholdDelay[]  = { 1, 2, 4, 8 };
+	static const uint8_t ihold[]       = { 16, 2, 8, 24 };
+	static const uint16_t tpwmthrs[]    = { 0, 200, 300, 400, 500, 800, 1200, 4000 };
+
+	if(address == TMC2209_TPWMTHRS)
+		return tpwmthrs[(otp >> 13) & 0x07]; // OTP1.5..7
+
+	// IRUN = 31, IHOLD from OTP2.5..6, IHOLDDELAY from OTP2.3..4
+	return (iholdDelay[(otp >> 19) & 0x03] << 16) | (31 << 8) | ihold[(otp >> 21) & 0x03];
+}
+
+// Current value of the given register after power-on.
+// Returns false if the register could not be read.
+static bool powerOnValue(TMC2209TypeDef *tmc2209, uint8_t address, int32_t otp, int32_t *value)
+{
+	if(TMC_IS_READABLE(tmc2209->registerAccess[address]))
+		return tmc2209_readIntChecked(tmc2209, address, value);
+
+	switch(address)
+	{
+	case TMC2209_IHOLD_IRUN:
+	case TMC2209_TPWMTHRS:
+		*value = otpPowerOnValue(address, otp);
+		break;
+	case TMC2209_TPOWERDOWN:
+		*value = 20;
+		break;
+	default: // SLAVECONF, OTP_PROG, VACTUAL, ...
+		*value = 0;
+		break;
+	}
+
+	return true;
+}
+
+// Reset right after power-on, writing only the registers that differ from the
+// OTP-applied power-on values. If a read back fails, the remaining registers are
+// written by the periodic job as with tmc2209_reset().
+uint8_t tmc2209_resetFromOTP(TMC2209TypeDef *tmc2209)
+{
+	int32_t otp, value;
+	size_t i;
+
+	if(!tmc2209_reset(tmc2209))
+		return false;
+
+	if(!tmc2209_readIntChecked(tmc2209, TMC2209_OTP_READ, &otp))
+		return true;
+
+	for(i = 0; i < ARRAY_SIZE(tmc2209_resettableRegisters); i++)
+	{
+		uint8_t address = tmc2209_resettableRegisters[i];
+		int32_t target = resetValue(tmc2209, address);
+
+		if(!powerOnValue(tmc2209, address, otp, &value))
+		{
+			tmc2209->config->configIndex = i;
+			return true;
+		}
+
+		if(value != target)
+		{
+			tmc2209_writeInt(tmc2209, address, target);
+		}
+		else
+		{	// Only keep the shadow register, the power-on value is restored by the IC itself
+			TMC_SHADOW_REGISTER(tmc2209->config, address) = target;
+		}
+	}
+
+	// Finish the configuration
+	tmc2209->config->configIndex = ARRAY_SIZE(tmc2209_resettableRegisters);
+	writeConfiguration(tmc2209);
+
+	return true;
+}
+
+// Program one bit of the OTP image at end-of-line.
+// Compares OTP byte [byte] (0..2) against [image] and starts programming the lowest
+// bit still missing. Call again after at least 10ms, until it returns 0.
+// Returns the amount of bits left to program including the one just started, or -1
+// if OTP_READ could not be read or the OTP holds bits not set in [image]
+// (OTP bits can not be cleared).
+int32_t tmc2209_programOTP(TMC2209TypeDef *tmc2209, uint8_t byte, uint8_t image)
+{
+	int32_t otp;
+	uint8_t missing;
+	uint8_t bit;
+	int32_t count = 0;
+
+	if((byte > 2) || !tmc2209_readIntChecked(tmc2209, TMC2209_OTP_READ, &otp))
+		return -1;
+
+	otp = (otp >> (8 * byte)) & 0xFF;
+	if(otp & ~image)
+		return -1;
+
+	missing = image & ~otp;
+	if(!missing)
+		return 0;
+
+	for(bit = 0; !(missing & (1 << bit)); bit++);
+
+	for(; missing; missing &= missing - 1)
+		count++;
+
+	tmc2209_writeInt(tmc2209, TMC2209_OTP_PROG, (0xBD << TMC2209_OTPMAGIC_SHIFT) | (byte << TMC2209_OTPBYTE_SHIFT) | bit);
+
+	return count;
+}
+
 uint8_t tmc2209_restore(TMC2209TypeDef *tmc2209)
 {
 	if(tmc2209->config->state != CONFIG_READY)
@@ -179,6 +871,207 @@ uint8_t tmc2209_restore(TMC2209TypeDef *tmc2209)
 	return true;
 }
 
+// IC bank
+// Bank-wide operations send the frames of all selected ICs sharing a UART channel
+// back-to-back, up to one frame per slave address per transfer. They return a bitmask
+// of the ICs whose write echo collided, 0 without TMC_UART_ECHO.
+
+// Fails to compile if TMC2209_BANK_SLOTS is out of sync
+typedef char bankSlotsCheck[(ARRAY_SIZE(tmc2209_restorableRegisters) == TMC2209_BANK_SLOTS) ? 1 : -1];
+
+#define BANK_ALL(bank)  (((bank)->count >= 32) ? 0xFFFFFFFFu : ((1u << (bank)->count) - 1))
+
+// Shadow row of [address], NULL for registers without write access
+static int32_t *bankRow(TMC2209BankTypeDef *bank, uint8_t address)
+{
+	for(uint8_t slot = 0; slot < TMC2209_BANK_SLOTS; slot++)
+	{
+		if(tmc2209_restorableRegisters[slot] == address)
+			return &bank->shadow[slot * bank->count];
+	}
+
+	return NULL;
+}
+
+// Write row[ic] to [address] of every IC selected in [ics]
+static uint32_t bankSendRow(TMC2209BankTypeDef *bank, uint8_t address, const int32_t *row, uint32_t ics)
+{
+	uint8_t data[TMC_UART_WRITE_LENGTH * TMC2209_BUS_NODES];
+	uint8_t frameIC[TMC2209_BUS_NODES];
+	uint32_t collisions = 0;
+	uint8_t frames = 0;
+	uint8_t ic, i;
+
+	address = TMC_ADDRESS(address) | TMC_WRITE_BIT;
+
+	for(ic = 0; ic < bank->count; ic++)
+	{
+		if(!(ics & (1u << ic)))
+			continue;
+
+		tmc_uart_fillWriteFrame(&uart, &data[TMC_UART_WRITE_LENGTH * frames], bank->slaveAddresses[ic], address, row[ic]);
+		frameIC[frames++] = ic;
+
+		// Send at a full transfer, before a channel change or after the last selected IC
+		ics &= ~(1u << ic);
+		if((frames < TMC2209_BUS_NODES) && ics && (ic + 1 < bank->count) && (bank->channels[ic + 1] == bank->channels[frameIC[0]]))
+			continue;
+
+		uint8_t channel = bank->channels[frameIC[0]];
+
+		TMC_LOCK(channel);
+		TMC_INSTRUMENT_CALL("TMC2209", channel, address, true, (TMC_UART_WRITE_LENGTH + TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH)) * frames,
+				row[frameIC[0]], 0,
+				tmc2209_readWriteArray(channel, &data[0], TMC_UART_WRITE_LENGTH * frames, TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH * frames)));
+		TMC_UNLOCK(channel);
+
+		for(i = 0; i < frames; i++)
+		{
+			if(!tmc_uart_checkWriteEcho(&uart, &data[TMC_UART_WRITE_LENGTH * i], bank->slaveAddresses[frameIC[i]], address, row[frameIC[i]]))
+				collisions |= 1u << frameIC[i];
+		}
+
+		frames = 0;
+	}
+
+	return collisions;
+}
+
+// Store the shadows of the selected ICs, mark them dirty and send them
+static uint32_t bankWriteRow(TMC2209BankTypeDef *bank, uint8_t address, int32_t *row, uint32_t ics)
+{
+	bank->dirty[(row - bank->shadow) / bank->count] |= ics;
+
+	return bankSendRow(bank, address, row, ics);
+}
+
+// [shadow] has to hold TMC2209_BANK_SLOTS * [count] values, see TMC2209_BANK_SHADOW().
+// The shadows start with the reset values, nothing is written to the ICs.
+// Returns false for more than TMC2209_BANK_MAX_ICS ICs.
+bool tmc2209_bankInit(TMC2209BankTypeDef *bank, uint8_t count, const uint8_t *channels, const uint8_t *slaveAddresses, int32_t *shadow, const int32_t *resetState)
+{
+	if(count > TMC2209_BANK_MAX_ICS)
+		return false;
+
+	bank->resetState      = resetState;
+	bank->shadow          = shadow;
+	bank->channels        = channels;
+	bank->slaveAddresses  = slaveAddresses;
+	bank->count           = count;
+
+	for(uint8_t slot = 0; slot < TMC2209_BANK_SLOTS; slot++)
+	{
+		bank->dirty[slot] = 0;
+
+		for(uint8_t ic = 0; ic < count; ic++)
+			shadow[slot * count + ic] = resetState[tmc2209_restorableRegisters[slot]];
+	}
+
+	return true;
+}
+
+uint32_t tmc2209_bankWriteInt(TMC2209BankTypeDef *bank, uint8_t ic, uint8_t address, int32_t value)
+{
+	int32_t *row;
+
+	address = TMC_ADDRESS(address);
+	row = bankRow(bank, address);
+	if(!row || (ic >= bank->count))
+		return 0;
+
+	row[ic] = value;
+
+	return bankWriteRow(bank, address, row, 1u << ic);
+}
+
+// Registers that are not readable return the shadow value.
+// Returns false if no valid reply was received.
+bool tmc2209_bankReadInt(TMC2209BankTypeDef *bank, uint8_t ic, uint8_t address, int32_t *value)
+{
+	int32_t *row;
+
+	address = TMC_ADDRESS(address);
+
+	if(TMC_IS_READABLE(tmc2209_defaultRegisterAccess[address]))
+		return tmc_uart_readInt(&uart, bank->channels[ic], bank->slaveAddresses[ic], address, value);
+
+	row = bankRow(bank, address);
+	*value = (row) ? row[ic] : 0;
+
+	return true;
+}
+
+// Write the same value to all ICs
+uint32_t tmc2209_bankWriteAll(TMC2209BankTypeDef *bank, uint8_t address, int32_t value)
+{
+	int32_t *row;
+
+	address = TMC_ADDRESS(address);
+	row = bankRow(bank, address);
+	if(!row)
+		return 0;
+
+	for(uint8_t ic = 0; ic < bank->count; ic++)
+		row[ic] = value;
+
+	return bankWriteRow(bank, address, row, BANK_ALL(bank));
+}
+
+// Update a field of all ICs from their shadow values, e.g. IHOLD of IHOLD_IRUN,
+// keeping the other fields of each IC
+uint32_t tmc2209_bankFieldUpdateAll(TMC2209BankTypeDef *bank, uint8_t address, uint32_t mask, uint8_t shift, uint32_t value)
+{
+	int32_t *row;
+
+	address = TMC_ADDRESS(address);
+	row = bankRow(bank, address);
+	if(!row)
+		return 0;
+
+	for(uint8_t ic = 0; ic < bank->count; ic++)
+		row[ic] = FIELD_SET(row[ic], mask, shift, value);
+
+	return bankWriteRow(bank, address, row, BANK_ALL(bank));
+}
+
+// Write the reset values to all ICs right away and clear the dirty bits.
+// Hardware preset registers are skipped, like tmc2209_reset().
+uint32_t tmc2209_bankReset(TMC2209BankTypeDef *bank)
+{
+	uint32_t collisions = 0;
+
+	for(uint8_t slot = 0; slot < TMC2209_BANK_SLOTS; slot++)
+	{
+		uint8_t address = tmc2209_restorableRegisters[slot];
+		int32_t *row = &bank->shadow[slot * bank->count];
+
+		for(uint8_t ic = 0; ic < bank->count; ic++)
+			row[ic] = bank->resetState[address];
+
+		bank->dirty[slot] = 0;
+
+		if(TMC_IS_RESETTABLE(tmc2209_defaultRegisterAccess[address]))
+			collisions |= bankSendRow(bank, address, row, BANK_ALL(bank));
+	}
+
+	return collisions;
+}
+
+// Write the registers changed since the last reset again, e.g. after a power loss
+// of the ICs. Only the ICs with a dirty register are addressed.
+uint32_t tmc2209_bankRestore(TMC2209BankTypeDef *bank)
+{
+	uint32_t collisions = 0;
+
+	for(uint8_t slot = 0; slot < TMC2209_BANK_SLOTS; slot++)
+	{
+		if(bank->dirty[slot])
+			collisions |= bankSendRow(bank, tmc2209_restorableRegisters[slot], &bank->shadow[slot * bank->count], bank->dirty[slot]);
+	}
+
+	return collisions;
+}
+
 uint8_t tmc2209_get_slave(TMC2209TypeDef *tmc2209)
 {
 	return tmc2209->slaveAddress;
@@ -188,3 +1081,43 @@ void tmc2209_set_slave(TMC2209TypeDef *tmc2209, uint8_t slaveAddress)
 {
 	tmc2209->slaveAddress = slaveAddress;
 }
+
+// Common IC interface, see tmc/helpers/ICInterface.h
+static int32_t interfaceReadInt(void *ic, uint8_t address)
+{
+	return tmc2209_readInt(ic, address);
+}
+
+static void interfaceWriteInt(void *ic, uint8_t address, int32_t value)
+{
+	tmc2209_writeInt(ic, address, value);
+}
+
+static TMCConfigStatus interfacePeriodicJob(void *ic, uint32_t tick)
+{
+	return tmc2209_periodicJob(ic, tick);
+}
+
+const TMCICInterface tmc2209_interface =
+{
+	.name           = "TMC2209",
+	.readInt        = interfaceReadInt,
+	.writeInt       = interfaceWriteInt,
+	.readIntBatch   = NULL,
+	.periodicJob    = interfacePeriodicJob,
+};
+
+// Move with the internal pulse generator, driven by the ramp of [stream].
+// Call this at the VACTUAL update rate with the ramp ticks elapsed since the last call.
+// VACTUAL is only written if it changed. Returns true if it was written.
+bool tmc2209_streamVelocity(TMC2209TypeDef *tmc2209, TMC_VelocityStream *stream, uint32_t ticks)
+{
+	int32_t vactual;
+
+	if(!tmc_ramp_vstream_update(stream, ticks, &vactual))
+		return false;
+
+	tmc2209_writeInt(tmc2209, TMC2209_VACTUAL, vactual);
+
+	return true;
+}
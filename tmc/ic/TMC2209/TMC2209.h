@@ -10,6 +10,7 @@
 
 #include "tmc/helpers/Constants.h"
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ramp/VelocityStream.h"
 #include "TMC2209_Register.h"
 #include "TMC2209_Constants.h"
 #include "TMC2209_Fields.h"
@@ -18,20 +19,77 @@
 #define TMC2209_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc2209_readInt(tdef, address), mask, shift)
 #define TMC2209_FIELD_UPDATE(tdef, address, mask, shift, value) \
-	(tmc2209_writeInt(tdef, address, FIELD_SET(tmc2209_readInt(tdef, address), mask, shift, value)))
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc2209_writeInt(tdef, address, FIELD_SET(tmc2209_readInt(tdef, address), mask, shift, value))), \
+	TMC_UNLOCK((tdef)->config->channel))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
 	ConfigurationTypeDef *config;
 
+#ifdef TMC_RESET_STATE_CONST
+	TMCResetStateTypeDef registerResetState;
+#else
 	int32_t registerResetState[TMC2209_REGISTER_COUNT];
+#endif
+#ifdef TMC_DIRTY_BITMAP
+	const uint8_t *registerAccess;   // Defaults to tmc2209_defaultRegisterAccess
+	uint32_t dirty[TMC_DIRTY_WORDS]; // Registers written since the last reset
+#else
 	uint8_t registerAccess[TMC2209_REGISTER_COUNT];
+#endif
 
 	uint8_t slaveAddress;
+	TMCUartLink *link; // Shared by all ICs of the channel, NULL: fixed baud rate. See tmc2209_tuneLink()
+
+	// Status read by tmc2209_onInterrupt()
+	int32_t gstat;
+	int32_t drvStatus;
 } TMC2209TypeDef;
 
+// Write-to-clear flags handled by the interrupt status read
+#define TMC2209_GSTAT_EVENTS  (TMC2209_RESET_MASK | TMC2209_DRV_ERR_MASK | TMC2209_UV_CP_MASK)
+
 typedef void (*tmc2209_callback)(TMC2209TypeDef*, ConfigState);
 
+// Multi-node bus: up to 4 ICs (slave addresses 0-3) on one UART channel
+#define TMC2209_BUS_NODES         4
+#define TMC2209_BUS_QUEUE_LENGTH  16
+
+typedef struct {
+	TMC2209TypeDef *tmc2209;
+	uint8_t address;  // Register address, with TMC_WRITE_BIT set for writes
+	int32_t value;
+	int32_t *result;  // Read destination
+} TMC2209BusEntryTypeDef;
+
+typedef struct {
+	uint8_t channel;
+	size_t count;
+	TMC2209BusEntryTypeDef queue[TMC2209_BUS_QUEUE_LENGTH];
+	int16_t ifcnt[TMC2209_BUS_NODES];  // Last known IFCNT per slave address, -1 if unknown
+} TMC2209BusTypeDef;
+
+// IC bank: A fleet of identical ICs without a TMC2209TypeDef and
+// ConfigurationTypeDef per IC. All ICs share the constant access table and one reset
+// table. Shadow values are only kept for the writable registers
+// (tmc2209_restorableRegisters), stored per register for all ICs:
+// shadow[slot * count + ic]. A bank-wide write walks one contiguous row.
+#define TMC2209_BANK_SLOTS    14 // Entries of tmc2209_restorableRegisters
+#define TMC2209_BANK_MAX_ICS  32 // One dirty bit per IC and slot
+
+// Shadow memory of a bank with [ics] ICs
+#define TMC2209_BANK_SHADOW(name, ics)  int32_t name[TMC2209_BANK_SLOTS * (ics)]
+
+typedef struct {
+	const int32_t *resetState;          // Shared by all ICs, e.g. tmc2209_defaultRegisterResetState
+	int32_t *shadow;                    // TMC2209_BANK_SHADOW() with [count] ICs
+	uint32_t dirty[TMC2209_BANK_SLOTS]; // Bit n: Register written to IC n since the last reset
+	const uint8_t *channels;            // UART channel per IC
+	const uint8_t *slaveAddresses;      // Slave address per IC
+	uint8_t count;
+} TMC2209BankTypeDef;
+
 // Default Register values
 #define R00 0x00000040  // GCONF
 #define R10 0x00071703  // IHOLD_IRUN
@@ -60,6 +118,40 @@ static const uint8_t tmc2209_defaultRegisterAccess[TMC2209_REGISTER_COUNT] =
 	0x03, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2209_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2209_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x14, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
+static const uint8_t tmc2209_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x14, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
+// Shadow register slots (only used with TMC_SHADOW_SPARSE)
+// Derived from tmc2209_defaultRegisterAccess - keep both in sync.
+// Registers without access share the unused slot 0.
+#define TMC2209_SHADOW_SLOTS 25
+
+static const uint8_t tmc2209_shadowIndex[TMC2209_REGISTER_COUNT] =
+{
+//	0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, ____, ____, ____, ____, ____, ____, ____, ____, // 0x00 - 0x0F
+	0x09, 0x0A, 0x0B, 0x0C, 0x0D, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x10 - 0x1F
+	____, ____, 0x0E, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x20 - 0x2F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x30 - 0x3F
+	0x0F, 0x10, 0x11, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x40 - 0x4F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x50 - 0x5F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 0x12, 0x13, 0x14, ____, ____, 0x15, // 0x60 - 0x6F
+	0x16, 0x17, 0x18, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
+};
+
 static const int32_t tmc2209_defaultRegisterResetState[TMC2209_REGISTER_COUNT] =
 {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
@@ -84,15 +176,46 @@ static const int32_t tmc2209_defaultRegisterResetState[TMC2209_REGISTER_COUNT] =
 // Communication
 void tmc2209_writeInt(TMC2209TypeDef *tmc2209, uint8_t address, int32_t value);
 int32_t tmc2209_readInt(TMC2209TypeDef *tmc2209, uint8_t address);
+bool tmc2209_readIntChecked(TMC2209TypeDef *tmc2209, uint8_t address, int32_t *value);
+bool tmc2209_tuneLink(TMCUartLink *link, TMC2209TypeDef **ics, uint8_t count);
+
+void tmc2209_busInit(TMC2209BusTypeDef *bus, uint8_t channel);
+bool tmc2209_busQueueWrite(TMC2209BusTypeDef *bus, TMC2209TypeDef *tmc2209, uint8_t address, int32_t value);
+bool tmc2209_busQueueRead(TMC2209BusTypeDef *bus, TMC2209TypeDef *tmc2209, uint8_t address, int32_t *value);
+uint8_t tmc2209_busFlush(TMC2209BusTypeDef *bus);
+#ifdef TMC2209_ASYNC
+TMCAsyncRequestTypeDef *tmc2209_writeIntAsync(TMC2209TypeDef *tmc2209, TMCAsyncRequestTypeDef *request, uint8_t address, int32_t value, tmc_async_callback callback, void *userData);
+TMCAsyncRequestTypeDef *tmc2209_readIntAsync(TMC2209TypeDef *tmc2209, TMCAsyncRequestTypeDef *request, uint8_t address, tmc_async_callback callback, void *userData);
+#endif
 
 void tmc2209_init(TMC2209TypeDef *tmc2209, uint8_t channel, uint8_t slaveAddress, ConfigurationTypeDef *tmc2209_config, const int32_t *registerResetState);
 uint8_t tmc2209_reset(TMC2209TypeDef *tmc2209);
+uint8_t tmc2209_resetFromOTP(TMC2209TypeDef *tmc2209);
+int32_t tmc2209_programOTP(TMC2209TypeDef *tmc2209, uint8_t byte, uint8_t image);
 uint8_t tmc2209_restore(TMC2209TypeDef *tmc2209);
 void tmc2209_setRegisterResetState(TMC2209TypeDef *tmc2209, const int32_t *resetState);
 void tmc2209_setCallback(TMC2209TypeDef *tmc2209, tmc2209_callback callback);
-void tmc2209_periodicJob(TMC2209TypeDef *tmc2209, uint32_t tick);
+TMCConfigStatus tmc2209_periodicJob(TMC2209TypeDef *tmc2209, uint32_t tick);
+uint8_t tmc2209_configureBurst(TMC2209TypeDef *tmc2209, uint32_t maxSteps);
+bool tmc2209_streamVelocity(TMC2209TypeDef *tmc2209, TMC_VelocityStream *stream, uint32_t ticks);
+bool tmc2209_onInterrupt(TMC2209TypeDef *tmc2209);
+bool tmc2209_sampleLoad(TMC2209TypeDef *tmc2209, TMCLoadStream *stream, uint8_t axis, uint32_t tick);
+void tmc2209_writeChopperThresholds(TMC2209TypeDef *tmc2209, const TMCChopperThresholdsTypeDef *thresholds);
+bool tmc2209_thermalUpdate(TMC2209TypeDef *tmc2209, TMCThermalDerating *thermal);
+TMCHomingState tmc2209_home(TMC2209TypeDef *tmc2209, TMCHomingTypeDef *homing);
+TMCCoolStepTuneState tmc2209_tuneCoolStep(TMC2209TypeDef *tmc2209, TMCCoolStepTuneTypeDef *tune);
+
+bool tmc2209_bankInit(TMC2209BankTypeDef *bank, uint8_t count, const uint8_t *channels, const uint8_t *slaveAddresses, int32_t *shadow, const int32_t *resetState);
+uint32_t tmc2209_bankWriteInt(TMC2209BankTypeDef *bank, uint8_t ic, uint8_t address, int32_t value);
+bool tmc2209_bankReadInt(TMC2209BankTypeDef *bank, uint8_t ic, uint8_t address, int32_t *value);
+uint32_t tmc2209_bankWriteAll(TMC2209BankTypeDef *bank, uint8_t address, int32_t value);
+uint32_t tmc2209_bankFieldUpdateAll(TMC2209BankTypeDef *bank, uint8_t address, uint32_t mask, uint8_t shift, uint32_t value);
+uint32_t tmc2209_bankReset(TMC2209BankTypeDef *bank);
+uint32_t tmc2209_bankRestore(TMC2209BankTypeDef *bank);
 
 uint8_t tmc2209_get_slave(TMC2209TypeDef *tmc2209);
 void tmc2209_set_slave(TMC2209TypeDef *tmc2209, uint8_t slaveAddress);
 
+extern const TMCICInterface tmc2209_interface;
+
 #endif /* TMC_IC_TMC2209_H_ */
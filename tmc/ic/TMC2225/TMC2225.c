@@ -12,23 +12,24 @@ extern void tmc2225_readWriteArray(uint8_t channel, uint8_t *data, size_t writeL
 // <= UART wrapper
 
 // => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc2225_CRC8 NULL
+#else
 extern uint8_t tmc2225_CRC8(uint8_t *data, size_t length);
+#endif
 // <= CRC wrapper
 
-void tmc2225_writeInt(TMC2225TypeDef *tmc2225, uint8_t address, int32_t value)
+static const TMCUartInterface uart =
 {
-	uint8_t data[8];
-
-	data[0] = 0x05;
-	data[1] = 0;
-	data[2] = address | TMC_WRITE_BIT;
-	data[3] = (value >> 24) & 0xFF;
-	data[4] = (value >> 16) & 0xFF;
-	data[5] = (value >> 8 ) & 0xFF;
-	data[6] = (value      ) & 0xFF;
-	data[7] = tmc2225_CRC8(data, 7);
+	.readWriteArray  = tmc2225_readWriteArray,
+	.crc             = tmc2225_CRC8,
+	TMC_INSTRUMENT_NAME("TMC2225")
+};
 
-	tmc2225_readWriteArray(tmc2225->config->channel, &data[0], 8, 0);
+void tmc2225_writeInt(TMC2225TypeDef *tmc2225, uint8_t address, int32_t value)
+{
+	tmc_uart_writeInt(&uart, tmc2225->config->channel, 0, address, value);
 
 	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
@@ -36,113 +37,106 @@ void tmc2225_writeInt(TMC2225TypeDef *tmc2225, uint8_t address, int32_t value)
 	tmc2225->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
-int32_t tmc2225_readInt(TMC2225TypeDef *tmc2225, uint8_t address)
+// Read an integer from the given address.
+// Returns false if no valid reply was received after TMC_UART_READ_RETRIES retries.
+bool tmc2225_readIntChecked(TMC2225TypeDef *tmc2225, uint8_t address, int32_t *value)
 {
-	uint8_t data[8] = { 0 };
-
 	address = TMC_ADDRESS(address);
 
 	if (!TMC_IS_READABLE(tmc2225->registerAccess[address]))
-		return tmc2225->config->shadowRegister[address];
-
-	data[0] = 0x05;
-	data[1] = 0;
-	data[2] = address;
-	data[3] = tmc2225_CRC8(data, 3);
-
-	tmc2225_readWriteArray(tmc2225->config->channel, data, 4, 8);
+	{
+		*value = tmc2225->config->shadowRegister[address];
+		return true;
+	}
 
-	// Byte 0: Sync nibble correct?
-	if (data[0] != 0x05)
-		return 0;
+	return tmc_uart_readInt(&uart, tmc2225->config->channel, 0, address, value);
+}
 
-	// Byte 1: Master address correct?
-	if (data[1] != 0xFF)
-		return 0;
+int32_t tmc2225_readInt(TMC2225TypeDef *tmc2225, uint8_t address)
+{
+	int32_t value;
 
-	// Byte 2: Address correct?
-	if (data[2] != address)
-		return 0;
+	// An invalid reply reads as 0
+	tmc2225_readIntChecked(tmc2225, address, &value);
 
-	// Byte 7: CRC correct?
-	if (data[7] != tmc2225_CRC8(data, 7))
-		return 0;
+	return value;
+}
 
-	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2225_writeInt(ic, address, value);
 }
 
-void tmc2225_init(TMC2225TypeDef *tmc2225, uint8_t channel, ConfigurationTypeDef *tmc2225_config, const int32_t *registerResetState)
+static const TMCRegisterDriver driver =
 {
-	tmc2225->config               = tmc2225_config;
-	tmc2225->config->callback     = NULL;
-	tmc2225->config->channel      = channel;
-	tmc2225->config->configIndex  = 0;
-	tmc2225->config->state        = CONFIG_READY;
+	.registerCount          = TMC2225_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2225_defaultRegisterAccess,
+	.resettableRegisters    = tmc2225_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2225_resettableRegisters),
+	.restorableRegisters    = tmc2225_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2225_restorableRegisters),
+	.constants              = NULL,
+	.constantCount          = 0,
+	.writeInt               = writeRegister,
+};
 
-	for(size_t i = 0; i < TMC2225_REGISTER_COUNT; i++)
-	{
-		tmc2225->registerAccess[i]      = tmc2225_defaultRegisterAccess[i];
-		tmc2225->registerResetState[i]  = registerResetState[i];
-	}
+void tmc2225_init(TMC2225TypeDef *tmc2225, uint8_t channel, ConfigurationTypeDef *tmc2225_config, const int32_t *registerResetState)
+{
+	tmc2225->config = tmc2225_config;
+	tmc_driver_init(&driver, tmc2225->config, channel, tmc2225->registerAccess, tmc2225->registerResetState, registerResetState);
 }
 
 static void writeConfiguration(TMC2225TypeDef *tmc2225)
 {
-	uint8_t *ptr = &tmc2225->config->configIndex;
-	const int32_t *settings;
-
-	if(tmc2225->config->state == CONFIG_RESTORE)
-	{
-		settings = tmc2225->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2225_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2225->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
-	else
-	{
-		settings = tmc2225->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2225_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2225->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
+	if(!tmc_driver_writeConfiguration(&driver, tmc2225, tmc2225->config, tmc2225->registerAccess, tmc2225->registerResetState))
+		return;
 
-	if(*ptr < TMC2225_REGISTER_COUNT)
+	// Finished configuration
+	if(tmc2225->config->callback)
 	{
-		tmc2225_writeInt(tmc2225, *ptr, settings[*ptr]);
-		(*ptr)++;
+		((tmc2225_callback)tmc2225->config->callback)(tmc2225, tmc2225->config->state);
 	}
-	else // Finished configuration
-	{
-		if(tmc2225->config->callback)
-		{
-			((tmc2225_callback)tmc2225->config->callback)(tmc2225, tmc2225->config->state);
-		}
 
-		tmc2225->config->state = CONFIG_READY;
-	}
+	tmc2225->config->state = CONFIG_READY;
 }
 
-void tmc2225_periodicJob(TMC2225TypeDef *tmc2225, uint32_t tick)
+TMCConfigStatus tmc2225_periodicJob(TMC2225TypeDef *tmc2225, uint32_t tick)
 {
 	UNUSED(tick);
 
 	if(tmc2225->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc2225);
-		return;
+		return TMC_CONFIG_STATUS(tmc2225->config);
 	}
+
+	return TMC_CONFIG_STATUS_READY;
 }
 
-void tmc2225_setRegisterResetState(TMC2225TypeDef *tmc2225, const int32_t *resetState)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2225_configureBurst(TMC2225TypeDef *tmc2225, uint32_t maxSteps)
 {
-	for(size_t i = 0; i < TMC2225_REGISTER_COUNT; i++)
+	uint32_t step;
+
+	for(step = 0; tmc2225->config->state != CONFIG_READY; step++)
 	{
-		tmc2225->registerResetState[i] = resetState[i];
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc2225);
 	}
+
+	return (tmc2225->config->state == CONFIG_READY);
+}
+
+void tmc2225_setRegisterResetState(TMC2225TypeDef *tmc2225, const int32_t *resetState)
+{
+	tmc_driver_setRegisterResetState(&driver, tmc2225->registerResetState, resetState);
 }
 
 void tmc2225_setCallback(TMC2225TypeDef *tmc2225, tmc2225_callback callback)
@@ -152,31 +146,12 @@ void tmc2225_setCallback(TMC2225TypeDef *tmc2225, tmc2225_callback callback)
 
 uint8_t tmc2225_reset(TMC2225TypeDef *tmc2225)
 {
-	if(tmc2225->config->state != CONFIG_READY)
-		return false;
-
-	// Reset the dirty bits and wipe the shadow registers
-	for(size_t i = 0; i < TMC2225_REGISTER_COUNT; i++)
-	{
-		tmc2225->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc2225->config->shadowRegister[i] = 0;
-	}
-
-	tmc2225->config->state        = CONFIG_RESET;
-	tmc2225->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_reset(&driver, tmc2225->config, tmc2225->registerAccess);
 }
 
 uint8_t tmc2225_restore(TMC2225TypeDef *tmc2225)
 {
-	if(tmc2225->config->state != CONFIG_READY)
-		return false;
-
-	tmc2225->config->state        = CONFIG_RESTORE;
-	tmc2225->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_restore(tmc2225->config);
 }
 
 void tmc2225_set_slave(TMC2225TypeDef *tmc2225, uint8_t slave)
@@ -17,7 +17,9 @@
 #define TMC2225_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc2225_readInt(tdef, address), mask, shift)
 #define TMC2225_FIELD_UPDATE(tdef, address, mask, shift, value) \
-	(tmc2225_writeInt(tdef, address, FIELD_SET(tmc2225_readInt(tdef, address), mask, shift, value)))
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc2225_writeInt(tdef, address, FIELD_SET(tmc2225_readInt(tdef, address), mask, shift, value))), \
+	TMC_UNLOCK((tdef)->config->channel))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
@@ -57,6 +59,22 @@ static const uint8_t tmc2225_defaultRegisterAccess[TMC2225_REGISTER_COUNT] =
 	0x03, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2225_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2225_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
+static const uint8_t tmc2225_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
 static const int32_t tmc2225_defaultRegisterResetState[TMC2225_REGISTER_COUNT] =
 {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
@@ -80,13 +98,15 @@ static const int32_t tmc2225_defaultRegisterResetState[TMC2225_REGISTER_COUNT] =
 
 void tmc2225_writeInt(TMC2225TypeDef *tmc2225, uint8_t address, int32_t value);
 int32_t tmc2225_readInt(TMC2225TypeDef *tmc2225, uint8_t address);
+bool tmc2225_readIntChecked(TMC2225TypeDef *tmc2225, uint8_t address, int32_t *value);
 
 void tmc2225_init(TMC2225TypeDef *tmc2225, uint8_t channel, ConfigurationTypeDef *tmc2225_config, const int32_t *registerResetState);
 uint8_t tmc2225_reset(TMC2225TypeDef *tmc2225);
 uint8_t tmc2225_restore(TMC2225TypeDef *tmc2225);
 void tmc2225_setRegisterResetState(TMC2225TypeDef *tmc2225, const int32_t *resetState);
 void tmc2225_setCallback(TMC2225TypeDef *tmc2225, tmc2225_callback callback);
-void tmc2225_periodicJob(TMC2225TypeDef *tmc2225, uint32_t tick);
+TMCConfigStatus tmc2225_periodicJob(TMC2225TypeDef *tmc2225, uint32_t tick);
+uint8_t tmc2225_configureBurst(TMC2225TypeDef *tmc2225, uint32_t maxSteps);
 
 uint8_t tmc2225_get_slave(TMC2225TypeDef *tmc2225);
 void tmc2225_set_slave(TMC2225TypeDef *tmc2225, uint8_t slave);
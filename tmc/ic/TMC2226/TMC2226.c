@@ -12,23 +12,24 @@ extern void tmc2226_readWriteArray(uint8_t channel, uint8_t *data, size_t writeL
 // <= UART wrapper
 
 // => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc2226_CRC8 NULL
+#else
 extern uint8_t tmc2226_CRC8(uint8_t *data, size_t length);
+#endif
 // <= CRC wrapper
 
-void tmc2226_writeInt(TMC2226TypeDef *tmc2226, uint8_t address, int32_t value)
+static const TMCUartInterface uart =
 {
-	uint8_t data[8];
-
-	data[0] = 0x05;
-	data[1] = tmc2226->slaveAddress;
-	data[2] = address | TMC_WRITE_BIT;
-	data[3] = (value >> 24) & 0xFF;
-	data[4] = (value >> 16) & 0xFF;
-	data[5] = (value >> 8 ) & 0xFF;
-	data[6] = (value      ) & 0xFF;
-	data[7] = tmc2226_CRC8(data, 7);
+	.readWriteArray  = tmc2226_readWriteArray,
+	.crc             = tmc2226_CRC8,
+	TMC_INSTRUMENT_NAME("TMC2226")
+};
 
-	tmc2226_readWriteArray(tmc2226->config->channel, &data[0], 8, 0);
+void tmc2226_writeInt(TMC2226TypeDef *tmc2226, uint8_t address, int32_t value)
+{
+	tmc_uart_writeInt(&uart, tmc2226->config->channel, tmc2226->slaveAddress, address, value);
 
 	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
@@ -36,113 +37,144 @@ void tmc2226_writeInt(TMC2226TypeDef *tmc2226, uint8_t address, int32_t value)
 	tmc2226->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
-int32_t tmc2226_readInt(TMC2226TypeDef *tmc2226, uint8_t address)
+// Read an integer from the given address.
+// Returns false if no valid reply was received after TMC_UART_READ_RETRIES retries.
+bool tmc2226_readIntChecked(TMC2226TypeDef *tmc2226, uint8_t address, int32_t *value)
 {
-	uint8_t data[8] = { 0 };
+	bool valid;
 
 	address = TMC_ADDRESS(address);
 
 	if (!TMC_IS_READABLE(tmc2226->registerAccess[address]))
-		return tmc2226->config->shadowRegister[address];
+	{
+		*value = tmc2226->config->shadowRegister[address];
+		return true;
+	}
 
-	data[0] = 0x05;
-	data[1] = tmc2226->slaveAddress;
-	data[2] = address;
-	data[3] = tmc2226_CRC8(data, 3);
+	valid = tmc_uart_readInt(&uart, tmc2226->config->channel, tmc2226->slaveAddress, address, value);
 
-	tmc2226_readWriteArray(tmc2226->config->channel, data, 4, 8);
+	if(tmc2226->link)
+		tmc_uart_linkReply(tmc2226->link, valid);
 
-	// Byte 0: Sync nibble correct?
-	if (data[0] != 0x05)
-		return 0;
+	return valid;
+}
 
-	// Byte 1: Master address correct?
-	if (data[1] != 0xFF)
-		return 0;
+// Tune the baud rate and SENDDELAY of all ICs on one channel, see tmc_uart_tuneLink().
+// The ICs then report their reads to [link] and fall back to slower baud rates on errors.
+// Returns false if no candidate worked.
+bool tmc2226_tuneLink(TMCUartLink *link, TMC2226TypeDef **ics, uint8_t count)
+{
+	uint8_t slaveAddresses[TMC_UART_LINK_NODES];
+	bool tuned;
+	uint8_t i;
 
-	// Byte 2: Address correct?
-	if (data[2] != address)
-		return 0;
+	if((count == 0) || (count > TMC_UART_LINK_NODES))
+		return false;
+
+	for(i = 0; i < count; i++)
+		slaveAddresses[i] = ics[i]->slaveAddress;
 
-	// Byte 7: CRC correct?
-	if (data[7] != tmc2226_CRC8(data, 7))
-		return 0;
+	tuned = tmc_uart_tuneLink(link, &uart, ics[0]->config->channel, slaveAddresses, count);
+
+	// Keep SENDDELAY in the shadow, so a restore writes it again
+	for(i = 0; i < count; i++)
+	{
+		ics[i]->config->shadowRegister[TMC_UART_SLAVECONF] = (int32_t) link->sendDelay << TMC_UART_SENDDELAY_SHIFT;
+		ics[i]->registerAccess[TMC_UART_SLAVECONF] |= TMC_ACCESS_DIRTY;
+		ics[i]->link = link;
+	}
 
-	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+	return tuned;
 }
 
+int32_t tmc2226_readInt(TMC2226TypeDef *tmc2226, uint8_t address)
+{
+	int32_t value;
+
+	// An invalid reply reads as 0
+	tmc2226_readIntChecked(tmc2226, address, &value);
+
+	return value;
+}
+
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2226_writeInt(ic, address, value);
+}
+
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC2226_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2226_defaultRegisterAccess,
+	.resettableRegisters    = tmc2226_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2226_resettableRegisters),
+	.restorableRegisters    = tmc2226_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2226_restorableRegisters),
+	.constants              = tmc2226_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc2226_RegisterConstants),
+	.writeInt               = writeRegister,
+};
+
 void tmc2226_init(TMC2226TypeDef *tmc2226, uint8_t channel, uint8_t slaveAddress, ConfigurationTypeDef *tmc2226_config, const int32_t *registerResetState)
 {
 	tmc2226->slaveAddress = slaveAddress;
+	tmc2226->link = NULL;
 
-	tmc2226->config               = tmc2226_config;
-	tmc2226->config->callback     = NULL;
-	tmc2226->config->channel      = channel;
-	tmc2226->config->configIndex  = 0;
-	tmc2226->config->state        = CONFIG_READY;
-
-	for(size_t i = 0; i < TMC2226_REGISTER_COUNT; i++)
-	{
-		tmc2226->registerAccess[i]      = tmc2226_defaultRegisterAccess[i];
-		tmc2226->registerResetState[i]  = registerResetState[i];
-	}
+	tmc2226->config = tmc2226_config;
+	tmc_driver_init(&driver, tmc2226->config, channel, tmc2226->registerAccess, tmc2226->registerResetState, registerResetState);
 }
 
 static void writeConfiguration(TMC2226TypeDef *tmc2226)
 {
-	uint8_t *ptr = &tmc2226->config->configIndex;
-	const int32_t *settings;
+	if(!tmc_driver_writeConfiguration(&driver, tmc2226, tmc2226->config, tmc2226->registerAccess, tmc2226->registerResetState))
+		return;
 
-	if(tmc2226->config->state == CONFIG_RESTORE)
+	// Finished configuration
+	if(tmc2226->config->callback)
 	{
-		settings = tmc2226->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2226_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2226->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
-	else
-	{
-		settings = tmc2226->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2226_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2226->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		((tmc2226_callback)tmc2226->config->callback)(tmc2226, tmc2226->config->state);
 	}
 
-	if(*ptr < TMC2226_REGISTER_COUNT)
+	tmc2226->config->state = CONFIG_READY;
+}
+
+TMCConfigStatus tmc2226_periodicJob(TMC2226TypeDef *tmc2226, uint32_t tick)
+{
+	UNUSED(tick);
+
+	if(tmc2226->config->state != CONFIG_READY)
 	{
-		tmc2226_writeInt(tmc2226, *ptr, settings[*ptr]);
-		(*ptr)++;
+		writeConfiguration(tmc2226);
+		return TMC_CONFIG_STATUS(tmc2226->config);
 	}
-	else // Finished configuration
-	{
-		if(tmc2226->config->callback)
-		{
-			((tmc2226_callback)tmc2226->config->callback)(tmc2226, tmc2226->config->state);
-		}
 
-		tmc2226->config->state = CONFIG_READY;
-	}
+	return TMC_CONFIG_STATUS_READY;
 }
 
-void tmc2226_periodicJob(TMC2226TypeDef *tmc2226, uint32_t tick)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2226_configureBurst(TMC2226TypeDef *tmc2226, uint32_t maxSteps)
 {
-	UNUSED(tick);
+	uint32_t step;
 
-	if(tmc2226->config->state != CONFIG_READY)
+	for(step = 0; tmc2226->config->state != CONFIG_READY; step++)
 	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
 		writeConfiguration(tmc2226);
-		return;
 	}
+
+	return (tmc2226->config->state == CONFIG_READY);
 }
 
 void tmc2226_setRegisterResetState(TMC2226TypeDef *tmc2226, const int32_t *resetState)
 {
-	for(size_t i = 0; i < TMC2226_REGISTER_COUNT; i++)
-		tmc2226->registerResetState[i] = resetState[i];
+	tmc_driver_setRegisterResetState(&driver, tmc2226->registerResetState, resetState);
 }
 
 void tmc2226_setCallback(TMC2226TypeDef *tmc2226, tmc2226_callback callback)
@@ -152,31 +184,12 @@ void tmc2226_setCallback(TMC2226TypeDef *tmc2226, tmc2226_callback callback)
 
 uint8_t tmc2226_reset(TMC2226TypeDef *tmc2226)
 {
-	if(tmc2226->config->state != CONFIG_READY)
-		return false;
-
-	// Reset the dirty bits and wipe the shadow registers
-	for(size_t i = 0; i < TMC2226_REGISTER_COUNT; i++)
-	{
-		tmc2226->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc2226->config->shadowRegister[i] = 0;
-	}
-
-	tmc2226->config->state        = CONFIG_RESET;
-	tmc2226->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_reset(&driver, tmc2226->config, tmc2226->registerAccess);
 }
 
 uint8_t tmc2226_restore(TMC2226TypeDef *tmc2226)
 {
-	if(tmc2226->config->state != CONFIG_READY)
-		return false;
-
-	tmc2226->config->state        = CONFIG_RESTORE;
-	tmc2226->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_restore(tmc2226->config);
 }
 
 uint8_t tmc2226_getSlaveAddress(TMC2226TypeDef *tmc2226)
@@ -188,3 +201,18 @@ void tmc2226_setSlaveAddress(TMC2226TypeDef *tmc2226, uint8_t slaveAddress)
 {
 	tmc2226->slaveAddress = slaveAddress;
 }
+
+// Move with the internal pulse generator, driven by the ramp of [stream].
+// Call this at the VACTUAL update rate with the ramp ticks elapsed since the last call.
+// VACTUAL is only written if it changed. Returns true if it was written.
+bool tmc2226_streamVelocity(TMC2226TypeDef *tmc2226, TMC_VelocityStream *stream, uint32_t ticks)
+{
+	int32_t vactual;
+
+	if(!tmc_ramp_vstream_update(stream, ticks, &vactual))
+		return false;
+
+	tmc2226_writeInt(tmc2226, TMC2226_VACTUAL, vactual);
+
+	return true;
+}
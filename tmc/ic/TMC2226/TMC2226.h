@@ -10,6 +10,7 @@
 
 #include "tmc/helpers/Constants.h"
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ramp/VelocityStream.h"
 #include "TMC2226_Register.h"
 #include "TMC2226_Constants.h"
 #include "TMC2226_Fields.h"
@@ -18,7 +19,9 @@
 #define TMC2226_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc2226_readInt(tdef, address), mask, shift)
 #define TMC2226_FIELD_UPDATE(tdef, address, mask, shift, value) \
-	(tmc2226_writeInt(tdef, address, FIELD_SET(tmc2226_readInt(tdef, address), mask, shift, value)))
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc2226_writeInt(tdef, address, FIELD_SET(tmc2226_readInt(tdef, address), mask, shift, value))), \
+	TMC_UNLOCK((tdef)->config->channel))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
@@ -28,6 +31,7 @@ typedef struct {
 	uint8_t registerAccess[TMC2226_REGISTER_COUNT];
 
 	uint8_t slaveAddress;
+	TMCUartLink *link; // Shared by all ICs of the channel, NULL: fixed baud rate. See tmc2226_tuneLink()
 } TMC2226TypeDef;
 
 typedef void (*tmc2226_callback)(TMC2226TypeDef*, ConfigState);
@@ -60,6 +64,22 @@ static const uint8_t tmc2226_defaultRegisterAccess[TMC2226_REGISTER_COUNT] =
 	0x03, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2226_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2226_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x10, 0x14, 0x22, 0x40, 0x42, 0x70
+};
+
+static const uint8_t tmc2226_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x07, 0x10, 0x11, 0x13, 0x14, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
 static const int32_t tmc2226_defaultRegisterResetState[TMC2226_REGISTER_COUNT] =
 {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
@@ -97,13 +117,17 @@ static const TMCRegisterConstant tmc2226_RegisterConstants[] =
 // Communication
 void tmc2226_writeInt(TMC2226TypeDef *tmc2226, uint8_t address, int32_t value);
 int32_t tmc2226_readInt(TMC2226TypeDef *tmc2226, uint8_t address);
+bool tmc2226_readIntChecked(TMC2226TypeDef *tmc2226, uint8_t address, int32_t *value);
+bool tmc2226_tuneLink(TMCUartLink *link, TMC2226TypeDef **ics, uint8_t count);
 
 void tmc2226_init(TMC2226TypeDef *tmc2226, uint8_t channel, uint8_t slaveAddress, ConfigurationTypeDef *tmc2226_config, const int32_t *registerResetState);
 uint8_t tmc2226_reset(TMC2226TypeDef *tmc2226);
 uint8_t tmc2226_restore(TMC2226TypeDef *tmc2226);
 void tmc2226_setRegisterResetState(TMC2226TypeDef *tmc2226, const int32_t *resetState);
 void tmc2226_setCallback(TMC2226TypeDef *tmc2226, tmc2226_callback callback);
-void tmc2226_periodicJob(TMC2226TypeDef *tmc2226, uint32_t tick);
+TMCConfigStatus tmc2226_periodicJob(TMC2226TypeDef *tmc2226, uint32_t tick);
+uint8_t tmc2226_configureBurst(TMC2226TypeDef *tmc2226, uint32_t maxSteps);
+bool tmc2226_streamVelocity(TMC2226TypeDef *tmc2226, TMC_VelocityStream *stream, uint32_t ticks);
 
 uint8_t tmc2226_getSlaveAddress(TMC2226TypeDef *tmc2226);
 void tmc2226_setSlaveAddress(TMC2226TypeDef *tmc2226, uint8_t slaveAddress);
@@ -6,8 +6,114 @@
  */
 
 #include "TMC2240.h"
-extern void tmc2240_writeInt(TMC2240TypeDef *tmc2240, uint8_t address, int32_t value);
 
+// => SPI wrapper
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc2240_readWriteSPI(uint8_t channel, uint8_t *data, size_t length);
+// <= SPI wrapper
+
+// => UART wrapper
+// Send [writeLength] bytes of [data], then receive [readLength] bytes into [data]
+extern void tmc2240_readWriteUART(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
+// <= UART wrapper
+
+// => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc2240_CRC8 NULL
+#else
+extern uint8_t tmc2240_CRC8(uint8_t *data, size_t length);
+#endif
+// <= CRC wrapper
+
+static const TMCSpiInterface spi =
+{
+	.readWriteArray  = tmc2240_readWriteSPI,
+	TMC_INSTRUMENT_NAME("TMC2240")
+};
+
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc2240_readWriteUART,
+	.crc             = tmc2240_CRC8,
+	TMC_INSTRUMENT_NAME("TMC2240")
+};
+
+// Select the interface the IC is connected with. TMC_COMM_DEFAULT is SPI.
+// UART datagrams are sent to the address set with tmc2240_setSlaveAddress().
+void tmc2240_setCommMode(TMC2240TypeDef *tmc2240, TMC_Comm_Mode mode)
+{
+	tmc2240->commMode = mode;
+}
+
+void tmc2240_writeInt(TMC2240TypeDef *tmc2240, uint8_t address, int32_t value)
+{
+	if(tmc2240->commMode == TMC_COMM_UART)
+		tmc_uart_writeInt(&uart, tmc2240->config->channel, tmc2240->slaveAddress, address, value);
+	else
+		tmc_spi_writeInt(&spi, tmc2240->config->channel, address, value);
+
+	// Write to the shadow register and mark the register dirty
+	address = TMC_ADDRESS(address);
+	TMC_SHADOW_REGISTER(tmc2240->config, address) = value;
+	tmc2240->registerAccess[address] |= TMC_ACCESS_DIRTY;
+}
+
+int32_t tmc2240_readInt(TMC2240TypeDef *tmc2240, uint8_t address)
+{
+	int32_t value;
+
+	address = TMC_ADDRESS(address);
+
+	// register not readable -> shadow register copy
+	if(!TMC_IS_READABLE(tmc2240->registerAccess[address]))
+		return TMC_SHADOW_REGISTER(tmc2240->config, address);
+
+	if(tmc2240->commMode != TMC_COMM_UART)
+		return tmc_spi_readInt(&spi, tmc2240->config->channel, address);
+
+	// An invalid reply reads as 0
+	tmc_uart_readInt(&uart, tmc2240->config->channel, tmc2240->slaveAddress, address, &value);
+
+	return value;
+}
+
+// Read multiple registers. Over SPI the read requests are pipelined, taking
+// count+1 transfers instead of 2*count, see tmc/helpers/SPI.h.
+void tmc2240_readIntBatch(TMC2240TypeDef *tmc2240, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	size_t i;
+
+	if(tmc2240->commMode != TMC_COMM_UART)
+	{
+		tmc_spi_readIntBatch(&spi, tmc2240->config, tmc2240->registerAccess, addresses, values, count);
+		return;
+	}
+
+	// UART replies follow their request directly, there is nothing to pipeline
+	for(i = 0; i < count; i++)
+		values[i] = tmc2240_readInt(tmc2240, addresses[i]);
+}
+
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2240_writeInt(ic, address, value);
+}
+
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC2240_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2240_defaultRegisterAccess,
+	.resettableRegisters    = tmc2240_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2240_resettableRegisters),
+	.restorableRegisters    = NULL,
+	.restorableCount        = 0,
+	.constants              = tmc2240_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc2240_RegisterConstants),
+	.writeInt               = writeRegister,
+};
 
 // Initialize a TMC2240 IC.
 // This function requires:
@@ -21,53 +127,33 @@ void tmc2240_init(TMC2240TypeDef *tmc2240, uint8_t channel, ConfigurationTypeDef
 	tmc2240->oldTick   = 0;
 	tmc2240->oldX      = 0;
 
-	tmc2240->config               = config;
-	tmc2240->config->callback     = NULL;
-	tmc2240->config->channel      = channel;
-	tmc2240->config->configIndex  = 0;
-	tmc2240->config->state        = CONFIG_READY;
+#if TMC_FEATURE_TELEMETRY
+	tmc_adcTelemetry_init(&tmc2240->adc);
+#endif
 
-	size_t i;
-	for(i = 0; i < TMC2240_REGISTER_COUNT; i++)
-	{
-		tmc2240->registerAccess[i]      = tmc2240_defaultRegisterAccess[i];
-		tmc2240->registerResetState[i]  = registerResetState[i];
-	}
+	tmc2240->commMode = TMC_COMM_DEFAULT;
+
+	tmc2240->config = config;
+	tmc_driver_init(&driver, tmc2240->config, channel, tmc2240->registerAccess, tmc2240->registerResetState, registerResetState);
 }
 
 // Reset the TMC2240.
 uint8_t tmc2240_reset(TMC2240TypeDef *tmc2240)
 {
-	if(tmc2240->config->state != CONFIG_READY)
-		return false;
-
-	tmc2240->config->state        = CONFIG_RESET;
-	tmc2240->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_reset(&driver, tmc2240->config, tmc2240->registerAccess);
 }
 
 // Restore the TMC2240 to the state stored in the shadow registers.
 // This can be used to recover the IC configuration after a VM power loss.
 uint8_t tmc2240_restore(TMC2240TypeDef *tmc2240)
 {
-	if(tmc2240->config->state != CONFIG_READY)
-		return false;
-
-	tmc2240->config->state        = CONFIG_RESTORE;
-	tmc2240->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_restore(tmc2240->config);
 }
 
 // Change the values the IC will be configured with when performing a reset.
 void tmc2240_setRegisterResetState(TMC2240TypeDef *tmc2240, const int32_t *resetState)
 {
-	size_t i;
-	for(i = 0; i < TMC2240_REGISTER_COUNT; i++)
-	{
-		tmc2240->registerResetState[i] = resetState[i];
-	}
+	tmc_driver_setRegisterResetState(&driver, tmc2240->registerResetState, resetState);
 }
 
 // Register a function to be called after completion of the configuration mechanism
@@ -87,42 +173,237 @@ void tmc2240_setSlaveAddress(TMC2240TypeDef *tmc2240, uint8_t slaveAddress)
 // Helper function: Configure the next register.
 static void writeConfiguration(TMC2240TypeDef *tmc2240)
 {
-	uint8_t *ptr = &tmc2240->config->configIndex;
-	const int32_t *settings;
-
-	settings = tmc2240->registerResetState;
-	// Find the next resettable register
-	while((*ptr < TMC2240_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2240->registerAccess[*ptr]))
-		{
-		(*ptr)++;
-		}
-//	}
+	if(!tmc_driver_writeConfiguration(&driver, tmc2240, tmc2240->config, tmc2240->registerAccess, tmc2240->registerResetState))
+		return;
 
-	if(*ptr < TMC2240_REGISTER_COUNT)
+	// Finished configuration
+	if(tmc2240->config->callback)
 	{
-		tmc2240_writeInt(tmc2240, *ptr, settings[*ptr]);
-		(*ptr)++;
+		((tmc2240_callback)tmc2240->config->callback)(tmc2240, tmc2240->config->state);
 	}
-	else // Finished configuration
-	{
-		if(tmc2240->config->callback)
-		{
-			((tmc2240_callback)tmc2240->config->callback)(tmc2240, tmc2240->config->state);
-		}
 
-		tmc2240->config->state = CONFIG_READY;
-	}
+	tmc2240->config->state = CONFIG_READY;
+}
+
+#if TMC_FEATURE_TELEMETRY
+// Read and publish the ADC values, see tmc/helpers/AdcTelemetry.h
+static void serviceAdc(TMC2240TypeDef *tmc2240, uint32_t tick)
+{
+	int32_t supplyAin = tmc2240_readInt(tmc2240, TMC2240_ADC_VSUPPLY_AIN);
+	int32_t temperature = tmc2240_readInt(tmc2240, TMC2240_ADC_TEMP);
+
+	tmc_adcTelemetry_update(&tmc2240->adc, tmc2240,
+			FIELD_GET(supplyAin, TMC2240_ADC_VSUPPLY_MASK, TMC2240_ADC_VSUPPLY_SHIFT),
+			FIELD_GET(supplyAin, TMC2240_ADC_AIN_MASK, TMC2240_ADC_AIN_SHIFT),
+			FIELD_GET(temperature, TMC2240_ADC_TEMP_MASK, TMC2240_ADC_TEMP_SHIFT),
+			tick);
+}
+
+// Latest ADC values (TMC_ADC_VALUE_COUNT, indexed by TMCAdcValue) without bus access.
+// Configure the capture with tmc2240->adc.interval. Returns false if nothing was captured yet.
+bool tmc2240_readAdc(TMC2240TypeDef *tmc2240, int32_t *values, uint32_t *tick)
+{
+	tmc_snapshot_read(&tmc2240->adc.snapshot, values, TMC_ADC_VALUE_COUNT, tick);
+
+	return (tmc2240->adc.snapshot.sequence != 0);
 }
 
+// Thermal derating from ADC_TEMP, see tmc/helpers/ThermalDerating.h.
+// Processes each ADC capture once, call it after tmc2240_periodicJob().
+// Returns true if GLOBAL_SCALER was written.
+bool tmc2240_thermalUpdate(TMC2240TypeDef *tmc2240, TMCThermalDerating *thermal)
+{
+	int32_t values[TMC_ADC_VALUE_COUNT];
+	uint32_t tick;
+
+	if(!tmc2240_readAdc(tmc2240, values, &tick))
+		return false;
+
+	if(thermal->valid && (tick == thermal->sampleTick))
+		return false;
+
+	thermal->sampleTick = tick;
+
+	if(!tmc_thermal_updateTemperature(thermal, values[TMC_ADC_TEMPERATURE]))
+		return false;
+
+	tmc2240_writeInt(tmc2240, TMC2240_GLOBAL_SCALER, tmc_thermal_globalScaler(thermal));
+
+	return true;
+}
+#endif
+
 // Call this periodically
-void tmc2240_periodicJob(TMC2240TypeDef *tmc2240, uint32_t tick)
+TMCConfigStatus tmc2240_periodicJob(TMC2240TypeDef *tmc2240, uint32_t tick)
 {
 	UNUSED(tick);
 	if(tmc2240->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc2240);
-		return;
+		return TMC_CONFIG_STATUS(tmc2240->config);
+	}
+
+#if TMC_FEATURE_TELEMETRY
+	if(tmc_adcTelemetry_due(&tmc2240->adc, tick))
+		serviceAdc(tmc2240, tick);
+#endif
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2240_configureBurst(TMC2240TypeDef *tmc2240, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc2240->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc2240);
+	}
+
+	return (tmc2240->config->state == CONFIG_READY);
+}
+
+// Sample SG_RESULT and CS_ACTUAL into [stream] as [axis], see tmc/helpers/LoadStream.h
+void tmc2240_sampleLoad(TMC2240TypeDef *tmc2240, TMCLoadStream *stream, uint8_t axis, uint32_t tick)
+{
+	int32_t drvStatus = tmc2240_readInt(tmc2240, TMC2240_DRVSTATUS);
+
+	tmc_loadStream_sample(stream, axis,
+			FIELD_GET(drvStatus, TMC2240_SG_RESULT_MASK, TMC2240_SG_RESULT_SHIFT),
+			FIELD_GET(drvStatus, TMC2240_CS_ACTUAL_MASK, TMC2240_CS_ACTUAL_SHIFT),
+			tick);
+}
+
+// Write planned chopper thresholds, see tmc_planChopperThresholds()
+void tmc2240_writeChopperThresholds(TMC2240TypeDef *tmc2240, const TMCChopperThresholdsTypeDef *thresholds)
+{
+	tmc2240_writeInt(tmc2240, TMC2240_TPWMTHRS, thresholds->tpwmthrs);
+	tmc2240_writeInt(tmc2240, TMC2240_TCOOLTHRS, thresholds->tcoolthrs);
+	tmc2240_writeInt(tmc2240, TMC2240_THIGH, thresholds->thigh);
+}
+
+// Sensorless homing with StallGuard2, see tmc/helpers/Homing.h.
+// The TMC2240 has no motion controller: The application steps the motor at the homing
+// velocity, away from the end stop in TMC_HOMING_CALIBRATE, towards it in
+// TMC_HOMING_ACCELERATE and TMC_HOMING_SEEK, and stops on TMC_HOMING_DONE or
+// TMC_HOMING_FAILED. Poll periodically after tmc_homing_start().
+static void homingFinish(TMC2240TypeDef *tmc2240, TMCHomingTypeDef *homing, TMCHomingState state)
+{
+	tmc2240_writeInt(tmc2240, TMC2240_COOLCONF, homing->saved[0]);
+	tmc2240_writeInt(tmc2240, TMC2240_TCOOLTHRS, homing->saved[1]);
+
+	homing->state = state;
+}
+
+static void writeStallThreshold(TMC2240TypeDef *tmc2240, TMCHomingTypeDef *homing)
+{
+	tmc2240_writeInt(tmc2240, TMC2240_COOLCONF, FIELD_SET(homing->saved[0], TMC2240_SGT_MASK, TMC2240_SGT_SHIFT, homing->threshold));
+}
+
+TMCHomingState tmc2240_home(TMC2240TypeDef *tmc2240, TMCHomingTypeDef *homing)
+{
+	int32_t drvStatus;
+
+	switch(homing->state)
+	{
+	case TMC_HOMING_START:
+		homing->saved[0] = tmc2240_readInt(tmc2240, TMC2240_COOLCONF);
+		homing->saved[1] = tmc2240_readInt(tmc2240, TMC2240_TCOOLTHRS);
+
+		// StallGuard active at every velocity of the homing
+		tmc2240_writeInt(tmc2240, TMC2240_TCOOLTHRS, TMC2240_TCOOLTHRS_MASK);
+		writeStallThreshold(tmc2240, homing);
+
+		homing->state = (homing->calibrated) ? TMC_HOMING_ACCELERATE : TMC_HOMING_CALIBRATE;
+		break;
+	case TMC_HOMING_CALIBRATE:
+		drvStatus = tmc2240_readInt(tmc2240, TMC2240_DRVSTATUS);
+		if(!tmc_homing_sample(homing, FIELD_GET(drvStatus, TMC2240_SG_RESULT_MASK, TMC2240_SG_RESULT_SHIFT)))
+			break;
+
+		homing->state = tmc_homing_calibrateSG2(homing);
+		if(homing->state == TMC_HOMING_FAILED)
+			homingFinish(tmc2240, homing, TMC_HOMING_FAILED);
+		else
+			writeStallThreshold(tmc2240, homing);
+		break;
+	case TMC_HOMING_ACCELERATE:
+		// Wait for the application to reverse and reach the homing velocity
+		if(++homing->count < TMC_HOMING_SETTLE_SAMPLES)
+			break;
+
+		tmc_homing_resetSamples(homing);
+		tmc_homing_arm(homing);
+		break;
+	case TMC_HOMING_SEEK:
+		if(homing->diagEvent || (tmc2240_readInt(tmc2240, TMC2240_DRVSTATUS) & TMC2240_STALLGUARD_MASK))
+			homingFinish(tmc2240, homing, TMC_HOMING_DONE);
+		else if(tmc_homing_timedOut(homing))
+			homingFinish(tmc2240, homing, TMC_HOMING_FAILED);
+		break;
+	default:
+		break;
 	}
+
+	return homing->state;
+}
+
+// CoolStep auto tuning, see tmc/helpers/CoolStepTune.h.
+// The TMC2240 has no motion controller: The application steps the motor at the calibration
+// velocity while the tuning runs. Poll periodically after tmc_coolStepTune_start() until
+// TMC_COOLSTEP_TUNE_DONE or TMC_COOLSTEP_TUNE_FAILED is returned, then stop the motor.
+// On a failure the previous COOLCONF is kept.
+static void coolStepTuneFinish(TMC2240TypeDef *tmc2240, TMCCoolStepTuneTypeDef *tune, TMCCoolStepTuneState state)
+{
+	tmc2240_writeInt(tmc2240, TMC2240_COOLCONF, (state == TMC_COOLSTEP_TUNE_DONE) ? tune->coolconf : tune->saved[0]);
+	tmc2240_writeInt(tmc2240, TMC2240_TCOOLTHRS, tune->saved[1]);
+
+	tune->state = state;
 }
 
+TMCCoolStepTuneState tmc2240_tuneCoolStep(TMC2240TypeDef *tmc2240, TMCCoolStepTuneTypeDef *tune)
+{
+	int32_t drvStatus;
+	TMCCoolStepTuneState state;
+
+	switch(tune->state)
+	{
+	case TMC_COOLSTEP_TUNE_START:
+		tune->saved[0] = tmc2240_readInt(tmc2240, TMC2240_COOLCONF);
+		tune->saved[1] = tmc2240_readInt(tmc2240, TMC2240_TCOOLTHRS);
+
+		// CoolStep active at every velocity of the tuning, off for the baseline
+		tmc2240_writeInt(tmc2240, TMC2240_TCOOLTHRS, TMC2240_TCOOLTHRS_MASK);
+		tune->state = TMC_COOLSTEP_TUNE_BASELINE;
+		tmc2240_writeInt(tmc2240, TMC2240_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		break;
+	case TMC_COOLSTEP_TUNE_BASELINE:
+	case TMC_COOLSTEP_TUNE_SWEEP:
+		drvStatus = tmc2240_readInt(tmc2240, TMC2240_DRVSTATUS);
+		if(!tmc_coolStepTune_sample(tune, FIELD_GET(drvStatus, TMC2240_SG_RESULT_MASK, TMC2240_SG_RESULT_SHIFT), FIELD_GET(drvStatus, TMC2240_CS_ACTUAL_MASK, TMC2240_CS_ACTUAL_SHIFT)))
+			break;
+
+		state = tmc_coolStepTune_evaluate(tune);
+		if(state != TMC_COOLSTEP_TUNE_SWEEP)
+		{
+			coolStepTuneFinish(tmc2240, tune, state);
+			break;
+		}
+
+		tune->state = state;
+		tmc2240_writeInt(tmc2240, TMC2240_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		break;
+	default:
+		break;
+	}
 
+	return tune->state;
+}
@@ -17,6 +17,9 @@
 	FIELD_GET(tmc2240_readInt(tdef, address), mask, shift)
 #define TMC2240_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc2240_writeInt(tdef, address, FIELD_SET(tmc2240_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC2240_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc2240_writeInt(tdef, address, FIELDS_SET(tmc2240_readInt(tdef, address), mask, values)))
 
 // Typedefs
 typedef struct
@@ -27,6 +30,10 @@ typedef struct
 	int32_t registerResetState[TMC2240_REGISTER_COUNT];
 	uint8_t registerAccess[TMC2240_REGISTER_COUNT];
 	uint8_t slaveAddress;
+	TMC_Comm_Mode commMode;  // Set with tmc2240_setCommMode()
+#if TMC_FEATURE_TELEMETRY
+	TMCAdcTelemetryTypeDef adc;  // Supply, AIN and temperature, see tmc2240_readAdc()
+#endif
 } TMC2240TypeDef;
 
 typedef void (*tmc2240_callback)(TMC2240TypeDef*, ConfigState);
@@ -88,6 +95,24 @@ static const uint8_t tmc2240_defaultRegisterAccess[TMC2240_REGISTER_COUNT] =
 	0x03, 0x01, 0x01, ____, 0x03, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2240_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2240_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x2D, 0x38, 0x39, 0x3A, 0x3B,
+	0x52, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x70, 0x74
+};
+
+static const uint8_t tmc2240_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x2D, 0x38, 0x39, 0x3A, 0x3B,
+	0x52, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x70, 0x74
+};
+
 // Register constants (only required for 0x42 registers, since we do not have
 // any way to find out the content but want to hold the actual value in the
 // shadow register so an application (i.e. the TMCL IDE) can still display
@@ -97,6 +122,11 @@ static const TMCRegisterConstant tmc2240_RegisterConstants[] =
 		///
 };
 
+void tmc2240_writeInt(TMC2240TypeDef *tmc2240, uint8_t address, int32_t value);
+int32_t tmc2240_readInt(TMC2240TypeDef *tmc2240, uint8_t address);
+void tmc2240_readIntBatch(TMC2240TypeDef *tmc2240, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc2240_setCommMode(TMC2240TypeDef *tmc2240, TMC_Comm_Mode mode);
+
 void tmc2240_init(TMC2240TypeDef *tmc2240, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
 //void tmc2240_fillShadowRegisters(TMC2240TypeDef *tmc2240);
 uint8_t tmc2240_reset(TMC2240TypeDef *tmc2240);
@@ -105,8 +135,17 @@ uint8_t tmc2240_getSlaveAddress(TMC2240TypeDef *tmc2240);
 void tmc2240_setSlaveAddress(TMC2240TypeDef *tmc2240, uint8_t slaveAddress);
 void tmc2240_setRegisterResetState(TMC2240TypeDef *tmc2240, const int32_t *resetState);
 void tmc2240_setCallback(TMC2240TypeDef *tmc2240, tmc2240_callback callback);
-void tmc2240_periodicJob(TMC2240TypeDef *tmc2240, uint32_t tick);
+TMCConfigStatus tmc2240_periodicJob(TMC2240TypeDef *tmc2240, uint32_t tick);
+uint8_t tmc2240_configureBurst(TMC2240TypeDef *tmc2240, uint32_t maxSteps);
+#if TMC_FEATURE_TELEMETRY
+bool tmc2240_readAdc(TMC2240TypeDef *tmc2240, int32_t *values, uint32_t *tick);
+bool tmc2240_thermalUpdate(TMC2240TypeDef *tmc2240, TMCThermalDerating *thermal);
+#endif
 
 uint8_t tmc2240_consistencyCheck(TMC2240TypeDef *tmc2240);
+void tmc2240_sampleLoad(TMC2240TypeDef *tmc2240, TMCLoadStream *stream, uint8_t axis, uint32_t tick);
+void tmc2240_writeChopperThresholds(TMC2240TypeDef *tmc2240, const TMCChopperThresholdsTypeDef *thresholds);
+TMCHomingState tmc2240_home(TMC2240TypeDef *tmc2240, TMCHomingTypeDef *homing);
+TMCCoolStepTuneState tmc2240_tuneCoolStep(TMC2240TypeDef *tmc2240, TMCCoolStepTuneTypeDef *tune);
 
 #endif /* TMC_IC_TMC2240_H_ */
@@ -12,9 +12,21 @@ extern void tmc2300_readWriteArray(uint8_t channel, uint8_t *data, size_t writeL
 // <= UART wrapper
 
 // => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc2300_CRC8 NULL
+#else
 extern uint8_t tmc2300_CRC8(uint8_t *data, size_t length);
+#endif
 // <= CRC wrapper
 
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc2300_readWriteArray,
+	.crc             = tmc2300_CRC8,
+	TMC_INSTRUMENT_NAME("TMC2300")
+};
+
 void tmc2300_writeInt(TMC2300TypeDef *tmc2300, uint8_t address, int32_t value)
 {
 	// When we are in standby or in the reset procedure we do not actually write
@@ -23,18 +35,7 @@ void tmc2300_writeInt(TMC2300TypeDef *tmc2300, uint8_t address, int32_t value)
 	// register contents into the chip.
 	if (!tmc2300->standbyEnabled || tmc2300->config->state != CONFIG_RESET)
 	{
-		uint8_t data[8];
-
-		data[0] = 0x05;
-		data[1] = tmc2300->slaveAddress;
-		data[2] = address | TMC_WRITE_BIT;
-		data[3] = (value >> 24) & 0xFF;
-		data[4] = (value >> 16) & 0xFF;
-		data[5] = (value >> 8 ) & 0xFF;
-		data[6] = (value      ) & 0xFF;
-		data[7] = tmc2300_CRC8(data, 7);
-
-		tmc2300_readWriteArray(tmc2300->config->channel, &data[0], 8, 0);
+		tmc_uart_writeInt(&uart, tmc2300->config->channel, tmc2300->slaveAddress, address, value);
 	}
 
 	// Write to the shadow register and mark the register dirty
@@ -43,63 +44,62 @@ void tmc2300_writeInt(TMC2300TypeDef *tmc2300, uint8_t address, int32_t value)
 	tmc2300->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
-int32_t tmc2300_readInt(TMC2300TypeDef *tmc2300, uint8_t address)
+// Read an integer from the given address.
+// Returns false if no valid reply was received after TMC_UART_READ_RETRIES retries.
+bool tmc2300_readIntChecked(TMC2300TypeDef *tmc2300, uint8_t address, int32_t *value)
 {
-	uint8_t data[8] = { 0 };
-
 	address = TMC_ADDRESS(address);
 
 	// When the chip is in standby or when accessing a write-only register
 	// use the shadow register content instead.
 	if (tmc2300->standbyEnabled || !TMC_IS_READABLE(tmc2300->registerAccess[address]))
-		return tmc2300->config->shadowRegister[address];
-
-	data[0] = 0x05;
-	data[1] = tmc2300->slaveAddress;
-	data[2] = address;
-	data[3] = tmc2300_CRC8(data, 3);
-
-	tmc2300_readWriteArray(tmc2300->config->channel, data, 4, 8);
+	{
+		*value = tmc2300->config->shadowRegister[address];
+		return true;
+	}
 
-	// Byte 0: Sync nibble correct?
-	if (data[0] != 0x05)
-		return 0;
+	return tmc_uart_readInt(&uart, tmc2300->config->channel, tmc2300->slaveAddress, address, value);
+}
 
-	// Byte 1: Master address correct?
-	if (data[1] != 0xFF)
-		return 0;
+int32_t tmc2300_readInt(TMC2300TypeDef *tmc2300, uint8_t address)
+{
+	int32_t value;
 
-	// Byte 2: Address correct?
-	if (data[2] != address)
-		return 0;
+	// An invalid reply reads as 0
+	tmc2300_readIntChecked(tmc2300, address, &value);
 
-	// Byte 7: CRC correct?
-	if (data[7] != tmc2300_CRC8(data, 7))
-		return 0;
+	return value;
+}
 
-	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc2300_writeInt(ic, address, value);
 }
 
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC2300_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc2300_defaultRegisterAccess,
+	.resettableRegisters    = tmc2300_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc2300_resettableRegisters),
+	.restorableRegisters    = tmc2300_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc2300_restorableRegisters),
+	.constants              = tmc2300_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc2300_RegisterConstants),
+	.writeInt               = writeRegister,
+};
+
 void tmc2300_init(TMC2300TypeDef *tmc2300, uint8_t channel, ConfigurationTypeDef *tmc2300_config, const int32_t *registerResetState)
 {
-	tmc2300->config               = tmc2300_config;
-	tmc2300->config->callback     = NULL;
-	tmc2300->config->channel      = channel;
-	tmc2300->config->configIndex  = 0;
-	tmc2300->config->state        = CONFIG_READY;
+	tmc2300->config = tmc2300_config;
+	tmc_driver_init(&driver, tmc2300->config, channel, tmc2300->registerAccess, tmc2300->registerResetState, registerResetState);
 
 	// Default slave address: 0
 	tmc2300->slaveAddress = 0;
 
 	// Start in standby
 	tmc2300->standbyEnabled = 1;
-
-	int i;
-	for(i = 0; i < TMC2300_REGISTER_COUNT; i++)
-	{
-		tmc2300->registerAccess[i]      = tmc2300_defaultRegisterAccess[i];
-		tmc2300->registerResetState[i]  = registerResetState[i];
-	}
 }
 
 // Fill the shadow registers of hardware preset registers
@@ -107,51 +107,21 @@ void tmc2300_init(TMC2300TypeDef *tmc2300, uint8_t channel, ConfigurationTypeDef
 // (e.g. for the TMCL IDE register browser)
 static void fillShadowRegisters(TMC2300TypeDef *tmc2300)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc2300_RegisterConstants) == 0)
-		return;
-
-	size_t i, j = 0;
-	for(i = 0; i < TMC2300_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset registers
-		// that have not yet been written (no dirty bit) here.
-		if(!TMC_IS_PRESET(tmc2300->registerAccess[i]) || TMC_IS_DIRTY(tmc2300->registerAccess[i]))
-			continue;
-
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while (j < ARRAY_SIZE(tmc2300_RegisterConstants) && (tmc2300_RegisterConstants[j].address < i))
-		{
-			j++;
-		}
-
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc2300_RegisterConstants))
-			break;
-
-		// If we have an entry for our current address, write the constant
-		if (tmc2300_RegisterConstants[j].address == i)
-		{
-			tmc2300->config->shadowRegister[i] = tmc2300_RegisterConstants[j].value;
-		}
-	}
+	tmc_driver_fillShadowRegisters(&driver, tmc2300->config, tmc2300->registerAccess);
 }
 
 void writeConfiguration(TMC2300TypeDef *tmc2300)
 {
 	uint8_t *ptr = &tmc2300->config->configIndex;
 	const int32_t *settings;
+	const uint8_t *registers;
+	size_t registerCount;
 
 	if (tmc2300->config->state == CONFIG_RESET)
 	{
 		settings = tmc2300->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC2300_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc2300->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		registers      = tmc2300_resettableRegisters;
+		registerCount  = ARRAY_SIZE(tmc2300_resettableRegisters);
 	}
 	else
 	{
@@ -160,17 +130,19 @@ void writeConfiguration(TMC2300TypeDef *tmc2300)
 			return;
 
 		settings = tmc2300->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC2300_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc2300->registerAccess[*ptr]))
+		registers      = tmc2300_restorableRegisters;
+		registerCount  = ARRAY_SIZE(tmc2300_restorableRegisters);
+		// Skip hardware preset registers that have not been written yet
+		while((*ptr < registerCount) && !TMC_IS_RESTORABLE(tmc2300->registerAccess[registers[*ptr]]))
 		{
 			(*ptr)++;
 		}
 	}
 
-	if(*ptr < TMC2300_REGISTER_COUNT)
+	if(*ptr < registerCount)
 	{
 		// Reset/restore the found register
-		tmc2300_writeInt(tmc2300, *ptr, settings[*ptr]);
+		tmc2300_writeInt(tmc2300, registers[*ptr], settings[registers[*ptr]]);
 		(*ptr)++;
 	}
 	else
@@ -199,11 +171,7 @@ void writeConfiguration(TMC2300TypeDef *tmc2300)
 
 void tmc2300_setRegisterResetState(TMC2300TypeDef *tmc2300, const int32_t *resetState)
 {
-	size_t i;
-	for (i = 0; i < TMC2300_REGISTER_COUNT; i++)
-	{
-		tmc2300->registerResetState[i] = resetState[i];
-	}
+	tmc_driver_setRegisterResetState(&driver, tmc2300->registerResetState, resetState);
 }
 
 void tmc2300_setCallback(TMC2300TypeDef *tmc2300, tmc2300_callback callback)
@@ -211,15 +179,41 @@ void tmc2300_setCallback(TMC2300TypeDef *tmc2300, tmc2300_callback callback)
 	tmc2300->config->callback = (tmc_callback_config) callback;
 }
 
-void tmc2300_periodicJob(TMC2300TypeDef *tmc2300, uint32_t tick)
+TMCConfigStatus tmc2300_periodicJob(TMC2300TypeDef *tmc2300, uint32_t tick)
 {
 	UNUSED(tick);
 
 	if(tmc2300->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc2300);
-		return;
+		return TMC_CONFIG_STATUS(tmc2300->config);
 	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc2300_configureBurst(TMC2300TypeDef *tmc2300, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc2300->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		// Restoring is paused while in standby
+		if((tmc2300->config->state == CONFIG_RESTORE) && tmc2300->standbyEnabled)
+			break;
+
+		writeConfiguration(tmc2300);
+	}
+
+	return (tmc2300->config->state == CONFIG_READY);
 }
 
 uint8_t tmc2300_reset(TMC2300TypeDef *tmc2300)
@@ -278,3 +272,60 @@ void tmc2300_setStandby(TMC2300TypeDef *tmc2300, uint8_t standbyState)
 	}
 	tmc2300->standbyEnabled = standbyState;
 }
+
+// Value of [address] after leaving standby: The hardware preset or 0
+static int32_t powerOnValue(uint8_t address)
+{
+	size_t i;
+
+	for(i = 0; i < ARRAY_SIZE(tmc2300_RegisterConstants); i++)
+	{
+		if(tmc2300_RegisterConstants[i].address == address)
+			return tmc2300_RegisterConstants[i].value;
+	}
+
+	return 0;
+}
+
+// Leave standby and restore the configuration in one burst.
+// Standby drops all register contents, the IC wakes with its power-on values.
+// Only registers whose configured value differs from that are written, instead
+// of restoring one register per tmc2300_periodicJob(). The configuration callback is
+// called with CONFIG_RESTORE once the IC is ready for motion.
+// A pending reset is not shortened - the regular mechanism continues then.
+// Returns the amount of registers written.
+uint8_t tmc2300_wake(TMC2300TypeDef *tmc2300)
+{
+	uint8_t written = 0;
+	size_t i;
+
+	if(tmc2300->config->state == CONFIG_RESET)
+	{
+		tmc2300_setStandby(tmc2300, 0);
+		return 0;
+	}
+
+	tmc2300->standbyEnabled = 0;
+
+	for(i = 0; i < ARRAY_SIZE(tmc2300_restorableRegisters); i++)
+	{
+		uint8_t address = tmc2300_restorableRegisters[i];
+		int32_t value = tmc2300->config->shadowRegister[address];
+
+		if(!TMC_IS_RESTORABLE(tmc2300->registerAccess[address]) || (value == powerOnValue(address)))
+			continue;
+
+		tmc2300_writeInt(tmc2300, address, value);
+		written++;
+	}
+
+	tmc2300->config->state        = CONFIG_READY;
+	tmc2300->config->configIndex  = 0;
+
+	if(tmc2300->config->callback)
+	{
+		((tmc2300_callback)tmc2300->config->callback)(tmc2300, CONFIG_RESTORE);
+	}
+
+	return written;
+}
@@ -18,7 +18,14 @@
 #define TMC2300_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc2300_readInt(tdef, address), mask, shift)
 #define TMC2300_FIELD_WRITE(tdef, address, mask, shift, value) \
-	(tmc2300_writeInt(tdef, address, FIELD_SET(tmc2300_readInt(tdef, address), mask, shift, value)))
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc2300_writeInt(tdef, address, FIELD_SET(tmc2300_readInt(tdef, address), mask, shift, value))), \
+	TMC_UNLOCK((tdef)->config->channel))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC2300_FIELDS_WRITE(tdef, address, mask, values) \
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc2300_writeInt(tdef, address, FIELDS_SET(tmc2300_readInt(tdef, address), mask, values))), \
+	TMC_UNLOCK((tdef)->config->channel))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
@@ -53,6 +60,22 @@ static const uint8_t tmc2300_defaultRegisterAccess[TMC2300_REGISTER_COUNT] =
 	0x43, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc2300_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc2300_resettableRegisters[] =
+{
+	0x01, 0x03, 0x14, 0x22, 0x40, 0x42
+};
+
+static const uint8_t tmc2300_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x10, 0x11, 0x14, 0x22, 0x40, 0x42, 0x6C, 0x70
+};
+
 void writeConfiguration(TMC2300TypeDef *tmc2300);
 static const int32_t tmc2300_defaultRegisterResetState[TMC2300_REGISTER_COUNT] =
 {
@@ -83,18 +106,21 @@ static const TMCRegisterConstant tmc2300_RegisterConstants[] =
 
 void tmc2300_writeInt(TMC2300TypeDef *tmc2300, uint8_t address, int32_t value);
 int32_t tmc2300_readInt(TMC2300TypeDef *tmc2300, uint8_t address);
+bool tmc2300_readIntChecked(TMC2300TypeDef *tmc2300, uint8_t address, int32_t *value);
 
 void tmc2300_init(TMC2300TypeDef *tmc2300, uint8_t channel, ConfigurationTypeDef *tmc2300_config, const int32_t *registerResetState);
 uint8_t tmc2300_reset(TMC2300TypeDef *tmc2300);
 uint8_t tmc2300_restore(TMC2300TypeDef *tmc2300);
 void tmc2300_setRegisterResetState(TMC2300TypeDef *tmc2300, const int32_t *resetState);
 void tmc2300_setCallback(TMC2300TypeDef *tmc2300, tmc2300_callback callback);
-void tmc2300_periodicJob(TMC2300TypeDef *tmc2300, uint32_t tick);
+TMCConfigStatus tmc2300_periodicJob(TMC2300TypeDef *tmc2300, uint32_t tick);
+uint8_t tmc2300_configureBurst(TMC2300TypeDef *tmc2300, uint32_t maxSteps);
 
 uint8_t tmc2300_getSlaveAddress(TMC2300TypeDef *tmc2300);
 void tmc2300_setSlaveAddress(TMC2300TypeDef *tmc2300, uint8_t slaveAddress);
 
 uint8_t tmc2300_getStandby(TMC2300TypeDef *tmc2300);
 void tmc2300_setStandby(TMC2300TypeDef *tmc2300, uint8_t standbyState);
+uint8_t tmc2300_wake(TMC2300TypeDef *tmc2300);
 
 #endif /* TMC_IC_TMC2300_H_ */
@@ -12,13 +12,18 @@ extern void tmc2590_readWriteArray(uint8_t channel, uint8_t *data, size_t length
 // <= SPI wrapper
 
 static void continousSync(TMC2590TypeDef *tmc2590);
+static void decodeReply(TMC2590TypeDef *tmc2590, uint32_t reply);
 static void readWrite(TMC2590TypeDef *tmc2590, uint32_t value);
+static void writeNext(TMC2590TypeDef *tmc2590);
 static void readImmediately(TMC2590TypeDef *tmc2590, uint8_t rdsel);
 
 static void standStillCurrentLimitation(TMC2590TypeDef *tmc2590, uint32_t tick)
 {
-	// Check if the motor is in standstill
-	if (!TMC2590_GET_STST(tmc2590_readInt(tmc2590, TMC2590_RESPONSE_LATEST)))
+	uint8_t currentScale;
+
+	// Check if the motor is in standstill. The flag is taken from the latest
+	// decoded reply, this does not need an additional datagram.
+	if (!TMC2590_GET_STST(tmc2590->status.flags))
 	{
 		// The standStillTick variable holds the tick counter where a standstill
 		// started.
@@ -28,100 +33,121 @@ static void standStillCurrentLimitation(TMC2590TypeDef *tmc2590, uint32_t tick)
 	}
 
 	// Check if standstill timeout has been reached
-	if (tick - tmc2590->standStillTick > tmc2590->standStillTimeout)
-	{
-		tmc2590->isStandStillCurrent = 1;
-		// Change to standstill current
-		TMC2590_FIELD_WRITE(tmc2590, TMC2590_SGCSCONF, TMC2590_CS_MASK, TMC2590_CS_SHIFT, tmc2590->standStillCurrentScale);
-	}
-	else
-	{
-		tmc2590->isStandStillCurrent = 0;
-		// Change to run current
-		TMC2590_FIELD_WRITE(tmc2590, TMC2590_SGCSCONF, TMC2590_CS_MASK, TMC2590_CS_SHIFT, tmc2590->runCurrentScale);
-	}
+	tmc2590->isStandStillCurrent = (tick - tmc2590->standStillTick > tmc2590->standStillTimeout) ? 1 : 0;
+
+	// Change to standstill or run current. SGCSCONF is only sent when the
+	// current scale differs from the shadow register.
+	currentScale = (tmc2590->isStandStillCurrent) ? tmc2590->standStillCurrentScale : tmc2590->runCurrentScale;
+	if(TMC2590_FIELD_READ(tmc2590, TMC2590_WRITE_BIT | TMC2590_SGCSCONF, TMC2590_CS_MASK, TMC2590_CS_SHIFT) != currentScale)
+		TMC2590_FIELD_WRITE(tmc2590, TMC2590_WRITE_BIT | TMC2590_SGCSCONF, TMC2590_CS_MASK, TMC2590_CS_SHIFT, currentScale);
 }
 
 static void continousSync(TMC2590TypeDef *tmc2590)
 { // refreshes settings to prevent chip from loosing settings on brownout
-	static uint8_t write  = 0;
-	static uint8_t read   = 0;
-	static uint8_t rdsel  = 0;
-
 	// rotational reading all replys to keep values up to date
-	uint32_t value, drvConf;
-
-	// additional reading to keep all replies up to date
-	value = drvConf = tmc2590_readInt(0, TMC2590_WRITE_BIT | TMC2590_DRVCONF);  // buffer value amd  drvConf to write back later
-	value &= ~TMC2590_SET_RDSEL(-1);                                        // clear RDSEL bits
-	value |= TMC2590_SET_RDSEL(rdsel % 3);                                  // clear set rdsel
-	readWrite(tmc2590, value);
-	readWrite(tmc2590, drvConf);
-
-	// determine next read address
-	read = (read + 1) % 3;
+	readImmediately(tmc2590, (tmc2590->rdsel + 1) % 3);
+}
 
-	// Write settings from shadow register to chip.
-	readWrite(tmc2590, tmc2590->config->shadowRegister[TMC2590_WRITE_BIT | write]);
+static void decodeReply(TMC2590TypeDef *tmc2590, uint32_t reply)
+{
+	TMC2590StatusTypeDef *status = &tmc2590->status;
 
-	// Determine next write address while skipping unused addresses
-	if (write == TMC2590_DRVCTRL)
-	{
-		// Skip over the unused addresses between DRVCTRL and CHOPCONF
-		write = TMC2590_CHOPCONF;
-	}
-	else
+	switch(tmc2590->rdsel)
 	{
-		// Increase the address
-		write = (write + 1) & TMC2590_REGISTER_COUNT;
+	case TMC2590_RESPONSE0:
+		status->microstep = TMC2590_GET_MSTEP(reply);
+		break;
+	case TMC2590_RESPONSE1:
+		status->stallGuard = TMC2590_GET_SG(reply);
+		break;
+	case TMC2590_RESPONSE2:
+		status->stallGuard   = TMC2590_GET_SGU(reply) << 5;
+		status->smartEnergy  = TMC2590_GET_SE(reply);
+		break;
+	default:
+		return;
 	}
+
+	status->flags = reply & 0xFF;
+	status->valid |= 1 << tmc2590->rdsel;
 }
 
 static void readWrite(TMC2590TypeDef *tmc2590, uint32_t value)
-{	// sending data (value) via spi to TMC262, coping written and received data to shadow register
-	static uint8_t rdsel = 0; // number of expected read response
-
+{	// sending data (value) via spi to TMC2590, coping written and received data to shadow register
+	uint8_t address = TMC2590_GET_ADDRESS(value);
 	uint8_t data[] = { BYTE(value, 2), BYTE(value, 1), BYTE(value, 0) };
+	uint32_t reply;
 
-	tmc2590_readWriteArray(tmc2590->config->channel, &data[0], 3);
+	// Every datagram is a write, the register is the datagram address
+	TMC_INSTRUMENT_CALL("TMC2590", tmc2590->config->channel, address, true, 3, value, 0, tmc2590_readWriteArray(tmc2590->config->channel, &data[0], 3));
 
-	tmc2590->config->shadowRegister[rdsel] = _8_32(data[0], data[1], data[2], 0) >> 12;
-	tmc2590->config->shadowRegister[TMC2590_RESPONSE_LATEST] = tmc2590->config->shadowRegister[rdsel];
+	reply = _8_32(data[0], data[1], data[2], 0) >> 12;
+	if(tmc2590->rdsel < TMC2590_RESPONSE_LATEST)
+		tmc2590->config->shadowRegister[tmc2590->rdsel] = reply;
+	tmc2590->config->shadowRegister[TMC2590_RESPONSE_LATEST] = reply;
+	decodeReply(tmc2590, reply);
 
 // set virtual read address for next reply given by RDSEL, can only change by setting RDSEL in DRVCONF
-	if(TMC2590_GET_ADDRESS(value) == TMC2590_DRVCONF)
-		rdsel = TMC2590_GET_RDSEL(value);
+	if(address == TMC2590_DRVCONF)
+		tmc2590->rdsel = TMC2590_GET_RDSEL(value);
 
 // write store written value to shadow register
-	tmc2590->config->shadowRegister[TMC2590_GET_ADDRESS(value)] = value;
+	tmc2590->config->shadowRegister[TMC2590_WRITE_BIT | address] = value;
+	tmc2590->dirtyRegisters &= ~(1 << address);
+}
+
+static void writeNext(TMC2590TypeDef *tmc2590)
+{ // sends a pending write if there is one, refreshes the next shadow register otherwise
+	uint8_t address, i;
+
+	for(i = 0; i < TMC2590_REGISTER_COUNT; i++)
+	{
+		if(tmc2590->dirtyRegisters & (1 << i))
+		{
+			readWrite(tmc2590, tmc2590->config->shadowRegister[TMC2590_WRITE_BIT | i]);
+			return;
+		}
+	}
+
+	address = tmc2590->syncWrite;
+	readWrite(tmc2590, tmc2590->config->shadowRegister[TMC2590_WRITE_BIT | address]);
+
+	// Determine next write address while skipping the unused addresses between DRVCTRL and CHOPCONF
+	tmc2590->syncWrite = (address == TMC2590_DRVCTRL) ? TMC2590_CHOPCONF : ((address + 1) % TMC2590_REGISTER_COUNT);
 }
 
 static void readImmediately(TMC2590TypeDef *tmc2590, uint8_t rdsel)
-{ // sets desired reply in DRVCONF register, resets it to previous settings whilst reading desired reply
-	uint32_t value, drvConf;
+{ // selects the desired reply in DRVCONF if needed, the reply arrives with the following datagram
+	uint32_t value;
 
-// additional reading to keep all replies up to date
+	if(rdsel != tmc2590->rdsel)
+	{
+		// The DRVCONF datagram switching RDSEL also carries a pending DRVCONF write.
+		// RDSEL is not restored afterwards, the following replies are decoded by its new value.
+		value = tmc2590->config->shadowRegister[TMC2590_WRITE_BIT | TMC2590_DRVCONF];
+		value &= ~TMC2590_SET_RDSEL(-1);    // clear RDSEL bits
+		value |= TMC2590_SET_RDSEL(rdsel);  // set rdsel
+		readWrite(tmc2590, value);
+	}
 
-	value = tmc2590_readInt(tmc2590, TMC2590_WRITE_BIT | TMC2590_DRVCONF);  // buffer value amd  drvConf to write back later
-	drvConf = value;
-	value &= ~TMC2590_SET_RDSEL(-1);                              // clear RDSEL bits
-	value |= TMC2590_SET_RDSEL(rdsel%3);                          // set rdsel
-	readWrite(tmc2590, value);                                    // write to chip and readout reply
-	readWrite(tmc2590, drvConf);
+	// Use the datagram carrying the reply for a pending write or a shadow register refresh
+	writeNext(tmc2590);
 }
 
 void tmc2590_writeInt(TMC2590TypeDef *tmc2590, uint8_t address, int32_t value)
 {
 	value = TMC2590_VALUE(value);
 	tmc2590->config->shadowRegister[TMC_ADDRESS(address) | TMC2590_WRITE_BIT] = value;
-	if(!tmc2590->continuousModeEnable)
+	if(tmc2590->continuousModeEnable)
+		tmc2590->dirtyRegisters |= 1 << (TMC_ADDRESS(address) & TMC2590_ADDRESS_MASK);
+	else
 		readWrite(tmc2590, value);
 }
 
 uint32_t tmc2590_readInt(TMC2590TypeDef *tmc2590, uint8_t address)
 {
 	if(!tmc2590->continuousModeEnable && !(address & TMC2590_WRITE_BIT))
-		readImmediately(tmc2590, address);
+		readImmediately(tmc2590, (address < TMC2590_RESPONSE_LATEST) ? address : tmc2590->rdsel);
 
 	return tmc2590->config->shadowRegister[TMC_ADDRESS(address)];
 }
@@ -136,6 +162,15 @@ void tmc2590_init(TMC2590TypeDef *tmc2590, uint8_t channel, ConfigurationTypeDef
 
 	tmc2590->continuousModeEnable      = 0;
 
+	tmc2590->rdsel                     = 0;  // RDSEL power on default
+	tmc2590->dirtyRegisters            = 0;
+	tmc2590->syncWrite                 = TMC2590_DRVCTRL;
+	tmc2590->status.microstep          = 0;
+	tmc2590->status.stallGuard         = 0;
+	tmc2590->status.smartEnergy        = 0;
+	tmc2590->status.flags              = 0;
+	tmc2590->status.valid              = 0;
+
 	tmc2590->coolStepActiveValue       = 0;
 	tmc2590->coolStepInactiveValue     = 0;
 	tmc2590->coolStepThreshold         = 0;
@@ -152,14 +187,34 @@ void tmc2590_init(TMC2590TypeDef *tmc2590, uint8_t channel, ConfigurationTypeDef
 	}
 }
 
-void tmc2590_periodicJob(TMC2590TypeDef *tmc2590, uint32_t tick)
+// Real-time part of the periodic job: standstill current reduction.
+// Worst case per call: 1 datagram when the current scale changes, none in continuous mode
+// (the write is sent by the next sync instead).
+void tmc2590_periodicJobFast(TMC2590TypeDef *tmc2590, uint32_t tick)
 {
 	standStillCurrentLimitation(tmc2590, tick);
+}
+
+// Background part of the periodic job: continuous mode sync.
+// Worst case per call: 2 datagrams (RDSEL switch and the write carrying the reply).
+TMCConfigStatus tmc2590_periodicJobBackground(TMC2590TypeDef *tmc2590, uint32_t tick)
+{
+	UNUSED(tick);
 
 	if(tmc2590->continuousModeEnable)
 	{ // continuously write settings to chip and rotate through all reply types to keep data up to date
 		continousSync(tmc2590);
 	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Call this periodically. Runs tmc2590_periodicJobFast() and tmc2590_periodicJobBackground().
+TMCConfigStatus tmc2590_periodicJob(TMC2590TypeDef *tmc2590, uint32_t tick)
+{
+	tmc2590_periodicJobFast(tmc2590, tick);
+
+	return tmc2590_periodicJobBackground(tmc2590, tick);
 }
 
 uint8_t tmc2590_reset(TMC2590TypeDef *tmc2590)
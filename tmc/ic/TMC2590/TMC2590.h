@@ -18,11 +18,29 @@
 	FIELD_GET(tmc2590_readInt(tdef, address), mask, shift)
 #define TMC2590_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc2590_writeInt(tdef, address, FIELD_SET(tmc2590_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC2590_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc2590_writeInt(tdef, address, FIELDS_SET(tmc2590_readInt(tdef, address), mask, values)))
+
+// Decoded replies. Every datagram returns the reply selected by the RDSEL
+// setting of the previous datagram, each reply updates its part of the cache.
+typedef struct {
+	uint16_t microstep;   // RDSEL 0: MSTEP
+	uint16_t stallGuard;  // RDSEL 1: SG, RDSEL 2: upper 5 bits of SG
+	uint8_t smartEnergy;  // RDSEL 2: SE
+	uint8_t flags;        // Status flags of the latest reply
+	uint8_t valid;        // Bit n set: a reply with RDSEL n has been received
+} TMC2590StatusTypeDef;
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
 	ConfigurationTypeDef *config;
 
+	TMC2590StatusTypeDef status;
+	uint8_t rdsel;           // RDSEL of the next reply
+	uint8_t dirtyRegisters;  // Continuous mode: written registers not sent yet, bit = address
+	uint8_t syncWrite;       // Next shadow register to refresh
+
 	uint8_t continuousModeEnable;
 
 	uint8_t coolStepInactiveValue;
@@ -64,7 +82,9 @@ static const int32_t tmc2590_defaultRegisterResetState[TMC2590_REGISTER_COUNT] =
 };
 
 void tmc2590_init(TMC2590TypeDef *tmc2590, uint8_t channel, ConfigurationTypeDef *tmc2590_config, const int32_t *registerResetState);
-void tmc2590_periodicJob(TMC2590TypeDef *tmc2590, uint32_t tick);
+TMCConfigStatus tmc2590_periodicJob(TMC2590TypeDef *tmc2590, uint32_t tick);
+void tmc2590_periodicJobFast(TMC2590TypeDef *tmc2590, uint32_t tick);
+TMCConfigStatus tmc2590_periodicJobBackground(TMC2590TypeDef *tmc2590, uint32_t tick);
 void tmc2590_writeInt(TMC2590TypeDef *tmc2590, uint8_t address, int32_t value);
 uint32_t tmc2590_readInt(TMC2590TypeDef *tmc2590, uint8_t address);
 uint8_t tmc2590_reset(TMC2590TypeDef *tmc2590);
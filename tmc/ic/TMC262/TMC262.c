@@ -8,128 +8,20 @@
 
 #include "TMC262.h"
 
-// Data structs for TMC262 Shadowregister
-typedef struct
-{
-	uint8_t Intpol;
-	uint8_t DEdge;
-	uint8_t MRes;
-} TStepDirConfig;
-
-typedef struct
-{
-	uint8_t BlankTime;
-	uint8_t ChopperMode;
-	uint8_t HysteresisDecay;
-	uint8_t RandomTOff;
-	uint8_t HysteresisEnd;
-	uint8_t HysteresisStart;
-	uint8_t TOff;
-	uint8_t DisableFlag;
-} TChopperConfig;
-
-typedef struct
-{
-	uint8_t SmartIMin;
-	uint8_t SmartDownStep;
-	uint8_t SmartStallLevelMax;
-	uint8_t SmartUpStep;
-	uint8_t SmartStallLevelMin;
-} TSmartEnergyControl;
-
-typedef struct
-{
-	uint8_t FilterEnable;
-	int8_t StallGuardThreshold;
-	uint8_t CurrentScale;
-} TStallGuardConfig;
-
-
-typedef struct
-{
-	uint8_t SlopeHighSide;
-	uint8_t SlopeLowSide;
-	uint8_t ProtectionDisable;
-	uint8_t ProtectionTimer;
-	uint8_t StepDirectionDisable;
-	uint8_t VSenseScale;
-	uint8_t ReadBackSelect;
-} TDriverConfig;
-
-typedef enum {
-	RB_CHOPPER,
-	RB_DRIVER,
-	RB_SMART_ENERGY,
-	RB_STALL_GUARD,
-	RB_STEP_DIR
-} TReadBackDatagram;
-
-// Variablen
-static TStepDirConfig StepDirConfig;            // Shadowregister of DRVCTRL-Register
-static TChopperConfig ChopperConfig;            // Shadowregister of CHOPCONF-Register
-static TSmartEnergyControl SmartEnergyControl;  // Shadowregister of SMARTEN-Register
-static TStallGuardConfig StallGuardConfig;      // Shadowregister of SGSCONF-Register
-static TDriverConfig DriverConfig;              // Shadowregister of DRVCONF-Register
-static TReadBackDatagram ReadBackDatagram;      // Next telegram to be used to read the state
-static uint32_t SPIReadInt;
-static uint32_t SPIWriteInt;
-
-static uint32_t SPIStepDirConf;
-static uint32_t SPIChopperConf;
-static uint32_t SPISmartConf;
-static uint32_t SPISGConf;
-static uint32_t SPIDriverConf;
-
-// Choose the configuration that suits your board // todo API 2: configuration should be chosen outside API e.g. in TMC-EvalSystem
-#define DEVTYPE_TMC428 // Direct SPI communication if TMC262 is connected to the processor
-//#define DEVTYPE_TMC43xx // Communication is forwarded to TMC262 by TMC43xx with "cover datagrams"
-
-#if defined(DEVTYPE_TMC428)
-	// => SPI wrapper
-	extern uint8_t tmc5130_spi_readWrite(uint8_t data, uint8_t lastTransfer);
-	// <= SPI wrapper
-#elif defined(DEVTYPE_TMC43xx)
-	#include "tmc/ic/TMC43xx/TMC4361A_Register.h"
-	// => Cover data wrapper
-	extern int32_t tmc43xx_readInt(uint8_t address);
-	extern int32_t tmc43xx_writeInt(uint8_t address, uint32_t data);
-	// <= Cover data wrapper
-#else
-#error "Device not supported!"
-#endif
-
 // Functions
 
 /*******************************************************************
 	 Function: ReadWrite262()
-	 Parameter: Read: Pointer to int for result
-	            Write: Array with 3 bytes to be written in TMC262
+	 Parameter: tmc262: TMC262 instance, SPIWriteInt holds the datagram
 
 	 Returns: ---
 
-	 Purpose: SPI-Communication with TMC262. The datagrams are shifted
-	          to the correct position.
+	 Purpose: Send one datagram with the transport of the instance and
+	          store the reply in SPIReadInt.
 ********************************************************************/
-static void ReadWrite262(uint32_t *ReadInt, uint32_t WriteInt)
+static void ReadWrite262(TMC262TypeDef *tmc262)
 {
-#if defined(DEVTYPE_TMC428)
-	*ReadInt = tmc5130_spi_readWrite(WriteInt>>16, FALSE);
-	*ReadInt <<= 8;
-	*ReadInt |= tmc5130_spi_readWrite(WriteInt>>8, FALSE);
-	*ReadInt <<= 8;
-	*ReadInt |= tmc5130_spi_readWrite(WriteInt & 0xFF, TRUE);
-	*ReadInt >>= 4;
-
-#elif defined(DEVTYPE_TMC43xx)
-	tmc43xx_writeInt(TMC4361A_EVENT_CLEAR_CONF, ~TMC4361A_COVER_DONE);
-	tmc43xx_readInt(TMC4361A_EVENTS);
-	tmc43xx_writeInt(TMC4361A_COVER_LOW_WR, WriteInt);
-	while(!(tmc43xx_readInt(TMC4361A_EVENTS) & TMC4361A_COVER_DONE)) {};
-	*ReadInt = tmc43xx_readInt(TMC4361A_COVER_DRV_LOW_RD);
-
-#else
-#error "Device not supported!"
-#endif
+	tmc262->SPIReadInt = tmc262->transport->readWrite(tmc262->transportContext, tmc262->SPIWriteInt);
 }
 
 
@@ -140,22 +32,21 @@ static void ReadWrite262(uint32_t *ReadInt, uint32_t WriteInt)
 	 Returns: ---
 
 	 Purpose: Write register DRVCTRL of TMC262 in Step/Dir Mode.
-	          The parameters must be pre-configured in the StepDirConfig
-	          global variables.
+	          The parameters must be pre-configured in tmc262->StepDirConfig.
 ********************************************************************/
-static void WriteStepDirConfig()
+static void WriteStepDirConfig(TMC262TypeDef *tmc262)
 {
-	SPIWriteInt = 0;
-	if(StepDirConfig.Intpol)
-		SPIWriteInt |= BIT9;
-	if(StepDirConfig.DEdge)
-		SPIWriteInt |= BIT8;
-	if(StepDirConfig.MRes > 15)
-		StepDirConfig.MRes = 15;
-	SPIWriteInt |= StepDirConfig.MRes;
+	tmc262->SPIWriteInt = 0;
+	if(tmc262->StepDirConfig.Intpol)
+		tmc262->SPIWriteInt |= BIT9;
+	if(tmc262->StepDirConfig.DEdge)
+		tmc262->SPIWriteInt |= BIT8;
+	if(tmc262->StepDirConfig.MRes > 15)
+		tmc262->StepDirConfig.MRes = 15;
+	tmc262->SPIWriteInt |= tmc262->StepDirConfig.MRes;
 
-	ReadWrite262(&SPIReadInt, SPIWriteInt);
-	SPIStepDirConf = SPIWriteInt;
+	tmc262->SPIStepDirConf = tmc262->SPIWriteInt;
+	ReadWrite262(tmc262);
 }
 
 
@@ -166,32 +57,31 @@ static void WriteStepDirConfig()
 	 Returns: ---
 
 	 Purpose: Write register CHOPCONF of TMC262 in Step/Dir Mode.
-	          The parameters must be pre-configured in the ChopperConfig
-	          global variables.
+	          The parameters must be pre-configured in tmc262->ChopperConfig.
 ********************************************************************/
-static void WriteChopperConfig()
+static void WriteChopperConfig(TMC262TypeDef *tmc262)
 {
-	ChopperConfig.BlankTime        = MIN(ChopperConfig.BlankTime, 3);
-	ChopperConfig.HysteresisDecay  = MIN(ChopperConfig.HysteresisDecay, 3);
-	ChopperConfig.HysteresisEnd    = MIN(ChopperConfig.HysteresisEnd, 15);
-	ChopperConfig.HysteresisStart  = MIN(ChopperConfig.HysteresisStart, 7);
-	ChopperConfig.TOff             = MIN(ChopperConfig.TOff, 15);
+	tmc262->ChopperConfig.BlankTime        = MIN(tmc262->ChopperConfig.BlankTime, 3);
+	tmc262->ChopperConfig.HysteresisDecay  = MIN(tmc262->ChopperConfig.HysteresisDecay, 3);
+	tmc262->ChopperConfig.HysteresisEnd    = MIN(tmc262->ChopperConfig.HysteresisEnd, 15);
+	tmc262->ChopperConfig.HysteresisStart  = MIN(tmc262->ChopperConfig.HysteresisStart, 7);
+	tmc262->ChopperConfig.TOff             = MIN(tmc262->ChopperConfig.TOff, 15);
 
-	SPIWriteInt = 0;
-	SPIWriteInt |= BIT19;  // Registeraddresse CHOPCONF;
-	SPIWriteInt |= ((uint32_t) ChopperConfig.BlankTime) << 15;
-	if(ChopperConfig.ChopperMode)
-		SPIWriteInt |= BIT14;
-	if(ChopperConfig.RandomTOff)
-		SPIWriteInt |= BIT13;
-	SPIWriteInt |= ((uint32_t) ChopperConfig.HysteresisDecay) << 11;
-	SPIWriteInt |= ((uint32_t) ChopperConfig.HysteresisEnd) << 7;
-	SPIWriteInt |= ((uint32_t) ChopperConfig.HysteresisStart) << 4;
-	if(!ChopperConfig.DisableFlag)
-		SPIWriteInt |= ((uint32_t) ChopperConfig.TOff);  // wenn DisableFlag gesetzt wird 0 gesendet
+	tmc262->SPIWriteInt = 0;
+	tmc262->SPIWriteInt |= BIT19;  // Registeraddresse CHOPCONF;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->ChopperConfig.BlankTime) << 15;
+	if(tmc262->ChopperConfig.ChopperMode)
+		tmc262->SPIWriteInt |= BIT14;
+	if(tmc262->ChopperConfig.RandomTOff)
+		tmc262->SPIWriteInt |= BIT13;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->ChopperConfig.HysteresisDecay) << 11;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->ChopperConfig.HysteresisEnd) << 7;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->ChopperConfig.HysteresisStart) << 4;
+	if(!tmc262->ChopperConfig.DisableFlag)
+		tmc262->SPIWriteInt |= ((uint32_t) tmc262->ChopperConfig.TOff);  // wenn DisableFlag gesetzt wird 0 gesendet
 
-	ReadWrite262(&SPIReadInt, SPIWriteInt);
-	SPIChopperConf = SPIWriteInt;
+	tmc262->SPIChopperConf = tmc262->SPIWriteInt;
+	ReadWrite262(tmc262);
 }
 
 
@@ -202,27 +92,27 @@ static void WriteChopperConfig()
 	 Returns: ---
 
 	 Purpose: Write register SMARTEN of TMC262 in Step/Dir Mode.
-	          The parameters must be pre-configured in the
-	          SmartEnergyControl global variables.
+	          The parameters must be pre-configured in
+	          tmc262->SmartEnergyControl.
 ********************************************************************/
-static void WriteSmartEnergyControl()
+static void WriteSmartEnergyControl(TMC262TypeDef *tmc262)
 {
-	SmartEnergyControl.SmartIMin           = MIN(SmartEnergyControl.SmartIMin, 1);
-	SmartEnergyControl.SmartDownStep       = MIN(SmartEnergyControl.SmartDownStep, 3);
-	SmartEnergyControl.SmartStallLevelMax  = MIN(SmartEnergyControl.SmartStallLevelMax, 15);
-	SmartEnergyControl.SmartUpStep         = MIN(SmartEnergyControl.SmartUpStep, 3);
-	SmartEnergyControl.SmartStallLevelMin  = MIN(SmartEnergyControl.SmartStallLevelMin, 15);
+	tmc262->SmartEnergyControl.SmartIMin           = MIN(tmc262->SmartEnergyControl.SmartIMin, 1);
+	tmc262->SmartEnergyControl.SmartDownStep       = MIN(tmc262->SmartEnergyControl.SmartDownStep, 3);
+	tmc262->SmartEnergyControl.SmartStallLevelMax  = MIN(tmc262->SmartEnergyControl.SmartStallLevelMax, 15);
+	tmc262->SmartEnergyControl.SmartUpStep         = MIN(tmc262->SmartEnergyControl.SmartUpStep, 3);
+	tmc262->SmartEnergyControl.SmartStallLevelMin  = MIN(tmc262->SmartEnergyControl.SmartStallLevelMin, 15);
 
-	SPIWriteInt =  0;
-	SPIWriteInt |= BIT19 | BIT17;  // Register address SMARTEN
-	SPIWriteInt |= ((uint32_t) SmartEnergyControl.SmartIMin) << 15;
-	SPIWriteInt |= ((uint32_t) SmartEnergyControl.SmartDownStep)  << 13;
-	SPIWriteInt |= ((uint32_t) SmartEnergyControl.SmartStallLevelMax) << 8;
-	SPIWriteInt |= ((uint32_t) SmartEnergyControl.SmartUpStep) << 5;
-	SPIWriteInt |= ((uint32_t) SmartEnergyControl.SmartStallLevelMin);
+	tmc262->SPIWriteInt =  0;
+	tmc262->SPIWriteInt |= BIT19 | BIT17;  // Register address SMARTEN
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->SmartEnergyControl.SmartIMin) << 15;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->SmartEnergyControl.SmartDownStep)  << 13;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->SmartEnergyControl.SmartStallLevelMax) << 8;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->SmartEnergyControl.SmartUpStep) << 5;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->SmartEnergyControl.SmartStallLevelMin);
 
-	ReadWrite262(&SPIReadInt, SPIWriteInt);
-	SPISmartConf = SPIWriteInt;
+	tmc262->SPISmartConf = tmc262->SPIWriteInt;
+	ReadWrite262(tmc262);
 }
 
 
@@ -233,24 +123,24 @@ static void WriteSmartEnergyControl()
 	 Returns: ---
 
 	 Purpose: Write register SGCSCONF of TMC262 in Step/Dir Mode.
-	          The parameters must be pre-configured in the
-	          StallGuardConfig global variables.
+	          The parameters must be pre-configured in
+	          tmc262->StallGuardConfig.
 ********************************************************************/
-static void WriteStallGuardConfig()
+static void WriteStallGuardConfig(TMC262TypeDef *tmc262)
 {
-	if(abs(StallGuardConfig.StallGuardThreshold) > 63)
-		StallGuardConfig.StallGuardThreshold = (StallGuardConfig.StallGuardThreshold > 0)? 63:-63;
-	StallGuardConfig.CurrentScale = MIN(StallGuardConfig.CurrentScale, 31);
+	if(abs(tmc262->StallGuardConfig.StallGuardThreshold) > 63)
+		tmc262->StallGuardConfig.StallGuardThreshold = (tmc262->StallGuardConfig.StallGuardThreshold > 0)? 63:-63;
+	tmc262->StallGuardConfig.CurrentScale = MIN(tmc262->StallGuardConfig.CurrentScale, 31);
 
-	SPIWriteInt = 0;
-	SPIWriteInt |= BIT19 | BIT18;  // Register address SGSCONF
-	if(StallGuardConfig.FilterEnable == 1)
-		SPIWriteInt |= BIT16;
-	SPIWriteInt |= ((uint32_t) StallGuardConfig.StallGuardThreshold & 0x7F) << 8;
-	SPIWriteInt |= ((uint32_t) StallGuardConfig.CurrentScale);
+	tmc262->SPIWriteInt = 0;
+	tmc262->SPIWriteInt |= BIT19 | BIT18;  // Register address SGSCONF
+	if(tmc262->StallGuardConfig.FilterEnable == 1)
+		tmc262->SPIWriteInt |= BIT16;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->StallGuardConfig.StallGuardThreshold & 0x7F) << 8;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->StallGuardConfig.CurrentScale);
 
-	ReadWrite262(&SPIReadInt, SPIWriteInt);
-	SPISGConf = SPIWriteInt;
+	tmc262->SPISGConf = tmc262->SPIWriteInt;
+	ReadWrite262(tmc262);
 }
 
 
@@ -261,369 +151,439 @@ static void WriteStallGuardConfig()
 	 Returns: ---
 
 	 Purpose: Write register DRVCONF of TMC262 in Step/Dir Mode.
-	          The parameters must be pre-configured in the DriverConfig
-	          global variables.
+	          The parameters must be pre-configured in tmc262->DriverConfig.
+********************************************************************/
+static void WriteDriverConfig(TMC262TypeDef *tmc262)
+{
+	tmc262->SPIWriteInt = 0;
+	tmc262->SPIWriteInt |= BIT19 | BIT18 | BIT17;  // Register address DRVCONF
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->DriverConfig.SlopeHighSide) << 14;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->DriverConfig.SlopeLowSide) << 12;
+	if(tmc262->DriverConfig.ProtectionDisable == 1)
+		tmc262->SPIWriteInt |= BIT10;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->DriverConfig.ProtectionTimer) << 8;
+	if(tmc262->DriverConfig.StepDirectionDisable == 1)
+		tmc262->SPIWriteInt |= BIT7;
+	if(tmc262->DriverConfig.VSenseScale == 1)
+		tmc262->SPIWriteInt |= BIT6;
+	tmc262->SPIWriteInt |= ((uint32_t) tmc262->DriverConfig.ReadBackSelect) << 4;
+
+	tmc262->SPIDriverConf = tmc262->SPIWriteInt;
+	ReadWrite262(tmc262);
+}
+
+// Write functions of the datagrams, indexed by TMC262Datagram
+static void (* const WriteDatagram[])(TMC262TypeDef *tmc262) =
+{
+	[TMC262_DATAGRAM_CHOPPER]       = WriteChopperConfig,
+	[TMC262_DATAGRAM_DRIVER]        = WriteDriverConfig,
+	[TMC262_DATAGRAM_SMART_ENERGY]  = WriteSmartEnergyControl,
+	[TMC262_DATAGRAM_STALL_GUARD]   = WriteStallGuardConfig,
+	[TMC262_DATAGRAM_STEP_DIR]      = WriteStepDirConfig
+};
+
+/*******************************************************************
+	 Function: CommitConfig()
+	 Parameter: tmc262: TMC262 instance
+	            Datagram: Datagram holding the changed setting
+
+	 Returns: ---
+
+	 Purpose: Send a changed datagram. Between tmc262_beginUpdate() and
+	          tmc262_commit() the datagram is only marked for sending.
 ********************************************************************/
-static void WriteDriverConfig()
+static void CommitConfig(TMC262TypeDef *tmc262, TMC262Datagram Datagram)
 {
-	SPIWriteInt = 0;
-	SPIWriteInt |= BIT19 | BIT18 | BIT17;  // Register address DRVCONF
-	SPIWriteInt |= ((uint32_t) DriverConfig.SlopeHighSide) << 14;
-	SPIWriteInt |= ((uint32_t) DriverConfig.SlopeLowSide) << 12;
-	if(DriverConfig.ProtectionDisable == 1)
-		SPIWriteInt |= BIT10;
-	SPIWriteInt |= ((uint32_t) DriverConfig.ProtectionTimer) << 8;
-	if(DriverConfig.StepDirectionDisable == 1)
-		SPIWriteInt |= BIT7;
-	if(DriverConfig.VSenseScale == 1)
-		SPIWriteInt |= BIT6;
-	SPIWriteInt |= ((uint32_t) DriverConfig.ReadBackSelect) << 4;
+	if(tmc262->Deferred)
+		tmc262->Pending |= 1 << Datagram;
+	else
+		WriteDatagram[Datagram](tmc262);
+}
 
-	ReadWrite262(&SPIReadInt, SPIWriteInt);
-	SPIDriverConf = SPIWriteInt;
+
+/*******************************************************************
+	 Function: tmc262_beginUpdate()
+	 Parameter: tmc262: TMC262 instance
+
+	 Returns: ---
+
+	 Purpose: Start a deferred update. The following setter calls only
+	          change the settings, tmc262_commit() then sends every
+	          changed datagram once.
+********************************************************************/
+void tmc262_beginUpdate(TMC262TypeDef *tmc262)
+{
+	tmc262->Deferred = TRUE;
 }
 
+
+/*******************************************************************
+	 Function: tmc262_commit()
+	 Parameter: tmc262: TMC262 instance
+
+	 Returns: ---
+
+	 Purpose: End a deferred update and send the changed datagrams.
+********************************************************************/
+void tmc262_commit(TMC262TypeDef *tmc262)
+{
+	uint8_t Pending = tmc262->Pending;
+
+	tmc262->Deferred  = FALSE;
+	tmc262->Pending   = 0;
+
+	for(uint8_t i = 0; i < ARRAY_SIZE(WriteDatagram); i++)
+	{
+		if(Pending & (1 << i))
+			WriteDatagram[i](tmc262);
+	}
+}
+
+
 /*******************************************************************
 	 Function: tmc262_initMotorDrivers()
-	 Parameter: ---
+	 Parameter: tmc262: TMC262 instance
+	            transport: Datagram transport of this TMC262
+	            transportContext: Passed to the transport functions
 
 	 Returns: ---
 
 	 Purpose: Initialization of TMC262 and its variables
 ********************************************************************/
-void tmc262_initMotorDrivers(void)
+void tmc262_initMotorDrivers(TMC262TypeDef *tmc262, const TMC262TransportTypeDef *transport, void *transportContext)
 {
+	tmc262->transport         = transport;
+	tmc262->transportContext  = transportContext;
+	tmc262->ReadBackDatagram  = TMC262_DATAGRAM_CHOPPER;
+	tmc262->Deferred          = FALSE;
+	tmc262->Pending           = 0;
+
 	// Initialize data structs
 	// Parameter "non cool"
-	StallGuardConfig.FilterEnable         = 1;
-	StallGuardConfig.StallGuardThreshold  = 5;
-#if defined(DEVTYPE_TMC43xx)
-	StallGuardConfig.CurrentScale         = 31;
-#else
-	StallGuardConfig.CurrentScale         = 5; //16;
-#endif
-
-	DriverConfig.SlopeHighSide         = 3;
-	DriverConfig.SlopeLowSide          = 3;
-	DriverConfig.ProtectionDisable     = 0;
-	DriverConfig.ProtectionTimer       = 0;
-#if defined(DEVTYPE_TMC43xx)
-	DriverConfig.StepDirectionDisable  = 1;
-#else
-	DriverConfig.StepDirectionDisable  = 0;
-#endif
-
-	DriverConfig.VSenseScale     = 1;
-	DriverConfig.ReadBackSelect  = TMC262_RB_SMART_ENERGY;
-
-	SmartEnergyControl.SmartIMin           = 0;
-	SmartEnergyControl.SmartDownStep       = 0;
-	SmartEnergyControl.SmartStallLevelMax  = 0;
-	SmartEnergyControl.SmartUpStep         = 0;
-	SmartEnergyControl.SmartStallLevelMin  = 0;
-
-	StepDirConfig.Intpol  = 0;
-	StepDirConfig.DEdge   = 0;
-	StepDirConfig.MRes    = 0;
-
-	ChopperConfig.BlankTime        = 2;
-	ChopperConfig.ChopperMode      = 0;
-	ChopperConfig.RandomTOff       = 0;
-	ChopperConfig.HysteresisDecay  = 0;
-	ChopperConfig.HysteresisEnd    = 2;
-	ChopperConfig.HysteresisStart  = 3;
-	ChopperConfig.TOff             = 5;
-	ChopperConfig.DisableFlag      = FALSE;
+	tmc262->StallGuardConfig.FilterEnable         = 1;
+	tmc262->StallGuardConfig.StallGuardThreshold  = 5;
+	if(transport->coverDatagrams)
+		tmc262->StallGuardConfig.CurrentScale       = 31;
+	else
+		tmc262->StallGuardConfig.CurrentScale       = 5; //16;
+
+	tmc262->DriverConfig.SlopeHighSide         = 3;
+	tmc262->DriverConfig.SlopeLowSide          = 3;
+	tmc262->DriverConfig.ProtectionDisable     = 0;
+	tmc262->DriverConfig.ProtectionTimer       = 0;
+	tmc262->DriverConfig.StepDirectionDisable  = (transport->coverDatagrams) ? 1 : 0;
+
+	tmc262->DriverConfig.VSenseScale     = 1;
+	tmc262->DriverConfig.ReadBackSelect  = TMC262_RB_SMART_ENERGY;
+
+	tmc262->SmartEnergyControl.SmartIMin           = 0;
+	tmc262->SmartEnergyControl.SmartDownStep       = 0;
+	tmc262->SmartEnergyControl.SmartStallLevelMax  = 0;
+	tmc262->SmartEnergyControl.SmartUpStep         = 0;
+	tmc262->SmartEnergyControl.SmartStallLevelMin  = 0;
+
+	tmc262->StepDirConfig.Intpol  = 0;
+	tmc262->StepDirConfig.DEdge   = 0;
+	tmc262->StepDirConfig.MRes    = 0;
+
+	tmc262->ChopperConfig.BlankTime        = 2;
+	tmc262->ChopperConfig.ChopperMode      = 0;
+	tmc262->ChopperConfig.RandomTOff       = 0;
+	tmc262->ChopperConfig.HysteresisDecay  = 0;
+	tmc262->ChopperConfig.HysteresisEnd    = 2;
+	tmc262->ChopperConfig.HysteresisStart  = 3;
+	tmc262->ChopperConfig.TOff             = 5;
+	tmc262->ChopperConfig.DisableFlag      = FALSE;
 
 	// Send initial values to TMC262
-	WriteSmartEnergyControl();
-	WriteStallGuardConfig();
-	WriteDriverConfig();
-	WriteStepDirConfig();
-	WriteChopperConfig();
+	WriteSmartEnergyControl(tmc262);
+	WriteStallGuardConfig(tmc262);
+	WriteDriverConfig(tmc262);
+	WriteStepDirConfig(tmc262);
+	WriteChopperConfig(tmc262);
 }
 
-void tmc262_setStepDirMStepRes(uint8_t MicrostepResolution)
+void tmc262_setStepDirMStepRes(TMC262TypeDef *tmc262, uint8_t MicrostepResolution)
 {
-	StepDirConfig.MRes = MicrostepResolution;
+	tmc262->StepDirConfig.MRes = MicrostepResolution;
 	if(MicrostepResolution != 4)
-		StepDirConfig.Intpol = 0;
-	WriteStepDirConfig();
+		tmc262->StepDirConfig.Intpol = 0;
+	CommitConfig(tmc262, TMC262_DATAGRAM_STEP_DIR);
 }
 
-void tmc262_setStepDirInterpolation(uint8_t Interpolation)
+void tmc262_setStepDirInterpolation(TMC262TypeDef *tmc262, uint8_t Interpolation)
 {
-	StepDirConfig.Intpol = Interpolation;
+	tmc262->StepDirConfig.Intpol = Interpolation;
 	if(Interpolation)
-		StepDirConfig.MRes = 4;
-	WriteStepDirConfig();
+		tmc262->StepDirConfig.MRes = 4;
+	CommitConfig(tmc262, TMC262_DATAGRAM_STEP_DIR);
 }
 
-void tmc262_setStepDirDoubleEdge(uint8_t DoubleEdge)
+void tmc262_setStepDirDoubleEdge(TMC262TypeDef *tmc262, uint8_t DoubleEdge)
 {
-	StepDirConfig.DEdge = DoubleEdge;
-	WriteStepDirConfig();
+	tmc262->StepDirConfig.DEdge = DoubleEdge;
+	CommitConfig(tmc262, TMC262_DATAGRAM_STEP_DIR);
 }
 
-uint8_t tmc262_getStepDirMStepRes()
+uint8_t tmc262_getStepDirMStepRes(TMC262TypeDef *tmc262)
 {
-	return StepDirConfig.MRes;
+	return tmc262->StepDirConfig.MRes;
 }
 
-uint8_t tmc262_getStepDirInterpolation()
+uint8_t tmc262_getStepDirInterpolation(TMC262TypeDef *tmc262)
 {
-	return StepDirConfig.Intpol;
+	return tmc262->StepDirConfig.Intpol;
 }
 
-uint8_t tmc262_getStepDirDoubleEdge()
+uint8_t tmc262_getStepDirDoubleEdge(TMC262TypeDef *tmc262)
 {
-	return StepDirConfig.DEdge;
+	return tmc262->StepDirConfig.DEdge;
 }
 
 
-void tmc262_setChopperBlankTime(uint8_t BlankTime)
+void tmc262_setChopperBlankTime(TMC262TypeDef *tmc262, uint8_t BlankTime)
 {
-	ChopperConfig.BlankTime = BlankTime;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.BlankTime = BlankTime;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-void tmc262_setChopperMode(uint8_t Mode)
+void tmc262_setChopperMode(TMC262TypeDef *tmc262, uint8_t Mode)
 {
-	ChopperConfig.ChopperMode = Mode;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.ChopperMode = Mode;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-void tmc262_setChopperRandomTOff(uint8_t RandomTOff)
+void tmc262_setChopperRandomTOff(TMC262TypeDef *tmc262, uint8_t RandomTOff)
 {
-	ChopperConfig.RandomTOff = RandomTOff;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.RandomTOff = RandomTOff;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-void tmc262_setChopperHysteresisDecay(uint8_t HysteresisDecay)
+void tmc262_setChopperHysteresisDecay(TMC262TypeDef *tmc262, uint8_t HysteresisDecay)
 {
-	ChopperConfig.HysteresisDecay = HysteresisDecay;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.HysteresisDecay = HysteresisDecay;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-void tmc262_setChopperHysteresisEnd(uint8_t HysteresisEnd)
+void tmc262_setChopperHysteresisEnd(TMC262TypeDef *tmc262, uint8_t HysteresisEnd)
 {
-	ChopperConfig.HysteresisEnd = HysteresisEnd;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.HysteresisEnd = HysteresisEnd;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-void tmc262_setChopperHysteresisStart(uint8_t HysteresisStart)
+void tmc262_setChopperHysteresisStart(TMC262TypeDef *tmc262, uint8_t HysteresisStart)
 {
-	ChopperConfig.HysteresisStart = HysteresisStart;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.HysteresisStart = HysteresisStart;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-void tmc262_setChopperTOff(uint8_t TOff)
+void tmc262_setChopperTOff(TMC262TypeDef *tmc262, uint8_t TOff)
 {
-	ChopperConfig.TOff = TOff;
-	WriteChopperConfig();
+	tmc262->ChopperConfig.TOff = TOff;
+	CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 }
 
-uint8_t tmc262_getChopperBlankTime()
+uint8_t tmc262_getChopperBlankTime(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.BlankTime;
+	return tmc262->ChopperConfig.BlankTime;
 }
 
-uint8_t tmc262_getChopperMode()
+uint8_t tmc262_getChopperMode(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.ChopperMode;
+	return tmc262->ChopperConfig.ChopperMode;
 }
 
-uint8_t tmc262_getChopperRandomTOff()
+uint8_t tmc262_getChopperRandomTOff(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.RandomTOff;
+	return tmc262->ChopperConfig.RandomTOff;
 }
 
-uint8_t tmc262_getChopperHysteresisDecay()
+uint8_t tmc262_getChopperHysteresisDecay(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.HysteresisDecay;
+	return tmc262->ChopperConfig.HysteresisDecay;
 }
 
-uint8_t tmc262_getChopperHysteresisEnd()
+uint8_t tmc262_getChopperHysteresisEnd(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.HysteresisEnd;
+	return tmc262->ChopperConfig.HysteresisEnd;
 }
 
-uint8_t tmc262_getChopperHysteresisStart()
+uint8_t tmc262_getChopperHysteresisStart(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.HysteresisStart;
+	return tmc262->ChopperConfig.HysteresisStart;
 }
 
-uint8_t tmc262_getChopperTOff()
+uint8_t tmc262_getChopperTOff(TMC262TypeDef *tmc262)
 {
-	return ChopperConfig.TOff;
+	return tmc262->ChopperConfig.TOff;
 }
 
 
-void tmc262_setSmartEnergyIMin(uint8_t SmartIMin)
+void tmc262_setSmartEnergyIMin(TMC262TypeDef *tmc262, uint8_t SmartIMin)
 {
-	SmartEnergyControl.SmartIMin = SmartIMin;
-	WriteSmartEnergyControl();
+	tmc262->SmartEnergyControl.SmartIMin = SmartIMin;
+	CommitConfig(tmc262, TMC262_DATAGRAM_SMART_ENERGY);
 }
 
-void tmc262_setSmartEnergyDownStep(uint8_t SmartDownStep)
+void tmc262_setSmartEnergyDownStep(TMC262TypeDef *tmc262, uint8_t SmartDownStep)
 {
-	SmartEnergyControl.SmartDownStep = SmartDownStep;
-	WriteSmartEnergyControl();
+	tmc262->SmartEnergyControl.SmartDownStep = SmartDownStep;
+	CommitConfig(tmc262, TMC262_DATAGRAM_SMART_ENERGY);
 }
 
-void tmc262_setSmartEnergyStallLevelMax(uint8_t StallLevelMax)
+void tmc262_setSmartEnergyStallLevelMax(TMC262TypeDef *tmc262, uint8_t StallLevelMax)
 {
-	SmartEnergyControl.SmartStallLevelMax = StallLevelMax;
-	WriteSmartEnergyControl();
+	tmc262->SmartEnergyControl.SmartStallLevelMax = StallLevelMax;
+	CommitConfig(tmc262, TMC262_DATAGRAM_SMART_ENERGY);
 }
 
-void tmc262_setSmartEnergyUpStep(uint8_t SmartUpStep)
+void tmc262_setSmartEnergyUpStep(TMC262TypeDef *tmc262, uint8_t SmartUpStep)
 {
-	SmartEnergyControl.SmartUpStep = SmartUpStep;
-	WriteSmartEnergyControl();
+	tmc262->SmartEnergyControl.SmartUpStep = SmartUpStep;
+	CommitConfig(tmc262, TMC262_DATAGRAM_SMART_ENERGY);
 }
 
-void tmc262_setSmartEnergyStallLevelMin(uint8_t StallLevelMin)
+void tmc262_setSmartEnergyStallLevelMin(TMC262TypeDef *tmc262, uint8_t StallLevelMin)
 {
-	SmartEnergyControl.SmartStallLevelMin = StallLevelMin;
-	WriteSmartEnergyControl();
+	tmc262->SmartEnergyControl.SmartStallLevelMin = StallLevelMin;
+	CommitConfig(tmc262, TMC262_DATAGRAM_SMART_ENERGY);
 }
 
-uint8_t tmc262_getSmartEnergyIMin()
+uint8_t tmc262_getSmartEnergyIMin(TMC262TypeDef *tmc262)
 {
-	return SmartEnergyControl.SmartIMin;
+	return tmc262->SmartEnergyControl.SmartIMin;
 }
 
-uint8_t tmc262_getSmartEnergyDownStep()
+uint8_t tmc262_getSmartEnergyDownStep(TMC262TypeDef *tmc262)
 {
-	return SmartEnergyControl.SmartDownStep;
+	return tmc262->SmartEnergyControl.SmartDownStep;
 }
 
-uint8_t tmc262_getSmartEnergyStallLevelMax()
+uint8_t tmc262_getSmartEnergyStallLevelMax(TMC262TypeDef *tmc262)
 {
-	return SmartEnergyControl.SmartStallLevelMax;
+	return tmc262->SmartEnergyControl.SmartStallLevelMax;
 }
 
-uint8_t tmc262_getSmartEnergyUpStep()
+uint8_t tmc262_getSmartEnergyUpStep(TMC262TypeDef *tmc262)
 {
-	return SmartEnergyControl.SmartUpStep;
+	return tmc262->SmartEnergyControl.SmartUpStep;
 }
 
-uint8_t tmc262_getSmartEnergyStallLevelMin()
+uint8_t tmc262_getSmartEnergyStallLevelMin(TMC262TypeDef *tmc262)
 {
-	return SmartEnergyControl.SmartStallLevelMin;
+	return tmc262->SmartEnergyControl.SmartStallLevelMin;
 }
 
 
-void tmc262_setStallGuardFilter(uint8_t Enable)
+void tmc262_setStallGuardFilter(TMC262TypeDef *tmc262, uint8_t Enable)
 {
-	StallGuardConfig.FilterEnable = Enable;
-	WriteStallGuardConfig();
+	tmc262->StallGuardConfig.FilterEnable = Enable;
+	CommitConfig(tmc262, TMC262_DATAGRAM_STALL_GUARD);
 }
 
-void tmc262_setStallGuardThreshold(int8_t Threshold)
+void tmc262_setStallGuardThreshold(TMC262TypeDef *tmc262, int8_t Threshold)
 {
-	StallGuardConfig.StallGuardThreshold = Threshold;
-	WriteStallGuardConfig();
+	tmc262->StallGuardConfig.StallGuardThreshold = Threshold;
+	CommitConfig(tmc262, TMC262_DATAGRAM_STALL_GUARD);
 }
 
-void tmc262_setStallGuardCurrentScale(uint8_t CurrentScale)
+void tmc262_setStallGuardCurrentScale(TMC262TypeDef *tmc262, uint8_t CurrentScale)
 {
-	StallGuardConfig.CurrentScale = CurrentScale;
-	WriteStallGuardConfig();
+	tmc262->StallGuardConfig.CurrentScale = CurrentScale;
+	CommitConfig(tmc262, TMC262_DATAGRAM_STALL_GUARD);
 }
 
-uint8_t tmc262_getStallGuardFilter()
+uint8_t tmc262_getStallGuardFilter(TMC262TypeDef *tmc262)
 {
-	return StallGuardConfig.FilterEnable;
+	return tmc262->StallGuardConfig.FilterEnable;
 }
 
-int8_t tmc262_getStallGuardThreshold()
+int8_t tmc262_getStallGuardThreshold(TMC262TypeDef *tmc262)
 {
-	return StallGuardConfig.StallGuardThreshold;
+	return tmc262->StallGuardConfig.StallGuardThreshold;
 }
 
-uint8_t tmc262_getStallGuardCurrentScale()
+uint8_t tmc262_getStallGuardCurrentScale(TMC262TypeDef *tmc262)
 {
-	return StallGuardConfig.CurrentScale;
+	return tmc262->StallGuardConfig.CurrentScale;
 }
 
 
-void tmc262_setDriverSlopeHighSide(uint8_t SlopeHighSide)
+void tmc262_setDriverSlopeHighSide(TMC262TypeDef *tmc262, uint8_t SlopeHighSide)
 {
-	DriverConfig.SlopeHighSide = SlopeHighSide;
-	WriteDriverConfig();
+	tmc262->DriverConfig.SlopeHighSide = SlopeHighSide;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-void tmc262_setDriverSlopeLowSide(uint8_t SlopeLowSide)
+void tmc262_setDriverSlopeLowSide(TMC262TypeDef *tmc262, uint8_t SlopeLowSide)
 {
-	DriverConfig.SlopeLowSide = SlopeLowSide;
-	WriteDriverConfig();
+	tmc262->DriverConfig.SlopeLowSide = SlopeLowSide;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-void tmc262_setDriverDisableProtection(uint8_t DisableProtection)
+void tmc262_setDriverDisableProtection(TMC262TypeDef *tmc262, uint8_t DisableProtection)
 {
-	DriverConfig.ProtectionDisable = DisableProtection;
-	WriteDriverConfig();
+	tmc262->DriverConfig.ProtectionDisable = DisableProtection;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-void tmc262_setDriverProtectionTimer(uint8_t ProtectionTimer)
+void tmc262_setDriverProtectionTimer(TMC262TypeDef *tmc262, uint8_t ProtectionTimer)
 {
-	DriverConfig.ProtectionTimer = ProtectionTimer;
-	WriteDriverConfig();
+	tmc262->DriverConfig.ProtectionTimer = ProtectionTimer;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-void tmc262_setDriverStepDirectionOff(uint8_t SDOff)
+void tmc262_setDriverStepDirectionOff(TMC262TypeDef *tmc262, uint8_t SDOff)
 {
-	DriverConfig.StepDirectionDisable = SDOff;
-	WriteDriverConfig();
+	tmc262->DriverConfig.StepDirectionDisable = SDOff;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-void tmc262_setDriverVSenseScale(uint8_t Scale)
+void tmc262_setDriverVSenseScale(TMC262TypeDef *tmc262, uint8_t Scale)
 {
-	DriverConfig.VSenseScale = Scale;
-	WriteDriverConfig();
+	tmc262->DriverConfig.VSenseScale = Scale;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-void tmc262_setDriverReadSelect(uint8_t ReadSelect)
+void tmc262_setDriverReadSelect(TMC262TypeDef *tmc262, uint8_t ReadSelect)
 {
-	DriverConfig.ReadBackSelect = ReadSelect;
-	WriteDriverConfig();
+	tmc262->DriverConfig.ReadBackSelect = ReadSelect;
+	CommitConfig(tmc262, TMC262_DATAGRAM_DRIVER);
 }
 
-uint8_t tmc262_getDriverSlopeHighSide()
+uint8_t tmc262_getDriverSlopeHighSide(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.SlopeHighSide;
+	return tmc262->DriverConfig.SlopeHighSide;
 }
 
-uint8_t tmc262_getDriverSlopeLowSide()
+uint8_t tmc262_getDriverSlopeLowSide(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.SlopeLowSide;
+	return tmc262->DriverConfig.SlopeLowSide;
 }
 
-uint8_t tmc262_getDriverDisableProtection()
+uint8_t tmc262_getDriverDisableProtection(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.ProtectionDisable;
+	return tmc262->DriverConfig.ProtectionDisable;
 }
 
-uint8_t tmc262_getDriverProtectionTimer()
+uint8_t tmc262_getDriverProtectionTimer(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.ProtectionTimer;
+	return tmc262->DriverConfig.ProtectionTimer;
 }
 
-uint8_t tmc262_getDriverStepDirectionOff()
+uint8_t tmc262_getDriverStepDirectionOff(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.StepDirectionDisable;
+	return tmc262->DriverConfig.StepDirectionDisable;
 }
 
-uint8_t tmc262_getDriverVSenseScale()
+uint8_t tmc262_getDriverVSenseScale(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.VSenseScale;
+	return tmc262->DriverConfig.VSenseScale;
 }
 
-uint8_t tmc262_getDriverReadSelect()
+uint8_t tmc262_getDriverReadSelect(TMC262TypeDef *tmc262)
 {
-	return DriverConfig.ReadBackSelect;
+	return tmc262->DriverConfig.ReadBackSelect;
 }
 
 
@@ -641,70 +601,69 @@ uint8_t tmc262_getDriverReadSelect()
 	          values are extracted accordingly from the SPI telegram.
 	          NULL can be used for values that are not required.
 ********************************************************************/
-void tmc262_readState(uint8_t *Phases, uint8_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags)
+void tmc262_readState(TMC262TypeDef *tmc262, uint8_t *Phases, uint8_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags)
 {
 	// Alternately use all datagram types of the TMC26x to read out the states.
 	// This ensures that all registers are always written with the correct values
 	// (if there should be a TMC26x reset between them).
-	switch(ReadBackDatagram)
+	switch(tmc262->ReadBackDatagram)
 	{
-	case RB_CHOPPER:
-		WriteChopperConfig();
-		ReadBackDatagram = RB_DRIVER;
+	case TMC262_DATAGRAM_CHOPPER:
+		WriteChopperConfig(tmc262);
+		tmc262->ReadBackDatagram = TMC262_DATAGRAM_DRIVER;
 		break;
-	case RB_DRIVER:
-		WriteDriverConfig();
-		ReadBackDatagram = RB_SMART_ENERGY;
+	case TMC262_DATAGRAM_DRIVER:
+		WriteDriverConfig(tmc262);
+		tmc262->ReadBackDatagram = TMC262_DATAGRAM_SMART_ENERGY;
 		break;
-	case RB_SMART_ENERGY:
-		WriteSmartEnergyControl();
-		ReadBackDatagram = RB_STALL_GUARD;
+	case TMC262_DATAGRAM_SMART_ENERGY:
+		WriteSmartEnergyControl(tmc262);
+		tmc262->ReadBackDatagram = TMC262_DATAGRAM_STALL_GUARD;
 		break;
-	case RB_STALL_GUARD:
-		WriteStallGuardConfig();
-		ReadBackDatagram = RB_STEP_DIR;
+	case TMC262_DATAGRAM_STALL_GUARD:
+		WriteStallGuardConfig(tmc262);
+		tmc262->ReadBackDatagram = TMC262_DATAGRAM_STEP_DIR;
 		break;
-	case RB_STEP_DIR:
-		WriteStepDirConfig();
-		ReadBackDatagram = RB_CHOPPER;
+	case TMC262_DATAGRAM_STEP_DIR:
+		WriteStepDirConfig(tmc262);
+		tmc262->ReadBackDatagram = TMC262_DATAGRAM_CHOPPER;
 		break;
 	default:
-		ReadBackDatagram = RB_CHOPPER;
+		tmc262->ReadBackDatagram = TMC262_DATAGRAM_CHOPPER;
 		break;
 	}
 
 	// Decode read values depending on selected type
-	switch(DriverConfig.ReadBackSelect)
+	switch(tmc262->DriverConfig.ReadBackSelect)
 	{
 	case TMC262_RB_MSTEP:
 		if(Phases != NULL)
-			*Phases = SPIReadInt >> 18;
+			*Phases = tmc262->SPIReadInt >> 18;
 		if(MStep != NULL)
-			*MStep = SPIReadInt >> 10;
+			*MStep = tmc262->SPIReadInt >> 10;
 		break;
 	case TMC262_RB_STALL_GUARD:
 		if(StallGuard != NULL)
-			*StallGuard=SPIReadInt >> 10;
+			*StallGuard=tmc262->SPIReadInt >> 10;
 		break;
 	case TMC262_RB_SMART_ENERGY:
 		if(StallGuard != NULL)
 		{
-			*StallGuard = SPIReadInt >> 15;
+			*StallGuard = tmc262->SPIReadInt >> 15;
 			*StallGuard <<= 5;
 		}
 		if(SmartEnergy != NULL)
 		{
-			*SmartEnergy = (SPIReadInt >> 10) & 0x1F;
+			*SmartEnergy = (tmc262->SPIReadInt >> 10) & 0x1F;
 		}
 		break;
 	}
 
 	if(Flags != NULL)
-		*Flags = SPIReadInt & 0xFF;
+		*Flags = tmc262->SPIReadInt & 0xFF;
 }
 
 
-#if defined(DEVTYPE_TMC43xx)
 /*******************************************************************
 	 Function: tmc262_readStateNoCoverData()
 	 Parameter: Phases: Pointer to state variable of phase bits
@@ -713,8 +672,7 @@ void tmc262_readState(uint8_t *Phases, uint8_t *MStep, uint32_t *StallGuard, uin
 	            SmartEnergy: Pointer to variable for SmartEnergy
 	            Flags: Pointer to variable for error-flags
 
-	 Returns: ---
-
+	 Returns: TRUE if the transport supports polling, FALSE otherwise
 
 	 Purpose: Read out TMC262-state, without sending a cover datagram
 	          and thus without disturbing SPI communication.
@@ -722,14 +680,17 @@ void tmc262_readState(uint8_t *Phases, uint8_t *MStep, uint32_t *StallGuard, uin
 	          values are extracted accordingly from the SPI telegram.
 	          NULL can be used for values that are not required.
 ********************************************************************/
-void tmc262_readStateNoCoverData(uint8_t *Phases, uint16_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags)
+uint8_t tmc262_readStateNoCoverData(TMC262TypeDef *tmc262, uint8_t *Phases, uint16_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags)
 {
 	uint32_t SPIReadData;
 
-	SPIReadData = tmc43xx_readInt(TMC4361A_POLLING_STATUS_RD);
+	if(!tmc262->transport->readPollingStatus)
+		return FALSE;
+
+	SPIReadData = tmc262->transport->readPollingStatus(tmc262->transportContext);
 
 	// Decode read values depending on selected type
-	switch(DriverConfig.ReadBackSelect)
+	switch(tmc262->DriverConfig.ReadBackSelect)
 	{
 	case TMC262_RB_MSTEP:
 		if(Phases != NULL)
@@ -756,8 +717,9 @@ void tmc262_readStateNoCoverData(uint8_t *Phases, uint16_t *MStep, uint32_t *Sta
 
 	if(Flags != NULL)
 		*Flags = SPIReadData & 0xFF;
+
+	return TRUE;
 }
-#endif
 
 
 
@@ -771,12 +733,12 @@ void tmc262_readStateNoCoverData(uint8_t *Phases, uint16_t *MStep, uint32_t *Sta
 	          TOff-Time to 0 (altough the last TOff value which was set
 	          with tmc262_setChopperTOff() is still available.
 ********************************************************************/
-void tmc262_disable()
+void tmc262_disable(TMC262TypeDef *tmc262)
 {
-	if(!ChopperConfig.DisableFlag)
+	if(!tmc262->ChopperConfig.DisableFlag)
 	{
-		ChopperConfig.DisableFlag = TRUE;
-		WriteChopperConfig();
+		tmc262->ChopperConfig.DisableFlag = TRUE;
+		CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 	}
 }
 
@@ -791,39 +753,39 @@ void tmc262_disable()
 	          with the value which was written the last time by
 	          tmc262_setChopperTOff()
 ********************************************************************/
-void tmc262_enable()
+void tmc262_enable(TMC262TypeDef *tmc262)
 {
-	if(ChopperConfig.DisableFlag)
+	if(tmc262->ChopperConfig.DisableFlag)
 	{
-		ChopperConfig.DisableFlag = FALSE;
-		WriteChopperConfig();
+		tmc262->ChopperConfig.DisableFlag = FALSE;
+		CommitConfig(tmc262, TMC262_DATAGRAM_CHOPPER);
 	}
 }
 
-void tmc262_getSPIData(uint8_t Index, int *Data)
+void tmc262_getSPIData(TMC262TypeDef *tmc262, uint8_t Index, int *Data)
 {
 	switch(Index)
 	{
 	case 0:
-		*Data = SPIReadInt;
+		*Data = tmc262->SPIReadInt;
 		break;
 	case 1:
-		*Data = SPIStepDirConf;
+		*Data = tmc262->SPIStepDirConf;
 		break;
 	case 2:
-		*Data = SPIChopperConf;
+		*Data = tmc262->SPIChopperConf;
 		break;
 	case 3:
-		*Data = SPISmartConf;
+		*Data = tmc262->SPISmartConf;
 		break;
 	case 4:
-		*Data = SPISGConf;
+		*Data = tmc262->SPISGConf;
 		break;
 	case 5:
-		*Data = SPIDriverConf;
+		*Data = tmc262->SPIDriverConf;
 		break;
 	case 6:
-		*Data = ChopperConfig.DisableFlag;
+		*Data = tmc262->ChopperConfig.DisableFlag;
 		break;
 	}
 }
@@ -26,68 +26,162 @@
 #define TMC262_FLAG_OT    0x02
 #define TMC262_FLAG_SG    0x01
 
+// Data structs for TMC262 Shadowregister
+typedef struct
+{
+	uint8_t Intpol;
+	uint8_t DEdge;
+	uint8_t MRes;
+} TMC262StepDirConfig;
+
+typedef struct
+{
+	uint8_t BlankTime;
+	uint8_t ChopperMode;
+	uint8_t HysteresisDecay;
+	uint8_t RandomTOff;
+	uint8_t HysteresisEnd;
+	uint8_t HysteresisStart;
+	uint8_t TOff;
+	uint8_t DisableFlag;
+} TMC262ChopperConfig;
+
+typedef struct
+{
+	uint8_t SmartIMin;
+	uint8_t SmartDownStep;
+	uint8_t SmartStallLevelMax;
+	uint8_t SmartUpStep;
+	uint8_t SmartStallLevelMin;
+} TMC262SmartEnergyControl;
+
+typedef struct
+{
+	uint8_t FilterEnable;
+	int8_t StallGuardThreshold;
+	uint8_t CurrentScale;
+} TMC262StallGuardConfig;
+
+
+typedef struct
+{
+	uint8_t SlopeHighSide;
+	uint8_t SlopeLowSide;
+	uint8_t ProtectionDisable;
+	uint8_t ProtectionTimer;
+	uint8_t StepDirectionDisable;
+	uint8_t VSenseScale;
+	uint8_t ReadBackSelect;
+} TMC262DriverConfig;
+
+typedef enum {
+	TMC262_DATAGRAM_CHOPPER,
+	TMC262_DATAGRAM_DRIVER,
+	TMC262_DATAGRAM_SMART_ENERGY,
+	TMC262_DATAGRAM_STALL_GUARD,
+	TMC262_DATAGRAM_STEP_DIR
+} TMC262Datagram;
+
+// Datagram transport of a TMC262.
+// readWrite sends a 20 bit datagram and returns the 20 bit reply, either by direct SPI
+// (24 bit transfer, the reply shifted right by 4) or through the cover datagrams of a
+// TMC43xx motion controller (e.g. tmc4361A_readWriteCover()).
+typedef struct
+{
+	uint32_t (*readWrite)(void *context, uint32_t datagram);
+	uint32_t (*readPollingStatus)(void *context); // Last TMC262 reply polled by a TMC43xx, NULL if not available
+	uint8_t coverDatagrams;                       // TRUE if the TMC262 is driven by a TMC43xx in SPI mode
+} TMC262TransportTypeDef;
+
+typedef struct
+{
+	const TMC262TransportTypeDef *transport;
+	void *transportContext;
+
+	TMC262StepDirConfig StepDirConfig;            // Shadowregister of DRVCTRL-Register
+	TMC262ChopperConfig ChopperConfig;            // Shadowregister of CHOPCONF-Register
+	TMC262SmartEnergyControl SmartEnergyControl;  // Shadowregister of SMARTEN-Register
+	TMC262StallGuardConfig StallGuardConfig;      // Shadowregister of SGSCONF-Register
+	TMC262DriverConfig DriverConfig;              // Shadowregister of DRVCONF-Register
+	TMC262Datagram ReadBackDatagram;              // Next telegram to be used to read the state
+	uint32_t SPIReadInt;
+	uint32_t SPIWriteInt;
+
+	uint32_t SPIStepDirConf;
+	uint32_t SPIChopperConf;
+	uint32_t SPISmartConf;
+	uint32_t SPISGConf;
+	uint32_t SPIDriverConf;
+
+	uint8_t Deferred;  // Setters only mark their datagram, see tmc262_beginUpdate()
+	uint8_t Pending;   // Datagrams to send with tmc262_commit(), bit = TMC262Datagram
+} TMC262TypeDef;
+
 // Access functions for TMC262
-void tmc262_initMotorDrivers(void);
-void tmc262_setStepDirMStepRes(uint8_t MicrostepResolution);
-void tmc262_setStepDirInterpolation(uint8_t Interpolation);
-void tmc262_setStepDirDoubleEdge(uint8_t DoubleEdge);
-uint8_t tmc262_getStepDirMStepRes();
-uint8_t tmc262_getStepDirInterpolation();
-uint8_t tmc262_getStepDirDoubleEdge();
-
-void tmc262_setChopperBlankTime(uint8_t BlankTime);
-void tmc262_setChopperMode(uint8_t Mode);
-void tmc262_setChopperRandomTOff(uint8_t RandomTOff);
-void tmc262_setChopperHysteresisDecay(uint8_t HysteresisDecay);
-void tmc262_setChopperHysteresisEnd(uint8_t HysteresisEnd);
-void tmc262_setChopperHysteresisStart(uint8_t HysteresisStart);
-void tmc262_setChopperTOff(uint8_t TOff);
-uint8_t tmc262_getChopperBlankTime();
-uint8_t tmc262_getChopperMode();
-uint8_t tmc262_getChopperRandomTOff();
-uint8_t tmc262_getChopperHysteresisDecay();
-uint8_t tmc262_getChopperHysteresisEnd();
-uint8_t tmc262_getChopperHysteresisStart();
-uint8_t tmc262_getChopperTOff();
-
-void tmc262_setSmartEnergyIMin(uint8_t SmartIMin);
-void tmc262_setSmartEnergyDownStep(uint8_t SmartDownStep);
-void tmc262_setSmartEnergyStallLevelMax(uint8_t StallLevelMax);
-void tmc262_setSmartEnergyUpStep(uint8_t SmartUpStep);
-void tmc262_setSmartEnergyStallLevelMin(uint8_t StallLevelMin);
-uint8_t tmc262_getSmartEnergyIMin();
-uint8_t tmc262_getSmartEnergyDownStep();
-uint8_t tmc262_getSmartEnergyStallLevelMax();
-uint8_t tmc262_getSmartEnergyUpStep();
-uint8_t tmc262_getSmartEnergyStallLevelMin();
-
-void tmc262_setStallGuardFilter(uint8_t Enable);
-void tmc262_setStallGuardThreshold(signed char Threshold);
-void tmc262_setStallGuardCurrentScale(uint8_t CurrentScale);
-uint8_t tmc262_getStallGuardFilter();
-signed char tmc262_getStallGuardThreshold();
-uint8_t tmc262_getStallGuardCurrentScale();
-
-void tmc262_setDriverSlopeHighSide(uint8_t SlopeHighSide);
-void tmc262_setDriverSlopeLowSide(uint8_t SlopeLowSide);
-void tmc262_setDriverDisableProtection(uint8_t DisableProtection);
-void tmc262_setDriverProtectionTimer(uint8_t ProtectionTimer);
-void tmc262_setDriverStepDirectionOff(uint8_t SDOff);
-void tmc262_setDriverVSenseScale(uint8_t Scale);
-void tmc262_setDriverReadSelect(uint8_t ReadSelect);
-uint8_t tmc262_getDriverSlopeHighSide();
-uint8_t tmc262_getDriverSlopeLowSide();
-uint8_t tmc262_getDriverDisableProtection();
-uint8_t tmc262_getDriverProtectionTimer();
-uint8_t tmc262_getDriverStepDirectionOff();
-uint8_t tmc262_getDriverVSenseScale();
-uint8_t tmc262_getDriverReadSelect();
-
-void tmc262_disable();
-void tmc262_enable();
-
-void tmc262_readState(uint8_t *Phases, uint8_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags);
-
-void tmc262_getSPIData(uint8_t Index, int *Data);
+void tmc262_initMotorDrivers(TMC262TypeDef *tmc262, const TMC262TransportTypeDef *transport, void *transportContext);
+void tmc262_beginUpdate(TMC262TypeDef *tmc262);
+void tmc262_commit(TMC262TypeDef *tmc262);
+void tmc262_setStepDirMStepRes(TMC262TypeDef *tmc262, uint8_t MicrostepResolution);
+void tmc262_setStepDirInterpolation(TMC262TypeDef *tmc262, uint8_t Interpolation);
+void tmc262_setStepDirDoubleEdge(TMC262TypeDef *tmc262, uint8_t DoubleEdge);
+uint8_t tmc262_getStepDirMStepRes(TMC262TypeDef *tmc262);
+uint8_t tmc262_getStepDirInterpolation(TMC262TypeDef *tmc262);
+uint8_t tmc262_getStepDirDoubleEdge(TMC262TypeDef *tmc262);
+
+void tmc262_setChopperBlankTime(TMC262TypeDef *tmc262, uint8_t BlankTime);
+void tmc262_setChopperMode(TMC262TypeDef *tmc262, uint8_t Mode);
+void tmc262_setChopperRandomTOff(TMC262TypeDef *tmc262, uint8_t RandomTOff);
+void tmc262_setChopperHysteresisDecay(TMC262TypeDef *tmc262, uint8_t HysteresisDecay);
+void tmc262_setChopperHysteresisEnd(TMC262TypeDef *tmc262, uint8_t HysteresisEnd);
+void tmc262_setChopperHysteresisStart(TMC262TypeDef *tmc262, uint8_t HysteresisStart);
+void tmc262_setChopperTOff(TMC262TypeDef *tmc262, uint8_t TOff);
+uint8_t tmc262_getChopperBlankTime(TMC262TypeDef *tmc262);
+uint8_t tmc262_getChopperMode(TMC262TypeDef *tmc262);
+uint8_t tmc262_getChopperRandomTOff(TMC262TypeDef *tmc262);
+uint8_t tmc262_getChopperHysteresisDecay(TMC262TypeDef *tmc262);
+uint8_t tmc262_getChopperHysteresisEnd(TMC262TypeDef *tmc262);
+uint8_t tmc262_getChopperHysteresisStart(TMC262TypeDef *tmc262);
+uint8_t tmc262_getChopperTOff(TMC262TypeDef *tmc262);
+
+void tmc262_setSmartEnergyIMin(TMC262TypeDef *tmc262, uint8_t SmartIMin);
+void tmc262_setSmartEnergyDownStep(TMC262TypeDef *tmc262, uint8_t SmartDownStep);
+void tmc262_setSmartEnergyStallLevelMax(TMC262TypeDef *tmc262, uint8_t StallLevelMax);
+void tmc262_setSmartEnergyUpStep(TMC262TypeDef *tmc262, uint8_t SmartUpStep);
+void tmc262_setSmartEnergyStallLevelMin(TMC262TypeDef *tmc262, uint8_t StallLevelMin);
+uint8_t tmc262_getSmartEnergyIMin(TMC262TypeDef *tmc262);
+uint8_t tmc262_getSmartEnergyDownStep(TMC262TypeDef *tmc262);
+uint8_t tmc262_getSmartEnergyStallLevelMax(TMC262TypeDef *tmc262);
+uint8_t tmc262_getSmartEnergyUpStep(TMC262TypeDef *tmc262);
+uint8_t tmc262_getSmartEnergyStallLevelMin(TMC262TypeDef *tmc262);
+
+void tmc262_setStallGuardFilter(TMC262TypeDef *tmc262, uint8_t Enable);
+void tmc262_setStallGuardThreshold(TMC262TypeDef *tmc262, signed char Threshold);
+void tmc262_setStallGuardCurrentScale(TMC262TypeDef *tmc262, uint8_t CurrentScale);
+uint8_t tmc262_getStallGuardFilter(TMC262TypeDef *tmc262);
+signed char tmc262_getStallGuardThreshold(TMC262TypeDef *tmc262);
+uint8_t tmc262_getStallGuardCurrentScale(TMC262TypeDef *tmc262);
+
+void tmc262_setDriverSlopeHighSide(TMC262TypeDef *tmc262, uint8_t SlopeHighSide);
+void tmc262_setDriverSlopeLowSide(TMC262TypeDef *tmc262, uint8_t SlopeLowSide);
+void tmc262_setDriverDisableProtection(TMC262TypeDef *tmc262, uint8_t DisableProtection);
+void tmc262_setDriverProtectionTimer(TMC262TypeDef *tmc262, uint8_t ProtectionTimer);
+void tmc262_setDriverStepDirectionOff(TMC262TypeDef *tmc262, uint8_t SDOff);
+void tmc262_setDriverVSenseScale(TMC262TypeDef *tmc262, uint8_t Scale);
+void tmc262_setDriverReadSelect(TMC262TypeDef *tmc262, uint8_t ReadSelect);
+uint8_t tmc262_getDriverSlopeHighSide(TMC262TypeDef *tmc262);
+uint8_t tmc262_getDriverSlopeLowSide(TMC262TypeDef *tmc262);
+uint8_t tmc262_getDriverDisableProtection(TMC262TypeDef *tmc262);
+uint8_t tmc262_getDriverProtectionTimer(TMC262TypeDef *tmc262);
+uint8_t tmc262_getDriverStepDirectionOff(TMC262TypeDef *tmc262);
+uint8_t tmc262_getDriverVSenseScale(TMC262TypeDef *tmc262);
+uint8_t tmc262_getDriverReadSelect(TMC262TypeDef *tmc262);
+
+void tmc262_disable(TMC262TypeDef *tmc262);
+void tmc262_enable(TMC262TypeDef *tmc262);
+
+void tmc262_readState(TMC262TypeDef *tmc262, uint8_t *Phases, uint8_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags);
+uint8_t tmc262_readStateNoCoverData(TMC262TypeDef *tmc262, uint8_t *Phases, uint16_t *MStep, uint32_t *StallGuard, uint8_t *SmartEnergy, uint8_t *Flags);
+
+void tmc262_getSPIData(TMC262TypeDef *tmc262, uint8_t Index, int *Data);
 
 #endif /* TMC_IC_TMC262_H_ */
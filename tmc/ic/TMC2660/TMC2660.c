@@ -38,60 +38,71 @@ extern void tmc2660_readWrite(uint8_t motor, uint32_t value);
 //extern void tmc2660_setField(uint8_t motor, uint8_t address, uint32_t clearMask, uint32_t field);
 // <= SPI wrapper
 
-static void standStillCurrentLimitation(TMC2660TypeDef *TMC2660)
+static void standStillCurrentLimitation(uint32_t tick, TMC2660TypeDef *TMC2660, ConfigurationTypeDef *TMC2660_config)
 { // mark if current should be reduced in stand still if too high
-	static uint32_t errorTimer = 0;
-
-	// check the standstill flag
-	if(TMC2660_GET_STST(tmc2660_readInt(0, TMC2660_RESPONSE_LATEST)))
+	// check the standstill flag of the latest reply, no additional datagram needed
+	if(TMC2660_GET_STST(TMC2660_config->shadowRegister[TMC2660_RESPONSE_LATEST]))
 	{
 		// check if current reduction is neccessary
 		if(TMC2660->runCurrentScale > TMC2660->standStillCurrentScale)
 		{
 			TMC2660->isStandStillOverCurrent = 1;
 
-			// count timeout
-			if(errorTimer++ > TMC2660->standStillTimeout/10)
+			// check timeout
+			if(tick - TMC2660->standStillTick > TMC2660->standStillTimeout)
 			{
 				// set current limitation flag
 				TMC2660->isStandStillCurrentLimit = 1;
-				errorTimer = 0;
 			}
 			return;
 		}
 	}
 
-	// No standstill or overcurrent -> reset flags & error timer
+	// No standstill or overcurrent -> reset flags & timeout
 	TMC2660->isStandStillOverCurrent  = 0;
 	TMC2660->isStandStillCurrentLimit = 0;
-	errorTimer = 0;
+	TMC2660->standStillTick = tick;
 }
 
-static void continousSync(ConfigurationTypeDef *TMC2660_config)
+static void continousSync(uint8_t motor, uint32_t tick, TMC2660TypeDef *tmc2660, ConfigurationTypeDef *TMC2660_config)
 { // refreshes settings to prevent chip from loosing settings on brownout
-	static uint8_t write  = 0;
-	static uint8_t read   = 0;
-	static uint8_t rdsel  = 0;
-
-	// rotational reading all replys to keep values up to date
 	uint32_t value, drvConf;
+	uint8_t i, rdsel;
+
+	// rotational reading of the requested replies to keep their values up to date
+	for(i = 1; i <= 3; i++)
+	{
+		rdsel = (tmc2660->syncRead + i) % 3;
+		if(tmc2660->syncReadMask & (1 << rdsel))
+			break;
+	}
 
-	// additional reading to keep all replies up to date
-	value = drvConf = tmc2660_readInt(0, TMC2660_WRITE_BIT | TMC2660_DRVCONF);  // buffer value amd  drvConf to write back later
-	value &= ~TMC2660_SET_RDSEL(-1);                                        // clear RDSEL bits
-	value |= TMC2660_SET_RDSEL(rdsel % 3);                                  // clear set rdsel
-	tmc2660_readWrite(0, value);
-	tmc2660_readWrite(0, drvConf);
+	if(i <= 3)
+	{
+		value = drvConf = tmc2660_readInt(motor, TMC2660_WRITE_BIT | TMC2660_DRVCONF);  // buffer value and drvConf to write back later
 
-	// determine next read address
-	read = (read + 1) % 3;
+		// The reply of the next datagram is selected by the RDSEL setting of the previous one.
+		// Change and restore RDSEL only if the requested reply is not the selected one already.
+		if(TMC2660_GET_RDSEL(drvConf) != rdsel)
+		{
+			value &= ~TMC2660_SET_RDSEL(-1);    // clear RDSEL bits
+			value |= TMC2660_SET_RDSEL(rdsel);  // set rdsel
+			tmc2660_readWrite(motor, value);
+		}
+		tmc2660_readWrite(motor, drvConf);
+
+		tmc2660->syncRead = rdsel;
+	}
 
-	// write settings from shadow register to chip.
-	//readWrite(TMC2660_config->shadowRegister[TMC2660_WRITE | write]);
-	tmc2660_readWrite(0, TMC2660_config->shadowRegister[TMC2660_WRITE_BIT | write]);
+	// write settings from shadow register to chip, one register per interval
+	if(tick - tmc2660->syncRewriteTick < tmc2660->syncRewriteInterval)
+		return;
+
+	tmc2660->syncRewriteTick = tick;
+	tmc2660_readWrite(motor, TMC2660_config->shadowRegister[TMC2660_WRITE_BIT | tmc2660->syncWrite]);
 
 	// determine next write address - skip unused addresses
-	write = (write == TMC2660_DRVCTRL) ? TMC2660_CHOPCONF : ((write + 1) % TMC2660_REGISTER_COUNT);
+	tmc2660->syncWrite = (tmc2660->syncWrite == TMC2660_DRVCTRL) ? TMC2660_CHOPCONF : ((tmc2660->syncWrite + 1) % TMC2660_REGISTER_COUNT);
 }
 
 void tmc2660_initConfig(TMC2660TypeDef *tmc2660)
@@ -108,6 +119,13 @@ void tmc2660_initConfig(TMC2660TypeDef *tmc2660)
 	tmc2660->coolStepThreshold         = 0;
 	tmc2660->standStillCurrentScale    = 5;
 	tmc2660->standStillTimeout         = 0;
+	tmc2660->standStillTick            = 0;
+
+	tmc2660->syncReadMask              = 0x07;
+	tmc2660->syncRewriteInterval       = 0;
+	tmc2660->syncRead                  = 2;
+	tmc2660->syncWrite                 = 0;
+	tmc2660->syncRewriteTick           = 0;
 
 	int i;
 	for(i = 0; i < TMC2660_REGISTER_COUNT; i++)
@@ -141,22 +159,36 @@ void tmc2660_writeConfiguration(TMC2660TypeDef *tmc2660, ConfigurationTypeDef *T
 	//}
 }
 
-void tmc2660_periodicJob(uint8_t motor, uint32_t tick, TMC2660TypeDef *tmc2660, ConfigurationTypeDef *TMC2660_config)
+// Real-time part of the periodic job: standstill current flags from the latest reply.
+// Worst case per call: no datagram.
+void tmc2660_periodicJobFast(uint8_t motor, uint32_t tick, TMC2660TypeDef *tmc2660, ConfigurationTypeDef *TMC2660_config)
 {
 	UNUSED(motor);
 
 	if(tick - tmc2660->oldTick >= 10)
 	{
-		standStillCurrentLimitation(tmc2660);
+		standStillCurrentLimitation(tick, tmc2660, TMC2660_config);
 		tmc2660->oldTick = tick;
 	}
+}
 
+// Background part of the periodic job: continuous mode sync.
+// Worst case per call: 3 datagrams (RDSEL switch, RDSEL restore and one register rewrite).
+void tmc2660_periodicJobBackground(uint8_t motor, uint32_t tick, TMC2660TypeDef *tmc2660, ConfigurationTypeDef *TMC2660_config)
+{
 	if(tmc2660->continuousModeEnable)
 	{ // continuously write settings to chip and rotate through all reply types to keep data up to date
-		continousSync(TMC2660_config);
+		continousSync(motor, tick, tmc2660, TMC2660_config);
 	}
 }
 
+// Call this periodically. Runs tmc2660_periodicJobFast() and tmc2660_periodicJobBackground().
+void tmc2660_periodicJob(uint8_t motor, uint32_t tick, TMC2660TypeDef *tmc2660, ConfigurationTypeDef *TMC2660_config)
+{
+	tmc2660_periodicJobFast(motor, tick, tmc2660, TMC2660_config);
+	tmc2660_periodicJobBackground(motor, tick, tmc2660, TMC2660_config);
+}
+
 uint8_t tmc2660_reset(TMC2660TypeDef *TMC2660, ConfigurationTypeDef *TMC2660_config)
 {
 	UNUSED(TMC2660_config);
@@ -31,12 +31,22 @@ typedef struct {
 	int velocity;
 	int oldX;
 	uint32_t oldTick;
+	uint32_t standStillTick;        // Tick of the last movement or current change
+
+	// Continuous mode (continuousModeEnable)
+	uint8_t syncReadMask;           // Replies to keep up to date, bit n = RDSEL n (TMC2660_RESPONSEn)
+	uint32_t syncRewriteInterval;   // Ticks between two shadow register re-writes (brownout protection), 0: every call
+	uint8_t syncRead;               // RDSEL of the last reply read
+	uint8_t syncWrite;              // Next shadow register to re-write
+	uint32_t syncRewriteTick;
 	uint8_t registerAccess[TMC2660_REGISTER_COUNT];
 	int32_t registerResetState[TMC2660_REGISTER_COUNT];
 } TMC2660TypeDef;
 
 void tmc2660_initConfig(TMC2660TypeDef *TMC2660);
 void tmc2660_periodicJob(uint8_t motor, uint32_t tick, TMC2660TypeDef *TMC2660, ConfigurationTypeDef *TMC2660_config);
+void tmc2660_periodicJobFast(uint8_t motor, uint32_t tick, TMC2660TypeDef *TMC2660, ConfigurationTypeDef *TMC2660_config);
+void tmc2660_periodicJobBackground(uint8_t motor, uint32_t tick, TMC2660TypeDef *TMC2660, ConfigurationTypeDef *TMC2660_config);
 uint8_t tmc2660_reset(TMC2660TypeDef *TMC2660, ConfigurationTypeDef *TMC2660_config);
 uint8_t tmc2660_restore(ConfigurationTypeDef *TMC2660_config);
 
@@ -17,6 +17,20 @@
 
 #include "TMC4210.h"
 
+// PULSE_DIV/RAMP_DIV, taken from the written datagrams
+static uint8_t PulseRampDivCache;
+
+// Clock frequency and its fixed point reciprocals for the unit conversions
+typedef struct
+{
+	uint32_t Mantissa;  // 2^31..2^32-1
+	uint8_t Shift;      // 1 / Divisor = Mantissa / 2^Shift
+} TReciprocal;
+
+static uint32_t ClockFrequency;
+static TReciprocal VelocityReciprocal;      // 1 / fCLK
+static TReciprocal AccelerationReciprocal;  // 1 / fCLK^2
+
 /***************************************************************//**
    \fn ReadWrite4210(uint8_t *Read, uint8_t *Write)
    \brief 32 bit SPI communication with TMC4210
@@ -35,6 +49,10 @@ void ReadWrite4210(uint8_t *Read, uint8_t *Write)
 	Read[1] = ReadWriteSPI(SPI_DEV_TMC4210, Write[1], FALSE);
 	Read[2] = ReadWriteSPI(SPI_DEV_TMC4210, Write[2], FALSE);
 	Read[3] = ReadWriteSPI(SPI_DEV_TMC4210, Write[3], TRUE);
+
+	// Keep track of the dividers for SetAMax()
+	if(Write[0] == TMC4210_IDX_PULSEDIV_RAMPDIV)
+		PulseRampDivCache = Write[2];
 }
 
 /***************************************************************//**
@@ -213,9 +231,7 @@ int32_t Read4210Short(uint8_t Address)
 	Write[0] = Address | TMC4210_READ;
 	ReadWrite4210(Read, Write);
 
-	Result = (Read[2]<<8) | Read[3];
-	if(Result & 0x00000800) // convert signed 12 bit to signed 32 bit
-		Result |= 0xFFFFF000;
+	Result = CAST_Sn_TO_S32((Read[2]<<8) | Read[3], 12); // convert signed 12 bit to signed 32 bit
 
 	return Result;
 }
@@ -238,9 +254,7 @@ int32_t Read4210Int(uint8_t Address)
 	Write[0] = Address | TMC4210_READ;
 	ReadWrite4210(Read, Write);
 
-	Result = (Read[1]<<16) | (Read[2]<<8) | Read[3];
-	if(Result & 0x00800000) // convert signed 24 bit to signed 32 bit
-		Result |= 0xFF000000;
+	Result = CAST_Sn_TO_S32((Read[1]<<16) | (Read[2]<<8) | Read[3], 24); // convert signed 24 bit to signed 32 bit
 
 	return Result;
 }
@@ -289,6 +303,114 @@ void Set4210SwitchMode(uint8_t SwitchMode)
 	ReadWrite4210(Read, Write);
 }
 
+/***************************************************************//**
+   \fn CalcReciprocal(uint64_t Divisor, TReciprocal *Reciprocal)
+   \brief Calculate a normalized fixed point reciprocal
+   \param Divisor     divisor (1..2^63)
+   \param Reciprocal  receives 2^Shift / Divisor in 32 bits
+
+   This is a binary long division, so it also works for the 64 bit
+   square of the clock frequency.
+********************************************************************/
+static void CalcReciprocal(uint64_t Divisor, TReciprocal *Reciprocal)
+{
+	uint64_t Remainder = 1;
+	uint8_t Bits = 0;
+	uint8_t i;
+
+	// 2^(Bits-1) < Divisor <= 2^Bits
+	while((Remainder << Bits) < Divisor)
+		Bits++;
+
+	Remainder <<= Bits;
+	Reciprocal->Mantissa = 1;
+	Remainder -= Divisor;
+
+	for(i = 0; i < 31; i++)
+	{
+		Remainder <<= 1;
+		Reciprocal->Mantissa <<= 1;
+		if(Remainder >= Divisor)
+		{
+			Remainder -= Divisor;
+			Reciprocal->Mantissa |= 1;
+		}
+	}
+
+	Reciprocal->Shift = Bits + 31;
+}
+
+/***************************************************************//**
+   \fn Scale(uint32_t Value, uint8_t Exponent, const TReciprocal *Reciprocal)
+   \brief Calculate Value * 2^Exponent * Reciprocal
+   \param Value       value to convert
+   \param Exponent    power of two of the divider settings
+   \param Reciprocal  reciprocal of the clock frequency (squared)
+
+   The result is rounded and limited to the 11 bit range of the
+   VMAX and AMAX registers.
+********************************************************************/
+static uint32_t Scale(uint32_t Value, uint8_t Exponent, const TReciprocal *Reciprocal)
+{
+	uint64_t Result = (uint64_t) Value * Reciprocal->Mantissa;
+
+	if(Reciprocal->Mantissa == 0)
+		return 0;
+
+	if(Exponent >= Reciprocal->Shift)
+		return (Value == 0) ? 0 : 2047;
+
+	Exponent = Reciprocal->Shift - Exponent - 1;
+	if(Exponent >= 64)
+		return 0;
+
+	Result = ((Result >> Exponent) + 1) >> 1;
+
+	return (Result > 2047) ? 2047 : Result;
+}
+
+/***************************************************************//**
+   \fn CalcPMulPDiv(uint8_t PulseRampDiv, uint32_t AMax, uint8_t *Data)
+   \brief Calculate the PMUL and PDIV values for an acceleration
+   \param PulseRampDiv  PULSE_DIV (high nibble) and RAMP_DIV (low nibble)
+   \param AMax          maximum acceleration (0..2047)
+   \param Data          three byte array receiving the PMUL_PDIV register
+
+   PMUL = 128..255 and PDIV = 0..13 have to fulfill
+   PMUL / 2^(PDIV+3) = 0.988 * AMax / 2^(RAMP_DIV-PULSE_DIV+7).
+   Only one PDIV can put PMUL into its range: The one that normalizes
+   0.988 * AMax * 2^(PULSE_DIV-RAMP_DIV+PDIV+3) / 128 into 128..255.
+   The factor 0.988 is kept exact as 988/1000, so this gives the same
+   result as the former floating point search. PMUL = PDIV = 0xFF
+   indicates that no valid pair exists.
+********************************************************************/
+static void CalcPMulPDiv(uint8_t PulseRampDiv, uint32_t AMax, uint8_t *Data)
+{
+	// 988 * AMax * 2^(PDIV+3+PULSE_DIV-RAMP_DIV) / 128000 = PMUL
+	uint32_t Numerator = 988 * AMax;
+	int32_t pdiv = (int32_t) (PulseRampDiv & 0x0F) - (PulseRampDiv >> 4) - 3;
+
+	Data[0] = 0;
+	Data[1] = 0xFF;
+	Data[2] = 0xFF;
+
+	if(Numerator == 0)
+		return;
+
+	// Normalize to PMUL >= 128 (988 * 2047 < 128 * 128000, so this always shifts left)
+	while(Numerator < 128 * 128000UL)
+	{
+		Numerator <<= 1;
+		pdiv++;
+	}
+
+	if((pdiv < 0) || (pdiv > 13))
+		return;
+
+	Data[1] = Numerator / 128000UL;
+	Data[2] = pdiv;
+}
+
 /***************************************************************//**
    \fn SetAMax(uint32_t AMax)
    \brief Set the maximum acceleration
@@ -297,49 +419,103 @@ void Set4210SwitchMode(uint8_t SwitchMode)
    This function sets the maximum acceleration and also calculates
    the PMUL and PDIV value according to all other parameters
    (please see the TMC4210 data sheet for more info about PMUL and PDIV
-   values).
+   values). The PULSE_DIV and RAMP_DIV values are the ones last written
+   to the TMC4210, so no register has to be read back.
 ********************************************************************/
 uint8_t SetAMax(uint32_t AMax)
 {
-	int32_t pmul, pm, pd;
-	float p, p_reduced;
-	int32_t ramp_div;
-	int32_t pulse_div;
-	uint8_t PulseRampDiv;
 	uint8_t Data[3];
 
 	AMax &= 0x000007FF;
-	Read4210Bytes(TMC4210_IDX_PULSEDIV_RAMPDIV, Data);
-	PulseRampDiv = Data[1];
-	pulse_div = PulseRampDiv >> 4;
-	ramp_div = PulseRampDiv & 0x0F;
+	CalcPMulPDiv(PulseRampDivCache, AMax, Data);
+	Write4210Bytes(TMC4210_IDX_PMUL_PDIV, Data);
+	Write4210Short(TMC4210_IDX_AMAX, AMax);
 
-	// -1 indicates : no valid pair found
-	pm = -1;
-	pd = -1;
+	return 0;
+}
 
-	if(ramp_div >= pulse_div)
-		p = AMax / ( 128.0 * (1 << (ramp_div - pulse_div)));  // Exponent positive or 0
-	else
-		p = AMax / ( 128.0 / (1 << (pulse_div - ramp_div)));  // Exponent negative
+/***************************************************************//**
+   \fn Set4210Clock(uint32_t Frequency)
+   \brief Set the clock frequency for the unit conversions
+   \param Frequency  clock frequency of the TMC4210 in Hz
+
+   The conversions between steps/s (steps/s^2) and the internal
+   velocity (acceleration) units multiply with a fixed point
+   reciprocal of the clock frequency (squared) that is calculated
+   here once, so they need no division. Init4210() sets 16MHz if no
+   clock frequency has been set before.
+********************************************************************/
+void Set4210Clock(uint32_t Frequency)
+{
+	ClockFrequency = Frequency;
+	CalcReciprocal(Frequency, &VelocityReciprocal);
+	CalcReciprocal((uint64_t) Frequency * Frequency, &AccelerationReciprocal);
+}
 
-	p_reduced = p*0.988;
+/***************************************************************//**
+   \fn Calc4210V(uint32_t Velocity)
+   \brief Convert a velocity from steps/s into TMC4210 units
+   \param Velocity  velocity in steps/s
 
-	int32_t pdiv;
-	for(pdiv = 0; pdiv <= 13; pdiv++)
-	{
-		pmul = (int32_t) (p_reduced * 8.0 * (1<<pdiv)) - 128;
+   V = Velocity * 2^(PULSE_DIV+16) / fCLK, rounded and limited to
+   0..2047. PULSE_DIV is the one last written to the TMC4210.
+********************************************************************/
+uint32_t Calc4210V(uint32_t Velocity)
+{
+	return Scale(Velocity, (PulseRampDivCache >> 4) + 16, &VelocityReciprocal);
+}
 
-		if((0 <= pmul) && (pmul <= 127))
-		{
-			pm = pmul + 128;
-			pd = pdiv;
-		}
-	}
+/***************************************************************//**
+   \fn Calc4210Velocity(uint32_t V)
+   \brief Convert a velocity from TMC4210 units into steps/s
+   \param V  velocity in TMC4210 units (0..2047)
+********************************************************************/
+uint32_t Calc4210Velocity(uint32_t V)
+{
+	return ((uint64_t) V * ClockFrequency) >> ((PulseRampDivCache >> 4) + 16);
+}
 
-	Data[0] = 0;
-	Data[1] = (uint8_t) pm;
-	Data[2] = (uint8_t) pd;
+/***************************************************************//**
+   \fn Calc4210A(uint32_t Acceleration)
+   \brief Convert an acceleration from steps/s^2 into TMC4210 units
+   \param Acceleration  acceleration in steps/s^2
+
+   A = Acceleration * 2^(PULSE_DIV+RAMP_DIV+29) / fCLK^2, rounded and
+   limited to 0..2047.
+********************************************************************/
+uint32_t Calc4210A(uint32_t Acceleration)
+{
+	return Scale(Acceleration, (PulseRampDivCache >> 4) + (PulseRampDivCache & 0x0F) + 29, &AccelerationReciprocal);
+}
+
+/***************************************************************//**
+   \fn Calc4210Acceleration(uint32_t A)
+   \brief Convert an acceleration from TMC4210 units into steps/s^2
+   \param A  acceleration in TMC4210 units (0..2047)
+********************************************************************/
+uint32_t Calc4210Acceleration(uint32_t A)
+{
+	return ((uint64_t) A * ClockFrequency * ClockFrequency) >> ((PulseRampDivCache >> 4) + (PulseRampDivCache & 0x0F) + 29);
+}
+
+/***************************************************************//**
+   \fn Set4210Ramp(uint32_t Velocity, uint32_t Acceleration)
+   \brief Set the maximum velocity and acceleration
+   \param Velocity      maximum velocity in steps/s
+   \param Acceleration  maximum acceleration in steps/s^2
+
+   VMAX, AMAX, PMUL and PDIV are calculated with the current divider
+   settings before the first register is written, so the three
+   registers are written with directly following datagrams.
+********************************************************************/
+uint8_t Set4210Ramp(uint32_t Velocity, uint32_t Acceleration)
+{
+	uint32_t VMax = Calc4210V(Velocity);
+	uint32_t AMax = Calc4210A(Acceleration);
+	uint8_t Data[3];
+
+	CalcPMulPDiv(PulseRampDivCache, AMax, Data);
+	Write4210Int(TMC4210_IDX_VMAX, VMax);
 	Write4210Bytes(TMC4210_IDX_PMUL_PDIV, Data);
 	Write4210Short(TMC4210_IDX_AMAX, AMax);
 
@@ -370,6 +546,10 @@ void HardStop(void)
 void Init4210(void)
 {
 	uint32_t addr;
+
+	if(ClockFrequency == 0)
+		Set4210Clock(16000000);
+
 	for(addr = 0; addr <= TMC4210_IDX_XLATCHED; addr++)
 		Write4210Zero(addr | (Motor<<5));
 
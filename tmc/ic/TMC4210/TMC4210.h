@@ -26,6 +26,12 @@ int32_t Read4210Int(uint8_t Address);
 void Set4210RampMode(uint8_t RampMode);
 void Set4210SwitchMode(uint8_t SwitchMode);
 uint8_t SetAMax(uint32_t AMax);
+void Set4210Clock(uint32_t Frequency);
+uint32_t Calc4210V(uint32_t Velocity);
+uint32_t Calc4210Velocity(uint32_t V);
+uint32_t Calc4210A(uint32_t Acceleration);
+uint32_t Calc4210Acceleration(uint32_t A);
+uint8_t Set4210Ramp(uint32_t Velocity, uint32_t Acceleration);
 void HardStop(void);
 
 #endif /* TMC_IC_TMC4210_H_ */
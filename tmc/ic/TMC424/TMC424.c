@@ -19,8 +19,9 @@
 
 
 /***************************************************************//**
-	 \fn ReadWrite424(uint8_t *Read, uint8_t *Write)
+	 \fn ReadWrite424(TMC424TypeDef *TMC424, uint8_t *Read, uint8_t *Write)
 	 \brief 32 bit SPI communication with TMC424
+	 \param TMC424 TMC424 instance
 	 \param Read   four byte array holding the data read from the TMC424
 	 \param Write  four byte array holding the data to write to the TMC424
 
@@ -28,17 +29,17 @@
 	 the TMC424. It sends a 32 bit SPI telegramme to the TMC424 and
 	 receives the 32 bit answer telegramme from the TMC424.
 ********************************************************************/
-static void ReadWrite424(uint8_t *Read, uint8_t *Write)
+static void ReadWrite424(TMC424TypeDef *TMC424, uint8_t *Read, uint8_t *Write)
 {
-	Read[0] = ReadWriteSPI(SPI_DEV_ENCODER, Write[0], FALSE);
-	Read[1] = ReadWriteSPI(SPI_DEV_ENCODER, Write[1], FALSE);
-	Read[2] = ReadWriteSPI(SPI_DEV_ENCODER, Write[2], FALSE);
-	Read[3] = ReadWriteSPI(SPI_DEV_ENCODER, Write[3], TRUE);
+	Read[0] = ReadWriteSPI(TMC424->SPIDevice, Write[0], FALSE);
+	Read[1] = ReadWriteSPI(TMC424->SPIDevice, Write[1], FALSE);
+	Read[2] = ReadWriteSPI(TMC424->SPIDevice, Write[2], FALSE);
+	Read[3] = ReadWriteSPI(TMC424->SPIDevice, Write[3], TRUE);
 }
 
 
 /***************************************************************//**
-	 \fn Write424Bytes(uint8_t Address, uint8_t HiByte, uint8_t MidByte, uint8_t LoByte)
+	 \fn Write424Bytes(TMC424TypeDef *TMC424, uint8_t Address, uint8_t HiByte, uint8_t MidByte, uint8_t LoByte)
 	 \brief Write to TMC424 register
 	 \param Address   TMC424 register address
 	 \param HiByte    MSB to be written
@@ -47,17 +48,17 @@ static void ReadWrite424(uint8_t *Read, uint8_t *Write)
 
 	 Write to the three single bytes of a TMC424 register.
 ********************************************************************/
-static void Write424Bytes(uint8_t Address, uint8_t HiByte, uint8_t MidByte, uint8_t LoByte)
+static void Write424Bytes(TMC424TypeDef *TMC424, uint8_t Address, uint8_t HiByte, uint8_t MidByte, uint8_t LoByte)
 {
-	ReadWriteSPI(SPI_DEV_ENCODER, Address|TMC424_WRITE, FALSE);
-	ReadWriteSPI(SPI_DEV_ENCODER, HiByte, FALSE);
-	ReadWriteSPI(SPI_DEV_ENCODER, MidByte, FALSE);
-	ReadWriteSPI(SPI_DEV_ENCODER, LoByte, TRUE);
+	ReadWriteSPI(TMC424->SPIDevice, Address|TMC424_WRITE, FALSE);
+	ReadWriteSPI(TMC424->SPIDevice, HiByte, FALSE);
+	ReadWriteSPI(TMC424->SPIDevice, MidByte, FALSE);
+	ReadWriteSPI(TMC424->SPIDevice, LoByte, TRUE);
 }
 
 
 /***************************************************************//**
-	 \fn SetEncoderPrescaler(uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunctionBits)
+	 \fn SetEncoderPrescaler(TMC424TypeDef *TMC424, uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunctionBits)
 	 \brief Index  TMC424 encoder channel (0, 1 or 2)
 	 \param Prescaler   Encooder pre-scaler (see TMC424 data sheet)
 	 \param SpecialFunctionBits  special encoder functions (see TMC424 data sheet)
@@ -65,7 +66,7 @@ static void Write424Bytes(uint8_t Address, uint8_t HiByte, uint8_t MidByte, uint
 	 This function sets the pre-scaler and the special functions of an encoder
 	 channel.
 ********************************************************************/
-void SetEncoderPrescaler(uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunctionBits)
+void SetEncoderPrescaler(TMC424TypeDef *TMC424, uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunctionBits)
 {
 	uint8_t RegAddr;
 	uint32_t ps;
@@ -74,13 +75,13 @@ void SetEncoderPrescaler(uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunct
 	switch(Index)
 	{
 	case 0:
-		RegAddr = TMC423_ENC_CONF_1;
+		RegAddr = TMC424_ENC_CONF_1;
 		break;
 	case 1:
-		RegAddr = TMC423_ENC_CONF_2;
+		RegAddr = TMC424_ENC_CONF_2;
 		break;
 	case 2:
-		RegAddr = TMC423_ENC_CONF_3;
+		RegAddr = TMC424_ENC_CONF_3;
 		break;
 	default:
 		return;
@@ -90,12 +91,12 @@ void SetEncoderPrescaler(uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunct
 	sf = SpecialFunctionBits;
 	sf <<= 7;
 	ps |= sf;
-	Write423Bytes(RegAddr, 0, ps >> 16, ps >> 8, (uint8_t) ps);
+	Write424Bytes(TMC424, RegAddr, ps >> 16, ps >> 8, (uint8_t) ps);
 }
 
 
 /***************************************************************//**
-	 \fn ReadEncoder(uint8_t Index)
+	 \fn ReadEncoder(TMC424TypeDef *TMC424, uint8_t Index)
 	 \brief  Read encoder counter
 	 \param Index  Specifies the encoder (0, 1 or 2)
 	 \return Encoder positon counter value
@@ -103,21 +104,21 @@ void SetEncoderPrescaler(uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunct
 	 This function reads an encoder counter and returns its value
 	 as a 32 bit signed value.
 ********************************************************************/
-int32_t ReadEncoder(uint8_t Index)
+int32_t ReadEncoder(TMC424TypeDef *TMC424, uint8_t Index)
 {
-	uint8_t Read424[5], Write424[5];
+	uint8_t Read424[4], Write424[4];
 	uint32_t Position;
 
 	switch(Index)
 	{
 	case 0:
-		Write424[0] = TMC423_ENC_DATA_1;
+		Write424[0] = TMC424_ENC_DATA_1;
 		break;
 	case 1:
-		Write424[0] = TMC423_ENC_DATA_2;
+		Write424[0] = TMC424_ENC_DATA_2;
 		break;
 	case 2:
-		Write424[0] = TMC423_ENC_DATA_3;
+		Write424[0] = TMC424_ENC_DATA_3;
 		break;
 	default:
 		return 0;
@@ -126,49 +127,77 @@ int32_t ReadEncoder(uint8_t Index)
 	Write424[1] = 0;
 	Write424[2] = 0;
 	Write424[3] = 0;
-	Write424[4] = 0;
-	ReadWrite424(Read424, Write424);
-	Position = (Read424[1]<<16) | (Read424[2]<<8) | Read424[3];
-	if(Read424[1] & 0x80) // Sign extend the value
-		Position |= 0xFF000000;
+	ReadWrite424(TMC424, Read424, Write424);
+	Position = CAST_Sn_TO_S32((Read424[1]<<16) | (Read424[2]<<8) | Read424[3], 24); // Sign extend the value
 
 	return Position;
 }
 
 
 /***************************************************************//**
-	 \fn WriteEncoder(uint8_t Index, int32_t Value)
+	 \fn ReadAllEncoders(TMC424TypeDef *TMC424, int32_t *Positions)
+	 \brief  Read all encoder counters at the same time
+	 \param Positions  Array of TMC424_ENCODERS values, receives the counters
+
+	 The FREEZE bit latches all encoder data registers, so the three
+	 counter values are sampled at the same time. The registers are then
+	 read back to back and FREEZE is cleared again.
+********************************************************************/
+void ReadAllEncoders(TMC424TypeDef *TMC424, int32_t *Positions)
+{
+	static const uint8_t Registers[TMC424_ENCODERS] = { TMC424_ENC_DATA_1, TMC424_ENC_DATA_2, TMC424_ENC_DATA_3 };
+	uint8_t Read424[4], Write424[4];
+	uint8_t i;
+
+	Write424Bytes(TMC424, TMC424_INT_CTRL, TMC424->IntCtrl | TMC424_FREEZE, 0, 0);
+
+	Write424[1] = 0;
+	Write424[2] = 0;
+	Write424[3] = 0;
+	for(i = 0; i < TMC424_ENCODERS; i++)
+	{
+		Write424[0] = Registers[i];
+		ReadWrite424(TMC424, Read424, Write424);
+		Positions[i] = CAST_Sn_TO_S32((Read424[1]<<16) | (Read424[2]<<8) | Read424[3], 24); // Sign extend the value
+	}
+
+	Write424Bytes(TMC424, TMC424_INT_CTRL, TMC424->IntCtrl, 0, 0);
+}
+
+
+/***************************************************************//**
+	 \fn WriteEncoder(TMC424TypeDef *TMC424, uint8_t Index, int32_t Value)
 	 \brief Change encoder counter
 	 \param Index  specifies the encoder (0, 1 or 2)
 	 \param Value  value to be written
 
 	 Change an encoder counter register to the given value.
 ********************************************************************/
-void WriteEncoder(uint8_t Index, int32_t Value)
+void WriteEncoder(TMC424TypeDef *TMC424, uint8_t Index, int32_t Value)
 {
 	uint8_t RegAddr;
 
 	switch(Index)
 	{
 	case 0:
-		RegAddr = TMC423_ENC_DATA_1;
+		RegAddr = TMC424_ENC_DATA_1;
 		break;
 	case 1:
-		RegAddr = TMC423_ENC_DATA_2;
+		RegAddr = TMC424_ENC_DATA_2;
 		break;
 	case 2:
-		RegAddr = TMC423_ENC_DATA_3;
+		RegAddr = TMC424_ENC_DATA_3;
 		break;
 	default:
 		return;
 	}
 
-	Write424Bytes(RegAddr, Value >> 16, Value >> 8, (uint8_t) Value);
+	Write424Bytes(TMC424, RegAddr, Value >> 16, Value >> 8, (uint8_t) Value);
 }
 
 
 /***************************************************************//**
-	 \fn ReadEncoderNullChannel(uint8_t Index)
+	 \fn ReadEncoderNullChannel(TMC424TypeDef *TMC424, uint8_t Index)
 	 \brief Check null channel of an encoder
 	 \param Index  specifies the encoer (0, 1 or 2)
 	 \return State of the N input for the given encoder
@@ -176,7 +205,7 @@ void WriteEncoder(uint8_t Index, int32_t Value)
 	 This function reads the state of the null channel input for an
 	 encoder.
 ********************************************************************/
-uint8_t ReadEncoderNullChannel(uint8_t Index)
+uint8_t ReadEncoderNullChannel(TMC424TypeDef *TMC424, uint8_t Index)
 {
 	uint8_t Read424[4], Write424[4];
 
@@ -184,7 +213,7 @@ uint8_t ReadEncoderNullChannel(uint8_t Index)
 	Write424[1] = 0;
 	Write424[2] = 0;
 	Write424[3] = 0;
-	ReadWrite424(Write424, Read424);
+	ReadWrite424(TMC424, Read424, Write424);
 
 	switch(Index)
 	{
@@ -214,25 +243,29 @@ uint8_t ReadEncoderNullChannel(uint8_t Index)
 
 
 /***************************************************************//**
-	 \fn Init424()
+	 \fn Init424(TMC424TypeDef *TMC424, void *SPIDevice)
 	 \brief Initialize the TMC424
+	 \param SPIDevice  SPI device of this TMC424, passed to ReadWriteSPI()
 
 	 This function does the basic initialization of the TMC424.
 	 The encoder prescalers are set to some example values, and the
 	 encoder counters are cleared.
 ********************************************************************/
-void Init424(void)
+void Init424(TMC424TypeDef *TMC424, void *SPIDevice)
 {
+	TMC424->SPIDevice  = SPIDevice;
+	TMC424->IntCtrl    = 0;
+
 	// Set encoder prescalers to 12.5
-	SetEncoderPrescaler(0, 0xC8, 0);
-	SetEncoderPrescaler(1, 0xC8, 0);
-	SetEncoderPrescaler(2, 0xC8, 0);
+	SetEncoderPrescaler(TMC424, 0, 0xC8, 0);
+	SetEncoderPrescaler(TMC424, 1, 0xC8, 0);
+	SetEncoderPrescaler(TMC424, 2, 0xC8, 0);
 
 	// Switch off interrupts
-	Write423Bytes(TMC424_INT_CTRL, 0, TMC424_CLR_FLAGS, 0, 0);
+	Write424Bytes(TMC424, TMC424_INT_CTRL, TMC424_CLR_FLAGS, 0, 0);
 
 	// Clear encoder counters
-	Write423Bytes(TMC424_ENC_DATA_1, 0, 0, 0, 0);
-	Write423Bytes(TMC424_ENC_DATA_2, 0, 0, 0, 0);
-	Write423Bytes(TMC424_ENC_DATA_3, 0, 0, 0, 0);
+	Write424Bytes(TMC424, TMC424_ENC_DATA_1, 0, 0, 0);
+	Write424Bytes(TMC424, TMC424_ENC_DATA_2, 0, 0, 0);
+	Write424Bytes(TMC424, TMC424_ENC_DATA_3, 0, 0, 0);
 }
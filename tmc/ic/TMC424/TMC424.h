@@ -10,10 +10,23 @@
 	#include "tmc/helpers/API_Header.h"
 	#include "TMC424_Register.h"
 
-	void SetEncoderPrescaler(uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunctionBits);
-	int32_t ReadEncoder(uint8_t Which423, uint8_t Index);
-	void WriteEncoder(uint8_t Index, int32_t Value);
-	uint8_t ReadEncoderNullChannel(uint8_t Which424, uint8_t Index);
-	void Init424(void);
+	// user must provide this function
+	uint8_t ReadWriteSPI(void* p_SPI_DeviceHandle, uint8_t data,bool endTransaction);
+
+	#define TMC424_ENCODERS 3
+
+	// One instance per TMC424
+	typedef struct
+	{
+		void *SPIDevice;  // Passed to ReadWriteSPI()
+		uint8_t IntCtrl;  // Last written TMC424_INT_CTRL bits (without TMC424_FREEZE)
+	} TMC424TypeDef;
+
+	void SetEncoderPrescaler(TMC424TypeDef *TMC424, uint8_t Index, uint32_t Prescaler, uint8_t SpecialFunctionBits);
+	int32_t ReadEncoder(TMC424TypeDef *TMC424, uint8_t Index);
+	void ReadAllEncoders(TMC424TypeDef *TMC424, int32_t *Positions);
+	void WriteEncoder(TMC424TypeDef *TMC424, uint8_t Index, int32_t Value);
+	uint8_t ReadEncoderNullChannel(TMC424TypeDef *TMC424, uint8_t Index);
+	void Init424(TMC424TypeDef *TMC424, void *SPIDevice);
 
 #endif /* TMC_IC_TMC424_H_ */
@@ -17,6 +17,23 @@
 
 #include "TMC429.h"
 
+// PULSE_DIV/RAMP_DIV of each motor, taken from the written datagrams
+static uint8_t PulseRampDivCache[3];
+
+// Status byte of the last SPI access
+static uint8_t StatusCache;
+
+// Clock frequency and its fixed point reciprocals for the unit conversions
+typedef struct
+{
+	uint32_t Mantissa;  // 2^31..2^32-1
+	uint8_t Shift;      // 1 / Divisor = Mantissa / 2^Shift
+} TReciprocal;
+
+static uint32_t ClockFrequency;
+static TReciprocal VelocityReciprocal;      // 1 / fCLK
+static TReciprocal AccelerationReciprocal;  // 1 / fCLK^2
+
 /***************************************************************//**
 	 \fn ReadWrite429(uint8_t *Read, uint8_t *Write)
 	 \brief 32 bit SPI communication with TMC429
@@ -33,6 +50,13 @@ void ReadWrite429(uint8_t *Read, uint8_t *Write)
 	Read[1] = ReadWriteSPI(SPI_DEV_TMC429, Write[1], FALSE);
 	Read[2] = ReadWriteSPI(SPI_DEV_TMC429, Write[2], FALSE);
 	Read[3] = ReadWriteSPI(SPI_DEV_TMC429, Write[3], TRUE);
+
+	// Every datagram returns the status byte
+	StatusCache = Read[0];
+
+	// Keep track of the dividers for SetAMax()
+	if(((Write[0] & 0x9F) == TMC429_IDX_PULSEDIV_RAMPDIV(0)) && ((Write[0] >> 5) < 3))
+		PulseRampDivCache[Write[0] >> 5] = Write[2];
 }
 
 /***************************************************************//**
@@ -144,7 +168,23 @@ void Write429Int(uint8_t Address, int32_t Value)
 ********************************************************************/
 uint8_t Read429Status(void)
 {
-	return ReadWriteSPI(SPI_DEV_TMC429, 0x01, TRUE);
+	StatusCache = ReadWriteSPI(SPI_DEV_TMC429, 0x01, TRUE);
+
+	return StatusCache;
+}
+
+/***************************************************************//**
+	 \fn Get429CachedStatus
+	 \brief Get the last TMC429 status byte
+
+	 \return TMC429 status byte
+
+	 This function returns the status byte received with the last
+	 SPI access without accessing the TMC429.
+********************************************************************/
+uint8_t Get429CachedStatus(void)
+{
+	return StatusCache;
 }
 
 /***************************************************************//**
@@ -211,9 +251,7 @@ int32_t Read429Int12(uint8_t Address)
 	Write[0] = Address | TMC429_READ;
 	ReadWrite429(Read, Write);
 
-	Result = (Read[2]<<8) | Read[3];
-	if(Result & 0x00000800)
-		Result |= 0xFFFFF000;
+	Result = CAST_Sn_TO_S32((Read[2]<<8) | Read[3], 12);
 
 	return Result;
 }
@@ -236,13 +274,50 @@ int32_t Read429Int24(uint8_t Address)
 	Write[0] = Address | TMC429_READ;
 	ReadWrite429(Read, Write);
 
-	Result = (Read[1]<<16) | (Read[2]<<8) | (Read[3]);
-	if(Result & 0x00800000)
-		Result |= 0xFF000000;
+	Result = CAST_Sn_TO_S32((Read[1]<<16) | (Read[2]<<8) | (Read[3]), 24);
 
 	return Result;
 }
 
+/***************************************************************//**
+	 \fn Read429Snapshot(TMC429SnapshotTypeDef *Snapshot)
+	 \brief Read position and velocity of all motors
+	 \param Snapshot  receives X_ACTUAL, V_ACTUAL and the status byte
+
+	 \return TMC429 status byte
+
+	 The TMC429 answers a read access within the same datagram, so the
+	 six datagrams are sent directly after each other and only decoded
+	 afterwards. The status byte of the last datagram is the most
+	 recent one and is stored in the snapshot.
+********************************************************************/
+uint8_t Read429Snapshot(TMC429SnapshotTypeDef *Snapshot)
+{
+	uint8_t Read[6][4], Write[4] = { 0 };
+	uint8_t motor;
+
+	for(motor = 0; motor < 3; motor++)
+	{
+		Write[0] = TMC429_IDX_XACTUAL(motor) | TMC429_READ;
+		ReadWrite429(Read[2*motor], Write);
+		Write[0] = TMC429_IDX_VACTUAL(motor) | TMC429_READ;
+		ReadWrite429(Read[2*motor+1], Write);
+	}
+
+	for(motor = 0; motor < 3; motor++)
+	{
+		uint8_t *x = Read[2*motor];
+		uint8_t *v = Read[2*motor+1];
+
+		Snapshot->XActual[motor] = CAST_Sn_TO_S32((x[1]<<16) | (x[2]<<8) | x[3], 24);
+		Snapshot->VActual[motor] = CAST_Sn_TO_S32((v[2]<<8) | v[3], 12);
+	}
+
+	Snapshot->Status = StatusCache;
+
+	return Snapshot->Status;
+}
+
 /***************************************************************//**
 	 \fn Set429RampMode(uint8_t Axis, uint8_t RampMode)
 	 \brief Set the ramping mode of an axis
@@ -289,6 +364,114 @@ void Set429SwitchMode(uint8_t Axis, uint8_t SwitchMode)
 	ReadWrite429(Read, Write);
 }
 
+/***************************************************************//**
+	 \fn CalcReciprocal(uint64_t Divisor, TReciprocal *Reciprocal)
+	 \brief Calculate a normalized fixed point reciprocal
+	 \param Divisor     divisor (1..2^63)
+	 \param Reciprocal  receives 2^Shift / Divisor in 32 bits
+
+	 This is a binary long division, so it also works for the 64 bit
+	 square of the clock frequency.
+********************************************************************/
+static void CalcReciprocal(uint64_t Divisor, TReciprocal *Reciprocal)
+{
+	uint64_t Remainder = 1;
+	uint8_t Bits = 0;
+	uint8_t i;
+
+	// 2^(Bits-1) < Divisor <= 2^Bits
+	while((Remainder << Bits) < Divisor)
+		Bits++;
+
+	Remainder <<= Bits;
+	Reciprocal->Mantissa = 1;
+	Remainder -= Divisor;
+
+	for(i = 0; i < 31; i++)
+	{
+		Remainder <<= 1;
+		Reciprocal->Mantissa <<= 1;
+		if(Remainder >= Divisor)
+		{
+			Remainder -= Divisor;
+			Reciprocal->Mantissa |= 1;
+		}
+	}
+
+	Reciprocal->Shift = Bits + 31;
+}
+
+/***************************************************************//**
+	 \fn Scale(uint32_t Value, uint8_t Exponent, const TReciprocal *Reciprocal)
+	 \brief Calculate Value * 2^Exponent * Reciprocal
+	 \param Value       value to convert
+	 \param Exponent    power of two of the divider settings
+	 \param Reciprocal  reciprocal of the clock frequency (squared)
+
+	 The result is rounded and limited to the 11 bit range of the
+	 VMAX and AMAX registers.
+********************************************************************/
+static uint32_t Scale(uint32_t Value, uint8_t Exponent, const TReciprocal *Reciprocal)
+{
+	uint64_t Result = (uint64_t) Value * Reciprocal->Mantissa;
+
+	if(Reciprocal->Mantissa == 0)
+		return 0;
+
+	if(Exponent >= Reciprocal->Shift)
+		return (Value == 0) ? 0 : 2047;
+
+	Exponent = Reciprocal->Shift - Exponent - 1;
+	if(Exponent >= 64)
+		return 0;
+
+	Result = ((Result >> Exponent) + 1) >> 1;
+
+	return (Result > 2047) ? 2047 : Result;
+}
+
+/***************************************************************//**
+	 \fn CalcPMulPDiv(uint8_t PulseRampDiv, uint32_t AMax, uint8_t *Data)
+	 \brief Calculate the PMUL and PDIV values for an acceleration
+	 \param PulseRampDiv  PULSE_DIV (high nibble) and RAMP_DIV (low nibble)
+	 \param AMax          maximum acceleration (0..2047)
+	 \param Data          three byte array receiving the PMUL_PDIV register
+
+	 PMUL = 128..255 and PDIV = 0..13 have to fulfill
+	 PMUL / 2^(PDIV+3) = 0.988 * AMax / 2^(RAMP_DIV-PULSE_DIV+7).
+	 Only one PDIV can put PMUL into its range: The one that normalizes
+	 0.988 * AMax * 2^(PULSE_DIV-RAMP_DIV+PDIV+3) / 128 into 128..255.
+	 The factor 0.988 is kept exact as 988/1000, so this gives the same
+	 result as the former floating point search. PMUL = PDIV = 0xFF
+	 indicates that no valid pair exists.
+********************************************************************/
+static void CalcPMulPDiv(uint8_t PulseRampDiv, uint32_t AMax, uint8_t *Data)
+{
+	// 988 * AMax * 2^(PDIV+3+PULSE_DIV-RAMP_DIV) / 128000 = PMUL
+	uint32_t Numerator = 988 * AMax;
+	int32_t pdiv = (int32_t) (PulseRampDiv & 0x0F) - (PulseRampDiv >> 4) - 3;
+
+	Data[0] = 0;
+	Data[1] = 0xFF;
+	Data[2] = 0xFF;
+
+	if(Numerator == 0)
+		return;
+
+	// Normalize to PMUL >= 128 (988 * 2047 < 128 * 128000, so this always shifts left)
+	while(Numerator < 128 * 128000UL)
+	{
+		Numerator <<= 1;
+		pdiv++;
+	}
+
+	if((pdiv < 0) || (pdiv > 13))
+		return;
+
+	Data[1] = Numerator / 128000UL;
+	Data[2] = pdiv;
+}
+
 /***************************************************************//**
 	 \fn SetAMax(uint8_t Motor, uint32_t AMax)
 	 \brief Set the maximum acceleration
@@ -298,51 +481,179 @@ void Set429SwitchMode(uint8_t Axis, uint8_t SwitchMode)
 	 This function sets the maximum acceleration and also calculates
 	 the PMUL and PDIV value according to all other parameters
 	 (please see the TMC429 data sheet for more info about PMUL and PDIV
-	 values).
+	 values). The PULSE_DIV and RAMP_DIV values are the ones last written
+	 to the TMC429, so no register has to be read back.
 ********************************************************************/
 uint8_t SetAMax(uint8_t Motor, uint32_t AMax)
 {
-	int32_t pm, pd;
-	float p, p_reduced;
-	int32_t ramp_div;
-	int32_t pulse_div;
-	uint8_t PulseRampDiv;
 	uint8_t Data[3];
 
+	if(Motor >= 3)
+		return 1;
+
 	AMax &= 0x000007FF;
-	Read429Bytes(TMC429_IDX_PULSEDIV_RAMPDIV(Motor), Data);
-	PulseRampDiv = Data[1];
-	pulse_div = PulseRampDiv >> 4;
-	ramp_div = PulseRampDiv & 0x0F;
+	CalcPMulPDiv(PulseRampDivCache[Motor], AMax, Data);
+	Write429Bytes(TMC429_IDX_PMUL_PDIV(Motor), Data);
+	Write429U16(TMC429_IDX_AMAX(Motor), AMax);
 
-	// -1 indicates : no valid pair found
-	pm = -1;
-	pd = -1;
+	return 0;
+}
 
-	if(ramp_div >= pulse_div)
-		p = AMax / ( 128.0 * (1<<(ramp_div-pulse_div)));  // Exponent positive or 0
-	else
-		p = AMax / ( 128.0 / (1<<(pulse_div-ramp_div)));  // Exponent negative
+/***************************************************************//**
+	 \fn SetAMaxAll(uint32_t *AMax)
+	 \brief Set the maximum acceleration of all motors
+	 \param AMax: array of three maximum accelerations (1..2047)
+
+	 This function works like SetAMax() for all three motors. The PMUL
+	 and PDIV values of all motors are calculated before the first
+	 register is written, so the accelerations change with six directly
+	 following datagrams.
+********************************************************************/
+uint8_t SetAMaxAll(uint32_t *AMax)
+{
+	uint8_t Data[3][3];
+	uint8_t motor;
 
-	p_reduced = p*0.988;
+	for(motor = 0; motor < 3; motor++)
+		CalcPMulPDiv(PulseRampDivCache[motor], AMax[motor] & 0x000007FF, Data[motor]);
 
-	int32_t pdiv;
-	for(pdiv = 0; pdiv <= 13; pdiv++)
+	for(motor = 0; motor < 3; motor++)
 	{
-		int32_t pmul = (int32_t) (p_reduced * 8.0 * (1<<pdiv)) - 128;
+		Write429Bytes(TMC429_IDX_PMUL_PDIV(motor), Data[motor]);
+		Write429U16(TMC429_IDX_AMAX(motor), AMax[motor] & 0x000007FF);
+	}
 
-		if((0 <= pmul) && (pmul <= 127))
-		{
-			pm = pmul + 128;
-			pd = pdiv;
-		}
+	return 0;
+}
+
+/***************************************************************//**
+	 \fn Set429Clock(uint32_t Frequency)
+	 \brief Set the clock frequency for the unit conversions
+	 \param Frequency  clock frequency of the TMC429 in Hz
+
+	 The conversions between steps/s (steps/s^2) and the internal
+	 velocity (acceleration) units multiply with a fixed point
+	 reciprocal of the clock frequency (squared) that is calculated
+	 here once, so they need no division. Init429() sets 16MHz if no
+	 clock frequency has been set before.
+********************************************************************/
+void Set429Clock(uint32_t Frequency)
+{
+	ClockFrequency = Frequency;
+	CalcReciprocal(Frequency, &VelocityReciprocal);
+	CalcReciprocal((uint64_t) Frequency * Frequency, &AccelerationReciprocal);
+}
+
+/***************************************************************//**
+	 \fn Calc429V(uint8_t Motor, uint32_t Velocity)
+	 \brief Convert a velocity from steps/s into TMC429 units
+	 \param Motor  motor number (0, 1, 2)
+	 \param Velocity  velocity in steps/s
+
+	 V = Velocity * 2^(PULSE_DIV+16) / fCLK, rounded and limited to
+	 0..2047. PULSE_DIV is the one last written to the TMC429.
+********************************************************************/
+uint32_t Calc429V(uint8_t Motor, uint32_t Velocity)
+{
+	if(Motor >= 3)
+		return 0;
+
+	return Scale(Velocity, (PulseRampDivCache[Motor] >> 4) + 16, &VelocityReciprocal);
+}
+
+/***************************************************************//**
+	 \fn Calc429Velocity(uint8_t Motor, uint32_t V)
+	 \brief Convert a velocity from TMC429 units into steps/s
+	 \param Motor  motor number (0, 1, 2)
+	 \param V  velocity in TMC429 units (0..2047)
+********************************************************************/
+uint32_t Calc429Velocity(uint8_t Motor, uint32_t V)
+{
+	if(Motor >= 3)
+		return 0;
+
+	return ((uint64_t) V * ClockFrequency) >> ((PulseRampDivCache[Motor] >> 4) + 16);
+}
+
+/***************************************************************//**
+	 \fn Calc429A(uint8_t Motor, uint32_t Acceleration)
+	 \brief Convert an acceleration from steps/s^2 into TMC429 units
+	 \param Motor  motor number (0, 1, 2)
+	 \param Acceleration  acceleration in steps/s^2
+
+	 A = Acceleration * 2^(PULSE_DIV+RAMP_DIV+29) / fCLK^2, rounded and
+	 limited to 0..2047.
+********************************************************************/
+uint32_t Calc429A(uint8_t Motor, uint32_t Acceleration)
+{
+	if(Motor >= 3)
+		return 0;
+
+	return Scale(Acceleration, (PulseRampDivCache[Motor] >> 4) + (PulseRampDivCache[Motor] & 0x0F) + 29, &AccelerationReciprocal);
+}
+
+/***************************************************************//**
+	 \fn Calc429Acceleration(uint8_t Motor, uint32_t A)
+	 \brief Convert an acceleration from TMC429 units into steps/s^2
+	 \param Motor  motor number (0, 1, 2)
+	 \param A  acceleration in TMC429 units (0..2047)
+********************************************************************/
+uint32_t Calc429Acceleration(uint8_t Motor, uint32_t A)
+{
+	if(Motor >= 3)
+		return 0;
+
+	return ((uint64_t) A * ClockFrequency * ClockFrequency) >> ((PulseRampDivCache[Motor] >> 4) + (PulseRampDivCache[Motor] & 0x0F) + 29);
+}
+
+/***************************************************************//**
+	 \fn SetVMaxAll(uint32_t *VMax)
+	 \brief Set the maximum velocity of all motors
+	 \param VMax: array of three maximum velocities (0..2047)
+
+	 The three VMAX registers are written with directly following
+	 datagrams.
+********************************************************************/
+uint8_t SetVMaxAll(uint32_t *VMax)
+{
+	uint8_t motor;
+
+	for(motor = 0; motor < 3; motor++)
+		Write429U24(TMC429_IDX_VMAX(motor), VMax[motor] & 0x000007FF);
+
+	return 0;
+}
+
+/***************************************************************//**
+	 \fn Set429RampAll(const uint32_t *Velocity, const uint32_t *Acceleration)
+	 \brief Set the maximum velocity and acceleration of all motors
+	 \param Velocity      array of three maximum velocities in steps/s
+	 \param Acceleration  array of three maximum accelerations in steps/s^2
+
+	 All VMAX, AMAX, PMUL and PDIV values are calculated with the
+	 current divider settings before the first register is written.
+	 The nine registers are then written in one pass.
+********************************************************************/
+uint8_t Set429RampAll(const uint32_t *Velocity, const uint32_t *Acceleration)
+{
+	uint32_t VMax[3];
+	uint32_t AMax[3];
+	uint8_t Data[3][3];
+	uint8_t motor;
+
+	for(motor = 0; motor < 3; motor++)
+	{
+		VMax[motor] = Calc429V(motor, Velocity[motor]);
+		AMax[motor] = Calc429A(motor, Acceleration[motor]);
+		CalcPMulPDiv(PulseRampDivCache[motor], AMax[motor], Data[motor]);
 	}
 
-	Data[0] = 0;
-	Data[1] = (uint8_t) pm;
-	Data[2] = (uint8_t) pd;
-	Write429Bytes(TMC429_IDX_PMUL_PDIV(Motor), Data);
-	Write429U16(TMC429_IDX_AMAX(Motor), AMax);
+	for(motor = 0; motor < 3; motor++)
+	{
+		Write429U24(TMC429_IDX_VMAX(motor), VMax[motor]);
+		Write429Bytes(TMC429_IDX_PMUL_PDIV(motor), Data[motor]);
+		Write429U16(TMC429_IDX_AMAX(motor), AMax[motor]);
+	}
 
 	return 0;
 }
@@ -373,6 +684,10 @@ void HardStop(uint32_t Motor)
 void Init429(void)
 {
 	uint8_t motor;
+
+	if(ClockFrequency == 0)
+		Set429Clock(16000000);
+
 	for(motor = 0; motor < 3; motor++)
 	{
 		uint32_t addr;
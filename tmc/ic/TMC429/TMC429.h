@@ -10,6 +10,14 @@
 	#include "tmc/helpers/API_Header.h"
 	#include "TMC429_Register.h"
 
+	// Position and velocity of all motors, see Read429Snapshot()
+	typedef struct
+	{
+		int32_t XActual[3];
+		int32_t VActual[3];
+		uint8_t Status;
+	} TMC429SnapshotTypeDef;
+
 	// user must provide this function
 	uint8_t ReadWriteSPI(void* p_SPI_DeviceHandle, uint8_t data,bool endTransaction);
 
@@ -22,13 +30,23 @@
 	void Write429U16(uint8_t Address, uint16_t Value);
 	void Write429U24(uint8_t Address, uint32_t Value);
 	uint8_t Read429Status(void);
+	uint8_t Get429CachedStatus(void);
 	uint8_t Read429Bytes(uint8_t Address, uint8_t *Bytes);
 	uint8_t Read429SingleByte(uint8_t Address, uint8_t Index);
 	int32_t Read429Int12(uint8_t Address);
 	int32_t Read429Int24(uint8_t Address);
+	uint8_t Read429Snapshot(TMC429SnapshotTypeDef *Snapshot);
 	void Set429RampMode(uint8_t Axis, uint8_t RampMode);
 	void Set429SwitchMode(uint8_t Axis, uint8_t SwitchMode);
 	uint8_t SetAMax(uint8_t Motor, uint32_t AMax);
+	uint8_t SetAMaxAll(uint32_t *AMax);
+	uint8_t SetVMaxAll(uint32_t *VMax);
+	void Set429Clock(uint32_t Frequency);
+	uint32_t Calc429V(uint8_t Motor, uint32_t Velocity);
+	uint32_t Calc429Velocity(uint8_t Motor, uint32_t V);
+	uint32_t Calc429A(uint8_t Motor, uint32_t Acceleration);
+	uint32_t Calc429Acceleration(uint8_t Motor, uint32_t A);
+	uint8_t Set429RampAll(const uint32_t *Velocity, const uint32_t *Acceleration);
 	void HardStop(uint32_t Motor);
 
 #endif /* TMC_IC_TMC429_H_ */
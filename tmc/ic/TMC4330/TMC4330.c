@@ -13,106 +13,61 @@
 extern void tmc4330_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
 // <= SPI wrapper
 
+static const TMC43xxVariantTypeDef variant =
+{
+	.spi                    = { .readWriteArray = tmc4330_readWriteArray, TMC_INSTRUMENT_NAME("TMC4330") },
+	.defaultRegisterAccess  = tmc4330_defaultRegisterAccess,
+	.resettableRegisters    = tmc4330_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc4330_resettableRegisters),
+	.restorableRegisters    = tmc4330_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc4330_restorableRegisters),
+	.constants              = NULL,
+	.constantCount          = 0,
+	.features               = TMC43XX_FEATURE_CLOSED_LOOP,
+};
+
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
 void tmc4330_writeDatagram(TMC4330TypeDef *tmc4330, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
-	int value;
-	uint8_t data[5] = { address | TMC4330_WRITE_BIT, x1, x2, x3, x4 };
-
-	tmc4330_readWriteArray(tmc4330->config->channel, &data[0], 5);
-
-	tmc4330->status = data[0];
-
-	value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
-
-	// Write to the shadow register and mark the register dirty
-	address = TMC_ADDRESS(address);
-	tmc4330->config->shadowRegister[address] = value;
-	tmc4330->registerAccess[address] |= TMC_ACCESS_DIRTY;
+	tmc43xx_core_writeDatagram(tmc4330, address, x1, x2, x3, x4);
 }
 
 void tmc4330_writeInt(TMC4330TypeDef *tmc4330, uint8_t address, int32_t value)
 {
-	tmc4330_writeDatagram(tmc4330, address, BYTE(value, 3), BYTE(value, 2), BYTE(value, 1), BYTE(value, 0));
+	tmc43xx_core_writeInt(tmc4330, address, value);
 }
 
 int32_t tmc4330_readInt(TMC4330TypeDef *tmc4330, uint8_t address)
 {
-	int value;
-	uint8_t data[5];
-
-	address = TMC_ADDRESS(address);
-
-	if(!TMC_IS_READABLE(tmc4330->registerAccess[address]))
-		return tmc4330->config->shadowRegister[address];
-
-	data[0] = address;
-	tmc4330_readWriteArray(tmc4330->config->channel, &data[0], 5);
-
-	data[0] = address;
-	tmc4330_readWriteArray(tmc4330->config->channel, &data[0], 5);
-
-	tmc4330->status = data[0];
-	value = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+	return tmc43xx_core_readInt(tmc4330, address);
+}
 
-	return value;
+// Read multiple registers with pipelined datagrams, see tmc43xx_core_readIntBatch()
+void tmc4330_readIntBatch(TMC4330TypeDef *tmc4330, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	tmc43xx_core_readIntBatch(tmc4330, addresses, values, count);
 }
 
 // Provide the init function with a channel index (sent back in the SPI callback), a pointer to a ConfigurationTypeDef struct
 // and a pointer to a int32_t array (size 128) holding the reset values that shall be used.
 void tmc4330_init(TMC4330TypeDef *tmc4330, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
 {
-	tmc4330->velocity  = 0;
-	tmc4330->oldTick   = 0;
-	tmc4330->oldX      = 0;
-	tmc4330->config    = config;
-
-	tmc4330->config->callback     = NULL;
-	tmc4330->config->channel      = channel;
-	tmc4330->config->configIndex  = 0;
-	tmc4330->config->state        = CONFIG_READY;
-
-	int i;
-	for(i = 0; i < TMC4330_REGISTER_COUNT; i++)
-	{
-		tmc4330->registerAccess[i]      = tmc4330_defaultRegisterAccess[i];
-		tmc4330->registerResetState[i]  = registerResetState[i];
-	}
+	tmc43xx_core_init(tmc4330, &variant, channel, config, registerResetState);
 }
 
 uint8_t tmc4330_reset(TMC4330TypeDef *tmc4330)
 {
-	if(tmc4330->config->state != CONFIG_READY)
-		return 0;
-
-	int i;
-
-	// Reset the dirty bits
-	for(i = 0; i < TMC4330_REGISTER_COUNT; i++)
-		tmc4330->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-
-	tmc4330->config->state        = CONFIG_RESET;
-	tmc4330->config->configIndex  = 0;
-
-	return 1;
+	return tmc43xx_core_reset(tmc4330);
 }
 
 uint8_t tmc4330_restore(TMC4330TypeDef *tmc4330)
 {
-	if(tmc4330->config->state != CONFIG_READY)
-		return 0;
-
-	tmc4330->config->state        = CONFIG_RESTORE;
-	tmc4330->config->configIndex  = 0;
-
-	return 1;
+	return tmc43xx_core_restore(tmc4330);
 }
 
 void tmc4330_setRegisterResetState(TMC4330TypeDef *tmc4330, const int32_t *resetState)
 {
-	uint32_t i;
-	for(i = 0; i < TMC4330_REGISTER_COUNT; i++)
-		tmc4330->registerResetState[i] = resetState[i];
+	tmc43xx_core_setRegisterResetState(tmc4330, resetState);
 }
 
 void tmc4330_setCallback(TMC4330TypeDef *tmc4330, tmc4330_callback callback)
@@ -120,204 +75,111 @@ void tmc4330_setCallback(TMC4330TypeDef *tmc4330, tmc4330_callback callback)
 	tmc4330->config->callback = (tmc_callback_config) callback;
 }
 
-static void tmc4330_writeConfiguration(TMC4330TypeDef *tmc4330)
+TMCConfigStatus tmc4330_periodicJob(TMC4330TypeDef *tmc4330, uint32_t tick)
 {
-	uint8_t *ptr = &tmc4330->config->configIndex;
-	const int32_t *settings;
-
-	if(tmc4330->config->state == CONFIG_RESTORE)
-	{
-		settings = &tmc4330->config->shadowRegister[0];
-		// Find the next restorable register
-		while((*ptr < TMC4330_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc4330->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-	else
-	{
-		settings = &tmc4330->registerResetState[0];
-		// Find the next resettable register
-		while((*ptr < TMC4330_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc4330->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-
-	if (*ptr < TMC4330_REGISTER_COUNT) {
-		tmc4330_writeInt(tmc4330, *ptr, settings[*ptr]);
-		(*ptr)++;
-	}
-	else
-	{
-		if(tmc4330->config->callback)
-		{
-			((tmc4330_callback)tmc4330->config->callback)(tmc4330, tmc4330->config->state);
-		}
-
-		tmc4330->config->state = CONFIG_READY;
-	}
+	return tmc43xx_core_periodicJob(tmc4330, tick);
 }
 
-void tmc4330_periodicJob(TMC4330TypeDef *tmc4330, uint32_t tick)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc4330_configureBurst(TMC4330TypeDef *tmc4330, uint32_t maxSteps)
 {
-	if(tmc4330->config->state != CONFIG_READY)
-	{
-		tmc4330_writeConfiguration(tmc4330);
-		return;
-	}
+	return tmc43xx_core_configureBurst(tmc4330, maxSteps);
+}
 
-	if((tick - tmc4330->oldTick) != 0)
-	{
-		tmc4330_calibrateClosedLoop(tmc4330, 0);
-		tmc4330->oldTick = tick;
-	}
+// Event driven status, see tmc43xx_core_onInterrupt()
+uint8_t tmc4330_onInterrupt(TMC4330TypeDef *tmc4330)
+{
+	return tmc43xx_core_onInterrupt(tmc4330);
 }
 
 void tmc4330_rotate(TMC4330TypeDef *tmc4330, int32_t velocity)
 {
-	// Disable Position Mode
-	TMC4330_FIELD_UPDATE(tmc4330, TMC4330_RAMPMODE, TMC4330_OPERATION_MODE_MASK, TMC4330_OPERATION_MODE_SHIFT, 0);
-
-	tmc4330_writeInt(tmc4330, TMC4330_VMAX, tmc4330_discardVelocityDecimals(velocity));
+	tmc43xx_core_rotate(tmc4330, velocity);
 }
 
 void tmc4330_right(TMC4330TypeDef *tmc4330, int32_t velocity)
 {
-	tmc4330_rotate(tmc4330, velocity);
+	tmc43xx_core_rotate(tmc4330, velocity);
 }
 
 void tmc4330_left(TMC4330TypeDef *tmc4330, int32_t velocity)
 {
-	tmc4330_rotate(tmc4330, -velocity);
+	tmc43xx_core_rotate(tmc4330, -velocity);
 }
 
 void tmc4330_stop(TMC4330TypeDef *tmc4330)
 {
-	tmc4330_rotate(tmc4330, 0);
+	tmc43xx_core_rotate(tmc4330, 0);
 }
 
 void tmc4330_moveTo(TMC4330TypeDef *tmc4330, int32_t position, uint32_t velocityMax)
 {
-	// Enable Position Mode
-	TMC4330_FIELD_UPDATE(tmc4330, TMC4330_RAMPMODE, TMC4330_OPERATION_MODE_MASK, TMC4330_OPERATION_MODE_SHIFT, 1);
-
-	tmc4330_writeInt(tmc4330, TMC4330_VMAX, tmc4330_discardVelocityDecimals(velocityMax));
-
-	tmc4330_writeInt(tmc4330, TMC4330_X_TARGET, position);
+	tmc43xx_core_moveTo(tmc4330, position, velocityMax);
 }
 
 // The function will write the absolute target position to *ticks
 void tmc4330_moveBy(TMC4330TypeDef *tmc4330, int32_t *ticks, uint32_t velocityMax)
 {
-	// determine actual position and add numbers of ticks to move
-	*ticks += tmc4330_readInt(tmc4330, TMC4330_XACTUAL);
+	tmc43xx_core_moveBy(tmc4330, ticks, velocityMax);
+}
 
-	tmc4330_moveTo(tmc4330, *ticks, velocityMax);
+// Move queue, see tmc43xx_core_moveQueueService()
+void tmc4330_moveQueueInit(TMC4330MoveQueueTypeDef *queue)
+{
+	tmc43xx_core_moveQueueInit(queue);
 }
 
-int32_t tmc4330_discardVelocityDecimals(int32_t value)
+// Returns false if the queue is full
+bool tmc4330_moveQueuePush(TMC4330MoveQueueTypeDef *queue, const TMC4330MoveTypeDef *move)
 {
-	if(abs(value) > 8000000)
-	{
-		value = (value < 0) ? -8000000 : 8000000;
-	}
-	return value << 8;
+	return tmc43xx_core_moveQueuePush(queue, move);
 }
 
-static uint8_t tmc4330_moveToNextFullstep(TMC4330TypeDef *tmc4330)
+void tmc4330_moveQueueService(TMC4330TypeDef *tmc4330, TMC4330MoveQueueTypeDef *queue)
 {
-	int32_t stepCount;
+	tmc43xx_core_moveQueueService(tmc4330, queue);
+}
 
-	// Motor must be stopped
-	if(tmc4330_readInt(tmc4330, TMC4330_VACTUAL) != 0)
-	{
-		// Not stopped
-		return 0;
-	}
+// Returns true once all queued moves are finished
+bool tmc4330_moveQueueIsDone(TMC4330MoveQueueTypeDef *queue)
+{
+	return tmc43xx_core_moveQueueIsDone(queue);
+}
 
-	// Position mode, hold mode, low velocity
-	tmc4330_writeInt(tmc4330, TMC4330_RAMPMODE, 4);
-	tmc4330_writeInt(tmc4330, TMC4330_VMAX, 10000 << 8);
+// Start group, see tmc43xx_core_startGroupInit()
+void tmc4330_startGroupInit(TMC4330StartGroupTypeDef *group, TMC4330TypeDef **axes, uint8_t count)
+{
+	tmc43xx_core_startGroupInit(group, axes, count);
+}
 
-	// Current step count
-	stepCount = TMC4330_FIELD_READ(tmc4330, TMC4330_MSCNT_RD, TMC4330_MSCNT_MASK, TMC4330_MSCNT_SHIFT);
-	// Get microstep value of step count (lowest 8 bits)
-	stepCount = stepCount % 256;
-	// Assume: 256 microsteps -> Fullsteps are at 128 + n*256
-	stepCount = 128 - stepCount;
+// Hold back XTARGET writes of all axes until the START signal
+void tmc4330_startGroupArm(TMC4330StartGroupTypeDef *group)
+{
+	tmc43xx_core_startGroupArm(group);
+}
 
-	if(stepCount == 0)
-	{
-		// Fullstep reached
-		return 1;
-	}
+// Preload a move of [axis], it starts with the next START signal
+void tmc4330_startGroupPreload(TMC4330StartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax)
+{
+	tmc43xx_core_startGroupPreload(group, axis, position, velocityMax);
+}
 
-	// Fullstep not reached -> calculate next fullstep position
-	stepCount += tmc4330_readInt(tmc4330, TMC4330_XACTUAL);
-	// Move to next fullstep position
-	tmc4330_writeInt(tmc4330, TMC4330_X_TARGET, stepCount);
+// Restore the START_CONF of all axes
+void tmc4330_startGroupDisarm(TMC4330StartGroupTypeDef *group)
+{
+	tmc43xx_core_startGroupDisarm(group);
+}
 
-	return 0;
+int32_t tmc4330_discardVelocityDecimals(int32_t value)
+{
+	return tmc43xx_core_discardVelocityDecimals(value);
 }
 
 uint8_t tmc4330_calibrateClosedLoop(TMC4330TypeDef *tmc4330, uint8_t worker0master1)
 {
-	static uint8_t state = 0;
-	static uint32_t oldRamp;
-
-	uint32_t amax = 0;
-	uint32_t dmax = 0;
-
-	if(worker0master1 && state == 0)
-		state = 1;
-
-	switch(state)
-	{
-	case 1:
-		amax = tmc4330_readInt(tmc4330, TMC4330_AMAX);
-		dmax = tmc4330_readInt(tmc4330, TMC4330_DMAX);
-
-		// Set ramp and motion parameters
-		oldRamp = tmc4330_readInt(tmc4330, TMC4330_RAMPMODE);
-		tmc4330_writeInt(tmc4330, TMC4330_RAMPMODE, TMC4330_RAMP_POSITION | TMC4330_RAMP_HOLD);
-		tmc4330_writeInt(tmc4330, TMC4330_AMAX, MAX(amax, 1000));
-		tmc4330_writeInt(tmc4330, TMC4330_DMAX, MAX(dmax, 1000));
-		tmc4330_writeInt(tmc4330, TMC4330_VMAX, 0);
-
-		state = 2;
-		break;
-	case 2:
-		// Clear encoder calibration bit
-		TMC4330_FIELD_UPDATE(tmc4330, TMC4330_ENC_IN_CONF, TMC4330_CL_CALIBRATION_EN_MASK, TMC4330_CL_CALIBRATION_EN_SHIFT, 0);
-
-		// Disable internal data regulation for closed loop operation in encoder config
-		TMC4330_FIELD_UPDATE(tmc4330, TMC4330_ENC_IN_CONF, TMC4330_REGULATION_MODUS_MASK, TMC4330_REGULATION_MODUS_SHIFT, 1);
-
-		if(tmc4330_moveToNextFullstep(tmc4330)) // move to next fullstep, motor must be stopped, poll until finished
-			state = 3;
-		break;
-	case 3:
-		// Start encoder calibration
-		TMC4330_FIELD_UPDATE(tmc4330, TMC4330_ENC_IN_CONF, TMC4330_CL_CALIBRATION_EN_MASK, TMC4330_CL_CALIBRATION_EN_SHIFT, 1);
-
-		state = 4;
-		break;
-	case 4:
-		if(worker0master1)
-			break;
-
-		// Stop encoder calibration
-		TMC4330_FIELD_UPDATE(tmc4330, TMC4330_ENC_IN_CONF, TMC4330_CL_CALIBRATION_EN_MASK, TMC4330_CL_CALIBRATION_EN_SHIFT, 0);
-		// Enable closed loop in encoder config
-		TMC4330_FIELD_UPDATE(tmc4330, TMC4330_ENC_IN_CONF, TMC4330_REGULATION_MODUS_MASK, TMC4330_REGULATION_MODUS_SHIFT, 1);
-		// Restore old ramp mode, enable position mode
-		tmc4330_writeInt(tmc4330, TMC4330_RAMPMODE, TMC4330_RAMP_POSITION | oldRamp);
-
-		state = 5;
-		break;
-	case 5:
-		state = 0;
-		return 1;
-		break;
-	default:
-		break;
-	}
-	return 0;
+	return tmc43xx_core_calibrateClosedLoop(tmc4330, worker0master1);
 }
@@ -9,6 +9,7 @@
 #define TMC_IC_TMC4330_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ic/TMC43xx/TMC43xx_Core.h"
 #include "TMC4330_Register.h"
 #include "TMC4330_Constants.h"
 #include "TMC4330_Fields.h"
@@ -20,18 +21,12 @@
 	(tmc4330_writeInt(tdef, address, FIELD_SET(tmc4330_readInt(tdef, address), mask, shift, value)))
 
 // Typedefs
-typedef struct
-{
-	ConfigurationTypeDef *config;
-	int velocity;
-	int oldX;
-	uint32_t oldTick;
-	int32_t registerResetState[TMC4330_REGISTER_COUNT];
-	uint8_t registerAccess[TMC4330_REGISTER_COUNT];
-	//TMotorConfig motorConfig;
-	//TClosedLoopConfig closedLoopConfig;
-	uint8_t status;
-} TMC4330TypeDef;
+// The TMC43xx variants share one core, see tmc/ic/TMC43xx/TMC43xx_Core.h
+typedef TMC43xxCoreTypeDef TMC4330TypeDef;
+
+typedef TMC43xxMoveTypeDef TMC4330MoveTypeDef;
+typedef TMC43xxMoveQueueTypeDef TMC4330MoveQueueTypeDef;
+typedef TMC43xxStartGroupTypeDef TMC4330StartGroupTypeDef;
 
 typedef void (*tmc4330_callback)(TMC4330TypeDef*, ConfigState);
 
@@ -79,6 +74,32 @@ static const uint8_t tmc4330_defaultRegisterAccess[TMC4330_REGISTER_COUNT] =
 	0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x01, 0x01, 0x01, 0x02, 0x02, 0x42, 0x01  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc4330_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc4330_resettableRegisters[] =
+{
+	0x01, 0x02, 0x03, 0x05, 0x08, 0x0C, 0x0D, 0x0E, 0x10, 0x11, 0x13, 0x14, 0x15, 0x17, 0x1E, 0x20,
+	0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x32, 0x33,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43,
+	0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4F, 0x50, 0x51, 0x52, 0x54, 0x59,
+	0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60, 0x61, 0x63, 0x68, 0x69, 0x7C, 0x7D
+};
+
+static const uint8_t tmc4330_restorableRegisters[] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x05, 0x07, 0x08, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x10, 0x11, 0x12, 0x13,
+	0x14, 0x15, 0x17, 0x1C, 0x1E, 0x1F, 0x20, 0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B,
+	0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+	0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B,
+	0x4C, 0x4D, 0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D,
+	0x5E, 0x5F, 0x60, 0x61, 0x62, 0x63, 0x68, 0x69, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77,
+	0x78, 0x7C, 0x7D, 0x7E
+};
+
 
 // API Functions
 // All functions act on one IC given by the TMC4330TypeDef struct
@@ -87,7 +108,7 @@ static const uint8_t tmc4330_defaultRegisterAccess[TMC4330_REGISTER_COUNT] =
 void tmc4330_writeDatagram(TMC4330TypeDef *tmc4330, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc4330_writeInt(TMC4330TypeDef *tmc4330, uint8_t address, int32_t value);
 int32_t tmc4330_readInt(TMC4330TypeDef *tmc4330, uint8_t address);
-void tmc4330_readWriteCover(TMC4330TypeDef *tmc4330, uint8_t *data, size_t length);
+void tmc4330_readIntBatch(TMC4330TypeDef *tmc4330, const uint8_t *addresses, int32_t *values, size_t count);
 
 // Configuration
 void tmc4330_init(TMC4330TypeDef *tmc4330, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
@@ -95,7 +116,19 @@ uint8_t tmc4330_reset(TMC4330TypeDef *tmc4330);
 uint8_t tmc4330_restore(TMC4330TypeDef *tmc4330);
 void tmc4330_setRegisterResetState(TMC4330TypeDef *tmc4330, const int32_t *resetState);
 void tmc4330_setCallback(TMC4330TypeDef *tmc4330, tmc4330_callback callback);
-void tmc4330_periodicJob(TMC4330TypeDef *tmc4330, uint32_t tick);
+TMCConfigStatus tmc4330_periodicJob(TMC4330TypeDef *tmc4330, uint32_t tick);
+uint8_t tmc4330_configureBurst(TMC4330TypeDef *tmc4330, uint32_t maxSteps);
+uint8_t tmc4330_onInterrupt(TMC4330TypeDef *tmc4330);
+
+void tmc4330_moveQueueInit(TMC4330MoveQueueTypeDef *queue);
+bool tmc4330_moveQueuePush(TMC4330MoveQueueTypeDef *queue, const TMC4330MoveTypeDef *move);
+void tmc4330_moveQueueService(TMC4330TypeDef *tmc4330, TMC4330MoveQueueTypeDef *queue);
+bool tmc4330_moveQueueIsDone(TMC4330MoveQueueTypeDef *queue);
+
+void tmc4330_startGroupInit(TMC4330StartGroupTypeDef *group, TMC4330TypeDef **axes, uint8_t count);
+void tmc4330_startGroupArm(TMC4330StartGroupTypeDef *group);
+void tmc4330_startGroupPreload(TMC4330StartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax);
+void tmc4330_startGroupDisarm(TMC4330StartGroupTypeDef *group);
 
 // Motion
 void tmc4330_rotate(TMC4330TypeDef *tmc4330, int32_t velocity);
@@ -13,163 +13,75 @@
 extern void tmc4331_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
 // <= SPI wrapper
 
+static const TMC43xxVariantTypeDef variant =
+{
+	.spi                    = { .readWriteArray = tmc4331_readWriteArray, TMC_INSTRUMENT_NAME("TMC4331") },
+	.defaultRegisterAccess  = tmc4331_defaultRegisterAccess,
+	.resettableRegisters    = tmc4331_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc4331_resettableRegisters),
+	.restorableRegisters    = tmc4331_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc4331_restorableRegisters),
+	.constants              = NULL,
+	.constantCount          = 0,
+	.features               = TMC43XX_FEATURE_COVER,
+};
+
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
 void tmc4331_writeDatagram(TMC4331TypeDef *tmc4331, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
-	int value;
-	uint8_t data[5] = { address | TMC4331_WRITE_BIT, x1, x2, x3, x4 };
-
-	tmc4331_readWriteArray(tmc4331->config->channel, &data[0], 5);
-
-	tmc4331->status = data[0];
-
-	value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
-
-	// Write to the shadow register and mark the register dirty
-	address = TMC_ADDRESS(address);
-	tmc4331->config->shadowRegister[address] = value;
-	tmc4331->registerAccess[address] |= TMC_ACCESS_DIRTY;
+	tmc43xx_core_writeDatagram(tmc4331, address, x1, x2, x3, x4);
 }
 
 void tmc4331_writeInt(TMC4331TypeDef *tmc4331, uint8_t address, int32_t value)
 {
-	tmc4331_writeDatagram(tmc4331, address, BYTE(value, 3), BYTE(value, 2), BYTE(value, 1), BYTE(value, 0));
+	tmc43xx_core_writeInt(tmc4331, address, value);
 }
 
 int32_t tmc4331_readInt(TMC4331TypeDef *tmc4331, uint8_t address)
 {
-	int value;
-	uint8_t data[5];
-
-	address = TMC_ADDRESS(address);
-
-	if(!TMC_IS_READABLE(tmc4331->registerAccess[address]))
-		return tmc4331->config->shadowRegister[address];
-
-	data[0] = address;
-	tmc4331_readWriteArray(tmc4331->config->channel, &data[0], 5);
-
-	data[0] = address;
-	tmc4331_readWriteArray(tmc4331->config->channel, &data[0], 5);
+	return tmc43xx_core_readInt(tmc4331, address);
+}
 
-	tmc4331->status = data[0];
-	value = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+// Read multiple registers with pipelined datagrams, see tmc43xx_core_readIntBatch()
+void tmc4331_readIntBatch(TMC4331TypeDef *tmc4331, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	tmc43xx_core_readIntBatch(tmc4331, addresses, values, count);
+}
 
-	return value;
+// Send the cover datagrams one after another. Returns false if a reply timed out,
+// the remaining datagrams are not sent then.
+bool tmc4331_readWriteCoverQueue(TMC4331TypeDef *tmc4331, TMC4331CoverDatagramTypeDef *datagrams, size_t count)
+{
+	return tmc43xx_core_readWriteCoverQueue(tmc4331, datagrams, count);
 }
 
 // Send [length] bytes stored in the [data] array to a driver attached to the TMC4331
 // and overwrite [data] with the replies. data[0] is the first byte sent and received.
 void tmc4331_readWriteCover(TMC4331TypeDef *tmc4331, uint8_t *data, size_t length)
 {
-	// Buffering old values to not interrupt manual covering
-	int32_t old_high = tmc4331->config->shadowRegister[TMC4331_COVER_HIGH_WR];
-	int32_t old_low = tmc4331->config->shadowRegister[TMC4331_COVER_LOW_WR];
-
-	// Check if datagram length is valid
-	if(length == 0 || length > 8)
-		return;
-
-	uint8_t bytes[8] = { 0 };
-	uint32_t tmp;
-	size_t i;
-
-	// Copy data into buffer of maximum cover datagram length (8 bytes)
-	for(i = 0; i < length; i++)
-		bytes[i] = data[length-i-1];
-
-	// Send the datagram
-	if(length > 4)
-		tmc4331_writeDatagram(tmc4331, TMC4331_COVER_HIGH_WR, bytes[7], bytes[6], bytes[5], bytes[4]);
-
-	tmc4331_writeDatagram(tmc4331, TMC4331_COVER_LOW_WR, bytes[3], bytes[2], bytes[1], bytes[0]);
-
-	// Wait for datagram completion
-	// TODO CHECK 3: Get the waiting for cover completion done properly (LH)
-	for(i = 0; i < 100; i++)
-		tmp = ACCESS_ONCE(i);
-
-	// Read the reply
-	if(length > 4)
-	{
-		tmp = tmc4331_readInt(tmc4331, TMC4331_COVER_DRV_HIGH_RD);
-		bytes[4] = BYTE(tmp, 0);
-		bytes[5] = BYTE(tmp, 1);
-		bytes[6] = BYTE(tmp, 2);
-		bytes[7] = BYTE(tmp, 3);
-	}
-	tmp = tmc4331_readInt(tmc4331, TMC4331_COVER_DRV_LOW_RD);
-	bytes[0] = BYTE(tmp, 0);
-	bytes[1] = BYTE(tmp, 1);
-	bytes[2] = BYTE(tmp, 2);
-	bytes[3] = BYTE(tmp, 3);
-
-	// Write the reply to the data array
-	for(i = 0; i < length; i++)
-	{
-		data[length-i-1] = bytes[i];
-	}
-
-	// Rewriting old values to prevent interrupting manual covering. Imitating unchanged values and state.
-	tmc4331_writeInt(tmc4331, TMC4331_COVER_HIGH_WR, old_high);
-	tmc4331->config->shadowRegister[TMC4331_COVER_LOW_WR] = old_low;
+	tmc43xx_core_readWriteCover(tmc4331, data, length);
 }
 
 // Provide the init function with a channel index (sent back in the SPI callback), a pointer to a ConfigurationTypeDef struct
 // and a pointer to a int32_t array (size 128) holding the reset values that shall be used.
 void tmc4331_init(TMC4331TypeDef *tmc4331, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
 {
-	tmc4331->velocity  = 0;
-	tmc4331->oldTick   = 0;
-	tmc4331->oldX      = 0;
-	tmc4331->config    = config;
-
-	tmc4331->config->callback     = NULL;
-	tmc4331->config->channel      = channel;
-	tmc4331->config->configIndex  = 0;
-	tmc4331->config->state        = CONFIG_READY;
-
-	int i;
-	for(i = 0; i < TMC4331_REGISTER_COUNT; i++)
-	{
-		tmc4331->registerAccess[i]      = tmc4331_defaultRegisterAccess[i];
-		tmc4331->registerResetState[i]  = registerResetState[i];
-	}
+	tmc43xx_core_init(tmc4331, &variant, channel, config, registerResetState);
 }
 
 uint8_t tmc4331_reset(TMC4331TypeDef *tmc4331)
 {
-	if(tmc4331->config->state != CONFIG_READY)
-		return 0;
-
-	int i;
-
-	// Reset the dirty bits
-	for(i = 0; i < TMC4331_REGISTER_COUNT; i++)
-		tmc4331->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-
-	tmc4331->config->state        = CONFIG_RESET;
-	tmc4331->config->configIndex  = 0;
-
-	return 1;
+	return tmc43xx_core_reset(tmc4331);
 }
 
 uint8_t tmc4331_restore(TMC4331TypeDef *tmc4331)
 {
-	if(tmc4331->config->state != CONFIG_READY)
-		return 0;
-
-	tmc4331->config->state        = CONFIG_RESTORE;
-	tmc4331->config->configIndex  = 0;
-
-	return 1;
+	return tmc43xx_core_restore(tmc4331);
 }
 
 void tmc4331_setRegisterResetState(TMC4331TypeDef *tmc4331, const int32_t *resetState)
 {
-	uint32_t i;
-	for(i = 0; i < TMC4331_REGISTER_COUNT; i++)
-		tmc4331->registerResetState[i] = resetState[i];
+	tmc43xx_core_setRegisterResetState(tmc4331, resetState);
 }
 
 void tmc4331_setCallback(TMC4331TypeDef *tmc4331, tmc4331_callback callback)
@@ -177,102 +89,111 @@ void tmc4331_setCallback(TMC4331TypeDef *tmc4331, tmc4331_callback callback)
 	tmc4331->config->callback = (tmc_callback_config) callback;
 }
 
-static void tmc4331_writeConfiguration(TMC4331TypeDef *tmc4331)
+TMCConfigStatus tmc4331_periodicJob(TMC4331TypeDef *tmc4331, uint32_t tick)
 {
-	uint8_t *ptr = &tmc4331->config->configIndex;
-	const int32_t *settings;
-
-	if(tmc4331->config->state == CONFIG_RESTORE)
-	{
-		settings = &tmc4331->config->shadowRegister[0];
-		// Find the next restorable register
-		while((*ptr < TMC4331_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc4331->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-	else
-	{
-		settings = &tmc4331->registerResetState[0];
-		// Find the next resettable register
-		while((*ptr < TMC4331_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc4331->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-
-	if (*ptr < TMC4331_REGISTER_COUNT) {
-		tmc4331_writeInt(tmc4331, *ptr, settings[*ptr]);
-		(*ptr)++;
-	}
-	else
-	{
-		if(tmc4331->config->callback)
-		{
-			((tmc4331_callback)tmc4331->config->callback)(tmc4331, tmc4331->config->state);
-		}
-
-		tmc4331->config->state = CONFIG_READY;
-	}
+	return tmc43xx_core_periodicJob(tmc4331, tick);
 }
 
-void tmc4331_periodicJob(TMC4331TypeDef *tmc4331, uint32_t tick)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc4331_configureBurst(TMC4331TypeDef *tmc4331, uint32_t maxSteps)
 {
-	if(tmc4331->config->state != CONFIG_READY)
-	{
-		tmc4331_writeConfiguration(tmc4331);
-		return;
-	}
-
-	if((tick - tmc4331->oldTick) != 0)
-	{
-		tmc4331->oldTick = tick;
-	}
+	return tmc43xx_core_configureBurst(tmc4331, maxSteps);
 }
 
-void tmc4331_rotate(TMC4331TypeDef *tmc4331, int32_t velocity)
+// Event driven status, see tmc43xx_core_onInterrupt()
+uint8_t tmc4331_onInterrupt(TMC4331TypeDef *tmc4331)
 {
-	// Disable Position Mode
-	TMC4331_FIELD_WRITE(tmc4331, TMC4331_RAMPMODE, TMC4331_OPERATION_MODE_MASK, TMC4331_OPERATION_MODE_SHIFT, 0);
+	return tmc43xx_core_onInterrupt(tmc4331);
+}
 
-	tmc4331_writeInt(tmc4331, TMC4331_VMAX, tmc4331_discardVelocityDecimals(velocity));
+void tmc4331_rotate(TMC4331TypeDef *tmc4331, int32_t velocity)
+{
+	tmc43xx_core_rotate(tmc4331, velocity);
 }
 
 void tmc4331_right(TMC4331TypeDef *tmc4331, int32_t velocity)
 {
-	tmc4331_rotate(tmc4331, velocity);
+	tmc43xx_core_rotate(tmc4331, velocity);
 }
 
 void tmc4331_left(TMC4331TypeDef *tmc4331, int32_t velocity)
 {
-	tmc4331_rotate(tmc4331, -velocity);
+	tmc43xx_core_rotate(tmc4331, -velocity);
 }
 
 void tmc4331_stop(TMC4331TypeDef *tmc4331)
 {
-	tmc4331_rotate(tmc4331, 0);
+	tmc43xx_core_rotate(tmc4331, 0);
 }
 
 void tmc4331_moveTo(TMC4331TypeDef *tmc4331, int32_t position, uint32_t velocityMax)
 {
-	// Enable Position Mode
-	TMC4331_FIELD_WRITE(tmc4331, TMC4331_RAMPMODE, TMC4331_OPERATION_MODE_MASK, TMC4331_OPERATION_MODE_SHIFT, 1);
-
-	tmc4331_writeInt(tmc4331, TMC4331_VMAX, tmc4331_discardVelocityDecimals(velocityMax));
-
-	tmc4331_writeInt(tmc4331, TMC4331_X_TARGET, position);
+	tmc43xx_core_moveTo(tmc4331, position, velocityMax);
 }
 
 // The function will write the absolute target position to *ticks
 void tmc4331_moveBy(TMC4331TypeDef *tmc4331, int32_t *ticks, uint32_t velocityMax)
 {
-	// determine actual position and add numbers of ticks to move
-	*ticks += tmc4331_readInt(tmc4331, TMC4331_XACTUAL);
+	tmc43xx_core_moveBy(tmc4331, ticks, velocityMax);
+}
 
-	tmc4331_moveTo(tmc4331, *ticks, velocityMax);
+// Move queue, see tmc43xx_core_moveQueueService()
+void tmc4331_moveQueueInit(TMC4331MoveQueueTypeDef *queue)
+{
+	tmc43xx_core_moveQueueInit(queue);
+}
+
+// Returns false if the queue is full
+bool tmc4331_moveQueuePush(TMC4331MoveQueueTypeDef *queue, const TMC4331MoveTypeDef *move)
+{
+	return tmc43xx_core_moveQueuePush(queue, move);
+}
+
+void tmc4331_moveQueueService(TMC4331TypeDef *tmc4331, TMC4331MoveQueueTypeDef *queue)
+{
+	tmc43xx_core_moveQueueService(tmc4331, queue);
+}
+
+// Returns true once all queued moves are finished
+bool tmc4331_moveQueueIsDone(TMC4331MoveQueueTypeDef *queue)
+{
+	return tmc43xx_core_moveQueueIsDone(queue);
+}
+
+// Start group, see tmc43xx_core_startGroupInit()
+void tmc4331_startGroupInit(TMC4331StartGroupTypeDef *group, TMC4331TypeDef **axes, uint8_t count)
+{
+	tmc43xx_core_startGroupInit(group, axes, count);
+}
+
+// Hold back XTARGET writes of all axes until the START signal
+void tmc4331_startGroupArm(TMC4331StartGroupTypeDef *group)
+{
+	tmc43xx_core_startGroupArm(group);
+}
+
+// Preload a move of [axis], it starts with the next START signal
+void tmc4331_startGroupPreload(TMC4331StartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax)
+{
+	tmc43xx_core_startGroupPreload(group, axis, position, velocityMax);
+}
+
+// Restore the START_CONF of all axes
+void tmc4331_startGroupDisarm(TMC4331StartGroupTypeDef *group)
+{
+	tmc43xx_core_startGroupDisarm(group);
 }
 
 int32_t tmc4331_discardVelocityDecimals(int32_t value)
 {
-	if(abs(value) > 8000000)
-	{
-		value = (value < 0) ? -8000000 : 8000000;
-	}
-	return value << 8;
+	return tmc43xx_core_discardVelocityDecimals(value);
+}
+
+uint8_t tmc4331_calibrateClosedLoop(TMC4331TypeDef *tmc4331, uint8_t worker0master1)
+{
+	return tmc43xx_core_calibrateClosedLoop(tmc4331, worker0master1);
 }
@@ -9,6 +9,7 @@
 #define TMC_IC_TMC4331_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ic/TMC43xx/TMC43xx_Core.h"
 #include "TMC4331_Register.h"
 #include "TMC4331_Constants.h"
 #include "TMC4331_Fields.h"
@@ -18,20 +19,18 @@
 	FIELD_GET(tmc4331_readInt(tdef, address), mask, shift)
 #define TMC4331_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc4331_writeInt(tdef, address, FIELD_SET(tmc4331_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC4331_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc4331_writeInt(tdef, address, FIELDS_SET(tmc4331_readInt(tdef, address), mask, values)))
 
 // Typedefs
-typedef struct
-{
-	ConfigurationTypeDef *config;
-	int velocity;
-	int oldX;
-	uint32_t oldTick;
-	int32_t registerResetState[TMC4331_REGISTER_COUNT];
-	uint8_t registerAccess[TMC4331_REGISTER_COUNT];
-	//TMotorConfig motorConfig;
-	//TClosedLoopConfig closedLoopConfig;
-	uint8_t status;
-} TMC4331TypeDef;
+// The TMC43xx variants share one core, see tmc/ic/TMC43xx/TMC43xx_Core.h
+typedef TMC43xxCoreTypeDef TMC4331TypeDef;
+
+typedef TMC43xxCoverDatagramTypeDef TMC4331CoverDatagramTypeDef;
+typedef TMC43xxMoveTypeDef TMC4331MoveTypeDef;
+typedef TMC43xxMoveQueueTypeDef TMC4331MoveQueueTypeDef;
+typedef TMC43xxStartGroupTypeDef TMC4331StartGroupTypeDef;
 
 typedef void (*tmc4331_callback)(TMC4331TypeDef*, ConfigState);
 
@@ -79,6 +78,31 @@ static const uint8_t tmc4331_defaultRegisterAccess[TMC4331_REGISTER_COUNT] =
 	0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x01, 0x01, 0x53, 0x13, ____, 0x42, 0x01  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc4331_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc4331_resettableRegisters[] =
+{
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x0C, 0x0D, 0x0E, 0x10, 0x11, 0x13, 0x14, 0x15, 0x16, 0x18, 0x19,
+	0x1A, 0x1B, 0x1D, 0x1E, 0x20, 0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D,
+	0x2E, 0x2F, 0x30, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E,
+	0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4F,
+	0x60, 0x61, 0x67, 0x6C, 0x6D, 0x7C
+};
+
+static const uint8_t tmc4331_restorableRegisters[] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x10, 0x11, 0x12, 0x13,
+	0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x24, 0x25, 0x26,
+	0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36,
+	0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46,
+	0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4F, 0x60, 0x61, 0x62, 0x67, 0x6C, 0x6D, 0x70, 0x71,
+	0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x7B, 0x7C, 0x7E
+};
+
 
 // API Functions
 // All functions act on one IC given by the TMC4331TypeDef struct
@@ -87,7 +111,9 @@ static const uint8_t tmc4331_defaultRegisterAccess[TMC4331_REGISTER_COUNT] =
 void tmc4331_writeDatagram(TMC4331TypeDef *tmc4331, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc4331_writeInt(TMC4331TypeDef *tmc4331, uint8_t address, int32_t value);
 int32_t tmc4331_readInt(TMC4331TypeDef *tmc4331, uint8_t address);
+void tmc4331_readIntBatch(TMC4331TypeDef *tmc4331, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc4331_readWriteCover(TMC4331TypeDef *tmc4331, uint8_t *data, size_t length);
+bool tmc4331_readWriteCoverQueue(TMC4331TypeDef *tmc4331, TMC4331CoverDatagramTypeDef *datagrams, size_t count);
 
 // Configuration
 void tmc4331_init(TMC4331TypeDef *tmc4331, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
@@ -95,7 +121,19 @@ uint8_t tmc4331_reset(TMC4331TypeDef *tmc4331);
 uint8_t tmc4331_restore(TMC4331TypeDef *tmc4331);
 void tmc4331_setRegisterResetState(TMC4331TypeDef *tmc4331, const int32_t *resetState);
 void tmc4331_setCallback(TMC4331TypeDef *tmc4331, tmc4331_callback callback);
-void tmc4331_periodicJob(TMC4331TypeDef *tmc4331, uint32_t tick);
+TMCConfigStatus tmc4331_periodicJob(TMC4331TypeDef *tmc4331, uint32_t tick);
+uint8_t tmc4331_configureBurst(TMC4331TypeDef *tmc4331, uint32_t maxSteps);
+uint8_t tmc4331_onInterrupt(TMC4331TypeDef *tmc4331);
+
+void tmc4331_moveQueueInit(TMC4331MoveQueueTypeDef *queue);
+bool tmc4331_moveQueuePush(TMC4331MoveQueueTypeDef *queue, const TMC4331MoveTypeDef *move);
+void tmc4331_moveQueueService(TMC4331TypeDef *tmc4331, TMC4331MoveQueueTypeDef *queue);
+bool tmc4331_moveQueueIsDone(TMC4331MoveQueueTypeDef *queue);
+
+void tmc4331_startGroupInit(TMC4331StartGroupTypeDef *group, TMC4331TypeDef **axes, uint8_t count);
+void tmc4331_startGroupArm(TMC4331StartGroupTypeDef *group);
+void tmc4331_startGroupPreload(TMC4331StartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax);
+void tmc4331_startGroupDisarm(TMC4331StartGroupTypeDef *group);
 
 // Motion
 void tmc4331_rotate(TMC4331TypeDef *tmc4331, int32_t velocity);
@@ -9,6 +9,7 @@
 #define TMC_IC_TMC4361_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ic/TMC43xx/TMC43xx_Core.h"
 #include "TMC4361_Register.h"
 #include "TMC4361_Constants.h"
 #include "TMC4361_Fields.h"
@@ -18,21 +19,18 @@
 	FIELD_GET(tmc4361_readInt(tdef, address), mask, shift)
 #define TMC4361_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc4361_writeInt(tdef, address, FIELD_SET(tmc4361_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC4361_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc4361_writeInt(tdef, address, FIELDS_SET(tmc4361_readInt(tdef, address), mask, values)))
 
 // Typedefs
-typedef struct
-{
-	ConfigurationTypeDef *config;
-	int velocity;
-	int oldX;
-	uint32_t oldTick;
-	int32_t registerResetState[TMC4361_REGISTER_COUNT];
-	uint8_t registerAccess[TMC4361_REGISTER_COUNT];
-	//TMotorConfig motorConfig;
-	//TClosedLoopConfig closedLoopConfig;
-	uint8_t status;
-	bool cover_hold;
-} TMC4361TypeDef;
+// The TMC43xx variants share one core, see tmc/ic/TMC43xx/TMC43xx_Core.h
+typedef TMC43xxCoreTypeDef TMC4361TypeDef;
+
+typedef TMC43xxCoverDatagramTypeDef TMC4361CoverDatagramTypeDef;
+typedef TMC43xxMoveTypeDef TMC4361MoveTypeDef;
+typedef TMC43xxMoveQueueTypeDef TMC4361MoveQueueTypeDef;
+typedef TMC43xxStartGroupTypeDef TMC4361StartGroupTypeDef;
 
 typedef void (*tmc4361_callback)(TMC4361TypeDef*, ConfigState);
 
@@ -80,6 +78,34 @@ static const uint8_t tmc4361_defaultRegisterAccess[TMC4361_REGISTER_COUNT] =
 	0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x01, 0x01, 0x53, 0x53, 0x02, 0x42, 0x01  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc4361_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc4361_resettableRegisters[] =
+{
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x10, 0x11, 0x13, 0x14, 0x15, 0x16,
+	0x18, 0x19, 0x1A, 0x1B, 0x1D, 0x1E, 0x20, 0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B,
+	0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C,
+	0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C,
+	0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x54, 0x55, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60,
+	0x61, 0x63, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x7D
+};
+
+static const uint8_t tmc4361_restorableRegisters[] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x10,
+	0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+	0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+	0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42,
+	0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52,
+	0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60, 0x61, 0x62,
+	0x63, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x7B,
+	0x7C, 0x7D, 0x7E
+};
+
 
 // API Functions
 // All functions act on one IC given by the TMC4361TypeDef struct
@@ -88,7 +114,9 @@ static const uint8_t tmc4361_defaultRegisterAccess[TMC4361_REGISTER_COUNT] =
 void tmc4361_writeDatagram(TMC4361TypeDef *tmc4361, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc4361_writeInt(TMC4361TypeDef *tmc4361, uint8_t address, int32_t value);
 int32_t tmc4361_readInt(TMC4361TypeDef *tmc4361, uint8_t address);
+void tmc4361_readIntBatch(TMC4361TypeDef *tmc4361, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc4361_readWriteCover(TMC4361TypeDef *tmc4361, uint8_t *data, size_t length);
+bool tmc4361_readWriteCoverQueue(TMC4361TypeDef *tmc4361, TMC4361CoverDatagramTypeDef *datagrams, size_t count);
 
 // Configuration
 void tmc4361_init(TMC4361TypeDef *tmc4361, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
@@ -96,7 +124,19 @@ uint8_t tmc4361_reset(TMC4361TypeDef *tmc4361);
 uint8_t tmc4361_restore(TMC4361TypeDef *tmc4361);
 void tmc4361_setRegisterResetState(TMC4361TypeDef *tmc4361, const int32_t *resetState);
 void tmc4361_setCallback(TMC4361TypeDef *tmc4361, tmc4361_callback callback);
-void tmc4361_periodicJob(TMC4361TypeDef *tmc4361, uint32_t tick);
+TMCConfigStatus tmc4361_periodicJob(TMC4361TypeDef *tmc4361, uint32_t tick);
+uint8_t tmc4361_configureBurst(TMC4361TypeDef *tmc4361, uint32_t maxSteps);
+uint8_t tmc4361_onInterrupt(TMC4361TypeDef *tmc4361);
+
+void tmc4361_moveQueueInit(TMC4361MoveQueueTypeDef *queue);
+bool tmc4361_moveQueuePush(TMC4361MoveQueueTypeDef *queue, const TMC4361MoveTypeDef *move);
+void tmc4361_moveQueueService(TMC4361TypeDef *tmc4361, TMC4361MoveQueueTypeDef *queue);
+bool tmc4361_moveQueueIsDone(TMC4361MoveQueueTypeDef *queue);
+
+void tmc4361_startGroupInit(TMC4361StartGroupTypeDef *group, TMC4361TypeDef **axes, uint8_t count);
+void tmc4361_startGroupArm(TMC4361StartGroupTypeDef *group);
+void tmc4361_startGroupPreload(TMC4361StartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax);
+void tmc4361_startGroupDisarm(TMC4361StartGroupTypeDef *group);
 
 // Motion
 void tmc4361_rotate(TMC4361TypeDef *tmc4361, int32_t velocity);
@@ -13,128 +13,60 @@
 extern void tmc4361A_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
 // <= SPI wrapper
 
+static const TMC43xxVariantTypeDef variant =
+{
+	.spi                    = { .readWriteArray = tmc4361A_readWriteArray, TMC_INSTRUMENT_NAME("TMC4361A") },
+	.defaultRegisterAccess  = tmc4361A_defaultRegisterAccess,
+	.resettableRegisters    = tmc4361A_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc4361A_resettableRegisters),
+	.restorableRegisters    = tmc4361A_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc4361A_restorableRegisters),
+	.constants              = tmc4361A_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc4361A_RegisterConstants),
+	.features               = TMC43XX_FEATURE_COVER | TMC43XX_FEATURE_CLOSED_LOOP | TMC43XX_FEATURE_PIPELINE,
+};
+
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
 void tmc4361A_writeDatagram(TMC4361ATypeDef *tmc4361A, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
-	int value;
-	uint8_t data[5] = { address | TMC4361A_WRITE_BIT, x1, x2, x3, x4 };
-
-	tmc4361A_readWriteArray(tmc4361A->config->channel, &data[0], 5);
-
-	tmc4361A->status = data[0];
-
-	value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
-
-	// Write to the shadow register and mark the register dirty
-	address = TMC_ADDRESS(address);
-	tmc4361A->config->shadowRegister[address] = value;
-	tmc4361A->registerAccess[address] |= TMC_ACCESS_DIRTY;
+	tmc43xx_core_writeDatagram(tmc4361A, address, x1, x2, x3, x4);
 }
 
 void tmc4361A_writeInt(TMC4361ATypeDef *tmc4361A, uint8_t address, int32_t value)
 {
-	tmc4361A_writeDatagram(tmc4361A, address, BYTE(value, 3), BYTE(value, 2), BYTE(value, 1), BYTE(value, 0));
+	tmc43xx_core_writeInt(tmc4361A, address, value);
 }
 
 int32_t tmc4361A_readInt(TMC4361ATypeDef *tmc4361A, uint8_t address)
 {
-	int value;
-	uint8_t data[5];
-
-	address = TMC_ADDRESS(address);
-
-	if(!TMC_IS_READABLE(tmc4361A->registerAccess[address]))
-		return tmc4361A->config->shadowRegister[address];
-
-	data[0] = address;
-	tmc4361A_readWriteArray(tmc4361A->config->channel, &data[0], 5);
-
-	data[0] = address;
-	tmc4361A_readWriteArray(tmc4361A->config->channel, &data[0], 5);
+	return tmc43xx_core_readInt(tmc4361A, address);
+}
 
-	tmc4361A->status = data[0];
-	value = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+// Read multiple registers with pipelined datagrams, see tmc43xx_core_readIntBatch()
+void tmc4361A_readIntBatch(TMC4361ATypeDef *tmc4361A, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	tmc43xx_core_readIntBatch(tmc4361A, addresses, values, count);
+}
 
-	return value;
+// Send the cover datagrams one after another. Returns false if a reply timed out,
+// the remaining datagrams are not sent then.
+bool tmc4361A_readWriteCoverQueue(TMC4361ATypeDef *tmc4361A, TMC4361ACoverDatagramTypeDef *datagrams, size_t count)
+{
+	return tmc43xx_core_readWriteCoverQueue(tmc4361A, datagrams, count);
 }
 
 // Send [length] bytes stored in the [data] array to a driver attached to the TMC4361A
 // and overwrite [data] with the replies. data[0] is the first byte sent and received.
 void tmc4361A_readWriteCover(TMC4361ATypeDef *tmc4361A, uint8_t *data, size_t length)
 {
-	// Buffering old values to not interrupt manual covering
-	int32_t old_high = tmc4361A->config->shadowRegister[TMC4361A_COVER_HIGH_WR];
-	int32_t old_low = tmc4361A->config->shadowRegister[TMC4361A_COVER_LOW_WR];
-
-	// Check if datagram length is valid
-	if(length == 0 || length > 8)
-		return;
-
-	uint8_t bytes[8] = { 0 };
-	uint32_t tmp;
-	size_t i;
-
-	// Copy data into buffer of maximum cover datagram length (8 bytes)
-	for(i = 0; i < length; i++)
-		bytes[i] = data[length-i-1];
-
-	// Send the datagram
-	if(length > 4)
-		tmc4361A_writeDatagram(tmc4361A, TMC4361A_COVER_HIGH_WR, bytes[7], bytes[6], bytes[5], bytes[4]);
-
-	tmc4361A_writeDatagram(tmc4361A, TMC4361A_COVER_LOW_WR, bytes[3], bytes[2], bytes[1], bytes[0]);
-
-	// Wait for datagram completion
-	// TODO CHECK 3: Get the waiting for cover completion done properly (LH)
-	for(i = 0; i < 100; i++)
-		tmp = ACCESS_ONCE(i);
-
-	// Read the reply
-	if(length > 4)
-	{
-		tmp = tmc4361A_readInt(tmc4361A, TMC4361A_COVER_DRV_HIGH_RD);
-		bytes[4] = BYTE(tmp, 0);
-		bytes[5] = BYTE(tmp, 1);
-		bytes[6] = BYTE(tmp, 2);
-		bytes[7] = BYTE(tmp, 3);
-	}
-	tmp = tmc4361A_readInt(tmc4361A, TMC4361A_COVER_DRV_LOW_RD);
-	bytes[0] = BYTE(tmp, 0);
-	bytes[1] = BYTE(tmp, 1);
-	bytes[2] = BYTE(tmp, 2);
-	bytes[3] = BYTE(tmp, 3);
-
-	// Write the reply to the data array
-	for(i = 0; i < length; i++)
-	{
-		data[length-i-1] = bytes[i];
-	}
-
-	// Rewriting old values to prevent interrupting manual covering. Imitating unchanged values and state.
-	tmc4361A_writeInt(tmc4361A, TMC4361A_COVER_HIGH_WR, old_high);
-	tmc4361A->config->shadowRegister[TMC4361A_COVER_LOW_WR] = old_low;
+	tmc43xx_core_readWriteCover(tmc4361A, data, length);
 }
 
 // Provide the init function with a channel index (sent back in the SPI callback), a pointer to a ConfigurationTypeDef struct
 // and a pointer to a int32_t array (size 128) holding the reset values that shall be used.
 void tmc4361A_init(TMC4361ATypeDef *tmc4361A, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
 {
-	tmc4361A->velocity  = 0;
-	tmc4361A->oldTick   = 0;
-	tmc4361A->oldX      = 0;
-	tmc4361A->config    = config;
-
-	tmc4361A->config->callback     = NULL;
-	tmc4361A->config->channel      = channel;
-	tmc4361A->config->configIndex  = 0;
-	tmc4361A->config->state        = CONFIG_READY;
-
-	int i;
-	for(i = 0; i < TMC4361A_REGISTER_COUNT; i++)
-	{
-		tmc4361A->registerAccess[i]      = tmc4361A_defaultRegisterAccess[i];
-		tmc4361A->registerResetState[i]  = registerResetState[i];
-	}
+	tmc43xx_core_init(tmc4361A, &variant, channel, config, registerResetState);
 }
 
 // Fill the shadow registers of hardware preset non-readable registers
@@ -142,67 +74,22 @@ void tmc4361A_init(TMC4361ATypeDef *tmc4361A, uint8_t channel, ConfigurationType
 // (e.g. for the TMCL IDE register browser)
 void tmc4361A_fillShadowRegisters(TMC4361ATypeDef *tmc4361A)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc4361A_RegisterConstants) == 0)
-		return;
-
-	size_t i, j;
-	for(i = 0, j = 0; i < TMC4361A_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc4361A->registerAccess[i] != TMC_ACCESS_W_PRESET)
-			continue;
-
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc4361A_RegisterConstants) && (tmc4361A_RegisterConstants[j].address < i))
-			j++;
-
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc4361A_RegisterConstants))
-			break;
-
-		// If we have an entry for our current address, write the constant
-		if(tmc4361A_RegisterConstants[j].address == i)
-			tmc4361A->config->shadowRegister[i] = tmc4361A_RegisterConstants[j].value;
-	}
+	tmc43xx_core_fillShadowRegisters(tmc4361A);
 }
 
 uint8_t tmc4361A_reset(TMC4361ATypeDef *tmc4361A)
 {
-	if(tmc4361A->config->state != CONFIG_READY)
-		return 0;
-
-	int i;
-
-	// Reset the dirty bits
-	for(i = 0; i < TMC4361A_REGISTER_COUNT; i++)
-		tmc4361A->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-
-	tmc4361A->config->state        = CONFIG_RESET;
-	tmc4361A->config->configIndex  = 0;
-
-	return 1;
+	return tmc43xx_core_reset(tmc4361A);
 }
 
 uint8_t tmc4361A_restore(TMC4361ATypeDef *tmc4361A)
 {
-	if(tmc4361A->config->state != CONFIG_READY)
-		return 0;
-
-	tmc4361A->config->state        = CONFIG_RESTORE;
-	tmc4361A->config->configIndex  = 0;
-
-	return 1;
+	return tmc43xx_core_restore(tmc4361A);
 }
 
 void tmc4361A_setRegisterResetState(TMC4361ATypeDef *tmc4361A, const int32_t *resetState)
 {
-	uint32_t i;
-	for(i = 0; i < TMC4361A_REGISTER_COUNT; i++)
-		tmc4361A->registerResetState[i] = resetState[i];
+	tmc43xx_core_setRegisterResetState(tmc4361A, resetState);
 }
 
 void tmc4361A_setCallback(TMC4361ATypeDef *tmc4361A, tmc4361A_callback callback)
@@ -210,204 +97,146 @@ void tmc4361A_setCallback(TMC4361ATypeDef *tmc4361A, tmc4361A_callback callback)
 	tmc4361A->config->callback = (tmc_callback_config) callback;
 }
 
-static void tmc4361A_writeConfiguration(TMC4361ATypeDef *tmc4361A)
-{
-	uint8_t *ptr = &tmc4361A->config->configIndex;
-	const int32_t *settings;
-
-	if(tmc4361A->config->state == CONFIG_RESTORE)
-	{
-		settings = &tmc4361A->config->shadowRegister[0];
-		// Find the next restorable register
-		while((*ptr < TMC4361A_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc4361A->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-	else
-	{
-		settings = &tmc4361A->registerResetState[0];
-		// Find the next resettable register
-		while((*ptr < TMC4361A_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc4361A->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-
-	if (*ptr < TMC4361A_REGISTER_COUNT) {
-		tmc4361A_writeInt(tmc4361A, *ptr, settings[*ptr]);
-		(*ptr)++;
-	}
-	else
-	{
-		if(tmc4361A->config->callback)
-		{
-			((tmc4361A_callback)tmc4361A->config->callback)(tmc4361A, tmc4361A->config->state);
-		}
-
-		tmc4361A->config->state = CONFIG_READY;
-	}
-}
-
-void tmc4361A_periodicJob(TMC4361ATypeDef *tmc4361A, uint32_t tick)
-{
-	if(tmc4361A->config->state != CONFIG_READY)
-	{
-		tmc4361A_writeConfiguration(tmc4361A);
-		return;
-	}
-
-	if((tick - tmc4361A->oldTick) != 0)
-	{
-		tmc4361A_calibrateClosedLoop(tmc4361A, 0);
-		tmc4361A->oldTick = tick;
-	}
+TMCConfigStatus tmc4361A_periodicJob(TMC4361ATypeDef *tmc4361A, uint32_t tick)
+{
+	return tmc43xx_core_periodicJob(tmc4361A, tick);
 }
 
-void tmc4361A_rotate(TMC4361ATypeDef *tmc4361A, int32_t velocity)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc4361A_configureBurst(TMC4361ATypeDef *tmc4361A, uint32_t maxSteps)
 {
-	// Disable Position Mode
-	TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_RAMPMODE, TMC4361A_OPERATION_MODE_MASK, TMC4361A_OPERATION_MODE_SHIFT, 0);
+	return tmc43xx_core_configureBurst(tmc4361A, maxSteps);
+}
+
+// Event driven status, see tmc43xx_core_onInterrupt()
+uint8_t tmc4361A_onInterrupt(TMC4361ATypeDef *tmc4361A)
+{
+	return tmc43xx_core_onInterrupt(tmc4361A);
+}
 
-	tmc4361A_writeInt(tmc4361A, TMC4361A_VMAX, tmc4361A_discardVelocityDecimals(velocity));
+void tmc4361A_rotate(TMC4361ATypeDef *tmc4361A, int32_t velocity)
+{
+	tmc43xx_core_rotate(tmc4361A, velocity);
 }
 
 void tmc4361A_right(TMC4361ATypeDef *tmc4361A, int32_t velocity)
 {
-	tmc4361A_rotate(tmc4361A, velocity);
+	tmc43xx_core_rotate(tmc4361A, velocity);
 }
 
 void tmc4361A_left(TMC4361ATypeDef *tmc4361A, int32_t velocity)
 {
-	tmc4361A_rotate(tmc4361A, -velocity);
+	tmc43xx_core_rotate(tmc4361A, -velocity);
 }
 
 void tmc4361A_stop(TMC4361ATypeDef *tmc4361A)
 {
-	tmc4361A_rotate(tmc4361A, 0);
+	tmc43xx_core_rotate(tmc4361A, 0);
 }
 
 void tmc4361A_moveTo(TMC4361ATypeDef *tmc4361A, int32_t position, uint32_t velocityMax)
 {
-	// Enable Position Mode
-	TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_RAMPMODE, TMC4361A_OPERATION_MODE_MASK, TMC4361A_OPERATION_MODE_SHIFT, 1);
-
-	tmc4361A_writeInt(tmc4361A, TMC4361A_VMAX, tmc4361A_discardVelocityDecimals(velocityMax));
-
-	tmc4361A_writeInt(tmc4361A, TMC4361A_X_TARGET, position);
+	tmc43xx_core_moveTo(tmc4361A, position, velocityMax);
 }
 
 // The function will write the absolute target position to *ticks
 void tmc4361A_moveBy(TMC4361ATypeDef *tmc4361A, int32_t *ticks, uint32_t velocityMax)
 {
-	// determine actual position and add numbers of ticks to move
-	*ticks += tmc4361A_readInt(tmc4361A, TMC4361A_XACTUAL);
+	tmc43xx_core_moveBy(tmc4361A, ticks, velocityMax);
+}
 
-	tmc4361A_moveTo(tmc4361A, *ticks, velocityMax);
+// Move queue, see tmc43xx_core_moveQueueService()
+void tmc4361A_moveQueueInit(TMC4361AMoveQueueTypeDef *queue)
+{
+	tmc43xx_core_moveQueueInit(queue);
 }
 
-int32_t tmc4361A_discardVelocityDecimals(int32_t value)
+// Returns false if the queue is full
+bool tmc4361A_moveQueuePush(TMC4361AMoveQueueTypeDef *queue, const TMC4361AMoveTypeDef *move)
+{
+	return tmc43xx_core_moveQueuePush(queue, move);
+}
+
+void tmc4361A_moveQueueService(TMC4361ATypeDef *tmc4361A, TMC4361AMoveQueueTypeDef *queue)
+{
+	tmc43xx_core_moveQueueService(tmc4361A, queue);
+}
+
+// Returns true once all queued moves are finished
+bool tmc4361A_moveQueueIsDone(TMC4361AMoveQueueTypeDef *queue)
+{
+	return tmc43xx_core_moveQueueIsDone(queue);
+}
+
+// Start group, see tmc43xx_core_startGroupInit()
+void tmc4361A_startGroupInit(TMC4361AStartGroupTypeDef *group, TMC4361ATypeDef **axes, uint8_t count)
+{
+	tmc43xx_core_startGroupInit(group, axes, count);
+}
+
+// Hold back XTARGET writes of all axes until the START signal
+void tmc4361A_startGroupArm(TMC4361AStartGroupTypeDef *group)
+{
+	tmc43xx_core_startGroupArm(group);
+}
+
+// Preload a move of [axis], it starts with the next START signal
+void tmc4361A_startGroupPreload(TMC4361AStartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax)
 {
-	if(abs(value) > 8000000)
-	{
-		value = (value < 0) ? -8000000 : 8000000;
-	}
-	return value << 8;
+	tmc43xx_core_startGroupPreload(group, axis, position, velocityMax);
 }
 
-static uint8_t tmc4361A_moveToNextFullstep(TMC4361ATypeDef *tmc4361A)
+// Restore the START_CONF of all axes
+void tmc4361A_startGroupDisarm(TMC4361AStartGroupTypeDef *group)
 {
-	int32_t stepCount;
+	tmc43xx_core_startGroupDisarm(group);
+}
 
-	// Motor must be stopped
-	if(tmc4361A_readInt(tmc4361A, TMC4361A_VACTUAL) != 0)
-	{
-		// Not stopped
-		return 0;
-	}
+// Trigger queue, see tmc43xx_core_triggerQueueService()
+void tmc4361A_triggerQueueInit(TMC4361ATriggerQueueTypeDef *queue)
+{
+	tmc43xx_core_triggerQueueInit(queue);
+}
 
-	// Position mode, hold mode, low velocity
-	tmc4361A_writeInt(tmc4361A, TMC4361A_RAMPMODE, 4);
-	tmc4361A_writeInt(tmc4361A, TMC4361A_VMAX, 10000 << 8);
+// Returns false if the queue is full
+bool tmc4361A_triggerQueuePush(TMC4361ATriggerQueueTypeDef *queue, int32_t position)
+{
+	return tmc43xx_core_triggerQueuePush(queue, position);
+}
 
-	// Current step count
-	stepCount = TMC4361A_FIELD_READ(tmc4361A, TMC4361A_MSCNT_RD, TMC4361A_MSCNT_MASK, TMC4361A_MSCNT_SHIFT);
-	// Get microstep value of step count (lowest 8 bits)
-	stepCount = stepCount % 256;
-	// Assume: 256 microsteps -> Fullsteps are at 128 + n*256
-	stepCount = 128 - stepCount;
+// Returns false if the queue is empty
+bool tmc4361A_triggerQueueArm(TMC4361ATypeDef *tmc4361A, TMC4361ATriggerQueueTypeDef *queue)
+{
+	return tmc43xx_core_triggerQueueArm(tmc4361A, queue);
+}
 
-	if(stepCount == 0)
-	{
-		// Fullstep reached
-		return 1;
-	}
+// Returns the amount of positions fired since the last call
+uint8_t tmc4361A_triggerQueueService(TMC4361ATypeDef *tmc4361A, TMC4361ATriggerQueueTypeDef *queue)
+{
+	return tmc43xx_core_triggerQueueService(tmc4361A, queue);
+}
+
+void tmc4361A_triggerQueueDisarm(TMC4361ATypeDef *tmc4361A, TMC4361ATriggerQueueTypeDef *queue)
+{
+	tmc43xx_core_triggerQueueDisarm(tmc4361A, queue);
+}
 
-	// Fullstep not reached -> calculate next fullstep position
-	stepCount += tmc4361A_readInt(tmc4361A, TMC4361A_XACTUAL);
-	// Move to next fullstep position
-	tmc4361A_writeInt(tmc4361A, TMC4361A_X_TARGET, stepCount);
+// Returns true once all queued positions have fired
+bool tmc4361A_triggerQueueIsDone(TMC4361ATriggerQueueTypeDef *queue)
+{
+	return tmc43xx_core_triggerQueueIsDone(queue);
+}
 
-	return 0;
+int32_t tmc4361A_discardVelocityDecimals(int32_t value)
+{
+	return tmc43xx_core_discardVelocityDecimals(value);
 }
 
 uint8_t tmc4361A_calibrateClosedLoop(TMC4361ATypeDef *tmc4361A, uint8_t worker0master1)
 {
-	static uint8_t state = 0;
-	static uint32_t oldRamp;
-
-	uint32_t amax = 0;
-	uint32_t dmax = 0;
-
-	if(worker0master1 && state == 0)
-		state = 1;
-
-	switch(state)
-	{
-	case 1:
-		amax = tmc4361A_readInt(tmc4361A, TMC4361A_AMAX);
-		dmax = tmc4361A_readInt(tmc4361A, TMC4361A_DMAX);
-
-		// Set ramp and motion parameters
-		oldRamp = tmc4361A_readInt(tmc4361A, TMC4361A_RAMPMODE);
-		tmc4361A_writeInt(tmc4361A, TMC4361A_RAMPMODE, TMC4361A_RAMP_POSITION | TMC4361A_RAMP_HOLD);
-		tmc4361A_writeInt(tmc4361A, TMC4361A_AMAX, MAX(amax, 1000));
-		tmc4361A_writeInt(tmc4361A, TMC4361A_DMAX, MAX(dmax, 1000));
-		tmc4361A_writeInt(tmc4361A, TMC4361A_VMAX, 0);
-
-		state = 2;
-		break;
-	case 2:
-		// Clear encoder calibration bit
-		TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_ENC_IN_CONF, TMC4361A_CL_CALIBRATION_EN_MASK, TMC4361A_CL_CALIBRATION_EN_SHIFT, 0);
-
-		// Disable internal data regulation for closed loop operation in encoder config
-		TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_ENC_IN_CONF, TMC4361A_REGULATION_MODUS_MASK, TMC4361A_REGULATION_MODUS_SHIFT, 1);
-
-		if(tmc4361A_moveToNextFullstep(tmc4361A)) // move to next fullstep, motor must be stopped, poll until finished
-			state = 3;
-		break;
-	case 3:
-		// Start encoder calibration
-		TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_ENC_IN_CONF, TMC4361A_CL_CALIBRATION_EN_MASK, TMC4361A_CL_CALIBRATION_EN_SHIFT, 1);
-
-		state = 4;
-		break;
-	case 4:
-		if(worker0master1)
-			break;
-
-		// Stop encoder calibration
-		TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_ENC_IN_CONF, TMC4361A_CL_CALIBRATION_EN_MASK, TMC4361A_CL_CALIBRATION_EN_SHIFT, 0);
-		// Enable closed loop in encoder config
-		TMC4361A_FIELD_WRITE(tmc4361A, TMC4361A_ENC_IN_CONF, TMC4361A_REGULATION_MODUS_MASK, TMC4361A_REGULATION_MODUS_SHIFT, 1);
-		// Restore old ramp mode, enable position mode
-		tmc4361A_writeInt(tmc4361A, TMC4361A_RAMPMODE, TMC4361A_RAMP_POSITION | oldRamp);
-
-		state = 5;
-		break;
-	case 5:
-		state = 0;
-		return 1;
-		break;
-	default:
-		break;
-	}
-	return 0;
+	return tmc43xx_core_calibrateClosedLoop(tmc4361A, worker0master1);
 }
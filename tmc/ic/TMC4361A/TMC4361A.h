@@ -9,6 +9,7 @@
 #define TMC_IC_TMC4361A_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ic/TMC43xx/TMC43xx_Core.h"
 #include "TMC4361A_Register.h"
 #include "TMC4361A_Constants.h"
 #include "TMC4361A_Fields.h"
@@ -18,21 +19,23 @@
 	FIELD_GET(tmc4361A_readInt(tdef, address), mask, shift)
 #define TMC4361A_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc4361A_writeInt(tdef, address, FIELD_SET(tmc4361A_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC4361A_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc4361A_writeInt(tdef, address, FIELDS_SET(tmc4361A_readInt(tdef, address), mask, values)))
 
 // Typedefs
-typedef struct
-{
-	ConfigurationTypeDef *config;
-	int velocity;
-	int oldX;
-	uint32_t oldTick;
-	int32_t registerResetState[TMC4361A_REGISTER_COUNT];
-	uint8_t registerAccess[TMC4361A_REGISTER_COUNT];
-	//TMotorConfig motorConfig;
-	//TClosedLoopConfig closedLoopConfig;
-	uint8_t status;
-	ConfigurationTypeDef *cover;
-} TMC4361ATypeDef;
+// The TMC43xx variants share one core, see tmc/ic/TMC43xx/TMC43xx_Core.h
+typedef TMC43xxCoreTypeDef TMC4361ATypeDef;
+
+typedef TMC43xxCoverDatagramTypeDef TMC4361ACoverDatagramTypeDef;
+typedef TMC43xxMoveTypeDef TMC4361AMoveTypeDef;
+typedef TMC43xxMoveQueueTypeDef TMC4361AMoveQueueTypeDef;
+typedef TMC43xxStartGroupTypeDef TMC4361AStartGroupTypeDef;
+typedef TMC43xxTriggerQueueTypeDef TMC4361ATriggerQueueTypeDef;
+
+#define TMC4361A_COVER_TIMEOUT     TMC43XX_COVER_TIMEOUT
+#define TMC4361A_MOVE_QUEUE_SIZE   TMC43XX_MOVE_QUEUE_SIZE
+#define TMC4361A_START_GROUP_SIZE  TMC43XX_START_GROUP_SIZE
 
 typedef void (*tmc4361A_callback)(TMC4361ATypeDef*, ConfigState);
 
@@ -81,6 +84,34 @@ static const uint8_t tmc4361A_defaultRegisterAccess[TMC4361A_REGISTER_COUNT] =
 	0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x13, 0x01, 0x13, 0x13, 0x02, 0x42, 0x01  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc4361A_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc4361A_resettableRegisters[] =
+{
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x10, 0x11, 0x13, 0x14, 0x15, 0x16,
+	0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1D, 0x1E, 0x20, 0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A,
+	0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+	0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B,
+	0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x54, 0x55, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+	0x60, 0x61, 0x63, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x79, 0x7B, 0x7C, 0x7D
+};
+
+static const uint8_t tmc4361A_restorableRegisters[] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x10,
+	0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+	0x21, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+	0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42,
+	0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52,
+	0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60, 0x61, 0x62,
+	0x63, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+	0x7B, 0x7C, 0x7D, 0x7E
+};
+
 // Register constants (only required for 0x42 registers, since we do not have
 // any way to find out the content but want to hold the actual value in the
 // shadow register so an application (i.e. the TMCL IDE) can still display
@@ -111,7 +142,9 @@ static const TMCRegisterConstant tmc4361A_RegisterConstants[] =
 void tmc4361A_writeDatagram(TMC4361ATypeDef *tmc4361A, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc4361A_writeInt(TMC4361ATypeDef *tmc4361A, uint8_t address, int32_t value);
 int32_t tmc4361A_readInt(TMC4361ATypeDef *tmc4361A, uint8_t address);
+void tmc4361A_readIntBatch(TMC4361ATypeDef *tmc4361A, const uint8_t *addresses, int32_t *values, size_t count);
 void tmc4361A_readWriteCover(TMC4361ATypeDef *tmc4361A, uint8_t *data, size_t length);
+bool tmc4361A_readWriteCoverQueue(TMC4361ATypeDef *tmc4361A, TMC4361ACoverDatagramTypeDef *datagrams, size_t count);
 
 // Configuration
 void tmc4361A_init(TMC4361ATypeDef *tmc4361A, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
@@ -120,7 +153,26 @@ uint8_t tmc4361A_reset(TMC4361ATypeDef *tmc4361A);
 uint8_t tmc4361A_restore(TMC4361ATypeDef *tmc4361A);
 void tmc4361A_setRegisterResetState(TMC4361ATypeDef *tmc4361A, const int32_t *resetState);
 void tmc4361A_setCallback(TMC4361ATypeDef *tmc4361A, tmc4361A_callback callback);
-void tmc4361A_periodicJob(TMC4361ATypeDef *tmc4361A, uint32_t tick);
+TMCConfigStatus tmc4361A_periodicJob(TMC4361ATypeDef *tmc4361A, uint32_t tick);
+uint8_t tmc4361A_configureBurst(TMC4361ATypeDef *tmc4361A, uint32_t maxSteps);
+uint8_t tmc4361A_onInterrupt(TMC4361ATypeDef *tmc4361A);
+
+void tmc4361A_moveQueueInit(TMC4361AMoveQueueTypeDef *queue);
+bool tmc4361A_moveQueuePush(TMC4361AMoveQueueTypeDef *queue, const TMC4361AMoveTypeDef *move);
+void tmc4361A_moveQueueService(TMC4361ATypeDef *tmc4361A, TMC4361AMoveQueueTypeDef *queue);
+bool tmc4361A_moveQueueIsDone(TMC4361AMoveQueueTypeDef *queue);
+
+void tmc4361A_startGroupInit(TMC4361AStartGroupTypeDef *group, TMC4361ATypeDef **axes, uint8_t count);
+void tmc4361A_startGroupArm(TMC4361AStartGroupTypeDef *group);
+void tmc4361A_startGroupPreload(TMC4361AStartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax);
+void tmc4361A_startGroupDisarm(TMC4361AStartGroupTypeDef *group);
+
+void tmc4361A_triggerQueueInit(TMC4361ATriggerQueueTypeDef *queue);
+bool tmc4361A_triggerQueuePush(TMC4361ATriggerQueueTypeDef *queue, int32_t position);
+bool tmc4361A_triggerQueueArm(TMC4361ATypeDef *tmc4361A, TMC4361ATriggerQueueTypeDef *queue);
+uint8_t tmc4361A_triggerQueueService(TMC4361ATypeDef *tmc4361A, TMC4361ATriggerQueueTypeDef *queue);
+void tmc4361A_triggerQueueDisarm(TMC4361ATypeDef *tmc4361A, TMC4361ATriggerQueueTypeDef *queue);
+bool tmc4361A_triggerQueueIsDone(TMC4361ATriggerQueueTypeDef *queue);
 
 // Motion
 void tmc4361A_rotate(TMC4361ATypeDef *tmc4361A, int32_t velocity);
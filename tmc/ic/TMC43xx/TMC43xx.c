@@ -72,6 +72,49 @@ const TClosedLoopConfig ClosedLoopConfig=
 	0,           // EncoderCorrectionYOffset
 };
 
+// Shadow register usable for the register? Flag registers and registers with
+// separate read and write values do not read back the written value.
+static uint8_t isShadowed(TMC43xxTypeDef *tmc43xx, uint8_t Address)
+{
+	uint8_t access;
+
+	if(!tmc43xx->registerAccess)
+		return FALSE;
+
+	access = tmc43xx->registerAccess[Address];
+	return TMC_IS_WRITABLE(access) && !(access & (TMC_ACCESS_RW_SPECIAL | TMC_ACCESS_FLAGS));
+}
+
+// Write a register on the chip, bypassing a deferred update
+static void writeRegister(TMC43xxTypeDef *tmc43xx, uint8_t Address, int32_t Value)
+{
+	if(isShadowed(tmc43xx, Address))
+	{
+		tmc43xx->shadowRegister[Address] = Value;
+		TMC_DIRTY_SET(tmc43xx->valid, Address);
+	}
+
+	tmc43xx_spi_writeInt(tmc43xx->axis, Address|TMC43xx_WRITE, Value);
+}
+
+// Current register value for a read-modify-write
+static uint32_t readModifyBase(TMC43xxTypeDef *tmc43xx, uint8_t Address)
+{
+	if(!isShadowed(tmc43xx, Address))
+		return tmc43xx_readInt(tmc43xx, Address);
+
+	if(!TMC_DIRTY_TEST(tmc43xx->valid, Address))
+	{
+		// Write only registers keep the initial shadow value until written
+		if(TMC_IS_READABLE(tmc43xx->registerAccess[Address]))
+			tmc43xx->shadowRegister[Address] = tmc43xx_readInt(tmc43xx, Address);
+
+		TMC_DIRTY_SET(tmc43xx->valid, Address);
+	}
+
+	return tmc43xx->shadowRegister[Address];
+}
+
 /*******************************************************************
 	 Function: tmc43xx_writeBytes()
 	 Parameter: Address: Register address
@@ -81,7 +124,7 @@ const TClosedLoopConfig ClosedLoopConfig=
 
 	 Purpose: Write 4 bytes in a TMC43xx register
 ********************************************************************/
-void tmc43xx_writeBytes(uint8_t Axis, uint8_t Address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
+void tmc43xx_writeBytes(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
 	uint32_t Value;
 
@@ -90,7 +133,7 @@ void tmc43xx_writeBytes(uint8_t Axis, uint8_t Address, uint8_t x1, uint8_t x2, u
 	Value |= x3 << 8;
 	Value |= x4;
 
-	tmc43xx_spi_writeInt(Axis, Address|TMC43xx_WRITE, Value);
+	tmc43xx_writeInt(tmc43xx, Address, Value);
 }
 
 
@@ -102,10 +145,21 @@ void tmc43xx_writeBytes(uint8_t Axis, uint8_t Address, uint8_t x1, uint8_t x2, u
 	 Returns: ---
 
 	 Purpose: Write a 32-Bit value in a TMC43xx register.
+	          During an update only the shadow register is changed.
 ********************************************************************/
-void tmc43xx_writeInt(uint8_t Axis, uint8_t Address, int32_t Value)
+void tmc43xx_writeInt(TMC43xxTypeDef *tmc43xx, uint8_t Address, int32_t Value)
 {
-	tmc43xx_spi_writeInt(Axis, Address|TMC43xx_WRITE, Value);
+	Address = TMC_ADDRESS(Address);
+
+	if(tmc43xx->deferred && isShadowed(tmc43xx, Address))
+	{
+		tmc43xx->shadowRegister[Address] = Value;
+		TMC_DIRTY_SET(tmc43xx->valid, Address);
+		TMC_DIRTY_SET(tmc43xx->dirty, Address);
+		return;
+	}
+
+	writeRegister(tmc43xx, Address, Value);
 }
 
 
@@ -117,62 +171,97 @@ void tmc43xx_writeInt(uint8_t Axis, uint8_t Address, int32_t Value)
 
 	 Purpose: Read a 32-bit value from a TMC43xx register
 ********************************************************************/
-int32_t tmc43xx_readInt(uint8_t Axis, uint8_t Address)
+int32_t tmc43xx_readInt(TMC43xxTypeDef *tmc43xx, uint8_t Address)
 {
-	tmc43xx_spi_readInt(Axis, Address);
-	return tmc43xx_spi_readInt(Axis, Address);
+	tmc43xx_spi_readInt(tmc43xx->axis, Address);
+	return tmc43xx_spi_readInt(tmc43xx->axis, Address);
 }
 
 
-void tmc43xx_setBits(uint8_t Axis, uint8_t Address, uint32_t BitMask)
+void tmc43xx_setBits(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint32_t BitMask)
 {
 	uint32_t Value;
 
-	Value = tmc43xx_readInt(Axis, Address);
+	Address = TMC_ADDRESS(Address);
+	Value = readModifyBase(tmc43xx, Address);
 	Value |= BitMask;
-	tmc43xx_writeInt(Axis, Address, Value);
+	tmc43xx_writeInt(tmc43xx, Address, Value);
 }
 
 
-void tmc43xx_clearBits(uint8_t Axis, uint8_t Address, uint32_t BitMask)
+void tmc43xx_clearBits(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint32_t BitMask)
 {
 	uint32_t Value;
 
-	Value = tmc43xx_readInt(Axis, Address);
+	Address = TMC_ADDRESS(Address);
+	Value = readModifyBase(tmc43xx, Address);
 	Value &= ~BitMask;
-	tmc43xx_writeInt(Axis, Address, Value);
+	tmc43xx_writeInt(tmc43xx, Address, Value);
 }
 
 
-void tmc43xx_writeBits(uint8_t Axis, uint8_t Address, uint32_t Value, uint8_t Start, uint8_t Size)
+void tmc43xx_writeBits(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint32_t Value, uint8_t Start, uint8_t Size)
 {
 	uint32_t RegVal;
 	uint32_t Mask;
 
-	RegVal = tmc43xx_readInt(Axis, Address);
+	Address = TMC_ADDRESS(Address);
+	RegVal = readModifyBase(tmc43xx, Address);
 
-	Mask = 0;
-	uint32_t i;
-	for(i = Start; i < Start+Size; i++)
-		Mask |= (1<<i);
+	Mask = (Size >= 32) ? 0xFFFFFFFF : (((uint32_t) 1 << Size) - 1);
+	Mask <<= Start;
 	RegVal &= ~Mask;
 	RegVal |= (Value << Start) & Mask;
 
-	tmc43xx_writeInt(Axis, Address, RegVal);
+	tmc43xx_writeInt(tmc43xx, Address, RegVal);
 }
 
 
-uint32_t tmc43xx_peekEvents(uint8_t Axis)
+/*******************************************************************
+	 Function: tmc43xx_beginUpdate()
+	 Parameter: ---
+	 Returns: ---
+
+	 Purpose: Start collecting register writes in the shadow registers
+********************************************************************/
+void tmc43xx_beginUpdate(TMC43xxTypeDef *tmc43xx)
 {
-	tmc43xx_writeInt(Axis, TMC4361A_EVENT_CLEAR_CONF, 0xFFFFFFFF);
-	return tmc43xx_readInt(Axis, TMC4361A_EVENTS);
+	tmc43xx->deferred = TRUE;
 }
 
 
-uint32_t tmc43xx_readAndClearEvents(uint8_t Axis, uint32_t EventMask)
+/*******************************************************************
+	 Function: tmc43xx_commit()
+	 Parameter: ---
+	 Returns: ---
+
+	 Purpose: Send every register changed since tmc43xx_beginUpdate()
+	          once, in ascending address order
+********************************************************************/
+void tmc43xx_commit(TMC43xxTypeDef *tmc43xx)
 {
-	tmc43xx_writeInt(Axis, TMC4361A_EVENT_CLEAR_CONF, ~EventMask);
-	return tmc43xx_readInt(Axis, TMC4361A_EVENTS);
+	int32_t Address;
+
+	tmc43xx->deferred = FALSE;
+
+	for(Address = tmc_dirtyNext(tmc43xx->dirty, 0); Address >= 0; Address = tmc_dirtyNext(tmc43xx->dirty, Address + 1))
+		tmc43xx_spi_writeInt(tmc43xx->axis, Address|TMC43xx_WRITE, tmc43xx->shadowRegister[Address]);
+
+	tmc_dirtyClearAll(tmc43xx->dirty);
+}
+
+
+uint32_t tmc43xx_peekEvents(TMC43xxTypeDef *tmc43xx)
+{
+	writeRegister(tmc43xx, TMC4361A_EVENT_CLEAR_CONF, 0xFFFFFFFF);
+	return tmc43xx_readInt(tmc43xx, TMC4361A_EVENTS);
+}
+
+
+uint32_t tmc43xx_readAndClearEvents(TMC43xxTypeDef *tmc43xx, uint32_t EventMask)
+{
+	writeRegister(tmc43xx, TMC4361A_EVENT_CLEAR_CONF, ~EventMask);
+	return tmc43xx_readInt(tmc43xx, TMC4361A_EVENTS);
 }
 
 
@@ -183,90 +272,98 @@ uint32_t tmc43xx_readAndClearEvents(uint8_t Axis, uint32_t EventMask)
 
 	 Purpose: Stop the motor immediately
 ********************************************************************/
-void tmc43xx_hardStop(uint8_t Axis)
+void tmc43xx_hardStop(TMC43xxTypeDef *tmc43xx)
 {
 	tmc43xx_VMaxModified = TRUE;
-	tmc43xx_writeInt(Axis, TMC4361A_RAMPMODE, TMC43xx_RAMPMODE_VEL_HOLD);
-	tmc43xx_writeInt(Axis, TMC4361A_VMAX, 0);
+	writeRegister(tmc43xx, TMC4361A_RAMPMODE, TMC43xx_RAMPMODE_VEL_HOLD);
+	writeRegister(tmc43xx, TMC4361A_VMAX, 0);
 }
 
 
 /*******************************************************************
 	 Function: tmc43xx_init
-	 Parameter: ---
+	 Parameter: axis: Axis number passed to the SPI wrapper
+	            registerAccess: Register access table or NULL
 	 Returns: ---
 
-	 Purpose: Initialize TMC43xx
+	 Purpose: Initialize the instance of one axis and its TMC43xx
 ********************************************************************/
-void tmc43xx_init(uint8_t numberOfMotors)
+void tmc43xx_init(TMC43xxTypeDef *tmc43xx, uint8_t axis, const uint8_t *registerAccess)
 {
-	uint8_t Axis;
-	for(Axis = 0; Axis < numberOfMotors; Axis++)
-	{
-		tmc43xx_writeInt(Axis, TMC4361A_GENERAL_CONF, TMC43xx_GCONF_ENC_INC|TMC43xx_GCONF_ENC_DIFF_DIS);
+	uint8_t i;
+
+	tmc43xx->axis            = axis;
+	tmc43xx->registerAccess  = registerAccess;
+	tmc43xx->deferred        = FALSE;
+	tmc_dirtyClearAll(tmc43xx->valid);
+	tmc_dirtyClearAll(tmc43xx->dirty);
+
+	for(i = 0; i < TMC43xx_REGISTER_COUNT; i++)
+		tmc43xx->shadowRegister[i] = 0;
+
+	tmc43xx_writeInt(tmc43xx, TMC4361A_GENERAL_CONF, TMC43xx_GCONF_ENC_INC|TMC43xx_GCONF_ENC_DIFF_DIS);
 #if defined(DRVTYPE_TMC262)
 	#if defined(TMC4331A) || defined(TMC4361) || defined(TMC4361A)
-		tmc43xx_writeInt(Axis, TMC4361A_SPIOUT_CONF, TMC43xx_SPIOUT_TMC26x_389
-							  |TMC43xx_SPIOUT_ENABLE_SHADOW_DATAGRAMS);  // TMC26x SPI
+	tmc43xx_writeInt(tmc43xx, TMC4361A_SPIOUT_CONF, TMC43xx_SPIOUT_TMC26x_389
+						  |TMC43xx_SPIOUT_ENABLE_SHADOW_DATAGRAMS);  // TMC26x SPI
 	#endif
 #elif defined(DRVTYPE_TMC5130)
-		tmc43xx_writeInt(Axis, TMC4361A_STP_LENGTH_ADD, 0x00050005);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_STP_LENGTH_ADD, 0x00050005);
 	#if defined(TMC4331A) || defined(TMC4361) || defined(TMC4361A)
-		tmc43xx_writeInt(Axis, TMC4361A_SPIOUT_CONF, 0x83300000|TMC43xx_SPIOUT_TMC21xx
-					|TMC43xx_SPIOUT_POLL_BLOCK_MULTI(2)
-					//|TMC43xx_SPIOUT_DISABLE_POLLING
-					|TMC43xx_SPIOUT_ENABLE_SHADOW_DATAGRAMS
-					|TMC43xx_SPIOUT_COVER_DONE_NOT_FOR_CURRENT
-					);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_SPIOUT_CONF, 0x83300000|TMC43xx_SPIOUT_TMC21xx
+				|TMC43xx_SPIOUT_POLL_BLOCK_MULTI(2)
+				//|TMC43xx_SPIOUT_DISABLE_POLLING
+				|TMC43xx_SPIOUT_ENABLE_SHADOW_DATAGRAMS
+				|TMC43xx_SPIOUT_COVER_DONE_NOT_FOR_CURRENT
+				);
 	#endif
-		tmc43xx_writeInt(Axis, TMC4361A_EVENT_CLEAR_CONF, ~TMC43xx_EV_COVER_DONE);  // Read event register deletes only the cover-done bit
-		tmc43xx_readInt(Axis, TMC4361A_EVENTS);
-		tmc43xx_writeBytes(Axis, TMC4361A_COVER_HIGH_WR, 0, 0, 0, 0);
-		tmc43xx_writeInt(Axis, TMC4361A_COVER_LOW_WR, 0);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_EVENT_CLEAR_CONF, ~TMC43xx_EV_COVER_DONE);  // Read event register deletes only the cover-done bit
+	tmc43xx_readInt(tmc43xx, TMC4361A_EVENTS);
+	tmc43xx_writeBytes(tmc43xx, TMC4361A_COVER_HIGH_WR, 0, 0, 0, 0);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_COVER_LOW_WR, 0);
 #else
 #error "Driver type not supported"
 #endif
 
 #if defined(TMC4331A) || defined(TMC4361) || defined(TMC4361A)
-		tmc43xx_writeInt(Axis, TMC4361A_CURRENT_CONF, TMC43xx_CURCONF_HOLD_EN|TMC43xx_CURCONF_DRIVE_EN);  // Current settings through TMC43xx
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CURRENT_CONF, TMC43xx_CURCONF_HOLD_EN|TMC43xx_CURCONF_DRIVE_EN);  // Current settings through TMC43xx
 #endif
-		tmc43xx_writeInt(Axis, TMC4361A_RAMPMODE, TMC43xx_RAMPMODE_POS_HOLD);
-		tmc43xx_writeInt(Axis, TMC4361A_X_TARGET, 0);
-		tmc43xx_writeInt(Axis, TMC4361A_XACTUAL, 0);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_RAMPMODE, TMC43xx_RAMPMODE_POS_HOLD);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_X_TARGET, 0);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_XACTUAL, 0);
 
-		tmc43xx_writeInt(Axis, TMC4361A_VMAX, 51200 << 8);
-		tmc43xx_writeInt(Axis, TMC4361A_AMAX, 51200 << 2);
-		tmc43xx_writeInt(Axis, TMC4361A_DMAX, 51200 << 2);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_VMAX, 51200 << 8);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_AMAX, 51200 << 2);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_DMAX, 51200 << 2);
 
-		tmc43xx_writeBytes(Axis, TMC4361A_SCALE_VALUES, MotorConfig.IStandby, 0, MotorConfig.IRun, MotorConfig.BoostCurrent);
-		tmc43xx_writeInt(Axis, TMC4361A_STDBY_DELAY, MotorConfig.SettingDelay*160000);
+	tmc43xx_writeBytes(tmc43xx, TMC4361A_SCALE_VALUES, MotorConfig.IStandby, 0, MotorConfig.IRun, MotorConfig.BoostCurrent);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_STDBY_DELAY, MotorConfig.SettingDelay*160000);
 
 #if defined(TMC4361) || defined(TMC4361A)
-		tmc43xx_writeInt(Axis, TMC4361A_CL_VMIN_EMF_WR, ClosedLoopConfig.GammaVMin);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_VADD_EMF, ClosedLoopConfig.GammaVAdd);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_BETA, (ClosedLoopConfig.Gamma<<16)|ClosedLoopConfig.Beta);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_OFFSET, ClosedLoopConfig.Offset);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_VMAX_CALC_P_WR, ClosedLoopConfig.CorrectionVelocityP);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_VMAX_CALC_I_WR, ClosedLoopConfig.CorrectionVelocityI);
-		tmc43xx_writeBytes(Axis, TMC4361A_PID_I_CLIP_WR, 0, ClosedLoopConfig.CorrectionVelocityDClk,
-		ClosedLoopConfig.CorrectionVelocityIClip >> 8, ClosedLoopConfig.CorrectionVelocityIClip & 0xFF);
-		tmc43xx_writeInt(Axis, TMC4361A_PID_DV_CLIP_WR, ClosedLoopConfig.CorrectionVelocityDClip);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_UPSCALE_DELAY, ClosedLoopConfig.UpscaleDelay);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_DOWNSCALE_DELAY, ClosedLoopConfig.DownscaleDelay);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_DELTA_P_WR, ClosedLoopConfig.PositionCorrectionP);
-		tmc43xx_writeInt(Axis, TMC4361A_PID_TOLERANCE_WR, ClosedLoopConfig.PositionCorrectionTolerance);
-		tmc43xx_writeInt(Axis, TMC4361A_CL_TR_TOLERANCE_WR, ClosedLoopConfig.PositionWindow);
-		tmc43xx_writeBytes(Axis, TMC4361A_ENC_VMEAN_WAIT_WR, ClosedLoopConfig.EncVMeanInt >> 8,
-		ClosedLoopConfig.EncVMeanInt & 0xFF, ClosedLoopConfig.EncVMeanFilter,
-		ClosedLoopConfig.EncVMeanWait);
-
-		tmc43xx_writeBytes(Axis, TMC4361A_ENC_COMP_XOFFSET, 0, ClosedLoopConfig.EncoderCorrectionYOffset, 0, 0);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_VMIN_EMF_WR, ClosedLoopConfig.GammaVMin);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_VADD_EMF, ClosedLoopConfig.GammaVAdd);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_BETA, (ClosedLoopConfig.Gamma<<16)|ClosedLoopConfig.Beta);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_OFFSET, ClosedLoopConfig.Offset);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_VMAX_CALC_P_WR, ClosedLoopConfig.CorrectionVelocityP);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_VMAX_CALC_I_WR, ClosedLoopConfig.CorrectionVelocityI);
+	tmc43xx_writeBytes(tmc43xx, TMC4361A_PID_I_CLIP_WR, 0, ClosedLoopConfig.CorrectionVelocityDClk,
+	ClosedLoopConfig.CorrectionVelocityIClip >> 8, ClosedLoopConfig.CorrectionVelocityIClip & 0xFF);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_PID_DV_CLIP_WR, ClosedLoopConfig.CorrectionVelocityDClip);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_UPSCALE_DELAY, ClosedLoopConfig.UpscaleDelay);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_DOWNSCALE_DELAY, ClosedLoopConfig.DownscaleDelay);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_DELTA_P_WR, ClosedLoopConfig.PositionCorrectionP);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_PID_TOLERANCE_WR, ClosedLoopConfig.PositionCorrectionTolerance);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_CL_TR_TOLERANCE_WR, ClosedLoopConfig.PositionWindow);
+	tmc43xx_writeBytes(tmc43xx, TMC4361A_ENC_VMEAN_WAIT_WR, ClosedLoopConfig.EncVMeanInt >> 8,
+	ClosedLoopConfig.EncVMeanInt & 0xFF, ClosedLoopConfig.EncVMeanFilter,
+	ClosedLoopConfig.EncVMeanWait);
+
+	tmc43xx_writeBytes(tmc43xx, TMC4361A_ENC_COMP_XOFFSET, 0, ClosedLoopConfig.EncoderCorrectionYOffset, 0, 0);
 #endif
 
-		// Für Home-Switch-Abfrage
-		tmc43xx_writeInt(Axis, TMC4361A_REFERENCE_CONF, BIT17|BIT16);
-		tmc43xx_writeInt(Axis, TMC4361A_X_HOME, 0x7FFFFFFF);
-	}
+	// Für Home-Switch-Abfrage
+	tmc43xx_writeInt(tmc43xx, TMC4361A_REFERENCE_CONF, BIT17|BIT16);
+	tmc43xx_writeInt(tmc43xx, TMC4361A_X_HOME, 0x7FFFFFFF);
 }
 
 /*******************************************************************
@@ -277,9 +374,9 @@ void tmc43xx_init(uint8_t numberOfMotors)
 	 Purpose: Polls home-input. Works only if bits 17 and 16 in
 	          REFERENCE_CONF are set and XHOME of INT_MAX as well (trick)
 ********************************************************************/
-uint8_t tmc43xx_getHomeInput(uint8_t Motor)
+uint8_t tmc43xx_getHomeInput(TMC43xxTypeDef *tmc43xx)
 {
-	if(tmc43xx_readInt(Motor, TMC4361A_STATUS) & TMC43xx_ST_HOME_ERROR)
+	if(tmc43xx_readInt(tmc43xx, TMC4361A_STATUS) & TMC43xx_ST_HOME_ERROR)
 		return TRUE;
 	else
 		return FALSE;
@@ -292,26 +389,26 @@ uint8_t tmc43xx_getHomeInput(uint8_t Motor)
 
 	 Purpose: Moves from the current position to the next fullstep
 ********************************************************************/
-uint8_t tmc43xx_moveToNextFullstep(uint8_t Axis)
+uint8_t tmc43xx_moveToNextFullstep(TMC43xxTypeDef *tmc43xx)
 {
 	int32_t value;
 	int32_t mscnt;
 
-	if(tmc43xx_readInt(Axis, TMC4361A_VACTUAL) != 0) // motor must be stopped
+	if(tmc43xx_readInt(tmc43xx, TMC4361A_VACTUAL) != 0) // motor must be stopped
 		return 0;
 
-	tmc43xx_writeInt(Axis, TMC4361A_RAMPMODE, TMC43xx_RAMPMODE_POS_HOLD);  // positioning & hold mode
-	tmc43xx_writeInt(Axis, TMC4361A_VMAX, 10000<<8);                       // low velocity
+	tmc43xx_writeInt(tmc43xx, TMC4361A_RAMPMODE, TMC43xx_RAMPMODE_POS_HOLD);  // positioning & hold mode
+	tmc43xx_writeInt(tmc43xx, TMC4361A_VMAX, 10000<<8);                       // low velocity
 
-	mscnt = tmc43xx_readInt(Axis, TMC4361A_MSCNT_RD) & 0x3FF;              // position in microstep table
+	mscnt = tmc43xx_readInt(tmc43xx, TMC4361A_MSCNT_RD) & 0x3FF;              // position in microstep table
 	value = mscnt & 0xFF;                                                  // if last 8 bits are 0 its a multiple of 256
 	value = 128-value;                                                     // assuming 256 µsteps fullsteps are 128+n*256
 
 	if(!value) // fullstep position reached
 		return 1;
 
-	value = tmc43xx_readInt(Axis, TMC4361A_XACTUAL) + value;               // distance to next fullstep, assume 256 µsteps resolution
-	tmc43xx_writeInt(Axis, TMC4361A_X_TARGET, value);                      // move to next fullstep
+	value = tmc43xx_readInt(tmc43xx, TMC4361A_XACTUAL) + value;               // distance to next fullstep, assume 256 µsteps resolution
+	tmc43xx_writeInt(tmc43xx, TMC4361A_X_TARGET, value);                      // move to next fullstep
 
 	return 0;
 }
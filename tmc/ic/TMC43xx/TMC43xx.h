@@ -12,6 +12,7 @@
 #include "tmc/helpers/API_Header.h"
 
 #define TMC43xx_WRITE 0x80
+#define TMC43xx_REGISTER_COUNT 128
 
 // TMC43xx GENERAL_CONFIG bits
 #define TMC43xx_GCONF_USE_AVSTART          0x00000001
@@ -187,19 +188,38 @@
 #define TMC43xx_REFCONF_DRV_AFTER_STALL    0x08000000
 #define TMC43xx_REFCONF_CIRCULAR_ENC_EN    0x80000000
 
+// One instance per axis.
+// The bit functions (setBits, clearBits, writeBits) work on the shadow register
+// of the axis: a register is read from the chip once, afterwards the written value
+// is used. Between tmc43xx_beginUpdate() and tmc43xx_commit() all writes only change
+// the shadow registers, the commit then sends each changed register once.
+// Shadowing requires registerAccess (e.g. tmc4361A_defaultRegisterAccess). Registers
+// with flags or separate read/write values are always accessed on the chip.
+typedef struct
+{
+	uint8_t axis;                                    // Passed to the SPI wrapper
+	const uint8_t *registerAccess;                   // NULL: no shadowing
+	int32_t shadowRegister[TMC43xx_REGISTER_COUNT];
+	uint32_t valid[TMC_DIRTY_WORDS];                 // Shadow register holds the register value
+	uint32_t dirty[TMC_DIRTY_WORDS];                 // Changed during an update, not sent yet
+	uint8_t deferred;
+} TMC43xxTypeDef;
+
 // TMC43xx access functions
-void tmc43xx_writeBytes(uint8_t Axis, uint8_t Address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
-void tmc43xx_writeInt(uint8_t Axis, uint8_t Address, int32_t Value);
-int32_t tmc43xx_readInt(uint8_t Axis, uint8_t Address);
-void tmc43xx_setBits(uint8_t Axis, uint8_t Address, uint32_t BitMask);
-void tmc43xx_clearBits(uint8_t Axis, uint8_t Address, uint32_t BitMask);
-void tmc43xx_writeBits(uint8_t Axis, uint8_t Address, uint32_t Value, uint8_t Start, uint8_t Size);
-uint32_t tmc43xx_peekEvents(uint8_t Axis);
-uint32_t tmc43xx_readAndClearEvents(uint8_t Axis, uint32_t EventMask);
-uint8_t tmc43xx_getHomeInput(uint8_t Motor);
-uint8_t tmc43xx_moveToNextFullstep(uint8_t Axis);
-void tmc43xx_hardStop(uint8_t Axis);
-void tmc43xx_init(uint8_t numberOfMotors);
+void tmc43xx_writeBytes(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
+void tmc43xx_writeInt(TMC43xxTypeDef *tmc43xx, uint8_t Address, int32_t Value);
+int32_t tmc43xx_readInt(TMC43xxTypeDef *tmc43xx, uint8_t Address);
+void tmc43xx_setBits(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint32_t BitMask);
+void tmc43xx_clearBits(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint32_t BitMask);
+void tmc43xx_writeBits(TMC43xxTypeDef *tmc43xx, uint8_t Address, uint32_t Value, uint8_t Start, uint8_t Size);
+void tmc43xx_beginUpdate(TMC43xxTypeDef *tmc43xx);
+void tmc43xx_commit(TMC43xxTypeDef *tmc43xx);
+uint32_t tmc43xx_peekEvents(TMC43xxTypeDef *tmc43xx);
+uint32_t tmc43xx_readAndClearEvents(TMC43xxTypeDef *tmc43xx, uint32_t EventMask);
+uint8_t tmc43xx_getHomeInput(TMC43xxTypeDef *tmc43xx);
+uint8_t tmc43xx_moveToNextFullstep(TMC43xxTypeDef *tmc43xx);
+void tmc43xx_hardStop(TMC43xxTypeDef *tmc43xx);
+void tmc43xx_init(TMC43xxTypeDef *tmc43xx, uint8_t axis, const uint8_t *registerAccess);
 
 typedef struct
 {
@@ -0,0 +1,903 @@
+/*
+ * TMC43xx_Core.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "TMC43xx_Core.h"
+
+// Registers and fields shared by all variants
+#define START_CONF          0x02
+#define ENC_IN_CONF         0x07
+#define EVENTS              0x0E
+#define STATUS              0x0F
+#define RAMPMODE            0x20
+#define XACTUAL             0x21
+#define VACTUAL             0x22
+#define POS_COMP            0x32
+#define VMAX                0x24
+#define AMAX                0x28
+#define DMAX                0x29
+#define X_TARGET            0x37
+#define X_PIPE0             0x38
+#define SH_REG0             0x40
+#define SH_REG1             0x41
+#define SH_REG2             0x42
+#define COVER_LOW_WR        0x6C
+#define COVER_HIGH_WR       0x6D
+#define COVER_DRV_LOW_RD    0x6E
+#define COVER_DRV_HIGH_RD   0x6F
+#define MSCNT_RD            0x79
+
+#define OPERATION_MODE_MASK      0x04 // RAMPMODE
+#define OPERATION_MODE_SHIFT     2
+#define RAMP_POSITION            4    // RAMPMODE: position mode
+#define RAMP_HOLD                0    // RAMPMODE: no ramp
+#define START_EN0_MASK           0x01 // START_CONF
+#define START_EN4_MASK           0x10
+#define TRIGGER_EVENTS0_MASK     0x20
+#define TRIGGER_EVENTS1_MASK     0x40
+#define TRIGGER_EVENTS3_MASK     0x0100
+#define IMMEDIATE_START_IN_MASK  0x0400
+#define PIPELINE_EN_MASK         0xF000
+#define PIPELINE_EN1_MASK        0x2000
+#define SHADOW_OPTION_MASK       0x030000
+#define REGULATION_MODUS_MASK    0xC00000   // ENC_IN_CONF
+#define REGULATION_MODUS_SHIFT   22
+#define CL_CALIBRATION_EN_MASK   0x01000000
+#define CL_CALIBRATION_EN_SHIFT  24
+#define TARGET_REACHED_MASK      0x01       // EVENTS
+#define POS_COMP_REACHED_MASK    0x02
+#define COVER_DONE_MASK          0x02000000
+#define TARGET_REACHED_F_MASK    0x01       // STATUS
+#define MSCNT_MASK               0x03FF     // MSCNT_RD
+
+// START_CONF bits used by the move queue: XTARGET and the shadow registers
+// (SHADOW_OPTION 0: SH_REG0-2 = VMAX, AMAX, DMAX) are taken over on TARGET_REACHED
+#define MOVE_QUEUE_START_CONF  (START_EN0_MASK | START_EN4_MASK | TRIGGER_EVENTS1_MASK)
+
+// START_CONF bits of an armed start group axis: XTARGET is taken over on the external
+// START signal, without the start delay. The remaining START_CONF bits (e.g. the START
+// polarity) are kept.
+#define START_GROUP_MASK        (0x01FF | IMMEDIATE_START_IN_MASK)
+#define START_GROUP_START_CONF  (START_EN0_MASK | TRIGGER_EVENTS0_MASK | IMMEDIATE_START_IN_MASK)
+
+// START_CONF bits of an armed trigger queue: Every POS_COMP_REACHED is an internal start
+// signal, which shifts X_PIPE0 into POS_COMP (and the pipeline on by one)
+#define TRIGGER_QUEUE_MASK        (0x01E0 | PIPELINE_EN_MASK)
+#define TRIGGER_QUEUE_START_CONF  (TRIGGER_EVENTS3_MASK | PIPELINE_EN1_MASK)
+
+// POS_COMP and X_PIPE0-7
+#define TRIGGER_QUEUE_SLOTS 9
+
+#define CORE_FIELD_WRITE(tmc43xx, address, mask, shift, value) \
+	(tmc43xx_core_writeInt(tmc43xx, address, FIELD_SET(tmc43xx_core_readInt(tmc43xx, address), mask, shift, value)))
+
+static void transfer(TMC43xxCoreTypeDef *tmc43xx, uint8_t *data)
+{
+	const TMCSpiInterface *spi = &tmc43xx->variant->spi;
+
+	TMC_INSTRUMENT_SPI(spi->name, spi->readWriteArray, tmc43xx->config->channel, data, TMC_SPI_DATAGRAM_LENGTH);
+	tmc43xx->status = data[0];
+}
+
+static int32_t replyValue(const uint8_t *data)
+{
+	return tmc_unpackInt32(&data[1]);
+}
+
+// Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
+void tmc43xx_core_writeDatagram(TMC43xxCoreTypeDef *tmc43xx, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH] = { address | TMC_WRITE_BIT, x1, x2, x3, x4 };
+
+	transfer(tmc43xx, data);
+
+	// Write to the shadow register and mark the register dirty
+	address = TMC_ADDRESS(address);
+	tmc43xx->config->shadowRegister[address] = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
+	tmc43xx->registerAccess[address] |= TMC_ACCESS_DIRTY;
+}
+
+void tmc43xx_core_writeInt(TMC43xxCoreTypeDef *tmc43xx, uint8_t address, int32_t value)
+{
+	tmc43xx_core_writeDatagram(tmc43xx, address, BYTE(value, 3), BYTE(value, 2), BYTE(value, 1), BYTE(value, 0));
+}
+
+int32_t tmc43xx_core_readInt(TMC43xxCoreTypeDef *tmc43xx, uint8_t address)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH] = { 0 };
+
+	address = TMC_ADDRESS(address);
+
+	// register not readable -> shadow register copy
+	if(!TMC_IS_READABLE(tmc43xx->registerAccess[address]))
+		return tmc43xx->config->shadowRegister[address];
+
+	TMC_LOCK(tmc43xx->config->channel);
+
+	data[0] = address;
+	transfer(tmc43xx, data);
+
+	data[0] = address;
+	data[1] = data[2] = data[3] = data[4] = 0;
+	transfer(tmc43xx, data);
+
+	TMC_UNLOCK(tmc43xx->config->channel);
+
+	return replyValue(data);
+}
+
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc43xx_core_readIntBatch(TMC43xxCoreTypeDef *tmc43xx, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[TMC_SPI_DATAGRAM_LENGTH];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	TMC_LOCK(tmc43xx->config->channel);
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		if(!TMC_IS_READABLE(tmc43xx->registerAccess[address]))
+		{
+			values[i] = tmc43xx->config->shadowRegister[address];
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		transfer(tmc43xx, data);
+
+		if(pending < count)
+			values[pending] = replyValue(data);
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		transfer(tmc43xx, data);
+		values[pending] = replyValue(data);
+	}
+
+	TMC_UNLOCK(tmc43xx->config->channel);
+}
+
+// Send one cover datagram and wait for the COVER_DONE event.
+// Returns false if the reply did not arrive within TMC43XX_COVER_TIMEOUT polls.
+static bool coverTransfer(TMC43xxCoreTypeDef *tmc43xx, uint8_t *data, size_t length)
+{
+	static const uint8_t addresses[] = { EVENTS, COVER_DRV_LOW_RD, COVER_DRV_HIGH_RD };
+	uint8_t bytes[8] = { 0 };
+	int32_t values[3];
+	size_t i;
+
+	// Check if datagram length is valid
+	if(length == 0 || length > 8)
+		return false;
+
+	// Copy data into buffer of maximum cover datagram length (8 bytes)
+	for(i = 0; i < length; i++)
+		bytes[i] = data[length-i-1];
+
+	// Reading EVENTS clears a COVER_DONE left from an earlier datagram.
+	// Other events are kept for the application.
+	tmc43xx->events |= tmc43xx_core_readInt(tmc43xx, EVENTS) & ~COVER_DONE_MASK;
+
+	// Send the datagram
+	if(length > 4)
+		tmc43xx_core_writeDatagram(tmc43xx, COVER_HIGH_WR, bytes[7], bytes[6], bytes[5], bytes[4]);
+
+	tmc43xx_core_writeDatagram(tmc43xx, COVER_LOW_WR, bytes[3], bytes[2], bytes[1], bytes[0]);
+
+	// Poll EVENTS and read the reply with the same pipelined batch.
+	// The reply registers are sampled after EVENTS, so they are valid once COVER_DONE is set.
+	for(i = 0; ; i++)
+	{
+		if(i == TMC43XX_COVER_TIMEOUT)
+			return false;
+
+		tmc43xx_core_readIntBatch(tmc43xx, addresses, values, (length > 4) ? 3 : 2);
+		tmc43xx->events |= values[0] & ~COVER_DONE_MASK;
+
+		if(values[0] & COVER_DONE_MASK)
+			break;
+	}
+
+	// Write the reply to the data array
+	for(i = 0; i < length; i++)
+		data[length-i-1] = BYTE(values[1 + i / 4], i % 4);
+
+	return true;
+}
+
+// Send the cover datagrams one after another. Returns false if a reply timed out,
+// the remaining datagrams are not sent then. Variants without a driver SPI output
+// always return false.
+bool tmc43xx_core_readWriteCoverQueue(TMC43xxCoreTypeDef *tmc43xx, TMC43xxCoverDatagramTypeDef *datagrams, size_t count)
+{
+	// Buffering old values to not interrupt manual covering
+	int32_t old_high = tmc43xx->config->shadowRegister[COVER_HIGH_WR];
+	int32_t old_low = tmc43xx->config->shadowRegister[COVER_LOW_WR];
+	bool success = (tmc43xx->variant->features & TMC43XX_FEATURE_COVER) != 0;
+	size_t i;
+
+	for(i = 0; (i < count) && success; i++)
+		success = coverTransfer(tmc43xx, datagrams[i].data, datagrams[i].length);
+
+	// Rewriting old values to prevent interrupting manual covering. Imitating unchanged values and state.
+	// COVER_HIGH_WR only changed if a long datagram was sent.
+	if(tmc43xx->config->shadowRegister[COVER_HIGH_WR] != old_high)
+		tmc43xx_core_writeInt(tmc43xx, COVER_HIGH_WR, old_high);
+	tmc43xx->config->shadowRegister[COVER_LOW_WR] = old_low;
+
+	return success;
+}
+
+// Send [length] bytes stored in the [data] array to a driver attached to the motion controller
+// and overwrite [data] with the replies. data[0] is the first byte sent and received.
+void tmc43xx_core_readWriteCover(TMC43xxCoreTypeDef *tmc43xx, uint8_t *data, size_t length)
+{
+	TMC43xxCoverDatagramTypeDef datagram = { data, length };
+
+	tmc43xx_core_readWriteCoverQueue(tmc43xx, &datagram, 1);
+}
+
+void tmc43xx_core_init(TMC43xxCoreTypeDef *tmc43xx, const TMC43xxVariantTypeDef *variant, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
+{
+	size_t i;
+
+	tmc43xx->variant           = variant;
+	tmc43xx->velocity          = 0;
+	tmc43xx->oldTick           = 0;
+	tmc43xx->oldX              = 0;
+	tmc43xx->status            = 0;
+	tmc43xx->events            = 0;
+	tmc43xx->statusFlags       = 0;
+	tmc43xx->calibrationState  = 0;
+	tmc43xx->calibrationRamp   = 0;
+	tmc43xx->config            = config;
+
+	tmc43xx->config->callback     = NULL;
+	tmc43xx->config->channel      = channel;
+	tmc43xx->config->configIndex  = 0;
+	tmc43xx->config->state        = CONFIG_READY;
+
+	for(i = 0; i < TMC_REGISTER_COUNT; i++)
+	{
+		tmc43xx->registerAccess[i]      = variant->defaultRegisterAccess[i];
+#ifndef TMC_RESET_STATE_CONST
+		tmc43xx->registerResetState[i]  = registerResetState[i];
+#endif
+	}
+
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_init(&tmc43xx->registerResetState, registerResetState);
+#endif
+}
+
+// Fill the shadow registers of hardware preset non-readable registers
+// Only needed if you want to read out those registers to display the value
+// (e.g. for the TMCL IDE register browser)
+void tmc43xx_core_fillShadowRegisters(TMC43xxCoreTypeDef *tmc43xx)
+{
+	tmc_fillShadowRegisters(tmc43xx->config, tmc43xx->registerAccess, NULL, tmc43xx->variant->constants, tmc43xx->variant->constantCount);
+}
+
+uint8_t tmc43xx_core_reset(TMC43xxCoreTypeDef *tmc43xx)
+{
+	size_t i;
+
+	if(tmc43xx->config->state != CONFIG_READY)
+		return 0;
+
+	// Reset the dirty bits
+	for(i = 0; i < TMC_REGISTER_COUNT; i++)
+		tmc43xx->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+
+	tmc43xx->config->state        = CONFIG_RESET;
+	tmc43xx->config->configIndex  = 0;
+
+	return 1;
+}
+
+uint8_t tmc43xx_core_restore(TMC43xxCoreTypeDef *tmc43xx)
+{
+	if(tmc43xx->config->state != CONFIG_READY)
+		return 0;
+
+	tmc43xx->config->state        = CONFIG_RESTORE;
+	tmc43xx->config->configIndex  = 0;
+
+	return 1;
+}
+
+void tmc43xx_core_setRegisterResetState(TMC43xxCoreTypeDef *tmc43xx, const int32_t *resetState)
+{
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_setAll(&tmc43xx->registerResetState, resetState, TMC_REGISTER_COUNT);
+#else
+	size_t i;
+	for(i = 0; i < TMC_REGISTER_COUNT; i++)
+		tmc43xx->registerResetState[i] = resetState[i];
+#endif
+}
+
+// Reset value of the given register
+static int32_t resetValue(TMC43xxCoreTypeDef *tmc43xx, uint8_t address)
+{
+#ifdef TMC_RESET_STATE_CONST
+	return tmc_resetState_get(&tmc43xx->registerResetState, address);
+#else
+	return tmc43xx->registerResetState[address];
+#endif
+}
+
+static void writeConfiguration(TMC43xxCoreTypeDef *tmc43xx)
+{
+	const TMC43xxVariantTypeDef *variant = tmc43xx->variant;
+	uint8_t *ptr = &tmc43xx->config->configIndex;
+	const uint8_t *registers;
+	size_t registerCount;
+
+	if(tmc43xx->config->state == CONFIG_RESTORE)
+	{
+		registers      = variant->restorableRegisters;
+		registerCount  = variant->restorableCount;
+		// Skip hardware preset registers that have not been written yet
+		while((*ptr < registerCount) && !TMC_IS_RESTORABLE(tmc43xx->registerAccess[registers[*ptr]]))
+			(*ptr)++;
+	}
+	else
+	{
+		registers      = variant->resettableRegisters;
+		registerCount  = variant->resettableCount;
+	}
+
+	if(*ptr < registerCount)
+	{
+		uint8_t address = registers[*ptr];
+
+		tmc43xx_core_writeInt(tmc43xx, address, (tmc43xx->config->state == CONFIG_RESTORE)
+				? tmc43xx->config->shadowRegister[address]
+				: resetValue(tmc43xx, address));
+		(*ptr)++;
+	}
+	else
+	{
+		if(tmc43xx->config->callback)
+		{
+			// The IC specific callback types only differ in the name of the TypeDef alias
+			((void (*)(TMC43xxCoreTypeDef *, ConfigState)) tmc43xx->config->callback)(tmc43xx, tmc43xx->config->state);
+		}
+
+		tmc43xx->config->state = CONFIG_READY;
+	}
+}
+
+TMCConfigStatus tmc43xx_core_periodicJob(TMC43xxCoreTypeDef *tmc43xx, uint32_t tick)
+{
+	if(tmc43xx->config->state != CONFIG_READY)
+	{
+		writeConfiguration(tmc43xx);
+		return TMC_CONFIG_STATUS(tmc43xx->config);
+	}
+
+	if((tick - tmc43xx->oldTick) != 0)
+	{
+		if(tmc43xx->variant->features & TMC43XX_FEATURE_CLOSED_LOOP)
+			tmc43xx_core_calibrateClosedLoop(tmc43xx, 0);
+
+		tmc43xx->oldTick = tick;
+	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc43xx_core_configureBurst(TMC43xxCoreTypeDef *tmc43xx, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc43xx->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc43xx);
+	}
+
+	return (tmc43xx->config->state == CONFIG_READY);
+}
+
+// Event driven status
+// Select the events signalled on the INTR pin with INTR_CONF and call this from
+// the GPIO interrupt instead of polling EVENTS periodically. EVENTS and STATUS are
+// read in one pipelined burst. Reading EVENTS clears the flags (see EVENT_CLEAR_CONF),
+// they are collected in tmc43xx->events for the application to handle.
+// Returns true if a new event was read.
+uint8_t tmc43xx_core_onInterrupt(TMC43xxCoreTypeDef *tmc43xx)
+{
+	static const uint8_t addresses[] = { EVENTS, STATUS };
+	int32_t values[ARRAY_SIZE(addresses)];
+	uint32_t events;
+
+	tmc43xx_core_readIntBatch(tmc43xx, addresses, values, ARRAY_SIZE(addresses));
+
+	// COVER_DONE belongs to a running cover transfer
+	events = values[0] & ~COVER_DONE_MASK;
+
+	tmc43xx->events      |= events;
+	tmc43xx->statusFlags  = values[1];
+
+	return (events != 0);
+}
+
+void tmc43xx_core_rotate(TMC43xxCoreTypeDef *tmc43xx, int32_t velocity)
+{
+	// Disable Position Mode
+	CORE_FIELD_WRITE(tmc43xx, RAMPMODE, OPERATION_MODE_MASK, OPERATION_MODE_SHIFT, 0);
+
+	tmc43xx_core_writeInt(tmc43xx, VMAX, tmc43xx_core_discardVelocityDecimals(velocity));
+}
+
+void tmc43xx_core_moveTo(TMC43xxCoreTypeDef *tmc43xx, int32_t position, uint32_t velocityMax)
+{
+	// Enable Position Mode
+	CORE_FIELD_WRITE(tmc43xx, RAMPMODE, OPERATION_MODE_MASK, OPERATION_MODE_SHIFT, 1);
+
+	tmc43xx_core_writeInt(tmc43xx, VMAX, tmc43xx_core_discardVelocityDecimals(velocityMax));
+
+	tmc43xx_core_writeInt(tmc43xx, X_TARGET, position);
+}
+
+// The function will write the absolute target position to *ticks
+void tmc43xx_core_moveBy(TMC43xxCoreTypeDef *tmc43xx, int32_t *ticks, uint32_t velocityMax)
+{
+	// determine actual position and add numbers of ticks to move
+	*ticks += tmc43xx_core_readInt(tmc43xx, XACTUAL);
+
+	tmc43xx_core_moveTo(tmc43xx, *ticks, velocityMax);
+}
+
+// Move queue
+// Push moves from the application, call tmc43xx_core_moveQueueService() periodically
+// (or from the INTR interrupt on TARGET_REACHED). The IC switches to a preloaded
+// move on its own once the running move reaches its target, the service only
+// has to preload the following move before that.
+#define MOVE_QUEUE_MASK (TMC43XX_MOVE_QUEUE_SIZE - 1)
+
+void tmc43xx_core_moveQueueInit(TMC43xxMoveQueueTypeDef *queue)
+{
+	queue->head    = 0;
+	queue->tail    = 0;
+	queue->active  = 0;
+}
+
+// Returns false if the queue is full
+bool tmc43xx_core_moveQueuePush(TMC43xxMoveQueueTypeDef *queue, const TMC43xxMoveTypeDef *move)
+{
+	if(((queue->tail + 1) & MOVE_QUEUE_MASK) == queue->head)
+		return false;
+
+	queue->moves[queue->tail] = *move;
+	queue->tail = (queue->tail + 1) & MOVE_QUEUE_MASK;
+
+	return true;
+}
+
+void tmc43xx_core_moveQueueService(TMC43xxCoreTypeDef *tmc43xx, TMC43xxMoveQueueTypeDef *queue)
+{
+	static const uint8_t addresses[] = { EVENTS, STATUS, XACTUAL };
+	int32_t values[ARRAY_SIZE(addresses)];
+	int32_t startConf;
+	const TMC43xxMoveTypeDef *move;
+
+	tmc43xx_core_readIntBatch(tmc43xx, addresses, values, ARRAY_SIZE(addresses));
+	tmc43xx->events |= values[0] & ~COVER_DONE_MASK;
+
+	// Target reached -> the IC started the preloaded move
+	if(tmc43xx->events & TARGET_REACHED_MASK)
+	{
+		tmc43xx->events &= ~TARGET_REACHED_MASK;
+
+		if(queue->active == 2)
+		{
+			queue->head = (queue->head + 1) & MOVE_QUEUE_MASK;
+			queue->active = 1;
+		}
+	}
+
+	// Standing at the target: The running move is done. If the move was preloaded
+	// too late to be taken over, the IC is not at its position and it is started again.
+	if((queue->active == 1) && (values[1] & TARGET_REACHED_F_MASK))
+	{
+		if(values[2] == queue->moves[queue->head].position)
+			queue->head = (queue->head + 1) & MOVE_QUEUE_MASK;
+
+		queue->active = 0;
+	}
+
+	startConf = tmc43xx_core_readInt(tmc43xx, START_CONF) & ~(MOVE_QUEUE_START_CONF | SHADOW_OPTION_MASK);
+
+	// Idle -> start the next move right away
+	if((queue->active == 0) && (queue->head != queue->tail))
+	{
+		move = &queue->moves[queue->head];
+
+		tmc43xx_core_writeInt(tmc43xx, START_CONF, startConf);
+		CORE_FIELD_WRITE(tmc43xx, RAMPMODE, OPERATION_MODE_MASK, OPERATION_MODE_SHIFT, 1);
+		tmc43xx_core_writeInt(tmc43xx, VMAX, tmc43xx_core_discardVelocityDecimals(move->velocityMax));
+		tmc43xx_core_writeInt(tmc43xx, AMAX, move->acceleration);
+		tmc43xx_core_writeInt(tmc43xx, DMAX, move->deceleration);
+		tmc43xx_core_writeInt(tmc43xx, X_TARGET, move->position);
+		queue->active = 1;
+	}
+
+	// One move running -> preload the following one, taken over on TARGET_REACHED
+	if((queue->active == 1) && (((queue->head + 1) & MOVE_QUEUE_MASK) != queue->tail))
+	{
+		move = &queue->moves[(queue->head + 1) & MOVE_QUEUE_MASK];
+
+		tmc43xx_core_writeInt(tmc43xx, START_CONF, startConf | MOVE_QUEUE_START_CONF);
+		tmc43xx_core_writeInt(tmc43xx, SH_REG0, tmc43xx_core_discardVelocityDecimals(move->velocityMax));
+		tmc43xx_core_writeInt(tmc43xx, SH_REG1, move->acceleration);
+		tmc43xx_core_writeInt(tmc43xx, SH_REG2, move->deceleration);
+		tmc43xx_core_writeInt(tmc43xx, X_TARGET, move->position);
+		queue->active = 2;
+	}
+}
+
+// Returns true once all queued moves are finished
+bool tmc43xx_core_moveQueueIsDone(TMC43xxMoveQueueTypeDef *queue)
+{
+	return (queue->active == 0) && (queue->head == queue->tail);
+}
+
+// Start group
+// Usage: Arm the group, preload the target of every axis, pulse the shared START line,
+// wait for the axes to start (or finish) and disarm the group again.
+// The axes have to be in position mode at standstill before arming, so switching
+// RAMPMODE and VMAX in the preload does not start a motion on its own.
+// Axes of different variants can be mixed in one group.
+
+void tmc43xx_core_startGroupInit(TMC43xxStartGroupTypeDef *group, TMC43xxCoreTypeDef **axes, uint8_t count)
+{
+	uint8_t i;
+
+	group->count = MIN(count, TMC43XX_START_GROUP_SIZE);
+
+	for(i = 0; i < group->count; i++)
+	{
+		group->axes[i]       = axes[i];
+		group->startConf[i]  = 0;
+	}
+}
+
+// Hold back XTARGET writes of all axes until the START signal
+void tmc43xx_core_startGroupArm(TMC43xxStartGroupTypeDef *group)
+{
+	uint8_t i;
+
+	for(i = 0; i < group->count; i++)
+	{
+		group->startConf[i] = tmc43xx_core_readInt(group->axes[i], START_CONF);
+		tmc43xx_core_writeInt(group->axes[i], START_CONF, FIELDS_SET(group->startConf[i], START_GROUP_MASK, START_GROUP_START_CONF));
+	}
+}
+
+// Preload a move of [axis], it starts with the next START signal
+void tmc43xx_core_startGroupPreload(TMC43xxStartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax)
+{
+	if(axis >= group->count)
+		return;
+
+	tmc43xx_core_moveTo(group->axes[axis], position, velocityMax);
+}
+
+// Restore the START_CONF of all axes
+void tmc43xx_core_startGroupDisarm(TMC43xxStartGroupTypeDef *group)
+{
+	uint8_t i;
+
+	for(i = 0; i < group->count; i++)
+		tmc43xx_core_writeInt(group->axes[i], START_CONF, group->startConf[i]);
+}
+
+// Trigger queue
+// Push the trigger positions, arm the queue and call tmc43xx_core_triggerQueueService()
+// from the INTR interrupt on POS_COMP_REACHED (or periodically). The IC fires the
+// position compare output and loads the next position on its own, the service only
+// refills the pipeline behind the fired positions. Up to 9 positions are loaded at
+// once, so the service may lag behind by up to 8 triggers without missing one.
+// Limitations:
+// - Positions loaded together have to differ, the service finds the fired ones by the
+//   value of POS_COMP. The positions of a queue should be ordered along the motion.
+// - After the last loaded position the pipeline holds copies of it. Whether the last
+//   position fired is derived from XACTUAL having passed it, in the direction of travel
+//   from the position before.
+// - The pipeline replaces the START_CONF trigger configuration, so the trigger queue
+//   can not be used together with the move queue or a start group on the same axis.
+#define TRIGGER_QUEUE_MASK_INDEX (TMC43XX_TRIGGER_QUEUE_SIZE - 1)
+
+static uint8_t triggerQueueCount(TMC43xxTriggerQueueTypeDef *queue)
+{
+	return (queue->tail - queue->head) & TRIGGER_QUEUE_MASK_INDEX;
+}
+
+static int32_t triggerQueueEntry(TMC43xxTriggerQueueTypeDef *queue, uint8_t offset)
+{
+	return queue->positions[(queue->head + offset) & TRIGGER_QUEUE_MASK_INDEX];
+}
+
+// Write the positions from [offset] on into the pipeline, padded with the last one
+static void triggerQueueLoad(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue, uint8_t offset)
+{
+	uint8_t count = MIN(triggerQueueCount(queue), TRIGGER_QUEUE_SLOTS);
+	uint8_t i;
+
+	for(i = MAX(offset, 1); i < TRIGGER_QUEUE_SLOTS; i++)
+		tmc43xx_core_writeInt(tmc43xx, X_PIPE0 + i - 1, triggerQueueEntry(queue, MIN(i, count - 1)));
+
+	// Nothing loaded -> POS_COMP holds a fired position, start with the head
+	if(offset == 0)
+		tmc43xx_core_writeInt(tmc43xx, POS_COMP, triggerQueueEntry(queue, 0));
+
+	queue->loaded = count;
+}
+
+void tmc43xx_core_triggerQueueInit(TMC43xxTriggerQueueTypeDef *queue)
+{
+	queue->head       = 0;
+	queue->tail       = 0;
+	queue->loaded     = 0;
+	queue->armed      = false;
+	queue->reference  = 0;
+	queue->startConf  = 0;
+	queue->fired      = 0;
+}
+
+// Returns false if the queue is full. Pushing to an armed queue is fine,
+// the next service loads the position.
+bool tmc43xx_core_triggerQueuePush(TMC43xxTriggerQueueTypeDef *queue, int32_t position)
+{
+	if(((queue->tail + 1) & TRIGGER_QUEUE_MASK_INDEX) == queue->head)
+		return false;
+
+	queue->positions[queue->tail] = position;
+	queue->tail = (queue->tail + 1) & TRIGGER_QUEUE_MASK_INDEX;
+
+	return true;
+}
+
+// Load the queued positions and enable the pipeline.
+// Returns false if the variant has no pipeline or the queue is empty.
+bool tmc43xx_core_triggerQueueArm(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue)
+{
+	if(!(tmc43xx->variant->features & TMC43XX_FEATURE_PIPELINE) || (queue->head == queue->tail))
+		return false;
+
+	queue->reference  = tmc43xx_core_readInt(tmc43xx, XACTUAL);
+	queue->startConf  = tmc43xx_core_readInt(tmc43xx, START_CONF);
+
+	// Without the pipeline enabled nothing is shifted while loading
+	triggerQueueLoad(tmc43xx, queue, 0);
+	tmc43xx_core_writeInt(tmc43xx, START_CONF, FIELDS_SET(queue->startConf, TRIGGER_QUEUE_MASK, TRIGGER_QUEUE_START_CONF));
+	queue->armed = true;
+
+	return true;
+}
+
+// Returns the amount of positions fired since the last call
+uint8_t tmc43xx_core_triggerQueueService(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue)
+{
+	static const uint8_t addresses[] = { EVENTS, POS_COMP, XACTUAL };
+	int32_t values[ARRAY_SIZE(addresses)];
+	int32_t last;
+	uint8_t offset;
+	uint8_t loaded;
+	uint8_t fired = 0;
+	uint8_t retry;
+
+	// A shift while refilling moves the pipeline under the writes: Check and refill again
+	for(retry = 0; retry < 3; retry++)
+	{
+		tmc43xx_core_readIntBatch(tmc43xx, addresses, values, ARRAY_SIZE(addresses));
+
+		// POS_COMP_REACHED is handled here, the other events are kept for the application
+		tmc43xx->events |= values[0] & ~(COVER_DONE_MASK | POS_COMP_REACHED_MASK);
+
+		if(!queue->armed)
+			break;
+
+		// Positions before the one in POS_COMP have fired
+		for(offset = 0; offset < queue->loaded; offset++)
+			if(triggerQueueEntry(queue, offset) == values[1])
+				break;
+
+		// POS_COMP holds the last loaded position (or a copy of it):
+		// Fired once XACTUAL reached it, coming from the position before
+		if((queue->loaded > 0) && (offset == queue->loaded - 1))
+		{
+			last = triggerQueueEntry(queue, offset);
+			if(offset > 0)
+				queue->reference = triggerQueueEntry(queue, offset - 1);
+
+			if((last >= queue->reference) ? (values[2] >= last) : (values[2] <= last))
+				offset++;
+		}
+
+		if(offset > 0)
+		{
+			queue->reference  = triggerQueueEntry(queue, offset - 1);
+			queue->head       = (queue->head + offset) & TRIGGER_QUEUE_MASK_INDEX;
+			queue->loaded    -= offset;
+			queue->fired     += offset;
+			fired            += offset;
+		}
+
+		// Nothing new to load
+		if(queue->loaded == MIN(triggerQueueCount(queue), TRIGGER_QUEUE_SLOTS))
+			break;
+
+		// Refill behind the loaded positions. With nothing loaded, POS_COMP holds the
+		// fired last position and no further match shifts the pipeline.
+		loaded = queue->loaded;
+		triggerQueueLoad(tmc43xx, queue, loaded);
+
+		if((loaded == 0) || (tmc43xx_core_readInt(tmc43xx, POS_COMP) == values[1]))
+			break;
+
+		// Only the positions loaded before are known to be in place
+		queue->loaded = loaded;
+	}
+
+	return fired;
+}
+
+// Restore the START_CONF from before arming. Loaded positions that did not fire are
+// kept in the queue for the next arming.
+void tmc43xx_core_triggerQueueDisarm(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue)
+{
+	if(!queue->armed)
+		return;
+
+	tmc43xx_core_writeInt(tmc43xx, START_CONF, queue->startConf);
+	queue->armed   = false;
+	queue->loaded  = 0;
+}
+
+// Returns true once all queued positions have fired
+bool tmc43xx_core_triggerQueueIsDone(TMC43xxTriggerQueueTypeDef *queue)
+{
+	return (queue->head == queue->tail);
+}
+
+int32_t tmc43xx_core_discardVelocityDecimals(int32_t value)
+{
+	if(abs(value) > 8000000)
+	{
+		value = (value < 0) ? -8000000 : 8000000;
+	}
+	return value << 8;
+}
+
+static uint8_t moveToNextFullstep(TMC43xxCoreTypeDef *tmc43xx)
+{
+	int32_t stepCount;
+
+	// Motor must be stopped
+	if(tmc43xx_core_readInt(tmc43xx, VACTUAL) != 0)
+	{
+		// Not stopped
+		return 0;
+	}
+
+	// Position mode, hold mode, low velocity
+	tmc43xx_core_writeInt(tmc43xx, RAMPMODE, 4);
+	tmc43xx_core_writeInt(tmc43xx, VMAX, 10000 << 8);
+
+	// Current step count
+	stepCount = tmc43xx_core_readInt(tmc43xx, MSCNT_RD) & MSCNT_MASK;
+	// Get microstep value of step count (lowest 8 bits)
+	stepCount = stepCount % 256;
+	// Assume: 256 microsteps -> Fullsteps are at 128 + n*256
+	stepCount = 128 - stepCount;
+
+	if(stepCount == 0)
+	{
+		// Fullstep reached
+		return 1;
+	}
+
+	// Fullstep not reached -> calculate next fullstep position
+	stepCount += tmc43xx_core_readInt(tmc43xx, XACTUAL);
+	// Move to next fullstep position
+	tmc43xx_core_writeInt(tmc43xx, X_TARGET, stepCount);
+
+	return 0;
+}
+
+// Encoder calibration state machine, the state is kept per IC.
+// Returns 1 once the calibration finished. Variants without closed loop
+// operation return 0 without accessing the IC.
+uint8_t tmc43xx_core_calibrateClosedLoop(TMC43xxCoreTypeDef *tmc43xx, uint8_t worker0master1)
+{
+	uint8_t *state = &tmc43xx->calibrationState;
+	uint32_t amax = 0;
+	uint32_t dmax = 0;
+
+	if(!(tmc43xx->variant->features & TMC43XX_FEATURE_CLOSED_LOOP))
+		return 0;
+
+	if(worker0master1 && *state == 0)
+		*state = 1;
+
+	switch(*state)
+	{
+	case 1:
+		amax = tmc43xx_core_readInt(tmc43xx, AMAX);
+		dmax = tmc43xx_core_readInt(tmc43xx, DMAX);
+
+		// Set ramp and motion parameters
+		tmc43xx->calibrationRamp = tmc43xx_core_readInt(tmc43xx, RAMPMODE);
+		tmc43xx_core_writeInt(tmc43xx, RAMPMODE, RAMP_POSITION | RAMP_HOLD);
+		tmc43xx_core_writeInt(tmc43xx, AMAX, MAX(amax, 1000));
+		tmc43xx_core_writeInt(tmc43xx, DMAX, MAX(dmax, 1000));
+		tmc43xx_core_writeInt(tmc43xx, VMAX, 0);
+
+		*state = 2;
+		break;
+	case 2:
+		// Clear encoder calibration bit
+		CORE_FIELD_WRITE(tmc43xx, ENC_IN_CONF, CL_CALIBRATION_EN_MASK, CL_CALIBRATION_EN_SHIFT, 0);
+
+		// Disable internal data regulation for closed loop operation in encoder config
+		CORE_FIELD_WRITE(tmc43xx, ENC_IN_CONF, REGULATION_MODUS_MASK, REGULATION_MODUS_SHIFT, 1);
+
+		if(moveToNextFullstep(tmc43xx)) // move to next fullstep, motor must be stopped, poll until finished
+			*state = 3;
+		break;
+	case 3:
+		// Start encoder calibration
+		CORE_FIELD_WRITE(tmc43xx, ENC_IN_CONF, CL_CALIBRATION_EN_MASK, CL_CALIBRATION_EN_SHIFT, 1);
+
+		*state = 4;
+		break;
+	case 4:
+		if(worker0master1)
+			break;
+
+		// Stop encoder calibration
+		CORE_FIELD_WRITE(tmc43xx, ENC_IN_CONF, CL_CALIBRATION_EN_MASK, CL_CALIBRATION_EN_SHIFT, 0);
+		// Enable closed loop in encoder config
+		CORE_FIELD_WRITE(tmc43xx, ENC_IN_CONF, REGULATION_MODUS_MASK, REGULATION_MODUS_SHIFT, 1);
+		// Restore old ramp mode, enable position mode
+		tmc43xx_core_writeInt(tmc43xx, RAMPMODE, RAMP_POSITION | tmc43xx->calibrationRamp);
+
+		*state = 5;
+		break;
+	case 5:
+		*state = 0;
+		return 1;
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
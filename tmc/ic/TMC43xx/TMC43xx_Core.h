@@ -0,0 +1,164 @@
+/*
+ * TMC43xx_Core.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Common core of the TMC4330, TMC4331, TMC4361 and TMC4361A drivers.
+ *  The motion controllers share the SPI datagram format and the register map
+ *  of the ramp generator, they only differ in the encoder and driver (cover)
+ *  interfaces and in their register access tables. The IC files describe
+ *  their variant with a constant TMC43xxVariantTypeDef and keep their public
+ *  functions as thin wrappers around the tmc43xx_core_*() functions.
+ */
+
+#ifndef TMC_IC_TMC43XX_CORE_H_
+#define TMC_IC_TMC43XX_CORE_H_
+
+#include "tmc/helpers/API_Header.h"
+
+// Variant features
+#define TMC43XX_FEATURE_COVER        0x01 // SPI output to a driver, see tmc43xx_core_readWriteCover()
+#define TMC43XX_FEATURE_CLOSED_LOOP  0x02 // Encoder input with closed loop calibration
+#define TMC43XX_FEATURE_PIPELINE     0x04 // X_PIPE0-7 pipeline, see tmc43xx_core_triggerQueueArm()
+
+// Maximum amount of EVENTS polls while waiting for the cover reply
+#define TMC43XX_COVER_TIMEOUT 100
+
+// Capacity of a move queue, must be a power of two
+#define TMC43XX_MOVE_QUEUE_SIZE 8
+
+// Maximum amount of axes in a start group
+#define TMC43XX_START_GROUP_SIZE 8
+
+// Capacity of a trigger queue, must be a power of two
+#define TMC43XX_TRIGGER_QUEUE_SIZE 32
+
+// Constant description of a motion controller variant
+typedef struct
+{
+	TMCSpiInterface spi;
+	const uint8_t *defaultRegisterAccess;
+	const uint8_t *resettableRegisters;
+	uint8_t resettableCount;
+	const uint8_t *restorableRegisters;
+	uint8_t restorableCount;
+	const TMCRegisterConstant *constants; // Hardware preset values of non-readable registers, may be NULL
+	uint8_t constantCount;
+	uint8_t features;
+} TMC43xxVariantTypeDef;
+
+// Usage note: use 1 TypeDef per IC. The IC specific TypeDefs are aliases of this one.
+typedef struct
+{
+	const TMC43xxVariantTypeDef *variant;
+	ConfigurationTypeDef *config;
+	int velocity;
+	int oldX;
+	uint32_t oldTick;
+#ifdef TMC_RESET_STATE_CONST
+	TMCResetStateTypeDef registerResetState;
+#else
+	int32_t registerResetState[TMC_REGISTER_COUNT];
+#endif
+	uint8_t registerAccess[TMC_REGISTER_COUNT];
+	uint8_t status;
+	uint32_t events;     // EVENTS flags read (and cleared) by the cover transport, the move queue and tmc43xx_core_onInterrupt()
+	int32_t statusFlags; // STATUS read by tmc43xx_core_onInterrupt()
+	uint8_t calibrationState; // State of tmc43xx_core_calibrateClosedLoop()
+	int32_t calibrationRamp;  // RAMPMODE saved by the calibration
+} TMC43xxCoreTypeDef;
+
+// Cover datagram for tmc43xx_core_readWriteCoverQueue()
+typedef struct
+{
+	uint8_t *data;     // Sent and overwritten with the reply
+	size_t length;     // 1 to 8 bytes
+} TMC43xxCoverDatagramTypeDef;
+
+typedef struct
+{
+	int32_t position;
+	uint32_t velocityMax;    // Same unit as tmc43xx_core_moveTo()
+	uint32_t acceleration;   // AMAX
+	uint32_t deceleration;   // DMAX
+} TMC43xxMoveTypeDef;
+
+// Moves executed back to back: While one move runs, the next one is preloaded
+// into XTARGET and the shadow registers and switched to by the IC itself.
+typedef struct
+{
+	TMC43xxMoveTypeDef moves[TMC43XX_MOVE_QUEUE_SIZE];
+	uint8_t head;    // Oldest move not known to be finished
+	uint8_t tail;    // Next free slot
+	uint8_t active;  // 0: idle, 1: moves[head] running, 2: next move preloaded
+} TMC43xxMoveQueueTypeDef;
+
+// Axes started together by one external START signal. The START pins of the group
+// are wired together and pulsed by the application, e.g. with a GPIO.
+typedef struct
+{
+	TMC43xxCoreTypeDef *axes[TMC43XX_START_GROUP_SIZE];
+	int32_t startConf[TMC43XX_START_GROUP_SIZE];  // START_CONF before arming
+	uint8_t count;
+} TMC43xxStartGroupTypeDef;
+
+// Position compare triggers fired by the IC: POS_COMP holds the next position, the
+// following ones wait in X_PIPE0-7 and are shifted into POS_COMP by every match.
+typedef struct
+{
+	int32_t positions[TMC43XX_TRIGGER_QUEUE_SIZE];
+	uint8_t head;       // Oldest position not known to be fired
+	uint8_t tail;       // Next free slot
+	uint8_t loaded;     // Positions from head on in POS_COMP and X_PIPE0-7
+	bool armed;
+	int32_t reference;  // Last fired position, XACTUAL before the first one
+	int32_t startConf;  // START_CONF before arming
+	uint32_t fired;     // Positions fired since the init
+} TMC43xxTriggerQueueTypeDef;
+
+// SPI Communication
+void tmc43xx_core_writeDatagram(TMC43xxCoreTypeDef *tmc43xx, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
+void tmc43xx_core_writeInt(TMC43xxCoreTypeDef *tmc43xx, uint8_t address, int32_t value);
+int32_t tmc43xx_core_readInt(TMC43xxCoreTypeDef *tmc43xx, uint8_t address);
+void tmc43xx_core_readIntBatch(TMC43xxCoreTypeDef *tmc43xx, const uint8_t *addresses, int32_t *values, size_t count);
+bool tmc43xx_core_readWriteCoverQueue(TMC43xxCoreTypeDef *tmc43xx, TMC43xxCoverDatagramTypeDef *datagrams, size_t count);
+void tmc43xx_core_readWriteCover(TMC43xxCoreTypeDef *tmc43xx, uint8_t *data, size_t length);
+
+// Configuration
+void tmc43xx_core_init(TMC43xxCoreTypeDef *tmc43xx, const TMC43xxVariantTypeDef *variant, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
+void tmc43xx_core_fillShadowRegisters(TMC43xxCoreTypeDef *tmc43xx);
+uint8_t tmc43xx_core_reset(TMC43xxCoreTypeDef *tmc43xx);
+uint8_t tmc43xx_core_restore(TMC43xxCoreTypeDef *tmc43xx);
+void tmc43xx_core_setRegisterResetState(TMC43xxCoreTypeDef *tmc43xx, const int32_t *resetState);
+TMCConfigStatus tmc43xx_core_periodicJob(TMC43xxCoreTypeDef *tmc43xx, uint32_t tick);
+uint8_t tmc43xx_core_configureBurst(TMC43xxCoreTypeDef *tmc43xx, uint32_t maxSteps);
+uint8_t tmc43xx_core_onInterrupt(TMC43xxCoreTypeDef *tmc43xx);
+
+// Motion
+void tmc43xx_core_rotate(TMC43xxCoreTypeDef *tmc43xx, int32_t velocity);
+void tmc43xx_core_moveTo(TMC43xxCoreTypeDef *tmc43xx, int32_t position, uint32_t velocityMax);
+void tmc43xx_core_moveBy(TMC43xxCoreTypeDef *tmc43xx, int32_t *ticks, uint32_t velocityMax);
+
+void tmc43xx_core_moveQueueInit(TMC43xxMoveQueueTypeDef *queue);
+bool tmc43xx_core_moveQueuePush(TMC43xxMoveQueueTypeDef *queue, const TMC43xxMoveTypeDef *move);
+void tmc43xx_core_moveQueueService(TMC43xxCoreTypeDef *tmc43xx, TMC43xxMoveQueueTypeDef *queue);
+bool tmc43xx_core_moveQueueIsDone(TMC43xxMoveQueueTypeDef *queue);
+
+void tmc43xx_core_startGroupInit(TMC43xxStartGroupTypeDef *group, TMC43xxCoreTypeDef **axes, uint8_t count);
+void tmc43xx_core_startGroupArm(TMC43xxStartGroupTypeDef *group);
+void tmc43xx_core_startGroupPreload(TMC43xxStartGroupTypeDef *group, uint8_t axis, int32_t position, uint32_t velocityMax);
+void tmc43xx_core_startGroupDisarm(TMC43xxStartGroupTypeDef *group);
+
+void tmc43xx_core_triggerQueueInit(TMC43xxTriggerQueueTypeDef *queue);
+bool tmc43xx_core_triggerQueuePush(TMC43xxTriggerQueueTypeDef *queue, int32_t position);
+bool tmc43xx_core_triggerQueueArm(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue);
+uint8_t tmc43xx_core_triggerQueueService(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue);
+void tmc43xx_core_triggerQueueDisarm(TMC43xxCoreTypeDef *tmc43xx, TMC43xxTriggerQueueTypeDef *queue);
+bool tmc43xx_core_triggerQueueIsDone(TMC43xxTriggerQueueTypeDef *queue);
+
+// Helper functions
+int32_t tmc43xx_core_discardVelocityDecimals(int32_t value);
+uint8_t tmc43xx_core_calibrateClosedLoop(TMC43xxCoreTypeDef *tmc43xx, uint8_t worker0master1);
+
+#endif /* TMC_IC_TMC43XX_CORE_H_ */
@@ -305,6 +305,16 @@ static const uint8_t TMC457RegisterReadable[128]=
 
 static int32_t TMC457SoftwareCopy[128];  // Software copies of all TMC457 registers
 
+// CRC16 step of the wavetable verification (polynomial 0x1021, MSB first)
+static uint16_t UpdateWavetableCRC(uint16_t CRC, uint16_t Value)
+{
+	CRC ^= Value;
+	for(uint8_t i = 0; i < 16; i++)
+		CRC = (CRC & 0x8000) ? (CRC << 1) ^ 0x1021 : (CRC << 1);
+
+	return CRC;
+}
+
 
 /***************************************************************//**
 	 \fn ReadWrite429(uint8_t *Read, uint8_t *Write)
@@ -404,6 +414,34 @@ void Write457Wavetable(uint16_t RAMAddress, uint16_t Value)
 }
 
 
+/***************************************************************//**
+	 \fn Write457WavetableBlock(uint16_t RAMAddress, const uint16_t *Values, uint16_t Count)
+	 \brief Write a block of values to the TMC457 wavetable RAM
+	 \param RAMAddress   Start address in wavetable RAM
+	 \param Values       Values to be written (e.g. a const table)
+	 \param Count        Number of values
+
+	 Writes Count consecutive wavetable entries with back-to-back
+	 SPI telegrammes. Only the address and data bytes are updated
+	 between the telegrammes.
+********************************************************************/
+void Write457WavetableBlock(uint16_t RAMAddress, const uint16_t *Values, uint16_t Count)
+{
+	uint8_t Write[5], Read[5];
+
+	Write[0] = TMC457_WAVETAB | TMC457_WRITE;
+	for(uint16_t i = 0; i < Count; i++, RAMAddress++)
+	{
+		Write[1] = RAMAddress >> 8;
+		Write[2] = RAMAddress & 0xFF;
+		Write[3] = Values[i] >> 8;
+		Write[4] = Values[i] & 0xFF;
+
+		ReadWrite457(Read, Write);
+	}
+}
+
+
 /***************************************************************//**
 	 \fn Read457Int(uint8_t Address)
 	 \brief Read TMC457 register
@@ -464,6 +502,91 @@ uint16_t Read457Wavetable(uint16_t RAMAddress)
 }
 
 
+/***************************************************************//**
+	 \fn Read457WavetableBlock(uint16_t RAMAddress, uint16_t *Values, uint16_t Count)
+	 \brief Read a block of values from the TMC457 wavetable RAM
+	 \param RAMAddress   Start address in wavetable RAM
+	 \param Values       Array receiving the values (NULL: values are only
+	                     used for the CRC)
+	 \param Count        Number of values
+	 \return CRC16 (see Calc457WavetableCRC()) of the values read
+
+	 The value of a wavetable read arrives with the following SPI
+	 access, so each access already requests the next entry. Reading
+	 Count entries takes Count+1 SPI accesses instead of 2*Count.
+********************************************************************/
+uint16_t Read457WavetableBlock(uint16_t RAMAddress, uint16_t *Values, uint16_t Count)
+{
+	uint8_t Write[5], Read[5];
+	uint16_t CRC = TMC457_WAVETABLE_CRC_INIT;
+
+	if(Count == 0)
+		return CRC;
+
+	Write[0] = TMC457_WAVETAB;
+	Write[3] = 0;
+	Write[4] = 0;
+	for(uint16_t i = 0; i <= Count; i++, RAMAddress++)
+	{
+		// The last access only fetches the value of the previous one
+		Write[1] = RAMAddress >> 8;
+		Write[2] = RAMAddress & 0xFF;
+
+		ReadWrite457(Read, Write);
+
+		if(i > 0)
+		{
+			uint16_t Value = (Read[3]<<8) | Read[4];
+
+			if(Values)
+				Values[i-1] = Value;
+			CRC = UpdateWavetableCRC(CRC, Value);
+		}
+	}
+
+	return CRC;
+}
+
+
+/***************************************************************//**
+	 \fn Calc457WavetableCRC(const uint16_t *Values, uint16_t Count)
+	 \brief Calculate the CRC of a wavetable
+	 \param Values   Wavetable values
+	 \param Count    Number of values
+	 \return CRC16 of the values
+
+	 CRC16 (polynomial 0x1021, MSB first) over the high and low byte of
+	 each value. For constant tables, the result can be calculated once
+	 and stored with the table.
+********************************************************************/
+uint16_t Calc457WavetableCRC(const uint16_t *Values, uint16_t Count)
+{
+	uint16_t CRC = TMC457_WAVETABLE_CRC_INIT;
+
+	for(uint16_t i = 0; i < Count; i++)
+		CRC = UpdateWavetableCRC(CRC, Values[i]);
+
+	return CRC;
+}
+
+
+/***************************************************************//**
+	 \fn Verify457Wavetable(uint16_t RAMAddress, uint16_t Count, uint16_t CRC)
+	 \brief Verify the TMC457 wavetable RAM against a CRC
+	 \param RAMAddress   Start address in wavetable RAM
+	 \param Count        Number of values
+	 \param CRC          Expected CRC (see Calc457WavetableCRC())
+	 \return TRUE if the wavetable RAM matches
+
+	 Reads the wavetable with pipelined accesses and compares their
+	 CRC, no buffer for the read values is needed.
+********************************************************************/
+uint8_t Verify457Wavetable(uint16_t RAMAddress, uint16_t Count, uint16_t CRC)
+{
+	return (Read457WavetableBlock(RAMAddress, NULL, Count) == CRC) ? TRUE : FALSE;
+}
+
+
 /***************************************************************//**
 	 \fn Set457RampMode(uint32_t RampMode)
 	 \brief Set ramp mode of the TMC457
@@ -482,6 +605,56 @@ void Set457RampMode(uint32_t RampMode)
 }
 
 
+// Wavetable entry for sine table index i (0..8191)
+static uint16_t WavetableValue(uint32_t i, int32_t Offset)
+{
+	//return Offset+abs((int32_t) ((4095.0-Offset)*sin(6.28318530718*((double) i/8192.0))));
+	return Offset+((4095-Offset)*IntSinTable[MIRROR(i)])/10000;
+}
+
+
+/***************************************************************//**
+	 \fn Build457Wavetable(uint16_t *Table, uint32_t Resolution, int32_t Offset)
+	 \brief Calculate a wavetable without uploading it
+	 \param Table        Array of TMC457_WAVETABLE_SIZE(Resolution) entries
+	 \param Resolution   Microstep resolution (0..11, 0=2048, 1=1024, ...)
+	 \param Offset       Wavetable offset (mostly 0)
+	 \return Number of entries
+
+	 Calculates the same wavetable as Init457Wavetable(). Build the
+	 wavetables once (at startup or offline for const tables in flash)
+	 and switch between them with Load457Wavetable().
+********************************************************************/
+uint16_t Build457Wavetable(uint16_t *Table, uint32_t Resolution, int32_t Offset)
+{
+	uint16_t Count = 0;
+
+	for(uint32_t i = 0; i < 8192; i += (1<<Resolution))
+		Table[Count++] = WavetableValue(i, Offset);
+
+	return Count;
+}
+
+
+/***************************************************************//**
+	 \fn Load457Wavetable(const uint16_t *Table, uint16_t Count, uint16_t CRC)
+	 \brief Upload a prepared wavetable and verify it
+	 \param Table   Wavetable, e.g. from Build457Wavetable()
+	 \param Count   Number of entries
+	 \param CRC     CRC of the table (see Calc457WavetableCRC())
+	 \return TRUE if the wavetable RAM matches the table afterwards
+
+	 Uploads the table without any calculation and checks the result
+	 with a CRC read back.
+********************************************************************/
+uint8_t Load457Wavetable(const uint16_t *Table, uint16_t Count, uint16_t CRC)
+{
+	Write457WavetableBlock(0, Table, Count);
+
+	return Verify457Wavetable(0, Count, CRC);
+}
+
+
 /***************************************************************//**
 	 \fn Init457Wavetable(uint32_t Resolution, int32_t Offset)
 	 \brief Initialize wavetable for the given microstep resolution
@@ -494,13 +667,22 @@ void Set457RampMode(uint32_t RampMode)
 ********************************************************************/
 void Init457Wavetable(uint32_t Resolution, int32_t Offset)
 {
+	uint16_t Block[32];
 	uint32_t Address = 0;
+	uint16_t Count = 0;
 
 	for(uint32_t i = 0; i < 8192; i += (1<<Resolution))
 	{
-		//Write457Wavetable(Address++, Offset+abs((int32_t) ((4095.0-Offset)*sin(6.28318530718*((double) i/8192.0)))));
-		Write457Wavetable(Address++, Offset+((4095-Offset)*IntSinTable[MIRROR(i)])/10000);
+		Block[Count++] = WavetableValue(i, Offset);
+
+		if(Count == 32)
+		{
+			Write457WavetableBlock(Address, Block, Count);
+			Address += Count;
+			Count = 0;
+		}
 	}
+	Write457WavetableBlock(Address, Block, Count);
 }
 
 
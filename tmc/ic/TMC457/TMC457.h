@@ -10,12 +10,24 @@
 	#include "tmc/helpers/API_Header.h"
 	#include "TMC457_Register.h"
 
+	// Start value of the wavetable CRC
+	#define TMC457_WAVETABLE_CRC_INIT 0xFFFF
+
+	// Number of wavetable entries for a microstep resolution (0..11)
+	#define TMC457_WAVETABLE_SIZE(Resolution) (8192 >> (Resolution))
+
 	void Write457Zero(uint8_t Address);
 	void Write457Int(uint8_t Address, int32_t Value);
 	void Write457Wavetable(uint16_t RAMAddress, uint16_t Value);
+	void Write457WavetableBlock(uint16_t RAMAddress, const uint16_t *Values, uint16_t Count);
 	int32_t Read457Int(uint8_t Address);
 	uint16_t Read457Wavetable(uint16_t RAMAddress);
+	uint16_t Read457WavetableBlock(uint16_t RAMAddress, uint16_t *Values, uint16_t Count);
+	uint16_t Calc457WavetableCRC(const uint16_t *Values, uint16_t Count);
+	uint8_t Verify457Wavetable(uint16_t RAMAddress, uint16_t Count, uint16_t CRC);
 	void Set457RampMode(uint32_t RampMode);
+	uint16_t Build457Wavetable(uint16_t *Table, uint32_t Resolution, int32_t Offset);
+	uint8_t Load457Wavetable(const uint16_t *Table, uint16_t Count, uint16_t CRC);
 	void Init457Wavetable(uint32_t Resolution, int32_t Offset);
 	void Init457(void);
 	void HardStop();
@@ -12,15 +12,56 @@
 #define STATE_ESTIMATE_OFFSET  3
 
 // => SPI wrapper
+#ifdef TMC4670_SPI_ARRAY
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc4670_readWriteArray(uint8_t motor, uint8_t *data, size_t length);
+#define tmc4670_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC4670", tmc4670_readWriteArray, channel, data, length)
+#else
 extern uint8_t tmc4670_readwriteByte(uint8_t motor, uint8_t data, uint8_t lastTransfer);
+#endif
 // <= SPI wrapper
 
+// Setpoint ramps attached with tmc4670_setRamp()
+static TMC_SetpointRamp *ramps[TMC4670_MOTORS];
+
+static TMC_SetpointRamp *getRamp(uint8_t motor, TMC_SetpointRamp_Mode mode);
+static void startRamp(uint8_t motor, TMC_SetpointRamp *ramp, int32_t target);
+
+// Last index written to INTERIM_ADDR and PID_ERROR_ADDR plus one, 0 if unknown.
+// Lets the indexed reads skip the index write when it did not change.
+static uint16_t interimIndex[TMC4670_MOTORS];
+static uint16_t pidErrorIndex[TMC4670_MOTORS];
+
+static uint16_t *getIndexShadow(uint8_t motor, uint8_t address)
+{
+	if(motor >= TMC4670_MOTORS)
+		return NULL;
+
+	switch(address)
+	{
+	case TMC4670_INTERIM_ADDR:
+		return &interimIndex[motor];
+	case TMC4670_PID_ERROR_ADDR:
+		return &pidErrorIndex[motor];
+	default:
+		return NULL;
+	}
+}
+
 // spi access
 int32_t tmc4670_readInt(uint8_t motor, uint8_t address)
 {
 	// clear write bit
 	address &= 0x7F;
 
+#ifdef TMC4670_SPI_ARRAY
+	uint8_t data[5] = { address, 0, 0, 0, 0 };
+	tmc4670_readWriteArray(motor, &data[0], 5);
+
+	return tmc_unpackInt32(&data[1]);
+#else
 	// write address
 	tmc4670_readwriteByte(motor, address, false);
 
@@ -34,10 +75,20 @@ int32_t tmc4670_readInt(uint8_t motor, uint8_t address)
 	value |= tmc4670_readwriteByte(motor, 0, true);
 
 	return value;
+#endif
 }
 
 void tmc4670_writeInt(uint8_t motor, uint8_t address, int32_t value)
 {
+	// keep the index shadows in sync with writes from outside the indexed reads
+	uint16_t *index = getIndexShadow(motor, address & 0x7F);
+	if(index)
+		*index = (value >= 0 && value <= 0xFF) ? value + 1 : 0;
+
+#ifdef TMC4670_SPI_ARRAY
+	uint8_t data[5] = { address|0x80, 0xFF & (value>>24), 0xFF & (value>>16), 0xFF & (value>>8), 0xFF & (value>>0) };
+	tmc4670_readWriteArray(motor, &data[0], 5);
+#else
 	// write address
 	tmc4670_readwriteByte(motor, address|0x80, false);
 
@@ -46,6 +97,7 @@ void tmc4670_writeInt(uint8_t motor, uint8_t address, int32_t value)
 	tmc4670_readwriteByte(motor, 0xFF & (value>>16), false);
 	tmc4670_readwriteByte(motor, 0xFF & (value>>8), false);
 	tmc4670_readwriteByte(motor, 0xFF & (value>>0), true);
+#endif
 }
 
 uint16_t tmc4670_readRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel)
@@ -97,14 +149,21 @@ void tmc4670_switchToMotionMode(uint8_t motor, uint8_t mode)
 
 void tmc4670_setTargetTorque_raw(uint8_t motor, int32_t targetTorque)
 {
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_TORQUE);
+
+	if(ramp)
+	{
+		startRamp(motor, ramp, targetTorque);
+		return;
+	}
+
 	tmc4670_switchToMotionMode(motor, TMC4670_MOTION_MODE_TORQUE);
 	tmc4670_writeRegister16BitValue(motor, TMC4670_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31, targetTorque);
 }
 
 int32_t tmc4670_getTargetTorque_raw(uint8_t motor)
 {
-	tmc4670_writeInt(motor, TMC4670_INTERIM_ADDR, 0);
-	return (int32_t) tmc4670_readInt(motor, TMC4670_INTERIM_DATA);
+	return tmc4670_readInterim(motor, TMC4670_INTERIM_PIDIN_TARGET_TORQUE);
 }
 
 int32_t tmc4670_getActualTorque_raw(uint8_t motor)
@@ -114,15 +173,15 @@ int32_t tmc4670_getActualTorque_raw(uint8_t motor)
 
 int32_t tmc4670_getActualRampTorque_raw(uint8_t motor)
 {
-	// no ramp implemented
-	UNUSED(motor);
-	return 0;
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_TORQUE);
+
+	// 0 without a torque ramp
+	return (ramp) ? tmc_ramp_setpoint_get_setpoint(ramp) : 0;
 }
 
 void tmc4670_setTargetTorque_mA(uint8_t motor, uint16_t torqueMeasurementFactor, int32_t targetTorque)
 {
-	tmc4670_switchToMotionMode(motor, TMC4670_MOTION_MODE_TORQUE);
-	tmc4670_writeRegister16BitValue(motor, TMC4670_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31, (targetTorque * 256) / (int32_t) torqueMeasurementFactor);
+	tmc4670_setTargetTorque_raw(motor, (targetTorque * 256) / (int32_t) torqueMeasurementFactor);
 }
 
 int32_t tmc4670_getTargetTorque_mA(uint8_t motor, uint16_t torqueMeasurementFactor)
@@ -137,10 +196,7 @@ int32_t tmc4670_getActualTorque_mA(uint8_t motor, uint16_t torqueMeasurementFact
 
 int32_t tmc4670_getActualRampTorque_mA(uint8_t motor, uint16_t torqueMeasurementFactor)
 {
-	// no ramp implemented
-	UNUSED(motor);
-	UNUSED(torqueMeasurementFactor);
-	return 0;
+	return (tmc4670_getActualRampTorque_raw(motor) * (int32_t) torqueMeasurementFactor) / 256;
 }
 
 void tmc4670_setTargetFlux_raw(uint8_t motor, int32_t targetFlux)
@@ -151,8 +207,7 @@ void tmc4670_setTargetFlux_raw(uint8_t motor, int32_t targetFlux)
 
 int32_t tmc4670_getTargetFlux_raw(uint8_t motor)
 {
-	tmc4670_writeInt(motor, TMC4670_INTERIM_ADDR, 1);
-	return (int32_t) tmc4670_readInt(motor, TMC4670_INTERIM_DATA);
+	return tmc4670_readInterim(motor, TMC4670_INTERIM_PIDIN_TARGET_FLUX);
 }
 
 int32_t tmc4670_getActualFlux_raw(uint8_t motor)
@@ -188,14 +243,21 @@ int32_t tmc4670_getTorqueFluxLimit_mA(uint8_t motor, uint16_t torqueMeasurementF
 
 void tmc4670_setTargetVelocity(uint8_t motor, int32_t targetVelocity)
 {
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_VELOCITY);
+
+	if(ramp)
+	{
+		startRamp(motor, ramp, targetVelocity);
+		return;
+	}
+
 	tmc4670_switchToMotionMode(motor, TMC4670_MOTION_MODE_VELOCITY);
 	tmc4670_writeInt(motor, TMC4670_PID_VELOCITY_TARGET, targetVelocity);
 }
 
 int32_t tmc4670_getTargetVelocity(uint8_t motor)
 {
-	tmc4670_writeInt(motor, TMC4670_INTERIM_ADDR, 2);
-	return (int32_t) tmc4670_readInt(motor, TMC4670_INTERIM_DATA);
+	return tmc4670_readInterim(motor, TMC4670_INTERIM_PIDIN_TARGET_VELOCITY);
 }
 
 int32_t tmc4670_getActualVelocity(uint8_t motor)
@@ -205,22 +267,30 @@ int32_t tmc4670_getActualVelocity(uint8_t motor)
 
 int32_t tmc4670_getActualRampVelocity(uint8_t motor)
 {
-	UNUSED(motor);
-	// no ramp implemented
-	return 0;
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_VELOCITY);
+
+	// 0 without a velocity ramp
+	return (ramp) ? tmc_ramp_setpoint_get_setpoint(ramp) : 0;
 }
 
 void tmc4670_setAbsolutTargetPosition(uint8_t motor, int32_t targetPosition)
 {
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_POSITION);
+
+	if(ramp)
+	{
+		startRamp(motor, ramp, targetPosition);
+		return;
+	}
+
 	tmc4670_switchToMotionMode(motor, TMC4670_MOTION_MODE_POSITION);
 	tmc4670_writeInt(motor, TMC4670_PID_POSITION_TARGET, targetPosition);
 }
 
 void tmc4670_setRelativeTargetPosition(uint8_t motor, int32_t relativePosition)
 {
-	tmc4670_switchToMotionMode(motor, TMC4670_MOTION_MODE_POSITION);
 	// determine actual position and add relative position ticks
-	tmc4670_writeInt(motor, TMC4670_PID_POSITION_TARGET, (int32_t) tmc4670_readInt(motor, TMC4670_PID_POSITION_ACTUAL) + relativePosition);
+	tmc4670_setAbsolutTargetPosition(motor, (int32_t) tmc4670_readInt(motor, TMC4670_PID_POSITION_ACTUAL) + relativePosition);
 }
 
 int32_t tmc4670_getTargetPosition(uint8_t motor)
@@ -240,9 +310,160 @@ int32_t tmc4670_getActualPosition(uint8_t motor)
 
 int32_t tmc4670_getActualRampPosition(uint8_t motor)
 {
-	UNUSED(motor);
-	// no ramp implemented
-	return 0;
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_POSITION);
+
+	// 0 without a position ramp
+	return (ramp) ? tmc_ramp_setpoint_get_setpoint(ramp) : 0;
+}
+
+// Read values behind an address/data register pair (INTERIM_ADDR/INTERIM_DATA, PID_ERROR_ADDR/PID_ERROR_DATA).
+// The index register is only written when it changes, so repeated reads of the same index
+// and sorted index lists cost one access per value.
+static void readIndexedBatch(uint8_t motor, uint8_t addressRegister, uint8_t dataRegister, const uint8_t *indices, int32_t *values, size_t count)
+{
+	uint16_t *current = getIndexShadow(motor, addressRegister);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		if(!current || (*current != indices[i] + 1))
+			tmc4670_writeInt(motor, addressRegister, indices[i]);
+
+		values[i] = tmc4670_readInt(motor, dataRegister);
+	}
+}
+
+// Read the interim values [indices], see TMC4670_INTERIM_*
+void tmc4670_readInterimBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count)
+{
+	readIndexedBatch(motor, TMC4670_INTERIM_ADDR, TMC4670_INTERIM_DATA, indices, values, count);
+}
+
+int32_t tmc4670_readInterim(uint8_t motor, uint8_t index)
+{
+	int32_t value;
+
+	tmc4670_readInterimBatch(motor, &index, &value, 1);
+	return value;
+}
+
+// Read the PID errors and error sums [indices], see TMC4670_PID_ERROR_*
+void tmc4670_readPidErrorBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count)
+{
+	readIndexedBatch(motor, TMC4670_PID_ERROR_ADDR, TMC4670_PID_ERROR_DATA, indices, values, count);
+}
+
+// setpoint ramp
+static uint8_t rampMotionMode(TMC_SetpointRamp *ramp)
+{
+	switch(ramp->mode)
+	{
+	case TMC_RAMP_SETPOINT_TORQUE:
+		return TMC4670_MOTION_MODE_TORQUE;
+	case TMC_RAMP_SETPOINT_VELOCITY:
+		return TMC4670_MOTION_MODE_VELOCITY;
+	default:
+		return TMC4670_MOTION_MODE_POSITION;
+	}
+}
+
+static int32_t rampActualValue(uint8_t motor, TMC_SetpointRamp *ramp)
+{
+	switch(ramp->mode)
+	{
+	case TMC_RAMP_SETPOINT_TORQUE:
+		return tmc4670_getActualTorque_raw(motor);
+	case TMC_RAMP_SETPOINT_VELOCITY:
+		return tmc4670_getActualVelocity(motor);
+	default:
+		return tmc4670_getActualPosition(motor);
+	}
+}
+
+static void writeSetpoint(uint8_t motor, TMC_SetpointRamp *ramp)
+{
+	int32_t setpoint = tmc_ramp_setpoint_get_setpoint(ramp);
+
+	switch(ramp->mode)
+	{
+	case TMC_RAMP_SETPOINT_TORQUE:
+		tmc4670_writeRegister16BitValue(motor, TMC4670_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31, setpoint);
+		break;
+	case TMC_RAMP_SETPOINT_VELOCITY:
+		tmc4670_writeInt(motor, TMC4670_PID_VELOCITY_TARGET, setpoint);
+		break;
+	default:
+		tmc4670_writeInt(motor, TMC4670_PID_POSITION_TARGET, setpoint);
+		break;
+	}
+}
+
+static TMC_SetpointRamp *getRamp(uint8_t motor, TMC_SetpointRamp_Mode mode)
+{
+	TMC_SetpointRamp *ramp = tmc4670_getRamp(motor);
+
+	return (ramp && (ramp->mode == mode)) ? ramp : NULL;
+}
+
+static void startRamp(uint8_t motor, TMC_SetpointRamp *ramp, int32_t target)
+{
+	uint8_t mode = rampMotionMode(ramp);
+
+	// Coming from another motion mode, the ramp starts at the actual value of the motor.
+	// Otherwise it continues from its current setpoint.
+	if((tmc4670_readInt(motor, TMC4670_MODE_RAMP_MODE_MOTION) & 0xFF) != mode)
+	{
+		tmc_ramp_setpoint_set_setpoint(ramp, rampActualValue(motor, ramp));
+		writeSetpoint(motor, ramp);
+		tmc4670_switchToMotionMode(motor, mode);
+	}
+
+	tmc_ramp_setpoint_set_target(ramp, target);
+}
+
+// Attach a setpoint ramp to the motor, NULL detaches it.
+// While attached, the target setters of the ramp mode (torque, velocity or position) set the
+// ramp target, and tmc4670_rampJob() writes the setpoints towards it.
+void tmc4670_setRamp(uint8_t motor, TMC_SetpointRamp *ramp)
+{
+	if(motor >= TMC4670_MOTORS)
+		return;
+
+	ramps[motor] = ramp;
+
+	// Already running in the mode of the ramp: start with the current target
+	if(ramp && ((tmc4670_readInt(motor, TMC4670_MODE_RAMP_MODE_MOTION) & 0xFF) == rampMotionMode(ramp)))
+	{
+		switch(ramp->mode)
+		{
+		case TMC_RAMP_SETPOINT_TORQUE:
+			tmc_ramp_setpoint_set_setpoint(ramp, (int16_t) tmc4670_readRegister16BitValue(motor, TMC4670_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31));
+			break;
+		case TMC_RAMP_SETPOINT_VELOCITY:
+			tmc_ramp_setpoint_set_setpoint(ramp, tmc4670_readInt(motor, TMC4670_PID_VELOCITY_TARGET));
+			break;
+		default:
+			tmc_ramp_setpoint_set_setpoint(ramp, tmc4670_getTargetPosition(motor));
+			break;
+		}
+	}
+}
+
+TMC_SetpointRamp *tmc4670_getRamp(uint8_t motor)
+{
+	return (motor < TMC4670_MOTORS) ? ramps[motor] : NULL;
+}
+
+// Write the next ramp setpoint every [interval] ticks of the ramp. tmc4670_periodicJob() calls it,
+// applications needing a more regular setpoint rate call it from a timer.
+void tmc4670_rampJob(uint8_t motor, uint32_t actualSystick)
+{
+	TMC_SetpointRamp *ramp = tmc4670_getRamp(motor);
+
+	if(!ramp || tmc_ramp_setpoint_isDone(ramp) || !tmc_ramp_setpoint_isDue(ramp, actualSystick))
+		return;
+
+	if(tmc_ramp_setpoint_compute(ramp, actualSystick))
+		writeSetpoint(motor, ramp);
 }
 
 // encoder initialization
@@ -396,6 +617,7 @@ void tmc4670_checkEncderInitialization(uint8_t motor, uint32_t actualSystick, ui
 void tmc4670_periodicJob(uint8_t motor, uint32_t actualSystick, uint8_t initMode, uint8_t *initState, uint16_t initWaitTime, uint16_t *actualInitWaitTime, uint16_t startVoltage)
 {
 	tmc4670_checkEncderInitialization(motor, actualSystick, initMode, initState, initWaitTime, actualInitWaitTime, startVoltage);
+	tmc4670_rampJob(motor, actualSystick);
 }
 
 void tmc4670_startEncoderInitialization(uint8_t mode, uint8_t *initMode, uint8_t *initState)
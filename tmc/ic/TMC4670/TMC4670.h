@@ -12,15 +12,39 @@
 #include "TMC4670_Register.h"
 #include "TMC4670_Constants.h"
 #include "TMC4670_Fields.h"
+#include "tmc/ramp/SetpointRamp.h"
 
 // spi access
 #define BIT_0_TO_15   0
 #define BIT_16_TO_31  1
 
+// Indices of tmc4670_readInterimBatch()
+#define TMC4670_INTERIM_PIDIN_TARGET_TORQUE     0
+#define TMC4670_INTERIM_PIDIN_TARGET_FLUX       1
+#define TMC4670_INTERIM_PIDIN_TARGET_VELOCITY   2
+#define TMC4670_INTERIM_PIDIN_TARGET_POSITION   3
+#define TMC4670_INTERIM_PIDOUT_TARGET_TORQUE    4
+#define TMC4670_INTERIM_PIDOUT_TARGET_FLUX      5
+#define TMC4670_INTERIM_PIDOUT_TARGET_VELOCITY  6
+#define TMC4670_INTERIM_PIDOUT_TARGET_POSITION  7
+
+// Indices of tmc4670_readPidErrorBatch()
+#define TMC4670_PID_ERROR_TORQUE        0
+#define TMC4670_PID_ERROR_FLUX          1
+#define TMC4670_PID_ERROR_VELOCITY      2
+#define TMC4670_PID_ERROR_POSITION      3
+#define TMC4670_PID_ERROR_TORQUE_SUM    4
+#define TMC4670_PID_ERROR_FLUX_SUM      5
+#define TMC4670_PID_ERROR_VELOCITY_SUM  6
+#define TMC4670_PID_ERROR_POSITION_SUM  7
+
 int32_t tmc4670_readInt(uint8_t motor, uint8_t address);
 void tmc4670_writeInt(uint8_t motor, uint8_t address, int32_t value);
 uint16_t tmc4670_readRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel);
 void tmc4670_writeRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel, uint16_t value);
+void tmc4670_readInterimBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count);
+int32_t tmc4670_readInterim(uint8_t motor, uint8_t index);
+void tmc4670_readPidErrorBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count);
 
 // do cyclic tasks
 void tmc4670_periodicJob(uint8_t motor, uint32_t actualSystick, uint8_t initMode, uint8_t *initState, uint16_t initWaitTime, uint16_t *actualInitWaitTime, uint16_t startVoltage);
@@ -69,6 +93,11 @@ void tmc4670_setActualPosition(uint8_t motor, int32_t actualPosition);
 int32_t tmc4670_getActualPosition(uint8_t motor);
 int32_t tmc4670_getActualRampPosition(uint8_t motor);
 
+// setpoint ramp
+void tmc4670_setRamp(uint8_t motor, TMC_SetpointRamp *ramp);
+TMC_SetpointRamp *tmc4670_getRamp(uint8_t motor);
+void tmc4670_rampJob(uint8_t motor, uint32_t actualSystick);
+
 // pwm control
 void tmc4670_disablePWM(uint8_t motor);
 
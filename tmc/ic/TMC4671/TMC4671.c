@@ -5,6 +5,7 @@
  *      Author: ed
  */
 #include "TMC4671.h"
+#include "TMC4671_Variants.h"
 
 #define STATE_NOTHING_TO_DO    0
 #define STATE_START_INIT       1
@@ -12,15 +13,113 @@
 #define STATE_ESTIMATE_OFFSET  3
 
 // => SPI wrapper
+#ifdef TMC4671_SPI_ARRAY
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc4671_readWriteArray(uint8_t motor, uint8_t *data, size_t length);
+#define tmc4671_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC4671", tmc4671_readWriteArray, channel, data, length)
+#else
 extern uint8_t tmc4671_readwriteByte(uint8_t motor, uint8_t data, uint8_t lastTransfer);
+#endif
 // <= SPI wrapper
 
+#ifdef TMC4671_TRANSFER_BATCH
+// => Batched SPI wrapper
+// Send the datagrams of [transfers] in order, each framed with its own chip select,
+// and overwrite their data with the replies. Called with up to TMC_TRANSFER_BATCH_SIZE transfers.
+extern void tmc4671_readWriteBatch(uint8_t motor, TMCTransfer *transfers, size_t count);
+// <= Batched SPI wrapper
+#endif
+
+#ifdef TMC4671_ASYNC
+// => Async SPI wrapper
+// Start sending [length] bytes stored in the [data] array as one datagram and return immediately.
+// Once the reply has been written to [data], call complete(context).
+extern void tmc4671_readWriteArrayAsync(uint8_t motor, uint8_t *data, size_t length, tmc_async_complete complete, void *context);
+// <= Async SPI wrapper
+#endif
+
+// Instances registered by tmc4671_init(), holding the per-motor state
+static TMC4671TypeDef *instances[TMC4671_MOTORS];
+
+static TMC4671TypeDef *getInstance(uint8_t motor)
+{
+	return (motor < TMC4671_MOTORS) ? instances[motor] : NULL;
+}
+
+static TMC_SetpointRamp *getRamp(uint8_t motor, TMC_SetpointRamp_Mode mode);
+static void startRamp(uint8_t motor, TMC_SetpointRamp *ramp, int32_t target);
+
+static void writeShadow(uint8_t motor, uint8_t address, int32_t value)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+
+	if(!tmc4671)
+		return;
+
+	address = TMC_ADDRESS(address);
+	tmc4671->shadowRegister[address] = value;
+	TMC_DIRTY_SET(tmc4671->shadowValid, address);
+}
+
+// Returns true if the shadow register holds the current register value
+static bool isShadowValid(TMC4671TypeDef *tmc4671, uint8_t address)
+{
+	if(!tmc4671)
+		return false;
+
+	uint8_t access = tmc4671_defaultRegisterAccess[address];
+	if(TMC_DIRTY_TEST(tmc4671->shadowValid, address))
+		access |= TMC_ACCESS_DIRTY;
+
+	return TMC_IS_CACHEABLE(access);
+}
+
+void tmc4671_init(TMC4671TypeDef *tmc4671, uint8_t motor)
+{
+	tmc4671->motor = motor;
+	tmc_dirtyClearAll(tmc4671->shadowValid);
+	tmc4671_setupEncoderInitialization(&tmc4671->encoderInit, 0, 0);
+	tmc4671_initScaling(&tmc4671->scaling, 0);
+	tmc4671->ramp = NULL;
+
+	if(motor < TMC4671_MOTORS)
+		instances[motor] = tmc4671;
+}
+
+TMC4671TypeDef *tmc4671_getInstance(uint8_t motor)
+{
+	return getInstance(motor);
+}
+
+void tmc4671_periodicJobInstance(TMC4671TypeDef *tmc4671, uint32_t actualSystick)
+{
+	tmc4671_encoderInitializationJob(tmc4671->motor, &tmc4671->encoderInit, actualSystick);
+	tmc4671_rampJob(tmc4671->motor, actualSystick);
+}
+
+// Forget the shadow registers, e.g. after the TMC4671 lost power or was reset.
+void tmc4671_clearShadowRegisters(uint8_t motor)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+
+	if(tmc4671)
+		tmc_dirtyClearAll(tmc4671->shadowValid);
+}
+
 // spi access
 int32_t tmc4671_readInt(uint8_t motor, uint8_t address)
 {
 	// clear write bit
 	address &= 0x7F;
 
+#ifdef TMC4671_SPI_ARRAY
+	uint8_t data[5] = { address, 0, 0, 0, 0 };
+	tmc4671_readWriteArray(motor, &data[0], 5);
+
+	return tmc_unpackInt32(&data[1]);
+#else
 	// write address
 	tmc4671_readwriteByte(motor, address, false);
 
@@ -34,10 +133,17 @@ int32_t tmc4671_readInt(uint8_t motor, uint8_t address)
 	value |= tmc4671_readwriteByte(motor, 0, true);
 
 	return value;
+#endif
 }
 
 void tmc4671_writeInt(uint8_t motor, uint8_t address, int32_t value)
 {
+	writeShadow(motor, address, value);
+
+#ifdef TMC4671_SPI_ARRAY
+	uint8_t data[5] = { address|0x80, 0xFF & (value>>24), 0xFF & (value>>16), 0xFF & (value>>8), 0xFF & (value>>0) };
+	tmc4671_readWriteArray(motor, &data[0], 5);
+#else
 	// write address
 	tmc4671_readwriteByte(motor, address|0x80, false);
 
@@ -46,8 +152,59 @@ void tmc4671_writeInt(uint8_t motor, uint8_t address, int32_t value)
 	tmc4671_readwriteByte(motor, 0xFF & (value>>16), false);
 	tmc4671_readwriteByte(motor, 0xFF & (value>>8), false);
 	tmc4671_readwriteByte(motor, 0xFF & (value>>0), true);
+#endif
+}
+
+#ifdef TMC4671_ASYNC
+static void asyncComplete(void *context)
+{
+	TMCAsyncRequestTypeDef *request = context;
+	uint8_t *data = &request->data[0];
+
+	// Write requests keep their value, read requests get the reply
+	if(!(data[0] & 0x80))
+		request->value = tmc_unpackInt32(&data[1]);
+
+	tmc_asyncFinish(request, TMC_ASYNC_DONE);
+}
+
+// Non-blocking tmc4671_readInt(). The value is stored in request->value once the request is done.
+// Returns the request handle or NULL if [request] is still pending.
+TMCAsyncRequestTypeDef *tmc4671_readIntAsync(uint8_t motor, TMCAsyncRequestTypeDef *request, uint8_t address, tmc_async_callback callback, void *userData)
+{
+	// clear write bit
+	address &= 0x7F;
+
+	if(!tmc_asyncStart(request, NULL, motor, address, 0, callback, userData))
+		return NULL;
+
+	request->data[0] = address;
+	request->data[1] = request->data[2] = request->data[3] = request->data[4] = 0;
+	tmc4671_readWriteArrayAsync(motor, &request->data[0], 5, asyncComplete, request);
+
+	return request;
 }
 
+// Non-blocking tmc4671_writeInt()
+// Returns the request handle or NULL if [request] is still pending.
+TMCAsyncRequestTypeDef *tmc4671_writeIntAsync(uint8_t motor, TMCAsyncRequestTypeDef *request, uint8_t address, int32_t value, tmc_async_callback callback, void *userData)
+{
+	if(!tmc_asyncStart(request, NULL, motor, address & 0x7F, value, callback, userData))
+		return NULL;
+
+	writeShadow(motor, address, value);
+
+	request->data[0] = address | 0x80;
+	request->data[1] = 0xFF & (value>>24);
+	request->data[2] = 0xFF & (value>>16);
+	request->data[3] = 0xFF & (value>>8);
+	request->data[4] = 0xFF & (value>>0);
+	tmc4671_readWriteArrayAsync(motor, &request->data[0], 5, asyncComplete, request);
+
+	return request;
+}
+#endif
+
 uint16_t tmc4671_readRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel)
 {
 	int32_t registerValue = tmc4671_readInt(motor, address);
@@ -67,8 +224,15 @@ uint16_t tmc4671_readRegister16BitValue(uint8_t motor, uint8_t address, uint8_t
 
 void tmc4671_writeRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel, uint16_t value)
 {
-	// read actual register content
-	int32_t registerValue = tmc4671_readInt(motor, address);
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+	int32_t registerValue;
+
+	// actual register content, read back only if the shadow register is not valid
+	address = TMC_ADDRESS(address);
+	if(isShadowValid(tmc4671, address))
+		registerValue = tmc4671->shadowRegister[address];
+	else
+		registerValue = tmc4671_readInt(motor, address);
 
 	// update one channel
 	switch(channel)
@@ -97,22 +261,21 @@ void tmc4671_switchToMotionMode(uint8_t motor, uint8_t mode)
 
 void tmc4671_setTargetTorque_raw(uint8_t motor, int32_t targetTorque)
 {
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_TORQUE);
+
+	if(ramp)
+	{
+		startRamp(motor, ramp, targetTorque);
+		return;
+	}
+
 	tmc4671_switchToMotionMode(motor, TMC4671_MOTION_MODE_TORQUE);
 	tmc4671_writeRegister16BitValue(motor, TMC4671_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31, targetTorque);
 }
 
 int32_t tmc4671_getTargetTorque_raw(uint8_t motor)
 {
-	// remember last set index
-	uint32_t lastIndex = tmc4671_readInt(motor, TMC4671_INTERIM_ADDR);
-
-	// get value
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, 0);
-	int32_t value = (int32_t)tmc4671_readInt(motor, TMC4671_INTERIM_DATA);
-
-	// reset last set index
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, lastIndex);
-	return value;
+	return tmc4671_readInterim(motor, TMC4671_INTERIM_PIDIN_TARGET_TORQUE);
 }
 
 int32_t tmc4671_getActualTorque_raw(uint8_t motor)
@@ -122,15 +285,15 @@ int32_t tmc4671_getActualTorque_raw(uint8_t motor)
 
 int32_t tmc4671_getActualRampTorque_raw(uint8_t motor)
 {
-	// no ramp implemented
-	UNUSED(motor);
-	return 0;
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_TORQUE);
+
+	// 0 without a torque ramp
+	return (ramp) ? tmc_ramp_setpoint_get_setpoint(ramp) : 0;
 }
 
 void tmc4671_setTargetTorque_mA(uint8_t motor, uint16_t torqueMeasurementFactor, int32_t targetTorque)
 {
-	tmc4671_switchToMotionMode(motor, TMC4671_MOTION_MODE_TORQUE);
-	tmc4671_writeRegister16BitValue(motor, TMC4671_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31, (targetTorque * 256) / (int32_t) torqueMeasurementFactor);
+	tmc4671_setTargetTorque_raw(motor, (targetTorque * 256) / (int32_t) torqueMeasurementFactor);
 }
 
 int32_t tmc4671_getTargetTorque_mA(uint8_t motor, uint16_t torqueMeasurementFactor)
@@ -145,19 +308,12 @@ int32_t tmc4671_getActualTorque_mA(uint8_t motor, uint16_t torqueMeasurementFact
 
 int32_t tmc4671_getTargetTorqueFluxSum_mA(uint8_t motor, uint16_t torqueMeasurementFactor)
 {
-	// remember last set index
-	uint32_t lastIndex = tmc4671_readInt(motor, TMC4671_INTERIM_ADDR);
-
-	// get target torque value
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, 0);
-	int32_t torque = (int32_t) tmc4671_readInt(motor, TMC4671_INTERIM_DATA);
+	const uint8_t indices[2] = { TMC4671_INTERIM_PIDIN_TARGET_TORQUE, TMC4671_INTERIM_PIDIN_TARGET_FLUX };
+	int32_t values[2];
 
-	// get target flux value
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, 1);
-	int32_t flux = (int32_t) tmc4671_readInt(motor, TMC4671_INTERIM_DATA);
-
-	// reset last set index
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, lastIndex);
+	tmc4671_readInterimBatch(motor, indices, values, 2);
+	int32_t torque = values[0];
+	int32_t flux = values[1];
 
 	return (((int32_t)flux+(int32_t)torque) * (int32_t)torqueMeasurementFactor) / 256;
 }
@@ -172,10 +328,7 @@ int32_t tmc4671_getActualTorqueFluxSum_mA(uint8_t motor, uint16_t torqueMeasurem
 
 int32_t tmc4671_getActualRampTorque_mA(uint8_t motor, uint16_t torqueMeasurementFactor)
 {
-	// no ramp implemented
-	UNUSED(motor);
-	UNUSED(torqueMeasurementFactor);
-	return 0;
+	return (tmc4671_getActualRampTorque_raw(motor) * (int32_t) torqueMeasurementFactor) / 256;
 }
 
 void tmc4671_setTargetFlux_raw(uint8_t motor, int32_t targetFlux)
@@ -186,16 +339,7 @@ void tmc4671_setTargetFlux_raw(uint8_t motor, int32_t targetFlux)
 
 int32_t tmc4671_getTargetFlux_raw(uint8_t motor)
 {
-	// remember last set index
-	uint32_t lastIndex = tmc4671_readInt(motor, TMC4671_INTERIM_ADDR);
-
-	// get value
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, 1);
-	int32_t value = (int32_t) tmc4671_readInt(motor, TMC4671_INTERIM_DATA);
-
-	// reset last set index
-	tmc4671_writeInt(motor, TMC4671_INTERIM_ADDR, lastIndex);
-	return value;
+	return tmc4671_readInterim(motor, TMC4671_INTERIM_PIDIN_TARGET_FLUX);
 }
 
 int32_t tmc4671_getActualFlux_raw(uint8_t motor)
@@ -229,8 +373,53 @@ int32_t tmc4671_getTorqueFluxLimit_mA(uint8_t motor, uint16_t torqueMeasurementF
 	return ((int32_t) tmc4671_readRegister16BitValue(motor, TMC4671_PID_TORQUE_FLUX_LIMITS, BIT_0_TO_15) * (int32_t) torqueMeasurementFactor) / 256;
 }
 
+void tmc4671_initScaling(TMC4671ScalingTypeDef *scaling, uint16_t torqueMeasurementFactor)
+{
+	uint8_t bits = 0;
+
+	while((torqueMeasurementFactor >> bits) != 0)
+		bits++;
+
+	// With 2^(31 + bits) the rounding error of the reciprocal stays below one for all
+	// dividends below 2^31, so the result equals the truncating division.
+	scaling->torqueMeasurementFactor  = torqueMeasurementFactor;
+	scaling->shift                    = 31 + bits;
+	scaling->reciprocal               = (torqueMeasurementFactor) ? ((uint64_t)1 << scaling->shift) / torqueMeasurementFactor + 1 : 0;
+}
+
+int32_t tmc4671_scaleToRaw(const TMC4671ScalingTypeDef *scaling, int32_t milliAmpere)
+{
+	// (milliAmpere * 256) / torqueMeasurementFactor, rounded towards zero
+	uint32_t dividend = (uint32_t) abs(milliAmpere) << 8;
+	int32_t raw = (int32_t) (((uint64_t) dividend * scaling->reciprocal) >> scaling->shift);
+
+	return (milliAmpere < 0) ? -raw : raw;
+}
+
+int32_t tmc4671_scaleToMilliAmpere(const TMC4671ScalingTypeDef *scaling, int32_t raw)
+{
+	return (raw * (int32_t) scaling->torqueMeasurementFactor) / 256;
+}
+
+void tmc4671_scaleToMilliAmpereArray(const TMC4671ScalingTypeDef *scaling, const int32_t *raw, int32_t *milliAmpere, size_t count)
+{
+	int32_t factor = scaling->torqueMeasurementFactor;
+	size_t i;
+
+	for(i = 0; i < count; i++)
+		milliAmpere[i] = (raw[i] * factor) / 256;
+}
+
 void tmc4671_setTargetVelocity(uint8_t motor, int32_t targetVelocity)
 {
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_VELOCITY);
+
+	if(ramp)
+	{
+		startRamp(motor, ramp, targetVelocity);
+		return;
+	}
+
 	tmc4671_switchToMotionMode(motor, TMC4671_MOTION_MODE_VELOCITY);
 	tmc4671_writeInt(motor, TMC4671_PID_VELOCITY_TARGET, targetVelocity);
 }
@@ -247,22 +436,30 @@ int32_t tmc4671_getActualVelocity(uint8_t motor)
 
 int32_t tmc4671_getActualRampVelocity(uint8_t motor)
 {
-	UNUSED(motor);
-	// no ramp implemented
-	return 0;
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_VELOCITY);
+
+	// 0 without a velocity ramp
+	return (ramp) ? tmc_ramp_setpoint_get_setpoint(ramp) : 0;
 }
 
 void tmc4671_setAbsolutTargetPosition(uint8_t motor, int32_t targetPosition)
 {
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_POSITION);
+
+	if(ramp)
+	{
+		startRamp(motor, ramp, targetPosition);
+		return;
+	}
+
 	tmc4671_switchToMotionMode(motor, TMC4671_MOTION_MODE_POSITION);
 	tmc4671_writeInt(motor, TMC4671_PID_POSITION_TARGET, targetPosition);
 }
 
 void tmc4671_setRelativeTargetPosition(uint8_t motor, int32_t relativePosition)
 {
-	tmc4671_switchToMotionMode(motor, TMC4671_MOTION_MODE_POSITION);
 	// determine actual position and add relative position ticks
-	tmc4671_writeInt(motor, TMC4671_PID_POSITION_TARGET, (int32_t) tmc4671_readInt(motor, TMC4671_PID_POSITION_ACTUAL) + relativePosition);
+	tmc4671_setAbsolutTargetPosition(motor, (int32_t) tmc4671_readInt(motor, TMC4671_PID_POSITION_ACTUAL) + relativePosition);
 }
 
 int32_t tmc4671_getTargetPosition(uint8_t motor)
@@ -282,26 +479,406 @@ int32_t tmc4671_getActualPosition(uint8_t motor)
 
 int32_t tmc4671_getActualRampPosition(uint8_t motor)
 {
-	UNUSED(motor);
-	// no ramp implemented
-	return 0;
+	TMC_SetpointRamp *ramp = getRamp(motor, TMC_RAMP_SETPOINT_POSITION);
+
+	// 0 without a position ramp
+	return (ramp) ? tmc_ramp_setpoint_get_setpoint(ramp) : 0;
+}
+
+void tmc4671_startSetpointStream(TMC4671SetpointStreamTypeDef *stream, uint8_t motor, uint8_t address, uint8_t channel)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+	int32_t value = 0;
+	uint8_t i;
+
+	// The untouched half of the register is sent with every setpoint
+	address = TMC_ADDRESS(address);
+	if(channel != TMC4671_STREAM_32BIT)
+		value = isShadowValid(tmc4671, address) ? tmc4671->shadowRegister[address] : tmc4671_readInt(motor, address);
+
+	stream->motor    = motor;
+	stream->channel  = channel;
+	stream->next     = 0;
+#ifdef TMC4671_ASYNC
+	stream->busy     = false;
+	stream->pending  = false;
+#endif
+
+	for(i = 0; i < 2; i++)
+	{
+		stream->datagram[i][0] = address | 0x80;
+		stream->datagram[i][1] = 0xFF & (value>>24);
+		stream->datagram[i][2] = 0xFF & (value>>16);
+		stream->datagram[i][3] = 0xFF & (value>>8);
+		stream->datagram[i][4] = 0xFF & (value>>0);
+	}
+}
+
+#ifdef TMC4671_ASYNC
+static void streamSend(TMC4671SetpointStreamTypeDef *stream);
+
+static void streamComplete(void *context)
+{
+	TMC4671SetpointStreamTypeDef *stream = context;
+
+	if(stream->pending)
+		streamSend(stream);
+	else
+		stream->busy = false;
+}
+#endif
+
+static void streamSend(TMC4671SetpointStreamTypeDef *stream)
+{
+	uint8_t *data = &stream->datagram[stream->next][0];
+	uint8_t i;
+
+	writeShadow(stream->motor, data[0] & 0x7F, tmc_unpackInt32(&data[1]));
+
+	// The next setpoint goes into the other datagram. The transport overwrites the
+	// sent one with the reply, so the other one gets a copy of the template first.
+	stream->next ^= 1;
+	for(i = 0; i < 5; i++)
+		stream->datagram[stream->next][i] = data[i];
+
+#if defined(TMC4671_ASYNC)
+	stream->pending = false;
+	stream->busy = true;
+	tmc4671_readWriteArrayAsync(stream->motor, data, 5, streamComplete, stream);
+#elif defined(TMC4671_SPI_ARRAY)
+	tmc4671_readWriteArray(stream->motor, data, 5);
+#else
+	for(i = 0; i < 5; i++)
+		tmc4671_readwriteByte(stream->motor, data[i], i == 4);
+#endif
+}
+
+// Read multiple registers back to back.
+// The TMC4671 sends the reply within the read datagram, so every register takes one datagram.
+// The TMC4671 latches a datagram on the rising edge of the chip select, so datagrams cannot
+// share one chip select window. With TMC4671_TRANSFER_BATCH, they are submitted together in
+// lists of up to TMC_TRANSFER_BATCH_SIZE datagrams instead, leaving the chip select framing to
+// the transport (e.g. one DMA descriptor chain).
+void tmc4671_readIntBatch(uint8_t motor, const uint8_t *addresses, int32_t *values, size_t count)
+{
+#ifdef TMC4671_TRANSFER_BATCH
+	TMCTransferList list;
+
+	tmc_transfer_init(&list, motor, tmc4671_readWriteBatch);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		tmc_transfer_appendDatagram(&list, TMC_ADDRESS(addresses[i]), 0, tmc_transfer_decodeInt32, &values[i]);
+
+		if(tmc_transfer_isFull(&list) || (i + 1 == count))
+			tmc_transfer_execute(&list);
+	}
+#else
+	for(size_t i = 0; i < count; i++)
+		values[i] = tmc4671_readInt(motor, addresses[i]);
+#endif
+}
+
+// Write multiple registers back to back, see tmc4671_readIntBatch()
+void tmc4671_writeIntBatch(uint8_t motor, const uint8_t *addresses, const int32_t *values, size_t count)
+{
+#ifdef TMC4671_TRANSFER_BATCH
+	TMCTransferList list;
+
+	tmc_transfer_init(&list, motor, tmc4671_readWriteBatch);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		writeShadow(motor, addresses[i], values[i]);
+		tmc_transfer_appendDatagram(&list, addresses[i] | 0x80, values[i], NULL, NULL);
+
+		if(tmc_transfer_isFull(&list) || (i + 1 == count))
+			tmc_transfer_execute(&list);
+	}
+#else
+	for(size_t i = 0; i < count; i++)
+		tmc4671_writeInt(motor, addresses[i], values[i]);
+#endif
+}
+
+// Read values behind an address/data register pair (INTERIM_ADDR/INTERIM_DATA, PID_ERROR_ADDR/PID_ERROR_DATA).
+// The index register is only written when it changes: its value is tracked in the shadow
+// register, so repeated reads of the same index cost one access each.
+static void readIndexedBatch(uint8_t motor, uint8_t addressRegister, uint8_t dataRegister, const uint8_t *indices, int32_t *values, size_t count)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+	// Without a valid shadow register the first index is always written
+	int32_t current = isShadowValid(tmc4671, addressRegister) ? tmc4671->shadowRegister[addressRegister] : -1;
+
+#ifdef TMC4671_TRANSFER_BATCH
+	TMCTransferList list;
+
+	tmc_transfer_init(&list, motor, tmc4671_readWriteBatch);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		// Keep an index write and its data read in the same list
+		if(list.count + 2 > TMC_TRANSFER_BATCH_SIZE)
+			tmc_transfer_execute(&list);
+
+		if(indices[i] != current)
+		{
+			current = indices[i];
+			writeShadow(motor, addressRegister, current);
+			tmc_transfer_appendDatagram(&list, addressRegister | 0x80, current, NULL, NULL);
+		}
+
+		tmc_transfer_appendDatagram(&list, dataRegister, 0, tmc_transfer_decodeInt32, &values[i]);
+	}
+
+	if(list.count)
+		tmc_transfer_execute(&list);
+#else
+	for(size_t i = 0; i < count; i++)
+	{
+		if(indices[i] != current)
+		{
+			current = indices[i];
+			tmc4671_writeInt(motor, addressRegister, current);
+		}
+
+		values[i] = tmc4671_readInt(motor, dataRegister);
+	}
+#endif
+}
+
+// Read the interim values [indices], see TMC4671_INTERIM_*.
+// With TMC4671_TRANSFER_BATCH the index writes and data reads are sent as one transfer list.
+void tmc4671_readInterimBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count)
+{
+	readIndexedBatch(motor, TMC4671_INTERIM_ADDR, TMC4671_INTERIM_DATA, indices, values, count);
+}
+
+int32_t tmc4671_readInterim(uint8_t motor, uint8_t index)
+{
+	int32_t value;
+
+	tmc4671_readInterimBatch(motor, &index, &value, 1);
+	return value;
+}
+
+// Read the PID errors and error sums [indices], see TMC4671_PID_ERROR_*
+void tmc4671_readPidErrorBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count)
+{
+	readIndexedBatch(motor, TMC4671_PID_ERROR_ADDR, TMC4671_PID_ERROR_DATA, indices, values, count);
+}
+
+void tmc4671_streamSetpoint(TMC4671SetpointStreamTypeDef *stream, int32_t value)
+{
+	uint8_t *data = &stream->datagram[stream->next][0];
+
+	switch(stream->channel)
+	{
+	case BIT_0_TO_15:
+		data[3] = 0xFF & (value>>8);
+		data[4] = 0xFF & (value>>0);
+		break;
+	case BIT_16_TO_31:
+		data[1] = 0xFF & (value>>8);
+		data[2] = 0xFF & (value>>0);
+		break;
+	default:
+		data[1] = 0xFF & (value>>24);
+		data[2] = 0xFF & (value>>16);
+		data[3] = 0xFF & (value>>8);
+		data[4] = 0xFF & (value>>0);
+		break;
+	}
+
+#ifdef TMC4671_ASYNC
+	if(stream->busy)
+	{
+		// Sent by streamComplete() once the current transfer is done
+		stream->pending = true;
+		return;
+	}
+#endif
+
+	streamSend(stream);
+}
+
+// The selected registers are read with one tmc4671_readIntBatch() call
+void tmc4671_readTelemetry(uint8_t motor, TMC4671TelemetryTypeDef *telemetry, uint8_t mask)
+{
+	uint8_t addresses[4];
+	int32_t values[4];
+	size_t count = 0;
+
+	if(mask & (TMC4671_TELEMETRY_TORQUE | TMC4671_TELEMETRY_FLUX))
+		addresses[count++] = TMC4671_PID_TORQUE_FLUX_ACTUAL;
+	if(mask & TMC4671_TELEMETRY_PHI_E)
+		addresses[count++] = TMC4671_PHI_E;
+	if(mask & TMC4671_TELEMETRY_VELOCITY)
+		addresses[count++] = TMC4671_PID_VELOCITY_ACTUAL;
+	if(mask & TMC4671_TELEMETRY_POSITION)
+		addresses[count++] = TMC4671_PID_POSITION_ACTUAL;
+
+	tmc4671_readIntBatch(motor, addresses, values, count);
+	count = 0;
+
+	if(mask & (TMC4671_TELEMETRY_TORQUE | TMC4671_TELEMETRY_FLUX))
+	{
+		int32_t torqueFlux = values[count++];
+
+		if(mask & TMC4671_TELEMETRY_TORQUE)
+			telemetry->torque = (int16_t) FIELD_GET(torqueFlux, TMC4671_PID_TORQUE_ACTUAL_MASK, TMC4671_PID_TORQUE_ACTUAL_SHIFT);
+		if(mask & TMC4671_TELEMETRY_FLUX)
+			telemetry->flux = (int16_t) FIELD_GET(torqueFlux, TMC4671_PID_FLUX_ACTUAL_MASK, TMC4671_PID_FLUX_ACTUAL_SHIFT);
+	}
+
+	if(mask & TMC4671_TELEMETRY_PHI_E)
+		telemetry->phiE = (int16_t) FIELD_GET(values[count++], TMC4671_PHI_E_MASK, TMC4671_PHI_E_SHIFT);
+
+	if(mask & TMC4671_TELEMETRY_VELOCITY)
+		telemetry->velocity = values[count++];
+
+	if(mask & TMC4671_TELEMETRY_POSITION)
+		telemetry->position = values[count++];
+}
+
+// setpoint ramp
+static uint8_t rampMotionMode(TMC_SetpointRamp *ramp)
+{
+	switch(ramp->mode)
+	{
+	case TMC_RAMP_SETPOINT_TORQUE:
+		return TMC4671_MOTION_MODE_TORQUE;
+	case TMC_RAMP_SETPOINT_VELOCITY:
+		return TMC4671_MOTION_MODE_VELOCITY;
+	default:
+		return TMC4671_MOTION_MODE_POSITION;
+	}
+}
+
+static int32_t rampActualValue(uint8_t motor, TMC_SetpointRamp *ramp)
+{
+	switch(ramp->mode)
+	{
+	case TMC_RAMP_SETPOINT_TORQUE:
+		return tmc4671_getActualTorque_raw(motor);
+	case TMC_RAMP_SETPOINT_VELOCITY:
+		return tmc4671_getActualVelocity(motor);
+	default:
+		return tmc4671_getActualPosition(motor);
+	}
+}
+
+// (Re)start the stream of the ramp register. For the torque this picks up the current flux target.
+static void startRampStream(TMC4671TypeDef *tmc4671)
+{
+#ifdef TMC4671_ASYNC
+	// Restarting would drop the setpoint in flight, the running stream is still valid
+	if(tmc4671->rampStream.busy)
+		return;
+#endif
+
+	switch(tmc4671->ramp->mode)
+	{
+	case TMC_RAMP_SETPOINT_TORQUE:
+		tmc4671_startSetpointStream(&tmc4671->rampStream, tmc4671->motor, TMC4671_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31);
+		break;
+	case TMC_RAMP_SETPOINT_VELOCITY:
+		tmc4671_startSetpointStream(&tmc4671->rampStream, tmc4671->motor, TMC4671_PID_VELOCITY_TARGET, TMC4671_STREAM_32BIT);
+		break;
+	default:
+		tmc4671_startSetpointStream(&tmc4671->rampStream, tmc4671->motor, TMC4671_PID_POSITION_TARGET, TMC4671_STREAM_32BIT);
+		break;
+	}
+}
+
+static TMC_SetpointRamp *getRamp(uint8_t motor, TMC_SetpointRamp_Mode mode)
+{
+	TMC_SetpointRamp *ramp = tmc4671_getRamp(motor);
+
+	return (ramp && (ramp->mode == mode)) ? ramp : NULL;
+}
+
+static void startRamp(uint8_t motor, TMC_SetpointRamp *ramp, int32_t target)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+	uint8_t mode = rampMotionMode(ramp);
+
+	startRampStream(tmc4671);
+
+	// Coming from another motion mode, the ramp starts at the actual value of the motor.
+	// Otherwise it continues from its current setpoint.
+	if((tmc4671_readInt(motor, TMC4671_MODE_RAMP_MODE_MOTION) & 0xFF) != mode)
+	{
+		tmc_ramp_setpoint_set_setpoint(ramp, rampActualValue(motor, ramp));
+		tmc4671_streamSetpoint(&tmc4671->rampStream, tmc_ramp_setpoint_get_setpoint(ramp));
+		tmc4671_switchToMotionMode(motor, mode);
+	}
+
+	tmc_ramp_setpoint_set_target(ramp, target);
+}
+
+void tmc4671_setRamp(uint8_t motor, TMC_SetpointRamp *ramp)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+
+	if(!tmc4671)
+		return;
+
+	tmc4671->ramp = ramp;
+
+	// Already running in the mode of the ramp: start with the current target
+	if(ramp && ((tmc4671_readInt(motor, TMC4671_MODE_RAMP_MODE_MOTION) & 0xFF) == rampMotionMode(ramp)))
+	{
+		switch(ramp->mode)
+		{
+		case TMC_RAMP_SETPOINT_TORQUE:
+			tmc_ramp_setpoint_set_setpoint(ramp, (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_PID_TORQUE_FLUX_TARGET, BIT_16_TO_31));
+			break;
+		case TMC_RAMP_SETPOINT_VELOCITY:
+			tmc_ramp_setpoint_set_setpoint(ramp, tmc4671_getTargetVelocity(motor));
+			break;
+		default:
+			tmc_ramp_setpoint_set_setpoint(ramp, tmc4671_getTargetPosition(motor));
+			break;
+		}
+	}
+}
+
+TMC_SetpointRamp *tmc4671_getRamp(uint8_t motor)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+
+	return (tmc4671) ? tmc4671->ramp : NULL;
+}
+
+// Stream the next ramp setpoint every [interval] ticks of the ramp. tmc4671_periodicJobInstance()
+// calls it, applications needing a more regular setpoint rate call it from a timer.
+void tmc4671_rampJob(uint8_t motor, uint32_t actualSystick)
+{
+	TMC4671TypeDef *tmc4671 = getInstance(motor);
+	TMC_SetpointRamp *ramp = tmc4671_getRamp(motor);
+
+	if(!ramp || tmc_ramp_setpoint_isDone(ramp) || !tmc_ramp_setpoint_isDue(ramp, actualSystick))
+		return;
+
+	if(tmc_ramp_setpoint_compute(ramp, actualSystick))
+		tmc4671_streamSetpoint(&tmc4671->rampStream, tmc_ramp_setpoint_get_setpoint(ramp));
 }
 
 // encoder initialization
-void tmc4671_doEncoderInitializationMode0(uint8_t motor, uint8_t *initState, uint16_t initWaitTime, uint16_t *actualInitWaitTime, uint16_t startVoltage,
-		uint16_t *last_Phi_E_Selection, uint32_t *last_UQ_UD_EXT, int16_t *last_PHI_E_EXT)
+static void doEncoderInitializationMode0(uint8_t motor, TMC4671EncoderInitTypeDef *init, uint32_t actualSystick)
 {
-	switch (*initState)
+	switch (init->state)
 	{
 	case STATE_NOTHING_TO_DO:
-		*actualInitWaitTime = 0;
+		init->startTick = actualSystick;
 		break;
 	case STATE_START_INIT: // started by writing 1 to initState
 
 		// save actual set values for PHI_E_SELECTION, UQ_UD_EXT, and PHI_E_EXT
-		*last_Phi_E_Selection = (uint16_t) tmc4671_readRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15);
-		*last_UQ_UD_EXT = (uint32_t) tmc4671_readInt(motor, TMC4671_UQ_UD_EXT);
-		*last_PHI_E_EXT = (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_PHI_E_EXT, BIT_0_TO_15);
+		init->last_Phi_E_Selection = (uint16_t) tmc4671_readRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15);
+		init->last_UQ_UD_EXT = (uint32_t) tmc4671_readInt(motor, TMC4671_UQ_UD_EXT);
+		init->last_PHI_E_EXT = (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_PHI_E_EXT, BIT_0_TO_15);
 
 		//switch motion mode for running motor in open loop
 		tmc4671_writeInt(motor, TMC4671_MODE_RAMP_MODE_MOTION, TMC4671_MOTION_MODE_UQ_UD_EXT);
@@ -314,42 +891,42 @@ void tmc4671_doEncoderInitializationMode0(uint8_t motor, uint8_t *initState, uin
 
 		// set an initialization voltage on UD_EXT (to the flux, not the torque!)
 		tmc4671_writeRegister16BitValue(motor, TMC4671_UQ_UD_EXT, BIT_16_TO_31, 0);
-		tmc4671_writeRegister16BitValue(motor, TMC4671_UQ_UD_EXT, BIT_0_TO_15, startVoltage);
+		tmc4671_writeRegister16BitValue(motor, TMC4671_UQ_UD_EXT, BIT_0_TO_15, init->startVoltage);
 
 		// set the "zero" angle
 		tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_EXT, BIT_0_TO_15, 0);
 
-		*initState = STATE_WAIT_INIT_TIME;
+		init->startTick = actualSystick;
+		init->state = STATE_WAIT_INIT_TIME;
 		break;
 	case STATE_WAIT_INIT_TIME:
 		// wait until initialization time is over (until no more vibration on the motor)
-		(*actualInitWaitTime)++;
-		if(*actualInitWaitTime >= initWaitTime)
+		if((uint32_t) (actualSystick - init->startTick) >= init->waitTime)
 		{
 			// set internal encoder value to zero
 			tmc4671_writeInt(motor, TMC4671_ABN_DECODER_COUNT, 0);
 
 			// switch back to last used UQ_UD_EXT setting
-			tmc4671_writeInt(motor, TMC4671_UQ_UD_EXT, *last_UQ_UD_EXT);
+			tmc4671_writeInt(motor, TMC4671_UQ_UD_EXT, init->last_UQ_UD_EXT);
 
 			// set PHI_E_EXT back to last value
-			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_EXT, BIT_0_TO_15, *last_PHI_E_EXT);
+			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_EXT, BIT_0_TO_15, init->last_PHI_E_EXT);
 
 			// switch back to last used PHI_E_SELECTION setting
-			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15, *last_Phi_E_Selection);
+			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15, init->last_Phi_E_Selection);
 
 			// go to next state
-			*initState = STATE_ESTIMATE_OFFSET;
+			init->state = STATE_ESTIMATE_OFFSET;
 		}
 		break;
 	case STATE_ESTIMATE_OFFSET:
 		// you can do offset estimation here (wait for N-Channel if available and save encoder value)
 
 		// go to ready state
-		*initState = 0;
+		init->state = 0;
 		break;
 	default:
-		*initState = 0;
+		init->state = 0;
 		break;
 	}
 }
@@ -359,17 +936,16 @@ int16_t tmc4671_getS16CircleDifference(int16_t newValue, int16_t oldValue)
 	return (newValue - oldValue);
 }
 
-void tmc4671_doEncoderInitializationMode2(uint8_t motor, uint8_t *initState, uint16_t *actualInitWaitTime,
-		int16_t *hall_phi_e_old, int16_t *hall_phi_e_new, int16_t *hall_actual_coarse_offset, uint16_t *last_Phi_E_Selection)
+static void doEncoderInitializationMode2(uint8_t motor, TMC4671EncoderInitTypeDef *init, uint32_t actualSystick)
 {
-	switch (*initState)
+	switch (init->state)
 	{
 	case STATE_NOTHING_TO_DO:
-		*actualInitWaitTime = 0;
+		init->startTick = actualSystick;
 		break;
 	case STATE_START_INIT: // started by writing 1 to initState
 		// save actual set value for PHI_E_SELECTION
-		*last_Phi_E_Selection = (uint16_t)tmc4671_readRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15);
+		init->last_Phi_E_Selection = (uint16_t)tmc4671_readRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15);
 
 		// turn hall_mode interpolation off (read, clear bit 8, write back)
 		tmc4671_writeInt(motor, TMC4671_HALL_MODE, tmc4671_readInt(motor, TMC4671_HALL_MODE) & 0xFFFFFEFF);
@@ -378,13 +954,13 @@ void tmc4671_doEncoderInitializationMode2(uint8_t motor, uint8_t *initState, uin
 		tmc4671_writeRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M_OFFSET, BIT_16_TO_31, 0);
 
 		// read actual hall angle
-		*hall_phi_e_old = TMC4671_FIELD_READ(motor, TMC4671_HALL_PHI_E_INTERPOLATED_PHI_E, TMC4671_HALL_PHI_E_MASK, TMC4671_HALL_PHI_E_SHIFT);
+		init->hall_phi_e_old = TMC4671_FIELD_READ(motor, TMC4671_HALL_PHI_E_INTERPOLATED_PHI_E, TMC4671_HALL_PHI_E_MASK, TMC4671_HALL_PHI_E_SHIFT);
 
 		// read actual abn_decoder angle and compute difference to actual hall angle
-		*hall_actual_coarse_offset = tmc4671_getS16CircleDifference(*hall_phi_e_old, (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M, BIT_16_TO_31));
+		init->hall_actual_coarse_offset = tmc4671_getS16CircleDifference(init->hall_phi_e_old, (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M, BIT_16_TO_31));
 
 		// set ABN_DECODER_PHI_E_OFFSET to actual hall-abn-difference, to use the actual hall angle for coarse initialization
-		tmc4671_writeRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M_OFFSET, BIT_16_TO_31, *hall_actual_coarse_offset);
+		tmc4671_writeRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M_OFFSET, BIT_16_TO_31, init->hall_actual_coarse_offset);
 
 		// normally MOTION_MODE_UQ_UD_EXT is only used by e.g. a wizard, not in normal operation
 		if (TMC4671_FIELD_READ(motor, TMC4671_MODE_RAMP_MODE_MOTION, TMC4671_MODE_MOTION_MASK, TMC4671_MODE_MOTION_SHIFT) != TMC4671_MOTION_MODE_UQ_UD_EXT)
@@ -393,58 +969,97 @@ void tmc4671_doEncoderInitializationMode2(uint8_t motor, uint8_t *initState, uin
 			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15, TMC4671_PHI_E_HALL);
 		}
 
-		*initState = STATE_WAIT_INIT_TIME;
+		init->startTick = actualSystick;
+		init->state = STATE_WAIT_INIT_TIME;
 		break;
 	case STATE_WAIT_INIT_TIME:
 		// read actual hall angle
-		*hall_phi_e_new = TMC4671_FIELD_READ(motor, TMC4671_HALL_PHI_E_INTERPOLATED_PHI_E, TMC4671_HALL_PHI_E_MASK, TMC4671_HALL_PHI_E_SHIFT);
+		init->hall_phi_e_new = TMC4671_FIELD_READ(motor, TMC4671_HALL_PHI_E_INTERPOLATED_PHI_E, TMC4671_HALL_PHI_E_MASK, TMC4671_HALL_PHI_E_SHIFT);
 
 		// wait until hall angle changed
-		if(*hall_phi_e_old != *hall_phi_e_new)
+		if(init->hall_phi_e_old != init->hall_phi_e_new)
 		{
 			// estimated value = old value + diff between old and new (handle int16_t overrun)
-			int16_t hall_phi_e_estimated = *hall_phi_e_old + tmc4671_getS16CircleDifference(*hall_phi_e_new, *hall_phi_e_old)/2;
+			int16_t hall_phi_e_estimated = init->hall_phi_e_old + tmc4671_getS16CircleDifference(init->hall_phi_e_new, init->hall_phi_e_old)/2;
 
 			// read actual abn_decoder angle and consider last set abn_decoder_offset
-			int16_t abn_phi_e_actual = (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M, BIT_16_TO_31) - *hall_actual_coarse_offset;
+			int16_t abn_phi_e_actual = (int16_t) tmc4671_readRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M, BIT_16_TO_31) - init->hall_actual_coarse_offset;
 
 			// set ABN_DECODER_PHI_E_OFFSET to actual estimated angle - abn_phi_e_actual difference
 			tmc4671_writeRegister16BitValue(motor, TMC4671_ABN_DECODER_PHI_E_PHI_M_OFFSET, BIT_16_TO_31, tmc4671_getS16CircleDifference(hall_phi_e_estimated, abn_phi_e_actual));
 
 			// switch back to last used PHI_E_SELECTION setting
-			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15, *last_Phi_E_Selection);
+			tmc4671_writeRegister16BitValue(motor, TMC4671_PHI_E_SELECTION, BIT_0_TO_15, init->last_Phi_E_Selection);
 
 			// go to ready state
-			*initState = 0;
+			init->state = 0;
 		}
 		break;
 	default:
-		*initState = 0;
+		init->state = 0;
 		break;
 	}
 }
 
+void tmc4671_setupEncoderInitialization(TMC4671EncoderInitTypeDef *init, uint16_t waitTime, uint16_t startVoltage)
+{
+	init->mode                       = 0;
+	init->state                      = STATE_NOTHING_TO_DO;
+	init->waitTime                   = waitTime;
+	init->startVoltage               = startVoltage;
+	init->startTick                  = 0;
+	init->hall_phi_e_old             = 0;
+	init->hall_phi_e_new             = 0;
+	init->hall_actual_coarse_offset  = 0;
+	init->last_Phi_E_Selection       = 0;
+	init->last_UQ_UD_EXT             = 0;
+	init->last_PHI_E_EXT             = 0;
+}
+
+void tmc4671_encoderInitializationJob(uint8_t motor, TMC4671EncoderInitTypeDef *init, uint32_t actualSystick)
+{
+	if(init->mode == 0)
+		doEncoderInitializationMode0(motor, init, actualSystick);
+	else if(init->mode == 2)
+		doEncoderInitializationMode2(motor, init, actualSystick);
+}
+
+bool tmc4671_isEncoderInitializationDone(TMC4671EncoderInitTypeDef *init)
+{
+	return init->state == STATE_NOTHING_TO_DO;
+}
+
 void tmc4671_checkEncderInitialization(uint8_t motor, uint32_t actualSystick, uint8_t initMode, uint8_t *initState, uint16_t initWaitTime, uint16_t *actualInitWaitTime, uint16_t startVoltage,
 		int16_t *hall_phi_e_old, int16_t *hall_phi_e_new, int16_t *hall_actual_coarse_offset,
 		uint16_t *last_Phi_E_Selection, uint32_t *last_UQ_UD_EXT, int16_t *last_PHI_E_EXT)
 {
-	// use the systick as 1ms timer for encoder initialization
-	static uint32_t lastSystick = 0;
-	if(actualSystick != lastSystick)
-	{
-		// needs timer to use the wait time
-		if(initMode == 0)
-		{
-			tmc4671_doEncoderInitializationMode0(motor, initState, initWaitTime, actualInitWaitTime, startVoltage, last_Phi_E_Selection, last_UQ_UD_EXT, last_PHI_E_EXT);
-		}
-		lastSystick = actualSystick;
-	}
-
-	// needs no timer
-	if(initMode == 2)
+	// Run the context based initialization on the caller's variables.
+	// actualInitWaitTime holds the elapsed systicks since the start of the wait.
+	TMC4671EncoderInitTypeDef init =
 	{
-		tmc4671_doEncoderInitializationMode2(motor, initState, actualInitWaitTime, hall_phi_e_old, hall_phi_e_new, hall_actual_coarse_offset, last_Phi_E_Selection);
-	}
+		.mode                       = initMode,
+		.state                      = *initState,
+		.waitTime                   = initWaitTime,
+		.startVoltage               = startVoltage,
+		.startTick                  = actualSystick - *actualInitWaitTime,
+		.hall_phi_e_old             = *hall_phi_e_old,
+		.hall_phi_e_new             = *hall_phi_e_new,
+		.hall_actual_coarse_offset  = *hall_actual_coarse_offset,
+		.last_Phi_E_Selection       = *last_Phi_E_Selection,
+		.last_UQ_UD_EXT             = *last_UQ_UD_EXT,
+		.last_PHI_E_EXT             = *last_PHI_E_EXT
+	};
+
+	tmc4671_encoderInitializationJob(motor, &init, actualSystick);
+
+	*initState                  = init.state;
+	*actualInitWaitTime         = MIN(actualSystick - init.startTick, UINT16_MAX);
+	*hall_phi_e_old             = init.hall_phi_e_old;
+	*hall_phi_e_new             = init.hall_phi_e_new;
+	*hall_actual_coarse_offset  = init.hall_actual_coarse_offset;
+	*last_Phi_E_Selection       = init.last_Phi_E_Selection;
+	*last_UQ_UD_EXT             = init.last_UQ_UD_EXT;
+	*last_PHI_E_EXT             = init.last_PHI_E_EXT;
 }
 
 void tmc4671_periodicJob(uint8_t motor, uint32_t actualSystick, uint8_t initMode, uint8_t *initState, uint16_t initWaitTime, uint16_t *actualInitWaitTime, uint16_t startVoltage,
@@ -557,6 +1172,91 @@ void tmc4671_setPositionPI(uint8_t motor, uint16_t pParameter, uint16_t iParamet
 	tmc4671_writeInt(motor, TMC4671_PID_POSITION_P_POSITION_I, ((uint32_t)pParameter << 16) | (uint32_t)iParameter);
 }
 
+// Q30 constants of the biquad coefficient calculation
+#define BIQUAD_ONE   ((int64_t)1 << 30)
+#define BIQUAD_PI    3373259426LL
+
+// tan(x) for 0 <= x <= pi/4 in Q30 (Taylor series up to x^9)
+static int64_t tanQ30(int64_t x)
+{
+	int64_t x2 = (x * x) >> 30;
+	int64_t sum = 23482185;                     // 62/2835
+
+	sum = 57947971 + ((sum * x2) >> 30);        // 17/315
+	sum = 143165577 + ((sum * x2) >> 30);       // 2/15
+	sum = 357913941 + ((sum * x2) >> 30);       // 1/3
+
+	return x + ((((x * x2) >> 30) * sum) >> 30);
+}
+
+void tmc4671_calculateBiquadLowPass(TMC4671BiquadTypeDef *biquad, uint32_t sampleFrequency, uint32_t cutoffFrequency, uint16_t qualityFactor)
+{
+	int64_t k, k2, kq, denominator;
+
+	// Cutoff frequencies up to a quarter of the sample frequency
+	cutoffFrequency = MIN(cutoffFrequency, sampleFrequency / 4);
+	if((cutoffFrequency == 0) || (qualityFactor == 0))
+	{
+		tmc4671_calculateBiquadBypass(biquad);
+		return;
+	}
+
+	// Bilinear transform with prewarping: K = tan(pi * fc / fs)
+	k = tanQ30((BIQUAD_PI * cutoffFrequency) / sampleFrequency);
+	k2 = (k * k) >> 30;
+	kq = (k * 256) / qualityFactor;
+	denominator = BIQUAD_ONE + kq + k2;
+
+	biquad->b0 = (int32_t) ((k2 << TMC4671_BIQUAD_SHIFT) / denominator);
+	biquad->b1 = 2 * biquad->b0;
+	biquad->b2 = biquad->b0;
+	biquad->a1 = (int32_t) ((2 * (BIQUAD_ONE - k2) * ((int64_t)1 << TMC4671_BIQUAD_SHIFT)) / denominator);
+	biquad->a2 = (int32_t) (-(BIQUAD_ONE - kq + k2) * ((int64_t)1 << TMC4671_BIQUAD_SHIFT) / denominator);
+	biquad->enable = true;
+}
+
+void tmc4671_calculateBiquadBypass(TMC4671BiquadTypeDef *biquad)
+{
+	biquad->b0      = (int32_t)1 << TMC4671_BIQUAD_SHIFT;
+	biquad->b1      = 0;
+	biquad->b2      = 0;
+	biquad->a1      = 0;
+	biquad->a2      = 0;
+	biquad->enable  = false;
+}
+
+static void writeConfig(uint8_t motor, uint8_t address, int32_t value)
+{
+	tmc4671_writeInt(motor, TMC4671_CONFIG_ADDR, address);
+	tmc4671_writeInt(motor, TMC4671_CONFIG_DATA, value);
+}
+
+void tmc4671_writeBiquad(uint8_t motor, TMC4671BiquadFilter filter, const TMC4671BiquadTypeDef *biquad)
+{
+	// The filters have eight CONFIG addresses each, in the order of TMC4671BiquadFilter
+	uint8_t offset = (uint8_t) filter * (CONFIG_ADDR_biquad_v_a_1 - CONFIG_ADDR_biquad_x_a_1);
+
+	// Disable the filter while the coefficients do not belong together
+	writeConfig(motor, CONFIG_ADDR_biquad_x_enable + offset, 0);
+
+	writeConfig(motor, CONFIG_ADDR_biquad_x_a_1 + offset, biquad->a1);
+	writeConfig(motor, CONFIG_ADDR_biquad_x_a_2 + offset, biquad->a2);
+	writeConfig(motor, CONFIG_ADDR_biquad_x_b_0 + offset, biquad->b0);
+	writeConfig(motor, CONFIG_ADDR_biquad_x_b_1 + offset, biquad->b1);
+	writeConfig(motor, CONFIG_ADDR_biquad_x_b_2 + offset, biquad->b2);
+
+	if(biquad->enable)
+		writeConfig(motor, CONFIG_ADDR_biquad_x_enable + offset, 1);
+}
+
+void tmc4671_writeControllerGains(uint8_t motor, const TMC4671ControllerGainsTypeDef *gains)
+{
+	tmc4671_writeInt(motor, TMC4671_PID_FLUX_P_FLUX_I, ((uint32_t)gains->fluxP << 16) | (uint32_t)gains->fluxI);
+	tmc4671_writeInt(motor, TMC4671_PID_TORQUE_P_TORQUE_I, ((uint32_t)gains->torqueP << 16) | (uint32_t)gains->torqueI);
+	tmc4671_writeInt(motor, TMC4671_PID_VELOCITY_P_VELOCITY_I, ((uint32_t)gains->velocityP << 16) | (uint32_t)gains->velocityI);
+	tmc4671_writeInt(motor, TMC4671_PID_POSITION_P_POSITION_I, ((uint32_t)gains->positionP << 16) | (uint32_t)gains->positionI);
+}
+
 int32_t tmc4671_readFieldWithDependency(uint8_t motor, uint8_t reg, uint8_t dependsReg, uint32_t dependsValue, uint32_t mask, uint8_t shift)
 {
 	// remember old depends value
@@ -570,3 +1270,159 @@ int32_t tmc4671_readFieldWithDependency(uint8_t motor, uint8_t reg, uint8_t depe
 	tmc4671_writeInt(motor, dependsReg, lastDependsValue);
 	return value;
 }
+
+void tmc4671_capture_init(TMC4671CaptureTypeDef *capture, uint8_t motor, int32_t *buffer, uint32_t size)
+{
+	capture->motor           = motor;
+	capture->channelCount    = 0;
+	capture->prescaler       = 1;
+	capture->prescalerCount  = 0;
+	capture->trigger         = TMC4671_CAPTURE_TRIGGER_NONE;
+	capture->threshold       = 0;
+	capture->lastValue       = 0;
+	capture->lastValid       = false;
+	capture->buffer          = buffer;
+	capture->size            = size;
+	capture->head            = 0;
+	capture->tail            = 0;
+	capture->remaining       = 0;
+	capture->overflows       = 0;
+	capture->state           = TMC4671_CAPTURE_IDLE;
+}
+
+bool tmc4671_capture_addChannel(TMC4671CaptureTypeDef *capture, uint8_t address, uint8_t selectorAddress, uint8_t selector)
+{
+	TMC4671CaptureChannelTypeDef *channel;
+
+	if((capture->state != TMC4671_CAPTURE_IDLE) || (capture->channelCount >= TMC4671_CAPTURE_CHANNELS))
+		return false;
+
+	channel = &capture->channels[capture->channelCount++];
+	channel->address          = address;
+	channel->selectorAddress  = selectorAddress;
+	channel->selector         = selector;
+
+	return true;
+}
+
+void tmc4671_capture_setPrescaler(TMC4671CaptureTypeDef *capture, uint16_t prescaler)
+{
+	capture->prescaler = MAX(prescaler, 1);
+}
+
+void tmc4671_capture_setTrigger(TMC4671CaptureTypeDef *capture, TMC4671CaptureTrigger trigger, int32_t threshold)
+{
+	capture->trigger   = trigger;
+	capture->threshold = threshold;
+}
+
+void tmc4671_capture_arm(TMC4671CaptureTypeDef *capture, uint32_t frames)
+{
+	// The buffer needs room for at least one frame besides the free one
+	if((capture->channelCount == 0) || (capture->size < 2 * capture->channelCount))
+		return;
+
+	capture->head            = 0;
+	capture->tail            = 0;
+	capture->prescalerCount  = 0;
+	capture->overflows       = 0;
+	capture->lastValid       = false;
+	capture->remaining       = frames;
+	capture->state           = (capture->trigger == TMC4671_CAPTURE_TRIGGER_NONE) ? TMC4671_CAPTURE_RUNNING : TMC4671_CAPTURE_ARMED;
+}
+
+void tmc4671_capture_stop(TMC4671CaptureTypeDef *capture)
+{
+	capture->state = TMC4671_CAPTURE_IDLE;
+}
+
+static bool captureTriggered(TMC4671CaptureTypeDef *capture, int32_t value)
+{
+	bool triggered = false;
+
+	if(capture->lastValid)
+	{
+		if(capture->trigger == TMC4671_CAPTURE_TRIGGER_RISING)
+			triggered = (capture->lastValue < capture->threshold) && (value >= capture->threshold);
+		else if(capture->trigger == TMC4671_CAPTURE_TRIGGER_FALLING)
+			triggered = (capture->lastValue >= capture->threshold) && (value < capture->threshold);
+	}
+
+	capture->lastValue = value;
+	capture->lastValid = true;
+
+	return triggered;
+}
+
+void tmc4671_capture_sample(TMC4671CaptureTypeDef *capture)
+{
+	uint32_t head = capture->head;
+	uint32_t used;
+	uint8_t i;
+
+	if((capture->state != TMC4671_CAPTURE_ARMED) && (capture->state != TMC4671_CAPTURE_RUNNING))
+		return;
+
+	if(++capture->prescalerCount < capture->prescaler)
+		return;
+	capture->prescalerCount = 0;
+
+	used = (head >= capture->tail) ? (head - capture->tail) : (capture->size - capture->tail + head);
+
+	// Keep one frame free to tell a full buffer from an empty one
+	if((capture->state == TMC4671_CAPTURE_RUNNING) && (used + 2 * capture->channelCount > capture->size))
+	{
+		capture->overflows++;
+		return;
+	}
+
+	for(i = 0; i < capture->channelCount; i++)
+	{
+		TMC4671CaptureChannelTypeDef *channel = &capture->channels[i];
+		int32_t value;
+
+		if(channel->selectorAddress != TMC4671_CAPTURE_NO_SELECTOR)
+			tmc4671_writeInt(capture->motor, channel->selectorAddress, channel->selector);
+		value = tmc4671_readInt(capture->motor, channel->address);
+
+		if(capture->state == TMC4671_CAPTURE_ARMED)
+		{
+			// Only channel 0 is needed for the trigger
+			if(!captureTriggered(capture, value))
+				return;
+			capture->state = TMC4671_CAPTURE_RUNNING;
+		}
+
+		capture->buffer[head] = value;
+		head = (head + 1 == capture->size) ? 0 : head + 1;
+	}
+
+	capture->head = head;
+
+	if(capture->remaining && (--capture->remaining == 0))
+		capture->state = TMC4671_CAPTURE_DONE;
+}
+
+uint32_t tmc4671_capture_read(TMC4671CaptureTypeDef *capture, int32_t *data, uint32_t count)
+{
+	uint32_t head = capture->head;
+	uint32_t tail = capture->tail;
+	uint32_t used = (head >= tail) ? (head - tail) : (capture->size - tail + head);
+	uint32_t i;
+
+	if(capture->channelCount == 0)
+		return 0;
+
+	count = MIN(count, used);
+	count -= count % capture->channelCount;
+
+	for(i = 0; i < count; i++)
+	{
+		data[i] = capture->buffer[tail];
+		tail = (tail + 1 == capture->size) ? 0 : tail + 1;
+	}
+
+	capture->tail = tail;
+
+	return count;
+}
@@ -12,11 +12,216 @@
 #include "TMC4671_Register.h"
 #include "TMC4671_Constants.h"
 #include "TMC4671_Fields.h"
+#include "tmc/ramp/SetpointRamp.h"
 
 // spi access
 #define BIT_0_TO_15   0
 #define BIT_16_TO_31  1
 
+#define TMC4671_REGISTER_COUNT TMC_REGISTER_COUNT
+
+// Register access permissions:
+//   0x00: none (reserved)
+//   0x01: read
+//   0x03: read/write
+//   0x13: read/write, the chip changes the value or it depends on another
+//         register (e.g. counters and the DATA part of ADDR/DATA pairs)
+//   0x23: read/write, flag register (write to clear)
+// Written registers with plain read/write access (0x03) are kept in the
+// shadow registers, so 16 bit half-register writes need no readback.
+static const uint8_t tmc4671_defaultRegisterAccess[TMC4671_REGISTER_COUNT] =
+{
+//  0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	0x01, 0x03, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, // 0x00 - 0x0F
+	____, 0x03, 0x01, 0x01, ____, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, // 0x10 - 0x1F
+	0x03, 0x03, 0x01, 0x13, 0x03, 0x03, 0x03, 0x13, 0x13, 0x03, 0x01, ____, 0x03, 0x03, 0x13, 0x13, // 0x20 - 0x2F
+	0x03, 0x01, ____, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x01, 0x03, 0x03, 0x01, 0x03, 0x01, // 0x30 - 0x3F
+	0x03, 0x13, 0x13, ____, ____, 0x03, 0x01, 0x13, ____, ____, 0x01, 0x01, 0x01, 0x13, 0x03, ____, // 0x40 - 0x4F
+	0x03, 0x03, 0x03, 0x01, 0x03, ____, 0x03, ____, 0x03, ____, 0x03, ____, 0x03, 0x03, 0x03, 0x03, // 0x50 - 0x5F
+	0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x01, 0x13, 0x01, 0x03, 0x13, 0x03, // 0x60 - 0x6F
+	____, ____, ____, ____, 0x03, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x23, 0x03, ____, ____  // 0x70 - 0x7F
+};
+
+// Indices of tmc4671_readInterimBatch()
+#define TMC4671_INTERIM_PIDIN_TARGET_TORQUE     0
+#define TMC4671_INTERIM_PIDIN_TARGET_FLUX       1
+#define TMC4671_INTERIM_PIDIN_TARGET_VELOCITY   2
+#define TMC4671_INTERIM_PIDIN_TARGET_POSITION   3
+#define TMC4671_INTERIM_PIDOUT_TARGET_TORQUE    4
+#define TMC4671_INTERIM_PIDOUT_TARGET_FLUX      5
+#define TMC4671_INTERIM_PIDOUT_TARGET_VELOCITY  6
+#define TMC4671_INTERIM_PIDOUT_TARGET_POSITION  7
+
+// Indices of tmc4671_readPidErrorBatch()
+#define TMC4671_PID_ERROR_TORQUE        0
+#define TMC4671_PID_ERROR_FLUX          1
+#define TMC4671_PID_ERROR_VELOCITY      2
+#define TMC4671_PID_ERROR_POSITION      3
+#define TMC4671_PID_ERROR_TORQUE_SUM    4
+#define TMC4671_PID_ERROR_FLUX_SUM      5
+#define TMC4671_PID_ERROR_VELOCITY_SUM  6
+#define TMC4671_PID_ERROR_POSITION_SUM  7
+
+// Telemetry values read by tmc4671_readTelemetry()
+#define TMC4671_TELEMETRY_TORQUE    0x01
+#define TMC4671_TELEMETRY_FLUX      0x02
+#define TMC4671_TELEMETRY_VELOCITY  0x04
+#define TMC4671_TELEMETRY_POSITION  0x08
+#define TMC4671_TELEMETRY_PHI_E     0x10
+#define TMC4671_TELEMETRY_ALL       0x1F
+
+typedef struct
+{
+	int16_t torque;    // PID_TORQUE_ACTUAL
+	int16_t flux;      // PID_FLUX_ACTUAL
+	int16_t phiE;      // PHI_E
+	int32_t velocity;  // PID_VELOCITY_ACTUAL
+	int32_t position;  // PID_POSITION_ACTUAL
+} TMC4671TelemetryTypeDef;
+
+// Setpoint streaming, see tmc4671_startSetpointStream()
+#define TMC4671_STREAM_32BIT  2  // Channel value for streaming the whole register
+
+typedef struct
+{
+	uint8_t motor;
+	uint8_t channel;         // BIT_0_TO_15, BIT_16_TO_31 or TMC4671_STREAM_32BIT
+	uint8_t datagram[2][5];  // Prepared write datagrams, only the payload is patched
+	uint8_t next;            // Datagram to fill with the next setpoint
+#ifdef TMC4671_ASYNC
+	volatile bool busy;      // A datagram is being sent
+	volatile bool pending;   // datagram[next] holds a setpoint that was not sent yet
+#endif
+} TMC4671SetpointStreamTypeDef;
+
+// Biquad filter coefficients, signed fixed point with 29 fractional bits.
+// The TMC4671 calculates y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2],
+// so a1 and a2 have the opposite sign of the usual textbook notation.
+#define TMC4671_BIQUAD_SHIFT  29
+
+// Quality factor of a Butterworth low pass (1/sqrt(2)) in 1/256
+#define TMC4671_BIQUAD_Q_BUTTERWORTH  181
+
+typedef enum {
+	TMC4671_BIQUAD_POSITION,
+	TMC4671_BIQUAD_VELOCITY,
+	TMC4671_BIQUAD_TORQUE,
+	TMC4671_BIQUAD_FLUX
+} TMC4671BiquadFilter;
+
+typedef struct
+{
+	int32_t a1;
+	int32_t a2;
+	int32_t b0;
+	int32_t b1;
+	int32_t b2;
+	bool enable;
+} TMC4671BiquadTypeDef;
+
+typedef struct
+{
+	uint16_t fluxP;
+	uint16_t fluxI;
+	uint16_t torqueP;
+	uint16_t torqueI;
+	uint16_t velocityP;
+	uint16_t velocityI;
+	uint16_t positionP;
+	uint16_t positionI;
+} TMC4671ControllerGainsTypeDef;
+
+// Precomputed conversions between mA and the raw torque/flux values for one motor,
+// see tmc4671_initScaling(). Same results as the *_mA functions without a division per value.
+typedef struct
+{
+	uint16_t torqueMeasurementFactor;  // mA per 256 raw units
+	uint8_t shift;
+	uint64_t reciprocal;               // 2^shift / torqueMeasurementFactor, rounded up
+} TMC4671ScalingTypeDef;
+
+// Encoder initialization state of one motor, see tmc4671_encoderInitializationJob()
+typedef struct
+{
+	uint8_t mode;                       // 0: open loop alignment, 2: hall signals
+	uint8_t state;                      // 0 when no initialization is running
+	uint16_t waitTime;                  // Open loop alignment duration in systicks
+	uint16_t startVoltage;              // UD_EXT voltage of the open loop alignment
+	uint32_t startTick;                 // Systick the current state started at
+	int16_t hall_phi_e_old;
+	int16_t hall_phi_e_new;
+	int16_t hall_actual_coarse_offset;
+	uint16_t last_Phi_E_Selection;      // Settings restored after the initialization
+	uint32_t last_UQ_UD_EXT;
+	int16_t last_PHI_E_EXT;
+} TMC4671EncoderInitTypeDef;
+
+// Software capture of internal values, sampled by tmc4671_capture_sample().
+// The TMC4671 has no on-chip trace memory. Internal signals are reached through the
+// ADDR/DATA selector register pairs (e.g. INTERIM_ADDR/INTERIM_DATA), so each channel
+// is a data register with an optional selector written before reading it.
+#define TMC4671_CAPTURE_CHANNELS     4
+#define TMC4671_CAPTURE_NO_SELECTOR  0xFF
+
+typedef enum {
+	TMC4671_CAPTURE_IDLE,
+	TMC4671_CAPTURE_ARMED,    // Sampling, waiting for the trigger
+	TMC4671_CAPTURE_RUNNING,  // Triggered, storing samples
+	TMC4671_CAPTURE_DONE
+} TMC4671CaptureState;
+
+typedef enum {
+	TMC4671_CAPTURE_TRIGGER_NONE,     // Start storing on arming
+	TMC4671_CAPTURE_TRIGGER_RISING,   // Channel 0 rises to or above the threshold
+	TMC4671_CAPTURE_TRIGGER_FALLING   // Channel 0 falls below the threshold
+} TMC4671CaptureTrigger;
+
+typedef struct
+{
+	uint8_t address;          // Register read for the sample
+	uint8_t selectorAddress;  // ADDR register written before, or TMC4671_CAPTURE_NO_SELECTOR
+	uint8_t selector;         // Value written to selectorAddress
+} TMC4671CaptureChannelTypeDef;
+
+typedef struct
+{
+	uint8_t motor;
+	TMC4671CaptureChannelTypeDef channels[TMC4671_CAPTURE_CHANNELS];
+	uint8_t channelCount;
+
+	uint16_t prescaler;       // Store every n-th call of tmc4671_capture_sample()
+	uint16_t prescalerCount;
+
+	TMC4671CaptureTrigger trigger;
+	int32_t threshold;
+	int32_t lastValue;         // Previous channel 0 value for the edge detection
+	bool lastValid;
+
+	// Ring buffer of frames (channelCount values each), written by the sampling
+	// and drained by tmc4671_capture_read()
+	int32_t *buffer;
+	uint32_t size;             // Buffer size in values
+	volatile uint32_t head;    // Next value to write
+	volatile uint32_t tail;    // Next value to read
+	uint32_t remaining;        // Frames left to store after the trigger
+	uint32_t overflows;        // Frames dropped because the buffer was full
+	volatile TMC4671CaptureState state;
+} TMC4671CaptureTypeDef;
+
+// Per-motor state of the driver, registered with tmc4671_init().
+// The motor index functions below use the state of the instance registered for
+// their motor. Motors without an instance work the same, but without shadow registers.
+typedef struct
+{
+	uint8_t motor;                                   // Passed to the SPI wrapper
+	int32_t shadowRegister[TMC4671_REGISTER_COUNT];  // See tmc4671_defaultRegisterAccess
+	uint32_t shadowValid[TMC_DIRTY_WORDS];
+	TMC4671EncoderInitTypeDef encoderInit;
+	TMC4671ScalingTypeDef scaling;
+	TMC_SetpointRamp *ramp;                  // See tmc4671_setRamp(), NULL: targets are written directly
+	TMC4671SetpointStreamTypeDef rampStream; // Writes the ramp setpoints
+} TMC4671TypeDef;
+
 // Helper macros
 #define TMC4671_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc4671_readInt(tdef, address), mask, shift)
@@ -25,8 +230,24 @@
 
 int32_t tmc4671_readInt(uint8_t motor, uint8_t address);
 void tmc4671_writeInt(uint8_t motor, uint8_t address, int32_t value);
+void tmc4671_readIntBatch(uint8_t motor, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc4671_writeIntBatch(uint8_t motor, const uint8_t *addresses, const int32_t *values, size_t count);
+void tmc4671_readInterimBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count);
+int32_t tmc4671_readInterim(uint8_t motor, uint8_t index);
+void tmc4671_readPidErrorBatch(uint8_t motor, const uint8_t *indices, int32_t *values, size_t count);
+#ifdef TMC4671_ASYNC
+TMCAsyncRequestTypeDef *tmc4671_readIntAsync(uint8_t motor, TMCAsyncRequestTypeDef *request, uint8_t address, tmc_async_callback callback, void *userData);
+TMCAsyncRequestTypeDef *tmc4671_writeIntAsync(uint8_t motor, TMCAsyncRequestTypeDef *request, uint8_t address, int32_t value, tmc_async_callback callback, void *userData);
+#endif
 uint16_t tmc4671_readRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel);
 void tmc4671_writeRegister16BitValue(uint8_t motor, uint8_t address, uint8_t channel, uint16_t value);
+void tmc4671_clearShadowRegisters(uint8_t motor);
+
+// instances
+void tmc4671_init(TMC4671TypeDef *tmc4671, uint8_t motor);
+TMC4671TypeDef *tmc4671_getInstance(uint8_t motor);
+// Runs the encoder initialization of the instance (tmc4671->encoderInit) and its setpoint ramp
+void tmc4671_periodicJobInstance(TMC4671TypeDef *tmc4671, uint32_t actualSystick);
 
 // do cyclic tasks
 void tmc4671_periodicJob(uint8_t motor, uint32_t actualSystick, uint8_t initMode, uint8_t *initState, uint16_t initWaitTime, uint16_t *actualInitWaitTime, uint16_t startVoltage,
@@ -37,6 +258,12 @@ void tmc4671_periodicJob(uint8_t motor, uint32_t actualSystick, uint8_t initMode
 void tmc4671_startEncoderInitialization(uint8_t mode, uint8_t *initMode, uint8_t *initState);
 void tmc4671_updatePhiSelectionAndInitialize(uint8_t motor, uint8_t actualPhiESelection, uint8_t desiredPhiESelection, uint8_t initMode, uint8_t *initState);
 
+// Context based encoder initialization. Each motor has its own context, the wait time
+// is measured against actualSystick, independent of how often the job is called.
+void tmc4671_setupEncoderInitialization(TMC4671EncoderInitTypeDef *init, uint16_t waitTime, uint16_t startVoltage);
+void tmc4671_encoderInitializationJob(uint8_t motor, TMC4671EncoderInitTypeDef *init, uint32_t actualSystick);
+bool tmc4671_isEncoderInitializationDone(TMC4671EncoderInitTypeDef *init);
+
 // === modes of operation ===
 void tmc4671_switchToMotionMode(uint8_t motor, uint8_t mode);
 
@@ -66,6 +293,13 @@ int32_t tmc4671_getActualFlux_mA(uint8_t motor, uint16_t torqueMeasurementFactor
 void tmc4671_setTorqueFluxLimit_mA(uint8_t motor, uint16_t torqueMeasurementFactor, int32_t max);
 int32_t tmc4671_getTorqueFluxLimit_mA(uint8_t motor, uint16_t torqueMeasurementFactor);
 
+// Torque/flux scaling
+void tmc4671_initScaling(TMC4671ScalingTypeDef *scaling, uint16_t torqueMeasurementFactor);
+// [milliAmpere] must be within +-2^23
+int32_t tmc4671_scaleToRaw(const TMC4671ScalingTypeDef *scaling, int32_t milliAmpere);
+int32_t tmc4671_scaleToMilliAmpere(const TMC4671ScalingTypeDef *scaling, int32_t raw);
+void tmc4671_scaleToMilliAmpereArray(const TMC4671ScalingTypeDef *scaling, const int32_t *raw, int32_t *milliAmpere, size_t count);
+
 // velocity mode
 void tmc4671_setTargetVelocity(uint8_t motor, int32_t targetVelocity);
 int32_t tmc4671_getTargetVelocity(uint8_t motor);
@@ -80,6 +314,23 @@ void tmc4671_setActualPosition(uint8_t motor, int32_t actualPosition);
 int32_t tmc4671_getActualPosition(uint8_t motor);
 int32_t tmc4671_getActualRampPosition(uint8_t motor);
 
+// Setpoint streaming for fast outer loops, e.g. PID_TORQUE_FLUX_TARGET with BIT_16_TO_31
+// for the torque or PID_VELOCITY_TARGET with TMC4671_STREAM_32BIT. The motion mode is not
+// changed. Starting a stream reads the register once, every setpoint afterwards is one
+// write without readback. With TMC4671_ASYNC, tmc4671_streamSetpoint() never waits for the
+// SPI: A setpoint given during a transfer is sent after it, newer setpoints replace it.
+// Call tmc4671_streamSetpoint() and the SPI completion from the same interrupt priority.
+void tmc4671_startSetpointStream(TMC4671SetpointStreamTypeDef *stream, uint8_t motor, uint8_t address, uint8_t channel);
+void tmc4671_streamSetpoint(TMC4671SetpointStreamTypeDef *stream, int32_t value);
+
+// Setpoint ramp of a motor with a registered instance. While attached, the target setters of the
+// ramp mode (torque, velocity or position) set the ramp target and tmc4671_rampJob() streams the
+// setpoints towards it. The torque stream repeats the flux target of the move start, change the
+// flux only while the ramp is done.
+void tmc4671_setRamp(uint8_t motor, TMC_SetpointRamp *ramp);
+TMC_SetpointRamp *tmc4671_getRamp(uint8_t motor);
+void tmc4671_rampJob(uint8_t motor, uint32_t actualSystick);
+
 // pwm control
 void tmc4671_disablePWM(uint8_t motor);
 
@@ -90,6 +341,25 @@ void tmc4671_setMotorType(uint8_t motor, uint8_t motorType);
 uint8_t tmc4671_getPolePairs(uint8_t motor);
 void tmc4671_setPolePairs(uint8_t motor, uint8_t polePairs);
 
+// Read the values selected by [mask] (TMC4671_TELEMETRY_*) with one register access each.
+// Torque and flux share one register access. Values not selected are left unchanged.
+void tmc4671_readTelemetry(uint8_t motor, TMC4671TelemetryTypeDef *telemetry, uint8_t mask);
+
+// Software capture, see TMC4671CaptureTypeDef.
+// tmc4671_capture_sample() is meant to be called periodically (e.g. from a timer ISR),
+// tmc4671_capture_read() drains the captured values from a lower priority task.
+// Channels with a selector leave their selector register changed.
+void tmc4671_capture_init(TMC4671CaptureTypeDef *capture, uint8_t motor, int32_t *buffer, uint32_t size);
+bool tmc4671_capture_addChannel(TMC4671CaptureTypeDef *capture, uint8_t address, uint8_t selectorAddress, uint8_t selector);
+void tmc4671_capture_setPrescaler(TMC4671CaptureTypeDef *capture, uint16_t prescaler);
+void tmc4671_capture_setTrigger(TMC4671CaptureTypeDef *capture, TMC4671CaptureTrigger trigger, int32_t threshold);
+// Starts sampling. [frames] is the amount of frames stored after the trigger, 0 for continuous capture.
+void tmc4671_capture_arm(TMC4671CaptureTypeDef *capture, uint32_t frames);
+void tmc4671_capture_stop(TMC4671CaptureTypeDef *capture);
+void tmc4671_capture_sample(TMC4671CaptureTypeDef *capture);
+// Copies up to [count] captured values (whole frames only) to [data]. Returns the amount of values copied.
+uint32_t tmc4671_capture_read(TMC4671CaptureTypeDef *capture, int32_t *data, uint32_t count);
+
 uint16_t tmc4671_getAdcI0Offset(uint8_t motor);
 void tmc4671_setAdcI0Offset(uint8_t motor, uint16_t offset);
 
@@ -99,6 +369,14 @@ void tmc4671_setAdcI1Offset(uint8_t motor, uint16_t offset);
 void tmc4671_setTorqueFluxPI(uint8_t motor, uint16_t pParameter, uint16_t iParameter);
 void tmc4671_setVelocityPI(uint8_t motor, uint16_t pParameter, uint16_t iParameter);
 void tmc4671_setPositionPI(uint8_t motor, uint16_t pParameter, uint16_t iParameter);
+void tmc4671_writeControllerGains(uint8_t motor, const TMC4671ControllerGainsTypeDef *gains);
+
+// Biquad filters. The coefficients are calculated with integer math.
+// [qualityFactor] is in 1/256, the cutoff frequency is limited to a quarter of the sample frequency.
+void tmc4671_calculateBiquadLowPass(TMC4671BiquadTypeDef *biquad, uint32_t sampleFrequency, uint32_t cutoffFrequency, uint16_t qualityFactor);
+void tmc4671_calculateBiquadBypass(TMC4671BiquadTypeDef *biquad);
+// Writes all coefficients through CONFIG_ADDR/CONFIG_DATA. The filter is disabled during the update.
+void tmc4671_writeBiquad(uint8_t motor, TMC4671BiquadFilter filter, const TMC4671BiquadTypeDef *biquad);
 
 int32_t tmc4671_readFieldWithDependency(uint8_t motor, uint8_t reg, uint8_t dependsReg, uint32_t dependsValue, uint32_t mask, uint8_t shift);
 
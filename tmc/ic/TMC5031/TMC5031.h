@@ -14,15 +14,15 @@
 #include "TMC5031_Constants.h"
 #include "TMC5031_Fields.h"
 
-#define TMC5031_FIELD_READ(motor, address, mask, shift) \
-	FIELD_READ(tmc5031_readInt, motor, address, mask, shift)
-#define TMC5031_FIELD_WRITE(motor, address, mask, shift, value) \
-	FIELD_WRITE(tmc5031_writeInt, motor, address, mask, shift, value)
-#define TMC5031_FIELD_UPDATE(motor, address, mask, shift, value) \
-	FIELD_UPDATE(tmc5031_readInt, tmc5031_writeInt, motor, address, mask, shift, value)
+#define TMC5031_FIELD_READ(tdef, address, mask, shift) \
+	FIELD_GET(tmc5031_readInt(tdef, address), mask, shift)
+#define TMC5031_FIELD_WRITE(tdef, address, mask, shift, value) \
+	(tmc5031_writeInt(tdef, address, FIELD_SET(tmc5031_readInt(tdef, address), mask, shift, value)))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
+	ConfigurationTypeDef *config;
+
 	int velocity[2], oldX[2];
 	uint32_t oldTick;
 	int32_t registerResetState[TMC5031_REGISTER_COUNT];
@@ -30,9 +30,78 @@ typedef struct {
 	bool vMaxModified[2];
 } TMC5031TypeDef;
 
-void tmc5031_initConfig(TMC5031TypeDef *TMC5031);
-void tmc5031_periodicJob(uint8_t motor, uint32_t tick, TMC5031TypeDef *TMC5031, ConfigurationTypeDef *TMC5031_config);
-uint8_t tmc5031_reset(ConfigurationTypeDef *TMC5031_config);
-uint8_t tmc5031_restore(ConfigurationTypeDef *TMC5031_config);
+// Default Register Values
+#define R30 0x00071703  // IHOLD_IRUN
+#define R32 0x00FFFFFF  // VHIGH
+#define R3A 0x00010000  // ENC_CONST
+#define R60 0xAAAAB554  // MSLUT[0]
+#define R61 0x4A9554AA  // MSLUT[1]
+#define R62 0x24492929  // MSLUT[2]
+#define R63 0x10104222  // MSLUT[3]
+#define R64 0xFBFFFFFF  // MSLUT[4]
+#define R65 0xB5BB777D  // MSLUT[5]
+#define R66 0x49295556  // MSLUT[6]
+#define R67 0x00404222  // MSLUT[7]
+#define R68 0xFFFF8056  // MSLUTSEL
+#define R69 0x00F70000  // MSLUTSTART
+#define R6C 0x000101D5  // CHOPCONF
+
+/* Register access permissions:
+ * 0: none (reserved)
+ * 1: read
+ * 2: write
+ * 3: read/write
+ * 7: read^write (separate functions/values)
+ */
+static const uint8_t tmc5031_defaultRegisterAccess[TMC5031_REGISTER_COUNT] = {
+//	0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F
+	3, 1, 1, 2, 7, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x00 - 0x0F
+	2, 1, 0, 0, 0, 0, 0, 0, 2, 1, 0, 0, 0, 0, 0, 0, // 0x10 - 0x1F
+	3, 3, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 0, 0, // 0x20 - 0x2F
+	2, 2, 2, 2, 3, 1, 1, 0, 3, 3, 2, 1, 1, 0, 0, 0, // 0x30 - 0x3F
+	3, 3, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 0, 0, // 0x40 - 0x4F
+	2, 2, 2, 2, 3, 1, 1, 0, 3, 3, 2, 1, 1, 0, 0, 0, // 0x50 - 0x5F
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 3, 2, 2, 1, // 0x60 - 0x6F
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 3, 2, 2, 1  // 0x70 - 0x7F
+};
+
+static const int32_t tmc5031_defaultRegisterResetState[TMC5031_REGISTER_COUNT] = {
+//	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 0x00 - 0x0F
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 0x10 - 0x1F
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 0x20 - 0x2F
+	R30, 0,   R32, 0,   0,   0,   0,   0,   0,   0,   R3A, 0,   0,   0,   0,   0, // 0x30 - 0x3F
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 0x40 - 0x4F
+	R30, 0,   R32, 0,   0,   0,   0,   0,   0,   0,   R3A, 0,   0,   0,   0,   0, // 0x50 - 0x5F
+	R60, R61, R62, R63, R64, R65, R66, R67, R68, R69, 0,   0,   R6C, 0,   0,   0, // 0x60 - 0x6F
+	R60, R61, R62, R63, R64, R65, R66, R67, R68, R69, 0,   0,   R6C, 0,   0,   0  // 0x70 - 0x7F
+};
+
+// Undefine the default register values.
+// This prevents warnings in case multiple TMC-API chip headers are included at once
+#undef R30
+#undef R32
+#undef R3A
+#undef R60
+#undef R61
+#undef R62
+#undef R63
+#undef R64
+#undef R65
+#undef R66
+#undef R67
+#undef R68
+#undef R69
+#undef R6C
+
+void tmc5031_writeDatagram(TMC5031TypeDef *tmc5031, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
+void tmc5031_writeInt(TMC5031TypeDef *tmc5031, uint8_t address, int32_t value);
+int32_t tmc5031_readInt(TMC5031TypeDef *tmc5031, uint8_t address);
+void tmc5031_readIntBatch(TMC5031TypeDef *tmc5031, const uint8_t *addresses, int32_t *values, size_t count);
+
+void tmc5031_init(TMC5031TypeDef *tmc5031, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
+TMCConfigStatus tmc5031_periodicJob(TMC5031TypeDef *tmc5031, uint32_t tick);
+uint8_t tmc5031_reset(TMC5031TypeDef *tmc5031);
+uint8_t tmc5031_restore(TMC5031TypeDef *tmc5031);
 
 #endif /* TMC_IC_TMC5031_H_ */
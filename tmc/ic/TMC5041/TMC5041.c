@@ -7,9 +7,12 @@
  */
 
 #include "TMC5041.h"
+#include "tmc/helpers/Functions.h"
 
 // => SPI wrapper
 extern void tmc5041_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc5041_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC5041", tmc5041_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
 void tmc5041_writeDatagram(TMC5041TypeDef *tmc5041, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
@@ -46,7 +49,79 @@ int32_t tmc5041_readInt(TMC5041TypeDef *tmc5041, uint8_t address)
 	data[0] = address;
 	tmc5041_readWriteArray(tmc5041->config->channel, &data[0], 5);
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+	return tmc_unpackInt32(&data[1]);
+}
+
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc5041_readIntBatch(TMC5041TypeDef *tmc5041, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[5];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc5041->registerAccess[address]))
+		{
+			values[i] = tmc5041->config->shadowRegister[address];
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5041_readWriteArray(tmc5041->config->channel, &data[0], 5);
+
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5041_readWriteArray(tmc5041->config->channel, &data[0], 5);
+		values[pending] = tmc_unpackInt32(&data[1]);
+	}
+}
+
+// Read XACTUAL, VACTUAL, RAMPSTAT and DRVSTATUS of both motors with one
+// pipelined batch (9 transfers instead of 16). status[] holds TMC5041_MOTORS entries.
+// Note: Reading RAMPSTAT clears its event flags.
+void tmc5041_readStatusBoth(TMC5041TypeDef *tmc5041, TMC5041MotorStatusTypeDef *status)
+{
+	uint8_t addresses[4 * TMC5041_MOTORS];
+	int32_t values[4 * TMC5041_MOTORS];
+	uint8_t motor;
+
+	for(motor = 0; motor < TMC5041_MOTORS; motor++)
+	{
+		addresses[4 * motor + 0] = TMC5041_XACTUAL(motor);
+		addresses[4 * motor + 1] = TMC5041_VACTUAL(motor);
+		addresses[4 * motor + 2] = TMC5041_RAMPSTAT(motor);
+		addresses[4 * motor + 3] = TMC5041_DRVSTATUS(motor);
+	}
+
+	tmc5041_readIntBatch(tmc5041, addresses, values, ARRAY_SIZE(addresses));
+
+	for(motor = 0; motor < TMC5041_MOTORS; motor++)
+	{
+		status[motor].xActual    = values[4 * motor + 0];
+		status[motor].vActual    = CAST_Sn_TO_S32(values[4 * motor + 1], 24);
+		status[motor].rampStat   = values[4 * motor + 2];
+		status[motor].drvStatus  = values[4 * motor + 3];
+	}
 }
 
 void tmc5041_init(TMC5041TypeDef *tmc5041, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
@@ -77,13 +152,16 @@ static void tmc5041_writeConfiguration(TMC5041TypeDef *tmc5041)
 {
 	uint8_t *ptr = &tmc5041->config->configIndex;
 	const int32_t *settings = (tmc5041->config->state == CONFIG_RESTORE) ? tmc5041->config->shadowRegister : tmc5041->registerResetState;
+	const uint8_t *registers;
+	size_t registerCount;
 
-	while((*ptr < TMC5041_REGISTER_COUNT) && !TMC_IS_WRITABLE(tmc5041->registerAccess[*ptr]))
-		(*ptr)++;
+	// Every writable register is reset/restored
+	registers      = tmc5041_restorableRegisters;
+	registerCount  = ARRAY_SIZE(tmc5041_restorableRegisters);
 
-	if(*ptr < TMC5041_REGISTER_COUNT)
+	if(*ptr < registerCount)
 	{
-		tmc5041_writeInt(tmc5041, *ptr, settings[*ptr]);
+		tmc5041_writeInt(tmc5041, registers[*ptr], settings[registers[*ptr]]);
 		(*ptr)++;
 	}
 	else
@@ -92,29 +170,58 @@ static void tmc5041_writeConfiguration(TMC5041TypeDef *tmc5041)
 	}
 }
 
-void tmc5041_periodicJob(TMC5041TypeDef *tmc5041, uint32_t tick)
+TMCConfigStatus tmc5041_periodicJob(TMC5041TypeDef *tmc5041, uint32_t tick)
 {
-	int xActual;
+	uint8_t addresses[TMC5041_MOTORS];
+	int32_t xActual[TMC5041_MOTORS];
 	uint32_t tickDiff;
 
 	if(tmc5041->config->state != CONFIG_READY)
 	{
 		tmc5041_writeConfiguration(tmc5041);
-		return;
+		return TMC_CONFIG_STATUS(tmc5041->config);
 	}
 
 	if((tickDiff = tick - tmc5041->oldTick) >= 5)
 	{
 		int i;
+
+		// Sample both positions in one burst
+		for (i = 0; i < TMC5041_MOTORS; i++)
+			addresses[i] = TMC5041_XACTUAL(i);
+
+		tmc5041_readIntBatch(tmc5041, addresses, xActual, TMC5041_MOTORS);
+
 		for (i = 0; i < TMC5041_MOTORS; i++)
 		{
-			xActual = tmc5041_readInt(tmc5041, TMC5041_XACTUAL(i));
-			tmc5041->config->shadowRegister[TMC5041_XACTUAL(i)] = xActual;
-			tmc5041->velocity[i] = (int) ((float) (abs(xActual-tmc5041->oldX[i]) / (float) tickDiff) * (float) 1048.576);
-			tmc5041->oldX[i] = xActual;
+			tmc5041->config->shadowRegister[TMC5041_XACTUAL(i)] = xActual[i];
+			tmc5041->velocity[i] = tmc_estimateVelocity(abs(xActual[i]-tmc5041->oldX[i]), tickDiff);
+			tmc5041->oldX[i] = xActual[i];
 		}
 		tmc5041->oldTick = tick;
 	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc5041_configureBurst(TMC5041TypeDef *tmc5041, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc5041->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		tmc5041_writeConfiguration(tmc5041);
+	}
+
+	return (tmc5041->config->state == CONFIG_READY);
 }
 
 uint8_t tmc5041_reset(TMC5041TypeDef *tmc5041)
@@ -17,6 +17,9 @@
 	FIELD_GET(tmc5041_readInt(tdef, address), mask, shift)
 #define TMC5041_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc5041_writeInt(tdef, address, FIELD_SET(tmc5041_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5041_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc5041_writeInt(tdef, address, FIELDS_SET(tmc5041_readInt(tdef, address), mask, values)))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
@@ -30,6 +33,14 @@ typedef struct {
 	bool vMaxModified[2];
 } TMC5041TypeDef;
 
+// Status snapshot of one motor, see tmc5041_readStatusBoth()
+typedef struct {
+	int32_t xActual;
+	int32_t vActual;
+	uint32_t rampStat;
+	uint32_t drvStatus;
+} TMC5041MotorStatusTypeDef;
+
 #define R30 0x00071703  // IHOLD_IRUN (Motor 1)
 #define R32 0x00FFFFFF  // VHIGH      (Motor 1)
 #define R50 0x00071703  // IHOLD_IRUN (Motor 2)
@@ -68,6 +79,28 @@ static const uint8_t tmc5041_defaultRegisterAccess[TMC5041_REGISTER_COUNT] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 3, 2, 0, 1  // 70 - 7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc5041_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc5041_resettableRegisters[] =
+{
+	0x00, 0x03, 0x05, 0x10, 0x18, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B, 0x2C,
+	0x2D, 0x30, 0x31, 0x32, 0x34, 0x40, 0x41, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x4A, 0x4B, 0x4C,
+	0x4D, 0x50, 0x51, 0x52, 0x54, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C,
+	0x6D, 0x7C, 0x7D
+};
+
+static const uint8_t tmc5041_restorableRegisters[] =
+{
+	0x00, 0x03, 0x05, 0x10, 0x18, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B, 0x2C,
+	0x2D, 0x30, 0x31, 0x32, 0x34, 0x40, 0x41, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x4A, 0x4B, 0x4C,
+	0x4D, 0x50, 0x51, 0x52, 0x54, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C,
+	0x6D, 0x7C, 0x7D
+};
+
 static const int32_t tmc5041_defaultRegisterResetState[TMC5041_REGISTER_COUNT] = {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
 	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 00 - 0F
@@ -102,9 +135,12 @@ static const int32_t tmc5041_defaultRegisterResetState[TMC5041_REGISTER_COUNT] =
 void tmc5041_writeDatagram(TMC5041TypeDef *tmc5041, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5041_writeInt(TMC5041TypeDef *tmc5041, uint8_t address, int32_t value);
 int32_t tmc5041_readInt(TMC5041TypeDef *tmc5041, uint8_t address);
+void tmc5041_readIntBatch(TMC5041TypeDef *tmc5041, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc5041_readStatusBoth(TMC5041TypeDef *tmc5041, TMC5041MotorStatusTypeDef *status);
 
 void tmc5041_init(TMC5041TypeDef *tmc5041, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
-void tmc5041_periodicJob(TMC5041TypeDef *tmc5041, uint32_t tick);
+TMCConfigStatus tmc5041_periodicJob(TMC5041TypeDef *tmc5041, uint32_t tick);
+uint8_t tmc5041_configureBurst(TMC5041TypeDef *tmc5041, uint32_t maxSteps);
 uint8_t tmc5041_reset(TMC5041TypeDef *tmc5041);
 uint8_t tmc5041_restore(TMC5041TypeDef *tmc5041);
 
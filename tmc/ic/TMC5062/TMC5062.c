@@ -7,9 +7,14 @@
  */
 
 #include "TMC5062.h"
+#include "tmc/helpers/Functions.h"
 
 // => SPI wrapper
-extern uint8_t tmc5062_readWrite(uint8_t motor, uint8_t data, uint8_t lastTransfer);
+// Sends [length] bytes in one chip select frame, replacing data with the reply.
+// The wrapper may use DMA: every datagram is passed as one contiguous buffer.
+extern void tmc5062_readWriteArray(uint8_t motor, uint8_t *data, size_t length);
+#define tmc5062_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC5062", tmc5062_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
 static void measureVelocity(TMC5062TypeDef *tmc5062, uint32_t tick);
@@ -20,11 +25,9 @@ void tmc5062_writeInt(TMC5062TypeDef *tmc5062, uint8_t channel, uint8_t address,
 	if(channel >= TMC5062_MOTORS)
 		return;
 
-	tmc5062_readWrite(tmc5062->motors[channel], address | TMC5062_WRITE_BIT, false);
-	tmc5062_readWrite(tmc5062->motors[channel], value >> 24, false);
-	tmc5062_readWrite(tmc5062->motors[channel], value >> 16, false);
-	tmc5062_readWrite(tmc5062->motors[channel], value >>  8, false);
-	tmc5062_readWrite(tmc5062->motors[channel], value,       true);
+	uint8_t data[5] = { address | TMC5062_WRITE_BIT, BYTE(value, 3), BYTE(value, 2), BYTE(value, 1), BYTE(value, 0) };
+
+	tmc5062_readWriteArray(tmc5062->motors[channel], &data[0], 5);
 
 	tmc5062->config->shadowRegister[TMC_ADDRESS(address)] = value;
 }
@@ -34,35 +37,136 @@ int tmc5062_readInt(TMC5062TypeDef *tmc5062, uint8_t channel, uint8_t address)
 	if(channel >= TMC5062_MOTORS)
 		return 0;
 
-	if(!TMC_IS_READABLE(tmc5062->registerAccess[TMC_ADDRESS(address)]))
-		return tmc5062->config->shadowRegister[TMC_ADDRESS(address)];
+	address = TMC_ADDRESS(address);
+
+	if(!TMC_IS_READABLE(tmc5062->registerAccess[address]))
+		return tmc5062->config->shadowRegister[address];
+
+	uint8_t data[5] = { 0, 0, 0, 0, 0 };
+
+	data[0] = address;
+	tmc5062_readWriteArray(tmc5062->motors[channel], &data[0], 5);
+
+	data[0] = address;
+	tmc5062_readWriteArray(tmc5062->motors[channel], &data[0], 5);
+
+	return tmc_unpackInt32(&data[1]);
+}
+
+// Read multiple registers of one channel with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc5062_readIntBatch(TMC5062TypeDef *tmc5062, uint8_t channel, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[5];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	if(channel >= TMC5062_MOTORS)
+		return;
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc5062->registerAccess[address]))
+		{
+			values[i] = tmc5062->config->shadowRegister[address];
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5062_readWriteArray(tmc5062->motors[channel], &data[0], 5);
+
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5062_readWriteArray(tmc5062->motors[channel], &data[0], 5);
+		values[pending] = tmc_unpackInt32(&data[1]);
+	}
+}
 
-	tmc5062_readWrite(tmc5062->motors[channel], address, false);
-	tmc5062_readWrite(tmc5062->motors[channel], 0, false);
-	tmc5062_readWrite(tmc5062->motors[channel], 0, false);
-	tmc5062_readWrite(tmc5062->motors[channel], 0, false);
-	tmc5062_readWrite(tmc5062->motors[channel], 0, true);
+// Read [perMotor] registers of each motor, addresses and values are grouped by motor.
+// With both motors on the same chip select this is a single pipelined burst.
+static void readBoth(TMC5062TypeDef *tmc5062, const uint8_t *addresses, int32_t *values, size_t perMotor)
+{
+	if(tmc5062->motors[0] == tmc5062->motors[1])
+	{
+		tmc5062_readIntBatch(tmc5062, 0, addresses, values, TMC5062_MOTORS * perMotor);
+		return;
+	}
 
-	int value = 0;
+	for(uint8_t channel = 0; channel < TMC5062_MOTORS; channel++)
+		tmc5062_readIntBatch(tmc5062, channel, &addresses[channel * perMotor], &values[channel * perMotor], perMotor);
+}
+
+// Read XACTUAL, VACTUAL, RAMPSTAT and DRVSTATUS of both motors in one burst.
+// status[] holds TMC5062_MOTORS entries.
+// Note: Reading RAMPSTAT clears its event flags.
+void tmc5062_readStatusBoth(TMC5062TypeDef *tmc5062, TMC5062MotorStatusTypeDef *status)
+{
+	uint8_t addresses[4 * TMC5062_MOTORS];
+	int32_t values[4 * TMC5062_MOTORS];
+	uint8_t motor;
 
-	tmc5062_readWrite(tmc5062->motors[channel], address, false);
-	value |= tmc5062_readWrite(tmc5062->motors[channel], 0, false);
-	value <<= 8;
-	value |= tmc5062_readWrite(tmc5062->motors[channel], 0, false);
-	value <<= 8;
-	value |= tmc5062_readWrite(tmc5062->motors[channel], 0, false);
-	value <<= 8;
-	value |= tmc5062_readWrite(tmc5062->motors[channel], 0, true);
+	for(motor = 0; motor < TMC5062_MOTORS; motor++)
+	{
+		addresses[4 * motor + 0] = TMC5062_XACTUAL(motor);
+		addresses[4 * motor + 1] = TMC5062_VACTUAL(motor);
+		addresses[4 * motor + 2] = TMC5062_RAMPSTAT(motor);
+		addresses[4 * motor + 3] = TMC5062_DRVSTATUS(motor);
+	}
 
-	return value;
+	readBoth(tmc5062, addresses, values, 4);
+
+	for(motor = 0; motor < TMC5062_MOTORS; motor++)
+	{
+		status[motor].xActual    = values[4 * motor + 0];
+		status[motor].vActual    = CAST_Sn_TO_S32(values[4 * motor + 1], 24);
+		status[motor].rampStat   = values[4 * motor + 2];
+		status[motor].drvStatus  = values[4 * motor + 3];
+	}
+}
+
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc5062_writeInt(ic, 0, address, value);
 }
 
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC5062_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc5062_defaultRegisterAccess,
+	.resettableRegisters    = tmc5062_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc5062_resettableRegisters),
+	.restorableRegisters    = tmc5062_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc5062_restorableRegisters),
+	.constants              = tmc5062_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc5062_RegisterConstants),
+	.writeInt               = writeRegister,
+};
+
 void tmc5062_init(TMC5062TypeDef *tmc5062, ConfigurationTypeDef *tmc5062_config, const int32_t *registerResetState, uint8_t motorIndex0, uint8_t motorIndex1, uint32_t chipFrequency)
 {
 	tmc5062->motors[0] = motorIndex0;
 	tmc5062->motors[1] = motorIndex1;
 
-	tmc5062->chipFrequency  = chipFrequency;
+	tmc5062_setChipFrequency(tmc5062, chipFrequency);
 	tmc5062->config = tmc5062_config;
 
 	tmc5062->measurementInterval = 25; // Default: 25 ms
@@ -72,52 +176,17 @@ void tmc5062_init(TMC5062TypeDef *tmc5062, ConfigurationTypeDef *tmc5062_config,
 	tmc5062->velocity[0]    = 0;
 	tmc5062->velocity[1]    = 0;
 
-	tmc5062->config->callback     = NULL;
-	tmc5062->config->channel      = 0;
-	tmc5062->config->configIndex  = 0;
-	tmc5062->config->state        = CONFIG_READY;
-
-	for(int i = 0; i < TMC5062_REGISTER_COUNT; i++)
-	{
-		tmc5062->registerAccess[i] = tmc5062_defaultRegisterAccess[i];
-		tmc5062->registerResetState[i]  = registerResetState[i];
-	}
+	tmc_driver_init(&driver, tmc5062->config, 0, tmc5062->registerAccess, tmc5062->registerResetState, registerResetState);
 }
 
 void tmc5062_fillShadowRegisters(TMC5062TypeDef *tmc5062)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc5062_RegisterConstants) == 0)
-		return;
-
-	size_t i, j;
-	for(i = 0, j = 0; i < TMC5062_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc5062->registerAccess[i] != TMC_ACCESS_W_PRESET)
-			continue;
-
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc5062_RegisterConstants) && (tmc5062_RegisterConstants[j].address < i))
-			j++;
-
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc5062_RegisterConstants))
-			break;
-
-		// If we have an entry for our current address, write the constant
-		if(tmc5062_RegisterConstants[j].address == i)
-			tmc5062->config->shadowRegister[i] = tmc5062_RegisterConstants[j].value;
-	}
+	tmc_driver_fillShadowRegisters(&driver, tmc5062->config, tmc5062->registerAccess);
 }
 
 void tmc5062_setRegisterResetState(TMC5062TypeDef *tmc5062, const int32_t *resetState)
 {
-	for(size_t i = 0; i < TMC5062_REGISTER_COUNT; i++)
-		tmc5062->registerResetState[i] = resetState[i];
+	tmc_driver_setRegisterResetState(&driver, tmc5062->registerResetState, resetState);
 }
 
 void tmc5062_setCallback(TMC5062TypeDef *tmc5062, tmc5062_callback callback)
@@ -127,47 +196,24 @@ void tmc5062_setCallback(TMC5062TypeDef *tmc5062, tmc5062_callback callback)
 
 static void writeConfiguration(TMC5062TypeDef *tmc5062)
 {
-	uint8_t *ptr = &tmc5062->config->configIndex;
-	const int32_t *settings;
-
-	if(tmc5062->config->state == CONFIG_RESTORE)
-	{
-		settings = tmc5062->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC5062_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc5062->registerAccess[*ptr]))
-			(*ptr)++;
-	}
-	else
-	{
-		settings = tmc5062->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC5062_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc5062->registerAccess[*ptr]))
-			(*ptr)++;
-
-	}
+	if(!tmc_driver_writeConfiguration(&driver, tmc5062, tmc5062->config, tmc5062->registerAccess, tmc5062->registerResetState))
+		return;
 
-	if(*ptr < TMC5062_REGISTER_COUNT)
+	// Finished configuration
+	if(tmc5062->config->callback)
 	{
-		tmc5062_writeInt(tmc5062, 0, *ptr, settings[*ptr]);
-		(*ptr)++;
+		((tmc5062_callback)tmc5062->config->callback)(tmc5062, tmc5062->config->state);
 	}
-	else // Finished configuration
-	{
-		if(tmc5062->config->callback)
-		{
-			((tmc5062_callback)tmc5062->config->callback)(tmc5062, tmc5062->config->state);
-		}
 
-		tmc5062->config->state = CONFIG_READY;
-	}
+	tmc5062->config->state = CONFIG_READY;
 }
 
-void tmc5062_periodicJob(TMC5062TypeDef *tmc5062, uint32_t tick)
+TMCConfigStatus tmc5062_periodicJob(TMC5062TypeDef *tmc5062, uint32_t tick)
 {
 	if(tmc5062->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc5062);
-		return;
+		return TMC_CONFIG_STATUS(tmc5062->config);
 	}
 
 	for(uint8_t channel = 0; channel < TMC5062_MOTORS; channel++)
@@ -179,35 +225,38 @@ void tmc5062_periodicJob(TMC5062TypeDef *tmc5062, uint32_t tick)
 			break;
 		}
 	}
+
+	return TMC_CONFIG_STATUS_READY;
 }
 
-uint8_t tmc5062_reset(TMC5062TypeDef *tmc5062)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc5062_configureBurst(TMC5062TypeDef *tmc5062, uint32_t maxSteps)
 {
-	if(tmc5062->config->state != CONFIG_READY)
-		return false;
+	uint32_t step;
 
-	// Reset the dirty bits and wipe the shadow registers
-	for(size_t i = 0; i < TMC5062_REGISTER_COUNT; i++)
+	for(step = 0; tmc5062->config->state != CONFIG_READY; step++)
 	{
-		tmc5062->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc5062->config->shadowRegister[i] = 0;
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc5062);
 	}
 
-	tmc5062->config->state        = CONFIG_RESET;
-	tmc5062->config->configIndex  = 0;
+	return (tmc5062->config->state == CONFIG_READY);
+}
 
-	return true;
+uint8_t tmc5062_reset(TMC5062TypeDef *tmc5062)
+{
+	return tmc_driver_reset(&driver, tmc5062->config, tmc5062->registerAccess);
 }
 
 uint8_t tmc5062_restore(TMC5062TypeDef *tmc5062)
 {
-	if(tmc5062->config->state != CONFIG_READY)
-		return 0;
-
-	tmc5062->config->state        = CONFIG_RESTORE;
-	tmc5062->config->configIndex  = 0;
-
-	return 1;
+	return tmc_driver_restore(tmc5062->config);
 }
 
 void tmc5062_rotate(TMC5062TypeDef *tmc5062, uint8_t motor, int32_t velocity)
@@ -252,6 +301,22 @@ void tmc5062_moveBy(TMC5062TypeDef *tmc5062, uint8_t motor, uint32_t velocityMax
 	return tmc5062_moveTo(tmc5062, motor, *ticks, velocityMax);
 }
 
+// Move both motors. positions[] and velocityMax[] hold TMC5062_MOTORS entries.
+// The XTARGET writes are sent last and back to back to start both moves together.
+void tmc5062_moveToBoth(TMC5062TypeDef *tmc5062, const int32_t *positions, const uint32_t *velocityMax)
+{
+	uint8_t motor;
+
+	for(motor = 0; motor < TMC5062_MOTORS; motor++)
+	{
+		tmc5062_writeInt(tmc5062, motor, TMC5062_RAMPMODE(motor), TMC5062_MODE_POSITION);
+		tmc5062_writeInt(tmc5062, motor, TMC5062_VMAX(motor), velocityMax[motor]);
+	}
+
+	for(motor = 0; motor < TMC5062_MOTORS; motor++)
+		tmc5062_writeInt(tmc5062, motor, TMC5062_XTARGET(motor), positions[motor]);
+}
+
 // Chopper settings
 uint8_t calculateTOFF(uint32_t chopFreq, uint32_t clkFreq)
 {
@@ -287,22 +352,32 @@ uint8_t dcStepActive(TMC5062TypeDef *tmc5062, uint8_t channel)
 	return vActual >= vDCMin;
 }
 
+// The velocity scale only depends on the clock, calculate it once instead of every measurement
+void tmc5062_setChipFrequency(TMC5062TypeDef *tmc5062, uint32_t chipFrequency)
+{
+	tmc5062->chipFrequency  = chipFrequency;
+	tmc5062->velocityScale  = tmc_velocityScale(chipFrequency);
+}
+
 static void measureVelocity(TMC5062TypeDef *tmc5062, uint32_t tick)
 {
-	int xActual;
+	uint8_t addresses[TMC5062_MOTORS];
+	int32_t xActual[TMC5062_MOTORS];
 	uint32_t tickDiff;
 
 	if((tickDiff = tick - tmc5062->oldTick) >= tmc5062->measurementInterval)
 	{
+		// Sample both positions in one burst
 		for(uint8_t channel = 0; channel < TMC5062_MOTORS; channel++)
-		{
-			xActual = tmc5062_readInt(tmc5062, channel, TMC5062_XACTUAL(channel));
+			addresses[channel] = TMC5062_XACTUAL(channel);
 
-			// Position difference gets multiplied by 1000 to compensate ticks being in milliseconds
-			int32_t xDiff = (xActual - tmc5062->oldXActual[channel])* 1000;
-			tmc5062->velocity[channel] = (xDiff) / ((float) tickDiff) * ((1<<24) / (float) tmc5062->chipFrequency);
+		readBoth(tmc5062, addresses, xActual, 1);
+
+		for(uint8_t channel = 0; channel < TMC5062_MOTORS; channel++)
+		{
+			tmc5062->velocity[channel] = tmc_estimateVelocityScaled(xActual[channel] - tmc5062->oldXActual[channel], tickDiff, tmc5062->velocityScale);
 
-			tmc5062->oldXActual[channel] = xActual;
+			tmc5062->oldXActual[channel] = xActual[channel];
 		}
 		tmc5062->oldTick = tick;
 	}
@@ -27,6 +27,7 @@ typedef struct {
 
 	// External frequency supplied to the IC (or 16MHz for internal frequency)
 	uint32_t chipFrequency;
+	uint32_t velocityScale; // Q16 factor for tmc_estimateVelocityScaled(), see tmc5062_setChipFrequency()
 
 	// Velocity estimation (for dcStep)
 	uint32_t measurementInterval;
@@ -38,6 +39,14 @@ typedef struct {
 	uint8_t registerAccess[TMC5062_REGISTER_COUNT];
 } TMC5062TypeDef;
 
+// Status snapshot of one motor, see tmc5062_readStatusBoth()
+typedef struct {
+	int32_t xActual;
+	int32_t vActual;
+	uint32_t rampStat;
+	uint32_t drvStatus;
+} TMC5062MotorStatusTypeDef;
+
 typedef void (*tmc5062_callback)(TMC5062TypeDef*, ConfigState);
 
 // Default Register Values
@@ -85,6 +94,29 @@ static const uint8_t tmc5062_defaultRegisterAccess[TMC5062_REGISTER_COUNT] = {
 	0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x01, 0x01, 0x03, 0x02, 0x02, 0x01  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc5062_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc5062_resettableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x05, 0x10, 0x18, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A,
+	0x2B, 0x2C, 0x2D, 0x30, 0x31, 0x32, 0x33, 0x34, 0x38, 0x39, 0x3A, 0x40, 0x41, 0x43, 0x44, 0x45,
+	0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x50, 0x51, 0x52, 0x53, 0x54, 0x58, 0x59, 0x5A,
+	0x6C, 0x6D, 0x6E, 0x7C, 0x7D, 0x7E
+};
+
+static const uint8_t tmc5062_restorableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x05, 0x10, 0x18, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A,
+	0x2B, 0x2C, 0x2D, 0x30, 0x31, 0x32, 0x33, 0x34, 0x38, 0x39, 0x3A, 0x40, 0x41, 0x43, 0x44, 0x45,
+	0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x50, 0x51, 0x52, 0x53, 0x54, 0x58, 0x59, 0x5A,
+	0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x6E, 0x70, 0x71, 0x72,
+	0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7C, 0x7D, 0x7E
+};
+
 static const TMCRegisterConstant tmc5062_RegisterConstants[] =
 {		// Use ascending addresses!
 		{ 0x60, 0xAAAAB554 }, // MSLUT[0]_M1
@@ -111,12 +143,16 @@ static const TMCRegisterConstant tmc5062_RegisterConstants[] =
 
 void tmc5062_writeInt(TMC5062TypeDef *tmc5062, uint8_t channel, uint8_t address, int value);
 int tmc5062_readInt(TMC5062TypeDef *tmc5062, uint8_t channel, uint8_t address);
+void tmc5062_readIntBatch(TMC5062TypeDef *tmc5062, uint8_t channel, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc5062_readStatusBoth(TMC5062TypeDef *tmc5062, TMC5062MotorStatusTypeDef *status);
 
 void tmc5062_init(TMC5062TypeDef *tmc5062, ConfigurationTypeDef *tmc5062_config, const int32_t *registerResetState, uint8_t motorIndex0, uint8_t motorIndex1, uint32_t chipFrequency);
 void tmc5062_fillShadowRegisters(TMC5062TypeDef *tmc5062);
 void tmc5062_setRegisterResetState(TMC5062TypeDef *tmc5062, const int32_t *resetState);
 void tmc5062_setCallback(TMC5062TypeDef *tmc5062, tmc5062_callback callback);
-void tmc5062_periodicJob(TMC5062TypeDef *tmc5072, uint32_t tick);
+void tmc5062_setChipFrequency(TMC5062TypeDef *tmc5062, uint32_t chipFrequency);
+TMCConfigStatus tmc5062_periodicJob(TMC5062TypeDef *tmc5072, uint32_t tick);
+uint8_t tmc5062_configureBurst(TMC5062TypeDef *tmc5062, uint32_t maxSteps);
 uint8_t tmc5062_reset(TMC5062TypeDef *tmc5062);
 uint8_t tmc5062_restore(TMC5062TypeDef *tmc5062);
 
@@ -126,6 +162,7 @@ void tmc5062_left(TMC5062TypeDef *tmc5062, uint8_t motor, int32_t velocity);
 void tmc5062_stop(TMC5062TypeDef *tmc5062, uint8_t motor);
 void tmc5062_moveTo(TMC5062TypeDef *tmc5062, uint8_t motor, int32_t position, uint32_t velocityMax);
 void tmc5062_moveBy(TMC5062TypeDef *tmc5062, uint8_t motor, uint32_t velocityMax, int32_t *ticks);
+void tmc5062_moveToBoth(TMC5062TypeDef *tmc5062, const int32_t *positions, const uint32_t *velocityMax);
 
 // Chopper settings
 uint8_t calculateTOFF(uint32_t chopFreq, uint32_t clkFreq);
@@ -7,9 +7,12 @@
  */
 
 #include "TMC5072.h"
+#include "tmc/helpers/Functions.h"
 
 // => SPI wrapper
 extern void tmc5072_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc5072_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC5072", tmc5072_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
 void tmc5072_writeDatagram(TMC5072TypeDef *tmc5072, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
@@ -46,7 +49,82 @@ int32_t tmc5072_readInt(TMC5072TypeDef *tmc5072, uint8_t address)
 	data[0] = address;
 	tmc5072_readWriteArray(tmc5072->config->channel, &data[0], 5);
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+	return tmc_unpackInt32(&data[1]);
+}
+
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc5072_readIntBatch(TMC5072TypeDef *tmc5072, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[5];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc5072->registerAccess[address]))
+		{
+			values[i] = tmc5072->config->shadowRegister[address];
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5072_readWriteArray(tmc5072->config->channel, &data[0], 5);
+
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5072_readWriteArray(tmc5072->config->channel, &data[0], 5);
+		values[pending] = tmc_unpackInt32(&data[1]);
+	}
+}
+
+// Read XACTUAL, VACTUAL, RAMPSTAT and DRVSTATUS of both motors with one
+// pipelined batch (9 transfers instead of 16). status[] holds TMC5072_MOTORS entries.
+// Note: Reading RAMPSTAT clears its event flags.
+void tmc5072_readStatusBoth(TMC5072TypeDef *tmc5072, TMC5072MotorStatusTypeDef *status)
+{
+	uint8_t addresses[4 * TMC5072_MOTORS];
+	int32_t values[4 * TMC5072_MOTORS];
+	uint8_t motor;
+
+	for(motor = 0; motor < TMC5072_MOTORS; motor++)
+	{
+		addresses[4 * motor + 0] = TMC5072_XACTUAL(motor);
+		addresses[4 * motor + 1] = TMC5072_VACTUAL(motor);
+		addresses[4 * motor + 2] = TMC5072_RAMPSTAT(motor);
+		addresses[4 * motor + 3] = TMC5072_DRVSTATUS(motor);
+	}
+
+	tmc5072_readIntBatch(tmc5072, addresses, values, ARRAY_SIZE(addresses));
+
+	for(motor = 0; motor < TMC5072_MOTORS; motor++)
+	{
+		status[motor].xActual    = values[4 * motor + 0];
+		status[motor].vActual    = CAST_Sn_TO_S32(values[4 * motor + 1], 24);
+		status[motor].rampStat   = values[4 * motor + 2];
+		status[motor].drvStatus  = values[4 * motor + 3];
+
+		if(tmc5072->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL)
+			tmc5072->velocity[motor] = abs(status[motor].vActual);
+	}
 }
 
 //void tmc5072_writeDatagram(TMC5072TypeDef *tmc5072, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
@@ -109,7 +187,8 @@ void tmc5072_init(TMC5072TypeDef *tmc5072, uint8_t channel, ConfigurationTypeDef
 		tmc5072->oldX[motor] = 0;
 	}
 
-	tmc5072->oldTick     = 0;
+	tmc5072->oldTick         = 0;
+	tmc5072->velocitySource  = TMC_VELOCITY_SOURCE_ESTIMATE;
 	tmc5072->config   = tmc5072_config;
 
 	/*
@@ -126,8 +205,14 @@ void tmc5072_init(TMC5072TypeDef *tmc5072, uint8_t channel, ConfigurationTypeDef
 	for(i = 0; i < TMC5072_REGISTER_COUNT; i++)
 	{
 		tmc5072->registerAccess[i]      = tmc5072_defaultRegisterAccess[i];
+#ifndef TMC_RESET_STATE_CONST
 		tmc5072->registerResetState[i]  = registerResetState[i];
+#endif
 	}
+
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_init(&tmc5072->registerResetState, registerResetState);
+#endif
 }
 
 //void tmc5072_initConfig(TMC5072TypeDef *tmc5072)
@@ -150,58 +235,45 @@ void tmc5072_init(TMC5072TypeDef *tmc5072, uint8_t channel, ConfigurationTypeDef
 
 void tmc5072_fillShadowRegisters(TMC5072TypeDef *tmc5072)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc5072_RegisterConstants) == 0)
-		return;
-
-	size_t i, j;
-	for(i = 0, j = 0; i < TMC5072_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc5072->registerAccess[i] != TMC_ACCESS_W_PRESET)
-			continue;
-
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc5072_RegisterConstants) && (tmc5072_RegisterConstants[j].address < i))
-			j++;
-
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc5072_RegisterConstants))
-			break;
+	tmc_fillShadowRegisters(tmc5072->config, tmc5072->registerAccess, NULL, tmc5072_RegisterConstants, ARRAY_SIZE(tmc5072_RegisterConstants));
+}
 
-		// If we have an entry for our current address, write the constant
-		if(tmc5072_RegisterConstants[j].address == i)
-			tmc5072->config->shadowRegister[i] = tmc5072_RegisterConstants[j].value;
-	}
+// Reset value of the given register
+static int32_t resetValue(TMC5072TypeDef *tmc5072, uint8_t address)
+{
+#ifdef TMC_RESET_STATE_CONST
+	return tmc_resetState_get(&tmc5072->registerResetState, address);
+#else
+	return tmc5072->registerResetState[address];
+#endif
 }
 
 static void writeConfiguration(TMC5072TypeDef *tmc5072)
 {
 	uint8_t *ptr = &tmc5072->config->configIndex;
 	const int32_t *settings;
+	const uint8_t *registers;
+	size_t registerCount;
 
 	if(tmc5072->config->state == CONFIG_RESTORE)
 	{
 		settings = tmc5072->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC5072_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc5072->registerAccess[*ptr]))
+		registers      = tmc5072_restorableRegisters;
+		registerCount  = ARRAY_SIZE(tmc5072_restorableRegisters);
+		// Skip hardware preset registers that have not been written yet
+		while((*ptr < registerCount) && !TMC_IS_RESTORABLE(tmc5072->registerAccess[registers[*ptr]]))
 			(*ptr)++;
 	}
 	else
 	{
-		settings = tmc5072->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC5072_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc5072->registerAccess[*ptr]))
-			(*ptr)++;
-
+		settings = NULL; // Use the reset values
+		registers      = tmc5072_resettableRegisters;
+		registerCount  = ARRAY_SIZE(tmc5072_resettableRegisters);
 	}
 
-	if(*ptr < TMC5072_REGISTER_COUNT)
+	if(*ptr < registerCount)
 	{
-		tmc5072_writeInt(tmc5072, *ptr, settings[*ptr]);
+		tmc5072_writeInt(tmc5072, registers[*ptr], (settings) ? settings[registers[*ptr]] : resetValue(tmc5072, registers[*ptr]));
 		(*ptr)++;
 	}
 	else // Finished configuration
@@ -235,31 +307,105 @@ static void writeConfiguration(TMC5072TypeDef *tmc5072)
 //	}
 //}
 
-void tmc5072_periodicJob(TMC5072TypeDef *tmc5072, uint32_t tick)
+// Select the value of tmc5072->velocity[], updated every 5 ticks by the periodic job:
+// TMC_VELOCITY_SOURCE_ESTIMATE differentiates XACTUAL (default), TMC_VELOCITY_SOURCE_VACTUAL
+// reads the exact velocity of the ramp generators, also updated by tmc5072_readStatusBoth().
+// TMC_VELOCITY_SOURCE_NONE leaves the velocities at 0 and costs no bus access.
+void tmc5072_setVelocitySource(TMC5072TypeDef *tmc5072, TMCVelocitySource source)
+{
+	tmc5072->velocitySource = source;
+
+	for(uint8_t motor = 0; motor < TMC5072_MOTORS; motor++)
+		tmc5072->velocity[motor] = 0;
+}
+
+// Real-time part of the periodic job: velocities only, no configuration work.
+// Nothing is done while a reset or restore is running. Worst case per call:
+// 1 batch read of TMC5072_MOTORS registers every 5 ticks (none with TMC_VELOCITY_SOURCE_NONE).
+void tmc5072_periodicJobFast(TMC5072TypeDef *tmc5072, uint32_t tick)
 {
 	uint32_t tickDiff;
 
 	if(tmc5072->config->state != CONFIG_READY)
-	{
-		writeConfiguration(tmc5072);
 		return;
-	}
 
-	int32_t x;
+	uint8_t addresses[TMC5072_MOTORS];
+	int32_t x[TMC5072_MOTORS];
+	uint8_t motor;
 
-	// Calculate velocity v = dx/dt
-	if((tickDiff = tick - tmc5072->oldTick) >= 5)
+	if((tmc5072->velocitySource != TMC_VELOCITY_SOURCE_NONE) && ((tickDiff = tick - tmc5072->oldTick) >= 5))
 	{
-		for(uint8_t motor = 0; motor < TMC5072_MOTORS; motor++)
+		bool vActual = (tmc5072->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL);
+
+		// Sample both motors in one burst
+		for(motor = 0; motor < TMC5072_MOTORS; motor++)
+			addresses[motor] = (vActual) ? TMC5072_VACTUAL(motor) : TMC5072_XACTUAL(motor);
+
+		tmc5072_readIntBatch(tmc5072, addresses, x, TMC5072_MOTORS);
+
+		for(motor = 0; motor < TMC5072_MOTORS; motor++)
 		{
-			x = tmc5072_readInt(tmc5072, TMC5072_XACTUAL(motor));
-			tmc5072->velocity[motor] = (uint32_t) ((float32_t) (abs(x - tmc5072->oldX[motor]) / (float32_t) tickDiff) * (float32_t) 1048.576);
-			tmc5072->oldX[motor] = x;
+			if(vActual)
+			{
+				tmc5072->velocity[motor] = abs(CAST_Sn_TO_S32(x[motor], 24));
+			}
+			else
+			{	// Calculate velocity v = dx/dt
+				tmc5072->velocity[motor] = tmc_estimateVelocity(abs(x[motor] - tmc5072->oldX[motor]), tickDiff);
+				tmc5072->oldX[motor] = x[motor];
+			}
 		}
 		tmc5072->oldTick  = tick;
 	}
 }
 
+// Background part of the periodic job. Worst case per call: 1 register write while
+// a reset or restore is running, nothing otherwise.
+TMCConfigStatus tmc5072_periodicJobBackground(TMC5072TypeDef *tmc5072, uint32_t tick)
+{
+	UNUSED(tick);
+
+	if(tmc5072->config->state != CONFIG_READY)
+	{
+		writeConfiguration(tmc5072);
+		return TMC_CONFIG_STATUS(tmc5072->config);
+	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Call this periodically. Runs tmc5072_periodicJobBackground() and, once no
+// configuration is running, tmc5072_periodicJobFast().
+TMCConfigStatus tmc5072_periodicJob(TMC5072TypeDef *tmc5072, uint32_t tick)
+{
+	TMCConfigStatus status = tmc5072_periodicJobBackground(tmc5072, tick);
+
+	if(status == TMC_CONFIG_STATUS_READY)
+		tmc5072_periodicJobFast(tmc5072, tick);
+
+	return status;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc5072_configureBurst(TMC5072TypeDef *tmc5072, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc5072->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc5072);
+	}
+
+	return (tmc5072->config->state == CONFIG_READY);
+}
+
 //void tmc5072_periodicJob(uint8_t motor, uint32_t tick, TMC5072TypeDef *tmc5072, ConfigurationTypeDef *TMC5072_config)
 //{
 //	int xActual;
@@ -336,8 +482,12 @@ uint8_t tmc5072_restore(TMC5072TypeDef *tmc5072)
 
 void tmc5072_setRegisterResetState(TMC5072TypeDef *tmc5072, const int32_t *resetState)
 {
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_setAll(&tmc5072->registerResetState, resetState, TMC5072_REGISTER_COUNT);
+#else
 	for(size_t i = 0; i < TMC5072_REGISTER_COUNT; i++)
 		tmc5072->registerResetState[i] = resetState[i];
+#endif
 }
 
 void tmc5072_setCallback(TMC5072TypeDef *tmc5072, tmc5072_callback callback)
@@ -386,3 +536,36 @@ void tmc5072_moveBy(TMC5072TypeDef *tmc5072, uint8_t motor, uint32_t velocityMax
 
 	return tmc5072_moveTo(tmc5072, motor, *ticks, velocityMax);
 }
+
+// Move both motors. positions[] and velocityMax[] hold TMC5072_MOTORS entries.
+// The XTARGET writes are done last and back to back, so both moves start
+// within one datagram of each other.
+void tmc5072_moveToBoth(TMC5072TypeDef *tmc5072, const int32_t *positions, const uint32_t *velocityMax)
+{
+	uint8_t motor;
+
+	for(motor = 0; motor < TMC5072_MOTORS; motor++)
+	{
+		tmc5072_writeInt(tmc5072, TMC5072_RAMPMODE(motor), TMC5072_MODE_POSITION);
+		tmc5072_writeInt(tmc5072, TMC5072_VMAX(motor), velocityMax[motor]);
+	}
+
+	for(motor = 0; motor < TMC5072_MOTORS; motor++)
+		tmc5072_writeInt(tmc5072, TMC5072_XTARGET(motor), positions[motor]);
+}
+
+// Write the ramp parameters of a planned profile, see tmc_planRampProfile().
+// VMAX is written by the following move: tmc5072_moveTo(tmc5072, motor, position, profile->vMax)
+void tmc5072_writeRampProfile(TMC5072TypeDef *tmc5072, uint8_t motor, const TMCRampProfileTypeDef *profile)
+{
+	if(motor >= TMC5072_MOTORS)
+		return;
+
+	tmc5072_writeInt(tmc5072, TMC5072_VSTART(motor), profile->vStart);
+	tmc5072_writeInt(tmc5072, TMC5072_A1(motor), profile->a1);
+	tmc5072_writeInt(tmc5072, TMC5072_V1(motor), profile->v1);
+	tmc5072_writeInt(tmc5072, TMC5072_AMAX(motor), profile->aMax);
+	tmc5072_writeInt(tmc5072, TMC5072_DMAX(motor), profile->dMax);
+	tmc5072_writeInt(tmc5072, TMC5072_D1(motor), profile->d1);
+	tmc5072_writeInt(tmc5072, TMC5072_VSTOP(motor), profile->vStop);
+}
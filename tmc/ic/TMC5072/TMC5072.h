@@ -19,6 +19,9 @@
 	FIELD_GET(tmc5072_readInt(tdef, address), mask, shift)
 #define TMC5072_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc5072_writeInt(tdef, address, FIELD_SET(tmc5072_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5072_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc5072_writeInt(tdef, address, FIELDS_SET(tmc5072_readInt(tdef, address), mask, values)))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
@@ -26,10 +29,23 @@ typedef struct {
 	int32_t oldX[TMC5072_MOTORS];
 	uint32_t velocity[TMC5072_MOTORS];
 	uint32_t oldTick;
+	TMCVelocitySource velocitySource;  // See tmc5072_setVelocitySource()
+#ifdef TMC_RESET_STATE_CONST
+	TMCResetStateTypeDef registerResetState;
+#else
 	int32_t registerResetState[TMC5072_REGISTER_COUNT];
+#endif
 	uint8_t registerAccess[TMC5072_REGISTER_COUNT];
 } TMC5072TypeDef;
 
+// Status snapshot of one motor, see tmc5072_readStatusBoth()
+typedef struct {
+	int32_t xActual;
+	int32_t vActual;
+	uint32_t rampStat;
+	uint32_t drvStatus;
+} TMC5072MotorStatusTypeDef;
+
 typedef void (*tmc5072_callback)(TMC5072TypeDef*, ConfigState);
 
 // Default Register Values
@@ -62,6 +78,28 @@ static const uint8_t tmc5072_defaultRegisterAccess[TMC5072_REGISTER_COUNT] = {
 	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 0x01, 0x01, 0x03, 0x02, 0x02, 0x01  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc5072_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc5072_resettableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x05, 0x10, 0x18, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B,
+	0x2C, 0x2D, 0x30, 0x31, 0x32, 0x33, 0x34, 0x38, 0x39, 0x3A, 0x40, 0x41, 0x43, 0x44, 0x45, 0x46,
+	0x47, 0x48, 0x4A, 0x4B, 0x4C, 0x4D, 0x50, 0x51, 0x52, 0x53, 0x54, 0x58, 0x59, 0x5A, 0x6C, 0x6D,
+	0x6E, 0x7C, 0x7D, 0x7E
+};
+
+static const uint8_t tmc5072_restorableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x05, 0x10, 0x18, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B,
+	0x2C, 0x2D, 0x30, 0x31, 0x32, 0x33, 0x34, 0x38, 0x39, 0x3A, 0x40, 0x41, 0x43, 0x44, 0x45, 0x46,
+	0x47, 0x48, 0x4A, 0x4B, 0x4C, 0x4D, 0x50, 0x51, 0x52, 0x53, 0x54, 0x58, 0x59, 0x5A, 0x60, 0x61,
+	0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x6E, 0x7C, 0x7D, 0x7E
+};
+
 static const int32_t tmc5072_defaultRegisterResetState[TMC5072_REGISTER_COUNT] = {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
 	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, // 0x00 - 0x0F
@@ -102,6 +140,8 @@ static const TMCRegisterConstant tmc5072_RegisterConstants[] =
 void tmc5072_writeDatagram(TMC5072TypeDef *tmc5072, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5072_writeInt(TMC5072TypeDef *tmc5072, uint8_t address, int32_t value);
 int32_t tmc5072_readInt(TMC5072TypeDef *tmc5072, uint8_t address);
+void tmc5072_readIntBatch(TMC5072TypeDef *tmc5072, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc5072_readStatusBoth(TMC5072TypeDef *tmc5072, TMC5072MotorStatusTypeDef *status);
 
 void tmc5072_init(TMC5072TypeDef *tmc5072, uint8_t channel, ConfigurationTypeDef *tmc5072_config, const int32_t *registerResetState);
 void tmc5072_fillShadowRegisters(TMC5072TypeDef *tmc5072); // For constant registers with hardware preset we cant determine actual value
@@ -109,7 +149,11 @@ uint8_t tmc5072_reset(TMC5072TypeDef *tmc5072);
 uint8_t tmc5072_restore(TMC5072TypeDef *tmc5072);
 void tmc5072_setRegisterResetState(TMC5072TypeDef *tmc5072, const int32_t *resetState);
 void tmc5072_setCallback(TMC5072TypeDef *tmc5072, tmc5072_callback callback);
-void tmc5072_periodicJob(TMC5072TypeDef *tmc5072, uint32_t tick);
+TMCConfigStatus tmc5072_periodicJob(TMC5072TypeDef *tmc5072, uint32_t tick);
+void tmc5072_periodicJobFast(TMC5072TypeDef *tmc5072, uint32_t tick);
+TMCConfigStatus tmc5072_periodicJobBackground(TMC5072TypeDef *tmc5072, uint32_t tick);
+void tmc5072_setVelocitySource(TMC5072TypeDef *tmc5072, TMCVelocitySource source);
+uint8_t tmc5072_configureBurst(TMC5072TypeDef *tmc5072, uint32_t maxSteps);
 
 void tmc5072_rotate(TMC5072TypeDef *tmc5072, uint8_t motor, int32_t velocity);
 void tmc5072_right(TMC5072TypeDef *tmc5072, uint8_t motor, int32_t velocity);
@@ -117,5 +161,7 @@ void tmc5072_left(TMC5072TypeDef *tmc5072, uint8_t motor, int32_t velocity);
 void tmc5072_stop(TMC5072TypeDef *tmc5072, uint8_t motor);
 void tmc5072_moveTo(TMC5072TypeDef *tmc5072, uint8_t motor, int32_t position, uint32_t velocityMax);
 void tmc5072_moveBy(TMC5072TypeDef *tmc5072, uint8_t motor, uint32_t velocityMax, int32_t *ticks);
+void tmc5072_moveToBoth(TMC5072TypeDef *tmc5072, const int32_t *positions, const uint32_t *velocityMax);
+void tmc5072_writeRampProfile(TMC5072TypeDef *tmc5072, uint8_t motor, const TMCRampProfileTypeDef *profile);
 
 #endif /* TMC_IC_TMC5072_H_ */
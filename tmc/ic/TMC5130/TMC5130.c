@@ -6,18 +6,25 @@
  */
 
 #include "TMC5130.h"
+#include "tmc/helpers/Functions.h"
 
 // => SPI wrapper
 // Send [length] bytes stored in the [data] array over SPI and overwrite [data]
 // with the reply. The first byte sent/received is data[0].
 extern void tmc5130_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc5130_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC5130", tmc5130_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
+// Keep the SPI_STATUS byte of a reply, see tmc/helpers/SPI.h
+#define captureStatus(tmc5130, status)  tmc_spi_captureStatus(&(tmc5130)->spiStatus, tmc5130, status)
+
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
 void tmc5130_writeDatagram(TMC5130TypeDef *tmc5130, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
 	uint8_t data[5] = { address | TMC5130_WRITE_BIT, x1, x2, x3, x4 };
 	tmc5130_readWriteArray(tmc5130->config->channel, &data[0], 5);
+	captureStatus(tmc5130, data[0]);
 
 	int32_t value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
 
@@ -49,10 +56,80 @@ int32_t tmc5130_readInt(TMC5130TypeDef *tmc5130, uint8_t address)
 
 	data[0] = address;
 	tmc5130_readWriteArray(tmc5130->config->channel, &data[0], 5);
+	captureStatus(tmc5130, data[0]);
+
+	return tmc_unpackInt32(&data[1]);
+}
+
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+void tmc5130_readIntBatch(TMC5130TypeDef *tmc5130, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[5];
+	size_t i;
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	for(i = 0; i < count; i++)
+	{
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc5130->registerAccess[address]))
+		{
+			values[i] = tmc5130->config->shadowRegister[address];
+			continue;
+		}
+
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5130_readWriteArray(tmc5130->config->channel, &data[0], 5);
+		captureStatus(tmc5130, data[0]);
+
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+
+		pending = i;
+	}
+
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5130_readWriteArray(tmc5130->config->channel, &data[0], 5);
+		captureStatus(tmc5130, data[0]);
+		values[pending] = tmc_unpackInt32(&data[1]);
+	}
+}
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc5130_writeInt(ic, address, value);
 }
 
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC5130_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc5130_defaultRegisterAccess,
+	.resettableRegisters    = tmc5130_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc5130_resettableRegisters),
+	.restorableRegisters    = tmc5130_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc5130_restorableRegisters),
+	.constants              = tmc5130_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc5130_RegisterConstants),
+	.powerOnValues          = tmc5130_powerOnRegisters,
+	.powerOnCount           = ARRAY_SIZE(tmc5130_powerOnRegisters),
+	.writeOrder             = tmc5130_writeOrder,
+	.writeOrderCount        = ARRAY_SIZE(tmc5130_writeOrder),
+	.writeInt               = writeRegister,
+};
+
 // Initialize a TMC5130 IC.
 // This function requires:
 //     - tmc5130: The pointer to a TMC5130TypeDef struct, which represents one IC
@@ -61,22 +138,27 @@ int32_t tmc5130_readInt(TMC5130TypeDef *tmc5130, uint8_t address)
 //     - registerResetState: An int32_t array with 128 elements. This holds the values to be used for a reset.
 void tmc5130_init(TMC5130TypeDef *tmc5130, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
 {
-	tmc5130->velocity  = 0;
-	tmc5130->oldTick   = 0;
-	tmc5130->oldX      = 0;
-
-	tmc5130->config               = config;
-	tmc5130->config->callback     = NULL;
-	tmc5130->config->channel      = channel;
-	tmc5130->config->configIndex  = 0;
-	tmc5130->config->state        = CONFIG_READY;
-
-	size_t i;
-	for(i = 0; i < TMC5130_REGISTER_COUNT; i++)
-	{
-		tmc5130->registerAccess[i]      = tmc5130_defaultRegisterAccess[i];
-		tmc5130->registerResetState[i]  = registerResetState[i];
-	}
+	tmc_units_init(&tmc5130->units, TMC_UNITS_DEFAULT_CLOCK);
+
+	tmc5130->velocity        = 0;
+	tmc5130->oldTick         = 0;
+	tmc5130->oldX            = 0;
+	tmc5130->velocitySource  = TMC_VELOCITY_SOURCE_ESTIMATE;
+
+	tmc5130->gstat      = 0;
+	tmc5130->rampStat   = 0;
+	tmc5130->drvStatus  = 0;
+
+#if TMC_FEATURE_SPI_STATUS
+	tmc5130->spiStatus.status    = 0;
+	tmc5130->spiStatus.edgeMask  = 0;
+	tmc5130->spiStatus.valid     = false;
+	tmc5130->spiStatus.tick      = 0;
+	tmc5130->spiStatus.callback  = NULL;
+#endif
+
+	tmc5130->config = config;
+	tmc_driver_init(&driver, tmc5130->config, channel, tmc5130->registerAccess, tmc5130->registerResetState, registerResetState);
 }
 
 // Fill the shadow registers of hardware preset non-readable registers
@@ -84,77 +166,34 @@ void tmc5130_init(TMC5130TypeDef *tmc5130, uint8_t channel, ConfigurationTypeDef
 // in the TMCL IDE register browser
 void tmc5130_fillShadowRegisters(TMC5130TypeDef *tmc5130)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc5130_RegisterConstants) == 0)
-		return;
-
-	size_t i, j;
-	for(i = 0, j = 0; i < TMC5130_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc5130->registerAccess[i] != TMC_ACCESS_W_PRESET)
-			continue;
-
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc5130_RegisterConstants) && (tmc5130_RegisterConstants[j].address < i))
-			j++;
-
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc5130_RegisterConstants))
-			break;
-
-		// If we have an entry for our current address, write the constant
-		if(tmc5130_RegisterConstants[j].address == i)
-		{
-			tmc5130->config->shadowRegister[i] = tmc5130_RegisterConstants[j].value;
-		}
-	}
+	tmc_driver_fillShadowRegisters(&driver, tmc5130->config, tmc5130->registerAccess);
 }
 
 // Reset the TMC5130.
 uint8_t tmc5130_reset(TMC5130TypeDef *tmc5130)
 {
-	if(tmc5130->config->state != CONFIG_READY)
-		return false;
-
-	// Reset the dirty bits and wipe the shadow registers
-	size_t i;
-	for(i = 0; i < TMC5130_REGISTER_COUNT; i++)
-	{
-		tmc5130->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc5130->config->shadowRegister[i] = 0;
-	}
-
-	tmc5130->config->state        = CONFIG_RESET;
-	tmc5130->config->configIndex  = 0;
+	return tmc_driver_reset(&driver, tmc5130->config, tmc5130->registerAccess);
+}
 
-	return true;
+// Reset the TMC5130 after it has been powered up.
+// Only the registers differing from their power-on value are written.
+// Use tmc5130_reset() if the IC may have been configured since.
+uint8_t tmc5130_resetFromPowerOn(TMC5130TypeDef *tmc5130)
+{
+	return tmc_driver_resetFromPowerOn(&driver, tmc5130->config, tmc5130->registerAccess);
 }
 
 // Restore the TMC5130 to the state stored in the shadow registers.
 // This can be used to recover the IC configuration after a VM power loss.
 uint8_t tmc5130_restore(TMC5130TypeDef *tmc5130)
 {
-	if(tmc5130->config->state != CONFIG_READY)
-		return false;
-
-	tmc5130->config->state        = CONFIG_RESTORE;
-	tmc5130->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_restore(tmc5130->config);
 }
 
 // Change the values the IC will be configured with when performing a reset.
 void tmc5130_setRegisterResetState(TMC5130TypeDef *tmc5130, const int32_t *resetState)
 {
-	size_t i;
-	for(i = 0; i < TMC5130_REGISTER_COUNT; i++)
-	{
-		tmc5130->registerResetState[i] = resetState[i];
-	}
+	tmc_driver_setRegisterResetState(&driver, tmc5130->registerResetState, resetState);
 }
 
 // Register a function to be called after completion of the configuration mechanism
@@ -166,69 +205,207 @@ void tmc5130_setCallback(TMC5130TypeDef *tmc5130, tmc5130_callback callback)
 // Helper function: Configure the next register.
 static void writeConfiguration(TMC5130TypeDef *tmc5130)
 {
-	uint8_t *ptr = &tmc5130->config->configIndex;
-	const int32_t *settings;
+	if(!tmc_driver_writeConfiguration(&driver, tmc5130, tmc5130->config, tmc5130->registerAccess, tmc5130->registerResetState))
+		return;
 
-	if(tmc5130->config->state == CONFIG_RESTORE)
-	{
-		settings = tmc5130->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC5130_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc5130->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
-	}
-	else
+	// Finished configuration
+	if(tmc5130->config->callback)
 	{
-		settings = tmc5130->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC5130_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc5130->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		((tmc5130_callback)tmc5130->config->callback)(tmc5130, tmc5130->config->state);
 	}
 
-	if(*ptr < TMC5130_REGISTER_COUNT)
-	{
-		tmc5130_writeInt(tmc5130, *ptr, settings[*ptr]);
-		(*ptr)++;
-	}
-	else // Finished configuration
+	tmc5130->config->state = CONFIG_READY;
+}
+
+// Set the clock frequency [Hz] of the IC, 16 MHz by default. The velocity
+// estimate of the periodic job and the conversions in tmc5130->units use it.
+void tmc5130_setClockFrequency(TMC5130TypeDef *tmc5130, uint32_t clockFrequency)
+{
+	tmc_units_init(&tmc5130->units, clockFrequency);
+}
+
+// Select the value of tmc5130->velocity, updated every 5 ticks by the periodic job:
+// TMC_VELOCITY_SOURCE_ESTIMATE differentiates XACTUAL (default), TMC_VELOCITY_SOURCE_VACTUAL
+// reads the exact velocity of the ramp generator. TMC_VELOCITY_SOURCE_NONE leaves the velocity
+// at 0 and costs no bus access, for applications not using it.
+void tmc5130_setVelocitySource(TMC5130TypeDef *tmc5130, TMCVelocitySource source)
+{
+	tmc5130->velocitySource  = source;
+	tmc5130->velocity        = 0;
+}
+
+#if TMC_FEATURE_SPI_STATUS
+// SPI_STATUS of the last reply (TMC_SPI_STATUS_* flags), taken from the transfers
+// that happen anyway. [tick] receives the capture time, may be NULL.
+// Returns 0 before the first transfer.
+uint8_t tmc5130_getSpiStatus(TMC5130TypeDef *tmc5130, uint32_t *tick)
+{
+	if(tick)
+		*tick = tmc5130->spiStatus.tick;
+
+	return tmc5130->spiStatus.status;
+}
+
+// Call [callback] from the transfer that captures a set flag of [edgeMask].
+// The callback runs in the context of the transfer and must not access the IC.
+void tmc5130_setSpiStatusCallback(TMC5130TypeDef *tmc5130, tmc_spi_statusCallback callback, uint8_t edgeMask)
+{
+	tmc5130->spiStatus.callback  = callback;
+	tmc5130->spiStatus.edgeMask  = edgeMask;
+}
+#endif
+
+// Real-time part of the periodic job: velocity only, no configuration work.
+// Nothing is done while a reset or restore is running. Worst case per call:
+// 1 register read every 5 ticks (none with TMC_VELOCITY_SOURCE_NONE).
+void tmc5130_periodicJobFast(TMC5130TypeDef *tmc5130, uint32_t tick)
+{
+	if(tmc5130->config->state != CONFIG_READY)
+		return;
+
+	int32_t XActual;
+	uint32_t tickDiff;
+
+	if((tmc5130->velocitySource != TMC_VELOCITY_SOURCE_NONE) && ((tickDiff = tick - tmc5130->oldTick) >= 5))
 	{
-		if(tmc5130->config->callback)
+		if(tmc5130->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL)
 		{
-			((tmc5130_callback)tmc5130->config->callback)(tmc5130, tmc5130->config->state);
+			tmc5130->velocity = CAST_Sn_TO_S32(tmc5130_readInt(tmc5130, TMC5130_VACTUAL), 24);
+		}
+		else
+		{	// Calculate velocity v = dx/dt
+			XActual = tmc5130_readInt(tmc5130, TMC5130_XACTUAL);
+			tmc5130->velocity = tmc_estimateVelocityScaled(XActual - tmc5130->oldX, tickDiff, tmc5130->units.velocityScale);
+			tmc5130->oldX = XActual;
 		}
 
-		tmc5130->config->state = CONFIG_READY;
+		tmc5130->oldTick = tick;
 	}
 }
 
-// Call this periodically
-void tmc5130_periodicJob(TMC5130TypeDef *tmc5130, uint32_t tick)
+// Background part of the periodic job. Worst case per call: 1 register write while
+// a reset or restore is running, nothing otherwise.
+TMCConfigStatus tmc5130_periodicJobBackground(TMC5130TypeDef *tmc5130, uint32_t tick)
 {
+	UNUSED(tick);
+
 	if(tmc5130->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc5130);
-		return;
+		return TMC_CONFIG_STATUS(tmc5130->config);
 	}
 
-	int32_t XActual;
-	uint32_t tickDiff;
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Call this periodically. Runs tmc5130_periodicJobBackground() and, once no
+// configuration is running, tmc5130_periodicJobFast().
+TMCConfigStatus tmc5130_periodicJob(TMC5130TypeDef *tmc5130, uint32_t tick)
+{
+	TMCConfigStatus status = tmc5130_periodicJobBackground(tmc5130, tick);
+
+	if(status == TMC_CONFIG_STATUS_READY)
+		tmc5130_periodicJobFast(tmc5130, tick);
+
+	return status;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc5130_configureBurst(TMC5130TypeDef *tmc5130, uint32_t maxSteps)
+{
+	uint32_t step;
 
-	// Calculate velocity v = dx/dt
-	if((tickDiff = tick - tmc5130->oldTick) >= 5)
+	for(step = 0; tmc5130->config->state != CONFIG_READY; step++)
 	{
-		XActual = tmc5130_readInt(tmc5130, TMC5130_XACTUAL);
-		// ToDo CHECK 2: API Compatibility - write alternative algorithm w/o floating point? (LH)
-		tmc5130->velocity = (uint32_t) ((float32_t) ((XActual - tmc5130->oldX) / (float32_t) tickDiff) * (float32_t) 1048.576);
+		if(maxSteps && (step >= maxSteps))
+			break;
 
-		tmc5130->oldX     = XActual;
-		tmc5130->oldTick  = tick;
+		writeConfiguration(tmc5130);
 	}
+
+	return (tmc5130->config->state == CONFIG_READY);
 }
 
 // Rotate with a given velocity (to the right)
+// Event driven status
+// Route events to the DIAG0/DIAG1 pins with the diag* fields of GCONF and call this
+// from the GPIO interrupt instead of polling the status registers periodically.
+// GSTAT, RAMP_STAT and DRV_STATUS are read in one pipelined burst, only the flags
+// found set are written back to clear them. With TMC_VELOCITY_SOURCE_VACTUAL the burst
+// also updates the velocity.
+// Returns true if a latched flag of GSTAT or RAMP_STAT was set.
+uint8_t tmc5130_onInterrupt(TMC5130TypeDef *tmc5130)
+{
+	static const uint8_t addresses[] = { TMC5130_GSTAT, TMC5130_RAMPSTAT, TMC5130_DRVSTATUS, TMC5130_VACTUAL };
+	int32_t values[ARRAY_SIZE(addresses)];
+	size_t count = ARRAY_SIZE(addresses) - 1;
+	uint8_t pending = false;
+
+	// The velocity from VACTUAL is read along with the status
+	if(tmc5130->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL)
+		count++;
+
+	tmc5130_readIntBatch(tmc5130, addresses, values, count);
+
+	tmc5130->gstat      = values[0];
+	tmc5130->rampStat   = values[1];
+	tmc5130->drvStatus  = values[2];
+
+	if(count == ARRAY_SIZE(addresses))
+		tmc5130->velocity = CAST_Sn_TO_S32(values[3], 24);
+
+	if(values[0] & TMC5130_GSTAT_EVENTS)
+	{
+		tmc5130_writeInt(tmc5130, TMC5130_GSTAT, values[0] & TMC5130_GSTAT_EVENTS);
+		pending = true;
+	}
+
+	if(values[1] & TMC5130_RAMPSTAT_EVENTS)
+	{
+		tmc5130_writeInt(tmc5130, TMC5130_RAMPSTAT, values[1] & TMC5130_RAMPSTAT_EVENTS);
+		pending = true;
+	}
+
+	return pending;
+}
+
+// Restore the configuration only if the IC actually lost it.
+// Uses the GSTAT value of the last tmc5130_onInterrupt(), so the check costs no
+// extra access during routine status polling. A reset flag always restores.
+// An undervoltage flag alone (VM dip) does not clear the registers in most cases,
+// GCONF and CHOPCONF are read back and compared to the shadow registers to confirm.
+// The flags are consumed by the call.
+// Returns true if a restore was started.
+uint8_t tmc5130_restoreIfLost(TMC5130TypeDef *tmc5130)
+{
+	static const uint8_t sentinels[] = { TMC5130_GCONF, TMC5130_CHOPCONF };
+	int32_t values[ARRAY_SIZE(sentinels)];
+	int32_t gstat = tmc5130->gstat;
+	size_t i;
+
+	tmc5130->gstat &= ~(TMC5130_RESET_MASK | TMC5130_UV_CP_MASK);
+
+	if(gstat & TMC5130_RESET_MASK)
+		return tmc5130_restore(tmc5130);
+
+	if(!(gstat & TMC5130_UV_CP_MASK))
+		return false;
+
+	tmc5130_readIntBatch(tmc5130, sentinels, values, ARRAY_SIZE(sentinels));
+
+	for(i = 0; i < ARRAY_SIZE(sentinels); i++)
+	{
+		if(values[i] != TMC_SHADOW_REGISTER(tmc5130->config, sentinels[i]))
+			return tmc5130_restore(tmc5130);
+	}
+
+	return false;
+}
+
 void tmc5130_rotate(TMC5130TypeDef *tmc5130, int32_t velocity)
 {
 	// Set absolute velocity
@@ -276,3 +453,284 @@ void tmc5130_moveBy(TMC5130TypeDef *tmc5130, int32_t *ticks, uint32_t velocityMa
 
 	tmc5130_moveTo(tmc5130, *ticks, velocityMax);
 }
+
+// Write the ramp parameters of a planned profile, see tmc_planRampProfile().
+// VMAX is written by the following move: tmc5130_moveTo(tmc5130, position, profile->vMax)
+void tmc5130_writeRampProfile(TMC5130TypeDef *tmc5130, const TMCRampProfileTypeDef *profile)
+{
+	tmc5130_writeInt(tmc5130, TMC5130_VSTART, profile->vStart);
+	tmc5130_writeInt(tmc5130, TMC5130_A1, profile->a1);
+	tmc5130_writeInt(tmc5130, TMC5130_V1, profile->v1);
+	tmc5130_writeInt(tmc5130, TMC5130_AMAX, profile->aMax);
+	tmc5130_writeInt(tmc5130, TMC5130_DMAX, profile->dMax);
+	tmc5130_writeInt(tmc5130, TMC5130_D1, profile->d1);
+	tmc5130_writeInt(tmc5130, TMC5130_VSTOP, profile->vStop);
+}
+
+// Switch to a configuration profile, see tmc/helpers/ConfigProfile.h.
+// Pass the precomputed difference of two profiles to only write the changed registers.
+void tmc5130_writeProfile(TMC5130TypeDef *tmc5130, const TMCConfigProfile *profile)
+{
+	TMC_LOCK(tmc5130->config->channel);
+
+	for(uint8_t i = 0; i < profile->count; i++)
+		tmc5130_writeInt(tmc5130, profile->registers[i].address, profile->registers[i].value);
+
+	TMC_UNLOCK(tmc5130->config->channel);
+}
+
+// Write planned chopper thresholds, see tmc_planChopperThresholds().
+void tmc5130_writeChopperThresholds(TMC5130TypeDef *tmc5130, const TMCChopperThresholdsTypeDef *thresholds)
+{
+	tmc5130_writeInt(tmc5130, TMC5130_TPWMTHRS, thresholds->tpwmthrs);
+	tmc5130_writeInt(tmc5130, TMC5130_TCOOLTHRS, thresholds->tcoolthrs);
+	tmc5130_writeInt(tmc5130, TMC5130_THIGH, thresholds->thigh);
+}
+
+// Write a dcStep plan (tmc_planDcStep()), DCCTRL first so dcStep starts with it
+void tmc5130_writeDcStep(TMC5130TypeDef *tmc5130, const TMCDcStepPlanTypeDef *plan)
+{
+	tmc5130_writeInt(tmc5130, TMC5130_DCCTRL, plan->dcctrl);
+	tmc5130_writeInt(tmc5130, TMC5130_VDCMIN, plan->vdcmin);
+}
+
+// Read VACTUAL and RAMP_STAT in one batch and check for dcStep limiting the velocity,
+// see tmc_dcStepLimiting(). [velocity] (may be NULL) receives VACTUAL.
+bool tmc5130_dcStepLimiting(TMC5130TypeDef *tmc5130, int32_t *velocity)
+{
+	static const uint8_t addresses[] = { TMC5130_VACTUAL, TMC5130_RAMPSTAT };
+	int32_t values[ARRAY_SIZE(addresses)];
+
+	tmc5130_readIntBatch(tmc5130, addresses, values, ARRAY_SIZE(addresses));
+
+	if(velocity)
+		*velocity = values[0];
+
+	return tmc_dcStepLimiting(tmc5130->config->shadowRegister[TMC5130_VDCMIN],
+			tmc5130->config->shadowRegister[TMC5130_VMAX],
+			values[0],
+			FIELD_GET(values[1], TMC5130_VELOCITY_REACHED_MASK, TMC5130_VELOCITY_REACHED_SHIFT));
+}
+
+// Sensorless homing, see tmc/helpers/Homing.h.
+// Poll periodically after tmc_homing_start() until TMC_HOMING_DONE or TMC_HOMING_FAILED
+// is returned. The homing uses velocity mode with the configured AMAX, the stop on stall
+// of the ramp generator ends the seek. XACTUAL is 0 at the end stop afterwards.
+static void homingFinish(TMC5130TypeDef *tmc5130, TMCHomingTypeDef *homing, TMCHomingState state)
+{
+	tmc5130_stop(tmc5130);
+
+	tmc5130_writeInt(tmc5130, TMC5130_SWMODE, homing->saved[0]);
+	tmc5130_writeInt(tmc5130, TMC5130_COOLCONF, homing->saved[1]);
+	tmc5130_writeInt(tmc5130, TMC5130_TCOOLTHRS, homing->saved[2]);
+
+	// Clear a stop on stall, it blocks further motion
+	tmc5130_writeInt(tmc5130, TMC5130_RAMPSTAT, TMC5130_EVENT_STOP_SG_MASK);
+
+	if(state == TMC_HOMING_DONE)
+		tmc5130_writeInt(tmc5130, TMC5130_XACTUAL, 0);
+
+	homing->state = state;
+}
+
+static void writeStallThreshold(TMC5130TypeDef *tmc5130, TMCHomingTypeDef *homing)
+{
+	tmc5130_writeInt(tmc5130, TMC5130_COOLCONF, FIELD_SET(homing->saved[1], TMC5130_SGT_MASK, TMC5130_SGT_SHIFT, homing->threshold));
+}
+
+TMCHomingState tmc5130_home(TMC5130TypeDef *tmc5130, TMCHomingTypeDef *homing)
+{
+	int32_t value;
+
+	switch(homing->state)
+	{
+	case TMC_HOMING_START:
+		homing->saved[0] = tmc5130_readInt(tmc5130, TMC5130_SWMODE);
+		homing->saved[1] = tmc5130_readInt(tmc5130, TMC5130_COOLCONF);
+		homing->saved[2] = tmc5130_readInt(tmc5130, TMC5130_TCOOLTHRS);
+
+		// StallGuard active at every velocity of the homing
+		tmc5130_writeInt(tmc5130, TMC5130_TCOOLTHRS, TMC5130_TCOOLTHRS_MASK);
+		writeStallThreshold(tmc5130, homing);
+
+		if(homing->calibrated)
+		{
+			tmc5130_rotate(tmc5130, homing->velocity);
+			homing->state = TMC_HOMING_ACCELERATE;
+		}
+		else
+		{
+			tmc5130_rotate(tmc5130, -homing->velocity);
+			homing->state = TMC_HOMING_CALIBRATE;
+		}
+		break;
+	case TMC_HOMING_CALIBRATE:
+		if(!(tmc5130_readInt(tmc5130, TMC5130_RAMPSTAT) & TMC5130_VELOCITY_REACHED_MASK))
+			break;
+
+		value = tmc5130_readInt(tmc5130, TMC5130_DRVSTATUS);
+		if(!tmc_homing_sample(homing, FIELD_GET(value, TMC5130_SG_RESULT_MASK, TMC5130_SG_RESULT_SHIFT)))
+			break;
+
+		homing->state = tmc_homing_calibrateSG2(homing);
+		if(homing->state == TMC_HOMING_FAILED)
+		{
+			homingFinish(tmc5130, homing, TMC_HOMING_FAILED);
+			break;
+		}
+
+		writeStallThreshold(tmc5130, homing);
+		if(homing->state == TMC_HOMING_ACCELERATE)
+			tmc5130_rotate(tmc5130, homing->velocity);
+		break;
+	case TMC_HOMING_ACCELERATE:
+		// Arm the stop on stall only at the homing velocity, StallGuard is not valid while accelerating
+		if(!(tmc5130_readInt(tmc5130, TMC5130_RAMPSTAT) & TMC5130_VELOCITY_REACHED_MASK))
+			break;
+
+		tmc5130_writeInt(tmc5130, TMC5130_RAMPSTAT, TMC5130_EVENT_STOP_SG_MASK);
+		tmc5130_writeInt(tmc5130, TMC5130_SWMODE, homing->saved[0] | TMC5130_SG_STOP_MASK);
+		tmc_homing_arm(homing);
+		break;
+	case TMC_HOMING_SEEK:
+		if(homing->diagEvent || (tmc5130_readInt(tmc5130, TMC5130_RAMPSTAT) & TMC5130_EVENT_STOP_SG_MASK))
+			homingFinish(tmc5130, homing, TMC_HOMING_DONE);
+		else if(tmc_homing_timedOut(homing))
+			homingFinish(tmc5130, homing, TMC_HOMING_FAILED);
+		break;
+	default:
+		break;
+	}
+
+	return homing->state;
+}
+
+// CoolStep auto tuning, see tmc/helpers/CoolStepTune.h.
+// The motor rotates at the calibration velocity during the tuning and is stopped at the end.
+// Poll periodically after tmc_coolStepTune_start() until TMC_COOLSTEP_TUNE_DONE or
+// TMC_COOLSTEP_TUNE_FAILED is returned. On a failure the previous COOLCONF is kept.
+static void coolStepTuneFinish(TMC5130TypeDef *tmc5130, TMCCoolStepTuneTypeDef *tune, TMCCoolStepTuneState state)
+{
+	tmc5130_stop(tmc5130);
+	tmc5130_writeInt(tmc5130, TMC5130_COOLCONF, (state == TMC_COOLSTEP_TUNE_DONE) ? tune->coolconf : tune->saved[0]);
+	tmc5130_writeInt(tmc5130, TMC5130_TCOOLTHRS, tune->saved[1]);
+
+	tune->state = state;
+}
+
+TMCCoolStepTuneState tmc5130_tuneCoolStep(TMC5130TypeDef *tmc5130, TMCCoolStepTuneTypeDef *tune)
+{
+	static const uint8_t addresses[] = { TMC5130_RAMPSTAT, TMC5130_DRVSTATUS };
+	int32_t values[ARRAY_SIZE(addresses)];
+	TMCCoolStepTuneState state;
+
+	switch(tune->state)
+	{
+	case TMC_COOLSTEP_TUNE_START:
+		tune->saved[0] = tmc5130_readInt(tmc5130, TMC5130_COOLCONF);
+		tune->saved[1] = tmc5130_readInt(tmc5130, TMC5130_TCOOLTHRS);
+
+		// CoolStep active at every velocity of the tuning, off for the baseline
+		tmc5130_writeInt(tmc5130, TMC5130_TCOOLTHRS, TMC5130_TCOOLTHRS_MASK);
+		tune->state = TMC_COOLSTEP_TUNE_BASELINE;
+		tmc5130_writeInt(tmc5130, TMC5130_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		tmc5130_rotate(tmc5130, tune->velocity);
+		break;
+	case TMC_COOLSTEP_TUNE_BASELINE:
+	case TMC_COOLSTEP_TUNE_SWEEP:
+		tmc5130_readIntBatch(tmc5130, addresses, values, ARRAY_SIZE(addresses));
+
+		// SG_RESULT is not valid while accelerating
+		if(!(values[0] & TMC5130_VELOCITY_REACHED_MASK))
+			break;
+
+		if(!tmc_coolStepTune_sample(tune, FIELD_GET(values[1], TMC5130_SG_RESULT_MASK, TMC5130_SG_RESULT_SHIFT), FIELD_GET(values[1], TMC5130_CS_ACTUAL_MASK, TMC5130_CS_ACTUAL_SHIFT)))
+			break;
+
+		state = tmc_coolStepTune_evaluate(tune);
+		if(state != TMC_COOLSTEP_TUNE_SWEEP)
+		{
+			coolStepTuneFinish(tmc5130, tune, state);
+			break;
+		}
+
+		tune->state = state;
+		tmc5130_writeInt(tmc5130, TMC5130_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		break;
+	default:
+		break;
+	}
+
+	return tune->state;
+}
+
+// Encoder step loss monitor
+// The TMC5130 has no deviation compare (ENC_DEVIATION) of its own. XACTUAL and X_ENC are
+// compared every [interval] ticks instead of every cycle, trading detection latency for
+// bus load. X_ENC has to be scaled to microsteps with ENC_CONST.
+
+void tmc5130_encoderMonitorInit(TMC5130TypeDef *tmc5130, TMC5130EncoderMonitorTypeDef *monitor, uint32_t tolerance, uint16_t interval)
+{
+	UNUSED(tmc5130);
+
+	monitor->tolerance  = tolerance;
+	monitor->interval   = MAX(interval, 1);
+	monitor->tick       = 0;
+	monitor->deviation  = 0;
+	monitor->stepLoss   = false;
+}
+
+// Call periodically. Returns true while a step loss is latched.
+bool tmc5130_encoderMonitorService(TMC5130TypeDef *tmc5130, TMC5130EncoderMonitorTypeDef *monitor, uint32_t tick)
+{
+	static const uint8_t addresses[] = { TMC5130_XACTUAL, TMC5130_XENC };
+	int32_t values[ARRAY_SIZE(addresses)];
+
+	if((tick - monitor->tick) < monitor->interval)
+		return monitor->stepLoss;
+
+	tmc5130_readIntBatch(tmc5130, addresses, values, ARRAY_SIZE(addresses));
+	monitor->deviation = values[0] - values[1];
+	monitor->tick = tick;
+
+	if((uint32_t) abs(monitor->deviation) > monitor->tolerance)
+		monitor->stepLoss = true;
+
+	return monitor->stepLoss;
+}
+
+// Clear a latched step loss, e.g. after re-homing
+void tmc5130_encoderMonitorClear(TMC5130TypeDef *tmc5130, TMC5130EncoderMonitorTypeDef *monitor)
+{
+	UNUSED(tmc5130);
+
+	monitor->stepLoss = false;
+}
+
+// Closed loop position mode: Call periodically while moving to [target] with tmc5130_moveTo().
+// Every loop->interval ticks, XACTUAL and X_ENC are read in one batch and XTARGET is set to
+// [target] plus the correction of the loop, see tmc/ramp/PositionLoop.h. Returns true if the loop updated.
+bool tmc5130_positionLoopService(TMC5130TypeDef *tmc5130, TMC_PositionLoop *loop, int32_t target, uint32_t tick)
+{
+	static const uint8_t addresses[] = { TMC5130_XACTUAL, TMC5130_XENC };
+	int32_t values[ARRAY_SIZE(addresses)];
+	int32_t setpoint;
+
+	if(!tmc_ramp_ploop_isDue(loop, tick))
+		return false;
+
+	tmc5130_readIntBatch(tmc5130, addresses, values, ARRAY_SIZE(addresses));
+	loop->transfers += ARRAY_SIZE(addresses) + 1;
+
+	setpoint = target + tmc_ramp_ploop_update(loop, values[0], values[1], tick);
+
+	// XTARGET only changes with the target or the correction
+	if((setpoint != loop->setpoint) || (loop->cycles == 1))
+	{
+		tmc5130_writeInt(tmc5130, TMC5130_XTARGET, setpoint);
+		loop->setpoint = setpoint;
+		loop->transfers++;
+	}
+
+	return true;
+}
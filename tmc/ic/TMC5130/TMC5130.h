@@ -9,6 +9,7 @@
 #define TMC_IC_TMC5130_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ramp/PositionLoop.h"
 #include "TMC5130_Register.h"
 #include "TMC5130_Constants.h"
 #include "TMC5130_Fields.h"
@@ -18,19 +19,45 @@
 	FIELD_GET(tmc5130_readInt(tdef, address), mask, shift)
 #define TMC5130_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc5130_writeInt(tdef, address, FIELD_SET(tmc5130_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5130_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc5130_writeInt(tdef, address, FIELDS_SET(tmc5130_readInt(tdef, address), mask, values)))
 
 // Typedefs
 typedef struct
 {
 	ConfigurationTypeDef *config;
+	TMCUnitConversion units;  // Clock dependent unit conversions, see tmc5130_setClockFrequency()
 	int velocity, oldX;
 	uint32_t oldTick;
+	TMCVelocitySource velocitySource;  // See tmc5130_setVelocitySource()
 	int32_t registerResetState[TMC5130_REGISTER_COUNT];
 	uint8_t registerAccess[TMC5130_REGISTER_COUNT];
+#if TMC_FEATURE_SPI_STATUS
+	TMCSpiStatus spiStatus;  // SPI_STATUS of the last reply, see tmc5130_getSpiStatus()
+#endif
+	// Status read by tmc5130_onInterrupt()
+	int32_t gstat;
+	int32_t rampStat;
+	int32_t drvStatus;
 } TMC5130TypeDef;
 
+// Write-to-clear flags handled by the interrupt status read
+#define TMC5130_GSTAT_EVENTS     (TMC5130_RESET_MASK | TMC5130_DRV_ERR_MASK | TMC5130_UV_CP_MASK)
+#define TMC5130_RAMPSTAT_EVENTS  (TMC5130_STATUS_LATCH_L_MASK | TMC5130_STATUS_LATCH_R_MASK | TMC5130_EVENT_STOP_SG_MASK | TMC5130_EVENT_POS_REACHED_MASK | TMC5130_SECOND_MOVE_MASK)
+
 typedef void (*tmc5130_callback)(TMC5130TypeDef*, ConfigState);
 
+// Encoder step loss monitor, see tmc5130_encoderMonitorService()
+typedef struct
+{
+	uint32_t tolerance;  // Allowed deviation of XACTUAL and X_ENC [microsteps]
+	uint16_t interval;   // Ticks between background reads of X_ENC, 0: off
+	uint32_t tick;       // Tick of the last background read
+	int32_t deviation;   // XACTUAL - X_ENC of the last read
+	bool stepLoss;       // Latched until tmc5130_encoderMonitorClear()
+} TMC5130EncoderMonitorTypeDef;
+
 // Default Register values
 #define R10 0x00071703  // IHOLD_IRUN
 #define R3A 0x00010000  // ENC_CONST
@@ -76,6 +103,41 @@ static const uint8_t tmc5130_defaultRegisterAccess[TMC5130_REGISTER_COUNT] =
 	0x42, 0x01, 0x02, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc5130_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc5130_resettableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x05, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27,
+	0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x33, 0x34, 0x38, 0x39, 0x3A, 0x6C, 0x6D, 0x6E, 0x72
+};
+
+static const uint8_t tmc5130_restorableRegisters[] =
+{
+	0x00, 0x03, 0x04, 0x05, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20, 0x21, 0x23, 0x24, 0x25, 0x26, 0x27,
+	0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x33, 0x34, 0x38, 0x39, 0x3A, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65,
+	0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x6E, 0x70, 0x72
+};
+
+// Write order constraints, see WriteOrder.h. The motor current has to be set
+// before CHOPCONF enables the driver.
+static const TMCWriteOrder tmc5130_writeOrder[] =
+{
+	{ TMC5130_IHOLD_IRUN, TMC5130_CHOPCONF },
+};
+
+// Power-on values of the resettable registers, all others power up as 0.
+// Used by tmc5130_resetFromPowerOn() to skip writes. Use ascending addresses!
+static const TMCRegisterConstant tmc5130_powerOnRegisters[] =
+{
+	{ 0x11, 0x0000000A }, // TPOWERDOWN
+	{ 0x3A, 0x00010000 }, // ENC_CONST
+	{ 0x6C, 0x10410150 }  // CHOPCONF
+};
+
 // Register constants (only required for 0x42 registers, since we do not have
 // any way to find out the content but want to hold the actual value in the
 // shadow register so an application (i.e. the TMCL IDE) can still display
@@ -101,14 +163,27 @@ static const TMCRegisterConstant tmc5130_RegisterConstants[] =
 void tmc5130_writeDatagram(TMC5130TypeDef *tmc5130, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5130_writeInt(TMC5130TypeDef *tmc5130, uint8_t address, int32_t value);
 int32_t tmc5130_readInt(TMC5130TypeDef *tmc5130, uint8_t address);
+void tmc5130_readIntBatch(TMC5130TypeDef *tmc5130, const uint8_t *addresses, int32_t *values, size_t count);
 
 void tmc5130_init(TMC5130TypeDef *tmc5130, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
 void tmc5130_fillShadowRegisters(TMC5130TypeDef *tmc5130);
 uint8_t tmc5130_reset(TMC5130TypeDef *tmc5130);
+uint8_t tmc5130_resetFromPowerOn(TMC5130TypeDef *tmc5130);
 uint8_t tmc5130_restore(TMC5130TypeDef *tmc5130);
 void tmc5130_setRegisterResetState(TMC5130TypeDef *tmc5130, const int32_t *resetState);
 void tmc5130_setCallback(TMC5130TypeDef *tmc5130, tmc5130_callback callback);
-void tmc5130_periodicJob(TMC5130TypeDef *tmc5130, uint32_t tick);
+TMCConfigStatus tmc5130_periodicJob(TMC5130TypeDef *tmc5130, uint32_t tick);
+void tmc5130_periodicJobFast(TMC5130TypeDef *tmc5130, uint32_t tick);
+TMCConfigStatus tmc5130_periodicJobBackground(TMC5130TypeDef *tmc5130, uint32_t tick);
+void tmc5130_setClockFrequency(TMC5130TypeDef *tmc5130, uint32_t clockFrequency);
+void tmc5130_setVelocitySource(TMC5130TypeDef *tmc5130, TMCVelocitySource source);
+#if TMC_FEATURE_SPI_STATUS
+uint8_t tmc5130_getSpiStatus(TMC5130TypeDef *tmc5130, uint32_t *tick);
+void tmc5130_setSpiStatusCallback(TMC5130TypeDef *tmc5130, tmc_spi_statusCallback callback, uint8_t edgeMask);
+#endif
+uint8_t tmc5130_configureBurst(TMC5130TypeDef *tmc5130, uint32_t maxSteps);
+uint8_t tmc5130_onInterrupt(TMC5130TypeDef *tmc5130);
+uint8_t tmc5130_restoreIfLost(TMC5130TypeDef *tmc5130);
 
 void tmc5130_rotate(TMC5130TypeDef *tmc5130, int32_t velocity);
 void tmc5130_right(TMC5130TypeDef *tmc5130, uint32_t velocity);
@@ -116,5 +191,16 @@ void tmc5130_left(TMC5130TypeDef *tmc5130, uint32_t velocity);
 void tmc5130_stop(TMC5130TypeDef *tmc5130);
 void tmc5130_moveTo(TMC5130TypeDef *tmc5130, int32_t position, uint32_t velocityMax);
 void tmc5130_moveBy(TMC5130TypeDef *tmc5130, int32_t *ticks, uint32_t velocityMax);
+void tmc5130_writeRampProfile(TMC5130TypeDef *tmc5130, const TMCRampProfileTypeDef *profile);
+void tmc5130_writeProfile(TMC5130TypeDef *tmc5130, const TMCConfigProfile *profile);
+void tmc5130_writeChopperThresholds(TMC5130TypeDef *tmc5130, const TMCChopperThresholdsTypeDef *thresholds);
+void tmc5130_writeDcStep(TMC5130TypeDef *tmc5130, const TMCDcStepPlanTypeDef *plan);
+bool tmc5130_dcStepLimiting(TMC5130TypeDef *tmc5130, int32_t *velocity);
+TMCHomingState tmc5130_home(TMC5130TypeDef *tmc5130, TMCHomingTypeDef *homing);
+TMCCoolStepTuneState tmc5130_tuneCoolStep(TMC5130TypeDef *tmc5130, TMCCoolStepTuneTypeDef *tune);
+void tmc5130_encoderMonitorInit(TMC5130TypeDef *tmc5130, TMC5130EncoderMonitorTypeDef *monitor, uint32_t tolerance, uint16_t interval);
+bool tmc5130_encoderMonitorService(TMC5130TypeDef *tmc5130, TMC5130EncoderMonitorTypeDef *monitor, uint32_t tick);
+void tmc5130_encoderMonitorClear(TMC5130TypeDef *tmc5130, TMC5130EncoderMonitorTypeDef *monitor);
+bool tmc5130_positionLoopService(TMC5130TypeDef *tmc5130, TMC_PositionLoop *loop, int32_t target, uint32_t tick);
 
 #endif /* TMC_IC_TMC5130_H_ */
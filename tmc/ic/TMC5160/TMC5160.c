@@ -6,25 +6,205 @@
  */
 
 #include "TMC5160.h"
+#include "TMC5160_Descriptors.h"
+#include "tmc/helpers/Functions.h"
 
 // => SPI wrapper
 // Send [length] bytes stored in the [data] array over SPI and overwrite [data]
 // with the reply. The first byte sent/received is data[0].
 extern void tmc5160_readWriteArray(uint8_t channel, uint8_t *data, size_t length);
+#define tmc5160_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC5160", tmc5160_readWriteArray, channel, data, length)
 // <= SPI wrapper
 
+#ifdef TMC5160_ASYNC
+// => Async SPI wrapper
+// Start sending [length] bytes stored in the [data] array and return immediately.
+// Once the reply has been written to [data], call complete(context).
+extern void tmc5160_readWriteArrayAsync(uint8_t channel, uint8_t *data, size_t length, tmc_async_complete complete, void *context);
+// <= Async SPI wrapper
+#endif
+
+#ifdef TMC5160_TRANSFER_BATCH
+// => Batched SPI wrapper
+// Send the datagrams of [transfers] in order, each framed with its own chip select,
+// and overwrite their data with the replies. Called with up to TMC_TRANSFER_BATCH_SIZE transfers.
+extern void tmc5160_readWriteBatch(uint8_t channel, TMCTransfer *transfers, size_t count);
+// <= Batched SPI wrapper
+#endif
+
+// Keep the SPI_STATUS byte of a reply, see tmc/helpers/SPI.h.
+// Replies of TMC5160_TRANSFER_BATCH lists are not captured.
+#define captureStatus(tmc5160, status)  tmc_spi_captureStatus(&(tmc5160)->spiStatus, tmc5160, status)
+
+// The IC latches a read value once its request datagram has been sent
+#ifdef TMC_SAMPLE_TIMESTAMP
+#define stampSample(tmc5160)  ((tmc5160)->sampleTime = TMC_SAMPLE_TIMESTAMP())
+#else
+#define stampSample(tmc5160)  ((void) 0)
+#endif
+
+#ifdef TMC5160_READ_CACHE
+// Cache slot of the given address, NULL if it is not cached
+static TMCReadCacheEntry *readCacheFind(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+	for(uint8_t i = 0; i < TMC5160_READ_CACHE_SIZE; i++)
+	{
+		if(tmc5160->readCache[i].valid && (tmc5160->readCache[i].address == address))
+			return &tmc5160->readCache[i];
+	}
+
+	return NULL;
+}
+
+// Store a read value if the register may be cached.
+// Replaces the entry of the same address, a free or the oldest entry.
+static void readCacheStore(TMC5160TypeDef *tmc5160, uint8_t address, int32_t value)
+{
+	uint8_t maxAge = tmc5160->registerMaxAge[address];
+	TMCReadCacheEntry *entry;
+
+	if(TMC_CACHE_MAX_AGE(maxAge) == 0)
+		return;
+
+	if((tmc5160->registerAccess[address] & TMC_ACCESS_FLAGS) && !(maxAge & TMC_CACHE_ALLOW_FLAGS))
+		return;
+
+	entry = readCacheFind(tmc5160, address);
+	for(uint8_t i = 0; !entry && (i < TMC5160_READ_CACHE_SIZE); i++)
+	{
+		if(!tmc5160->readCache[i].valid)
+			entry = &tmc5160->readCache[i];
+	}
+	if(!entry)
+	{
+		entry = &tmc5160->readCache[0];
+		for(uint8_t i = 1; i < TMC5160_READ_CACHE_SIZE; i++)
+		{
+			if((tmc5160->cacheTick - tmc5160->readCache[i].tick) > (tmc5160->cacheTick - entry->tick))
+				entry = &tmc5160->readCache[i];
+		}
+	}
+
+	entry->address  = address;
+	entry->valid    = true;
+	entry->tick     = tmc5160->cacheTick;
+	entry->value    = value;
+}
+#endif
+
+#if TMC_FEATURE_SHADOW
+// Mark a register as written since the last reset.
+// Called after storing the shadow value: Any context seeing the dirty mark also
+// sees the value. The mark only touches the register's own access byte, or the
+// shared bitmap word with an atomic OR.
+static void markDirty(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+	TMC_COMPILER_BARRIER();
+
+#ifdef TMC_DIRTY_BITMAP
+	// Only writable registers are restored, so only those need tracking
+	if(TMC_IS_WRITABLE(tmc5160->registerAccess[address]))
+		TMC_DIRTY_SET(tmc5160->dirty, address);
+#else
+	tmc5160->registerAccess[address] |= TMC_ACCESS_DIRTY;
+#endif
+}
+
+// Access permissions of a register, including the dirty bit
+static uint8_t getAccess(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+#ifdef TMC_DIRTY_BITMAP
+	return tmc5160->registerAccess[address] | (TMC_DIRTY_TEST(tmc5160->dirty, address) ? TMC_ACCESS_DIRTY : 0);
+#else
+	return tmc5160->registerAccess[address];
+#endif
+}
+#endif
+
+// Store a value read from or written to the IC in the attached register view
+static void storeView(TMC5160TypeDef *tmc5160, uint8_t address, int32_t value, bool written)
+{
+#if TMC_FEATURE_VIEW
+	if(tmc5160->view)
+		tmc_view_store(tmc5160->view, address, value, written);
+#else
+	UNUSED(tmc5160);
+	UNUSED(address);
+	UNUSED(value);
+	UNUSED(written);
+#endif
+}
+
+// Write to the shadow register and mark the register dirty
+static void writeShadow(TMC5160TypeDef *tmc5160, uint8_t address, int32_t value)
+{
+	storeView(tmc5160, address, value, true);
+
+#if TMC_FEATURE_TELEMETRY
+	// A motion command switches the telemetry back to the fast rate
+	if((address == TMC5160_RAMPMODE) || (address == TMC5160_XTARGET) || (address == TMC5160_VMAX))
+		tmc5160->telemetryActive = true;
+#endif
+
+#if TMC_FEATURE_SHADOW
+	TMC_SHADOW_REGISTER(tmc5160->config, address) = value;
+	markDirty(tmc5160, address);
+#else
+	UNUSED(tmc5160);
+	UNUSED(address);
+	UNUSED(value);
+#endif
+}
+
+// Value of a register that is not readable. 0 without shadow registers.
+static int32_t readShadow(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+#if TMC_FEATURE_SHADOW
+	return TMC_SHADOW_REGISTER(tmc5160->config, address);
+#else
+	UNUSED(tmc5160);
+	UNUSED(address);
+	return 0;
+#endif
+}
+
 // Writes (x1 << 24) | (x2 << 16) | (x3 << 8) | x4 to the given address
 void tmc5160_writeDatagram(TMC5160TypeDef *tmc5160, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4)
 {
+	int32_t value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
+
+	TMC_LOCK(tmc5160->config->channel);
+
+#if defined(TMC5160_WRITE_CACHE) && TMC_FEATURE_SHADOW
+	// Skip writes that would not change an already written register.
+	// The configuration mechanism always writes, and XACTUAL/XENC are also changed by the IC itself.
+	if((tmc5160->config->state == CONFIG_READY)
+	&& TMC_IS_CACHEABLE(getAccess(tmc5160, TMC_ADDRESS(address)))
+	&& (TMC_ADDRESS(address) != TMC5160_XACTUAL)
+	&& (TMC_ADDRESS(address) != TMC5160_XENC)
+	&& (TMC_SHADOW_REGISTER(tmc5160->config, TMC_ADDRESS(address)) == value))
+	{
+		TMC_UNLOCK(tmc5160->config->channel);
+		return;
+	}
+#endif
+
 	uint8_t data[5] = { address | TMC5160_WRITE_BIT, x1, x2, x3, x4 };
 	tmc5160_readWriteArray(tmc5160->config->channel, &data[0], 5);
+	captureStatus(tmc5160, data[0]);
 
-	int32_t value = ((uint32_t)x1 << 24) | ((uint32_t)x2 << 16) | (x3 << 8) | x4;
-
-	// Write to the shadow register and mark the register dirty
 	address = TMC_ADDRESS(address);
-	tmc5160->config->shadowRegister[address] = value;
-	tmc5160->registerAccess[address] |= TMC_ACCESS_DIRTY;
+	writeShadow(tmc5160, address, value);
+
+#ifdef TMC5160_READ_CACHE
+	// A write may change the read value
+	TMCReadCacheEntry *entry = readCacheFind(tmc5160, address);
+	if(entry)
+		entry->valid = false;
+#endif
+
+	TMC_UNLOCK(tmc5160->config->channel);
 }
 
 // Write an integer to the given address
@@ -40,254 +220,2093 @@ int32_t tmc5160_readInt(TMC5160TypeDef *tmc5160, uint8_t address)
 
 	// register not readable -> shadow register copy
 	if(!TMC_IS_READABLE(tmc5160->registerAccess[address]))
-		return tmc5160->config->shadowRegister[address];
+		return readShadow(tmc5160, address);
+
+	return tmc5160_readRegister(tmc5160, address);
+}
+
+// Read the given address over the bus, without checking the access table.
+// Only for readable registers, see TMC5160_Accessors.h.
+int32_t tmc5160_readRegister(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+	int32_t value;
+
+	address = TMC_ADDRESS(address);
+
+	// Both transfers of the read belong together
+	TMC_LOCK(tmc5160->config->channel);
 
+#ifdef TMC5160_READ_CACHE
+	// Value read recently enough -> cached copy
+	TMCReadCacheEntry *entry = readCacheFind(tmc5160, address);
+	if(entry && ((tmc5160->cacheTick - entry->tick) < TMC_CACHE_MAX_AGE(tmc5160->registerMaxAge[address])))
+	{
+		value = entry->value;
+		TMC_UNLOCK(tmc5160->config->channel);
+		return value;
+	}
+#endif
+
+#ifdef TMC5160_TRANSFER_BATCH
+	// Request and reply datagram in one submission
+	TMCTransferList list;
+
+	tmc_transfer_init(&list, tmc5160->config->channel, tmc5160_readWriteBatch);
+	tmc_transfer_appendDatagram(&list, address, 0, NULL, NULL);
+	tmc_transfer_appendDatagram(&list, address, 0, tmc_transfer_decodeInt32, &value);
+	stampSample(tmc5160); // Submission of the list, close to the request
+	tmc_transfer_execute(&list);
+#else
 	uint8_t data[5] = { 0, 0, 0, 0, 0 };
 
 	data[0] = address;
 	tmc5160_readWriteArray(tmc5160->config->channel, &data[0], 5);
+	stampSample(tmc5160);
 
 	data[0] = address;
 	tmc5160_readWriteArray(tmc5160->config->channel, &data[0], 5);
+	captureStatus(tmc5160, data[0]);
 
-	return ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | (data[3] << 8) | data[4];
-}
+	value = tmc_unpackInt32(&data[1]);
+#endif
 
-// Initialize a TMC5160 IC.
-// This function requires:
-//     - tmc5160: The pointer to a TMC5160TypeDef struct, which represents one IC
-//     - channel: The channel index, which will be sent back in the SPI callback
-//     - config: A ConfigurationTypeDef struct, which will be used by the IC
-//     - registerResetState: An int32_t array with 128 elements. This holds the values to be used for a reset.
-void tmc5160_init(TMC5160TypeDef *tmc5160, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
-{
-	tmc5160->velocity  = 0;
-	tmc5160->oldTick   = 0;
-	tmc5160->oldX      = 0;
+	storeView(tmc5160, address, value, false);
 
-	tmc5160->config               = config;
-	tmc5160->config->callback     = NULL;
-	tmc5160->config->channel      = channel;
-	tmc5160->config->configIndex  = 0;
-	tmc5160->config->state        = CONFIG_READY;
+#ifdef TMC5160_READ_CACHE
+	readCacheStore(tmc5160, address, value);
+#endif
 
-	size_t i;
-	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
-	{
-		tmc5160->registerAccess[i]      = tmc5160_defaultRegisterAccess[i];
-		tmc5160->registerResetState[i]  = registerResetState[i];
-	}
+	TMC_UNLOCK(tmc5160->config->channel);
+
+	return value;
 }
 
-// Fill the shadow registers of hardware preset non-readable registers
-// Only needed if you want to 'read' those registers e.g to display the value
-// in the TMCL IDE register browser
-void tmc5160_fillShadowRegisters(TMC5160TypeDef *tmc5160)
+// Read multiple registers with pipelined datagrams.
+// The reply to a read request is only sent with the following datagram, so
+// each request also clocks out the value of the previous one. Reading [count]
+// registers this way takes count+1 transfers instead of 2*count.
+// Registers that are not readable are taken from the shadow registers.
+#ifdef TMC5160_TRANSFER_BATCH
+// The datagrams are submitted in lists of up to TMC_TRANSFER_BATCH_SIZE transfers.
+void tmc5160_readIntBatch(TMC5160TypeDef *tmc5160, const uint8_t *addresses, int32_t *values, size_t count)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc5160_RegisterConstants) == 0)
-		return;
+	TMCTransferList list;
+	size_t i;
+	size_t pending = count; // Index of the value the reply of the next transfer belongs to
 
-	size_t i, j;
-	for(i = 0, j = 0; i < TMC5160_REGISTER_COUNT; i++)
+	TMC_LOCK(tmc5160->config->channel);
+
+	tmc_transfer_init(&list, tmc5160->config->channel, tmc5160_readWriteBatch);
+
+	for(i = 0; i <= count; i++)
 	{
-		// We only need to worry about hardware preset, write-only registers
-		// that have not yet been written (no dirty bit) here.
-		if(tmc5160->registerAccess[i] != TMC_ACCESS_W_PRESET)
-			continue;
+		uint8_t address;
 
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while(j < ARRAY_SIZE(tmc5160_RegisterConstants) && (tmc5160_RegisterConstants[j].address < i))
-			j++;
+		if(i < count)
+		{
+			address = TMC_ADDRESS(addresses[i]);
 
-		// Abort when we reach the end of the constant list
-		if (j == ARRAY_SIZE(tmc5160_RegisterConstants))
+			// register not readable -> shadow register copy
+			if(!TMC_IS_READABLE(tmc5160->registerAccess[address]))
+			{
+				values[i] = readShadow(tmc5160, address);
+				continue;
+			}
+		}
+		else if(pending < count)
+		{
+			// Clock out the reply of the last request
+			address = TMC_ADDRESS(addresses[pending]);
+		}
+		else
+		{
 			break;
+		}
 
-		// If we have an entry for our current address, write the constant
-		if(tmc5160_RegisterConstants[j].address == i)
+		if(pending < count)
 		{
-			tmc5160->config->shadowRegister[i] = tmc5160_RegisterConstants[j].value;
+			tmc_transfer_appendDatagram(&list, address, 0, tmc_transfer_decodeInt32, &values[pending]);
 		}
+		else
+		{	// Stamped with the first request, the first list is submitted right away
+			tmc_transfer_appendDatagram(&list, address, 0, NULL, NULL);
+			stampSample(tmc5160);
+		}
+		pending = i;
+
+		if(!tmc_transfer_isFull(&list) && (i < count))
+			continue;
+
+		tmc_transfer_execute(&list);
 	}
-}
 
-// Reset the TMC5160.
-uint8_t tmc5160_reset(TMC5160TypeDef *tmc5160)
-{
-	if(tmc5160->config->state != CONFIG_READY)
-		return false;
+#if TMC_FEATURE_VIEW
+	for(i = 0; i < count; i++)
+	{
+		if(TMC_IS_READABLE(tmc5160->registerAccess[TMC_ADDRESS(addresses[i])]))
+			storeView(tmc5160, TMC_ADDRESS(addresses[i]), values[i], false);
+	}
+#endif
 
-	// Reset the dirty bits and wipe the shadow registers
+	TMC_UNLOCK(tmc5160->config->channel);
+}
+#else
+void tmc5160_readIntBatch(TMC5160TypeDef *tmc5160, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	uint8_t data[5];
 	size_t i;
-	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+	size_t pending = count; // Index of the value the next reply belongs to
+
+	TMC_LOCK(tmc5160->config->channel);
+
+	for(i = 0; i < count; i++)
 	{
-		tmc5160->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
-		tmc5160->config->shadowRegister[i] = 0;
-	}
+		uint8_t address = TMC_ADDRESS(addresses[i]);
 
-	tmc5160->config->state        = CONFIG_RESET;
-	tmc5160->config->configIndex  = 0;
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(tmc5160->registerAccess[address]))
+		{
+			values[i] = readShadow(tmc5160, address);
+			continue;
+		}
 
-	return true;
-}
+		data[0] = address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5160_readWriteArray(tmc5160->config->channel, &data[0], 5);
+		captureStatus(tmc5160, data[0]);
 
-// Restore the TMC5160 to the state stored in the shadow registers.
-// This can be used to recover the IC configuration after a VM power loss.
-uint8_t tmc5160_restore(TMC5160TypeDef *tmc5160)
-{
-	if(tmc5160->config->state != CONFIG_READY)
-		return false;
+		if(pending < count)
+		{
+			values[pending] = tmc_unpackInt32(&data[1]);
+		}
+		else
+		{	// The whole batch is stamped with its first request
+			stampSample(tmc5160);
+		}
 
-	tmc5160->config->state        = CONFIG_RESTORE;
-	tmc5160->config->configIndex  = 0;
+		pending = i;
+	}
 
-	return true;
-}
+	// Clock out the reply of the last request
+	if(pending < count)
+	{
+		data[0] = TMC_ADDRESS(addresses[pending]);
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5160_readWriteArray(tmc5160->config->channel, &data[0], 5);
+		captureStatus(tmc5160, data[0]);
+		values[pending] = tmc_unpackInt32(&data[1]);
+	}
 
-// Change the values the IC will be configured with when performing a reset.
-void tmc5160_setRegisterResetState(TMC5160TypeDef *tmc5160, const int32_t *resetState)
-{
-	size_t i;
-	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+#if TMC_FEATURE_VIEW
+	for(i = 0; i < count; i++)
 	{
-		tmc5160->registerResetState[i] = resetState[i];
+		if(TMC_IS_READABLE(tmc5160->registerAccess[TMC_ADDRESS(addresses[i])]))
+			storeView(tmc5160, TMC_ADDRESS(addresses[i]), values[i], false);
 	}
+#endif
+
+	TMC_UNLOCK(tmc5160->config->channel);
 }
+#endif
 
-// Register a function to be called after completion of the configuration mechanism
-void tmc5160_setCallback(TMC5160TypeDef *tmc5160, tmc5160_callback callback)
+// Daisy chain access
+// The frame holds one datagram per IC. The datagram sent first is shifted the
+// furthest and ends up in the last IC of the chain, the reply of the last IC
+// is also received first. All ICs are accessed with a single transfer.
+
+// Initialize a chain of [count] ICs sharing the chip select of [channel].
+// ics[0] is the IC connected to the MCU's SDO, ics[count-1] the one connected to its SDI.
+void tmc5160_chainInit(TMC5160ChainTypeDef *chain, uint8_t channel, TMC5160TypeDef **ics, uint8_t count)
 {
-	tmc5160->config->callback = (tmc_callback_config) callback;
+	chain->channel = channel;
+	chain->count   = MIN(count, TMC5160_CHAIN_MAX);
+
+	for(uint8_t i = 0; i < chain->count; i++)
+		chain->ics[i] = ics[i];
 }
 
-// Helper function: Configure the next register.
-static void writeConfiguration(TMC5160TypeDef *tmc5160)
+// Write values[i] to addresses[i] of IC i, for all ICs of the chain in one transfer
+void tmc5160_chainWriteInt(TMC5160ChainTypeDef *chain, const uint8_t *addresses, const int32_t *values)
 {
-	uint8_t *ptr = &tmc5160->config->configIndex;
-	const int32_t *settings;
+	uint8_t data[5 * TMC5160_CHAIN_MAX];
+	uint8_t i;
 
-	if(tmc5160->config->state == CONFIG_RESTORE)
+	for(i = 0; i < chain->count; i++)
 	{
-		settings = tmc5160->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC5160_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc5160->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		uint8_t *datagram = &data[5 * (chain->count - 1 - i)];
+		datagram[0] = addresses[i] | TMC5160_WRITE_BIT;
+		tmc_packInt32(&datagram[1], values[i]);
 	}
-	else
+
+	TMC_LOCK(chain->channel);
+
+	tmc5160_readWriteArray(chain->channel, &data[0], 5 * chain->count);
+
+	for(i = 0; i < chain->count; i++)
 	{
-		settings = tmc5160->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC5160_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc5160->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		writeShadow(chain->ics[i], TMC_ADDRESS(addresses[i]), values[i]);
+		captureStatus(chain->ics[i], data[5 * (chain->count - 1 - i)]);
 	}
 
-	if(*ptr < TMC5160_REGISTER_COUNT)
+	TMC_UNLOCK(chain->channel);
+}
+
+// Start a move of every IC of the chain at the same time: VMAX is written with one
+// frame, the targets with a second one. All ICs take over the XTARGET datagram on
+// the same chip select edge, so the ramps start aligned to one clock cycle.
+// The ICs have to be in position mode at standstill, a changed VMAX then has no effect
+// until the new target arrives.
+void tmc5160_chainMoveTo(TMC5160ChainTypeDef *chain, const int32_t *positions, const uint32_t *velocities)
+{
+	uint8_t addresses[TMC5160_CHAIN_MAX];
+	int32_t values[TMC5160_CHAIN_MAX];
+	uint8_t i;
+
+	for(i = 0; i < chain->count; i++)
 	{
-		tmc5160_writeInt(tmc5160, *ptr, settings[*ptr]);
-		(*ptr)++;
+		addresses[i] = TMC5160_VMAX;
+		values[i] = velocities[i];
 	}
-	else // Finished configuration
-	{
-		if(tmc5160->config->callback)
-		{
-			((tmc5160_callback)tmc5160->config->callback)(tmc5160, tmc5160->config->state);
-		}
+	tmc5160_chainWriteInt(chain, addresses, values);
+
+	for(i = 0; i < chain->count; i++)
+		addresses[i] = TMC5160_XTARGET;
+	tmc5160_chainWriteInt(chain, addresses, positions);
+}
+
+// Write the same value to the same register of all ICs of the chain in one transfer
+void tmc5160_chainWriteIntAll(TMC5160ChainTypeDef *chain, uint8_t address, int32_t value)
+{
+	uint8_t addresses[TMC5160_CHAIN_MAX];
+	int32_t values[TMC5160_CHAIN_MAX];
 
-		tmc5160->config->state = CONFIG_READY;
+	for(uint8_t i = 0; i < chain->count; i++)
+	{
+		addresses[i] = address;
+		values[i]    = value;
 	}
+
+	tmc5160_chainWriteInt(chain, addresses, values);
 }
 
-// Call this periodically
-void tmc5160_periodicJob(TMC5160TypeDef *tmc5160, uint32_t tick)
+// Read addresses[i] of IC i into values[i] for all ICs of the chain.
+// Takes two transfers, as the replies are sent with the following frame.
+// Registers that are not readable are taken from the shadow registers.
+void tmc5160_chainReadInt(TMC5160ChainTypeDef *chain, const uint8_t *addresses, int32_t *values)
 {
-	if(tmc5160->config->state != CONFIG_READY)
+	uint8_t data[5 * TMC5160_CHAIN_MAX];
+	uint8_t i, pass;
+
+	TMC_LOCK(chain->channel);
+
+	for(pass = 0; pass < 2; pass++)
 	{
-		writeConfiguration(tmc5160);
-		return;
+		for(i = 0; i < chain->count; i++)
+		{
+			uint8_t *datagram = &data[5 * (chain->count - 1 - i)];
+			datagram[0] = TMC_ADDRESS(addresses[i]);
+			datagram[1] = datagram[2] = datagram[3] = datagram[4] = 0;
+		}
+
+		tmc5160_readWriteArray(chain->channel, &data[0], 5 * chain->count);
 	}
 
-	int32_t XActual;
-	uint32_t tickDiff;
+	TMC_UNLOCK(chain->channel);
 
-	// Calculate velocity v = dx/dt
-	if((tickDiff = tick - tmc5160->oldTick) >= 5)
+	for(i = 0; i < chain->count; i++)
 	{
-		XActual = tmc5160_readInt(tmc5160, TMC5160_XACTUAL);
-		// ToDo CHECK 2: API Compatibility - write alternative algorithm w/o floating point? (LH)
-		tmc5160->velocity = (uint32_t) ((float32_t) ((XActual - tmc5160->oldX) / (float32_t) tickDiff) * (float32_t) 1048.576);
+		uint8_t address = TMC_ADDRESS(addresses[i]);
+		uint8_t *datagram = &data[5 * (chain->count - 1 - i)];
 
-		tmc5160->oldX     = XActual;
-		tmc5160->oldTick  = tick;
+		captureStatus(chain->ics[i], datagram[0]);
+
+		// register not readable -> shadow register copy
+		if(!TMC_IS_READABLE(chain->ics[i]->registerAccess[address]))
+			values[i] = readShadow(chain->ics[i], address);
+		else
+			values[i] = tmc_unpackInt32(&datagram[1]);
 	}
 }
 
-// Rotate with a given velocity (to the right)
-void tmc5160_rotate(TMC5160TypeDef *tmc5160, int32_t velocity)
+// Sync batch
+// The datagrams are built when adding a write, so firing the batch only transfers them.
+
+void tmc5160_syncBatchInit(TMC5160SyncBatchTypeDef *batch)
 {
-	// Set absolute velocity
-	tmc5160_writeInt(tmc5160, TMC5160_VMAX, abs(velocity));
-	// Set direction
-	tmc5160_writeInt(tmc5160, TMC5160_RAMPMODE, (velocity >= 0) ? TMC5160_MODE_VELPOS : TMC5160_MODE_VELNEG);
+	batch->count[0]   = 0;
+	batch->count[1]   = 0;
+	batch->prepare    = 0;
+	batch->committed  = false;
 }
 
-// Rotate to the right
-void tmc5160_right(TMC5160TypeDef *tmc5160, uint32_t velocity)
+// Add a register write to the batch being prepared. Returns false if the batch is full.
+bool tmc5160_syncBatchAdd(TMC5160SyncBatchTypeDef *batch, TMC5160TypeDef *tmc5160, uint8_t address, int32_t value)
 {
-	tmc5160_rotate(tmc5160, velocity);
+	uint8_t *count = &batch->count[batch->prepare];
+	TMC5160SyncWriteTypeDef *write;
+
+	if(*count >= TMC5160_SYNC_BATCH_SIZE)
+		return false;
+
+	write = &batch->writes[batch->prepare][(*count)++];
+	write->ic           = tmc5160;
+	write->datagram[0]  = address | TMC5160_WRITE_BIT;
+	tmc_packInt32(&write->datagram[1], value);
+
+	return true;
 }
 
-// Rotate to the left
-void tmc5160_left(TMC5160TypeDef *tmc5160, uint32_t velocity)
+// Hand the prepared batch over to the next tmc5160_syncBatchFire() and start an empty one.
+// Returns false if the previously committed batch was not fired yet.
+bool tmc5160_syncBatchCommit(TMC5160SyncBatchTypeDef *batch)
 {
-	tmc5160_rotate(tmc5160, -velocity);
+	if(batch->committed)
+		return false;
+
+	batch->prepare ^= 1;
+	batch->count[batch->prepare] = 0;
+	batch->committed = true;
+
+	return true;
 }
 
-// Stop moving
-void tmc5160_stop(TMC5160TypeDef *tmc5160)
+// Send all writes of the committed batch. Call this from the event interrupt.
+// The shadow registers are updated here as well, so the application must not write
+// the same ICs from a lower priority context while a batch is committed.
+// Returns false if no batch was committed.
+bool tmc5160_syncBatchFire(TMC5160SyncBatchTypeDef *batch)
 {
-	tmc5160_rotate(tmc5160, 0);
+	uint8_t fire = batch->prepare ^ 1;
+
+	if(!batch->committed)
+		return false;
+
+	for(uint8_t i = 0; i < batch->count[fire]; i++)
+	{
+		TMC5160SyncWriteTypeDef *write = &batch->writes[fire][i];
+		TMC5160TypeDef *tmc5160 = write->ic;
+		uint8_t address = TMC_ADDRESS(write->datagram[0]);
+		// The transfer overwrites the data with the reply, keep the prepared datagram
+		uint8_t data[5] = { write->datagram[0], write->datagram[1], write->datagram[2], write->datagram[3], write->datagram[4] };
+
+		tmc5160_readWriteArray(tmc5160->config->channel, &data[0], 5);
+		captureStatus(tmc5160, data[0]);
+
+		writeShadow(tmc5160, address, tmc_unpackInt32(&write->datagram[1]));
+
+#ifdef TMC5160_READ_CACHE
+		TMCReadCacheEntry *entry = readCacheFind(tmc5160, address);
+		if(entry)
+			entry->valid = false;
+#endif
+	}
+
+	batch->committed = false;
+
+	return true;
 }
 
-// Move to a specified position with a given velocity
-void tmc5160_moveTo(TMC5160TypeDef *tmc5160, int32_t position, uint32_t velocityMax)
+#ifdef TMC5160_ASYNC
+static void writeIntAsyncComplete(void *context)
 {
-	tmc5160_writeInt(tmc5160, TMC5160_RAMPMODE, TMC5160_MODE_POSITION);
+	TMCAsyncRequestTypeDef *request = context;
+	TMC5160TypeDef *tmc5160 = request->ic;
 
-	// VMAX also holds the target velocity in velocity mode.
-	// Re-write the position mode maximum velocity here.
-	tmc5160_writeInt(tmc5160, TMC5160_VMAX, velocityMax);
+	writeShadow(tmc5160, request->address, request->value);
+	captureStatus(tmc5160, request->data[0]);
 
-	tmc5160_writeInt(tmc5160, TMC5160_XTARGET, position);
+	tmc_asyncFinish(request, TMC_ASYNC_DONE);
 }
 
-// Move by a given amount with a given velocity
-// This function will write the absolute target position to *ticks
-void tmc5160_moveBy(TMC5160TypeDef *tmc5160, int32_t *ticks, uint32_t velocityMax)
+// Non-blocking tmc5160_writeInt(). The shadow register is updated once the transfer completed.
+// Returns the request handle or NULL if [request] is still pending.
+TMCAsyncRequestTypeDef *tmc5160_writeIntAsync(TMC5160TypeDef *tmc5160, TMCAsyncRequestTypeDef *request, uint8_t address, int32_t value, tmc_async_callback callback, void *userData)
 {
-	// determine actual position and add numbers of ticks to move
-	*ticks += tmc5160_readInt(tmc5160, TMC5160_XACTUAL);
+	if(!tmc_asyncStart(request, tmc5160, tmc5160->config->channel, TMC_ADDRESS(address), value, callback, userData))
+		return NULL;
 
-	tmc5160_moveTo(tmc5160, *ticks, velocityMax);
+	request->data[0] = address | TMC5160_WRITE_BIT;
+	tmc_packInt32(&request->data[1], value);
+	tmc5160_readWriteArrayAsync(request->channel, &request->data[0], 5, writeIntAsyncComplete, request);
+
+	return request;
 }
 
-uint8_t tmc5160_consistencyCheck(TMC5160TypeDef *tmc5160)
+static void readIntAsyncComplete(void *context)
 {
-	// Config has not yet been written -> it cant be consistent
-	if(tmc5160->config->state != CONFIG_READY)
-		return 0;
+	TMCAsyncRequestTypeDef *request = context;
+	uint8_t *data = &request->data[0];
 
-	// Check constant shadow registers consistent with actual registers
-	for(size_t i = 0; i < TMC5160_REGISTER_COUNT; i++)
-		if(tmc5160->config->shadowRegister[i] != tmc5160_readInt(tmc5160, i))
-			return 1;
+	// The reply to the read request is sent with the second datagram
+	if(request->step++ == 0)
+	{
+		data[0] = request->address;
+		data[1] = data[2] = data[3] = data[4] = 0;
+		tmc5160_readWriteArrayAsync(request->channel, data, 5, readIntAsyncComplete, request);
+		return;
+	}
 
-	// No inconsistency detected
-	return 0;
+	request->value = tmc_unpackInt32(&data[1]);
+	captureStatus((TMC5160TypeDef *) request->ic, data[0]);
+	tmc_asyncFinish(request, TMC_ASYNC_DONE);
 }
+
+// Non-blocking tmc5160_readInt(). The value is stored in request->value once the request is done.
+// Registers that are not readable complete immediately with the shadow register value.
+// Returns the request handle or NULL if [request] is still pending.
+TMCAsyncRequestTypeDef *tmc5160_readIntAsync(TMC5160TypeDef *tmc5160, TMCAsyncRequestTypeDef *request, uint8_t address, tmc_async_callback callback, void *userData)
+{
+	address = TMC_ADDRESS(address);
+
+	if(!tmc_asyncStart(request, tmc5160, tmc5160->config->channel, address, 0, callback, userData))
+		return NULL;
+
+	// register not readable -> shadow register copy
+	if(!TMC_IS_READABLE(tmc5160->registerAccess[address]))
+	{
+		request->value = readShadow(tmc5160, address);
+		tmc_asyncFinish(request, TMC_ASYNC_DONE);
+		return request;
+	}
+
+	request->data[0] = address;
+	request->data[1] = request->data[2] = request->data[3] = request->data[4] = 0;
+	tmc5160_readWriteArrayAsync(request->channel, &request->data[0], 5, readIntAsyncComplete, request);
+
+	return request;
+}
+#endif
+
+// Initialize a TMC5160 IC.
+// This function requires:
+//     - tmc5160: The pointer to a TMC5160TypeDef struct, which represents one IC
+//     - channel: The channel index, which will be sent back in the SPI callback
+//     - config: A ConfigurationTypeDef struct, which will be used by the IC
+//     - registerResetState: An int32_t array with 128 elements. This holds the values to be used for a reset.
+void tmc5160_init(TMC5160TypeDef *tmc5160, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
+{
+	tmc_units_init(&tmc5160->units, TMC_UNITS_DEFAULT_CLOCK);
+
+#if TMC_FEATURE_VELOCITY_ESTIMATE
+	tmc5160->velocity        = 0;
+	tmc5160->oldTick         = 0;
+	tmc5160->oldX            = 0;
+	tmc5160->velocitySource  = TMC_VELOCITY_SOURCE_ESTIMATE;
+#ifdef TMC_SAMPLE_TIMESTAMP
+	tmc5160->oldSampleTime   = 0;
+#endif
+#endif
+#ifdef TMC_SAMPLE_TIMESTAMP
+	tmc5160->sampleTime      = 0;
+#endif
+
+	tmc5160->gstat      = 0;
+	tmc5160->rampStat   = 0;
+	tmc5160->drvStatus  = 0;
+
+#if TMC_FEATURE_TELEMETRY
+	tmc_snapshot_init(&tmc5160->telemetry);
+	tmc5160->telemetryTick      = 0;
+	tmc5160->telemetryInterval  = 0;
+	tmc5160->telemetryIdleInterval = 0;
+	tmc5160->telemetryActive    = true;
+#endif
+
+#if TMC_FEATURE_CONSISTENCY
+	tmc5160->consistencyIndex   = 0;
+	tmc5160->consistencyBudget  = 0;
+	tmc5160->inconsistent       = false;
+#endif
+
+#if TMC_FEATURE_VIEW
+	tmc5160->view = NULL;
+#endif
+
+#if TMC_FEATURE_SPI_STATUS
+	tmc5160->spiStatus.status    = 0;
+	tmc5160->spiStatus.edgeMask  = 0;
+	tmc5160->spiStatus.valid     = false;
+	tmc5160->spiStatus.tick      = 0;
+	tmc5160->spiStatus.callback  = NULL;
+#endif
+
+	tmc5160->config               = config;
+	tmc5160->config->callback     = NULL;
+	tmc5160->config->channel      = channel;
+	tmc5160->config->configIndex   = 0;
+	tmc5160->config->powerOnReset  = false;
+	tmc5160->config->state         = CONFIG_READY;
+#if TMC_FEATURE_SHADOW && defined(TMC_SHADOW_SPARSE)
+	tmc5160->config->shadowIndex  = tmc5160_shadowIndex;
+#endif
+
+	size_t i;
+	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+	{
+#ifndef TMC_DIRTY_BITMAP
+		tmc5160->registerAccess[i]      = tmc5160_defaultRegisterAccess[i];
+#endif
+#if TMC_FEATURE_CONFIG && !defined(TMC_RESET_STATE_CONST)
+		tmc5160->registerResetState[i]  = registerResetState[i];
+#endif
+	}
+
+#if !TMC_FEATURE_CONFIG
+	UNUSED(registerResetState);
+#elif defined(TMC_RESET_STATE_CONST)
+	tmc_resetState_init(&tmc5160->registerResetState, registerResetState);
+#endif
+
+#ifdef TMC_DIRTY_BITMAP
+	tmc5160->registerAccess = tmc5160_defaultRegisterAccess;
+	tmc_dirtyClearAll(tmc5160->dirty);
+#endif
+
+#ifdef TMC5160_READ_CACHE
+	tmc5160->registerMaxAge  = tmc5160_defaultRegisterMaxAge;
+	tmc5160->cacheTick       = 0;
+	for(i = 0; i < TMC5160_READ_CACHE_SIZE; i++)
+		tmc5160->readCache[i].valid = false;
+#endif
+}
+
+#if TMC_FEATURE_SHADOW
+// Fill the shadow registers of hardware preset non-readable registers
+// Only needed if you want to 'read' those registers e.g to display the value
+// in the TMCL IDE register browser
+void tmc5160_fillShadowRegisters(TMC5160TypeDef *tmc5160)
+{
+#ifdef TMC_DIRTY_BITMAP
+	tmc_fillShadowRegisters(tmc5160->config, tmc5160->registerAccess, tmc5160->dirty,
+			tmc5160_RegisterConstants, ARRAY_SIZE(tmc5160_RegisterConstants));
+#else
+	tmc_fillShadowRegisters(tmc5160->config, tmc5160->registerAccess, NULL,
+			tmc5160_RegisterConstants, ARRAY_SIZE(tmc5160_RegisterConstants));
+#endif
+}
+#endif
+
+#if TMC_FEATURE_CONFIG
+// Reset the TMC5160.
+uint8_t tmc5160_reset(TMC5160TypeDef *tmc5160)
+{
+	if(tmc5160->config->state != CONFIG_READY)
+		return false;
+
+	// Reset the dirty bits and wipe the shadow registers
+	size_t i;
+	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+	{
+#ifndef TMC_DIRTY_BITMAP
+		tmc5160->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+#endif
+#ifndef TMC_SHADOW_SPARSE
+		tmc5160->config->shadowRegister[i] = 0;
+#endif
+	}
+
+#ifdef TMC_SHADOW_SPARSE
+	for(size_t i = 0; i < TMC5160_SHADOW_SLOTS; i++)
+		tmc5160->config->shadowSlots[i] = 0;
+#endif
+
+#ifdef TMC_DIRTY_BITMAP
+	tmc_dirtyClearAll(tmc5160->dirty);
+#endif
+
+	tmc5160->config->state         = CONFIG_RESET;
+	tmc5160->config->configIndex   = 0;
+	tmc5160->config->powerOnReset  = false;
+
+	return true;
+}
+
+// Reset the TMC5160 after it has been powered up.
+// Only the registers differing from their power-on value are written.
+// Use tmc5160_reset() if the IC may have been configured since.
+uint8_t tmc5160_resetFromPowerOn(TMC5160TypeDef *tmc5160)
+{
+	if(!tmc5160_reset(tmc5160))
+		return false;
+
+	tmc5160->config->powerOnReset = true;
+
+	return true;
+}
+
+// Restore the TMC5160 to the state stored in the shadow registers.
+// This can be used to recover the IC configuration after a VM power loss.
+uint8_t tmc5160_restore(TMC5160TypeDef *tmc5160)
+{
+	if(tmc5160->config->state != CONFIG_READY)
+		return false;
+
+	tmc5160->config->state        = CONFIG_RESTORE;
+	tmc5160->config->configIndex  = 0;
+
+	return true;
+}
+
+// Change the values the IC will be configured with when performing a reset.
+void tmc5160_setRegisterResetState(TMC5160TypeDef *tmc5160, const int32_t *resetState)
+{
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_setAll(&tmc5160->registerResetState, resetState, TMC5160_REGISTER_COUNT);
+#else
+	size_t i;
+	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+	{
+		tmc5160->registerResetState[i] = resetState[i];
+	}
+#endif
+}
+
+// Change the reset values to the default reset table plus a constant diff list,
+// e.g. composed from fields at compile time with TMC_RESET_OVERRIDE() (see
+// tmc/helpers/ResetState.h). With TMC_RESET_STATE_CONST the list is not copied
+// and has to stay valid.
+void tmc5160_setRegisterResetDiff(TMC5160TypeDef *tmc5160, const TMCRegisterConstant *diff, size_t count)
+{
+#ifdef TMC_RESET_STATE_CONST
+	tmc_resetState_init(&tmc5160->registerResetState, tmc5160_defaultRegisterResetState);
+	tmc_resetState_setDiff(&tmc5160->registerResetState, diff, count);
+#else
+	size_t i;
+
+	tmc5160_setRegisterResetState(tmc5160, tmc5160_defaultRegisterResetState);
+
+	for(i = 0; i < count; i++)
+		tmc5160->registerResetState[TMC_ADDRESS(diff[i].address)] = (int32_t) diff[i].value;
+#endif
+}
+
+// Change the reset values to the default reset table plus the values of a
+// reset state blob (see tmc/helpers/RegisterImage.h), e.g. stored in flash.
+// Returns false if the blob is invalid, the reset state is unchanged then.
+uint8_t tmc5160_loadRegisterResetState(TMC5160TypeDef *tmc5160, const uint8_t *blob, size_t size)
+{
+#ifdef TMC_RESET_STATE_CONST
+	return tmc_resetBlob_load(blob, size, TMC5160_IMAGE_ID, &tmc5160->registerResetState, TMC5160_REGISTER_COUNT);
+#else
+	if(!tmc_resetBlob_check(blob, size, TMC5160_IMAGE_ID, TMC5160_REGISTER_COUNT))
+		return false;
+
+	tmc5160_setRegisterResetState(tmc5160, tmc5160_defaultRegisterResetState);
+
+	return tmc_resetBlob_apply(blob, size, TMC5160_IMAGE_ID, tmc5160->registerResetState, TMC5160_REGISTER_COUNT);
+#endif
+}
+
+// Register a function to be called after completion of the configuration mechanism
+void tmc5160_setCallback(TMC5160TypeDef *tmc5160, tmc5160_callback callback)
+{
+	tmc5160->config->callback = (tmc_callback_config) callback;
+}
+
+// Reset value of the given register
+static int32_t resetValue(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+#ifdef TMC_RESET_STATE_CONST
+	return tmc_resetState_get(&tmc5160->registerResetState, address);
+#else
+	return tmc5160->registerResetState[address];
+#endif
+}
+
+// Helper function: Next register write of the running configuration.
+// Advances the configuration index, returns false once all registers are written.
+static bool nextConfiguration(TMC5160TypeDef *tmc5160, uint8_t *address, int32_t *value)
+{
+	uint8_t *ptr = &tmc5160->config->configIndex;
+	const uint8_t *registers;
+	size_t registerCount;
+
+	if(tmc5160->config->state == CONFIG_RESTORE)
+	{
+#ifdef TMC_DIRTY_BITMAP
+		// Only the registers written since the last reset are restored,
+		// the configuration index holds the next address to check.
+		int32_t next = tmc_dirtyNext(tmc5160->dirty, *ptr);
+
+		if(next < 0)
+			return false;
+
+		*address  = next;
+		*value    = TMC_SHADOW_REGISTER(tmc5160->config, next);
+		*ptr      = next + 1;
+		return true;
+#else
+		registers      = tmc5160_restorableRegisters;
+		registerCount  = ARRAY_SIZE(tmc5160_restorableRegisters);
+		// Skip hardware preset registers that have not been written yet
+		while((*ptr < registerCount) && !TMC_IS_RESTORABLE(tmc5160->registerAccess[registers[*ptr]]))
+		{
+			(*ptr)++;
+		}
+#endif
+	}
+	else
+	{
+		registers      = tmc5160_resettableRegisters;
+		registerCount  = ARRAY_SIZE(tmc5160_resettableRegisters);
+		// Skip registers the IC already holds after powering up
+		while(tmc5160->config->powerOnReset && (*ptr < registerCount)
+				&& (resetValue(tmc5160, registers[*ptr]) == (int32_t) tmc_getRegisterConstant(tmc5160_powerOnRegisters, ARRAY_SIZE(tmc5160_powerOnRegisters), registers[*ptr])))
+		{
+			TMC_SHADOW_REGISTER(tmc5160->config, registers[*ptr]) = resetValue(tmc5160, registers[*ptr]);
+			(*ptr)++;
+		}
+	}
+
+	if(*ptr >= registerCount)
+		return false;
+
+	*address = registers[*ptr];
+	*value = (tmc5160->config->state == CONFIG_RESTORE)
+			? TMC_SHADOW_REGISTER(tmc5160->config, *address)
+			: resetValue(tmc5160, *address);
+	(*ptr)++;
+
+	return true;
+}
+
+// Helper function: Finish the configuration
+static void finishConfiguration(TMC5160TypeDef *tmc5160)
+{
+	if(tmc5160->config->callback)
+	{
+		((tmc5160_callback)tmc5160->config->callback)(tmc5160, tmc5160->config->state);
+	}
+
+	tmc5160->config->state = CONFIG_READY;
+}
+
+// Helper function: Configure the next register.
+static void writeConfiguration(TMC5160TypeDef *tmc5160)
+{
+	uint8_t address;
+	int32_t value;
+
+	if(nextConfiguration(tmc5160, &address, &value))
+		tmc5160_writeInt(tmc5160, address, value);
+	else
+		finishConfiguration(tmc5160);
+}
+
+#ifdef TMC5160_ASYNC
+// Start the next configuration write with the async transport, see ConfigEngine.h.
+// Returns false if the configuration is complete and nothing was started.
+// A still pending [request] counts as running configuration.
+bool tmc5160_configureStepAsync(TMC5160TypeDef *tmc5160, TMCAsyncRequestTypeDef *request)
+{
+	uint8_t address;
+	int32_t value;
+
+	if(request->state == TMC_ASYNC_PENDING)
+		return true;
+
+	if(tmc5160->config->state == CONFIG_READY)
+		return false;
+
+	if(!nextConfiguration(tmc5160, &address, &value))
+	{
+		finishConfiguration(tmc5160);
+		return false;
+	}
+
+	return tmc5160_writeIntAsync(tmc5160, request, address, value, NULL, NULL) != NULL;
+}
+#endif
+#endif
+
+// Set the clock frequency [Hz] of the IC, 16 MHz by default. The velocity
+// estimate of the periodic job and the conversions in tmc5160->units use it.
+void tmc5160_setClockFrequency(TMC5160TypeDef *tmc5160, uint32_t clockFrequency)
+{
+	tmc_units_init(&tmc5160->units, clockFrequency);
+}
+
+#if TMC_FEATURE_VELOCITY_ESTIMATE
+// Select the value of tmc5160->velocity, updated every 5 ticks by the periodic job:
+// TMC_VELOCITY_SOURCE_ESTIMATE differentiates XACTUAL (default), TMC_VELOCITY_SOURCE_VACTUAL
+// reads the exact velocity of the ramp generator. TMC_VELOCITY_SOURCE_NONE leaves the velocity
+// at 0 and costs no bus access, for applications not using it.
+void tmc5160_setVelocitySource(TMC5160TypeDef *tmc5160, TMCVelocitySource source)
+{
+	tmc5160->velocitySource  = source;
+	tmc5160->velocity        = 0;
+}
+#endif
+
+#if TMC_FEATURE_SPI_STATUS
+// SPI_STATUS of the last reply (TMC_SPI_STATUS_* flags), taken from the transfers
+// that happen anyway. Flags like the reset flag or standstill can be checked this
+// way without reading GSTAT or RAMP_STAT. [tick] receives the capture time, may be NULL.
+// Returns 0 before the first transfer.
+uint8_t tmc5160_getSpiStatus(TMC5160TypeDef *tmc5160, uint32_t *tick)
+{
+	if(tick)
+		*tick = tmc5160->spiStatus.tick;
+
+	return tmc5160->spiStatus.status;
+}
+
+// Call [callback] from the transfer that captures a set flag of [edgeMask], e.g.
+// TMC_SPI_STATUS_RESET_FLAG to restore the configuration after a reset of the IC.
+// The callback runs in the context of the transfer and must not access the IC.
+void tmc5160_setSpiStatusCallback(TMC5160TypeDef *tmc5160, tmc_spi_statusCallback callback, uint8_t edgeMask)
+{
+	tmc5160->spiStatus.callback  = callback;
+	tmc5160->spiStatus.edgeMask  = edgeMask;
+}
+#endif
+
+// Real-time part of the periodic job: velocity and telemetry capture, no configuration work.
+// Nothing is done while a reset or restore is running. Worst case per call:
+//   velocity   1 register read, every 5 ticks (not with TMC_VELOCITY_SOURCE_NONE)
+//   telemetry  1 batch read of TMC5160_TELEMETRY_COUNT registers, every telemetryInterval ticks
+//              (telemetryIdleInterval ticks at standstill, if set)
+// Calling both parts from different priorities needs TMC_LOCKING, see Lock.h.
+void tmc5160_periodicJobFast(TMC5160TypeDef *tmc5160, uint32_t tick)
+{
+#ifdef TMC5160_READ_CACHE
+	tmc5160->cacheTick = tick;
+#endif
+
+#if TMC_FEATURE_CONFIG
+	if(tmc5160->config->state != CONFIG_READY)
+		return;
+#endif
+
+#if TMC_FEATURE_VELOCITY_ESTIMATE
+	int32_t XActual;
+	uint32_t tickDiff;
+
+	if((tmc5160->velocitySource != TMC_VELOCITY_SOURCE_NONE) && ((tickDiff = tick - tmc5160->oldTick) >= 5))
+	{
+		if(tmc5160->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL)
+		{
+			tmc5160->velocity = CAST_Sn_TO_S32(tmc5160_readInt(tmc5160, TMC5160_VACTUAL), 24);
+		}
+		else
+		{	// Calculate velocity v = dx/dt
+			XActual = tmc5160_readInt(tmc5160, TMC5160_XACTUAL);
+#ifdef TMC_SAMPLE_TIMESTAMP
+			// Differentiate over the sampling instants, the scale is per millisecond
+			tmc5160->velocity = tmc_estimateVelocityScaled(XActual - tmc5160->oldX, tmc5160->sampleTime - tmc5160->oldSampleTime,
+					tmc5160->units.velocityScale / TMC_SAMPLE_TIMESTAMP_PER_MS);
+			tmc5160->oldSampleTime = tmc5160->sampleTime;
+#else
+			tmc5160->velocity = tmc_estimateVelocityScaled(XActual - tmc5160->oldX, tickDiff, tmc5160->units.velocityScale);
+#endif
+			tmc5160->oldX = XActual;
+		}
+
+		tmc5160->oldTick = tick;
+	}
+#endif
+
+#if TMC_FEATURE_TELEMETRY
+	if(tmc5160->telemetryInterval)
+	{
+		uint32_t interval = tmc5160->telemetryInterval;
+
+#if TMC_FEATURE_SPI_STATUS
+		// The status of the transfers in between shows motion and driver errors for free
+		if(tmc5160->spiStatus.valid
+		&& (!(tmc5160->spiStatus.status & TMC_SPI_STATUS_STANDSTILL) || (tmc5160->spiStatus.status & TMC_SPI_STATUS_DRIVER_ERROR)))
+			tmc5160->telemetryActive = true;
+#endif
+
+		if(!tmc5160->telemetryActive && tmc5160->telemetryIdleInterval)
+			interval = tmc5160->telemetryIdleInterval;
+
+		// One capture serves all readers
+		if((tick - tmc5160->telemetryTick) >= interval)
+		{
+			int32_t values[TMC5160_TELEMETRY_COUNT];
+
+			tmc5160_readIntBatch(tmc5160, tmc5160_telemetryRegisters, values, TMC5160_TELEMETRY_COUNT);
+#ifdef TMC_SAMPLE_TIMESTAMP
+			tmc_snapshot_publishStamped(&tmc5160->telemetry, values, TMC5160_TELEMETRY_COUNT, tick, tmc5160->sampleTime);
+#else
+			tmc_snapshot_publish(&tmc5160->telemetry, values, TMC5160_TELEMETRY_COUNT, tick);
+#endif
+			tmc5160->telemetryTick = tick;
+
+			// Back off once the ramp generator reached zero velocity and the motor stands still
+			tmc5160->telemetryActive = !(values[TMC5160_TELEMETRY_RAMPSTAT] & TMC5160_VZERO_MASK)
+					|| !(values[TMC5160_TELEMETRY_DRVSTATUS] & TMC5160_STST_MASK);
+		}
+	}
+#endif
+
+	UNUSED(tmc5160);
+	UNUSED(tick);
+}
+
+// Background part of the periodic job: reset/restore and consistency check. Worst case per call:
+//   configuration  1 register write while a reset or restore is running, nothing else then
+//   consistency    consistencyBudget register reads in up to 2 batch reads
+TMCConfigStatus tmc5160_periodicJobBackground(TMC5160TypeDef *tmc5160, uint32_t tick)
+{
+#ifdef TMC5160_READ_CACHE
+	tmc5160->cacheTick = tick;
+#endif
+
+#if TMC_FEATURE_CONFIG
+	if(tmc5160->config->state != CONFIG_READY)
+	{
+		writeConfiguration(tmc5160);
+		return TMC_CONFIG_STATUS(tmc5160->config);
+	}
+#endif
+
+#if TMC_FEATURE_CONSISTENCY
+	// Continuous brownout detection at a fixed bus load
+	if(tmc5160->consistencyBudget && tmc5160_consistencyCheckStep(tmc5160, tmc5160->consistencyBudget))
+		tmc5160->inconsistent = true;
+#endif
+
+	UNUSED(tmc5160);
+	UNUSED(tick);
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Call this periodically. Runs tmc5160_periodicJobBackground() and, once no
+// configuration is running, tmc5160_periodicJobFast().
+TMCConfigStatus tmc5160_periodicJob(TMC5160TypeDef *tmc5160, uint32_t tick)
+{
+	TMCConfigStatus status = tmc5160_periodicJobBackground(tmc5160, tick);
+
+	if(status == TMC_CONFIG_STATUS_READY)
+		tmc5160_periodicJobFast(tmc5160, tick);
+
+	return status;
+}
+
+#if TMC_FEATURE_CONFIG
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc5160_configureBurst(TMC5160TypeDef *tmc5160, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc5160->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		writeConfiguration(tmc5160);
+	}
+
+	return (tmc5160->config->state == CONFIG_READY);
+}
+
+// Save the registers written since the last reset to [image], e.g. for storing it in flash.
+// Returns the size of the image, 0 if [size] is too small (see TMC_IMAGE_SIZE).
+size_t tmc5160_saveImage(TMC5160TypeDef *tmc5160, uint8_t *image, size_t size)
+{
+#ifdef TMC_DIRTY_BITMAP
+	return tmc_image_save(tmc5160->config, tmc5160->registerAccess, tmc5160->dirty,
+			TMC5160_REGISTER_COUNT, TMC5160_IMAGE_ID, image, size);
+#else
+	return tmc_image_save(tmc5160->config, tmc5160->registerAccess, NULL,
+			TMC5160_REGISTER_COUNT, TMC5160_IMAGE_ID, image, size);
+#endif
+}
+
+// Start a restore from a saved image, e.g. after an MCU reset.
+// Registers not contained in the image are restored with their reset values.
+// The restore is run by tmc5160_periodicJob() or at once with tmc5160_configureBurst(tmc5160, 0).
+// Returns false if the image is invalid or a configuration is already running.
+uint8_t tmc5160_restoreImage(TMC5160TypeDef *tmc5160, const uint8_t *image, size_t size)
+{
+	size_t i;
+
+	if(tmc5160->config->state != CONFIG_READY)
+		return false;
+
+	if(!tmc_image_check(image, size, TMC5160_IMAGE_ID, TMC5160_REGISTER_COUNT))
+		return false;
+
+	for(i = 0; i < ARRAY_SIZE(tmc5160_resettableRegisters); i++)
+		TMC_SHADOW_REGISTER(tmc5160->config, tmc5160_resettableRegisters[i]) = resetValue(tmc5160, tmc5160_resettableRegisters[i]);
+
+#ifdef TMC_DIRTY_BITMAP
+	tmc_dirtyClearAll(tmc5160->dirty);
+	tmc_image_load(image, size, TMC5160_IMAGE_ID, tmc5160->config, NULL, tmc5160->dirty, TMC5160_REGISTER_COUNT);
+#else
+	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+		tmc5160->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+	tmc_image_load(image, size, TMC5160_IMAGE_ID, tmc5160->config, tmc5160->registerAccess, NULL, TMC5160_REGISTER_COUNT);
+#endif
+
+	return tmc5160_restore(tmc5160);
+}
+
+// Registers read back by tmc5160_adopt() per pipelined batch
+#define ADOPT_BATCH_SIZE 16
+
+// Take over an IC that kept its configuration while only the MCU was reset
+// (watchdog, firmware update), instead of configuring it again. Nothing is written
+// to the IC, so a running motion or the holding current is not interrupted.
+// GSTAT is read first: With the reset flag set, the IC lost its configuration and
+// nothing is adopted, use tmc5160_reset() or tmc5160_restoreImage() then. The
+// application therefore has to clear the reset flag once the IC is configured.
+// The readable configuration registers are read into the shadow registers with
+// pipelined reads and marked dirty, so a later restore writes them back. Write-only
+// registers can not be read: Their shadow values are taken from [image] (see
+// tmc5160_saveImage()), or are the reset values if [image] is NULL or invalid.
+// Returns false if the IC was reset or a configuration is running.
+uint8_t tmc5160_adopt(TMC5160TypeDef *tmc5160, const uint8_t *image, size_t size)
+{
+	uint8_t addresses[ADOPT_BATCH_SIZE];
+	int32_t values[ADOPT_BATCH_SIZE];
+	size_t count = 0;
+	size_t i, j;
+
+	if(tmc5160->config->state != CONFIG_READY)
+		return false;
+
+	if(tmc5160_readInt(tmc5160, TMC5160_GSTAT) & TMC5160_RESET_MASK)
+		return false;
+
+	for(i = 0; i < ARRAY_SIZE(tmc5160_resettableRegisters); i++)
+		TMC_SHADOW_REGISTER(tmc5160->config, tmc5160_resettableRegisters[i]) = resetValue(tmc5160, tmc5160_resettableRegisters[i]);
+
+#ifdef TMC_DIRTY_BITMAP
+	tmc_dirtyClearAll(tmc5160->dirty);
+	if(image)
+		tmc_image_load(image, size, TMC5160_IMAGE_ID, tmc5160->config, NULL, tmc5160->dirty, TMC5160_REGISTER_COUNT);
+#else
+	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+		tmc5160->registerAccess[i] &= ~TMC_ACCESS_DIRTY;
+	if(image)
+		tmc_image_load(image, size, TMC5160_IMAGE_ID, tmc5160->config, tmc5160->registerAccess, NULL, TMC5160_REGISTER_COUNT);
+#endif
+
+	// Plain read/write registers read back the written value
+	for(i = 0; i < TMC5160_REGISTER_COUNT; i++)
+	{
+		uint8_t access = tmc5160->registerAccess[i];
+
+		if(TMC_IS_READABLE(access) && TMC_IS_WRITABLE(access) && !(access & (TMC_ACCESS_RW_SPECIAL | TMC_ACCESS_FLAGS)))
+			addresses[count++] = i;
+
+		if((count < ADOPT_BATCH_SIZE) && (i + 1 < TMC5160_REGISTER_COUNT))
+			continue;
+
+		tmc5160_readIntBatch(tmc5160, addresses, values, count);
+
+		for(j = 0; j < count; j++)
+		{
+			TMC_SHADOW_REGISTER(tmc5160->config, addresses[j]) = values[j];
+
+			// Positions are changed by the IC itself, a restore must not write them back
+			if((addresses[j] != TMC5160_XACTUAL) && (addresses[j] != TMC5160_XENC))
+				markDirty(tmc5160, addresses[j]);
+		}
+
+		count = 0;
+	}
+
+	return true;
+}
+
+// Restore the configuration only if the IC actually lost it.
+// Uses the GSTAT value of the last tmc5160_onInterrupt(), so the check costs no
+// extra access during routine status polling. A reset flag always restores.
+// An undervoltage flag alone (VM dip) does not clear the registers in most cases,
+// GCONF and CHOPCONF are read back and compared to the shadow registers to confirm.
+// The flags are consumed by the call.
+// Returns true if a restore was started.
+uint8_t tmc5160_restoreIfLost(TMC5160TypeDef *tmc5160)
+{
+	static const uint8_t sentinels[] = { TMC5160_GCONF, TMC5160_CHOPCONF };
+	int32_t values[ARRAY_SIZE(sentinels)];
+	int32_t gstat = tmc5160->gstat;
+	size_t i;
+
+	tmc5160->gstat &= ~(TMC5160_RESET_MASK | TMC5160_UV_CP_MASK);
+
+	if(gstat & TMC5160_RESET_MASK)
+		return tmc5160_restore(tmc5160);
+
+	if(!(gstat & TMC5160_UV_CP_MASK))
+		return false;
+
+	tmc5160_readIntBatch(tmc5160, sentinels, values, ARRAY_SIZE(sentinels));
+
+	for(i = 0; i < ARRAY_SIZE(sentinels); i++)
+	{
+		if(values[i] != TMC_SHADOW_REGISTER(tmc5160->config, sentinels[i]))
+			return tmc5160_restore(tmc5160);
+	}
+
+	return false;
+}
+#endif
+
+// Event driven status
+// Route events to the DIAG0/DIAG1 pins with the diag* fields of GCONF and call this
+// from the GPIO interrupt instead of polling the status registers periodically.
+// GSTAT, RAMP_STAT and DRV_STATUS are read in one pipelined burst, only the flags
+// found set are written back to clear them. With TMC_VELOCITY_SOURCE_VACTUAL the burst
+// also updates the velocity.
+// Returns true if a latched flag of GSTAT or RAMP_STAT was set.
+uint8_t tmc5160_onInterrupt(TMC5160TypeDef *tmc5160)
+{
+	static const uint8_t addresses[] = { TMC5160_GSTAT, TMC5160_RAMPSTAT, TMC5160_DRVSTATUS, TMC5160_VACTUAL };
+	int32_t values[ARRAY_SIZE(addresses)];
+	size_t count = ARRAY_SIZE(addresses) - 1;
+	uint8_t pending = false;
+
+#if TMC_FEATURE_TELEMETRY
+	// DIAG events switch the telemetry back to the fast rate
+	tmc5160->telemetryActive = true;
+#endif
+
+#if TMC_FEATURE_VELOCITY_ESTIMATE
+	// The velocity from VACTUAL is read along with the status
+	if(tmc5160->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL)
+		count++;
+#endif
+
+	tmc5160_readIntBatch(tmc5160, addresses, values, count);
+
+	tmc5160->gstat      = values[0];
+	tmc5160->rampStat   = values[1];
+	tmc5160->drvStatus  = values[2];
+
+#if TMC_FEATURE_VELOCITY_ESTIMATE
+	if(count == ARRAY_SIZE(addresses))
+		tmc5160->velocity = CAST_Sn_TO_S32(values[3], 24);
+#endif
+
+	if(values[0] & TMC5160_GSTAT_EVENTS)
+	{
+		tmc5160_writeInt(tmc5160, TMC5160_GSTAT, values[0] & TMC5160_GSTAT_EVENTS);
+		pending = true;
+	}
+
+	if(values[1] & TMC5160_RAMPSTAT_EVENTS)
+	{
+		tmc5160_writeInt(tmc5160, TMC5160_RAMPSTAT, values[1] & TMC5160_RAMPSTAT_EVENTS);
+		pending = true;
+	}
+
+	return pending;
+}
+
+// Rotate with a given velocity (to the right)
+void tmc5160_rotate(TMC5160TypeDef *tmc5160, int32_t velocity)
+{
+	// Set absolute velocity
+	tmc5160_writeInt(tmc5160, TMC5160_VMAX, abs(velocity));
+	// Set direction
+	tmc5160_writeInt(tmc5160, TMC5160_RAMPMODE, (velocity >= 0) ? TMC5160_MODE_VELPOS : TMC5160_MODE_VELNEG);
+}
+
+// Rotate to the right
+void tmc5160_right(TMC5160TypeDef *tmc5160, uint32_t velocity)
+{
+	tmc5160_rotate(tmc5160, velocity);
+}
+
+// Rotate to the left
+void tmc5160_left(TMC5160TypeDef *tmc5160, uint32_t velocity)
+{
+	tmc5160_rotate(tmc5160, -velocity);
+}
+
+// Stop moving
+void tmc5160_stop(TMC5160TypeDef *tmc5160)
+{
+	tmc5160_rotate(tmc5160, 0);
+}
+
+// Move to a specified position with a given velocity
+void tmc5160_moveTo(TMC5160TypeDef *tmc5160, int32_t position, uint32_t velocityMax)
+{
+	tmc5160_writeInt(tmc5160, TMC5160_RAMPMODE, TMC5160_MODE_POSITION);
+
+	// VMAX also holds the target velocity in velocity mode.
+	// Re-write the position mode maximum velocity here.
+	tmc5160_writeInt(tmc5160, TMC5160_VMAX, velocityMax);
+
+	tmc5160_writeInt(tmc5160, TMC5160_XTARGET, position);
+}
+
+// Move by a given amount with a given velocity
+// This function will write the absolute target position to *ticks
+void tmc5160_moveBy(TMC5160TypeDef *tmc5160, int32_t *ticks, uint32_t velocityMax)
+{
+	// determine actual position and add numbers of ticks to move
+	*ticks += tmc5160_readInt(tmc5160, TMC5160_XACTUAL);
+
+	tmc5160_moveTo(tmc5160, *ticks, velocityMax);
+}
+
+// Helper function: Velocity mode reversal or positioning towards the retarget target
+static bool retargetStep(TMC5160TypeDef *tmc5160, TMCRetargetTypeDef *retarget)
+{
+	static const uint8_t addresses[] = { TMC5160_XACTUAL, TMC5160_VACTUAL };
+	int32_t values[ARRAY_SIZE(addresses)];
+	int8_t direction;
+
+	tmc5160_readIntBatch(tmc5160, addresses, values, ARRAY_SIZE(addresses));
+	direction = tmc_planRetarget(values[0], CAST_Sn_TO_S32(values[1], 24), retarget->target, tmc5160_readInt(tmc5160, TMC5160_DMAX));
+
+	if(direction == 0)
+	{
+		tmc5160_moveTo(tmc5160, retarget->target, retarget->velocityMax);
+		retarget->direction = 0;
+		return false;
+	}
+
+	if(direction != retarget->direction)
+	{
+		tmc5160_rotate(tmc5160, direction * (int32_t) retarget->velocityMax);
+		retarget->direction = direction;
+	}
+
+	return true;
+}
+
+// Move to [position], also during a motion. A target behind the motor, or one it can not
+// stop at in time, is approached with a direct reversal in velocity mode instead of the
+// positioning mode stop (see tmc_planRetarget()). Call tmc5160_retargetService() until it
+// returns false, it switches to the positioning mode once the motor moves towards the target.
+// Returns true if a reversal was started.
+bool tmc5160_retarget(TMC5160TypeDef *tmc5160, TMCRetargetTypeDef *retarget, int32_t position, uint32_t velocityMax)
+{
+	retarget->target       = position;
+	retarget->velocityMax  = velocityMax;
+	retarget->direction    = 0;
+
+	return retargetStep(tmc5160, retarget);
+}
+
+// Returns true while the reversal is running
+bool tmc5160_retargetService(TMC5160TypeDef *tmc5160, TMCRetargetTypeDef *retarget)
+{
+	if(retarget->direction == 0)
+		return false;
+
+	return retargetStep(tmc5160, retarget);
+}
+
+// Write the ramp parameters of a planned profile, see tmc_planRampProfile().
+// VMAX is written by the following move: tmc5160_moveTo(tmc5160, position, profile->vMax)
+void tmc5160_writeRampProfile(TMC5160TypeDef *tmc5160, const TMCRampProfileTypeDef *profile)
+{
+	tmc5160_writeInt(tmc5160, TMC5160_VSTART, profile->vStart);
+	tmc5160_writeInt(tmc5160, TMC5160_A1, profile->a1);
+	tmc5160_writeInt(tmc5160, TMC5160_V1, profile->v1);
+	tmc5160_writeInt(tmc5160, TMC5160_AMAX, profile->aMax);
+	tmc5160_writeInt(tmc5160, TMC5160_DMAX, profile->dMax);
+	tmc5160_writeInt(tmc5160, TMC5160_D1, profile->d1);
+	tmc5160_writeInt(tmc5160, TMC5160_VSTOP, profile->vStop);
+}
+
+#if TMC_FEATURE_VIEW
+// Attach a register view for debug probes and host tools, NULL detaches it.
+// The view starts with the shadow registers, see tmc/helpers/RegisterView.h.
+void tmc5160_setView(TMC5160TypeDef *tmc5160, TMCRegisterView *view)
+{
+	TMC_LOCK(tmc5160->config->channel);
+
+	tmc5160->view = view;
+
+	if(view)
+	{
+		tmc_view_init(view, TMC5160_IMAGE_ID, TMC5160_REGISTER_COUNT, tmc5160->registerAccess);
+
+#if TMC_FEATURE_SHADOW
+		for(uint8_t address = 0; address < TMC5160_REGISTER_COUNT; address++)
+		{
+			if(TMC_IS_WRITABLE(tmc5160->registerAccess[address]))
+				tmc_view_store(view, address, TMC_SHADOW_REGISTER(tmc5160->config, address), true);
+		}
+#endif
+	}
+
+	TMC_UNLOCK(tmc5160->config->channel);
+}
+#endif
+
+// Field access by index (TMC5160FieldIndex) or name, e.g. for remote tooling.
+// See tmc/helpers/RegisterDescriptor.h and TMC5160_Descriptors.h.
+int32_t tmc5160_fieldLookup(const char *name)
+{
+	return tmc_field_lookup(&tmc5160_fieldNameIndex, name);
+}
+
+// Registers that are not readable come from the shadow registers,
+// polled status registers from the read cache (TMC5160_READ_CACHE).
+int32_t tmc5160_fieldRead(TMC5160TypeDef *tmc5160, uint16_t field)
+{
+	if(field >= TMC5160_FIELD_COUNT)
+		return 0;
+
+	TMCFieldDescriptor descriptor = tmc5160_fieldDescriptors[field];
+
+	return tmc_field_get(descriptor, tmc5160_readInt(tmc5160, TMC_FIELD_ADDRESS(descriptor)));
+}
+
+// Read-modify-write of the register, fields covering the whole register are written
+// directly. Fields of flag registers are written alone, writing back the other
+// flags would clear them.
+void tmc5160_fieldWrite(TMC5160TypeDef *tmc5160, uint16_t field, int32_t value)
+{
+	if(field >= TMC5160_FIELD_COUNT)
+		return;
+
+	TMCFieldDescriptor descriptor = tmc5160_fieldDescriptors[field];
+	uint8_t address = TMC_FIELD_ADDRESS(descriptor);
+	uint32_t registerValue = 0;
+
+	// Keep the read and the write together
+	TMC_LOCK(tmc5160->config->channel);
+
+	if((TMC_FIELD_WIDTH(descriptor) < 32) && !TMC_FIELD_IS_CLEARABLE(descriptor))
+		registerValue = tmc5160_readInt(tmc5160, address);
+
+	tmc5160_writeInt(tmc5160, address, tmc_field_set(descriptor, registerValue, value));
+
+	TMC_UNLOCK(tmc5160->config->channel);
+}
+
+// Switch to a configuration profile, see tmc/helpers/ConfigProfile.h.
+// Pass the precomputed difference of two profiles to only write the changed registers.
+// The writes are sent back to back under one lock, with the batched transport
+// in lists of up to TMC_TRANSFER_BATCH_SIZE datagrams.
+void tmc5160_writeProfile(TMC5160TypeDef *tmc5160, const TMCConfigProfile *profile)
+{
+	uint8_t i;
+
+	TMC_LOCK(tmc5160->config->channel);
+
+#ifdef TMC5160_TRANSFER_BATCH
+	TMCTransferList list;
+
+	tmc_transfer_init(&list, tmc5160->config->channel, tmc5160_readWriteBatch);
+
+	for(i = 0; i < profile->count; i++)
+	{
+		tmc_transfer_appendDatagram(&list, profile->registers[i].address | TMC5160_WRITE_BIT, profile->registers[i].value, NULL, NULL);
+
+		if(!tmc_transfer_isFull(&list) && (i + 1 < profile->count))
+			continue;
+
+		tmc_transfer_execute(&list);
+	}
+
+	for(i = 0; i < profile->count; i++)
+	{
+		uint8_t address = profile->registers[i].address;
+
+		writeShadow(tmc5160, address, profile->registers[i].value);
+#ifdef TMC5160_READ_CACHE
+		TMCReadCacheEntry *entry = readCacheFind(tmc5160, address);
+		if(entry)
+			entry->valid = false;
+#endif
+	}
+#else
+	for(i = 0; i < profile->count; i++)
+		tmc5160_writeInt(tmc5160, profile->registers[i].address, profile->registers[i].value);
+#endif
+
+	TMC_UNLOCK(tmc5160->config->channel);
+}
+
+// Write planned chopper thresholds, see tmc_planChopperThresholds().
+// The lock keeps the three writes together, the mode switching never sees a mix of two plans.
+void tmc5160_writeChopperThresholds(TMC5160TypeDef *tmc5160, const TMCChopperThresholdsTypeDef *thresholds)
+{
+	TMC_LOCK(tmc5160->config->channel);
+
+	tmc5160_writeInt(tmc5160, TMC5160_TPWMTHRS, thresholds->tpwmthrs);
+	tmc5160_writeInt(tmc5160, TMC5160_TCOOLTHRS, thresholds->tcoolthrs);
+	tmc5160_writeInt(tmc5160, TMC5160_THIGH, thresholds->thigh);
+
+	TMC_UNLOCK(tmc5160->config->channel);
+}
+
+// Write a dcStep plan (tmc_planDcStep()), DCCTRL first so dcStep starts with it
+void tmc5160_writeDcStep(TMC5160TypeDef *tmc5160, const TMCDcStepPlanTypeDef *plan)
+{
+	TMC_LOCK(tmc5160->config->channel);
+
+	tmc5160_writeInt(tmc5160, TMC5160_DCCTRL, plan->dcctrl);
+	tmc5160_writeInt(tmc5160, TMC5160_VDCMIN, plan->vdcmin);
+
+	TMC_UNLOCK(tmc5160->config->channel);
+}
+
+// Check telemetry values (TMC5160TelemetryIndex, e.g. from tmc5160_readTelemetry())
+// for dcStep limiting the velocity, see tmc_dcStepLimiting(). No bus access.
+bool tmc5160_dcStepLimiting(TMC5160TypeDef *tmc5160, const int32_t *telemetry)
+{
+	return tmc_dcStepLimiting(TMC_SHADOW_REGISTER(tmc5160->config, TMC5160_VDCMIN),
+			TMC_SHADOW_REGISTER(tmc5160->config, TMC5160_VMAX),
+			telemetry[TMC5160_TELEMETRY_VACTUAL],
+			FIELD_GET(telemetry[TMC5160_TELEMETRY_RAMPSTAT], TMC5160_VELOCITY_REACHED_MASK, TMC5160_VELOCITY_REACHED_SHIFT));
+}
+
+// Sensorless homing, see tmc/helpers/Homing.h.
+// Poll periodically after tmc_homing_start() until TMC_HOMING_DONE or TMC_HOMING_FAILED
+// is returned. The homing uses velocity mode with the configured AMAX, the stop on stall
+// of the ramp generator ends the seek. XACTUAL is 0 at the end stop afterwards.
+static void homingFinish(TMC5160TypeDef *tmc5160, TMCHomingTypeDef *homing, TMCHomingState state)
+{
+	tmc5160_stop(tmc5160);
+
+	tmc5160_writeInt(tmc5160, TMC5160_SWMODE, homing->saved[0]);
+	tmc5160_writeInt(tmc5160, TMC5160_COOLCONF, homing->saved[1]);
+	tmc5160_writeInt(tmc5160, TMC5160_TCOOLTHRS, homing->saved[2]);
+
+	// Clear a stop on stall, it blocks further motion
+	tmc5160_writeInt(tmc5160, TMC5160_RAMPSTAT, TMC5160_EVENT_STOP_SG_MASK);
+
+	if(state == TMC_HOMING_DONE)
+		tmc5160_writeInt(tmc5160, TMC5160_XACTUAL, 0);
+
+	homing->state = state;
+}
+
+static void writeStallThreshold(TMC5160TypeDef *tmc5160, TMCHomingTypeDef *homing)
+{
+	tmc5160_writeInt(tmc5160, TMC5160_COOLCONF, FIELD_SET(homing->saved[1], TMC5160_SGT_MASK, TMC5160_SGT_SHIFT, homing->threshold));
+}
+
+TMCHomingState tmc5160_home(TMC5160TypeDef *tmc5160, TMCHomingTypeDef *homing)
+{
+	int32_t value;
+
+	switch(homing->state)
+	{
+	case TMC_HOMING_START:
+		homing->saved[0] = tmc5160_readInt(tmc5160, TMC5160_SWMODE);
+		homing->saved[1] = tmc5160_readInt(tmc5160, TMC5160_COOLCONF);
+		homing->saved[2] = tmc5160_readInt(tmc5160, TMC5160_TCOOLTHRS);
+
+		// StallGuard active at every velocity of the homing
+		tmc5160_writeInt(tmc5160, TMC5160_TCOOLTHRS, TMC5160_TCOOLTHRS_MASK);
+		writeStallThreshold(tmc5160, homing);
+
+		if(homing->calibrated)
+		{
+			tmc5160_rotate(tmc5160, homing->velocity);
+			homing->state = TMC_HOMING_ACCELERATE;
+		}
+		else
+		{
+			tmc5160_rotate(tmc5160, -homing->velocity);
+			homing->state = TMC_HOMING_CALIBRATE;
+		}
+		break;
+	case TMC_HOMING_CALIBRATE:
+		if(!(tmc5160_readInt(tmc5160, TMC5160_RAMPSTAT) & TMC5160_VELOCITY_REACHED_MASK))
+			break;
+
+		value = tmc5160_readInt(tmc5160, TMC5160_DRVSTATUS);
+		if(!tmc_homing_sample(homing, FIELD_GET(value, TMC5160_SG_RESULT_MASK, TMC5160_SG_RESULT_SHIFT)))
+			break;
+
+		homing->state = tmc_homing_calibrateSG2(homing);
+		if(homing->state == TMC_HOMING_FAILED)
+		{
+			homingFinish(tmc5160, homing, TMC_HOMING_FAILED);
+			break;
+		}
+
+		writeStallThreshold(tmc5160, homing);
+		if(homing->state == TMC_HOMING_ACCELERATE)
+			tmc5160_rotate(tmc5160, homing->velocity);
+		break;
+	case TMC_HOMING_ACCELERATE:
+		// Arm the stop on stall only at the homing velocity, StallGuard is not valid while accelerating
+		if(!(tmc5160_readInt(tmc5160, TMC5160_RAMPSTAT) & TMC5160_VELOCITY_REACHED_MASK))
+			break;
+
+		tmc5160_writeInt(tmc5160, TMC5160_RAMPSTAT, TMC5160_EVENT_STOP_SG_MASK);
+		tmc5160_writeInt(tmc5160, TMC5160_SWMODE, homing->saved[0] | TMC5160_SG_STOP_MASK);
+		tmc_homing_arm(homing);
+		break;
+	case TMC_HOMING_SEEK:
+		if(homing->diagEvent || (tmc5160_readInt(tmc5160, TMC5160_RAMPSTAT) & TMC5160_EVENT_STOP_SG_MASK))
+			homingFinish(tmc5160, homing, TMC_HOMING_DONE);
+		else if(tmc_homing_timedOut(homing))
+			homingFinish(tmc5160, homing, TMC_HOMING_FAILED);
+		break;
+	default:
+		break;
+	}
+
+	return homing->state;
+}
+
+// CoolStep auto tuning, see tmc/helpers/CoolStepTune.h.
+// The motor rotates at the calibration velocity during the tuning and is stopped at the end.
+// Poll periodically after tmc_coolStepTune_start() until TMC_COOLSTEP_TUNE_DONE or
+// TMC_COOLSTEP_TUNE_FAILED is returned. On a failure the previous COOLCONF is kept.
+static void coolStepTuneFinish(TMC5160TypeDef *tmc5160, TMCCoolStepTuneTypeDef *tune, TMCCoolStepTuneState state)
+{
+	TMC_LOCK(tmc5160->config->channel);
+
+	tmc5160_stop(tmc5160);
+	tmc5160_writeInt(tmc5160, TMC5160_COOLCONF, (state == TMC_COOLSTEP_TUNE_DONE) ? tune->coolconf : tune->saved[0]);
+	tmc5160_writeInt(tmc5160, TMC5160_TCOOLTHRS, tune->saved[1]);
+
+	TMC_UNLOCK(tmc5160->config->channel);
+
+	tune->state = state;
+}
+
+TMCCoolStepTuneState tmc5160_tuneCoolStep(TMC5160TypeDef *tmc5160, TMCCoolStepTuneTypeDef *tune)
+{
+	static const uint8_t addresses[] = { TMC5160_RAMPSTAT, TMC5160_DRVSTATUS };
+	int32_t values[ARRAY_SIZE(addresses)];
+	TMCCoolStepTuneState state;
+
+	switch(tune->state)
+	{
+	case TMC_COOLSTEP_TUNE_START:
+		tune->saved[0] = tmc5160_readInt(tmc5160, TMC5160_COOLCONF);
+		tune->saved[1] = tmc5160_readInt(tmc5160, TMC5160_TCOOLTHRS);
+
+		// CoolStep active at every velocity of the tuning, off for the baseline
+		tmc5160_writeInt(tmc5160, TMC5160_TCOOLTHRS, TMC5160_TCOOLTHRS_MASK);
+		tune->state = TMC_COOLSTEP_TUNE_BASELINE;
+		tmc5160_writeInt(tmc5160, TMC5160_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		tmc5160_rotate(tmc5160, tune->velocity);
+		break;
+	case TMC_COOLSTEP_TUNE_BASELINE:
+	case TMC_COOLSTEP_TUNE_SWEEP:
+		tmc5160_readIntBatch(tmc5160, addresses, values, ARRAY_SIZE(addresses));
+
+		// SG_RESULT is not valid while accelerating
+		if(!(values[0] & TMC5160_VELOCITY_REACHED_MASK))
+			break;
+
+		if(!tmc_coolStepTune_sample(tune, FIELD_GET(values[1], TMC5160_SG_RESULT_MASK, TMC5160_SG_RESULT_SHIFT), FIELD_GET(values[1], TMC5160_CS_ACTUAL_MASK, TMC5160_CS_ACTUAL_SHIFT)))
+			break;
+
+		state = tmc_coolStepTune_evaluate(tune);
+		if(state != TMC_COOLSTEP_TUNE_SWEEP)
+		{
+			coolStepTuneFinish(tmc5160, tune, state);
+			break;
+		}
+
+		tune->state = state;
+		tmc5160_writeInt(tmc5160, TMC5160_COOLCONF, tmc_coolStepTune_coolconf(tune));
+		break;
+	default:
+		break;
+	}
+
+	return tune->state;
+}
+
+// Encoder step loss monitor
+// The IC compares XACTUAL and X_ENC itself (ENC_DEVIATION) and flags deviation_warn in
+// ENC_STATUS. The service only polls ENC_STATUS, X_ENC is read when the flag is set
+// or every [interval] ticks to track the deviation in the background.
+// X_ENC has to be scaled to microsteps with ENC_CONST.
+
+static void readDeviation(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor)
+{
+	static const uint8_t addresses[] = { TMC5160_XACTUAL, TMC5160_XENC };
+	int32_t values[ARRAY_SIZE(addresses)];
+
+	tmc5160_readIntBatch(tmc5160, addresses, values, ARRAY_SIZE(addresses));
+	monitor->deviation = values[0] - values[1];
+}
+
+void tmc5160_encoderMonitorInit(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor, uint32_t tolerance, uint16_t interval)
+{
+	monitor->tolerance  = MIN(tolerance, TMC5160_ENC_DEVIATION_MASK);
+	monitor->interval   = interval;
+	monitor->tick       = 0;
+	monitor->deviation  = 0;
+	monitor->stepLoss   = false;
+
+	tmc5160_writeInt(tmc5160, TMC5160_ENC_DEVIATION, monitor->tolerance);
+	tmc5160_writeInt(tmc5160, TMC5160_ENC_STATUS, TMC5160_DEVIATION_WARN_MASK);
+}
+
+// Call periodically. Returns true while a step loss is latched.
+bool tmc5160_encoderMonitorService(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor, uint32_t tick)
+{
+	if(tmc5160_readInt(tmc5160, TMC5160_ENC_STATUS) & TMC5160_DEVIATION_WARN_MASK)
+	{
+		readDeviation(tmc5160, monitor);
+		monitor->stepLoss = true;
+		monitor->tick = tick;
+	}
+	else if(monitor->interval && ((tick - monitor->tick) >= monitor->interval))
+	{
+		readDeviation(tmc5160, monitor);
+		monitor->tick = tick;
+	}
+
+	return monitor->stepLoss;
+}
+
+// Clear a latched step loss, e.g. after re-homing
+void tmc5160_encoderMonitorClear(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor)
+{
+	tmc5160_writeInt(tmc5160, TMC5160_ENC_STATUS, TMC5160_DEVIATION_WARN_MASK);
+	monitor->stepLoss = false;
+}
+
+// Closed loop position mode: Call periodically while moving to [target] with tmc5160_moveTo().
+// Every loop->interval ticks, XACTUAL and X_ENC are read in one batch and XTARGET is set to
+// [target] plus the correction of the loop, see tmc/ramp/PositionLoop.h. Returns true if the loop updated.
+bool tmc5160_positionLoopService(TMC5160TypeDef *tmc5160, TMC_PositionLoop *loop, int32_t target, uint32_t tick)
+{
+	static const uint8_t addresses[] = { TMC5160_XACTUAL, TMC5160_XENC };
+	int32_t values[ARRAY_SIZE(addresses)];
+	int32_t setpoint;
+
+	if(!tmc_ramp_ploop_isDue(loop, tick))
+		return false;
+
+	tmc5160_readIntBatch(tmc5160, addresses, values, ARRAY_SIZE(addresses));
+	loop->transfers += ARRAY_SIZE(addresses) + 1;
+
+	setpoint = target + tmc_ramp_ploop_update(loop, values[0], values[1], tick);
+
+	// XTARGET only changes with the target or the correction
+	if((setpoint != loop->setpoint) || (loop->cycles == 1))
+	{
+		tmc5160_writeInt(tmc5160, TMC5160_XTARGET, setpoint);
+		loop->setpoint = setpoint;
+		loop->transfers++;
+	}
+
+	return true;
+}
+
+// Move queue
+// Push moves from the application. Start them with tmc5160_moveQueueNext() from the
+// event path (e.g. tmc5160_onInterrupt() reporting EVENT_POS_REACHED with DIAG1
+// routed to the position compare), or poll with tmc5160_moveQueueService().
+// Staging, starting and servicing have to be called from the same context.
+#define MOVE_QUEUE_MASK (TMC5160_MOVE_QUEUE_SIZE - 1)
+
+void tmc5160_moveQueueInit(TMC5160MoveQueueTypeDef *queue)
+{
+	queue->head         = 0;
+	queue->tail         = 0;
+	queue->running      = false;
+	queue->known        = false;
+	queue->stagedCount  = 0;
+}
+
+// Returns false if the queue is full
+bool tmc5160_moveQueuePush(TMC5160MoveQueueTypeDef *queue, const TMC5160MoveTypeDef *move)
+{
+	uint8_t tail = queue->tail;
+
+	if(((tail + 1) & MOVE_QUEUE_MASK) == queue->head)
+		return false;
+
+	queue->moves[tail] = *move;
+	queue->tail = (tail + 1) & MOVE_QUEUE_MASK;
+
+	return true;
+}
+
+static void stageWrite(TMC5160MoveQueueTypeDef *queue, uint8_t address, int32_t value)
+{
+	TMCCommand *command = &queue->staged[queue->stagedCount++];
+
+	command->address  = address;
+	command->mask     = 0xFFFFFFFF;
+	command->value    = value;
+}
+
+// Prepare the register writes of the next move ahead of time, so starting it only
+// takes the bus transfers. Called by tmc5160_moveQueueNext() and
+// tmc5160_moveQueueService() for the following move already.
+void tmc5160_moveQueueStage(TMC5160MoveQueueTypeDef *queue)
+{
+	const TMC5160MoveTypeDef *move;
+	const TMCRampProfileTypeDef *profile;
+
+	if(queue->stagedCount || (queue->head == queue->tail))
+		return;
+
+	move = &queue->moves[queue->head];
+	profile = move->profile;
+
+	if(!queue->known)
+		stageWrite(queue, TMC5160_RAMPMODE, TMC5160_MODE_POSITION);
+
+	if(profile && (!queue->known || (profile != queue->last.profile)))
+	{
+		stageWrite(queue, TMC5160_VSTART, profile->vStart);
+		stageWrite(queue, TMC5160_A1, profile->a1);
+		stageWrite(queue, TMC5160_V1, profile->v1);
+		stageWrite(queue, TMC5160_AMAX, profile->aMax);
+		stageWrite(queue, TMC5160_DMAX, profile->dMax);
+		stageWrite(queue, TMC5160_D1, profile->d1);
+		stageWrite(queue, TMC5160_VSTOP, profile->vStop);
+	}
+
+	if(!queue->known || (move->velocityMax != queue->last.velocityMax))
+		stageWrite(queue, TMC5160_VMAX, move->velocityMax);
+
+	stageWrite(queue, TMC5160_XTARGET, move->position);
+}
+
+// Start the next move right away.
+// Returns false if the queue is empty.
+bool tmc5160_moveQueueNext(TMC5160TypeDef *tmc5160, TMC5160MoveQueueTypeDef *queue)
+{
+	uint8_t i;
+
+	tmc5160_moveQueueStage(queue);
+	if(!queue->stagedCount)
+	{
+		queue->running = false;
+		return false;
+	}
+
+	for(i = 0; i < queue->stagedCount; i++)
+		tmc5160_writeInt(tmc5160, queue->staged[i].address, queue->staged[i].value);
+
+	// Keep the previous profile if the move did not change it
+	if(queue->moves[queue->head].profile || !queue->known)
+		queue->last.profile = queue->moves[queue->head].profile;
+	queue->last.velocityMax  = queue->moves[queue->head].velocityMax;
+	queue->last.position     = queue->moves[queue->head].position;
+	queue->known             = true;
+	queue->running           = true;
+	queue->stagedCount       = 0;
+	queue->head = (queue->head + 1) & MOVE_QUEUE_MASK;
+
+	// Prepare the following move while this one runs
+	tmc5160_moveQueueStage(queue);
+
+	return true;
+}
+
+// Status poll: Starts the next move once the running one reached its target.
+// Costs one RAMP_STAT read per call while a move is running.
+// Returns true if a move was started.
+bool tmc5160_moveQueueService(TMC5160TypeDef *tmc5160, TMC5160MoveQueueTypeDef *queue)
+{
+	if(queue->running && !(tmc5160_readInt(tmc5160, TMC5160_RAMPSTAT) & TMC5160_POSITION_REACHED_MASK))
+	{
+		tmc5160_moveQueueStage(queue);
+		return false;
+	}
+
+	return tmc5160_moveQueueNext(tmc5160, queue);
+}
+
+// Returns true once the last started move reached its target and nothing is queued.
+// Only updated by tmc5160_moveQueueNext() and tmc5160_moveQueueService().
+bool tmc5160_moveQueueIsDone(TMC5160MoveQueueTypeDef *queue)
+{
+	return !queue->running && (queue->head == queue->tail);
+}
+
+// Command queue, see tmc/helpers/CommandQueue.h
+// The queue functions only enqueue and can be called from interrupts,
+// tmc5160_serviceQueue() writes the queued commands.
+
+// Queue a tmc5160_moveTo()
+bool tmc5160_queueMoveTo(TMCCommandQueue *queue, int32_t position, uint32_t velocityMax)
+{
+	const TMCCommand commands[] =
+	{
+		{ .address = TMC5160_RAMPMODE, .mask = 0xFFFFFFFF, .value = TMC5160_MODE_POSITION },
+		{ .address = TMC5160_VMAX,     .mask = 0xFFFFFFFF, .value = velocityMax },
+		{ .address = TMC5160_XTARGET,  .mask = 0xFFFFFFFF, .value = position },
+	};
+
+	return tmc_queue_push(queue, commands, ARRAY_SIZE(commands));
+}
+
+// Queue a tmc5160_rotate()
+bool tmc5160_queueRotate(TMCCommandQueue *queue, int32_t velocity)
+{
+	const TMCCommand commands[] =
+	{
+		{ .address = TMC5160_VMAX,     .mask = 0xFFFFFFFF, .value = abs(velocity) },
+		{ .address = TMC5160_RAMPMODE, .mask = 0xFFFFFFFF, .value = (velocity >= 0) ? TMC5160_MODE_VELPOS : TMC5160_MODE_VELNEG },
+	};
+
+	return tmc_queue_push(queue, commands, ARRAY_SIZE(commands));
+}
+
+static void queueWriteInt(void *ic, uint8_t address, int32_t value)
+{
+	tmc5160_writeInt(ic, address, value);
+}
+
+static int32_t queueReadInt(void *ic, uint8_t address)
+{
+	return tmc5160_readInt(ic, address);
+}
+
+// Write the commands queued for the IC. Returns the amount of register writes.
+uint8_t tmc5160_serviceQueue(TMC5160TypeDef *tmc5160, TMCCommandQueue *queue)
+{
+	return tmc_queue_drainOrdered(queue, tmc5160, queueWriteInt, queueReadInt, tmc5160_writeOrder, ARRAY_SIZE(tmc5160_writeOrder));
+}
+
+// Current per ramp phase, see tmc/helpers/CurrentProfile.h.
+// [settings] holds TMC_RAMP_PHASE_COUNT entries, indexed by TMCRampPhase.
+void tmc5160_currentProfileInit(TMCCurrentProfile *profile, const TMCCurrentSetting *settings)
+{
+	tmc_currentProfile_init(profile, TMC5160_GLOBAL_SCALER, TMC5160_IHOLD_IRUN, settings);
+}
+
+// Determine the ramp phase of the motion controller from telemetry values
+// (TMC5160TelemetryIndex, e.g. from tmc5160_readTelemetry()) and queue the current
+// setting on a phase change. tmc5160_serviceQueue() writes it.
+// Returns true if commands were queued.
+bool tmc5160_currentProfileUpdate(TMCCurrentProfile *profile, TMCCommandQueue *queue, const int32_t *telemetry)
+{
+	TMCRampPhase phase = tmc_currentProfile_phase(profile, telemetry[TMC5160_TELEMETRY_VACTUAL],
+			FIELD_GET(telemetry[TMC5160_TELEMETRY_RAMPSTAT], TMC5160_VELOCITY_REACHED_MASK, TMC5160_VELOCITY_REACHED_SHIFT));
+
+	return tmc_currentProfile_update(profile, phase, queue);
+}
+
+// Thermal derating from the DRV_STATUS temperature flags of telemetry values
+// (TMC5160TelemetryIndex, e.g. from tmc5160_readTelemetry()), see
+// tmc/helpers/ThermalDerating.h. Call it once per new capture.
+// Returns true if GLOBAL_SCALER was written.
+bool tmc5160_thermalUpdate(TMC5160TypeDef *tmc5160, TMCThermalDerating *thermal, const int32_t *telemetry)
+{
+	int32_t drvStatus = telemetry[TMC5160_TELEMETRY_DRVSTATUS];
+	uint8_t level = 0;
+
+	if(drvStatus & TMC5160_OT_MASK)
+		level = 2;
+	else if(drvStatus & TMC5160_OTPW_MASK)
+		level = 1;
+
+	if(!tmc_thermal_updateLevel(thermal, level))
+		return false;
+
+	tmc5160_writeInt(tmc5160, TMC5160_GLOBAL_SCALER, tmc_thermal_globalScaler(thermal));
+
+	return true;
+}
+
+// Load telemetry, see tmc/helpers/LoadStream.h
+static void streamDrvStatus(TMCLoadStream *stream, uint8_t axis, int32_t drvStatus, uint32_t tick)
+{
+	tmc_loadStream_sample(stream, axis,
+			FIELD_GET(drvStatus, TMC5160_SG_RESULT_MASK, TMC5160_SG_RESULT_SHIFT),
+			FIELD_GET(drvStatus, TMC5160_CS_ACTUAL_MASK, TMC5160_CS_ACTUAL_SHIFT),
+			tick);
+}
+
+// Sample SG_RESULT and CS_ACTUAL of one IC into [stream] as [axis]
+void tmc5160_sampleLoad(TMC5160TypeDef *tmc5160, TMCLoadStream *stream, uint8_t axis, uint32_t tick)
+{
+	streamDrvStatus(stream, axis, tmc5160_readInt(tmc5160, TMC5160_DRVSTATUS), tick);
+}
+
+// Sample all ICs of a daisy chain with one chain read. The chain position is the axis.
+void tmc5160_chainSampleLoad(TMC5160ChainTypeDef *chain, TMCLoadStream *stream, uint32_t tick)
+{
+	uint8_t addresses[TMC5160_CHAIN_MAX];
+	int32_t values[TMC5160_CHAIN_MAX];
+	uint8_t i;
+
+	for(i = 0; i < chain->count; i++)
+		addresses[i] = TMC5160_DRVSTATUS;
+
+	tmc5160_chainReadInt(chain, addresses, values);
+
+	for(i = 0; i < chain->count; i++)
+		streamDrvStatus(stream, i, values[i], tick);
+}
+
+// Host telemetry record of the snapshot values [telemetry], see tmc/helpers/TelemetryExport.h.
+// faults holds DRV_STATUS bits 24 to 31 (stallGuard, ot, otpw, s2ga, s2gb, ola, olb, stst)
+// in bits 0 to 7 and s2vsa, s2vsb in bits 8 and 9. The TMC5160 has no temperature reading,
+// the application may fill it in before pushing the record.
+void tmc5160_telemetryRecord(const int32_t *telemetry, uint8_t axis, uint32_t timestamp, TMCTelemetryRecord *record)
+{
+	int32_t drvStatus = telemetry[TMC5160_TELEMETRY_DRVSTATUS];
+
+	record->timestamp    = timestamp;
+	record->position     = telemetry[TMC5160_TELEMETRY_XACTUAL];
+	record->velocity     = CAST_Sn_TO_S32(telemetry[TMC5160_TELEMETRY_VACTUAL], 24);
+	record->sg           = FIELD_GET(drvStatus, TMC5160_SG_RESULT_MASK, TMC5160_SG_RESULT_SHIFT);
+	record->current      = FIELD_GET(drvStatus, TMC5160_CS_ACTUAL_MASK, TMC5160_CS_ACTUAL_SHIFT);
+	record->temperature  = 0;
+	record->faults       = (((uint32_t) drvStatus >> 24) & 0xFF)
+	                     | (FIELD_GET(drvStatus, TMC5160_S2VSA_MASK | TMC5160_S2VSB_MASK, TMC5160_S2VSA_SHIFT) << 8);
+	record->axis         = axis;
+}
+
+// Read tmc5160_telemetryRegisters in one batch and publish them for other cores or tasks.
+// Index the snapshot with TMC5160TelemetryIndex.
+void tmc5160_publishTelemetry(TMC5160TypeDef *tmc5160, TMCSnapshot *snapshot, uint32_t tick)
+{
+	int32_t values[TMC5160_TELEMETRY_COUNT];
+
+	tmc5160_readIntBatch(tmc5160, tmc5160_telemetryRegisters, values, TMC5160_TELEMETRY_COUNT);
+#ifdef TMC_SAMPLE_TIMESTAMP
+	tmc_snapshot_publishStamped(snapshot, values, TMC5160_TELEMETRY_COUNT, tick, tmc5160->sampleTime);
+#else
+	tmc_snapshot_publish(snapshot, values, TMC5160_TELEMETRY_COUNT, tick);
+#endif
+}
+
+#if TMC_FEATURE_TELEMETRY
+// Switch the telemetry capture to the fast rate (telemetryInterval) until the axis
+// is found at standstill again. Motion commands and tmc5160_onInterrupt() do this
+// already, call it for other events that need fresh telemetry.
+void tmc5160_telemetryWake(TMC5160TypeDef *tmc5160)
+{
+	tmc5160->telemetryActive = true;
+}
+
+// Latest telemetry of the IC without bus access. Captured every telemetryInterval
+// ticks by tmc5160_periodicJob(). values holds TMC5160_TELEMETRY_COUNT entries,
+// tick (may be NULL) receives the capture tick.
+void tmc5160_readTelemetry(TMC5160TypeDef *tmc5160, int32_t *values, uint32_t *tick)
+{
+	tmc_snapshot_read(&tmc5160->telemetry, values, TMC5160_TELEMETRY_COUNT, tick);
+}
+
+// As tmc5160_readTelemetry(), timestamp (may be NULL) receives the sampling instant
+// (TMC_SAMPLE_TIMESTAMP()) of the values, or the capture tick without it.
+void tmc5160_readTelemetryStamped(TMC5160TypeDef *tmc5160, int32_t *values, uint32_t *tick, uint32_t *timestamp)
+{
+	tmc_snapshot_readStamped(&tmc5160->telemetry, values, TMC5160_TELEMETRY_COUNT, tick, timestamp);
+}
+#endif
+
+#if TMC_FEATURE_CONSISTENCY
+// Compare [count] entries of tmc5160_consistencyRegisters starting at [first]
+// with their shadow registers, using one pipelined batch read.
+static uint8_t checkRegisters(TMC5160TypeDef *tmc5160, size_t first, size_t count)
+{
+	int32_t values[ARRAY_SIZE(tmc5160_consistencyRegisters)];
+	size_t i;
+
+	tmc5160_readIntBatch(tmc5160, &tmc5160_consistencyRegisters[first], values, count);
+
+	for(i = 0; i < count; i++)
+		if(TMC_SHADOW_REGISTER(tmc5160->config, tmc5160_consistencyRegisters[first + i]) != values[i])
+			return 1;
+
+	return 0;
+}
+
+// Check the written configuration against the actual registers.
+// Returns 1 if an inconsistency was detected, e.g. after the IC lost its
+// supply, including inconsistencies found by the incremental check since the
+// last call.
+uint8_t tmc5160_consistencyCheck(TMC5160TypeDef *tmc5160)
+{
+	uint8_t inconsistent = tmc5160->inconsistent;
+
+	tmc5160->inconsistent = false;
+
+	// Config has not yet been written -> it cant be consistent
+	if(tmc5160->config->state != CONFIG_READY)
+		return 0;
+
+	if(checkRegisters(tmc5160, 0, ARRAY_SIZE(tmc5160_consistencyRegisters)))
+		return 1;
+
+	return inconsistent;
+}
+
+// Incremental consistency check: Verify the next [count] registers, continuing
+// where the previous call stopped. Reading count registers takes count+1 transfers.
+// tmc5160_periodicJob() calls this with consistencyBudget registers and latches
+// the result for tmc5160_consistencyCheck().
+// Returns 1 if an inconsistency was detected.
+uint8_t tmc5160_consistencyCheckStep(TMC5160TypeDef *tmc5160, uint8_t count)
+{
+	uint8_t result = 0;
+
+	if(tmc5160->config->state != CONFIG_READY)
+		return 0;
+
+	count = MIN(count, ARRAY_SIZE(tmc5160_consistencyRegisters));
+
+	while(count)
+	{
+		// Split the batch at the end of the list
+		uint8_t index = tmc5160->consistencyIndex;
+		uint8_t length = MIN(count, ARRAY_SIZE(tmc5160_consistencyRegisters) - index);
+
+		result |= checkRegisters(tmc5160, index, length);
+
+		index += length;
+		tmc5160->consistencyIndex = (index < ARRAY_SIZE(tmc5160_consistencyRegisters)) ? index : 0;
+		count -= length;
+	}
+
+	return result;
+}
+#endif
+
+// Common IC interface, see tmc/helpers/ICInterface.h
+static int32_t interfaceReadInt(void *ic, uint8_t address)
+{
+	return tmc5160_readInt(ic, address);
+}
+
+static void interfaceWriteInt(void *ic, uint8_t address, int32_t value)
+{
+	tmc5160_writeInt(ic, address, value);
+}
+
+static void interfaceReadIntBatch(void *ic, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	tmc5160_readIntBatch(ic, addresses, values, count);
+}
+
+static TMCConfigStatus interfacePeriodicJob(void *ic, uint32_t tick)
+{
+	return tmc5160_periodicJob(ic, tick);
+}
+
+#if TMC_FEATURE_TELEMETRY
+static bool interfaceReadTelemetry(void *ic, int32_t *values, uint32_t *tick)
+{
+	TMC5160TypeDef *tmc5160 = ic;
+
+	tmc5160_readTelemetry(tmc5160, values, tick);
+
+	return (tmc5160->telemetry.sequence != 0);
+}
+#endif
+
+const TMCICInterface tmc5160_interface =
+{
+	.name           = "TMC5160",
+	.readInt        = interfaceReadInt,
+	.writeInt       = interfaceWriteInt,
+	.readIntBatch   = interfaceReadIntBatch,
+	.periodicJob    = interfacePeriodicJob,
+#if TMC_FEATURE_TELEMETRY
+	.readTelemetry  = interfaceReadTelemetry,
+	.telemetryCount = TMC5160_TELEMETRY_COUNT,
+#endif
+};
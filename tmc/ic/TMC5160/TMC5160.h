@@ -9,42 +9,190 @@
 #define TMC_IC_TMC5160_H_
 
 #include "tmc/helpers/API_Header.h"
+#include "tmc/ramp/PositionLoop.h"
 #include "TMC5160_Register.h"
 #include "TMC5160_Constants.h"
 #include "TMC5160_Fields.h"
+#include "TMC5160_Status.h"
 
 // Helper macros
 #define TMC5160_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc5160_readInt(tdef, address), mask, shift)
 #define TMC5160_FIELD_WRITE(tdef, address, mask, shift, value) \
-	(tmc5160_writeInt(tdef, address, FIELD_SET(tmc5160_readInt(tdef, address), mask, shift, value)))
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc5160_writeInt(tdef, address, FIELD_SET(tmc5160_readInt(tdef, address), mask, shift, value))), \
+	TMC_UNLOCK((tdef)->config->channel))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5160_FIELDS_WRITE(tdef, address, mask, values) \
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc5160_writeInt(tdef, address, FIELDS_SET(tmc5160_readInt(tdef, address), mask, values))), \
+	TMC_UNLOCK((tdef)->config->channel))
 
 // Factor between 10ms units and internal units for 16MHz
 //#define TPOWERDOWN_FACTOR (4.17792*100.0/255.0)
 // TPOWERDOWN_FACTOR = k * 100 / 255 where k = 2^18 * 255 / fClk for fClk = 16000000)
 
+// Amount of registers held in the read cache (TMC5160_READ_CACHE)
+#define TMC5160_READ_CACHE_SIZE 4
+
+// IC id of saved register images (RegisterImage.h)
+#define TMC5160_IMAGE_ID 5160
+
 // Typedefs
 typedef struct
 {
 	ConfigurationTypeDef *config;
+	TMCUnitConversion units;  // Clock dependent unit conversions, see tmc5160_setClockFrequency()
+#if TMC_FEATURE_VELOCITY_ESTIMATE
 	int velocity, oldX;
 	uint32_t oldTick;
+	TMCVelocitySource velocitySource;  // See tmc5160_setVelocitySource()
+#ifdef TMC_SAMPLE_TIMESTAMP
+	uint32_t oldSampleTime;
+#endif
+#endif
+#ifdef TMC_SAMPLE_TIMESTAMP
+	uint32_t sampleTime;       // Sampling instant of the last read, see TMC_SAMPLE_TIMESTAMP() in SPI.h
+#endif
+#if !TMC_FEATURE_CONFIG
+	// No reset state (TMC_FEATURE_CONFIG)
+#elif defined(TMC_RESET_STATE_CONST)
+	TMCResetStateTypeDef registerResetState;
+#else
 	int32_t registerResetState[TMC5160_REGISTER_COUNT];
+#endif
+#ifdef TMC_DIRTY_BITMAP
+	const uint8_t *registerAccess;   // Defaults to tmc5160_defaultRegisterAccess
+	uint32_t dirty[TMC_DIRTY_WORDS]; // Registers written since the last reset
+#else
 	uint8_t registerAccess[TMC5160_REGISTER_COUNT];
+#endif
+#ifdef TMC5160_READ_CACHE
+	const uint8_t *registerMaxAge;  // Defaults to tmc5160_defaultRegisterMaxAge
+	uint32_t cacheTick;             // Last tick passed to tmc5160_periodicJob()
+	TMCReadCacheEntry readCache[TMC5160_READ_CACHE_SIZE];
+#endif
+#if TMC_FEATURE_CONSISTENCY
+	uint8_t consistencyIndex;   // Next entry of tmc5160_consistencyRegisters to verify
+	uint8_t consistencyBudget;  // Registers verified per tmc5160_periodicJob(), 0: off
+	bool inconsistent;          // Set by the incremental check, cleared by tmc5160_consistencyCheck()
+#endif
+#if TMC_FEATURE_TELEMETRY
+	TMCSnapshot telemetry;       // Latest tmc5160_telemetryRegisters, see tmc5160_readTelemetry()
+	uint32_t telemetryTick;      // Tick of the last periodic capture
+	uint8_t telemetryInterval;   // Ticks between captures in tmc5160_periodicJob(), 0: off
+	uint16_t telemetryIdleInterval; // Ticks between captures at standstill, 0: always telemetryInterval
+	bool telemetryActive;        // Axis moving or woken up, captures use telemetryInterval
+#endif
+#if TMC_FEATURE_VIEW
+	TMCRegisterView *view;       // See tmc5160_setView(), NULL: off
+#endif
+#if TMC_FEATURE_SPI_STATUS
+	TMCSpiStatus spiStatus;      // SPI_STATUS of the last reply, see tmc5160_getSpiStatus()
+#endif
+	// Status read by tmc5160_onInterrupt()
+	int32_t gstat;
+	int32_t rampStat;
+	int32_t drvStatus;
 } TMC5160TypeDef;
 
+// Write-to-clear flags handled by the interrupt status read
+#define TMC5160_GSTAT_EVENTS     (TMC5160_RESET_MASK | TMC5160_DRV_ERR_MASK | TMC5160_UV_CP_MASK)
+#define TMC5160_RAMPSTAT_EVENTS  (TMC5160_STATUS_LATCH_L_MASK | TMC5160_STATUS_LATCH_R_MASK | TMC5160_EVENT_STOP_SG_MASK | TMC5160_EVENT_POS_REACHED_MASK | TMC5160_SECOND_MOVE_MASK)
+
 typedef void (*tmc5160_callback)(TMC5160TypeDef*, ConfigState);
 
-// Default Register values
-#define R00 0x00000008  // GCONF
-#define R09 0x00010606  // SHORTCONF
-#define R0A 0x00080400  // DRVCONF
-#define R10 0x00070A03  // IHOLD_IRUN
-#define R11 0x0000000A  // TPOWERDOWN
-#define R2B 0x00000001  // VSTOP
-#define R3A 0x00010000  // ENC_CONST
-#define R6C 0x00410153  // CHOPCONF
-#define R70 0xC40C001E  // PWMCONF
+// Encoder step loss monitor, see tmc5160_encoderMonitorService()
+typedef struct
+{
+	uint32_t tolerance;  // Allowed deviation of XACTUAL and X_ENC [microsteps]
+	uint16_t interval;   // Ticks between background reads of X_ENC, 0: off
+	uint32_t tick;       // Tick of the last background read
+	int32_t deviation;   // XACTUAL - X_ENC of the last read
+	bool stepLoss;       // Latched until tmc5160_encoderMonitorClear()
+} TMC5160EncoderMonitorTypeDef;
+
+// Maximum amount of ICs in one daisy chain
+#define TMC5160_CHAIN_MAX 8
+
+// ICs daisy chained on one chip select
+typedef struct
+{
+	uint8_t channel;
+	uint8_t count;
+	TMC5160TypeDef *ics[TMC5160_CHAIN_MAX];
+} TMC5160ChainTypeDef;
+
+// Maximum amount of register writes in one sync batch
+#define TMC5160_SYNC_BATCH_SIZE 16
+
+// Register writes of one or more ICs, prepared by the application and fired together
+// from a timing critical context, e.g. the SYNC0 interrupt of an EtherCAT slave controller.
+// Double buffered: The application prepares the next batch while the committed one
+// waits for the event.
+typedef struct
+{
+	TMC5160TypeDef *ic;
+	uint8_t datagram[5];
+} TMC5160SyncWriteTypeDef;
+
+typedef struct
+{
+	TMC5160SyncWriteTypeDef writes[2][TMC5160_SYNC_BATCH_SIZE];
+	uint8_t count[2];
+	uint8_t prepare;          // Buffer filled by the application
+	volatile bool committed;  // The other buffer waits for tmc5160_syncBatchFire()
+} TMC5160SyncBatchTypeDef;
+
+// Capacity of a move queue, must be a power of two
+#define TMC5160_MOVE_QUEUE_SIZE 8
+
+typedef struct
+{
+	int32_t position;
+	uint32_t velocityMax;
+	const TMCRampProfileTypeDef *profile; // NULL: Keep the ramp parameters. Must not change while queued.
+} TMC5160MoveTypeDef;
+
+// Successive moves without waiting for the host: The register writes of the
+// next move are staged while the current one runs and fired as soon as it
+// reaches its target. Only registers that differ from the previous move are
+// written, so a move with unchanged ramp parameters is a single XTARGET write.
+// The queue assumes it controls the motion alone: Other motion commands between
+// moves require tmc5160_moveQueueInit() to write all registers again.
+typedef struct
+{
+	TMC5160MoveTypeDef moves[TMC5160_MOVE_QUEUE_SIZE];
+	volatile uint8_t head;  // Next move to start, advanced by the service
+	volatile uint8_t tail;  // Next free slot, advanced by pushing
+	bool running;           // A move was started and its target is not reached yet
+	bool known;             // The last move describes the register state
+	TMC5160MoveTypeDef last;
+	TMCCommand staged[10];  // Writes of moves[head], XTARGET last
+	uint8_t stagedCount;    // 0: not staged
+} TMC5160MoveQueueTypeDef;
+
+// Default register values, named for composing reset values from fields
+// at compile time (see tmc/helpers/ResetState.h)
+#define TMC5160_RESET_GCONF       0x00000008
+#define TMC5160_RESET_SHORTCONF   0x00010606
+#define TMC5160_RESET_DRVCONF     0x00080400
+#define TMC5160_RESET_IHOLD_IRUN  0x00070A03
+#define TMC5160_RESET_TPOWERDOWN  0x0000000A
+#define TMC5160_RESET_VSTOP       0x00000001
+#define TMC5160_RESET_ENC_CONST   0x00010000
+#define TMC5160_RESET_CHOPCONF    0x00410153
+#define TMC5160_RESET_PWMCONF     0xC40C001E
+
+#define R00 TMC5160_RESET_GCONF
+#define R09 TMC5160_RESET_SHORTCONF
+#define R0A TMC5160_RESET_DRVCONF
+#define R10 TMC5160_RESET_IHOLD_IRUN
+#define R11 TMC5160_RESET_TPOWERDOWN
+#define R2B TMC5160_RESET_VSTOP
+#define R3A TMC5160_RESET_ENC_CONST
+#define R6C TMC5160_RESET_CHOPCONF
+#define R70 TMC5160_RESET_PWMCONF
 
 static const int32_t tmc5160_defaultRegisterResetState[TMC5160_REGISTER_COUNT] =
 {
@@ -71,6 +219,18 @@ static const int32_t tmc5160_defaultRegisterResetState[TMC5160_REGISTER_COUNT] =
 #undef R6C
 #undef R70
 
+// Power-on values of the resettable registers, all others power up as 0.
+// Used by tmc5160_resetFromPowerOn() to skip writes. Use ascending addresses!
+static const TMCRegisterConstant tmc5160_powerOnRegisters[] =
+{
+	{ 0x00, 0x00000008 }, // GCONF
+	{ 0x09, 0x00010606 }, // SHORT_CONF
+	{ 0x0A, 0x00080400 }, // DRV_CONF
+	{ 0x11, 0x0000000A }, // TPOWERDOWN
+	{ 0x3A, 0x00010000 }, // ENC_CONST
+	{ 0x6C, 0x10410150 }  // CHOPCONF
+};
+
 // Register access permissions:
 //   0x00: none (reserved)
 //   0x01: read
@@ -92,6 +252,93 @@ static const uint8_t tmc5160_defaultRegisterAccess[TMC5160_REGISTER_COUNT] =
 	0x42, 0x01, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Read cache max age in ticks, 0: not cached (only used with TMC5160_READ_CACHE)
+// Status registers that are commonly polled by several checks per tick.
+static const uint8_t tmc5160_defaultRegisterMaxAge[TMC5160_REGISTER_COUNT] =
+{
+//	0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x00 - 0x0F
+	____, ____, 1,    ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x10 - 0x1F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x20 - 0x2F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x30 - 0x3F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x40 - 0x4F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x50 - 0x5F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, 1,    // 0x60 - 0x6F
+	____, 1,    1,    1,    ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
+};
+
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc5160_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc5160_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20,
+	0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x33, 0x34, 0x35, 0x38, 0x39,
+	0x3A, 0x3B, 0x3D, 0x6C, 0x6D, 0x6E
+};
+
+static const uint8_t tmc5160_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20,
+	0x21, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x33, 0x34, 0x35, 0x38, 0x39,
+	0x3A, 0x3B, 0x3D, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6C, 0x6D, 0x6E,
+	0x70
+};
+
+// Write order constraints, see WriteOrder.h. The driver strength and the motor
+// current have to be set before CHOPCONF enables the driver. The register lists
+// above and the dirty bitmap walk (ascending addresses) respect them.
+static const TMCWriteOrder tmc5160_writeOrder[] =
+{
+	{ TMC5160_DRV_CONF, TMC5160_CHOPCONF },
+	{ TMC5160_GLOBAL_SCALER, TMC5160_CHOPCONF },
+	{ TMC5160_IHOLD_IRUN, TMC5160_CHOPCONF },
+};
+
+// Registers compared against the shadow registers by the consistency check.
+// Derived from tmc5160_defaultRegisterAccess - keep both in sync. Read/write
+// registers without flag or separate read/write semantics, except XACTUAL and
+// X_ENC, which are changed by the IC itself.
+static const uint8_t tmc5160_consistencyRegisters[] =
+{
+	0x00, 0x08, 0x20, 0x2D, 0x34, 0x38, 0x6C
+};
+
+// Registers published by tmc5160_publishTelemetry(), in snapshot order
+static const uint8_t tmc5160_telemetryRegisters[] =
+{
+	TMC5160_XACTUAL, TMC5160_VACTUAL, TMC5160_RAMPSTAT, TMC5160_DRVSTATUS
+};
+
+typedef enum {
+	TMC5160_TELEMETRY_XACTUAL,
+	TMC5160_TELEMETRY_VACTUAL,
+	TMC5160_TELEMETRY_RAMPSTAT,
+	TMC5160_TELEMETRY_DRVSTATUS,
+	TMC5160_TELEMETRY_COUNT
+} TMC5160TelemetryIndex;
+
+// Shadow register slots (only used with TMC_SHADOW_SPARSE)
+// Derived from tmc5160_defaultRegisterAccess - keep both in sync.
+// Registers without access share the unused slot 0.
+#define TMC5160_SHADOW_SLOTS 63
+
+static const uint8_t tmc5160_shadowIndex[TMC5160_REGISTER_COUNT] =
+{
+//	0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, ____, ____, ____, // 0x00 - 0x0F
+	0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x10 - 0x1F
+	0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, ____, 0x1D, 0x1E, 0x1F, 0x20, ____, ____, // 0x20 - 0x2F
+	____, ____, ____, 0x21, 0x22, 0x23, 0x24, ____, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, ____, ____, // 0x30 - 0x3F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x40 - 0x4F
+	____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, // 0x50 - 0x5F
+	0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, // 0x60 - 0x6F
+	0x3B, 0x3C, 0x3D, 0x3E, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
+};
+
 // Register constants (only required for 0x42 registers, since we do not have
 // any way to find out the content but want to hold the actual value in the
 // shadow register so an application (i.e. the TMCL IDE) can still display
@@ -114,14 +361,60 @@ static const TMCRegisterConstant tmc5160_RegisterConstants[] =
 void tmc5160_writeDatagram(TMC5160TypeDef *tmc5160, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5160_writeInt(TMC5160TypeDef *tmc5160, uint8_t address, int32_t value);
 int32_t tmc5160_readInt(TMC5160TypeDef *tmc5160, uint8_t address);
+int32_t tmc5160_readRegister(TMC5160TypeDef *tmc5160, uint8_t address);
+void tmc5160_readIntBatch(TMC5160TypeDef *tmc5160, const uint8_t *addresses, int32_t *values, size_t count);
+
+void tmc5160_chainInit(TMC5160ChainTypeDef *chain, uint8_t channel, TMC5160TypeDef **ics, uint8_t count);
+void tmc5160_chainWriteInt(TMC5160ChainTypeDef *chain, const uint8_t *addresses, const int32_t *values);
+void tmc5160_chainWriteIntAll(TMC5160ChainTypeDef *chain, uint8_t address, int32_t value);
+void tmc5160_chainReadInt(TMC5160ChainTypeDef *chain, const uint8_t *addresses, int32_t *values);
+void tmc5160_chainMoveTo(TMC5160ChainTypeDef *chain, const int32_t *positions, const uint32_t *velocities);
+void tmc5160_chainSampleLoad(TMC5160ChainTypeDef *chain, TMCLoadStream *stream, uint32_t tick);
+
+void tmc5160_syncBatchInit(TMC5160SyncBatchTypeDef *batch);
+bool tmc5160_syncBatchAdd(TMC5160SyncBatchTypeDef *batch, TMC5160TypeDef *tmc5160, uint8_t address, int32_t value);
+bool tmc5160_syncBatchCommit(TMC5160SyncBatchTypeDef *batch);
+bool tmc5160_syncBatchFire(TMC5160SyncBatchTypeDef *batch);
+#ifdef TMC5160_ASYNC
+TMCAsyncRequestTypeDef *tmc5160_writeIntAsync(TMC5160TypeDef *tmc5160, TMCAsyncRequestTypeDef *request, uint8_t address, int32_t value, tmc_async_callback callback, void *userData);
+TMCAsyncRequestTypeDef *tmc5160_readIntAsync(TMC5160TypeDef *tmc5160, TMCAsyncRequestTypeDef *request, uint8_t address, tmc_async_callback callback, void *userData);
+#endif
 
 void tmc5160_init(TMC5160TypeDef *tmc5160, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
+#if TMC_FEATURE_SHADOW
 void tmc5160_fillShadowRegisters(TMC5160TypeDef *tmc5160);
+#endif
+#if TMC_FEATURE_CONFIG
 uint8_t tmc5160_reset(TMC5160TypeDef *tmc5160);
+uint8_t tmc5160_resetFromPowerOn(TMC5160TypeDef *tmc5160);
 uint8_t tmc5160_restore(TMC5160TypeDef *tmc5160);
 void tmc5160_setRegisterResetState(TMC5160TypeDef *tmc5160, const int32_t *resetState);
+void tmc5160_setRegisterResetDiff(TMC5160TypeDef *tmc5160, const TMCRegisterConstant *diff, size_t count);
+uint8_t tmc5160_loadRegisterResetState(TMC5160TypeDef *tmc5160, const uint8_t *blob, size_t size);
 void tmc5160_setCallback(TMC5160TypeDef *tmc5160, tmc5160_callback callback);
-void tmc5160_periodicJob(TMC5160TypeDef *tmc5160, uint32_t tick);
+#endif
+TMCConfigStatus tmc5160_periodicJob(TMC5160TypeDef *tmc5160, uint32_t tick);
+void tmc5160_periodicJobFast(TMC5160TypeDef *tmc5160, uint32_t tick);
+TMCConfigStatus tmc5160_periodicJobBackground(TMC5160TypeDef *tmc5160, uint32_t tick);
+void tmc5160_setClockFrequency(TMC5160TypeDef *tmc5160, uint32_t clockFrequency);
+#if TMC_FEATURE_VELOCITY_ESTIMATE
+void tmc5160_setVelocitySource(TMC5160TypeDef *tmc5160, TMCVelocitySource source);
+#endif
+#if TMC_FEATURE_SPI_STATUS
+uint8_t tmc5160_getSpiStatus(TMC5160TypeDef *tmc5160, uint32_t *tick);
+void tmc5160_setSpiStatusCallback(TMC5160TypeDef *tmc5160, tmc_spi_statusCallback callback, uint8_t edgeMask);
+#endif
+#if TMC_FEATURE_CONFIG
+uint8_t tmc5160_configureBurst(TMC5160TypeDef *tmc5160, uint32_t maxSteps);
+#ifdef TMC5160_ASYNC
+bool tmc5160_configureStepAsync(TMC5160TypeDef *tmc5160, TMCAsyncRequestTypeDef *request);
+#endif
+size_t tmc5160_saveImage(TMC5160TypeDef *tmc5160, uint8_t *image, size_t size);
+uint8_t tmc5160_restoreImage(TMC5160TypeDef *tmc5160, const uint8_t *image, size_t size);
+uint8_t tmc5160_restoreIfLost(TMC5160TypeDef *tmc5160);
+uint8_t tmc5160_adopt(TMC5160TypeDef *tmc5160, const uint8_t *image, size_t size);
+#endif
+uint8_t tmc5160_onInterrupt(TMC5160TypeDef *tmc5160);
 
 void tmc5160_rotate(TMC5160TypeDef *tmc5160, int32_t velocity);
 void tmc5160_right(TMC5160TypeDef *tmc5160, uint32_t velocity);
@@ -129,7 +422,53 @@ void tmc5160_left(TMC5160TypeDef *tmc5160, uint32_t velocity);
 void tmc5160_stop(TMC5160TypeDef *tmc5160);
 void tmc5160_moveTo(TMC5160TypeDef *tmc5160, int32_t position, uint32_t velocityMax);
 void tmc5160_moveBy(TMC5160TypeDef *tmc5160, int32_t *ticks, uint32_t velocityMax);
+void tmc5160_writeRampProfile(TMC5160TypeDef *tmc5160, const TMCRampProfileTypeDef *profile);
+bool tmc5160_retarget(TMC5160TypeDef *tmc5160, TMCRetargetTypeDef *retarget, int32_t position, uint32_t velocityMax);
+bool tmc5160_retargetService(TMC5160TypeDef *tmc5160, TMCRetargetTypeDef *retarget);
+#if TMC_FEATURE_VIEW
+void tmc5160_setView(TMC5160TypeDef *tmc5160, TMCRegisterView *view);
+#endif
+int32_t tmc5160_fieldLookup(const char *name);
+int32_t tmc5160_fieldRead(TMC5160TypeDef *tmc5160, uint16_t field);
+void tmc5160_fieldWrite(TMC5160TypeDef *tmc5160, uint16_t field, int32_t value);
+void tmc5160_writeProfile(TMC5160TypeDef *tmc5160, const TMCConfigProfile *profile);
+void tmc5160_writeChopperThresholds(TMC5160TypeDef *tmc5160, const TMCChopperThresholdsTypeDef *thresholds);
+void tmc5160_writeDcStep(TMC5160TypeDef *tmc5160, const TMCDcStepPlanTypeDef *plan);
+bool tmc5160_dcStepLimiting(TMC5160TypeDef *tmc5160, const int32_t *telemetry);
+TMCHomingState tmc5160_home(TMC5160TypeDef *tmc5160, TMCHomingTypeDef *homing);
+TMCCoolStepTuneState tmc5160_tuneCoolStep(TMC5160TypeDef *tmc5160, TMCCoolStepTuneTypeDef *tune);
+void tmc5160_encoderMonitorInit(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor, uint32_t tolerance, uint16_t interval);
+bool tmc5160_encoderMonitorService(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor, uint32_t tick);
+void tmc5160_encoderMonitorClear(TMC5160TypeDef *tmc5160, TMC5160EncoderMonitorTypeDef *monitor);
+bool tmc5160_positionLoopService(TMC5160TypeDef *tmc5160, TMC_PositionLoop *loop, int32_t target, uint32_t tick);
 
+void tmc5160_moveQueueInit(TMC5160MoveQueueTypeDef *queue);
+bool tmc5160_moveQueuePush(TMC5160MoveQueueTypeDef *queue, const TMC5160MoveTypeDef *move);
+void tmc5160_moveQueueStage(TMC5160MoveQueueTypeDef *queue);
+bool tmc5160_moveQueueNext(TMC5160TypeDef *tmc5160, TMC5160MoveQueueTypeDef *queue);
+bool tmc5160_moveQueueService(TMC5160TypeDef *tmc5160, TMC5160MoveQueueTypeDef *queue);
+bool tmc5160_moveQueueIsDone(TMC5160MoveQueueTypeDef *queue);
+
+bool tmc5160_queueMoveTo(TMCCommandQueue *queue, int32_t position, uint32_t velocityMax);
+bool tmc5160_queueRotate(TMCCommandQueue *queue, int32_t velocity);
+uint8_t tmc5160_serviceQueue(TMC5160TypeDef *tmc5160, TMCCommandQueue *queue);
+void tmc5160_currentProfileInit(TMCCurrentProfile *profile, const TMCCurrentSetting *settings);
+bool tmc5160_currentProfileUpdate(TMCCurrentProfile *profile, TMCCommandQueue *queue, const int32_t *telemetry);
+bool tmc5160_thermalUpdate(TMC5160TypeDef *tmc5160, TMCThermalDerating *thermal, const int32_t *telemetry);
+void tmc5160_sampleLoad(TMC5160TypeDef *tmc5160, TMCLoadStream *stream, uint8_t axis, uint32_t tick);
+void tmc5160_telemetryRecord(const int32_t *telemetry, uint8_t axis, uint32_t timestamp, TMCTelemetryRecord *record);
+void tmc5160_publishTelemetry(TMC5160TypeDef *tmc5160, TMCSnapshot *snapshot, uint32_t tick);
+#if TMC_FEATURE_TELEMETRY
+void tmc5160_readTelemetry(TMC5160TypeDef *tmc5160, int32_t *values, uint32_t *tick);
+void tmc5160_readTelemetryStamped(TMC5160TypeDef *tmc5160, int32_t *values, uint32_t *tick, uint32_t *timestamp);
+void tmc5160_telemetryWake(TMC5160TypeDef *tmc5160);
+#endif
+
+#if TMC_FEATURE_CONSISTENCY
 uint8_t tmc5160_consistencyCheck(TMC5160TypeDef *tmc5160);
+uint8_t tmc5160_consistencyCheckStep(TMC5160TypeDef *tmc5160, uint8_t count);
+#endif
+
+extern const TMCICInterface tmc5160_interface;
 
 #endif /* TMC_IC_TMC5160_H_ */
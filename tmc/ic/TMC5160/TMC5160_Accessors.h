@@ -0,0 +1,151 @@
+/*
+ * TMC5160_Accessors.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Per register accessors of the TMC5160 with the access decision resolved at
+ *  compile time. Readable registers go straight to the bus, write-only ones are
+ *  read from the shadow register, read-only ones have no write accessor:
+ *
+ *    int32_t position = tmc5160_read_XACTUAL(&tmc5160);
+ *    tmc5160_write_VMAX(&tmc5160, 200000);
+ *
+ *  The accessors skip the access table lookup of tmc5160_readInt(), everything
+ *  else (locking, read cache, shadow, status capture) is the same. Flag registers
+ *  keep their semantics: A read returns the flags as the IC reports them, a
+ *  write of 1 bits clears them.
+ *  Not included by TMC5160.h - include it where the accessors are needed.
+ */
+
+#ifndef TMC_IC_TMC5160_TMC5160_ACCESSORS_H_
+#define TMC_IC_TMC5160_TMC5160_ACCESSORS_H_
+
+#include "TMC5160.h"
+
+// Shadow register read of a write-only register
+static inline int32_t tmc5160_readShadowRegister(TMC5160TypeDef *tmc5160, uint8_t address)
+{
+#if TMC_FEATURE_SHADOW
+	return TMC_SHADOW_REGISTER(tmc5160->config, address);
+#else
+	UNUSED(tmc5160);
+	UNUSED(address);
+	return 0;
+#endif
+}
+
+// Generated from TMC5160_Register.h and tmc5160_defaultRegisterAccess - regenerate both on changes.
+static inline int32_t tmc5160_read_GCONF(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_GCONF); }
+static inline void tmc5160_write_GCONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_GCONF, value); }
+static inline int32_t tmc5160_read_GSTAT(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_GSTAT); }
+static inline void tmc5160_write_GSTAT(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_GSTAT, value); }
+static inline int32_t tmc5160_read_IFCNT(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_IFCNT); }
+static inline int32_t tmc5160_read_SLAVECONF(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_SLAVECONF); }
+static inline void tmc5160_write_SLAVECONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_SLAVECONF, value); }
+static inline int32_t tmc5160_read_INP_OUT(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_INP_OUT); }
+static inline void tmc5160_write_INP_OUT(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_INP_OUT, value); }
+static inline int32_t tmc5160_read_X_COMPARE(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_X_COMPARE); }
+static inline void tmc5160_write_X_COMPARE(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_X_COMPARE, value); }
+static inline int32_t tmc5160_read_OTP_PROG(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_OTP_PROG); }
+static inline void tmc5160_write_OTP_PROG(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_OTP_PROG, value); }
+static inline int32_t tmc5160_read_OTP_READ(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_OTP_READ); }
+static inline int32_t tmc5160_read_FACTORY_CONF(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_FACTORY_CONF); }
+static inline void tmc5160_write_FACTORY_CONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_FACTORY_CONF, value); }
+static inline int32_t tmc5160_read_SHORT_CONF(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_SHORT_CONF); }
+static inline void tmc5160_write_SHORT_CONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_SHORT_CONF, value); }
+static inline int32_t tmc5160_read_DRV_CONF(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_DRV_CONF); }
+static inline void tmc5160_write_DRV_CONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_DRV_CONF, value); }
+static inline int32_t tmc5160_read_GLOBAL_SCALER(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_GLOBAL_SCALER); }
+static inline void tmc5160_write_GLOBAL_SCALER(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_GLOBAL_SCALER, value); }
+static inline int32_t tmc5160_read_OFFSET_READ(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_OFFSET_READ); }
+static inline int32_t tmc5160_read_IHOLD_IRUN(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_IHOLD_IRUN); }
+static inline void tmc5160_write_IHOLD_IRUN(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_IHOLD_IRUN, value); }
+static inline int32_t tmc5160_read_TPOWERDOWN(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_TPOWERDOWN); }
+static inline void tmc5160_write_TPOWERDOWN(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_TPOWERDOWN, value); }
+static inline int32_t tmc5160_read_TSTEP(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_TSTEP); }
+static inline int32_t tmc5160_read_TPWMTHRS(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_TPWMTHRS); }
+static inline void tmc5160_write_TPWMTHRS(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_TPWMTHRS, value); }
+static inline int32_t tmc5160_read_TCOOLTHRS(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_TCOOLTHRS); }
+static inline void tmc5160_write_TCOOLTHRS(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_TCOOLTHRS, value); }
+static inline int32_t tmc5160_read_THIGH(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_THIGH); }
+static inline void tmc5160_write_THIGH(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_THIGH, value); }
+static inline int32_t tmc5160_read_RAMPMODE(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_RAMPMODE); }
+static inline void tmc5160_write_RAMPMODE(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_RAMPMODE, value); }
+static inline int32_t tmc5160_read_XACTUAL(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_XACTUAL); }
+static inline void tmc5160_write_XACTUAL(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_XACTUAL, value); }
+static inline int32_t tmc5160_read_VACTUAL(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_VACTUAL); }
+static inline int32_t tmc5160_read_VSTART(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_VSTART); }
+static inline void tmc5160_write_VSTART(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_VSTART, value); }
+static inline int32_t tmc5160_read_A1(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_A1); }
+static inline void tmc5160_write_A1(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_A1, value); }
+static inline int32_t tmc5160_read_V1(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_V1); }
+static inline void tmc5160_write_V1(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_V1, value); }
+static inline int32_t tmc5160_read_AMAX(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_AMAX); }
+static inline void tmc5160_write_AMAX(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_AMAX, value); }
+static inline int32_t tmc5160_read_VMAX(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_VMAX); }
+static inline void tmc5160_write_VMAX(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_VMAX, value); }
+static inline int32_t tmc5160_read_DMAX(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_DMAX); }
+static inline void tmc5160_write_DMAX(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_DMAX, value); }
+static inline int32_t tmc5160_read_D1(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_D1); }
+static inline void tmc5160_write_D1(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_D1, value); }
+static inline int32_t tmc5160_read_VSTOP(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_VSTOP); }
+static inline void tmc5160_write_VSTOP(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_VSTOP, value); }
+static inline int32_t tmc5160_read_TZEROWAIT(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_TZEROWAIT); }
+static inline void tmc5160_write_TZEROWAIT(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_TZEROWAIT, value); }
+static inline int32_t tmc5160_read_XTARGET(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_XTARGET); }
+static inline void tmc5160_write_XTARGET(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_XTARGET, value); }
+static inline int32_t tmc5160_read_VDCMIN(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_VDCMIN); }
+static inline void tmc5160_write_VDCMIN(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_VDCMIN, value); }
+static inline int32_t tmc5160_read_SWMODE(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_SWMODE); }
+static inline void tmc5160_write_SWMODE(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_SWMODE, value); }
+static inline int32_t tmc5160_read_RAMPSTAT(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_RAMPSTAT); }
+static inline void tmc5160_write_RAMPSTAT(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_RAMPSTAT, value); }
+static inline int32_t tmc5160_read_XLATCH(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_XLATCH); }
+static inline int32_t tmc5160_read_ENCMODE(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_ENCMODE); }
+static inline void tmc5160_write_ENCMODE(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_ENCMODE, value); }
+static inline int32_t tmc5160_read_XENC(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_XENC); }
+static inline void tmc5160_write_XENC(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_XENC, value); }
+static inline int32_t tmc5160_read_ENC_CONST(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_ENC_CONST); }
+static inline void tmc5160_write_ENC_CONST(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_ENC_CONST, value); }
+static inline int32_t tmc5160_read_ENC_STATUS(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_ENC_STATUS); }
+static inline void tmc5160_write_ENC_STATUS(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_ENC_STATUS, value); }
+static inline int32_t tmc5160_read_ENC_LATCH(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_ENC_LATCH); }
+static inline int32_t tmc5160_read_ENC_DEVIATION(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_ENC_DEVIATION); }
+static inline void tmc5160_write_ENC_DEVIATION(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_ENC_DEVIATION, value); }
+static inline int32_t tmc5160_read_MSLUT0(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT0); }
+static inline void tmc5160_write_MSLUT0(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT0, value); }
+static inline int32_t tmc5160_read_MSLUT1(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT1); }
+static inline void tmc5160_write_MSLUT1(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT1, value); }
+static inline int32_t tmc5160_read_MSLUT2(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT2); }
+static inline void tmc5160_write_MSLUT2(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT2, value); }
+static inline int32_t tmc5160_read_MSLUT3(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT3); }
+static inline void tmc5160_write_MSLUT3(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT3, value); }
+static inline int32_t tmc5160_read_MSLUT4(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT4); }
+static inline void tmc5160_write_MSLUT4(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT4, value); }
+static inline int32_t tmc5160_read_MSLUT5(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT5); }
+static inline void tmc5160_write_MSLUT5(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT5, value); }
+static inline int32_t tmc5160_read_MSLUT6(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT6); }
+static inline void tmc5160_write_MSLUT6(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT6, value); }
+static inline int32_t tmc5160_read_MSLUT7(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUT7); }
+static inline void tmc5160_write_MSLUT7(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUT7, value); }
+static inline int32_t tmc5160_read_MSLUTSEL(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUTSEL); }
+static inline void tmc5160_write_MSLUTSEL(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUTSEL, value); }
+static inline int32_t tmc5160_read_MSLUTSTART(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_MSLUTSTART); }
+static inline void tmc5160_write_MSLUTSTART(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_MSLUTSTART, value); }
+static inline int32_t tmc5160_read_MSCNT(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_MSCNT); }
+static inline int32_t tmc5160_read_MSCURACT(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_MSCURACT); }
+static inline int32_t tmc5160_read_CHOPCONF(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_CHOPCONF); }
+static inline void tmc5160_write_CHOPCONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_CHOPCONF, value); }
+static inline int32_t tmc5160_read_COOLCONF(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_COOLCONF); }
+static inline void tmc5160_write_COOLCONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_COOLCONF, value); }
+static inline int32_t tmc5160_read_DCCTRL(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_DCCTRL); }
+static inline void tmc5160_write_DCCTRL(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_DCCTRL, value); }
+static inline int32_t tmc5160_read_DRVSTATUS(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_DRVSTATUS); }
+static inline int32_t tmc5160_read_PWMCONF(TMC5160TypeDef *tmc5160) { return tmc5160_readShadowRegister(tmc5160, TMC5160_PWMCONF); }
+static inline void tmc5160_write_PWMCONF(TMC5160TypeDef *tmc5160, int32_t value) { tmc5160_writeInt(tmc5160, TMC5160_PWMCONF, value); }
+static inline int32_t tmc5160_read_PWMSCALE(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_PWMSCALE); }
+static inline int32_t tmc5160_read_PWM_AUTO(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_PWM_AUTO); }
+static inline int32_t tmc5160_read_LOST_STEPS(TMC5160TypeDef *tmc5160) { return tmc5160_readRegister(tmc5160, TMC5160_LOST_STEPS); }
+
+#endif /* TMC_IC_TMC5160_TMC5160_ACCESSORS_H_ */
@@ -0,0 +1,584 @@
+/*
+ * TMC5160_Descriptors.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Field descriptor table and field name index of the TMC5160,
+ *  see tmc/helpers/RegisterDescriptor.h.
+ *  Not included by TMC5160.h - include it where the table is needed.
+ */
+
+#ifndef TMC_IC_TMC5160_TMC5160_DESCRIPTORS_H_
+#define TMC_IC_TMC5160_TMC5160_DESCRIPTORS_H_
+
+#include "tmc/helpers/RegisterDescriptor.h"
+
+// Fields ascending by address and shift.
+// Generated from TMC5160_Fields.h and tmc5160_defaultRegisterAccess - regenerate both on changes.
+static const TMCFieldDescriptor tmc5160_fieldDescriptors[] =
+{
+	TMC_FIELD(0x00,  0,  1, 0, 0), // GCONF.RECALIBRATE
+	TMC_FIELD(0x00,  1,  1, 0, 0), // GCONF.FASTSTANDSTILL
+	TMC_FIELD(0x00,  2,  1, 0, 0), // GCONF.EN_PWM_MODE
+	TMC_FIELD(0x00,  3,  1, 0, 0), // GCONF.MULTISTEP_FILT
+	TMC_FIELD(0x00,  4,  1, 0, 0), // GCONF.SHAFT
+	TMC_FIELD(0x00,  5,  1, 0, 0), // GCONF.DIAG0_ERROR_ONLY_WITH_SD_MODE1
+	TMC_FIELD(0x00,  6,  1, 0, 0), // GCONF.DIAG0_OTPW_ONLY_WITH_SD_MODE1
+	TMC_FIELD(0x00,  7,  1, 0, 0), // GCONF.DIAG0_STALL
+	TMC_FIELD(0x00,  7,  1, 0, 0), // GCONF.DIAG0_STEP
+	TMC_FIELD(0x00,  8,  1, 0, 0), // GCONF.DIAG1_STALL
+	TMC_FIELD(0x00,  8,  1, 0, 0), // GCONF.DIAG1_DIR
+	TMC_FIELD(0x00,  9,  1, 0, 0), // GCONF.DIAG1_INDEX
+	TMC_FIELD(0x00, 10,  1, 0, 0), // GCONF.DIAG1_ONSTATE
+	TMC_FIELD(0x00, 11,  1, 0, 0), // GCONF.DIAG1_STEPS_SKIPPED
+	TMC_FIELD(0x00, 12,  1, 0, 0), // GCONF.DIAG0_INT_PUSHPULL
+	TMC_FIELD(0x00, 13,  1, 0, 0), // GCONF.DIAG1_POSCOMP_PUSHPULL
+	TMC_FIELD(0x00, 14,  1, 0, 0), // GCONF.SMALL_HYSTERESIS
+	TMC_FIELD(0x00, 15,  1, 0, 0), // GCONF.STOP_ENABLE
+	TMC_FIELD(0x00, 16,  1, 0, 0), // GCONF.DIRECT_MODE
+	TMC_FIELD(0x00, 17,  1, 0, 0), // GCONF.TEST_MODE
+	TMC_FIELD(0x01,  0,  1, 0, 1), // GSTAT.RESET
+	TMC_FIELD(0x01,  1,  1, 0, 1), // GSTAT.DRV_ERR
+	TMC_FIELD(0x01,  2,  1, 0, 1), // GSTAT.UV_CP
+	TMC_FIELD(0x02,  0,  8, 0, 0), // IFCNT.IFCNT
+	TMC_FIELD(0x03,  0,  8, 0, 0), // SLAVECONF.SLAVEADDR
+	TMC_FIELD(0x03,  8,  4, 0, 0), // SLAVECONF.SENDDELAY
+	TMC_FIELD(0x05,  0, 32, 0, 0), // X_COMPARE.X_COMPARE
+	TMC_FIELD(0x06,  0,  3, 0, 0), // OTP_PROG.OTPBIT
+	TMC_FIELD(0x06,  4,  2, 0, 0), // OTP_PROG.OTPBYTE
+	TMC_FIELD(0x06,  8,  8, 0, 0), // OTP_PROG.OTPMAGIC
+	TMC_FIELD(0x07,  0,  5, 0, 0), // OTP_READ.OTP_FCLKTRIM
+	TMC_FIELD(0x07,  5,  1, 0, 0), // OTP_READ.OTP_S2_LEVEL
+	TMC_FIELD(0x07,  6,  1, 0, 0), // OTP_READ.OTP_BBM
+	TMC_FIELD(0x07,  7,  1, 0, 0), // OTP_READ.OTP_TBL
+	TMC_FIELD(0x08,  0,  5, 0, 0), // FACTORY_CONF.FCLKTRIM
+	TMC_FIELD(0x09,  0,  4, 0, 0), // SHORT_CONF.S2VS_LEVEL
+	TMC_FIELD(0x09,  8,  4, 0, 0), // SHORT_CONF.S2GND_LEVEL
+	TMC_FIELD(0x09, 16,  2, 0, 0), // SHORT_CONF.SHORTFILTER
+	TMC_FIELD(0x09, 18,  1, 0, 0), // SHORT_CONF.SHORTDELAY
+	TMC_FIELD(0x0A,  0,  5, 0, 0), // DRV_CONF.BBMTIME
+	TMC_FIELD(0x0A,  8,  4, 0, 0), // DRV_CONF.BBMCLKS
+	TMC_FIELD(0x0A, 16,  2, 0, 0), // DRV_CONF.OTSELECT
+	TMC_FIELD(0x0A, 18,  2, 0, 0), // DRV_CONF.DRVSTRENGTH
+	TMC_FIELD(0x0A, 20,  2, 0, 0), // DRV_CONF.FILT_ISENSE
+	TMC_FIELD(0x0B,  0,  8, 0, 0), // GLOBAL_SCALER.GLOBAL_SCALER
+	TMC_FIELD(0x10,  0,  5, 0, 0), // IHOLD_IRUN.IHOLD
+	TMC_FIELD(0x10,  8,  5, 0, 0), // IHOLD_IRUN.IRUN
+	TMC_FIELD(0x10, 16,  4, 0, 0), // IHOLD_IRUN.IHOLDDELAY
+	TMC_FIELD(0x11,  0,  8, 0, 0), // TPOWERDOWN.TPOWERDOWN
+	TMC_FIELD(0x12,  0, 20, 0, 0), // TSTEP.TSTEP
+	TMC_FIELD(0x13,  0, 20, 0, 0), // TPWMTHRS.TPWMTHRS
+	TMC_FIELD(0x14,  0, 20, 0, 0), // TCOOLTHRS.TCOOLTHRS
+	TMC_FIELD(0x15,  0, 20, 0, 0), // THIGH.THIGH
+	TMC_FIELD(0x20,  0,  2, 0, 0), // RAMPMODE.RAMPMODE
+	TMC_FIELD(0x21,  0, 32, 1, 0), // XACTUAL.XACTUAL
+	TMC_FIELD(0x22,  0, 24, 1, 0), // VACTUAL.VACTUAL
+	TMC_FIELD(0x23,  0, 18, 0, 0), // VSTART.VSTART
+	TMC_FIELD(0x24,  0, 16, 0, 0), // A1.A1
+	TMC_FIELD(0x25,  0, 20, 0, 0), // V1.V1_
+	TMC_FIELD(0x26,  0, 16, 0, 0), // AMAX.AMAX
+	TMC_FIELD(0x27,  0, 23, 0, 0), // VMAX.VMAX
+	TMC_FIELD(0x28,  0, 16, 0, 0), // DMAX.DMAX
+	TMC_FIELD(0x2A,  0, 16, 0, 0), // D1.D1
+	TMC_FIELD(0x2B,  0, 18, 0, 0), // VSTOP.VSTOP
+	TMC_FIELD(0x2C,  0, 16, 0, 0), // TZEROWAIT.TZEROWAIT
+	TMC_FIELD(0x2D,  0, 32, 1, 0), // XTARGET.XTARGET
+	TMC_FIELD(0x33,  0, 23, 0, 0), // VDCMIN.VDCMIN
+	TMC_FIELD(0x34,  0,  1, 0, 0), // SW_MODE.STOP_L_ENABLE
+	TMC_FIELD(0x34,  1,  1, 0, 0), // SW_MODE.STOP_R_ENABLE
+	TMC_FIELD(0x34,  2,  1, 0, 0), // SW_MODE.POL_STOP_L
+	TMC_FIELD(0x34,  3,  1, 0, 0), // SW_MODE.POL_STOP_R
+	TMC_FIELD(0x34,  4,  1, 0, 0), // SW_MODE.SWAP_LR
+	TMC_FIELD(0x34,  5,  1, 0, 0), // SW_MODE.LATCH_L_ACTIVE
+	TMC_FIELD(0x34,  6,  1, 0, 0), // SW_MODE.LATCH_L_INACTIVE
+	TMC_FIELD(0x34,  7,  1, 0, 0), // SW_MODE.LATCH_R_ACTIVE
+	TMC_FIELD(0x34,  8,  1, 0, 0), // SW_MODE.LATCH_R_INACTIVE
+	TMC_FIELD(0x34,  9,  1, 0, 0), // SW_MODE.EN_LATCH_ENCODER
+	TMC_FIELD(0x34, 10,  1, 0, 0), // SW_MODE.SG_STOP
+	TMC_FIELD(0x34, 11,  1, 0, 0), // SW_MODE.EN_SOFTSTOP
+	TMC_FIELD(0x35,  0,  1, 0, 0), // RAMP_STAT.STATUS_STOP_L
+	TMC_FIELD(0x35,  1,  1, 0, 0), // RAMP_STAT.STATUS_STOP_R
+	TMC_FIELD(0x35,  2,  1, 0, 1), // RAMP_STAT.STATUS_LATCH_L
+	TMC_FIELD(0x35,  3,  1, 0, 1), // RAMP_STAT.STATUS_LATCH_R
+	TMC_FIELD(0x35,  4,  1, 0, 0), // RAMP_STAT.EVENT_STOP_L
+	TMC_FIELD(0x35,  5,  1, 0, 0), // RAMP_STAT.EVENT_STOP_R
+	TMC_FIELD(0x35,  6,  1, 0, 1), // RAMP_STAT.EVENT_STOP_SG
+	TMC_FIELD(0x35,  7,  1, 0, 1), // RAMP_STAT.EVENT_POS_REACHED
+	TMC_FIELD(0x35,  8,  1, 0, 0), // RAMP_STAT.VELOCITY_REACHED
+	TMC_FIELD(0x35,  9,  1, 0, 0), // RAMP_STAT.POSITION_REACHED
+	TMC_FIELD(0x35, 10,  1, 0, 0), // RAMP_STAT.VZERO
+	TMC_FIELD(0x35, 11,  1, 0, 0), // RAMP_STAT.T_ZEROWAIT_ACTIVE
+	TMC_FIELD(0x35, 12,  1, 0, 1), // RAMP_STAT.SECOND_MOVE
+	TMC_FIELD(0x35, 13,  1, 0, 0), // RAMP_STAT.STATUS_SG
+	TMC_FIELD(0x36,  0, 32, 0, 0), // XLATCH.XLATCH
+	TMC_FIELD(0x38,  0,  1, 0, 0), // ENCMODE.POL_A
+	TMC_FIELD(0x38,  1,  1, 0, 0), // ENCMODE.POL_B
+	TMC_FIELD(0x38,  2,  1, 0, 0), // ENCMODE.POL_N
+	TMC_FIELD(0x38,  3,  1, 0, 0), // ENCMODE.IGNORE_AB
+	TMC_FIELD(0x38,  4,  1, 0, 0), // ENCMODE.CLR_CONT
+	TMC_FIELD(0x38,  5,  1, 0, 0), // ENCMODE.CLR_ONCE
+	TMC_FIELD(0x38,  6,  2, 0, 0), // ENCMODE.POS_EDGENEG_EDGE
+	TMC_FIELD(0x38,  8,  1, 0, 0), // ENCMODE.CLR_ENC_X
+	TMC_FIELD(0x38,  9,  1, 0, 0), // ENCMODE.LATCH_X_ACT
+	TMC_FIELD(0x38, 10,  1, 0, 0), // ENCMODE.ENC_SEL_DECIMAL
+	TMC_FIELD(0x39,  0, 32, 1, 0), // X_ENC.X_ENC
+	TMC_FIELD(0x3A,  0, 16, 0, 0), // ENC_CONST.FRACTIONAL
+	TMC_FIELD(0x3A, 16, 16, 0, 0), // ENC_CONST.INTEGER
+	TMC_FIELD(0x3B,  0,  1, 0, 0), // ENC_STATUS.N_EVENT
+	TMC_FIELD(0x3B,  1,  1, 0, 1), // ENC_STATUS.DEVIATION_WARN
+	TMC_FIELD(0x3C,  0, 32, 1, 0), // ENC_LATCH.ENC_LATCH
+	TMC_FIELD(0x3D,  0, 20, 0, 0), // ENC_DEVIATION.ENC_DEVIATION
+	TMC_FIELD(0x68,  0,  2, 0, 0), // MSLUTSEL.W0
+	TMC_FIELD(0x68,  2,  2, 0, 0), // MSLUTSEL.W1
+	TMC_FIELD(0x68,  4,  2, 0, 0), // MSLUTSEL.W2
+	TMC_FIELD(0x68,  6,  2, 0, 0), // MSLUTSEL.W3
+	TMC_FIELD(0x68,  8,  8, 0, 0), // MSLUTSEL.X1
+	TMC_FIELD(0x68, 16,  8, 0, 0), // MSLUTSEL.X2
+	TMC_FIELD(0x68, 24,  8, 0, 0), // MSLUTSEL.X3
+	TMC_FIELD(0x69,  0,  8, 0, 0), // MSLUTSTART.START_SIN
+	TMC_FIELD(0x69, 16,  8, 0, 0), // MSLUTSTART.START_SIN90
+	TMC_FIELD(0x6A,  0, 10, 0, 0), // MSCNT.MSCNT
+	TMC_FIELD(0x6B,  0,  9, 1, 0), // MSCURACT.CUR_A
+	TMC_FIELD(0x6B, 16,  9, 1, 0), // MSCURACT.CUR_B
+	TMC_FIELD(0x6C,  0,  4, 0, 0), // CHOPCONF.TOFF
+	TMC_FIELD(0x6C,  4,  3, 0, 0), // CHOPCONF.TFD_ALL
+	TMC_FIELD(0x6C,  4,  3, 0, 0), // CHOPCONF.HSTRT
+	TMC_FIELD(0x6C,  7,  4, 0, 0), // CHOPCONF.OFFSET
+	TMC_FIELD(0x6C,  7,  4, 0, 0), // CHOPCONF.HEND
+	TMC_FIELD(0x6C, 11,  1, 0, 0), // CHOPCONF.TFD_3
+	TMC_FIELD(0x6C, 12,  1, 0, 0), // CHOPCONF.DISFDCC
+	TMC_FIELD(0x6C, 13,  1, 0, 0), // CHOPCONF.RNDTF
+	TMC_FIELD(0x6C, 14,  1, 0, 0), // CHOPCONF.CHM
+	TMC_FIELD(0x6C, 15,  2, 0, 0), // CHOPCONF.TBL
+	TMC_FIELD(0x6C, 17,  1, 0, 0), // CHOPCONF.VSENSE
+	TMC_FIELD(0x6C, 18,  1, 0, 0), // CHOPCONF.VHIGHFS
+	TMC_FIELD(0x6C, 19,  1, 0, 0), // CHOPCONF.VHIGHCHM
+	TMC_FIELD(0x6C, 20,  4, 0, 0), // CHOPCONF.TPFD
+	TMC_FIELD(0x6C, 24,  4, 0, 0), // CHOPCONF.MRES
+	TMC_FIELD(0x6C, 28,  1, 0, 0), // CHOPCONF.INTPOL
+	TMC_FIELD(0x6C, 29,  1, 0, 0), // CHOPCONF.DEDGE
+	TMC_FIELD(0x6C, 30,  1, 0, 0), // CHOPCONF.DISS2G
+	TMC_FIELD(0x6C, 31,  1, 0, 0), // CHOPCONF.DISS2VS
+	TMC_FIELD(0x6D,  0,  4, 0, 0), // COOLCONF.SEMIN
+	TMC_FIELD(0x6D,  5,  2, 0, 0), // COOLCONF.SEUP
+	TMC_FIELD(0x6D,  8,  4, 0, 0), // COOLCONF.SEMAX
+	TMC_FIELD(0x6D, 13,  2, 0, 0), // COOLCONF.SEDN
+	TMC_FIELD(0x6D, 15,  1, 0, 0), // COOLCONF.SEIMIN
+	TMC_FIELD(0x6D, 16,  7, 1, 0), // COOLCONF.SGT
+	TMC_FIELD(0x6D, 24,  1, 0, 0), // COOLCONF.SFILT
+	TMC_FIELD(0x6E,  0, 10, 0, 0), // DCCTRL.DC_TIME
+	TMC_FIELD(0x6E, 16,  8, 0, 0), // DCCTRL.DC_SG
+	TMC_FIELD(0x6F,  0, 10, 0, 0), // DRV_STATUS.SG_RESULT
+	TMC_FIELD(0x6F, 12,  1, 0, 0), // DRV_STATUS.S2VSA
+	TMC_FIELD(0x6F, 13,  1, 0, 0), // DRV_STATUS.S2VSB
+	TMC_FIELD(0x6F, 14,  1, 0, 0), // DRV_STATUS.STEALTH
+	TMC_FIELD(0x6F, 15,  1, 0, 0), // DRV_STATUS.FSACTIVE
+	TMC_FIELD(0x6F, 16,  5, 0, 0), // DRV_STATUS.CS_ACTUAL
+	TMC_FIELD(0x6F, 24,  1, 0, 0), // DRV_STATUS.STALLGUARD
+	TMC_FIELD(0x6F, 25,  1, 0, 0), // DRV_STATUS.OT
+	TMC_FIELD(0x6F, 26,  1, 0, 0), // DRV_STATUS.OTPW
+	TMC_FIELD(0x6F, 27,  1, 0, 0), // DRV_STATUS.S2GA
+	TMC_FIELD(0x6F, 28,  1, 0, 0), // DRV_STATUS.S2GB
+	TMC_FIELD(0x6F, 29,  1, 0, 0), // DRV_STATUS.OLA
+	TMC_FIELD(0x6F, 30,  1, 0, 0), // DRV_STATUS.OLB
+	TMC_FIELD(0x6F, 31,  1, 0, 0), // DRV_STATUS.STST
+	TMC_FIELD(0x70,  0,  8, 0, 0), // PWMCONF.PWM_OFS
+	TMC_FIELD(0x70,  8,  8, 0, 0), // PWMCONF.PWM_GRAD
+	TMC_FIELD(0x70, 16,  2, 0, 0), // PWMCONF.PWM_FREQ
+	TMC_FIELD(0x70, 18,  1, 0, 0), // PWMCONF.PWM_AUTOSCALE
+	TMC_FIELD(0x70, 19,  1, 0, 0), // PWMCONF.PWM_AUTOGRAD
+	TMC_FIELD(0x70, 20,  2, 0, 0), // PWMCONF.FREEWHEEL
+	TMC_FIELD(0x70, 24,  4, 0, 0), // PWMCONF.PWM_REG
+	TMC_FIELD(0x70, 28,  4, 0, 0), // PWMCONF.PWM_LIM
+	TMC_FIELD(0x71,  0,  8, 0, 0), // PWM_SCALE.PWM_SCALE_SUM
+	TMC_FIELD(0x71, 16,  9, 1, 0), // PWM_SCALE.PWM_SCALE_AUTO
+	TMC_FIELD(0x72,  0,  8, 0, 0), // PWM_AUTO.PWM_OFS_AUTO
+	TMC_FIELD(0x72, 16,  8, 0, 0), // PWM_AUTO.PWM_GRAD_AUTO
+	TMC_FIELD(0x73,  0, 20, 0, 0)  // LOST_STEPS.LOST_STEPS
+};
+
+typedef enum {
+	TMC5160_FIELD_RECALIBRATE,
+	TMC5160_FIELD_FASTSTANDSTILL,
+	TMC5160_FIELD_EN_PWM_MODE,
+	TMC5160_FIELD_MULTISTEP_FILT,
+	TMC5160_FIELD_SHAFT,
+	TMC5160_FIELD_DIAG0_ERROR_ONLY_WITH_SD_MODE1,
+	TMC5160_FIELD_DIAG0_OTPW_ONLY_WITH_SD_MODE1,
+	TMC5160_FIELD_DIAG0_STALL,
+	TMC5160_FIELD_DIAG0_STEP,
+	TMC5160_FIELD_DIAG1_STALL,
+	TMC5160_FIELD_DIAG1_DIR,
+	TMC5160_FIELD_DIAG1_INDEX,
+	TMC5160_FIELD_DIAG1_ONSTATE,
+	TMC5160_FIELD_DIAG1_STEPS_SKIPPED,
+	TMC5160_FIELD_DIAG0_INT_PUSHPULL,
+	TMC5160_FIELD_DIAG1_POSCOMP_PUSHPULL,
+	TMC5160_FIELD_SMALL_HYSTERESIS,
+	TMC5160_FIELD_STOP_ENABLE,
+	TMC5160_FIELD_DIRECT_MODE,
+	TMC5160_FIELD_TEST_MODE,
+	TMC5160_FIELD_RESET,
+	TMC5160_FIELD_DRV_ERR,
+	TMC5160_FIELD_UV_CP,
+	TMC5160_FIELD_IFCNT,
+	TMC5160_FIELD_SLAVEADDR,
+	TMC5160_FIELD_SENDDELAY,
+	TMC5160_FIELD_X_COMPARE,
+	TMC5160_FIELD_OTPBIT,
+	TMC5160_FIELD_OTPBYTE,
+	TMC5160_FIELD_OTPMAGIC,
+	TMC5160_FIELD_OTP_FCLKTRIM,
+	TMC5160_FIELD_OTP_S2_LEVEL,
+	TMC5160_FIELD_OTP_BBM,
+	TMC5160_FIELD_OTP_TBL,
+	TMC5160_FIELD_FCLKTRIM,
+	TMC5160_FIELD_S2VS_LEVEL,
+	TMC5160_FIELD_S2GND_LEVEL,
+	TMC5160_FIELD_SHORTFILTER,
+	TMC5160_FIELD_SHORTDELAY,
+	TMC5160_FIELD_BBMTIME,
+	TMC5160_FIELD_BBMCLKS,
+	TMC5160_FIELD_OTSELECT,
+	TMC5160_FIELD_DRVSTRENGTH,
+	TMC5160_FIELD_FILT_ISENSE,
+	TMC5160_FIELD_GLOBAL_SCALER,
+	TMC5160_FIELD_IHOLD,
+	TMC5160_FIELD_IRUN,
+	TMC5160_FIELD_IHOLDDELAY,
+	TMC5160_FIELD_TPOWERDOWN,
+	TMC5160_FIELD_TSTEP,
+	TMC5160_FIELD_TPWMTHRS,
+	TMC5160_FIELD_TCOOLTHRS,
+	TMC5160_FIELD_THIGH,
+	TMC5160_FIELD_RAMPMODE,
+	TMC5160_FIELD_XACTUAL,
+	TMC5160_FIELD_VACTUAL,
+	TMC5160_FIELD_VSTART,
+	TMC5160_FIELD_A1,
+	TMC5160_FIELD_V1_,
+	TMC5160_FIELD_AMAX,
+	TMC5160_FIELD_VMAX,
+	TMC5160_FIELD_DMAX,
+	TMC5160_FIELD_D1,
+	TMC5160_FIELD_VSTOP,
+	TMC5160_FIELD_TZEROWAIT,
+	TMC5160_FIELD_XTARGET,
+	TMC5160_FIELD_VDCMIN,
+	TMC5160_FIELD_STOP_L_ENABLE,
+	TMC5160_FIELD_STOP_R_ENABLE,
+	TMC5160_FIELD_POL_STOP_L,
+	TMC5160_FIELD_POL_STOP_R,
+	TMC5160_FIELD_SWAP_LR,
+	TMC5160_FIELD_LATCH_L_ACTIVE,
+	TMC5160_FIELD_LATCH_L_INACTIVE,
+	TMC5160_FIELD_LATCH_R_ACTIVE,
+	TMC5160_FIELD_LATCH_R_INACTIVE,
+	TMC5160_FIELD_EN_LATCH_ENCODER,
+	TMC5160_FIELD_SG_STOP,
+	TMC5160_FIELD_EN_SOFTSTOP,
+	TMC5160_FIELD_STATUS_STOP_L,
+	TMC5160_FIELD_STATUS_STOP_R,
+	TMC5160_FIELD_STATUS_LATCH_L,
+	TMC5160_FIELD_STATUS_LATCH_R,
+	TMC5160_FIELD_EVENT_STOP_L,
+	TMC5160_FIELD_EVENT_STOP_R,
+	TMC5160_FIELD_EVENT_STOP_SG,
+	TMC5160_FIELD_EVENT_POS_REACHED,
+	TMC5160_FIELD_VELOCITY_REACHED,
+	TMC5160_FIELD_POSITION_REACHED,
+	TMC5160_FIELD_VZERO,
+	TMC5160_FIELD_T_ZEROWAIT_ACTIVE,
+	TMC5160_FIELD_SECOND_MOVE,
+	TMC5160_FIELD_STATUS_SG,
+	TMC5160_FIELD_XLATCH,
+	TMC5160_FIELD_POL_A,
+	TMC5160_FIELD_POL_B,
+	TMC5160_FIELD_POL_N,
+	TMC5160_FIELD_IGNORE_AB,
+	TMC5160_FIELD_CLR_CONT,
+	TMC5160_FIELD_CLR_ONCE,
+	TMC5160_FIELD_POS_EDGENEG_EDGE,
+	TMC5160_FIELD_CLR_ENC_X,
+	TMC5160_FIELD_LATCH_X_ACT,
+	TMC5160_FIELD_ENC_SEL_DECIMAL,
+	TMC5160_FIELD_X_ENC,
+	TMC5160_FIELD_FRACTIONAL,
+	TMC5160_FIELD_INTEGER,
+	TMC5160_FIELD_N_EVENT,
+	TMC5160_FIELD_DEVIATION_WARN,
+	TMC5160_FIELD_ENC_LATCH,
+	TMC5160_FIELD_ENC_DEVIATION,
+	TMC5160_FIELD_W0,
+	TMC5160_FIELD_W1,
+	TMC5160_FIELD_W2,
+	TMC5160_FIELD_W3,
+	TMC5160_FIELD_X1,
+	TMC5160_FIELD_X2,
+	TMC5160_FIELD_X3,
+	TMC5160_FIELD_START_SIN,
+	TMC5160_FIELD_START_SIN90,
+	TMC5160_FIELD_MSCNT,
+	TMC5160_FIELD_CUR_A,
+	TMC5160_FIELD_CUR_B,
+	TMC5160_FIELD_TOFF,
+	TMC5160_FIELD_TFD_ALL,
+	TMC5160_FIELD_HSTRT,
+	TMC5160_FIELD_OFFSET,
+	TMC5160_FIELD_HEND,
+	TMC5160_FIELD_TFD_3,
+	TMC5160_FIELD_DISFDCC,
+	TMC5160_FIELD_RNDTF,
+	TMC5160_FIELD_CHM,
+	TMC5160_FIELD_TBL,
+	TMC5160_FIELD_VSENSE,
+	TMC5160_FIELD_VHIGHFS,
+	TMC5160_FIELD_VHIGHCHM,
+	TMC5160_FIELD_TPFD,
+	TMC5160_FIELD_MRES,
+	TMC5160_FIELD_INTPOL,
+	TMC5160_FIELD_DEDGE,
+	TMC5160_FIELD_DISS2G,
+	TMC5160_FIELD_DISS2VS,
+	TMC5160_FIELD_SEMIN,
+	TMC5160_FIELD_SEUP,
+	TMC5160_FIELD_SEMAX,
+	TMC5160_FIELD_SEDN,
+	TMC5160_FIELD_SEIMIN,
+	TMC5160_FIELD_SGT,
+	TMC5160_FIELD_SFILT,
+	TMC5160_FIELD_DC_TIME,
+	TMC5160_FIELD_DC_SG,
+	TMC5160_FIELD_SG_RESULT,
+	TMC5160_FIELD_S2VSA,
+	TMC5160_FIELD_S2VSB,
+	TMC5160_FIELD_STEALTH,
+	TMC5160_FIELD_FSACTIVE,
+	TMC5160_FIELD_CS_ACTUAL,
+	TMC5160_FIELD_STALLGUARD,
+	TMC5160_FIELD_OT,
+	TMC5160_FIELD_OTPW,
+	TMC5160_FIELD_S2GA,
+	TMC5160_FIELD_S2GB,
+	TMC5160_FIELD_OLA,
+	TMC5160_FIELD_OLB,
+	TMC5160_FIELD_STST,
+	TMC5160_FIELD_PWM_OFS,
+	TMC5160_FIELD_PWM_GRAD,
+	TMC5160_FIELD_PWM_FREQ,
+	TMC5160_FIELD_PWM_AUTOSCALE,
+	TMC5160_FIELD_PWM_AUTOGRAD,
+	TMC5160_FIELD_FREEWHEEL,
+	TMC5160_FIELD_PWM_REG,
+	TMC5160_FIELD_PWM_LIM,
+	TMC5160_FIELD_PWM_SCALE_SUM,
+	TMC5160_FIELD_PWM_SCALE_AUTO,
+	TMC5160_FIELD_PWM_OFS_AUTO,
+	TMC5160_FIELD_PWM_GRAD_AUTO,
+	TMC5160_FIELD_LOST_STEPS,
+	TMC5160_FIELD_COUNT
+} TMC5160FieldIndex;
+
+// Minimal perfect hash of the field names ("CHOPCONF.TOFF"), see tmc_field_lookup().
+// Generated with tmc5160_fieldDescriptors - regenerate both on changes.
+static const uint16_t tmc5160_fieldNameDisplacements[45] =
+{
+	   15,    36,     6,     5,    54,    88,     0,    26,   141,   244,    37,     0,
+	  188,    66,     0,    12,     5,     6,    87,     0,     4,    84,    21,    53,
+	    3,     6,    69,     0,    78,   534,    40,    66,   603,     6,     7,   128,
+	  859,   143,    64,    37,     0,   191,  2483,   236,  2635
+};
+
+// Per slot: FNV-1a hash of the name and field index
+static const TMCFieldNameSlot tmc5160_fieldNameSlots[178] =
+{
+	{ 0x8FE87DC3, TMC5160_FIELD_SWAP_LR }, // SW_MODE.SWAP_LR
+	{ 0x81E9D40B, TMC5160_FIELD_MULTISTEP_FILT }, // GCONF.MULTISTEP_FILT
+	{ 0x2FBD6996, TMC5160_FIELD_OTPBYTE }, // OTP_PROG.OTPBYTE
+	{ 0x5752100D, TMC5160_FIELD_DIAG0_INT_PUSHPULL }, // GCONF.DIAG0_INT_PUSHPULL
+	{ 0xFDD6F662, TMC5160_FIELD_HEND }, // CHOPCONF.HEND
+	{ 0x964101BA, TMC5160_FIELD_STATUS_LATCH_L }, // RAMP_STAT.STATUS_LATCH_L
+	{ 0x81FC9299, TMC5160_FIELD_X_COMPARE }, // X_COMPARE.X_COMPARE
+	{ 0x0987D845, TMC5160_FIELD_XTARGET }, // XTARGET.XTARGET
+	{ 0xB96574DF, TMC5160_FIELD_STALLGUARD }, // DRV_STATUS.STALLGUARD
+	{ 0x5F48FB3C, TMC5160_FIELD_OTP_BBM }, // OTP_READ.OTP_BBM
+	{ 0xCABC02CD, TMC5160_FIELD_IHOLDDELAY }, // IHOLD_IRUN.IHOLDDELAY
+	{ 0x8DB93E21, TMC5160_FIELD_IFCNT }, // IFCNT.IFCNT
+	{ 0xEE3991A5, TMC5160_FIELD_EN_SOFTSTOP }, // SW_MODE.EN_SOFTSTOP
+	{ 0x6F1155B2, TMC5160_FIELD_OLA }, // DRV_STATUS.OLA
+	{ 0xEFF51EC1, TMC5160_FIELD_DIAG1_STALL }, // GCONF.DIAG1_STALL
+	{ 0x1AB8F33E, TMC5160_FIELD_EVENT_POS_REACHED }, // RAMP_STAT.EVENT_POS_REACHED
+	{ 0x3C59F4A6, TMC5160_FIELD_PWM_LIM }, // PWMCONF.PWM_LIM
+	{ 0x60C76F7C, TMC5160_FIELD_OFFSET }, // CHOPCONF.OFFSET
+	{ 0x0831B053, TMC5160_FIELD_INTEGER }, // ENC_CONST.INTEGER
+	{ 0xE46351A9, TMC5160_FIELD_TSTEP }, // TSTEP.TSTEP
+	{ 0x87B93089, TMC5160_FIELD_VSTART }, // VSTART.VSTART
+	{ 0x2F5AE6F7, TMC5160_FIELD_CLR_ONCE }, // ENCMODE.CLR_ONCE
+	{ 0x94BFACF2, TMC5160_FIELD_BBMCLKS }, // DRV_CONF.BBMCLKS
+	{ 0x0BB7D2D9, TMC5160_FIELD_DISS2G }, // CHOPCONF.DISS2G
+	{ 0x671971F1, TMC5160_FIELD_PWM_SCALE_AUTO }, // PWM_SCALE.PWM_SCALE_AUTO
+	{ 0x8C0F9E26, TMC5160_FIELD_SHAFT }, // GCONF.SHAFT
+	{ 0x5BE098E1, TMC5160_FIELD_DISFDCC }, // CHOPCONF.DISFDCC
+	{ 0xCBFCA7A7, TMC5160_FIELD_TBL }, // CHOPCONF.TBL
+	{ 0x90AE6811, TMC5160_FIELD_FSACTIVE }, // DRV_STATUS.FSACTIVE
+	{ 0x4348479F, TMC5160_FIELD_D1 }, // D1.D1
+	{ 0x0E4C787A, TMC5160_FIELD_EVENT_STOP_R }, // RAMP_STAT.EVENT_STOP_R
+	{ 0x5AC3BE43, TMC5160_FIELD_RAMPMODE }, // RAMPMODE.RAMPMODE
+	{ 0x660F8890, TMC5160_FIELD_START_SIN90 }, // MSLUTSTART.START_SIN90
+	{ 0xA67E2609, TMC5160_FIELD_OTP_S2_LEVEL }, // OTP_READ.OTP_S2_LEVEL
+	{ 0x70EC8189, TMC5160_FIELD_DIAG0_OTPW_ONLY_WITH_SD_MODE1 }, // GCONF.DIAG0_OTPW_ONLY_WITH_SD_MODE1
+	{ 0xC299CF34, TMC5160_FIELD_W1 }, // MSLUTSEL.W1
+	{ 0x7840D280, TMC5160_FIELD_STATUS_LATCH_R }, // RAMP_STAT.STATUS_LATCH_R
+	{ 0x73304DE2, TMC5160_FIELD_PWM_OFS_AUTO }, // PWM_AUTO.PWM_OFS_AUTO
+	{ 0xF16C85CC, TMC5160_FIELD_S2GB }, // DRV_STATUS.S2GB
+	{ 0x82AD31EE, TMC5160_FIELD_CLR_CONT }, // ENCMODE.CLR_CONT
+	{ 0x975991FC, TMC5160_FIELD_STST }, // DRV_STATUS.STST
+	{ 0x21026E3E, TMC5160_FIELD_SEDN }, // COOLCONF.SEDN
+	{ 0x546195AD, TMC5160_FIELD_CS_ACTUAL }, // DRV_STATUS.CS_ACTUAL
+	{ 0x76A34505, TMC5160_FIELD_ENC_LATCH }, // ENC_LATCH.ENC_LATCH
+	{ 0x6E11541F, TMC5160_FIELD_OLB }, // DRV_STATUS.OLB
+	{ 0x3DEE2BE4, TMC5160_FIELD_HSTRT }, // CHOPCONF.HSTRT
+	{ 0x99C01769, TMC5160_FIELD_TZEROWAIT }, // TZEROWAIT.TZEROWAIT
+	{ 0x7199A720, TMC5160_FIELD_MRES }, // CHOPCONF.MRES
+	{ 0x26A72D29, TMC5160_FIELD_CLR_ENC_X }, // ENCMODE.CLR_ENC_X
+	{ 0xB6769505, TMC5160_FIELD_GLOBAL_SCALER }, // GLOBAL_SCALER.GLOBAL_SCALER
+	{ 0x2C741239, TMC5160_FIELD_X3 }, // MSLUTSEL.X3
+	{ 0x0E6E35CC, TMC5160_FIELD_DC_TIME }, // DCCTRL.DC_TIME
+	{ 0x4FA13879, TMC5160_FIELD_OTP_TBL }, // OTP_READ.OTP_TBL
+	{ 0x288057B4, TMC5160_FIELD_POL_N }, // ENCMODE.POL_N
+	{ 0xB9E000AF, TMC5160_FIELD_PWM_AUTOSCALE }, // PWMCONF.PWM_AUTOSCALE
+	{ 0x65999FEA, TMC5160_FIELD_IHOLD }, // IHOLD_IRUN.IHOLD
+	{ 0xCD661365, TMC5160_FIELD_S2VS_LEVEL }, // SHORT_CONF.S2VS_LEVEL
+	{ 0xC599D3ED, TMC5160_FIELD_W2 }, // MSLUTSEL.W2
+	{ 0x3485983F, TMC5160_FIELD_DISS2VS }, // CHOPCONF.DISS2VS
+	{ 0x6D1A0848, TMC5160_FIELD_VHIGHFS }, // CHOPCONF.VHIGHFS
+	{ 0x7BDAD3B5, TMC5160_FIELD_ENC_SEL_DECIMAL }, // ENCMODE.ENC_SEL_DECIMAL
+	{ 0x4310F5ED, TMC5160_FIELD_DIAG1_ONSTATE }, // GCONF.DIAG1_ONSTATE
+	{ 0x6F8E3F53, TMC5160_FIELD_T_ZEROWAIT_ACTIVE }, // RAMP_STAT.T_ZEROWAIT_ACTIVE
+	{ 0xB7915492, TMC5160_FIELD_SG_STOP }, // SW_MODE.SG_STOP
+	{ 0xC399D0C7, TMC5160_FIELD_W0 }, // MSLUTSEL.W0
+	{ 0xA22AE452, TMC5160_FIELD_IGNORE_AB }, // ENCMODE.IGNORE_AB
+	{ 0x722FC198, TMC5160_FIELD_FRACTIONAL }, // ENC_CONST.FRACTIONAL
+	{ 0x598291C4, TMC5160_FIELD_STOP_R_ENABLE }, // SW_MODE.STOP_R_ENABLE
+	{ 0x9C9CA203, TMC5160_FIELD_OTSELECT }, // DRV_CONF.OTSELECT
+	{ 0x3B0BB539, TMC5160_FIELD_START_SIN }, // MSLUTSTART.START_SIN
+	{ 0xEC7CF19F, TMC5160_FIELD_VSENSE }, // CHOPCONF.VSENSE
+	{ 0x1279AB5E, TMC5160_FIELD_VZERO }, // RAMP_STAT.VZERO
+	{ 0x1E7CC102, TMC5160_FIELD_PWM_FREQ }, // PWMCONF.PWM_FREQ
+	{ 0x068AB9D8, TMC5160_FIELD_SFILT }, // COOLCONF.SFILT
+	{ 0xB94695F4, TMC5160_FIELD_TEST_MODE }, // GCONF.TEST_MODE
+	{ 0x0E1CDE82, TMC5160_FIELD_SHORTFILTER }, // SHORT_CONF.SHORTFILTER
+	{ 0xF375700D, TMC5160_FIELD_MSCNT }, // MSCNT.MSCNT
+	{ 0x71903652, TMC5160_FIELD_LATCH_R_INACTIVE }, // SW_MODE.LATCH_R_INACTIVE
+	{ 0xE703F8CB, TMC5160_FIELD_DIRECT_MODE }, // GCONF.DIRECT_MODE
+	{ 0x7EEFF6B0, TMC5160_FIELD_DEDGE }, // CHOPCONF.DEDGE
+	{ 0x9D49D507, TMC5160_FIELD_OTPBIT }, // OTP_PROG.OTPBIT
+	{ 0x798F02AE, TMC5160_FIELD_SGT }, // COOLCONF.SGT
+	{ 0xE904AC6F, TMC5160_FIELD_S2GND_LEVEL }, // SHORT_CONF.S2GND_LEVEL
+	{ 0x23F3AC71, TMC5160_FIELD_ENC_DEVIATION }, // ENC_DEVIATION.ENC_DEVIATION
+	{ 0x3D512113, TMC5160_FIELD_DIAG1_STEPS_SKIPPED }, // GCONF.DIAG1_STEPS_SKIPPED
+	{ 0x402D3125, TMC5160_FIELD_SEIMIN }, // COOLCONF.SEIMIN
+	{ 0x95620EEB, TMC5160_FIELD_STEALTH }, // DRV_STATUS.STEALTH
+	{ 0x2A740F13, TMC5160_FIELD_X1 }, // MSLUTSEL.X1
+	{ 0x90D1486C, TMC5160_FIELD_IRUN }, // IHOLD_IRUN.IRUN
+	{ 0x978432DE, TMC5160_FIELD_OTPW }, // DRV_STATUS.OTPW
+	{ 0x331C7A7F, TMC5160_FIELD_TPWMTHRS }, // TPWMTHRS.TPWMTHRS
+	{ 0xAEA3FBFD, TMC5160_FIELD_FILT_ISENSE }, // DRV_CONF.FILT_ISENSE
+	{ 0x13B1DB4B, TMC5160_FIELD_PWM_AUTOGRAD }, // PWMCONF.PWM_AUTOGRAD
+	{ 0xC5AA5550, TMC5160_FIELD_PWM_GRAD_AUTO }, // PWM_AUTO.PWM_GRAD_AUTO
+	{ 0x312D6875, TMC5160_FIELD_SEUP }, // COOLCONF.SEUP
+	{ 0x3AD9B1AD, TMC5160_FIELD_TFD_3 }, // CHOPCONF.TFD_3
+	{ 0xE0B4DC07, TMC5160_FIELD_DC_SG }, // DCCTRL.DC_SG
+	{ 0x2CF26A3D, TMC5160_FIELD_UV_CP }, // GSTAT.UV_CP
+	{ 0x3A5E2E44, TMC5160_FIELD_STOP_ENABLE }, // GCONF.STOP_ENABLE
+	{ 0xE5B05A69, TMC5160_FIELD_TCOOLTHRS }, // TCOOLTHRS.TCOOLTHRS
+	{ 0xA017B3D1, TMC5160_FIELD_VACTUAL }, // VACTUAL.VACTUAL
+	{ 0xC499D25A, TMC5160_FIELD_W3 }, // MSLUTSEL.W3
+	{ 0x6E85CB92, TMC5160_FIELD_POL_STOP_R }, // SW_MODE.POL_STOP_R
+	{ 0x0996060F, TMC5160_FIELD_RNDTF }, // CHOPCONF.RNDTF
+	{ 0xB1B8A493, TMC5160_FIELD_VDCMIN }, // VDCMIN.VDCMIN
+	{ 0xBE2FD8F6, TMC5160_FIELD_DIAG0_STALL }, // GCONF.DIAG0_STALL
+	{ 0xB502AE33, TMC5160_FIELD_CUR_A }, // MSCURACT.CUR_A
+	{ 0x656C475A, TMC5160_FIELD_STOP_L_ENABLE }, // SW_MODE.STOP_L_ENABLE
+	{ 0xD00C03C0, TMC5160_FIELD_PWM_GRAD }, // PWMCONF.PWM_GRAD
+	{ 0xC7930462, TMC5160_FIELD_BBMTIME }, // DRV_CONF.BBMTIME
+	{ 0xD4BA04BF, TMC5160_FIELD_OT }, // DRV_STATUS.OT
+	{ 0xF919055D, TMC5160_FIELD_THIGH }, // THIGH.THIGH
+	{ 0xF0DC8573, TMC5160_FIELD_LATCH_L_ACTIVE }, // SW_MODE.LATCH_L_ACTIVE
+	{ 0xC6526CDE, TMC5160_FIELD_FASTSTANDSTILL }, // GCONF.FASTSTANDSTILL
+	{ 0x46D99992, TMC5160_FIELD_EN_LATCH_ENCODER }, // SW_MODE.EN_LATCH_ENCODER
+	{ 0x38870BE4, TMC5160_FIELD_LATCH_L_INACTIVE }, // SW_MODE.LATCH_L_INACTIVE
+	{ 0xFEAB5CE7, TMC5160_FIELD_TPOWERDOWN }, // TPOWERDOWN.TPOWERDOWN
+	{ 0x18CE9CD4, TMC5160_FIELD_EN_PWM_MODE }, // GCONF.EN_PWM_MODE
+	{ 0x2B7410A6, TMC5160_FIELD_X2 }, // MSLUTSEL.X2
+	{ 0x2A09EFFA, TMC5160_FIELD_STATUS_STOP_L }, // RAMP_STAT.STATUS_STOP_L
+	{ 0x0D9C57E4, TMC5160_FIELD_SEMIN }, // COOLCONF.SEMIN
+	{ 0x8A9C6E73, TMC5160_FIELD_CHM }, // CHOPCONF.CHM
+	{ 0x952C8B6A, TMC5160_FIELD_SECOND_MOVE }, // RAMP_STAT.SECOND_MOVE
+	{ 0xA5EA43A4, TMC5160_FIELD_SLAVEADDR }, // SLAVECONF.SLAVEADDR
+	{ 0x5013CE59, TMC5160_FIELD_SENDDELAY }, // SLAVECONF.SENDDELAY
+	{ 0x363A8FD5, TMC5160_FIELD_DRVSTRENGTH }, // DRV_CONF.DRVSTRENGTH
+	{ 0xF46C8A85, TMC5160_FIELD_S2GA }, // DRV_STATUS.S2GA
+	{ 0xD03A273F, TMC5160_FIELD_AMAX }, // AMAX.AMAX
+	{ 0xC47536A1, TMC5160_FIELD_PWM_SCALE_SUM }, // PWM_SCALE.PWM_SCALE_SUM
+	{ 0x94471BB4, TMC5160_FIELD_POSITION_REACHED }, // RAMP_STAT.POSITION_REACHED
+	{ 0x9D3D4D63, TMC5160_FIELD_OTP_FCLKTRIM }, // OTP_READ.OTP_FCLKTRIM
+	{ 0x8085E7E8, TMC5160_FIELD_POL_STOP_L }, // SW_MODE.POL_STOP_L
+	{ 0xF0248EB2, TMC5160_FIELD_PWM_REG }, // PWMCONF.PWM_REG
+	{ 0x4B974C25, TMC5160_FIELD_LATCH_R_ACTIVE }, // SW_MODE.LATCH_R_ACTIVE
+	{ 0x4CE0604B, TMC5160_FIELD_VHIGHCHM }, // CHOPCONF.VHIGHCHM
+	{ 0x5F64827E, TMC5160_FIELD_EVENT_STOP_SG }, // RAMP_STAT.EVENT_STOP_SG
+	{ 0x14932751, TMC5160_FIELD_XLATCH }, // XLATCH.XLATCH
+	{ 0x5826A702, TMC5160_FIELD_SG_RESULT }, // DRV_STATUS.SG_RESULT
+	{ 0x583DC789, TMC5160_FIELD_VSTOP }, // VSTOP.VSTOP
+	{ 0x048C4866, TMC5160_FIELD_DIAG0_STEP }, // GCONF.DIAG0_STEP
+	{ 0x4CAC3A0C, TMC5160_FIELD_DIAG1_DIR }, // GCONF.DIAG1_DIR
+	{ 0xD3DD6D4E, TMC5160_FIELD_PWM_OFS }, // PWMCONF.PWM_OFS
+	{ 0x64D0A603, TMC5160_FIELD_DIAG1_INDEX }, // GCONF.DIAG1_INDEX
+	{ 0x95538105, TMC5160_FIELD_SMALL_HYSTERESIS }, // GCONF.SMALL_HYSTERESIS
+	{ 0xC8971B97, TMC5160_FIELD_TFD_ALL }, // CHOPCONF.TFD_ALL
+	{ 0x3F054E29, TMC5160_FIELD_LOST_STEPS }, // LOST_STEPS.LOST_STEPS
+	{ 0xFF121B1D, TMC5160_FIELD_A1 }, // A1.A1
+	{ 0xA72D78F5, TMC5160_FIELD_DMAX }, // DMAX.DMAX
+	{ 0x99444C84, TMC5160_FIELD_LATCH_X_ACT }, // ENCMODE.LATCH_X_ACT
+	{ 0x44DB424B, TMC5160_FIELD_INTPOL }, // CHOPCONF.INTPOL
+	{ 0xC474B530, TMC5160_FIELD_FCLKTRIM }, // FACTORY_CONF.FCLKTRIM
+	{ 0x1BAFF5A6, TMC5160_FIELD_SEMAX }, // COOLCONF.SEMAX
+	{ 0x664DFE56, TMC5160_FIELD_POS_EDGENEG_EDGE }, // ENCMODE.POS_EDGENEG_EDGE
+	{ 0x1B9538BD, TMC5160_FIELD_S2VSA }, // DRV_STATUS.S2VSA
+	{ 0xF6415059, TMC5160_FIELD_TPFD }, // CHOPCONF.TPFD
+	{ 0x471C3DB0, TMC5160_FIELD_VELOCITY_REACHED }, // RAMP_STAT.VELOCITY_REACHED
+	{ 0x48AB06D7, TMC5160_FIELD_OTPMAGIC }, // OTP_PROG.OTPMAGIC
+	{ 0x2D633A65, TMC5160_FIELD_N_EVENT }, // ENC_STATUS.N_EVENT
+	{ 0xB602AFC6, TMC5160_FIELD_CUR_B }, // MSCURACT.CUR_B
+	{ 0xDD0B2AF2, TMC5160_FIELD_FREEWHEEL }, // PWMCONF.FREEWHEEL
+	{ 0x5A277BD9, TMC5160_FIELD_RESET }, // GSTAT.RESET
+	{ 0x1C8044D0, TMC5160_FIELD_POL_B }, // ENCMODE.POL_B
+	{ 0xC9077225, TMC5160_FIELD_X_ENC }, // X_ENC.X_ENC
+	{ 0x80062976, TMC5160_FIELD_DRV_ERR }, // GSTAT.DRV_ERR
+	{ 0xF04C4940, TMC5160_FIELD_EVENT_STOP_L }, // RAMP_STAT.EVENT_STOP_L
+	{ 0xCD213B6E, TMC5160_FIELD_TOFF }, // CHOPCONF.TOFF
+	{ 0x1F130498, TMC5160_FIELD_RECALIBRATE }, // GCONF.RECALIBRATE
+	{ 0x00835391, TMC5160_FIELD_VMAX }, // VMAX.VMAX
+	{ 0x0C09C0C0, TMC5160_FIELD_STATUS_STOP_R }, // RAMP_STAT.STATUS_STOP_R
+	{ 0x18953404, TMC5160_FIELD_S2VSB }, // DRV_STATUS.S2VSB
+	{ 0xEB865D4B, TMC5160_FIELD_STATUS_SG }, // RAMP_STAT.STATUS_SG
+	{ 0xFA0D4C30, TMC5160_FIELD_DIAG1_POSCOMP_PUSHPULL }, // GCONF.DIAG1_POSCOMP_PUSHPULL
+	{ 0x2A4845F1, TMC5160_FIELD_XACTUAL }, // XACTUAL.XACTUAL
+	{ 0x06AD4925, TMC5160_FIELD_DIAG0_ERROR_ONLY_WITH_SD_MODE1 }, // GCONF.DIAG0_ERROR_ONLY_WITH_SD_MODE1
+	{ 0x9075F780, TMC5160_FIELD_DEVIATION_WARN }, // ENC_STATUS.DEVIATION_WARN
+	{ 0x1F804989, TMC5160_FIELD_POL_A }, // ENCMODE.POL_A
+	{ 0x69A4F79F, TMC5160_FIELD_SHORTDELAY }, // SHORT_CONF.SHORTDELAY
+	{ 0xD7EF3C48, TMC5160_FIELD_V1_ }  // V1.V1_
+};
+
+static const TMCFieldNameIndex tmc5160_fieldNameIndex =
+{
+	.displacements  = tmc5160_fieldNameDisplacements,
+	.bucketCount    = 45,
+	.slots          = tmc5160_fieldNameSlots,
+	.slotCount      = 178,
+};
+
+#endif /* TMC_IC_TMC5160_TMC5160_DESCRIPTORS_H_ */
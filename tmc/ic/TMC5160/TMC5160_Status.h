@@ -0,0 +1,124 @@
+/*
+ * TMC5160_Status.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Typed decoders for the status registers GSTAT, RAMP_STAT and DRV_STATUS.
+ *  All fields of a register are extracted in one pass with constant masks from
+ *  TMC5160_Fields.h. For a plain check, test the raw value against the
+ *  predicate masks instead of decoding it.
+ */
+
+#ifndef TMC_IC_TMC5160_TMC5160_STATUS_H_
+#define TMC_IC_TMC5160_TMC5160_STATUS_H_
+
+#include "tmc/helpers/Types.h"
+#include "tmc/helpers/Macros.h"
+#include "TMC5160_Fields.h"
+
+// Predicate masks of the raw register values
+#define TMC5160_GSTAT_ERRORS       (TMC5160_DRV_ERR_MASK | TMC5160_UV_CP_MASK)
+#define TMC5160_RAMPSTAT_STOPS     (TMC5160_EVENT_STOP_L_MASK | TMC5160_EVENT_STOP_R_MASK | TMC5160_EVENT_STOP_SG_MASK)
+#define TMC5160_DRVSTATUS_SHORTS   (TMC5160_S2VSA_MASK | TMC5160_S2VSB_MASK | TMC5160_S2GA_MASK | TMC5160_S2GB_MASK)
+#define TMC5160_DRVSTATUS_ERRORS   (TMC5160_DRVSTATUS_SHORTS | TMC5160_OT_MASK)
+#define TMC5160_DRVSTATUS_WARNINGS (TMC5160_OTPW_MASK | TMC5160_OLA_MASK | TMC5160_OLB_MASK)
+
+typedef struct
+{
+	bool reset;
+	bool driverError;
+	bool undervoltage;
+} TMC5160GStatTypeDef;
+
+typedef struct
+{
+	bool stopL;
+	bool stopR;
+	bool latchL;
+	bool latchR;
+	bool eventStopL;
+	bool eventStopR;
+	bool eventStopSG;
+	bool eventPositionReached;
+	bool velocityReached;
+	bool positionReached;
+	bool vZero;
+	bool zeroWait;
+	bool secondMove;
+	bool stallGuard;
+} TMC5160RampStatTypeDef;
+
+typedef struct
+{
+	uint16_t sgResult;
+	uint8_t csActual;
+	bool stealth;
+	bool fullstep;
+	bool stallGuard;
+	bool overtemperature;
+	bool overtemperatureWarning;
+	bool shortToGround;     // Either phase
+	bool shortToSupply;     // Either phase
+	bool openLoad;          // Either phase
+	bool standstill;
+	bool error;             // Any of TMC5160_DRVSTATUS_ERRORS
+} TMC5160DrvStatusTypeDef;
+
+static inline TMC5160GStatTypeDef tmc5160_decodeGStat(uint32_t value)
+{
+	TMC5160GStatTypeDef status =
+	{
+		.reset         = (value & TMC5160_RESET_MASK) != 0,
+		.driverError   = (value & TMC5160_DRV_ERR_MASK) != 0,
+		.undervoltage  = (value & TMC5160_UV_CP_MASK) != 0,
+	};
+
+	return status;
+}
+
+static inline TMC5160RampStatTypeDef tmc5160_decodeRampStat(uint32_t value)
+{
+	TMC5160RampStatTypeDef status =
+	{
+		.stopL                 = (value & TMC5160_STATUS_STOP_L_MASK) != 0,
+		.stopR                 = (value & TMC5160_STATUS_STOP_R_MASK) != 0,
+		.latchL                = (value & TMC5160_STATUS_LATCH_L_MASK) != 0,
+		.latchR                = (value & TMC5160_STATUS_LATCH_R_MASK) != 0,
+		.eventStopL            = (value & TMC5160_EVENT_STOP_L_MASK) != 0,
+		.eventStopR            = (value & TMC5160_EVENT_STOP_R_MASK) != 0,
+		.eventStopSG           = (value & TMC5160_EVENT_STOP_SG_MASK) != 0,
+		.eventPositionReached  = (value & TMC5160_EVENT_POS_REACHED_MASK) != 0,
+		.velocityReached       = (value & TMC5160_VELOCITY_REACHED_MASK) != 0,
+		.positionReached       = (value & TMC5160_POSITION_REACHED_MASK) != 0,
+		.vZero                 = (value & TMC5160_VZERO_MASK) != 0,
+		.zeroWait              = (value & TMC5160_T_ZEROWAIT_ACTIVE_MASK) != 0,
+		.secondMove            = (value & TMC5160_SECOND_MOVE_MASK) != 0,
+		.stallGuard            = (value & TMC5160_STATUS_SG_MASK) != 0,
+	};
+
+	return status;
+}
+
+static inline TMC5160DrvStatusTypeDef tmc5160_decodeDrvStatus(uint32_t value)
+{
+	TMC5160DrvStatusTypeDef status =
+	{
+		.sgResult                = FIELD_GET(value, TMC5160_SG_RESULT_MASK, TMC5160_SG_RESULT_SHIFT),
+		.csActual                = FIELD_GET(value, TMC5160_CS_ACTUAL_MASK, TMC5160_CS_ACTUAL_SHIFT),
+		.stealth                 = (value & TMC5160_STEALTH_MASK) != 0,
+		.fullstep                = (value & TMC5160_FSACTIVE_MASK) != 0,
+		.stallGuard              = (value & TMC5160_STALLGUARD_MASK) != 0,
+		.overtemperature         = (value & TMC5160_OT_MASK) != 0,
+		.overtemperatureWarning  = (value & TMC5160_OTPW_MASK) != 0,
+		.shortToGround           = (value & (TMC5160_S2GA_MASK | TMC5160_S2GB_MASK)) != 0,
+		.shortToSupply           = (value & (TMC5160_S2VSA_MASK | TMC5160_S2VSB_MASK)) != 0,
+		.openLoad                = (value & (TMC5160_OLA_MASK | TMC5160_OLB_MASK)) != 0,
+		.standstill              = (value & TMC5160_STST_MASK) != 0,
+		.error                   = (value & TMC5160_DRVSTATUS_ERRORS) != 0,
+	};
+
+	return status;
+}
+
+#endif /* TMC_IC_TMC5160_TMC5160_STATUS_H_ */
@@ -6,7 +6,117 @@
  */
 
 #include "TMC5240.h"
+#include "tmc/helpers/Functions.h"
+
+// => SPI wrapper
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc5240_readWriteSPI(uint8_t channel, uint8_t *data, size_t length);
+// <= SPI wrapper
+
+// => UART wrapper
+// Send [writeLength] bytes of [data], then receive [readLength] bytes into [data]
+extern void tmc5240_readWriteUART(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
+// <= UART wrapper
+
+// => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc5240_CRC8 NULL
+#else
+extern uint8_t tmc5240_CRC8(uint8_t *data, size_t length);
+#endif
+// <= CRC wrapper
+
+static const TMCSpiInterface spi =
+{
+	.readWriteArray  = tmc5240_readWriteSPI,
+	TMC_INSTRUMENT_NAME("TMC5240")
+};
+
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc5240_readWriteUART,
+	.crc             = tmc5240_CRC8,
+	TMC_INSTRUMENT_NAME("TMC5240")
+};
+
+// Select the interface the IC is connected with. TMC_COMM_DEFAULT is SPI.
+// UART datagrams are sent to the address set with tmc5240_setSlaveAddress().
+void tmc5240_setCommMode(TMC5240TypeDef *tmc5240, TMC_Comm_Mode mode)
+{
+	tmc5240->commMode = mode;
+}
+
+void tmc5240_writeInt(TMC5240TypeDef *tmc5240, uint8_t address, int32_t value)
+{
+	if(tmc5240->commMode == TMC_COMM_UART)
+		tmc_uart_writeInt(&uart, tmc5240->config->channel, tmc5240->slaveAddress, address, value);
+	else
+		tmc_spi_writeInt(&spi, tmc5240->config->channel, address, value);
+
+	// Write to the shadow register and mark the register dirty
+	address = TMC_ADDRESS(address);
+	TMC_SHADOW_REGISTER(tmc5240->config, address) = value;
+	tmc5240->registerAccess[address] |= TMC_ACCESS_DIRTY;
+}
 
+int32_t tmc5240_readInt(TMC5240TypeDef *tmc5240, uint8_t address)
+{
+	int32_t value;
+
+	address = TMC_ADDRESS(address);
+
+	// register not readable -> shadow register copy
+	if(!TMC_IS_READABLE(tmc5240->registerAccess[address]))
+		return TMC_SHADOW_REGISTER(tmc5240->config, address);
+
+	if(tmc5240->commMode != TMC_COMM_UART)
+		return tmc_spi_readInt(&spi, tmc5240->config->channel, address);
+
+	// An invalid reply reads as 0
+	tmc_uart_readInt(&uart, tmc5240->config->channel, tmc5240->slaveAddress, address, &value);
+
+	return value;
+}
+
+// Read multiple registers. Over SPI the read requests are pipelined, taking
+// count+1 transfers instead of 2*count, see tmc/helpers/SPI.h.
+void tmc5240_readIntBatch(TMC5240TypeDef *tmc5240, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	size_t i;
+
+	if(tmc5240->commMode != TMC_COMM_UART)
+	{
+		tmc_spi_readIntBatch(&spi, tmc5240->config, tmc5240->registerAccess, addresses, values, count);
+		return;
+	}
+
+	// UART replies follow their request directly, there is nothing to pipeline
+	for(i = 0; i < count; i++)
+		values[i] = tmc5240_readInt(tmc5240, addresses[i]);
+}
+
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc5240_writeInt(ic, address, value);
+}
+
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC5240_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc5240_defaultRegisterAccess,
+	.resettableRegisters    = tmc5240_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc5240_resettableRegisters),
+	.restorableRegisters    = tmc5240_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc5240_restorableRegisters),
+	.constants              = tmc5240_RegisterConstants,
+	.constantCount          = ARRAY_SIZE(tmc5240_RegisterConstants),
+	.powerOnValues          = tmc5240_powerOnRegisters,
+	.powerOnCount           = ARRAY_SIZE(tmc5240_powerOnRegisters),
+	.writeInt               = writeRegister,
+};
 
 // Initialize a TMC5240 IC.
 // This function requires:
@@ -16,58 +126,49 @@
 //     - registerResetState: An int32_t array with 128 elements. This holds the values to be used for a reset.
 void tmc5240_init(TMC5240TypeDef *tmc5240, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState)
 {
-	tmc5240->velocity  = 0;
-	tmc5240->oldTick   = 0;
-	tmc5240->oldX      = 0;
+	tmc_units_init(&tmc5240->units, TMC_UNITS_DEFAULT_CLOCK);
 
-	tmc5240->config               = config;
-	tmc5240->config->callback     = NULL;
-	tmc5240->config->channel      = channel;
-	tmc5240->config->configIndex  = 0;
-	tmc5240->config->state        = CONFIG_READY;
+	tmc5240->velocity        = 0;
+	tmc5240->oldTick         = 0;
+	tmc5240->oldX            = 0;
+	tmc5240->velocitySource  = TMC_VELOCITY_SOURCE_ESTIMATE;
 
-	size_t i;
-	for(i = 0; i < TMC5240_REGISTER_COUNT; i++)
-	{
-		tmc5240->registerAccess[i]      = tmc5240_defaultRegisterAccess[i];
-		tmc5240->registerResetState[i]  = registerResetState[i];
-	}
+#if TMC_FEATURE_TELEMETRY
+	tmc_adcTelemetry_init(&tmc5240->adc);
+#endif
+
+	tmc5240->commMode = TMC_COMM_DEFAULT;
+
+	tmc5240->config = config;
+	tmc_driver_init(&driver, tmc5240->config, channel, tmc5240->registerAccess, tmc5240->registerResetState, registerResetState);
 }
 
 // Reset the TMC5240.
 uint8_t tmc5240_reset(TMC5240TypeDef *tmc5240)
 {
-	if(tmc5240->config->state != CONFIG_READY)
-		return false;
-
-
-	tmc5240->config->state        = CONFIG_RESET;
-	tmc5240->config->configIndex  = 0;
+	return tmc_driver_reset(&driver, tmc5240->config, tmc5240->registerAccess);
+}
 
-	return true;
+// Reset the TMC5240 right after it powered up, skipping the writes of
+// registers whose reset value matches the power-on value.
+uint8_t tmc5240_resetFromPowerOn(TMC5240TypeDef *tmc5240)
+{
+	return tmc_driver_resetFromPowerOn(&driver, tmc5240->config, tmc5240->registerAccess);
 }
 
 // Restore the TMC5240 to the state stored in the shadow registers.
 // This can be used to recover the IC configuration after a VM power loss.
+// Only registers written since the last reset (or without hardware preset) that
+// differ from their power-on value are written.
 uint8_t tmc5240_restore(TMC5240TypeDef *tmc5240)
 {
-	if(tmc5240->config->state != CONFIG_READY)
-		return false;
-
-	tmc5240->config->state        = CONFIG_RESTORE;
-	tmc5240->config->configIndex  = 0;
-
-	return true;
+	return tmc_driver_restore(tmc5240->config);
 }
 
 // Change the values the IC will be configured with when performing a reset.
 void tmc5240_setRegisterResetState(TMC5240TypeDef *tmc5240, const int32_t *resetState)
 {
-	size_t i;
-	for(i = 0; i < TMC5240_REGISTER_COUNT; i++)
-	{
-		tmc5240->registerResetState[i] = resetState[i];
-	}
+	tmc_driver_setRegisterResetState(&driver, tmc5240->registerResetState, resetState);
 }
 
 // Register a function to be called after completion of the configuration mechanism
@@ -87,55 +188,162 @@ void tmc5240_setSlaveAddress(TMC5240TypeDef *tmc5240, uint8_t slaveAddress)
 // Helper function: Configure the next register.
 static void writeConfiguration(TMC5240TypeDef *tmc5240)
 {
-	uint8_t *ptr = &tmc5240->config->configIndex;
-	const int32_t *settings;
-
-	settings = tmc5240->registerResetState;
-	// Find the next resettable register
-	while((*ptr < TMC5240_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc5240->registerAccess[*ptr]))
-		{
-		(*ptr)++;
-		}
-//	}
+	if(!tmc_driver_writeConfiguration(&driver, tmc5240, tmc5240->config, tmc5240->registerAccess, tmc5240->registerResetState))
+		return;
 
-	if(*ptr < TMC5240_REGISTER_COUNT)
+	// Finished configuration
+	if(tmc5240->config->callback)
 	{
-		tmc5240_writeInt(tmc5240, *ptr, settings[*ptr]);
-		(*ptr)++;
+		((tmc5240_callback)tmc5240->config->callback)(tmc5240, tmc5240->config->state);
 	}
-	else // Finished configuration
+
+	tmc5240->config->state = CONFIG_READY;
+}
+
+#if TMC_FEATURE_TELEMETRY
+// Read and publish the ADC values, see tmc/helpers/AdcTelemetry.h
+static void serviceAdc(TMC5240TypeDef *tmc5240, uint32_t tick)
+{
+	int32_t supplyAin = tmc5240_readInt(tmc5240, TMC5240_ADC_VSUPPLY_AIN);
+	int32_t temperature = tmc5240_readInt(tmc5240, TMC5240_ADC_TEMP);
+
+	tmc_adcTelemetry_update(&tmc5240->adc, tmc5240,
+			FIELD_GET(supplyAin, TMC5240_ADC_VSUPPLY_MASK, TMC5240_ADC_VSUPPLY_SHIFT),
+			FIELD_GET(supplyAin, TMC5240_ADC_AIN_MASK, TMC5240_ADC_AIN_SHIFT),
+			FIELD_GET(temperature, TMC5240_ADC_TEMP_MASK, TMC5240_ADC_TEMP_SHIFT),
+			tick);
+}
+
+// Latest ADC values (TMC_ADC_VALUE_COUNT, indexed by TMCAdcValue) without bus access.
+// Configure the capture with tmc5240->adc.interval. Returns false if nothing was captured yet.
+bool tmc5240_readAdc(TMC5240TypeDef *tmc5240, int32_t *values, uint32_t *tick)
+{
+	tmc_snapshot_read(&tmc5240->adc.snapshot, values, TMC_ADC_VALUE_COUNT, tick);
+
+	return (tmc5240->adc.snapshot.sequence != 0);
+}
+
+// Thermal derating from ADC_TEMP, see tmc/helpers/ThermalDerating.h.
+// Processes each ADC capture once, call it after tmc5240_periodicJob().
+// Returns true if GLOBAL_SCALER was written.
+bool tmc5240_thermalUpdate(TMC5240TypeDef *tmc5240, TMCThermalDerating *thermal)
+{
+	int32_t values[TMC_ADC_VALUE_COUNT];
+	uint32_t tick;
+
+	if(!tmc5240_readAdc(tmc5240, values, &tick))
+		return false;
+
+	if(thermal->valid && (tick == thermal->sampleTick))
+		return false;
+
+	thermal->sampleTick = tick;
+
+	if(!tmc_thermal_updateTemperature(thermal, values[TMC_ADC_TEMPERATURE]))
+		return false;
+
+	tmc5240_writeInt(tmc5240, TMC5240_GLOBAL_SCALER, tmc_thermal_globalScaler(thermal));
+
+	return true;
+}
+#endif
+
+// Set the clock frequency [Hz] of the IC, 16 MHz by default. The velocity
+// estimate of the periodic job and the conversions in tmc5240->units use it.
+void tmc5240_setClockFrequency(TMC5240TypeDef *tmc5240, uint32_t clockFrequency)
+{
+	tmc_units_init(&tmc5240->units, clockFrequency);
+}
+
+// Select the value of tmc5240->velocity, updated every 5 ticks by the periodic job:
+// TMC_VELOCITY_SOURCE_ESTIMATE differentiates XACTUAL (default), TMC_VELOCITY_SOURCE_VACTUAL
+// reads the exact velocity of the ramp generator. TMC_VELOCITY_SOURCE_NONE leaves the velocity
+// at 0 and costs no bus access, for applications not using it.
+void tmc5240_setVelocitySource(TMC5240TypeDef *tmc5240, TMCVelocitySource source)
+{
+	tmc5240->velocitySource  = source;
+	tmc5240->velocity        = 0;
+}
+
+// Real-time part of the periodic job: ADC telemetry and velocity, no configuration work.
+// Nothing is done while a reset or restore is running. Worst case per call:
+//   ADC telemetry  2 register reads, every adc.interval ticks
+//   velocity       1 register read, every 5 ticks (not with TMC_VELOCITY_SOURCE_NONE)
+void tmc5240_periodicJobFast(TMC5240TypeDef *tmc5240, uint32_t tick)
+{
+	if(tmc5240->config->state != CONFIG_READY)
+		return;
+
+#if TMC_FEATURE_TELEMETRY
+	if(tmc_adcTelemetry_due(&tmc5240->adc, tick))
+		serviceAdc(tmc5240, tick);
+#endif
+
+	int32_t XActual;
+	uint32_t tickDiff;
+
+	if((tmc5240->velocitySource != TMC_VELOCITY_SOURCE_NONE) && ((tickDiff = tick - tmc5240->oldTick) >= 5))
 	{
-		if(tmc5240->config->callback)
+		if(tmc5240->velocitySource == TMC_VELOCITY_SOURCE_VACTUAL)
 		{
-			((tmc5240_callback)tmc5240->config->callback)(tmc5240, tmc5240->config->state);
+			tmc5240->velocity = CAST_Sn_TO_S32(tmc5240_readInt(tmc5240, TMC5240_VACTUAL), 24);
+		}
+		else
+		{	// Calculate velocity v = dx/dt
+			XActual = tmc5240_readInt(tmc5240, TMC5240_XACTUAL);
+			tmc5240->velocity = tmc_estimateVelocityScaled(XActual - tmc5240->oldX, tickDiff, tmc5240->units.velocityScale);
+			tmc5240->oldX = XActual;
 		}
 
-		tmc5240->config->state = CONFIG_READY;
+		tmc5240->oldTick = tick;
 	}
 }
 
-// Call this periodically
-void tmc5240_periodicJob(TMC5240TypeDef *tmc5240, uint32_t tick)
+// Background part of the periodic job. Worst case per call: 1 register write while
+// a reset or restore is running, nothing otherwise.
+TMCConfigStatus tmc5240_periodicJobBackground(TMC5240TypeDef *tmc5240, uint32_t tick)
 {
+	UNUSED(tick);
+
 	if(tmc5240->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc5240);
-		return;
+		return TMC_CONFIG_STATUS(tmc5240->config);
 	}
 
-	int32_t XActual;
-	uint32_t tickDiff;
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Call this periodically. Runs tmc5240_periodicJobBackground() and, once no
+// configuration is running, tmc5240_periodicJobFast().
+TMCConfigStatus tmc5240_periodicJob(TMC5240TypeDef *tmc5240, uint32_t tick)
+{
+	TMCConfigStatus status = tmc5240_periodicJobBackground(tmc5240, tick);
+
+	if(status == TMC_CONFIG_STATUS_READY)
+		tmc5240_periodicJobFast(tmc5240, tick);
+
+	return status;
+}
 
-	// Calculate velocity v = dx/dt
-	if((tickDiff = tick - tmc5240->oldTick) >= 5)
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc5240_configureBurst(TMC5240TypeDef *tmc5240, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc5240->config->state != CONFIG_READY; step++)
 	{
-		XActual = tmc5240_readInt(tmc5240, TMC5240_XACTUAL);
-		// ToDo CHECK 2: API Compatibility - write alternative algorithm w/o floating point? (LH)
-		tmc5240->velocity = (uint32_t) ((float32_t) ((XActual - tmc5240->oldX) / (float32_t) tickDiff) * (float32_t) 1048.576);
+		if(maxSteps && (step >= maxSteps))
+			break;
 
-		tmc5240->oldX     = XActual;
-		tmc5240->oldTick  = tick;
+		writeConfiguration(tmc5240);
 	}
+
+	return (tmc5240->config->state == CONFIG_READY);
 }
 
 // Rotate with a given velocity (to the right)
@@ -187,3 +395,56 @@ void tmc5240_moveBy(TMC5240TypeDef *tmc5240, int32_t *ticks, uint32_t velocityMa
 	tmc5240_moveTo(tmc5240, *ticks, velocityMax);
 }
 
+// Write the ramp parameters of a planned profile, see tmc_planRampProfile().
+// VMAX is written by the following move: tmc5240_moveTo(tmc5240, position, profile->vMax)
+void tmc5240_writeRampProfile(TMC5240TypeDef *tmc5240, const TMCRampProfileTypeDef *profile)
+{
+	tmc5240_writeInt(tmc5240, TMC5240_VSTART, profile->vStart);
+	tmc5240_writeInt(tmc5240, TMC5240_A1, profile->a1);
+	tmc5240_writeInt(tmc5240, TMC5240_V1, profile->v1);
+	tmc5240_writeInt(tmc5240, TMC5240_AMAX, profile->aMax);
+	tmc5240_writeInt(tmc5240, TMC5240_DMAX, profile->dMax);
+	tmc5240_writeInt(tmc5240, TMC5240_D1, profile->d1);
+	tmc5240_writeInt(tmc5240, TMC5240_VSTOP, profile->vStop);
+}
+
+// Common IC interface, see tmc/helpers/ICInterface.h
+static int32_t interfaceReadInt(void *ic, uint8_t address)
+{
+	return tmc5240_readInt(ic, address);
+}
+
+static void interfaceWriteInt(void *ic, uint8_t address, int32_t value)
+{
+	tmc5240_writeInt(ic, address, value);
+}
+
+static void interfaceReadIntBatch(void *ic, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	tmc5240_readIntBatch(ic, addresses, values, count);
+}
+
+static TMCConfigStatus interfacePeriodicJob(void *ic, uint32_t tick)
+{
+	return tmc5240_periodicJob(ic, tick);
+}
+
+#if TMC_FEATURE_TELEMETRY
+static bool interfaceReadTelemetry(void *ic, int32_t *values, uint32_t *tick)
+{
+	return tmc5240_readAdc(ic, values, tick);
+}
+#endif
+
+const TMCICInterface tmc5240_interface =
+{
+	.name           = "TMC5240",
+	.readInt        = interfaceReadInt,
+	.writeInt       = interfaceWriteInt,
+	.readIntBatch   = interfaceReadIntBatch,
+	.periodicJob    = interfacePeriodicJob,
+#if TMC_FEATURE_TELEMETRY
+	.readTelemetry  = interfaceReadTelemetry,
+	.telemetryCount = TMC_ADC_VALUE_COUNT,
+#endif
+};
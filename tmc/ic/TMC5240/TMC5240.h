@@ -19,6 +19,9 @@
 	FIELD_GET(tmc5240_readInt(tdef, address), mask, shift)
 #define TMC5240_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc5240_writeInt(tdef, address, FIELD_SET(tmc5240_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5240_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc5240_writeInt(tdef, address, FIELDS_SET(tmc5240_readInt(tdef, address), mask, values)))
 
 // Factor between 10ms units and internal units for 16MHz
 //#define TPOWERDOWN_FACTOR (4.17792*100.0/255.0)
@@ -28,11 +31,17 @@
 typedef struct
 {
 	ConfigurationTypeDef *config;
+	TMCUnitConversion units;  // Clock dependent unit conversions, see tmc5240_setClockFrequency()
 	int velocity, oldX;
 	uint32_t oldTick;
+	TMCVelocitySource velocitySource;  // See tmc5240_setVelocitySource()
 	int32_t registerResetState[TMC5240_REGISTER_COUNT];
 	uint8_t registerAccess[TMC5240_REGISTER_COUNT];
 	uint8_t slaveAddress;
+	TMC_Comm_Mode commMode;  // Set with tmc5240_setCommMode()
+#if TMC_FEATURE_TELEMETRY
+	TMCAdcTelemetryTypeDef adc;  // Supply, AIN and temperature, see tmc5240_readAdc()
+#endif
 } TMC5240TypeDef;
 
 typedef void (*tmc5240_callback)(TMC5240TypeDef*, ConfigState);
@@ -98,10 +107,57 @@ static const uint8_t tmc5240_defaultRegisterAccess[TMC5240_REGISTER_COUNT] =
 	0x03, 0x01, 0x01, ____, 0x03, 0x01, 0x01, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc5240_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc5240_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x05, 0x06, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20, 0x21, 0x23,
+	0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x33, 0x34, 0x35,
+	0x38, 0x39, 0x3A, 0x3B, 0x3D, 0x52, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x6C, 0x6D, 0x6E, 0x70, 0x74
+};
+
+static const uint8_t tmc5240_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x04, 0x05, 0x06, 0x0A, 0x0B, 0x10, 0x11, 0x13, 0x14, 0x15, 0x20, 0x21, 0x23,
+	0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x33, 0x34, 0x35,
+	0x38, 0x39, 0x3A, 0x3B, 0x3D, 0x52, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x6C, 0x6D, 0x6E, 0x70, 0x74
+};
+
 // Register constants (only required for 0x42 registers, since we do not have
 // any way to find out the content but want to hold the actual value in the
 // shadow register so an application (i.e. the TMCL IDE) can still display
 // the values. This only works when the register content is constant.
+// Power-on values of the restorable registers, all others power up as 0.
+// Used to skip writes by a restore and by tmc5240_resetFromPowerOn(). Use ascending addresses!
+static const TMCRegisterConstant tmc5240_powerOnRegisters[] =
+{
+	{ 0x00, 0x00000008 }, // GCONF
+	{ 0x0A, 0x00000020 }, // DRV_CONF
+	{ 0x11, 0x0000000A }, // TPOWERDOWN
+	{ 0x2A, 0x0000000A }, // D1
+	{ 0x2B, 0x0000000A }, // VSTOP
+	{ 0x30, 0x0000000A }, // D2
+	{ 0x3A, 0x00010000 }, // ENC_CONST
+	{ 0x52, 0x0B920F25 }, // OTW_OV_VTH
+	{ 0x60, 0xAAAAB554 }, // MSLUT[0]
+	{ 0x61, 0x4A9554AA }, // MSLUT[1]
+	{ 0x62, 0x24492929 }, // MSLUT[2]
+	{ 0x63, 0x10104222 }, // MSLUT[3]
+	{ 0x64, 0xFBFFFFFF }, // MSLUT[4]
+	{ 0x65, 0xB5BB777D }, // MSLUT[5]
+	{ 0x66, 0x49295556 }, // MSLUT[6]
+	{ 0x67, 0x00404222 }, // MSLUT[7]
+	{ 0x68, 0xFFFF8056 }, // MSLUTSEL
+	{ 0x69, 0x00F70000 }, // MSLUTSTART
+	{ 0x70, 0xC44C001E }  // PWMCONF
+};
+
 static const TMCRegisterConstant tmc5240_RegisterConstants[] =
 {		// Use ascending addresses!
 		///
@@ -110,16 +166,28 @@ static const TMCRegisterConstant tmc5240_RegisterConstants[] =
 //void tmc5240_writeDatagram(TMC5240TypeDef *tmc5240, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5240_writeInt(TMC5240TypeDef *tmc5240, uint8_t address, int32_t value);
 int32_t tmc5240_readInt(TMC5240TypeDef *tmc5240, uint8_t address);
+void tmc5240_readIntBatch(TMC5240TypeDef *tmc5240, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc5240_setCommMode(TMC5240TypeDef *tmc5240, TMC_Comm_Mode mode);
 
 void tmc5240_init(TMC5240TypeDef *tmc5240, uint8_t channel, ConfigurationTypeDef *config, const int32_t *registerResetState);
 //void tmc5240_fillShadowRegisters(TMC5240TypeDef *tmc5240);
 uint8_t tmc5240_reset(TMC5240TypeDef *tmc5240);
+uint8_t tmc5240_resetFromPowerOn(TMC5240TypeDef *tmc5240);
 uint8_t tmc5240_restore(TMC5240TypeDef *tmc5240);
 uint8_t tmc5240_getSlaveAddress(TMC5240TypeDef *tmc5240);
 void tmc5240_setSlaveAddress(TMC5240TypeDef *tmc5240, uint8_t slaveAddress);
 void tmc5240_setRegisterResetState(TMC5240TypeDef *tmc5240, const int32_t *resetState);
 void tmc5240_setCallback(TMC5240TypeDef *tmc5240, tmc5240_callback callback);
-void tmc5240_periodicJob(TMC5240TypeDef *tmc5240, uint32_t tick);
+TMCConfigStatus tmc5240_periodicJob(TMC5240TypeDef *tmc5240, uint32_t tick);
+void tmc5240_periodicJobFast(TMC5240TypeDef *tmc5240, uint32_t tick);
+TMCConfigStatus tmc5240_periodicJobBackground(TMC5240TypeDef *tmc5240, uint32_t tick);
+void tmc5240_setClockFrequency(TMC5240TypeDef *tmc5240, uint32_t clockFrequency);
+void tmc5240_setVelocitySource(TMC5240TypeDef *tmc5240, TMCVelocitySource source);
+uint8_t tmc5240_configureBurst(TMC5240TypeDef *tmc5240, uint32_t maxSteps);
+#if TMC_FEATURE_TELEMETRY
+bool tmc5240_readAdc(TMC5240TypeDef *tmc5240, int32_t *values, uint32_t *tick);
+bool tmc5240_thermalUpdate(TMC5240TypeDef *tmc5240, TMCThermalDerating *thermal);
+#endif
 
 void tmc5240_rotate(TMC5240TypeDef *tmc5240, int32_t velocity);
 void tmc5240_right(TMC5240TypeDef *tmc5240, uint32_t velocity);
@@ -127,5 +195,8 @@ void tmc5240_left(TMC5240TypeDef *tmc5240, uint32_t velocity);
 void tmc5240_stop(TMC5240TypeDef *tmc5240);
 void tmc5240_moveTo(TMC5240TypeDef *tmc5240, int32_t position, uint32_t velocityMax);
 void tmc5240_moveBy(TMC5240TypeDef *tmc5240, int32_t *ticks, uint32_t velocityMax);
+void tmc5240_writeRampProfile(TMC5240TypeDef *tmc5240, const TMCRampProfileTypeDef *profile);
+
+extern const TMCICInterface tmc5240_interface;
 
 #endif /* TMC_IC_TMC5240_H_ */
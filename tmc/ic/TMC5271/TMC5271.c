@@ -6,7 +6,87 @@
  */
 
 #include <tmc/ic/TMC5271/TMC5271.h>
+#include "tmc/helpers/Functions.h"
+
+// => SPI wrapper
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc5271_readWriteSPI(uint8_t channel, uint8_t *data, size_t length);
+// <= SPI wrapper
+
+// => UART wrapper
+// Send [writeLength] bytes of [data], then receive [readLength] bytes into [data]
+extern void tmc5271_readWriteUART(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
+// <= UART wrapper
+
+// => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc5271_CRC8 NULL
+#else
+extern uint8_t tmc5271_CRC8(uint8_t *data, size_t length);
+#endif
+// <= CRC wrapper
+
+static const TMCSpiInterface spi =
+{
+	.readWriteArray  = tmc5271_readWriteSPI,
+	TMC_INSTRUMENT_NAME("TMC5271")
+};
 
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc5271_readWriteUART,
+	.crc             = tmc5271_CRC8,
+	TMC_INSTRUMENT_NAME("TMC5271")
+};
+
+// Select the interface the IC is connected with. TMC_COMM_DEFAULT is SPI.
+// UART datagrams are sent to the address set with tmc5271_setSlaveAddress().
+void tmc5271_setCommMode(TMC5271TypeDef *tmc5271, TMC_Comm_Mode mode)
+{
+	tmc5271->commMode = mode;
+}
+
+void tmc5271_writeInt(TMC5271TypeDef *tmc5271, uint8_t address, int32_t value)
+{
+	if(tmc5271->commMode == TMC_COMM_UART)
+		tmc_uart_writeInt(&uart, tmc5271->config->channel, tmc5271->slaveAddress, address, value);
+	else
+		tmc_spi_writeInt(&spi, tmc5271->config->channel, address, value);
+}
+
+int32_t tmc5271_readInt(TMC5271TypeDef *tmc5271, uint8_t address)
+{
+	int32_t value;
+
+	address = TMC_ADDRESS(address);
+
+	if(tmc5271->commMode != TMC_COMM_UART)
+		return tmc_spi_readInt(&spi, tmc5271->config->channel, address);
+
+	// An invalid reply reads as 0
+	tmc_uart_readInt(&uart, tmc5271->config->channel, tmc5271->slaveAddress, address, &value);
+
+	return value;
+}
+
+// Read multiple registers. Over SPI the read requests are pipelined, taking
+// count+1 transfers instead of 2*count, see tmc/helpers/SPI.h.
+void tmc5271_readIntBatch(TMC5271TypeDef *tmc5271, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	size_t i;
+
+	if(tmc5271->commMode != TMC_COMM_UART)
+	{
+		tmc_spi_readIntBatch(&spi, tmc5271->config, NULL, addresses, values, count);
+		return;
+	}
+
+	// UART replies follow their request directly, there is nothing to pipeline
+	for(i = 0; i < count; i++)
+		values[i] = tmc5271_readInt(tmc5271, addresses[i]);
+}
 
 // Initialize a TMC5271 IC.
 // This function requires:
@@ -22,6 +102,8 @@ void tmc5271_init(TMC5271TypeDef *tmc5271, uint8_t channel, ConfigurationTypeDef
 		tmc5271->oldX[motor] = 0;
 	}
 
+	tmc5271->commMode = TMC_COMM_DEFAULT;
+
 	tmc5271->config               = config;
 	tmc5271->config->callback     = NULL;
 	tmc5271->config->channel      = channel;
@@ -63,14 +145,14 @@ static void writeConfiguration(TMC5271TypeDef *tmc5271)
 }
 
 // Call this periodically
-void tmc5271_periodicJob(TMC5271TypeDef *tmc5271, uint32_t tick)
+TMCConfigStatus tmc5271_periodicJob(TMC5271TypeDef *tmc5271, uint32_t tick)
 {
 	uint32_t tickDiff;
 
 	if(tmc5271->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc5271);
-		return;
+		return TMC_CONFIG_STATUS(tmc5271->config);
 	}
 
 	int32_t x;
@@ -81,11 +163,13 @@ void tmc5271_periodicJob(TMC5271TypeDef *tmc5271, uint32_t tick)
 		for(uint8_t motor = 0; motor < TMC5271_MOTORS; motor++)
 		{
 			x = tmc5271_readInt(tmc5271, TMC5271_XACTUAL);
-			tmc5271->velocity[motor] = (uint32_t) ((float32_t) (abs(x - tmc5271->oldX[motor]) / (float32_t) tickDiff) * (float32_t) 1048.576);
+			tmc5271->velocity[motor] = tmc_estimateVelocity(abs(x - tmc5271->oldX[motor]), tickDiff);
 			tmc5271->oldX[motor] = x;
 		}
 		tmc5271->oldTick  = tick;
 	}
+
+	return TMC_CONFIG_STATUS_READY;
 }
 
 
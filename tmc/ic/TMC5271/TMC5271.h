@@ -18,6 +18,9 @@
 	FIELD_GET(tmc5271_readInt(tdef, address), mask, shift)
 #define TMC5271_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc5271_writeInt(tdef, address, FIELD_SET(tmc5271_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5271_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc5271_writeInt(tdef, address, FIELDS_SET(tmc5271_readInt(tdef, address), mask, values)))
 
 // Typedefs
 typedef struct
@@ -29,6 +32,7 @@ typedef struct
 	int32_t registerResetState[TMC5271_REGISTER_COUNT];
 	uint8_t registerAccess[TMC5271_REGISTER_COUNT];
 	uint8_t slaveAddress;
+	TMC_Comm_Mode commMode;  // Set with tmc5271_setCommMode()
 } TMC5271TypeDef;
 
 typedef void (*tmc5271_callback)(TMC5271TypeDef*, ConfigState);
@@ -106,6 +110,8 @@ static const TMCRegisterConstant tmc5271_RegisterConstants[] =
 //void tmc5271_writeDatagram(TMC5271TypeDef *tmc5271, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5271_writeInt(TMC5271TypeDef *tmc5271, uint8_t address, int32_t value);
 int32_t tmc5271_readInt(TMC5271TypeDef *tmc5271, uint8_t address);
+void tmc5271_readIntBatch(TMC5271TypeDef *tmc5271, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc5271_setCommMode(TMC5271TypeDef *tmc5271, TMC_Comm_Mode mode);
 
 void tmc5271_init(TMC5271TypeDef *tmc5271, uint8_t channel, ConfigurationTypeDef *config);
 //void tmc5271_fillShadowRegisters(TMC5271TypeDef *tmc5271);
@@ -115,7 +121,7 @@ uint8_t tmc5271_getSlaveAddress(TMC5271TypeDef *tmc5271);
 void tmc5271_setSlaveAddress(TMC5271TypeDef *tmc5271, uint8_t slaveAddress);
 void tmc5271_setRegisterResetState(TMC5271TypeDef *tmc5271, const int32_t *resetState);
 void tmc5271_setCallback(TMC5271TypeDef *tmc5271, tmc5271_callback callback);
-void tmc5271_periodicJob(TMC5271TypeDef *tmc5271, uint32_t tick);
+TMCConfigStatus tmc5271_periodicJob(TMC5271TypeDef *tmc5271, uint32_t tick);
 
 void tmc5271_rotate(TMC5271TypeDef *tmc5271, uint8_t motor, int32_t velocity);
 void tmc5271_right(TMC5271TypeDef *tmc5271, uint8_t motor, int32_t velocity);
@@ -6,7 +6,87 @@
  */
 
 #include "TMC5272.h"
+#include "tmc/helpers/Functions.h"
+
+// => SPI wrapper
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc5272_readWriteSPI(uint8_t channel, uint8_t *data, size_t length);
+// <= SPI wrapper
+
+// => UART wrapper
+// Send [writeLength] bytes of [data], then receive [readLength] bytes into [data]
+extern void tmc5272_readWriteUART(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
+// <= UART wrapper
+
+// => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc5272_CRC8 NULL
+#else
+extern uint8_t tmc5272_CRC8(uint8_t *data, size_t length);
+#endif
+// <= CRC wrapper
+
+static const TMCSpiInterface spi =
+{
+	.readWriteArray  = tmc5272_readWriteSPI,
+	TMC_INSTRUMENT_NAME("TMC5272")
+};
+
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc5272_readWriteUART,
+	.crc             = tmc5272_CRC8,
+	TMC_INSTRUMENT_NAME("TMC5272")
+};
+
+// Select the interface the IC is connected with. TMC_COMM_DEFAULT is SPI.
+// UART datagrams are sent to the address set with tmc5272_setSlaveAddress().
+void tmc5272_setCommMode(TMC5272TypeDef *tmc5272, TMC_Comm_Mode mode)
+{
+	tmc5272->commMode = mode;
+}
+
+void tmc5272_writeInt(TMC5272TypeDef *tmc5272, uint8_t address, int32_t value)
+{
+	if(tmc5272->commMode == TMC_COMM_UART)
+		tmc_uart_writeInt(&uart, tmc5272->config->channel, tmc5272->slaveAddress, address, value);
+	else
+		tmc_spi_writeInt(&spi, tmc5272->config->channel, address, value);
+}
+
+int32_t tmc5272_readInt(TMC5272TypeDef *tmc5272, uint8_t address)
+{
+	int32_t value;
+
+	address = TMC_ADDRESS(address);
 
+	if(tmc5272->commMode != TMC_COMM_UART)
+		return tmc_spi_readInt(&spi, tmc5272->config->channel, address);
+
+	// An invalid reply reads as 0
+	tmc_uart_readInt(&uart, tmc5272->config->channel, tmc5272->slaveAddress, address, &value);
+
+	return value;
+}
+
+// Read multiple registers. Over SPI the read requests are pipelined, taking
+// count+1 transfers instead of 2*count, see tmc/helpers/SPI.h.
+void tmc5272_readIntBatch(TMC5272TypeDef *tmc5272, const uint8_t *addresses, int32_t *values, size_t count)
+{
+	size_t i;
+
+	if(tmc5272->commMode != TMC_COMM_UART)
+	{
+		tmc_spi_readIntBatch(&spi, tmc5272->config, NULL, addresses, values, count);
+		return;
+	}
+
+	// UART replies follow their request directly, there is nothing to pipeline
+	for(i = 0; i < count; i++)
+		values[i] = tmc5272_readInt(tmc5272, addresses[i]);
+}
 
 // Initialize a TMC5272 IC.
 // This function requires:
@@ -22,6 +102,8 @@ void tmc5272_init(TMC5272TypeDef *tmc5272, uint8_t channel, ConfigurationTypeDef
 		tmc5272->oldX[motor] = 0;
 	}
 
+	tmc5272->commMode = TMC_COMM_DEFAULT;
+
 	tmc5272->config               = config;
 	tmc5272->config->callback     = NULL;
 	tmc5272->config->channel      = channel;
@@ -84,14 +166,14 @@ static void writeConfiguration(TMC5272TypeDef *tmc5272)
 }
 
 // Call this periodically
-void tmc5272_periodicJob(TMC5272TypeDef *tmc5272, uint32_t tick)
+TMCConfigStatus tmc5272_periodicJob(TMC5272TypeDef *tmc5272, uint32_t tick)
 {
 	uint32_t tickDiff;
 
 	if(tmc5272->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc5272);
-		return;
+		return TMC_CONFIG_STATUS(tmc5272->config);
 	}
 
 	int32_t x;
@@ -102,11 +184,13 @@ void tmc5272_periodicJob(TMC5272TypeDef *tmc5272, uint32_t tick)
 		for(uint8_t motor = 0; motor < TMC5272_MOTORS; motor++)
 		{
 			x = tmc5272_readInt(tmc5272, TMC5272_XACTUAL(motor));
-			tmc5272->velocity[motor] = (uint32_t) ((float32_t) (abs(x - tmc5272->oldX[motor]) / (float32_t) tickDiff) * (float32_t) 1048.576);
+			tmc5272->velocity[motor] = tmc_estimateVelocity(abs(x - tmc5272->oldX[motor]), tickDiff);
 			tmc5272->oldX[motor] = x;
 		}
 		tmc5272->oldTick  = tick;
 	}
+
+	return TMC_CONFIG_STATUS_READY;
 }
 
 
@@ -160,6 +244,52 @@ void tmc5272_moveBy(TMC5272TypeDef *tmc5272, uint8_t motor, uint32_t velocityMax
 	return tmc5272_moveTo(tmc5272, motor, *ticks, velocityMax);
 }
 
+// Move both motors. positions[] and velocityMax[] hold TMC5272_MOTORS entries.
+// RAMPMODE is shared by both motors and updated with a single write, the
+// XTARGET writes are sent last and back to back to start both moves together.
+void tmc5272_moveToBoth(TMC5272TypeDef *tmc5272, const int32_t *positions, const uint32_t *velocityMax)
+{
+	uint8_t motor;
+
+	TMC5272_FIELDS_WRITE(tmc5272, TMC5272_RAMPMODE, TMC5272_RAMPMODE_M0_RAMPMODE_MASK | TMC5272_RAMPMODE_M1_RAMPMODE_MASK,
+			FIELD_VALUE(TMC5272_RAMPMODE_M0_RAMPMODE_MASK, TMC5272_RAMPMODE_M0_RAMPMODE_SHIFT, TMC5272_MODE_POSITION)
+			| FIELD_VALUE(TMC5272_RAMPMODE_M1_RAMPMODE_MASK, TMC5272_RAMPMODE_M1_RAMPMODE_SHIFT, TMC5272_MODE_POSITION));
+
+	for(motor = 0; motor < TMC5272_MOTORS; motor++)
+		tmc5272_writeInt(tmc5272, TMC5272_VMAX(motor), velocityMax[motor]);
+
+	for(motor = 0; motor < TMC5272_MOTORS; motor++)
+		tmc5272_writeInt(tmc5272, TMC5272_XTARGET(motor), positions[motor]);
+}
+
+// Read XACTUAL, VACTUAL, RAMP_STAT and DRV_STATUS of both motors.
+// status[] holds TMC5272_MOTORS entries.
+// Note: Reading RAMP_STAT clears its event flags.
+void tmc5272_readStatusBoth(TMC5272TypeDef *tmc5272, TMC5272MotorStatusTypeDef *status)
+{
+	uint8_t addresses[4 * TMC5272_MOTORS];
+	int32_t values[4 * TMC5272_MOTORS];
+	uint8_t motor;
+
+	for(motor = 0; motor < TMC5272_MOTORS; motor++)
+	{
+		addresses[4 * motor + 0] = TMC5272_XACTUAL(motor);
+		addresses[4 * motor + 1] = TMC5272_VACTUAL(motor);
+		addresses[4 * motor + 2] = TMC5272_RAMP_STAT(motor);
+		addresses[4 * motor + 3] = TMC5272_DRV_STATUS(motor);
+	}
+
+	tmc5272_readIntBatch(tmc5272, addresses, values, ARRAY_SIZE(addresses));
+
+	for(motor = 0; motor < TMC5272_MOTORS; motor++)
+	{
+		status[motor].xActual    = values[4 * motor + 0];
+		status[motor].vActual    = CAST_Sn_TO_S32(values[4 * motor + 1], 24);
+		status[motor].rampStat   = values[4 * motor + 2];
+		status[motor].drvStatus  = values[4 * motor + 3];
+	}
+}
+
 
 uint8_t tmc5272_consistencyCheck(TMC5272TypeDef *tmc5272)
 {
@@ -18,6 +18,9 @@
 	FIELD_GET(tmc5272_readInt(tdef, address), mask, shift)
 #define TMC5272_FIELD_WRITE(tdef, address, mask, shift, value) \
 	(tmc5272_writeInt(tdef, address, FIELD_SET(tmc5272_readInt(tdef, address), mask, shift, value)))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC5272_FIELDS_WRITE(tdef, address, mask, values) \
+	(tmc5272_writeInt(tdef, address, FIELDS_SET(tmc5272_readInt(tdef, address), mask, values)))
 
 // Typedefs
 typedef struct
@@ -29,8 +32,18 @@ typedef struct
 	int32_t registerResetState[TMC5272_REGISTER_COUNT];
 	uint8_t registerAccess[TMC5272_REGISTER_COUNT];
 	uint8_t slaveAddress;
+	TMC_Comm_Mode commMode;  // Set with tmc5272_setCommMode()
 } TMC5272TypeDef;
 
+// Status snapshot of one motor, see tmc5272_readStatusBoth()
+typedef struct
+{
+	int32_t xActual;
+	int32_t vActual;
+	uint32_t rampStat;
+	uint32_t drvStatus;
+} TMC5272MotorStatusTypeDef;
+
 typedef void (*tmc5272_callback)(TMC5272TypeDef*, ConfigState);
 
 // Default Register values
@@ -64,6 +77,9 @@ typedef void (*tmc5272_callback)(TMC5272TypeDef*, ConfigState);
 //void tmc5272_writeDatagram(TMC5272TypeDef *tmc5272, uint8_t address, uint8_t x1, uint8_t x2, uint8_t x3, uint8_t x4);
 void tmc5272_writeInt(TMC5272TypeDef *tmc5272, uint8_t address, int32_t value);
 int32_t tmc5272_readInt(TMC5272TypeDef *tmc5272, uint8_t address);
+void tmc5272_readIntBatch(TMC5272TypeDef *tmc5272, const uint8_t *addresses, int32_t *values, size_t count);
+void tmc5272_setCommMode(TMC5272TypeDef *tmc5272, TMC_Comm_Mode mode);
+void tmc5272_readStatusBoth(TMC5272TypeDef *tmc5272, TMC5272MotorStatusTypeDef *status);
 
 void tmc5272_init(TMC5272TypeDef *tmc5272, uint8_t channel, ConfigurationTypeDef *config);
 //void tmc5272_fillShadowRegisters(TMC5272TypeDef *tmc5272);
@@ -73,7 +89,7 @@ uint8_t tmc5272_getSlaveAddress(TMC5272TypeDef *tmc5272);
 void tmc5272_setSlaveAddress(TMC5272TypeDef *tmc5272, uint8_t slaveAddress);
 void tmc5272_setRegisterResetState(TMC5272TypeDef *tmc5272, const int32_t *resetState);
 void tmc5272_setCallback(TMC5272TypeDef *tmc5272, tmc5272_callback callback);
-void tmc5272_periodicJob(TMC5272TypeDef *tmc5272, uint32_t tick);
+TMCConfigStatus tmc5272_periodicJob(TMC5272TypeDef *tmc5272, uint32_t tick);
 
 void tmc5272_rotate(TMC5272TypeDef *tmc5272, uint8_t motor, int32_t velocity);
 void tmc5272_right(TMC5272TypeDef *tmc5272, uint8_t motor, int32_t velocity);
@@ -81,6 +97,7 @@ void tmc5272_left(TMC5272TypeDef *tmc5272, uint8_t motor, int32_t velocity);
 void tmc5272_stop(TMC5272TypeDef *tmc5272, uint8_t motor);
 void tmc5272_moveTo(TMC5272TypeDef *tmc5272, uint8_t motor, int32_t position, uint32_t velocityMax);
 void tmc5272_moveBy(TMC5272TypeDef *tmc5272, uint8_t motor, uint32_t velocityMax, int32_t *ticks);
+void tmc5272_moveToBoth(TMC5272TypeDef *tmc5272, const int32_t *positions, const uint32_t *velocityMax);
 
 
 uint8_t tmc5272_consistencyCheck(TMC5272TypeDef *tmc5272);
@@ -8,7 +8,15 @@
 #include "TMC6100.h"
 
 // => SPI wrapper
+#ifdef TMC6100_SPI_ARRAY
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc6100_readWriteArray(uint8_t motor, uint8_t *data, size_t length);
+#define tmc6100_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC6100", tmc6100_readWriteArray, channel, data, length)
+#else
 extern uint8_t tmc6100_readwriteByte(uint8_t motor, uint8_t data, uint8_t lastTransfer);
+#endif
 // <= SPI wrapper
 
 // spi access
@@ -17,6 +25,12 @@ int tmc6100_readInt(uint8_t motor, uint8_t address)
 	// clear write bit
 	address = TMC_ADDRESS(address);
 
+#ifdef TMC6100_SPI_ARRAY
+	uint8_t data[5] = { address, 0, 0, 0, 0 };
+	tmc6100_readWriteArray(motor, &data[0], 5);
+
+	return tmc_unpackInt32(&data[1]);
+#else
 	// write address
 	tmc6100_readwriteByte(motor, address, false);
 
@@ -30,10 +44,15 @@ int tmc6100_readInt(uint8_t motor, uint8_t address)
 	value |= tmc6100_readwriteByte(motor, 0, true);
 
 	return value;
+#endif
 }
 
 void tmc6100_writeInt(uint8_t motor, uint8_t address, int value)
 {
+#ifdef TMC6100_SPI_ARRAY
+	uint8_t data[5] = { address | TMC6100_WRITE_BIT, 0xFF & (value>>24), 0xFF & (value>>16), 0xFF & (value>>8), 0xFF & (value>>0) };
+	tmc6100_readWriteArray(motor, &data[0], 5);
+#else
 	// write address
 	tmc6100_readwriteByte(motor, address | TMC6100_WRITE_BIT, false);
 
@@ -42,4 +61,41 @@ void tmc6100_writeInt(uint8_t motor, uint8_t address, int value)
 	tmc6100_readwriteByte(motor, 0xFF & (value>>16), false);
 	tmc6100_readwriteByte(motor, 0xFF & (value>>8), false);
 	tmc6100_readwriteByte(motor, 0xFF & (value>>0), true);
+#endif
+}
+
+void tmc6100_initFaultWatchdog(TMC6100FaultWatchdogTypeDef *watchdog, uint8_t motor, uint32_t interval, tmc6100_faultCallback callback)
+{
+	watchdog->motor     = motor;
+	watchdog->interval  = interval;
+	watchdog->lastTick  = 0;
+	watchdog->faults    = 0;
+	watchdog->callback  = callback;
+}
+
+void tmc6100_faultWatchdogJob(TMC6100FaultWatchdogTypeDef *watchdog, uint32_t tick)
+{
+	uint32_t faults, newFaults;
+
+	if((uint32_t) (tick - watchdog->lastTick) < watchdog->interval)
+		return;
+	watchdog->lastTick = tick;
+
+	// Both status registers back to back
+	faults = tmc6100_readInt(watchdog->motor, TMC6100_GSTAT) & 0xFFFF;
+	faults |= (tmc6100_readInt(watchdog->motor, TMC6100_IOIN_OUTPUT) & (TMC6100_OTPW_MASK | TMC6100_OT136C_MASK | TMC6100_OT143C_MASK | TMC6100_OT150C_MASK)) << 8;
+
+	// The GSTAT flags stay set until cleared, only report each fault once
+	newFaults = faults & ~watchdog->faults;
+	watchdog->faults |= faults;
+
+	if(newFaults && watchdog->callback)
+		watchdog->callback(watchdog->motor, watchdog->faults, newFaults);
+}
+
+void tmc6100_clearFaults(TMC6100FaultWatchdogTypeDef *watchdog)
+{
+	// GSTAT flags are cleared by writing 1
+	tmc6100_writeInt(watchdog->motor, TMC6100_GSTAT, watchdog->faults & 0xFFFF);
+	watchdog->faults = 0;
 }
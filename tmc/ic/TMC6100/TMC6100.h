@@ -13,7 +13,33 @@
 #include "TMC6100_Register.h"
 #include "TMC6100_Fields.h"
 
+// Fault watchdog, see tmc6100_faultWatchdogJob()
+// The reported faults are the GSTAT flags (TMC6100_*_MASK of GSTAT) and the
+// overtemperature flags of IOIN, which are moved to the upper half word:
+#define TMC6100_FAULT_OTPW    (TMC6100_OTPW_MASK << 8)
+#define TMC6100_FAULT_OT136C  (TMC6100_OT136C_MASK << 8)
+#define TMC6100_FAULT_OT143C  (TMC6100_OT143C_MASK << 8)
+#define TMC6100_FAULT_OT150C  (TMC6100_OT150C_MASK << 8)
+
+// Called with all latched faults and the ones that were not reported before
+typedef void (*tmc6100_faultCallback)(uint8_t motor, uint32_t faults, uint32_t newFaults);
+
+typedef struct
+{
+	uint8_t motor;
+	uint32_t interval;   // Ticks between two polls
+	uint32_t lastTick;
+	uint32_t faults;     // Latched faults
+	tmc6100_faultCallback callback;
+} TMC6100FaultWatchdogTypeDef;
+
 int tmc6100_readInt(uint8_t motor, uint8_t address);
 void tmc6100_writeInt(uint8_t motor, uint8_t address, int value);
 
+void tmc6100_initFaultWatchdog(TMC6100FaultWatchdogTypeDef *watchdog, uint8_t motor, uint32_t interval, tmc6100_faultCallback callback);
+// Polls the status registers every [interval] ticks
+void tmc6100_faultWatchdogJob(TMC6100FaultWatchdogTypeDef *watchdog, uint32_t tick);
+// Clears the latched faults in the watchdog and in GSTAT
+void tmc6100_clearFaults(TMC6100FaultWatchdogTypeDef *watchdog);
+
 #endif /* TMC_IC_TMC6630_H_ */
@@ -8,7 +8,15 @@
 #include "TMC6200.h"
 
 // => SPI wrapper
+#ifdef TMC6200_SPI_ARRAY
+// Send [length] bytes stored in the [data] array over SPI and overwrite [data]
+// with the reply. The first byte sent/received is data[0].
+extern void tmc6200_readWriteArray(uint8_t motor, uint8_t *data, size_t length);
+#define tmc6200_readWriteArray(channel, data, length) \
+	TMC_INSTRUMENT_SPI("TMC6200", tmc6200_readWriteArray, channel, data, length)
+#else
 extern uint8_t tmc6200_readwriteByte(uint8_t motor, uint8_t data, uint8_t lastTransfer);
+#endif
 // <= SPI wrapper
 
 // spi access
@@ -17,6 +25,12 @@ int32_t tmc6200_readInt(uint8_t motor, uint8_t address)
 	// clear write bit
 	address = TMC_ADDRESS(address);
 
+#ifdef TMC6200_SPI_ARRAY
+	uint8_t data[5] = { address, 0, 0, 0, 0 };
+	tmc6200_readWriteArray(motor, &data[0], 5);
+
+	return tmc_unpackInt32(&data[1]);
+#else
 	// write address
 	tmc6200_readwriteByte(motor, address, false);
 
@@ -30,10 +44,15 @@ int32_t tmc6200_readInt(uint8_t motor, uint8_t address)
 	value |= tmc6200_readwriteByte(motor, 0, true);
 
 	return value;
+#endif
 }
 
 void tmc6200_writeInt(uint8_t motor, uint8_t address, int32_t value)
 {
+#ifdef TMC6200_SPI_ARRAY
+	uint8_t data[5] = { address | TMC6200_WRITE_BIT, 0xFF & (value>>24), 0xFF & (value>>16), 0xFF & (value>>8), 0xFF & (value>>0) };
+	tmc6200_readWriteArray(motor, &data[0], 5);
+#else
 	// write address
 	tmc6200_readwriteByte(motor, address | TMC6200_WRITE_BIT, false);
 
@@ -42,4 +61,41 @@ void tmc6200_writeInt(uint8_t motor, uint8_t address, int32_t value)
 	tmc6200_readwriteByte(motor, 0xFF & (value>>16), false);
 	tmc6200_readwriteByte(motor, 0xFF & (value>>8), false);
 	tmc6200_readwriteByte(motor, 0xFF & (value>>0), true);
+#endif
+}
+
+void tmc6200_initFaultWatchdog(TMC6200FaultWatchdogTypeDef *watchdog, uint8_t motor, uint32_t interval, tmc6200_faultCallback callback)
+{
+	watchdog->motor     = motor;
+	watchdog->interval  = interval;
+	watchdog->lastTick  = 0;
+	watchdog->faults    = 0;
+	watchdog->callback  = callback;
+}
+
+void tmc6200_faultWatchdogJob(TMC6200FaultWatchdogTypeDef *watchdog, uint32_t tick)
+{
+	uint32_t faults, newFaults;
+
+	if((uint32_t) (tick - watchdog->lastTick) < watchdog->interval)
+		return;
+	watchdog->lastTick = tick;
+
+	// Both status registers back to back
+	faults = tmc6200_readInt(watchdog->motor, TMC6200_GSTAT) & 0xFFFF;
+	faults |= (tmc6200_readInt(watchdog->motor, TMC6200_IOIN_OUTPUT) & (TMC6200_OTPW_MASK | TMC6200_OT136C_MASK | TMC6200_OT143C_MASK | TMC6200_OT150C_MASK)) << 8;
+
+	// The GSTAT flags stay set until cleared, only report each fault once
+	newFaults = faults & ~watchdog->faults;
+	watchdog->faults |= faults;
+
+	if(newFaults && watchdog->callback)
+		watchdog->callback(watchdog->motor, watchdog->faults, newFaults);
+}
+
+void tmc6200_clearFaults(TMC6200FaultWatchdogTypeDef *watchdog)
+{
+	// GSTAT flags are cleared by writing 1
+	tmc6200_writeInt(watchdog->motor, TMC6200_GSTAT, watchdog->faults & 0xFFFF);
+	watchdog->faults = 0;
 }
@@ -13,6 +13,26 @@
 #include "TMC6200_Constants.h"
 #include "TMC6200_Fields.h"
 
+// Fault watchdog, see tmc6200_faultWatchdogJob()
+// The reported faults are the GSTAT flags (TMC6200_*_MASK of GSTAT) and the
+// overtemperature flags of IOIN, which are moved to the upper half word:
+#define TMC6200_FAULT_OTPW    (TMC6200_OTPW_MASK << 8)
+#define TMC6200_FAULT_OT136C  (TMC6200_OT136C_MASK << 8)
+#define TMC6200_FAULT_OT143C  (TMC6200_OT143C_MASK << 8)
+#define TMC6200_FAULT_OT150C  (TMC6200_OT150C_MASK << 8)
+
+// Called with all latched faults and the ones that were not reported before
+typedef void (*tmc6200_faultCallback)(uint8_t motor, uint32_t faults, uint32_t newFaults);
+
+typedef struct
+{
+	uint8_t motor;
+	uint32_t interval;   // Ticks between two polls
+	uint32_t lastTick;
+	uint32_t faults;     // Latched faults
+	tmc6200_faultCallback callback;
+} TMC6200FaultWatchdogTypeDef;
+
 // Helper macros
 #define TMC6200_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc6200_readInt(tdef, address), mask, shift)
@@ -22,4 +42,10 @@
 int32_t tmc6200_readInt(uint8_t motor, uint8_t address);
 void tmc6200_writeInt(uint8_t motor, uint8_t address, int32_t value);
 
+void tmc6200_initFaultWatchdog(TMC6200FaultWatchdogTypeDef *watchdog, uint8_t motor, uint32_t interval, tmc6200_faultCallback callback);
+// Polls the status registers every [interval] ticks
+void tmc6200_faultWatchdogJob(TMC6200FaultWatchdogTypeDef *watchdog, uint32_t tick);
+// Clears the latched faults in the watchdog and in GSTAT
+void tmc6200_clearFaults(TMC6200FaultWatchdogTypeDef *watchdog);
+
 #endif /* TMC_IC_TMC6630_H_ */
@@ -11,10 +11,30 @@
 extern void tmc7300_readWriteArray(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength);
 // <= UART wrapper
 
+#ifdef TMC7300_ASYNC
+// => Async UART wrapper
+// Start sending [writeLength] bytes stored in the [data] array and return immediately.
+// Once [readLength] reply bytes have been written to [data], call complete(context).
+extern void tmc7300_readWriteArrayAsync(uint8_t channel, uint8_t *data, size_t writeLength, size_t readLength, tmc_async_complete complete, void *context);
+// <= Async UART wrapper
+#endif
+
 // => CRC wrapper
+#ifdef TMC_CRC8_ENGINE_FLASH
+// The constant CRC table needs no initialization, no user callback required
+#define tmc7300_CRC8 NULL
+#else
 extern uint8_t tmc7300_CRC8(uint8_t *data, size_t length);
+#endif
 // <= CRC wrapper
 
+static const TMCUartInterface uart =
+{
+	.readWriteArray  = tmc7300_readWriteArray,
+	.crc             = tmc7300_CRC8,
+	TMC_INSTRUMENT_NAME("TMC7300")
+};
+
 void tmc7300_writeInt(TMC7300TypeDef *tmc7300, uint8_t address, int32_t value)
 {
 	// When we are in standby or in the reset procedure we do not actually write
@@ -23,18 +43,7 @@ void tmc7300_writeInt(TMC7300TypeDef *tmc7300, uint8_t address, int32_t value)
 	// register contents into the chip.
 	if (!tmc7300->standbyEnabled || tmc7300->config->state == CONFIG_RESET)
 	{
-		uint8_t data[8];
-
-		data[0] = 0x05;
-		data[1] = tmc7300->slaveAddress;
-		data[2] = address | TMC_WRITE_BIT;
-		data[3] = (value >> 24) & 0xFF;
-		data[4] = (value >> 16) & 0xFF;
-		data[5] = (value >> 8 ) & 0xFF;
-		data[6] = (value      ) & 0xFF;
-		data[7] = tmc7300_CRC8(data, 7);
-
-		tmc7300_readWriteArray(tmc7300->config->channel, &data[0], 8, 0);
+		tmc_uart_writeInt(&uart, tmc7300->config->channel, tmc7300->slaveAddress, address, value);
 	}
 
 	// Write to the shadow register and mark the register dirty
@@ -43,112 +52,169 @@ void tmc7300_writeInt(TMC7300TypeDef *tmc7300, uint8_t address, int32_t value)
 	tmc7300->registerAccess[address] |= TMC_ACCESS_DIRTY;
 }
 
-int32_t tmc7300_readInt(TMC7300TypeDef *tmc7300, uint8_t address)
+// Read an integer from the given address.
+// Returns false if no valid reply was received after TMC_UART_READ_RETRIES retries.
+bool tmc7300_readIntChecked(TMC7300TypeDef *tmc7300, uint8_t address, int32_t *value)
 {
-	uint8_t data[8] = { 0 };
-
 	address = TMC_ADDRESS(address);
 
 	// When the chip is in standby or when accessing a write-only register
 	// use the shadow register content instead.
 	if (tmc7300->standbyEnabled || !TMC_IS_READABLE(tmc7300->registerAccess[address]))
-		return tmc7300->config->shadowRegister[address];
+	{
+		*value = tmc7300->config->shadowRegister[address];
+		return true;
+	}
 
-	data[0] = 0x05;
-	data[1] = tmc7300->slaveAddress;
-	data[2] = address;
-	data[3] = tmc7300_CRC8(data, 3);
+	return tmc_uart_readInt(&uart, tmc7300->config->channel, tmc7300->slaveAddress, address, value);
+}
 
-	tmc7300_readWriteArray(tmc7300->config->channel, data, 4, 8);
+int32_t tmc7300_readInt(TMC7300TypeDef *tmc7300, uint8_t address)
+{
+	int32_t value;
 
-	// Byte 0: Sync nibble correct?
-	if (data[0] != 0x05)
-		return 0;
+	// An invalid reply reads as 0
+	tmc7300_readIntChecked(tmc7300, address, &value);
 
-	// Byte 1: Master address correct?
-	if (data[1] != 0xFF)
-		return 0;
+	return value;
+}
 
-	// Byte 2: Address correct?
-	if (data[2] != address)
-		return 0;
+// Fast PWM path
+// Both duty cycles share PWM_AB, so one 8 byte frame updates both motors.
 
-	// Byte 7: CRC correct?
-	if (data[7] != tmc7300_CRC8(data, 7))
-		return 0;
+// Signed duty cycles -255 ... 255 of motor A and B
+static int32_t pwmValue(int16_t dutyA, int16_t dutyB)
+{
+	dutyA = MIN(MAX(dutyA, -255), 255);
+	dutyB = MIN(MAX(dutyB, -255), 255);
 
-	return ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) | (data[5] << 8) | data[6];
+	return FIELD_VALUE(TMC7300_PWM_A_MASK, TMC7300_PWM_A_SHIFT, (uint32_t) dutyA)
+	     | FIELD_VALUE(TMC7300_PWM_B_MASK, TMC7300_PWM_B_SHIFT, (uint32_t) dutyB);
 }
 
-void tmc7300_init(TMC7300TypeDef *tmc7300, uint8_t channel, ConfigurationTypeDef *tmc7300_config, const int32_t *registerResetState)
+// The IC already holds [value]. PWM_AB is write only, the shadow register holds the last write.
+static bool pwmUnchanged(TMC7300TypeDef *tmc7300, int32_t value)
 {
-	tmc7300->config               = tmc7300_config;
-	tmc7300->config->callback     = NULL;
-	tmc7300->config->channel      = channel;
-	tmc7300->config->configIndex  = 0;
-	tmc7300->config->state        = CONFIG_RESET;
+	return (tmc7300->config->state == CONFIG_READY)
+		&& (tmc7300->registerAccess[TMC7300_PWM_AB] & TMC_ACCESS_DIRTY)
+		&& (tmc7300->config->shadowRegister[TMC7300_PWM_AB] == value);
+}
 
-	// Default slave address: 0
-	tmc7300->slaveAddress = 0;
+// Set the duty cycles of both motors (-255 ... 255) with one PWM_AB write.
+// The write is skipped if neither duty cycle changed.
+void tmc7300_setPWM(TMC7300TypeDef *tmc7300, int16_t dutyA, int16_t dutyB)
+{
+	int32_t value = pwmValue(dutyA, dutyB);
 
-	// Start in standby
-	tmc7300->standbyEnabled = 1;
+	if(pwmUnchanged(tmc7300, value))
+		return;
 
-	int i;
-	for(i = 0; i < TMC7300_REGISTER_COUNT; i++)
+	tmc7300_writeInt(tmc7300, TMC7300_PWM_AB, value);
+}
+
+#ifdef TMC7300_ASYNC
+static void setPWMAsyncComplete(void *context)
+{
+	TMCAsyncRequestTypeDef *request = context;
+	TMC7300TypeDef *tmc7300 = request->ic;
+
+	if(!tmc_uart_checkWriteEcho(&uart, request->data, tmc7300->slaveAddress, request->address, request->value))
 	{
-		tmc7300->registerAccess[i]      = tmc7300_defaultRegisterAccess[i];
-		tmc7300->registerResetState[i]  = registerResetState[i];
+		tmc_asyncFinish(request, TMC_ASYNC_ERROR);
+		return;
 	}
+
+	tmc7300->config->shadowRegister[request->address] = request->value;
+	tmc7300->registerAccess[request->address] |= TMC_ACCESS_DIRTY;
+
+	tmc_asyncFinish(request, TMC_ASYNC_DONE);
 }
 
-// Fill the shadow registers of hardware preset registers.
-// Only needed if you want to read out those registers to display the value
-// (e.g. for the TMCL IDE register browser)
-static void fillShadowRegisters(TMC7300TypeDef *tmc7300)
+// Non-blocking tmc7300_setPWM() for control loops. An unchanged duty cycle pair or a
+// write in standby finishes immediately without a transfer.
+// Returns the request handle or NULL if [request] is still pending - keep the previous
+// duty cycles for this control cycle then.
+TMCAsyncRequestTypeDef *tmc7300_setPWMAsync(TMC7300TypeDef *tmc7300, TMCAsyncRequestTypeDef *request, int16_t dutyA, int16_t dutyB, tmc_async_callback callback, void *userData)
 {
-	// Check if we have constants defined
-	if(ARRAY_SIZE(tmc7300_registerConstants) == 0)
-		return;
+	int32_t value = pwmValue(dutyA, dutyB);
 
-	size_t i, j = 0;
-	for(i = 0; i < TMC7300_REGISTER_COUNT; i++)
-	{
-		// We only need to worry about hardware preset registers
-		// that have not yet been written (no dirty bit) here.
-		if(!TMC_IS_PRESET(tmc7300->registerAccess[i]) || TMC_IS_DIRTY(tmc7300->registerAccess[i]))
-			continue;
+	if(!tmc_asyncStart(request, tmc7300, tmc7300->config->channel, TMC7300_PWM_AB, value, callback, userData))
+		return NULL;
 
-		// Search the constant list for the current address. With the constant
-		// list being sorted in ascended order, we can walk through the list
-		// until the entry with an address equal or greater than i
-		while (j < ARRAY_SIZE(tmc7300_registerConstants) && (tmc7300_registerConstants[j].address < i))
+	if(pwmUnchanged(tmc7300, value) || tmc7300->standbyEnabled)
+	{
+		if(tmc7300->standbyEnabled)
 		{
-			j++;
+			tmc7300->config->shadowRegister[TMC7300_PWM_AB] = value;
+			tmc7300->registerAccess[TMC7300_PWM_AB] |= TMC_ACCESS_DIRTY;
 		}
 
-		// If we have an entry for our current address, write the constant
-		if (tmc7300_registerConstants[j].address == i)
-		{
-			tmc7300->config->shadowRegister[i] = tmc7300_registerConstants[j].value;
-		}
+		tmc_asyncFinish(request, TMC_ASYNC_DONE);
+		return request;
 	}
+
+	tmc_uart_fillWriteFrame(&uart, request->data, tmc7300->slaveAddress, TMC7300_PWM_AB, value);
+	tmc7300_readWriteArrayAsync(request->channel, request->data, TMC_UART_WRITE_LENGTH, TMC_UART_ECHO_LENGTH(TMC_UART_WRITE_LENGTH), setPWMAsyncComplete, request);
+
+	return request;
+}
+#endif
+
+// Register driver core, see tmc/helpers/RegisterDriver.h
+static void writeRegister(void *ic, uint8_t address, int32_t value)
+{
+	tmc7300_writeInt(ic, address, value);
+}
+
+static const TMCRegisterDriver driver =
+{
+	.registerCount          = TMC7300_REGISTER_COUNT,
+	.defaultRegisterAccess  = tmc7300_defaultRegisterAccess,
+	.resettableRegisters    = tmc7300_resettableRegisters,
+	.resettableCount        = ARRAY_SIZE(tmc7300_resettableRegisters),
+	.restorableRegisters    = tmc7300_restorableRegisters,
+	.restorableCount        = ARRAY_SIZE(tmc7300_restorableRegisters),
+	.constants              = tmc7300_registerConstants,
+	.constantCount          = ARRAY_SIZE(tmc7300_registerConstants),
+	.writeInt               = writeRegister,
+};
+
+void tmc7300_init(TMC7300TypeDef *tmc7300, uint8_t channel, ConfigurationTypeDef *tmc7300_config, const int32_t *registerResetState)
+{
+	tmc7300->config = tmc7300_config;
+	tmc_driver_init(&driver, tmc7300->config, channel, tmc7300->registerAccess, tmc7300->registerResetState, registerResetState);
+
+	// Start with a reset
+	tmc7300->config->state = CONFIG_RESET;
+
+	// Default slave address: 0
+	tmc7300->slaveAddress = 0;
+
+	// Start in standby
+	tmc7300->standbyEnabled = 1;
+}
+
+// Fill the shadow registers of hardware preset registers.
+// Only needed if you want to read out those registers to display the value
+// (e.g. for the TMCL IDE register browser)
+static void fillShadowRegisters(TMC7300TypeDef *tmc7300)
+{
+	tmc_driver_fillShadowRegisters(&driver, tmc7300->config, tmc7300->registerAccess);
 }
 
 static void writeConfiguration(TMC7300TypeDef *tmc7300)
 {
 	uint8_t *ptr = &tmc7300->config->configIndex;
 	const int32_t *settings;
+	const uint8_t *registers;
+	size_t registerCount;
 
 	// Find the next register to reset/restore
 	if (tmc7300->config->state == CONFIG_RESET)
 	{
 		settings = tmc7300->registerResetState;
-		// Find the next resettable register
-		while((*ptr < TMC7300_REGISTER_COUNT) && !TMC_IS_RESETTABLE(tmc7300->registerAccess[*ptr]))
-		{
-			(*ptr)++;
-		}
+		registers      = tmc7300_resettableRegisters;
+		registerCount  = ARRAY_SIZE(tmc7300_resettableRegisters);
 	}
 	else
 	{
@@ -157,17 +223,19 @@ static void writeConfiguration(TMC7300TypeDef *tmc7300)
 			return;
 
 		settings = tmc7300->config->shadowRegister;
-		// Find the next restorable register
-		while((*ptr < TMC7300_REGISTER_COUNT) && !TMC_IS_RESTORABLE(tmc7300->registerAccess[*ptr]))
+		registers      = tmc7300_restorableRegisters;
+		registerCount  = ARRAY_SIZE(tmc7300_restorableRegisters);
+		// Skip hardware preset registers that have not been written yet
+		while((*ptr < registerCount) && !TMC_IS_RESTORABLE(tmc7300->registerAccess[registers[*ptr]]))
 		{
 			(*ptr)++;
 		}
 	}
 
-	if(*ptr < TMC7300_REGISTER_COUNT)
+	if(*ptr < registerCount)
 	{
 		// Reset/restore the found register
-		tmc7300_writeInt(tmc7300, *ptr, settings[*ptr]);
+		tmc7300_writeInt(tmc7300, registers[*ptr], settings[registers[*ptr]]);
 		(*ptr)++;
 	}
 	else
@@ -196,11 +264,7 @@ static void writeConfiguration(TMC7300TypeDef *tmc7300)
 
 void tmc7300_setRegisterResetState(TMC7300TypeDef *tmc7300, const int32_t *resetState)
 {
-	size_t i;
-	for (i = 0; i < TMC7300_REGISTER_COUNT; i++)
-	{
-		tmc7300->registerResetState[i] = resetState[i];
-	}
+	tmc_driver_setRegisterResetState(&driver, tmc7300->registerResetState, resetState);
 }
 
 void tmc7300_setCallback(TMC7300TypeDef *tmc7300, tmc7300_callback callback)
@@ -208,15 +272,41 @@ void tmc7300_setCallback(TMC7300TypeDef *tmc7300, tmc7300_callback callback)
 	tmc7300->config->callback = (tmc_callback_config) callback;
 }
 
-void tmc7300_periodicJob(TMC7300TypeDef *tmc7300, uint32_t tick)
+TMCConfigStatus tmc7300_periodicJob(TMC7300TypeDef *tmc7300, uint32_t tick)
 {
 	UNUSED(tick);
 
 	if(tmc7300->config->state != CONFIG_READY)
 	{
 		writeConfiguration(tmc7300);
-		return;
+		return TMC_CONFIG_STATUS(tmc7300->config);
 	}
+
+	return TMC_CONFIG_STATUS_READY;
+}
+
+// Run the configuration mechanism for multiple registers within one call.
+// Up to [maxSteps] configuration steps are processed, each step writing one
+// register. Finishing the configuration (calling the callback) takes one step.
+// Pass 0 to complete the whole configuration at once.
+// Returns true if the configuration is completed.
+uint8_t tmc7300_configureBurst(TMC7300TypeDef *tmc7300, uint32_t maxSteps)
+{
+	uint32_t step;
+
+	for(step = 0; tmc7300->config->state != CONFIG_READY; step++)
+	{
+		if(maxSteps && (step >= maxSteps))
+			break;
+
+		// Restoring is paused while in standby
+		if((tmc7300->config->state == CONFIG_RESTORE) && tmc7300->standbyEnabled)
+			break;
+
+		writeConfiguration(tmc7300);
+	}
+
+	return (tmc7300->config->state == CONFIG_READY);
 }
 
 uint8_t tmc7300_reset(TMC7300TypeDef *tmc7300)
@@ -276,6 +366,63 @@ void tmc7300_setStandby(TMC7300TypeDef *tmc7300, uint8_t standbyState)
 	tmc7300->standbyEnabled = standbyState;
 }
 
+// Value of [address] after leaving standby: The hardware preset or 0
+static int32_t powerOnValue(uint8_t address)
+{
+	size_t i;
+
+	for(i = 0; i < ARRAY_SIZE(tmc7300_registerConstants); i++)
+	{
+		if(tmc7300_registerConstants[i].address == address)
+			return tmc7300_registerConstants[i].value;
+	}
+
+	return 0;
+}
+
+// Leave standby and restore the configuration in one burst.
+// Standby drops all register contents, the IC wakes with its power-on values.
+// Only registers whose configured value differs from that are written, instead
+// of restoring one register per tmc7300_periodicJob(). The configuration callback is
+// called with CONFIG_RESTORE once the IC is ready for motion.
+// A pending reset is not shortened - the regular mechanism continues then.
+// Returns the amount of registers written.
+uint8_t tmc7300_wake(TMC7300TypeDef *tmc7300)
+{
+	uint8_t written = 0;
+	size_t i;
+
+	if(tmc7300->config->state == CONFIG_RESET)
+	{
+		tmc7300_setStandby(tmc7300, 0);
+		return 0;
+	}
+
+	tmc7300->standbyEnabled = 0;
+
+	for(i = 0; i < ARRAY_SIZE(tmc7300_restorableRegisters); i++)
+	{
+		uint8_t address = tmc7300_restorableRegisters[i];
+		int32_t value = tmc7300->config->shadowRegister[address];
+
+		if(!TMC_IS_RESTORABLE(tmc7300->registerAccess[address]) || (value == powerOnValue(address)))
+			continue;
+
+		tmc7300_writeInt(tmc7300, address, value);
+		written++;
+	}
+
+	tmc7300->config->state        = CONFIG_READY;
+	tmc7300->config->configIndex  = 0;
+
+	if(tmc7300->config->callback)
+	{
+		((tmc7300_callback)tmc7300->config->callback)(tmc7300, CONFIG_RESTORE);
+	}
+
+	return written;
+}
+
 uint8_t tmc7300_consistencyCheck(TMC7300TypeDef *tmc7300)
 {
 	// Config has not yet been written -> it can't be consistent
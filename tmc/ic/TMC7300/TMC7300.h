@@ -18,7 +18,14 @@
 #define TMC7300_FIELD_READ(tdef, address, mask, shift) \
 	FIELD_GET(tmc7300_readInt(tdef, address), mask, shift)
 #define TMC7300_FIELD_WRITE(tdef, address, mask, shift, value) \
-	(tmc7300_writeInt(tdef, address, FIELD_SET(tmc7300_readInt(tdef, address), mask, shift, value)))
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc7300_writeInt(tdef, address, FIELD_SET(tmc7300_readInt(tdef, address), mask, shift, value))), \
+	TMC_UNLOCK((tdef)->config->channel))
+// Update multiple fields of a register with one read and one write, see FIELDS_SET
+#define TMC7300_FIELDS_WRITE(tdef, address, mask, values) \
+	(TMC_LOCK((tdef)->config->channel), \
+	(tmc7300_writeInt(tdef, address, FIELDS_SET(tmc7300_readInt(tdef, address), mask, values))), \
+	TMC_UNLOCK((tdef)->config->channel))
 
 // Usage note: use 1 TypeDef per IC
 typedef struct {
@@ -54,6 +61,22 @@ static const uint8_t tmc7300_defaultRegisterAccess[TMC7300_REGISTER_COUNT] =
 	0x43, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____, ____  // 0x70 - 0x7F
 };
 
+// Registers written by the configuration mechanism, in ascending order.
+// Derived from tmc7300_defaultRegisterAccess - keep both in sync. Walking these
+// lists saves scanning all 128 entries of the access table.
+//   resettable: Write access, no hardware preset (TMC_IS_RESETTABLE)
+//   restorable: Write access. Hardware preset registers are only restored
+//               once they have been written (TMC_IS_RESTORABLE)
+static const uint8_t tmc7300_resettableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x22
+};
+
+static const uint8_t tmc7300_restorableRegisters[] =
+{
+	0x00, 0x01, 0x03, 0x10, 0x22, 0x6C, 0x70
+};
+
 static const int32_t tmc7300_defaultRegisterResetState[TMC7300_REGISTER_COUNT] =
 {
 //	0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F
@@ -84,19 +107,27 @@ static const TMCRegisterConstant tmc7300_registerConstants[] =
 
 void tmc7300_writeInt(TMC7300TypeDef *tmc7300, uint8_t address, int32_t value);
 int32_t tmc7300_readInt(TMC7300TypeDef *tmc7300, uint8_t address);
+bool tmc7300_readIntChecked(TMC7300TypeDef *tmc7300, uint8_t address, int32_t *value);
+
+void tmc7300_setPWM(TMC7300TypeDef *tmc7300, int16_t dutyA, int16_t dutyB);
+#ifdef TMC7300_ASYNC
+TMCAsyncRequestTypeDef *tmc7300_setPWMAsync(TMC7300TypeDef *tmc7300, TMCAsyncRequestTypeDef *request, int16_t dutyA, int16_t dutyB, tmc_async_callback callback, void *userData);
+#endif
 
 void tmc7300_init(TMC7300TypeDef *tmc7300, uint8_t channel, ConfigurationTypeDef *tmc7300_config, const int32_t *registerResetState);
 uint8_t tmc7300_reset(TMC7300TypeDef *tmc7300);
 uint8_t tmc7300_restore(TMC7300TypeDef *tmc7300);
 void tmc7300_setRegisterResetState(TMC7300TypeDef *tmc7300, const int32_t *resetState);
 void tmc7300_setCallback(TMC7300TypeDef *tmc7300, tmc7300_callback callback);
-void tmc7300_periodicJob(TMC7300TypeDef *tmc7300, uint32_t tick);
+TMCConfigStatus tmc7300_periodicJob(TMC7300TypeDef *tmc7300, uint32_t tick);
+uint8_t tmc7300_configureBurst(TMC7300TypeDef *tmc7300, uint32_t maxSteps);
 
 uint8_t tmc7300_get_slave(TMC7300TypeDef *tmc7300);
 void tmc7300_set_slave(TMC7300TypeDef *tmc7300, uint8_t slaveAddress);
 
 uint8_t tmc7300_getStandby(TMC7300TypeDef *tmc7300);
 void tmc7300_setStandby(TMC7300TypeDef *tmc7300, uint8_t standbyState);
+uint8_t tmc7300_wake(TMC7300TypeDef *tmc7300);
 
 uint8_t tmc7300_consistencyCheck(TMC7300TypeDef *tmc7300);
 
@@ -13,6 +13,7 @@
 #include "TMC8461_Register.h"
 #include "TMC8461_Constants.h"
 #include "TMC8461_Fields.h"
+#include "tmc/ic/TMC846x/TMC846x.h"
 
 // Helper macros
 #define TMC8461_FIELD_READ(tdef, read, address, mask, shift) \
@@ -20,34 +21,50 @@
 #define TMC8461_FIELD_WRITE(tdef, read, write, address, mask, shift, value) \
 	(write(tdef, address, FIELD_SET(read(tdef, address), mask, shift, value)))
 
-typedef struct {
-	ConfigurationTypeDef *config_esc;
-	ConfigurationTypeDef *config_mfc;
-} TMC8461TypeDef;
-
-// Preparation functions to prepare r/w access on specific registers
-void tmc8461_esc_read(TMC8461TypeDef *tmc8461, uint16_t address);
-void tmc8461_esc_write(TMC8461TypeDef *tmc8461, uint16_t address);
-void tmc8461_mfc_read(TMC8461TypeDef *tmc8461, uint16_t address);
-void tmc8461_mfc_write(TMC8461TypeDef *tmc8461, uint16_t address);
-
-void tmc8461_esc_read_data(TMC8461TypeDef *tmc8461, uint8_t *data_ptr, uint16_t address, uint16_t len);
-uint8_t tmc8461_esc_read_8(TMC8461TypeDef *tmc8461, uint16_t address);
-uint16_t tmc8461_esc_read_16(TMC8461TypeDef *tmc8461, uint16_t address);
-uint32_t tmc8461_esc_read_32(TMC8461TypeDef *tmc8461, uint16_t address);
-void tmc8461_esc_write_data(TMC8461TypeDef *tmc8461, uint8_t *data_ptr, uint16_t address, uint16_t len);
-void tmc8461_esc_write_8(TMC8461TypeDef *tmc8461, uint16_t address, uint8_t value);
-void tmc8461_esc_write_16(TMC8461TypeDef *tmc8461, uint16_t address, uint16_t value);
-void tmc8461_esc_write_32(TMC8461TypeDef *tmc8461, uint16_t address, uint32_t value);
-
-void tmc8461_mfc_read_data(TMC8461TypeDef *tmc8461, uint8_t *data_ptr, uint16_t address, uint16_t len);
-void tmc8461_mfc_read_32(TMC8461TypeDef *tmc8461, uint16_t address, uint32_t *value);
-void tmc8461_mfc_read_64(TMC8461TypeDef *tmc8461, uint16_t address, uint64_t *value);
-void tmc8461_mfc_read_auto(TMC8461TypeDef *tmc8461, uint16_t address, uint8_t *value);
-void tmc8461_mfc_write_data(TMC8461TypeDef *tmc8461, uint8_t *data_ptr, uint16_t address, uint16_t len);
-void tmc8461_mfc_write_32(TMC8461TypeDef *tmc8461, uint16_t address, uint32_t value);
-void tmc8461_mfc_write_64(TMC8461TypeDef *tmc8461, uint16_t address, uint64_t value);
-void tmc8461_mfc_write_auto(TMC8461TypeDef *tmc8461, uint16_t address, uint8_t *value);
+// The access functions are implemented by the shared TMC846x core
+typedef TMC846xTypeDef          TMC8461TypeDef;
+typedef TMC846xPdoMapTypeDef    TMC8461PdoMapTypeDef;
+typedef TMC846xPdoDirection     TMC8461PdoDirection;
+
+#define TMC8461_PDO_RX      TMC846x_PDO_RX
+#define TMC8461_PDO_TX      TMC846x_PDO_TX
+#define TMC8461_PDO_BURSTS  TMC846x_PDO_BURSTS
+
+#define tmc8461_esc_read             tmc846x_esc_read
+#define tmc8461_esc_write            tmc846x_esc_write
+#define tmc8461_mfc_read             tmc846x_mfc_read
+#define tmc8461_mfc_write            tmc846x_mfc_write
+#define tmc8461_esc_read_data        tmc846x_esc_read_data
+#define tmc8461_esc_read_8           tmc846x_esc_read_8
+#define tmc8461_esc_read_16          tmc846x_esc_read_16
+#define tmc8461_esc_read_32          tmc846x_esc_read_32
+#define tmc8461_esc_read_64          tmc846x_esc_read_64
+#define tmc8461_esc_write_data       tmc846x_esc_write_data
+#define tmc8461_esc_write_8          tmc846x_esc_write_8
+#define tmc8461_esc_write_16         tmc846x_esc_write_16
+#define tmc8461_esc_write_32         tmc846x_esc_write_32
+#define tmc8461_esc_write_64         tmc846x_esc_write_64
+#define tmc8461_mfc_read_data        tmc846x_mfc_read_data
+#define tmc8461_mfc_read_32          tmc846x_mfc_read_32
+#define tmc8461_mfc_read_64          tmc846x_mfc_read_64
+#define tmc8461_mfc_read_auto        tmc846x_mfc_read_auto
+#define tmc8461_mfc_write_data       tmc846x_mfc_write_data
+#define tmc8461_mfc_write_32         tmc846x_mfc_write_32
+#define tmc8461_mfc_write_64         tmc846x_mfc_write_64
+#define tmc8461_mfc_write_auto       tmc846x_mfc_write_auto
+#define tmc8461_esc_getDLStatus      tmc846x_esc_getDLStatus
+#define tmc8461_esc_waitForDLStatus  tmc846x_esc_waitForDLStatus
+#define tmc8461_dc_getSystemTime     tmc846x_dc_getSystemTime
+#define tmc8461_dc_startSync0        tmc846x_dc_startSync0
+#define tmc8461_dc_stopSync          tmc846x_dc_stopSync
+#define tmc8461_dc_acknowledgeSync0  tmc846x_dc_acknowledgeSync0
+#define tmc8461_dc_setSync0Hook      tmc846x_dc_setSync0Hook
+#define tmc8461_dc_sync0Event        tmc846x_dc_sync0Event
+#define tmc8461_pdo_init             tmc846x_pdo_init
+#define tmc8461_pdo_map              tmc846x_pdo_map
+#define tmc8461_pdo_cycle            tmc846x_pdo_cycle
+#define tmc8461_pdo_getRxImage       tmc846x_pdo_getRxImage
+#define tmc8461_pdo_getTxImage       tmc846x_pdo_getTxImage
 
 /**
  * Initializes configurations for both, ESC and MFC block
@@ -0,0 +1,409 @@
+/*
+ * TMC846x.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "TMC846x.h"
+
+// Send the address command, the payload follows in the same transfer
+static void sendCommand(TMC846xTypeDef *tmc846x, uint8_t channel, uint16_t address, uint8_t command)
+{
+	const TMC846xTransportTypeDef *transport = tmc846x->transport;
+	uint8_t data[4] = { address >> 5, (address << 3) | TMC846x_CMD_ADDR_EXT, ((address >> 8) & 0xE0) | (command << 2), 0xFF };
+	// Reads have an additional wait state byte
+	uint8_t length = (command == TMC846x_CMD_READ_WAIT) ? 4 : 3;
+
+	if(transport->readWriteArray)
+	{
+		transport->readWriteArray(channel, data, NULL, length, false);
+		return;
+	}
+
+	for(uint8_t i = 0; i < length; i++)
+		transport->readWrite(channel, data[i], false);
+}
+
+// Read the payload of an access started by sendCommand().
+// All bytes but the last one are sent as 0x00, the last one as 0xFF to end the read.
+static void readPayload(TMC846xTypeDef *tmc846x, uint8_t channel, uint8_t *data_ptr, uint16_t len)
+{
+	const TMC846xTransportTypeDef *transport = tmc846x->transport;
+	static const uint8_t last = 0xFF;
+
+	if(transport->readWriteArray)
+	{
+		if(len > 1)
+			transport->readWriteArray(channel, NULL, data_ptr, len - 1, false);
+		transport->readWriteArray(channel, &last, &data_ptr[len - 1], 1, true);
+		return;
+	}
+
+	for(uint16_t i = 0; i < len; i++)
+		data_ptr[i] = transport->readWrite(channel, (i < len - 1) ? 0x00 : 0xFF, (i < len - 1) ? false : true);
+}
+
+static void writePayload(TMC846xTypeDef *tmc846x, uint8_t channel, const uint8_t *data_ptr, uint16_t len)
+{
+	const TMC846xTransportTypeDef *transport = tmc846x->transport;
+
+	if(transport->readWriteArray)
+	{
+		transport->readWriteArray(channel, data_ptr, NULL, len, true);
+		return;
+	}
+
+	for(uint16_t i = 0; i < len; i++)
+		transport->readWrite(channel, data_ptr[i], (i < len - 1) ? false : true);
+}
+
+static uint64_t toUint64(const uint8_t *data)
+{
+	uint64_t value = 0;
+
+	for(uint8_t i = 8; i > 0; i--)
+		value = (value << 8) | data[i - 1];
+
+	return value;
+}
+
+static void fromUint64(uint8_t *data, uint64_t value)
+{
+	for(uint8_t i = 0; i < 8; i++)
+		data[i] = BYTE(value, i);
+}
+
+void tmc846x_init(TMC846xTypeDef *tmc846x, const TMC846xTransportTypeDef *transport, ConfigurationTypeDef *config_esc, ConfigurationTypeDef *config_mfc)
+{
+	tmc846x->transport     = transport;
+	tmc846x->config_esc    = config_esc;
+	tmc846x->config_mfc    = config_mfc;
+	tmc846x->sync0Hook     = NULL;
+	tmc846x->sync0Context  = NULL;
+
+	while(tmc846x_esc_read_8(tmc846x, TMC846x_ESC_PDI_CTRL) != TMC846x_PDI_SPI_SLAVE);
+	tmc846x_esc_write_16(tmc846x, TMC846x_ESC_AL_STATUS, FIELD_SET(TMC846x_EC_STATE_INIT, TMC846x_AL_ERROR_MASK, TMC846x_AL_ERROR_SHIFT, true));
+	tmc846x_esc_write_16(tmc846x, TMC846x_ESC_AL_CODE, 0x0000);
+	tmc846x_esc_write_16(tmc846x, TMC846x_ESC_AL_EVENT_MASK_LO, 0xFF0E);
+}
+
+TMC846xVariant tmc846x_getVariant(TMC846xTypeDef *tmc846x)
+{
+	return tmc846x->transport->variant;
+}
+
+void tmc846x_esc_read(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	sendCommand(tmc846x, tmc846x->config_esc->channel, address, TMC846x_CMD_READ_WAIT);
+}
+
+void tmc846x_esc_write(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	sendCommand(tmc846x, tmc846x->config_esc->channel, address, TMC846x_CMD_WRITE);
+}
+
+void tmc846x_mfc_read(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	sendCommand(tmc846x, tmc846x->config_mfc->channel, address, TMC846x_CMD_READ_WAIT);
+}
+
+void tmc846x_mfc_write(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	sendCommand(tmc846x, tmc846x->config_mfc->channel, address, TMC846x_CMD_WRITE);
+}
+
+void tmc846x_esc_read_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len)
+{
+	if(len == 0)
+		return;
+
+	tmc846x_esc_read(tmc846x, address);
+	readPayload(tmc846x, tmc846x->config_esc->channel, data_ptr, len);
+}
+
+uint8_t tmc846x_esc_read_8(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	uint8_t buffer = 0;
+
+	tmc846x_esc_read_data(tmc846x, &buffer, address, 1);
+
+	return buffer;
+}
+
+uint16_t tmc846x_esc_read_16(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	uint8_t data[2];
+
+	tmc846x_esc_read_data(tmc846x, data, address, 2);
+
+	return _8_16(data[1], data[0]);
+}
+
+uint32_t tmc846x_esc_read_32(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	uint8_t data[4];
+
+	tmc846x_esc_read_data(tmc846x, data, address, 4);
+
+	return _8_32(data[3], data[2], data[1], data[0]);
+}
+
+uint64_t tmc846x_esc_read_64(TMC846xTypeDef *tmc846x, uint16_t address)
+{
+	uint8_t data[8];
+
+	tmc846x_esc_read_data(tmc846x, data, address, 8);
+
+	return toUint64(data);
+}
+
+void tmc846x_esc_write_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len)
+{
+	if(len == 0)
+		return;
+
+	tmc846x_esc_write(tmc846x, address);
+	writePayload(tmc846x, tmc846x->config_esc->channel, data_ptr, len);
+}
+
+void tmc846x_esc_write_8(TMC846xTypeDef *tmc846x, uint16_t address, uint8_t value)
+{
+	tmc846x_esc_write_data(tmc846x, &value, address, 1);
+}
+
+void tmc846x_esc_write_16(TMC846xTypeDef *tmc846x, uint16_t address, uint16_t value)
+{
+	uint8_t data[2];
+
+	data[0] = BYTE(value, 0);
+	data[1] = BYTE(value, 1);
+	tmc846x_esc_write_data(tmc846x, data, address, 2);
+}
+
+void tmc846x_esc_write_32(TMC846xTypeDef *tmc846x, uint16_t address, uint32_t value)
+{
+	uint8_t data[4];
+
+	data[0] = BYTE(value, 0);
+	data[1] = BYTE(value, 1);
+	data[2] = BYTE(value, 2);
+	data[3] = BYTE(value, 3);
+	tmc846x_esc_write_data(tmc846x, data, address, 4);
+}
+
+void tmc846x_esc_write_64(TMC846xTypeDef *tmc846x, uint16_t address, uint64_t value)
+{
+	uint8_t data[8];
+
+	fromUint64(data, value);
+	tmc846x_esc_write_data(tmc846x, data, address, 8);
+}
+
+void tmc846x_mfc_read_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len)
+{
+	if(len == 0)
+		return;
+
+	tmc846x_mfc_read(tmc846x, address);
+	readPayload(tmc846x, tmc846x->config_mfc->channel, data_ptr, len);
+}
+
+void tmc846x_mfc_read_32(TMC846xTypeDef *tmc846x, uint16_t address, uint32_t *value)
+{
+	uint8_t data[4];
+
+	tmc846x_mfc_read_data(tmc846x, data, address, 4);
+
+	*value = _8_32(data[3], data[2], data[1], data[0]);
+}
+
+void tmc846x_mfc_read_64(TMC846xTypeDef *tmc846x, uint16_t address, uint64_t *value)
+{
+	uint8_t data[8];
+
+	// One burst, so both halves belong to the same register state
+	tmc846x_mfc_read_data(tmc846x, data, address, 8);
+
+	*value = toUint64(data);
+}
+
+static uint8_t mfcRegisterLength(uint16_t address)
+{
+	if(address == TMC846x_MFC_SPI_RX_DATA || address == TMC846x_MFC_SPI_TX_DATA || address == TMC846x_MFC_PWM4)
+		return 8;
+
+	return 4;
+}
+
+void tmc846x_mfc_read_auto(TMC846xTypeDef *tmc846x, uint16_t address, uint8_t *value)
+{
+	tmc846x_mfc_read_data(tmc846x, value, address, mfcRegisterLength(address));
+}
+
+void tmc846x_mfc_write_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len)
+{
+	if(len == 0)
+		return;
+
+	tmc846x_mfc_write(tmc846x, address);
+	writePayload(tmc846x, tmc846x->config_mfc->channel, data_ptr, len);
+}
+
+void tmc846x_mfc_write_32(TMC846xTypeDef *tmc846x, uint16_t address, uint32_t value)
+{
+	uint8_t data[4];
+
+	data[0] = BYTE(value, 0);
+	data[1] = BYTE(value, 1);
+	data[2] = BYTE(value, 2);
+	data[3] = BYTE(value, 3);
+
+	tmc846x_mfc_write_data(tmc846x, data, address, 4);
+}
+
+void tmc846x_mfc_write_64(TMC846xTypeDef *tmc846x, uint16_t address, uint64_t value)
+{
+	uint8_t data[8];
+
+	fromUint64(data, value);
+	tmc846x_mfc_write_data(tmc846x, data, address, 8);
+}
+
+void tmc846x_mfc_write_auto(TMC846xTypeDef *tmc846x, uint16_t address, uint8_t *value)
+{
+	tmc846x_mfc_write_data(tmc846x, value, address, mfcRegisterLength(address));
+}
+
+uint16_t tmc846x_esc_getDLStatus(TMC846xTypeDef *tmc846x)
+{
+	return tmc846x_esc_read_16(tmc846x, TMC846x_ESC_DL_STATUS);
+}
+
+bool tmc846x_esc_waitForDLStatus(TMC846xTypeDef *tmc846x, uint16_t mask, uint32_t timeout)
+{
+	for(uint32_t i = 0; i < timeout; i++)
+	{
+		if((tmc846x_esc_getDLStatus(tmc846x) & mask) == mask)
+			return true;
+	}
+
+	return false;
+}
+
+uint64_t tmc846x_dc_getSystemTime(TMC846xTypeDef *tmc846x)
+{
+	// The ESC latches the upper bytes when reading the first byte, a single burst reads a consistent time
+	return tmc846x_esc_read_64(tmc846x, TMC846x_ESC_DC_SYSTEM_TIME);
+}
+
+void tmc846x_dc_startSync0(TMC846xTypeDef *tmc846x, uint32_t cycleTime, uint32_t startDelay)
+{
+	tmc846x_dc_stopSync(tmc846x);
+
+	tmc846x_esc_write_8(tmc846x, TMC846x_ESC_DC_CYCLIC_UNIT_CTRL, TMC846x_DC_CYCLIC_UNIT_PDI);
+	tmc846x_esc_write_32(tmc846x, TMC846x_ESC_DC_SYNC0_CYCLE_TIME, cycleTime);
+	tmc846x_esc_write_64(tmc846x, TMC846x_ESC_DC_START_TIME, tmc846x_dc_getSystemTime(tmc846x) + startDelay);
+	tmc846x_esc_write_8(tmc846x, TMC846x_ESC_DC_ACTIVATION, TMC846x_DC_ACTIVATE_CYCLIC | TMC846x_DC_ACTIVATE_SYNC0);
+}
+
+void tmc846x_dc_stopSync(TMC846xTypeDef *tmc846x)
+{
+	tmc846x_esc_write_8(tmc846x, TMC846x_ESC_DC_ACTIVATION, 0);
+}
+
+bool tmc846x_dc_acknowledgeSync0(TMC846xTypeDef *tmc846x)
+{
+	return tmc846x_esc_read_8(tmc846x, TMC846x_ESC_DC_SYNC0_STATUS) & 0x01;
+}
+
+void tmc846x_dc_setSync0Hook(TMC846xTypeDef *tmc846x, tmc846x_syncHook hook, void *context)
+{
+	// Disable the hook while changing the context
+	tmc846x->sync0Hook     = NULL;
+	tmc846x->sync0Context  = context;
+	tmc846x->sync0Hook     = hook;
+}
+
+void tmc846x_dc_sync0Event(TMC846xTypeDef *tmc846x)
+{
+	tmc846x_syncHook hook = tmc846x->sync0Hook;
+
+	if(hook)
+		hook(tmc846x->sync0Context);
+}
+
+static void initImage(TMC846xPdoImageTypeDef *image, uint8_t *buffer0, uint8_t *buffer1, uint16_t size)
+{
+	image->buffer[0]   = buffer0;
+	image->buffer[1]   = buffer1;
+	image->size        = size;
+	image->length      = 0;
+	image->burstCount  = 0;
+	image->active      = 0;
+}
+
+void tmc846x_pdo_init(TMC846xPdoMapTypeDef *map, TMC846xTypeDef *tmc846x, uint8_t *rxBuffer0, uint8_t *rxBuffer1, uint16_t rxSize, uint8_t *txBuffer0, uint8_t *txBuffer1, uint16_t txSize)
+{
+	map->tmc846x = tmc846x;
+	initImage(&map->rx, rxBuffer0, rxBuffer1, rxSize);
+	initImage(&map->tx, txBuffer0, txBuffer1, txSize);
+}
+
+int32_t tmc846x_pdo_map(TMC846xPdoMapTypeDef *map, TMC846xPdoDirection direction, uint16_t address, uint16_t length)
+{
+	TMC846xPdoImageTypeDef *image = (direction == TMC846x_PDO_RX) ? &map->rx : &map->tx;
+	TMC846xPdoBurstTypeDef *burst = &image->bursts[(image->burstCount > 0) ? image->burstCount - 1 : 0];
+	uint16_t offset = image->length;
+
+	if((length == 0) || ((uint32_t) image->length + length > image->size))
+		return -1;
+
+	// Ranges are appended to the image, so a range following the last burst in
+	// ESC RAM is contiguous in the image as well
+	if((image->burstCount == 0) || ((uint32_t) burst->address + burst->length != address))
+	{
+		if(image->burstCount >= TMC846x_PDO_BURSTS)
+			return -1;
+
+		burst = &image->bursts[image->burstCount++];
+		burst->address  = address;
+		burst->offset   = offset;
+		burst->length   = 0;
+	}
+
+	burst->length += length;
+	image->length += length;
+
+	return offset;
+}
+
+void tmc846x_pdo_cycle(TMC846xPdoMapTypeDef *map)
+{
+	TMC846xPdoImageTypeDef *image;
+	uint8_t *buffer;
+	uint8_t i;
+
+	// The bursts transfer directly from and into the image buffers
+	image = &map->rx;
+	buffer = image->buffer[image->active ^ 1];
+	for(i = 0; i < image->burstCount; i++)
+		tmc846x_esc_read_data(map->tmc846x, &buffer[image->bursts[i].offset], image->bursts[i].address, image->bursts[i].length);
+	image->active ^= 1;
+
+	image = &map->tx;
+	image->active ^= 1;
+	buffer = image->buffer[image->active ^ 1];
+	for(i = 0; i < image->burstCount; i++)
+		tmc846x_esc_write_data(map->tmc846x, &buffer[image->bursts[i].offset], image->bursts[i].address, image->bursts[i].length);
+}
+
+uint8_t *tmc846x_pdo_getRxImage(TMC846xPdoMapTypeDef *map)
+{
+	return map->rx.buffer[map->rx.active];
+}
+
+uint8_t *tmc846x_pdo_getTxImage(TMC846xPdoMapTypeDef *map)
+{
+	return map->tx.buffer[map->tx.active];
+}
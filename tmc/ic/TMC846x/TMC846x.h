@@ -0,0 +1,237 @@
+/*
+ * TMC846x.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ *
+ *  Shared driver core of the TMC8461 and TMC8462 EtherCAT slave controllers.
+ *  Both variants use the same SPI protocol, ESC register set and MFC block,
+ *  so all accesses go through this core. The IC files describe their SPI
+ *  wrapper with a constant TMC846xTransportTypeDef and map their public
+ *  functions onto the core.
+ */
+
+#ifndef TMC_IC_TMC846X_H_
+#define TMC_IC_TMC846X_H_
+
+#include <stddef.h>
+#include "tmc/helpers/API_Header.h"
+
+// SPI commands
+#define TMC846x_CMD_READ       0x02
+#define TMC846x_CMD_READ_WAIT  0x03
+#define TMC846x_CMD_WRITE      0x04
+#define TMC846x_CMD_ADDR_EXT   0x06
+
+// ESC registers used by the core, identical on all variants
+#define TMC846x_ESC_DL_STATUS             0x0110
+#define TMC846x_ESC_AL_STATUS             0x0130
+#define TMC846x_ESC_AL_CODE               0x0134
+#define TMC846x_ESC_PDI_CTRL              0x0140
+#define TMC846x_ESC_AL_EVENT_MASK_LO      0x0204
+#define TMC846x_ESC_DC_SYSTEM_TIME        0x0910
+#define TMC846x_ESC_DC_CYCLIC_UNIT_CTRL   0x0980
+#define TMC846x_ESC_DC_ACTIVATION         0x0981
+#define TMC846x_ESC_DC_SYNC0_STATUS       0x098E
+#define TMC846x_ESC_DC_START_TIME         0x0990
+#define TMC846x_ESC_DC_SYNC0_CYCLE_TIME   0x09A0
+
+// MFC registers with 64 bit width
+#define TMC846x_MFC_SPI_RX_DATA  0x0060
+#define TMC846x_MFC_SPI_TX_DATA  0x0070
+#define TMC846x_MFC_PWM4         0x0280
+
+#define TMC846x_PDI_SPI_SLAVE     0x05
+#define TMC846x_EC_STATE_INIT     1
+#define TMC846x_AL_ERROR_MASK     0x10
+#define TMC846x_AL_ERROR_SHIFT    4
+
+// DL status bits
+#define TMC846x_DL_STATUS_PDI_OPERATIONAL      0x0001
+#define TMC846x_DL_STATUS_PDI_WATCHDOG         0x0002
+#define TMC846x_DL_STATUS_LINK(port)           (0x0010 << (port))
+#define TMC846x_DL_STATUS_COMMUNICATION(port)  (0x0200 << (2 * (port)))
+
+// DC cyclic unit control: SYNC/LATCH units assigned to the PDI instead of EtherCAT
+#define TMC846x_DC_CYCLIC_UNIT_PDI  0x01
+
+// DC activation bits
+#define TMC846x_DC_ACTIVATE_CYCLIC  0x01
+#define TMC846x_DC_ACTIVATE_SYNC0   0x02
+#define TMC846x_DC_ACTIVATE_SYNC1   0x04
+
+typedef enum {
+	TMC846x_VARIANT_8461,
+	TMC846x_VARIANT_8462
+} TMC846xVariant;
+
+// SPI wrapper of the IC.
+// readWriteArray sends [length] bytes from [tx] (0x00 bytes if NULL) and stores the received
+// bytes in [rx] (discarded if NULL). Chip select stays active afterwards unless [lastTransfer] is set.
+typedef uint8_t (*tmc846x_readWrite)(uint8_t channel, uint8_t data, uint8_t lastTransfer);
+typedef void (*tmc846x_readWriteArray)(uint8_t channel, const uint8_t *tx, uint8_t *rx, size_t length, uint8_t lastTransfer);
+
+typedef struct {
+	TMC846xVariant variant;
+	tmc846x_readWrite readWrite;           // Byte wise transport, used if readWriteArray is NULL
+	tmc846x_readWriteArray readWriteArray;
+} TMC846xTransportTypeDef;
+
+// Called on SYNC0 events, see tmc846x_dc_sync0Event()
+typedef void (*tmc846x_syncHook)(void *context);
+
+typedef struct {
+	const TMC846xTransportTypeDef *transport;
+	ConfigurationTypeDef *config_esc;
+	ConfigurationTypeDef *config_mfc;
+	tmc846x_syncHook sync0Hook;
+	void *sync0Context;
+} TMC846xTypeDef;
+
+// Process data image mapping
+// Maps ESC RAM ranges (e.g. the SyncManager buffers of the RxPDOs and TxPDOs) into a process
+// data image in application memory. Each mapped range gets an offset in the image, where the
+// application finds its variables (target position, actual position, status word, ...).
+// Ranges directly following the previous range of the same direction are merged into one
+// burst, so mapping them in ascending address order results in the fewest SPI transfers.
+#define TMC846x_PDO_BURSTS 8
+
+typedef enum {
+	TMC846x_PDO_RX, // Outputs of the master, read from the ESC RAM
+	TMC846x_PDO_TX  // Inputs of the master, written to the ESC RAM
+} TMC846xPdoDirection;
+
+typedef struct {
+	uint16_t address; // ESC RAM address
+	uint16_t offset;  // Offset in the image
+	uint16_t length;
+} TMC846xPdoBurstTypeDef;
+
+typedef struct {
+	uint8_t *buffer[2];
+	uint16_t size;   // Size of each buffer
+	uint16_t length; // Mapped bytes
+	TMC846xPdoBurstTypeDef bursts[TMC846x_PDO_BURSTS];
+	uint8_t burstCount;
+	volatile uint8_t active; // Buffer currently owned by the application
+} TMC846xPdoImageTypeDef;
+
+typedef struct {
+	TMC846xTypeDef *tmc846x;
+	TMC846xPdoImageTypeDef rx;
+	TMC846xPdoImageTypeDef tx;
+} TMC846xPdoMapTypeDef;
+
+/**
+ * Initializes the configurations for the ESC and MFC block and waits for the ESC
+ * to finish loading its configuration (PDI in SPI slave mode).
+ * @param tmc846x Your TMC846x instance
+ * @param transport The SPI wrapper and variant of the IC
+ * @param config_esc The configuration for the ESC
+ * @param config_mfc The configuration for the MFC block
+ */
+void tmc846x_init(TMC846xTypeDef *tmc846x, const TMC846xTransportTypeDef *transport, ConfigurationTypeDef *config_esc, ConfigurationTypeDef *config_mfc);
+TMC846xVariant tmc846x_getVariant(TMC846xTypeDef *tmc846x);
+
+// Preparation functions to prepare r/w access on specific registers
+void tmc846x_esc_read(TMC846xTypeDef *tmc846x, uint16_t address);
+void tmc846x_esc_write(TMC846xTypeDef *tmc846x, uint16_t address);
+void tmc846x_mfc_read(TMC846xTypeDef *tmc846x, uint16_t address);
+void tmc846x_mfc_write(TMC846xTypeDef *tmc846x, uint16_t address);
+
+void tmc846x_esc_read_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len);
+uint8_t tmc846x_esc_read_8(TMC846xTypeDef *tmc846x, uint16_t address);
+uint16_t tmc846x_esc_read_16(TMC846xTypeDef *tmc846x, uint16_t address);
+uint32_t tmc846x_esc_read_32(TMC846xTypeDef *tmc846x, uint16_t address);
+uint64_t tmc846x_esc_read_64(TMC846xTypeDef *tmc846x, uint16_t address);
+void tmc846x_esc_write_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len);
+void tmc846x_esc_write_8(TMC846xTypeDef *tmc846x, uint16_t address, uint8_t value);
+void tmc846x_esc_write_16(TMC846xTypeDef *tmc846x, uint16_t address, uint16_t value);
+void tmc846x_esc_write_32(TMC846xTypeDef *tmc846x, uint16_t address, uint32_t value);
+void tmc846x_esc_write_64(TMC846xTypeDef *tmc846x, uint16_t address, uint64_t value);
+
+void tmc846x_mfc_read_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len);
+void tmc846x_mfc_read_32(TMC846xTypeDef *tmc846x, uint16_t address, uint32_t *value);
+void tmc846x_mfc_read_64(TMC846xTypeDef *tmc846x, uint16_t address, uint64_t *value);
+void tmc846x_mfc_read_auto(TMC846xTypeDef *tmc846x, uint16_t address, uint8_t *value);
+void tmc846x_mfc_write_data(TMC846xTypeDef *tmc846x, uint8_t *data_ptr, uint16_t address, uint16_t len);
+void tmc846x_mfc_write_32(TMC846xTypeDef *tmc846x, uint16_t address, uint32_t value);
+void tmc846x_mfc_write_64(TMC846xTypeDef *tmc846x, uint16_t address, uint64_t value);
+void tmc846x_mfc_write_auto(TMC846xTypeDef *tmc846x, uint16_t address, uint8_t *value);
+
+// DL status
+uint16_t tmc846x_esc_getDLStatus(TMC846xTypeDef *tmc846x);
+
+/**
+ * Polls the DL status until all bits of [mask] are set, e.g.
+ * TMC846x_DL_STATUS_PDI_OPERATIONAL | TMC846x_DL_STATUS_COMMUNICATION(0).
+ * @return true if the bits were set within [timeout] reads
+ */
+bool tmc846x_esc_waitForDLStatus(TMC846xTypeDef *tmc846x, uint16_t mask, uint32_t timeout);
+
+// Distributed clock
+uint64_t tmc846x_dc_getSystemTime(TMC846xTypeDef *tmc846x);
+
+/**
+ * Takes the SYNC unit from the master and starts cyclic SYNC0 events.
+ * Only use this if the master does not configure the distributed clock itself.
+ * @param cycleTime SYNC0 cycle time in ns
+ * @param startDelay Time from now until the first SYNC0 event in ns
+ */
+void tmc846x_dc_startSync0(TMC846xTypeDef *tmc846x, uint32_t cycleTime, uint32_t startDelay);
+void tmc846x_dc_stopSync(TMC846xTypeDef *tmc846x);
+
+/**
+ * Reads the SYNC0 status, which acknowledges the SYNC0 event in acknowledge mode.
+ * Call this from the SYNC0 interrupt.
+ * @return true if a SYNC0 event occurred
+ */
+bool tmc846x_dc_acknowledgeSync0(TMC846xTypeDef *tmc846x);
+
+/**
+ * Registers a function run on every SYNC0 event, e.g. firing prepared drive register
+ * writes with tmc5160_syncBatchFire() so all axes apply their setpoints at the DC time.
+ * @param hook The function to run, NULL to disable
+ * @param context Passed to the hook
+ */
+void tmc846x_dc_setSync0Hook(TMC846xTypeDef *tmc846x, tmc846x_syncHook hook, void *context);
+
+/**
+ * Runs the SYNC0 hook. Call this directly from the interrupt of the SYNC0 pin.
+ * No ESC access is done here, so this does not collide with ESC accesses of the main loop.
+ * Configure SYNC0 without acknowledge mode or acknowledge with tmc846x_dc_acknowledgeSync0()
+ * outside of the interrupt.
+ */
+void tmc846x_dc_sync0Event(TMC846xTypeDef *tmc846x);
+
+/**
+ * Initializes an empty process data mapping. The images are double buffered: The application
+ * works on one buffer while tmc846x_pdo_cycle() transfers the other one.
+ * @param map The mapping
+ * @param tmc846x Your TMC846x instance
+ * @param rxBuffer0, rxBuffer1 The two buffers of the RxPDO image, rxSize bytes each
+ * @param txBuffer0, txBuffer1 The two buffers of the TxPDO image, txSize bytes each
+ */
+void tmc846x_pdo_init(TMC846xPdoMapTypeDef *map, TMC846xTypeDef *tmc846x, uint8_t *rxBuffer0, uint8_t *rxBuffer1, uint16_t rxSize, uint8_t *txBuffer0, uint8_t *txBuffer1, uint16_t txSize);
+
+/**
+ * Maps [length] bytes of ESC RAM at [address] into the image of the given direction.
+ * @return The offset of the range in the image, -1 if the image or the burst list is full
+ */
+int32_t tmc846x_pdo_map(TMC846xPdoMapTypeDef *map, TMC846xPdoDirection direction, uint16_t address, uint16_t length);
+
+/**
+ * Transfers one cycle: Reads all RxPDO bursts into the RxPDO buffer not used by the
+ * application and hands it over, then takes the TxPDO buffer the application filled
+ * since the last cycle and writes all TxPDO bursts from it.
+ * The application gets the other TxPDO buffer afterwards, which still holds the data of two
+ * cycles ago, so all TxPDO variables should be written every cycle.
+ * The consumer (e.g. the motion ISR) must be done with the previous buffers before the next call.
+ */
+void tmc846x_pdo_cycle(TMC846xPdoMapTypeDef *map);
+
+// Current image buffers of the application
+uint8_t *tmc846x_pdo_getRxImage(TMC846xPdoMapTypeDef *map);
+uint8_t *tmc846x_pdo_getTxImage(TMC846xPdoMapTypeDef *map);
+
+#endif /* TMC_IC_TMC846X_H_ */
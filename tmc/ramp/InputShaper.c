@@ -0,0 +1,193 @@
+/*
+ * InputShaper.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "InputShaper.h"
+#include "tmc/helpers/Functions.h"
+
+#define Q16_ONE  ((uint32_t)1 << 16)
+#define Q30_ONE  ((uint64_t)1 << 30)
+
+// pi in Q16
+#define Q16_PI   205887
+
+// Residual vibration the EI shaper is tuned for, Q16 (5%)
+#define EI_TOLERANCE  3277
+
+// e^-x for a Q16 [x], Q16 result.
+// Evaluates the Taylor series for x / 256, then squares the result 8 times.
+static uint32_t expNeg(uint32_t x)
+{
+	uint64_t t, t2, t3, t4, e;
+
+	// e^-16 is below the resolution
+	if(x >= (16 * Q16_ONE))
+		return 0;
+
+	t   = (uint64_t) x << 6; // Q30 of x / 256
+	t2  = (t * t) >> 30;
+	t3  = (t2 * t) >> 30;
+	t4  = (t3 * t) >> 30;
+	e   = Q30_ONE - t + (t2 / 2) - (t3 / 6) + (t4 / 24);
+
+	for(uint8_t i = 0; i < 8; i++)
+		e = (e * e) >> 30;
+
+	return (uint32_t) ((e + (1 << 13)) >> 14);
+}
+
+bool tmc_ramp_shaper_init(TMC_InputShaper *shaper, TMC_InputShaper_Type type, uint32_t frequency, uint32_t damping, uint32_t rampFrequency)
+{
+	uint32_t weight[TMC_RAMP_SHAPER_IMPULSES] = { 0 };
+	uint32_t sqrtOneMinusDamping2;
+	uint64_t halfPeriod;
+	uint32_t k;
+	uint64_t sum = 0;
+	uint32_t used = 0;
+
+	shaper->type         = TMC_RAMP_SHAPER_NONE;
+	shaper->impulses     = 1;
+	shaper->amplitude[0] = Q16_ONE;
+	shaper->delay[0]     = 0;
+	tmc_ramp_shaper_reset(shaper, 0);
+
+	if(type == TMC_RAMP_SHAPER_NONE)
+		return true;
+
+	if((frequency == 0) || (damping >= Q16_ONE))
+		return false;
+
+	// Damped resonance: fd = f * sqrt(1 - d^2), K = e^(-pi * d / sqrt(1 - d^2))
+	sqrtOneMinusDamping2 = tmc_sqrti64((uint64_t) Q16_ONE * Q16_ONE - (uint64_t) damping * damping);
+	if(sqrtOneMinusDamping2 == 0)
+		return false;
+
+	k = expNeg((uint32_t) MIN(((uint64_t) Q16_PI * damping) / sqrtOneMinusDamping2, 16 * Q16_ONE));
+
+	// Half of the damped period in ticks, rounded: rampFrequency / (2 * fd)
+	halfPeriod = ((uint64_t) rampFrequency * 1000 * Q16_ONE + (uint64_t) frequency * sqrtOneMinusDamping2) / ((uint64_t) 2 * frequency * sqrtOneMinusDamping2);
+
+	switch(type)
+	{
+	case TMC_RAMP_SHAPER_ZV:
+		shaper->impulses = 2;
+		weight[0] = Q16_ONE;
+		weight[1] = k;
+		break;
+	case TMC_RAMP_SHAPER_ZVD:
+		shaper->impulses = 3;
+		weight[0] = Q16_ONE;
+		weight[1] = 2 * k;
+		weight[2] = ((uint64_t) k * k) >> 16;
+		break;
+	case TMC_RAMP_SHAPER_EI:
+		shaper->impulses = 3;
+		weight[0] = (Q16_ONE + EI_TOLERANCE) / 4;
+		weight[1] = ((uint64_t) ((Q16_ONE - EI_TOLERANCE) / 2) * k) >> 16;
+		weight[2] = ((((uint64_t) weight[0] * k) >> 16) * k) >> 16;
+		break;
+	default:
+		shaper->impulses = 1;
+		return false;
+	}
+
+	if((halfPeriod * (shaper->impulses - 1)) >= TMC_RAMP_SHAPER_DELAY_SIZE)
+	{
+		shaper->impulses = 1;
+		return false;
+	}
+
+	// Normalise to a sum of exactly 1.0
+	for(uint8_t i = 0; i < shaper->impulses; i++)
+		sum += weight[i];
+
+	for(uint8_t i = 0; i < shaper->impulses; i++)
+	{
+		shaper->delay[i] = (uint16_t) (halfPeriod * i);
+		shaper->amplitude[i] = (i + 1 < shaper->impulses)
+			? (uint32_t) ((((uint64_t) weight[i] << 16) + (sum / 2)) / sum)
+			: Q16_ONE - used;
+		used += shaper->amplitude[i];
+	}
+
+	shaper->type = type;
+
+	return true;
+}
+
+void tmc_ramp_shaper_reset(TMC_InputShaper *shaper, int32_t position)
+{
+	for(uint16_t i = 0; i < TMC_RAMP_SHAPER_DELAY_SIZE; i++)
+		shaper->history[i] = position;
+
+	shaper->index   = 0;
+	shaper->input   = position;
+	shaper->output  = position;
+}
+
+int32_t tmc_ramp_shaper_shape(TMC_InputShaper *shaper, int32_t position)
+{
+	int64_t sum = 0;
+
+	shaper->index = (shaper->index + 1) & (TMC_RAMP_SHAPER_DELAY_SIZE - 1);
+	shaper->history[shaper->index] = position;
+
+	if(shaper->type == TMC_RAMP_SHAPER_NONE)
+		return position;
+
+	// Relative to the latest position, keeps the products small
+	for(uint8_t i = 1; i < shaper->impulses; i++)
+	{
+		int32_t delayed = shaper->history[(shaper->index - shaper->delay[i]) & (TMC_RAMP_SHAPER_DELAY_SIZE - 1)];
+		sum = tmc_math_mlal(sum, shaper->amplitude[i], delayed - position);
+	}
+
+	// Round half away from zero
+	sum += (sum < 0) ? -(1 << 15) : (1 << 15);
+
+	return position + (int32_t) (sum / (1 << 16));
+}
+
+int32_t tmc_ramp_shaper_compute(TMC_InputShaper *shaper, TMC_LinearRamp *linearRamp)
+{
+	int32_t output;
+	int32_t dx;
+
+	shaper->input += tmc_ramp_linear_compute(linearRamp);
+	output = tmc_ramp_shaper_shape(shaper, shaper->input);
+
+	dx = output - shaper->output;
+	shaper->output = output;
+
+	return dx;
+}
+
+uint16_t tmc_ramp_shaper_get_delay(TMC_InputShaper *shaper)
+{
+	return shaper->delay[shaper->impulses - 1];
+}
+
+uint32_t tmc_ramp_shaper_get_maxAcceleration(TMC_InputShaper *shaper, uint32_t maxDeviation, uint32_t rampFrequency)
+{
+	uint64_t mean = 0;     // Q16 ticks
+	uint64_t square = 0;   // Q16 ticks^2
+	uint64_t variance;     // Q16 ticks^2
+	uint64_t acceleration;
+
+	for(uint8_t i = 0; i < shaper->impulses; i++)
+	{
+		mean    += (uint64_t) shaper->amplitude[i] * shaper->delay[i];
+		square  += (uint64_t) shaper->amplitude[i] * shaper->delay[i] * shaper->delay[i];
+	}
+
+	variance = square - ((mean * mean) >> 16);
+	if((shaper->type == TMC_RAMP_SHAPER_NONE) || (variance == 0))
+		return UINT32_MAX;
+
+	// a = 2 * deviation / Var(t), converted from steps/tick^2 to steps/s^2
+	acceleration = ((((uint64_t) maxDeviation * rampFrequency) << 17) / variance) * rampFrequency;
+
+	return (uint32_t) MIN(acceleration, UINT32_MAX);
+}
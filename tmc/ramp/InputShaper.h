@@ -0,0 +1,78 @@
+/*
+ * InputShaper.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_INPUTSHAPER_H_
+#define TMC_RAMP_INPUTSHAPER_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Input shaping stage for the software ramps.
+// The commanded position stream is convolved with a train of two or three impulses,
+// spaced by half a period of the mechanical resonance, so the vibration excited by
+// one impulse is cancelled by the next. The motion ends later by the length of the
+// impulse train (the shaper delay), but settles without residual vibration, allowing
+// higher accelerations for the same settle time.
+//
+// - ZV:  2 impulses over half a period. Shortest delay, needs an accurate frequency.
+// - ZVD: 3 impulses over one period. Tolerates about +-15% frequency error.
+// - EI:  3 impulses over one period, tuned for 5% residual vibration. Tolerates about +-20%.
+//
+// The impulse amplitudes are Q16 values adding up to exactly 1.0, so a constant input
+// position is passed through unchanged. Only integer arithmetic is used.
+
+// Length of the delay line, has to be a power of two. The shaper delay
+// (one resonance period for ZVD and EI) has to be shorter than this amount of ticks.
+#ifndef TMC_RAMP_SHAPER_DELAY_SIZE
+#define TMC_RAMP_SHAPER_DELAY_SIZE 256
+#endif
+
+#define TMC_RAMP_SHAPER_IMPULSES 3
+
+typedef enum {
+	TMC_RAMP_SHAPER_NONE,
+	TMC_RAMP_SHAPER_ZV,
+	TMC_RAMP_SHAPER_ZVD,
+	TMC_RAMP_SHAPER_EI
+} TMC_InputShaper_Type;
+
+typedef struct
+{
+	TMC_InputShaper_Type type;
+	uint8_t impulses;
+	uint32_t amplitude[TMC_RAMP_SHAPER_IMPULSES]; // Q16
+	uint16_t delay[TMC_RAMP_SHAPER_IMPULSES];     // Ticks
+	int32_t history[TMC_RAMP_SHAPER_DELAY_SIZE];  // Input positions
+	uint16_t index;                               // Slot of the latest input position
+	int32_t input;    // Unshaped position, tmc_ramp_shaper_compute() only
+	int32_t output;   // Shaped position, tmc_ramp_shaper_compute() only
+} TMC_InputShaper;
+
+// [frequency]: Resonance frequency in mHz. [damping]: Damping ratio, Q16 (e.g. 0.1 = 6554).
+// [rampFrequency]: Ramp ticks per second.
+// Returns false and passes the position through if the shaper delay does not fit the delay line.
+bool tmc_ramp_shaper_init(TMC_InputShaper *shaper, TMC_InputShaper_Type type, uint32_t frequency, uint32_t damping, uint32_t rampFrequency);
+
+// Fill the delay line with [position], e.g. after setting the ramp position. The shaper starts at rest.
+void tmc_ramp_shaper_reset(TMC_InputShaper *shaper, int32_t position);
+
+// Push the commanded position of one tick, returns the shaped position
+int32_t tmc_ramp_shaper_shape(TMC_InputShaper *shaper, int32_t position);
+
+// Compute one tick of [linearRamp] and shape it. Returns the shaped position change,
+// to be used instead of the return value of tmc_ramp_linear_compute().
+int32_t tmc_ramp_shaper_compute(TMC_InputShaper *shaper, TMC_LinearRamp *linearRamp);
+
+// Ticks from the start of the impulse train to the last impulse
+uint16_t tmc_ramp_shaper_get_delay(TMC_InputShaper *shaper);
+
+// Highest acceleration (steps/s^2) for which the shaped position deviates at most [maxDeviation]
+// steps from the commanded one: At constant acceleration a the shaper lags by a/2 * Var(t),
+// the variance of the impulse times. Returns UINT32_MAX without shaping.
+uint32_t tmc_ramp_shaper_get_maxAcceleration(TMC_InputShaper *shaper, uint32_t maxDeviation, uint32_t rampFrequency);
+
+#endif /* TMC_RAMP_INPUTSHAPER_H_ */
@@ -0,0 +1,150 @@
+/*
+ * LinearInterpolation.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "LinearInterpolation.h"
+
+void tmc_ramp_interpolation_init(TMC_LinearInterpolation *interpolation, TMC_LinearRamp **axes, uint8_t count)
+{
+	uint8_t i;
+
+	tmc_ramp_linear_init(&interpolation->path);
+	tmc_ramp_linear_set_mode(&interpolation->path, TMC_RAMP_LINEAR_MODE_POSITION);
+
+	interpolation->count         = MIN(count, TMC_RAMP_INTERPOLATION_AXES);
+	interpolation->pathPosition  = 0;
+	interpolation->length        = 0;
+
+	for(i = 0; i < TMC_RAMP_INTERPOLATION_AXES; i++)
+	{
+		interpolation->axes[i]           = (i < interpolation->count) ? axes[i] : NULL;
+		interpolation->distance[i]       = 0;
+		interpolation->direction[i]      = 0;
+		interpolation->error[i]          = 0;
+		interpolation->velocityRatio[i]  = 0;
+		interpolation->positionDelta[i]  = 0;
+	}
+}
+
+bool tmc_ramp_interpolation_move(TMC_LinearInterpolation *interpolation, const int32_t *targetPositions, uint32_t maxVelocity, int32_t acceleration)
+{
+	TMC_LinearRamp *path = &interpolation->path;
+	uint32_t length = 0;
+	uint8_t i;
+
+	if(!tmc_ramp_interpolation_is_done(interpolation))
+		return false;
+
+	// The longest distance defines the path length
+	for(i = 0; i < interpolation->count; i++)
+	{
+		int64_t distance = (int64_t) targetPositions[i] - interpolation->axes[i]->rampPosition;
+
+		if((distance > INT32_MAX) || (distance < -INT32_MAX))
+			return false;
+
+		interpolation->direction[i]  = (distance < 0) ? -1 : 1;
+		interpolation->distance[i]   = (distance < 0) ? -distance : distance;
+		length = MAX(length, interpolation->distance[i]);
+	}
+
+	for(i = 0; i < interpolation->count; i++)
+	{
+		// Start with half an error to round the axis positions to the nearest step
+		interpolation->error[i]          = length / 2;
+		interpolation->velocityRatio[i]  = (length) ? ((uint64_t) interpolation->distance[i] << 16) / length : 0;
+		interpolation->positionDelta[i]  = 0;
+		interpolation->axes[i]->targetPosition = targetPositions[i];
+	}
+
+	interpolation->length        = length;
+	interpolation->pathPosition  = 0;
+
+	// Restart the path ramp
+	path->rampPosition         = 0;
+	path->rampVelocity         = 0;
+	path->targetVelocity       = 0;
+	path->accumulatorVelocity  = 0;
+	path->accumulatorPosition  = 0;
+	path->accelerationSteps    = 0;
+	path->state                = TMC_RAMP_LINEAR_STATE_IDLE;
+	tmc_ramp_linear_set_maxVelocity(path, maxVelocity);
+	tmc_ramp_linear_set_acceleration(path, acceleration);
+	tmc_ramp_linear_set_targetPosition(path, length);
+
+	return true;
+}
+
+void tmc_ramp_interpolation_compute(TMC_LinearInterpolation *interpolation)
+{
+	TMC_LinearRamp *path = &interpolation->path;
+	uint8_t i;
+
+	for(i = 0; i < interpolation->count; i++)
+		interpolation->positionDelta[i] = 0;
+
+	if(interpolation->length == 0)
+		return;
+
+	tmc_ramp_linear_compute(path);
+
+	// Distribute the path steps to the axes
+	while(interpolation->pathPosition < path->rampPosition)
+	{
+		interpolation->pathPosition++;
+
+		for(i = 0; i < interpolation->count; i++)
+		{
+			interpolation->error[i] += interpolation->distance[i];
+			if(interpolation->error[i] >= interpolation->length)
+			{
+				interpolation->error[i] -= interpolation->length;
+				interpolation->positionDelta[i] += interpolation->direction[i];
+			}
+		}
+	}
+
+	// Overshooting path ramp: exact inverse of the forward steps
+	while(interpolation->pathPosition > path->rampPosition)
+	{
+		interpolation->pathPosition--;
+
+		for(i = 0; i < interpolation->count; i++)
+		{
+			if(interpolation->error[i] < interpolation->distance[i])
+			{
+				interpolation->error[i] += interpolation->length;
+				interpolation->positionDelta[i] -= interpolation->direction[i];
+			}
+			interpolation->error[i] -= interpolation->distance[i];
+		}
+	}
+
+	for(i = 0; i < interpolation->count; i++)
+	{
+		TMC_LinearRamp *axis = interpolation->axes[i];
+
+		axis->rampPosition += interpolation->positionDelta[i];
+		axis->rampVelocity = interpolation->direction[i] * (int32_t) (((int64_t) path->rampVelocity * interpolation->velocityRatio[i]) / 65536);
+		axis->targetVelocity = axis->rampVelocity;
+	}
+}
+
+bool tmc_ramp_interpolation_is_done(TMC_LinearInterpolation *interpolation)
+{
+	TMC_LinearRamp *path = &interpolation->path;
+
+	if(interpolation->length == 0)
+		return true;
+
+	return (path->state == TMC_RAMP_LINEAR_STATE_IDLE)
+		&& (path->rampVelocity == 0)
+		&& (path->rampPosition == path->targetPosition);
+}
+
+int32_t tmc_ramp_interpolation_get_positionDelta(TMC_LinearInterpolation *interpolation, uint8_t axis)
+{
+	return interpolation->positionDelta[axis];
+}
@@ -0,0 +1,53 @@
+/*
+ * LinearInterpolation.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_LINEARINTERPOLATION_H_
+#define TMC_RAMP_LINEARINTERPOLATION_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Coordinated linear moves of multiple axes.
+// One TMC_LinearRamp in position mode (the path ramp) plans the move of the axis with the
+// longest distance. Every step of the path ramp is distributed to the other axes with an
+// integer line algorithm, so all axes start and stop together and stay on the straight line.
+// The maximum velocity and acceleration apply to the axis with the longest distance.
+//
+// The positions and velocities are written to the rampPosition and rampVelocity of the
+// axis ramps, so the application can keep reading them like independent ramps. The axis
+// ramps are not computed themselves while they are part of an interpolated move.
+
+// Maximum amount of interpolated axes
+#define TMC_RAMP_INTERPOLATION_AXES 4
+
+typedef struct
+{
+	TMC_LinearRamp path;
+	uint8_t count;
+	TMC_LinearRamp *axes[TMC_RAMP_INTERPOLATION_AXES];
+	int32_t pathPosition;       // Path position the axis positions were computed for
+	uint32_t length;            // Path length, distance of the longest axis
+	uint32_t distance[TMC_RAMP_INTERPOLATION_AXES];
+	int8_t direction[TMC_RAMP_INTERPOLATION_AXES];
+	uint32_t error[TMC_RAMP_INTERPOLATION_AXES];
+	uint32_t velocityRatio[TMC_RAMP_INTERPOLATION_AXES]; // distance / length in 1/65536
+	int32_t positionDelta[TMC_RAMP_INTERPOLATION_AXES];  // Result of the last computation
+} TMC_LinearInterpolation;
+
+void tmc_ramp_interpolation_init(TMC_LinearInterpolation *interpolation, TMC_LinearRamp **axes, uint8_t count);
+
+// Starts a move of all axes from their current rampPosition to targetPositions[axis].
+// Returns false if the previous move did not finish yet.
+bool tmc_ramp_interpolation_move(TMC_LinearInterpolation *interpolation, const int32_t *targetPositions, uint32_t maxVelocity, int32_t acceleration);
+
+// Computes one tick of the move. The position changes of the axes are stored in positionDelta.
+void tmc_ramp_interpolation_compute(TMC_LinearInterpolation *interpolation);
+
+bool tmc_ramp_interpolation_is_done(TMC_LinearInterpolation *interpolation);
+int32_t tmc_ramp_interpolation_get_positionDelta(TMC_LinearInterpolation *interpolation, uint8_t axis);
+
+#endif /* TMC_RAMP_LINEARINTERPOLATION_H_ */
@@ -6,6 +6,7 @@
  *
  *  This is a basic proof-of-concept implementation of a linear motion ramp
  *  generator. It is designed to run with 1 calculation / ms.
+ *  Compatibility layer on top of the TMC_LinearRamp of LinearRamp1.h.
  *
  *
  */
@@ -13,14 +14,9 @@
 
 void tmc_linearRamp_init(TMC_LinearRamp *linearRamp)
 {
-	linearRamp->maxVelocity     = 0;
-	linearRamp->targetPosition  = 0;
-	linearRamp->targetVelocity  = 0;
-	linearRamp->rampVelocity    = 0;
-	linearRamp->acceleration    = 0;
+	tmc_ramp_linear_init(linearRamp);
+
 	linearRamp->encoderSteps	= u16_MAX;
-	linearRamp->lastdVRest      = 0;
-	linearRamp->lastdXRest      = 0;
 	linearRamp->rampEnabled     = false;
 }
 
@@ -38,8 +34,8 @@ void tmc_linearRamp_computeRampVelocity(TMC_LinearRamp *linearRamp)
 		if (maxDTV < (dV/1000))
 			dV = maxDTV*1000;
 
-		dV += linearRamp->lastdVRest;
-		linearRamp->lastdVRest = dV % 1000;
+		dV += linearRamp->accumulatorVelocity;
+		linearRamp->accumulatorVelocity = dV % 1000;
 
 		if (linearRamp->rampVelocity < linearRamp->targetVelocity)
 		{
@@ -76,7 +72,7 @@ void tmc_linearRamp_computeRampPosition(TMC_LinearRamp *linearRamp)
 		int64_t sqrtiValue = tmc_limitS64(((int64_t)120 * (int64_t)linearRamp->acceleration * (int64_t)(abs(targetPositionsDifference))) / (int64_t)linearRamp->encoderSteps, 0, (int64_t)linearRamp->maxVelocity*(int64_t)linearRamp->maxVelocity);
 
 		// compute max allowed ramp velocity to ramp down to target
-		int32_t maxRampStop = tmc_sqrti(sqrtiValue);
+		int32_t maxRampStop = tmc_sqrtS64(sqrtiValue);
 
 		// compute max allowed ramp velocity
 		int32_t maxRampTargetVelocity = 0;
@@ -100,8 +96,8 @@ void tmc_linearRamp_computeRampPosition(TMC_LinearRamp *linearRamp)
 		if (maxDTV < (dV / 1000))
 			dV = maxDTV * 1000;
 
-		dV += linearRamp->lastdVRest;
-		linearRamp->lastdVRest = dV % 1000;
+		dV += linearRamp->accumulatorVelocity;
+		linearRamp->accumulatorVelocity = dV % 1000;
 
 		// do velocity ramping
 		if (maxRampTargetVelocity > linearRamp->rampVelocity)
@@ -117,7 +113,7 @@ void tmc_linearRamp_computeRampPosition(TMC_LinearRamp *linearRamp)
 		//linearRamp->rampVelocity = tmc_limitInt(linearRamp->rampVelocity, -abs(maxRampTargetVelocity), abs(maxRampTargetVelocity));
 
 		// do position ramping using actual ramp velocity to update dX
-		int64_t dX = ((int64_t)linearRamp->rampVelocity * (int64_t)linearRamp->encoderSteps) / ((int64_t)60) + linearRamp->lastdXRest;
+		int64_t dX = ((int64_t)linearRamp->rampVelocity * (int64_t)linearRamp->encoderSteps) / ((int64_t)60) + linearRamp->accumulatorPosition;
 
 		// scale actual target position
 		int64_t tempActualTargetPosition = (int64_t)linearRamp->rampPosition * 1000;
@@ -132,7 +128,7 @@ void tmc_linearRamp_computeRampPosition(TMC_LinearRamp *linearRamp)
 			tempActualTargetPosition = (int64_t)linearRamp->rampPosition * 1000;
 
 			dX = 0;
-			linearRamp->lastdXRest = 0;
+			linearRamp->accumulatorPosition = 0;
 			linearRamp->rampVelocity = 0;
 		}
 		else
@@ -144,9 +140,9 @@ void tmc_linearRamp_computeRampPosition(TMC_LinearRamp *linearRamp)
 		int64_t absTempActualTargetPosition = (tempActualTargetPosition >= 0) ? tempActualTargetPosition : -tempActualTargetPosition;
 
 		if (tempActualTargetPosition >= 0)
-			linearRamp->lastdXRest = (absTempActualTargetPosition % 1000);
+			linearRamp->accumulatorPosition = (absTempActualTargetPosition % 1000);
 		else if (tempActualTargetPosition < 0)
-			linearRamp->lastdXRest = -(absTempActualTargetPosition % 1000);
+			linearRamp->accumulatorPosition = -(absTempActualTargetPosition % 1000);
 
 		// scale actual target position back
 		linearRamp->rampPosition = tempActualTargetPosition / 1000;
@@ -8,22 +8,14 @@
 #ifndef TMC_LINEAR_RAMP_H_
 #define TMC_LINEAR_RAMP_H_
 
+	// Compatibility functions for the first linear ramp generator.
+	// They use the TMC_LinearRamp of the ramp core (LinearRamp1.h), so old and new
+	// code can be used together. The former fields lastdVRest and lastdXRest are now
+	// accumulatorVelocity and accumulatorPosition, all other field names are unchanged.
+
 	#include "tmc/helpers/API_Header.h"
 	#include "tmc/helpers/Functions.h"
-
-	typedef struct
-	{
-		uint32_t maxVelocity;
-		int32_t targetPosition;
-		int32_t rampPosition;
-		int32_t targetVelocity;
-		int32_t rampVelocity;
-		int32_t acceleration;
-		uint16_t encoderSteps;
-		int32_t lastdVRest;
-		int32_t lastdXRest;
-		uint8_t rampEnabled;
-	} TMC_LinearRamp;
+	#include "LinearRamp1.h"
 
 	void tmc_linearRamp_init(TMC_LinearRamp *linearRamp);
 	void tmc_linearRamp_computeRampVelocity(TMC_LinearRamp *linearRamp);
@@ -7,6 +7,59 @@
 #include "LinearRamp1.h"
 #include "tmc/helpers/Functions.h"
 
+#ifdef TMC_RAMP_LINEAR_PRECISION_SHIFT
+	#define PRECISION_SHIFT(ramp)  TMC_RAMP_LINEAR_PRECISION_SHIFT
+#else
+	#define PRECISION_SHIFT(ramp)  ((ramp)->precisionShift)
+#endif
+
+#ifdef TMC_RAMP_LINEAR_ACCUMULATOR_64
+	typedef uint64_t UnsignedAccumulator;
+
+	// 1 << 31 fits the 64 bit signed position accumulator math
+	#define MAX_SHIFT_PRECISION ((uint32_t)1<<31)
+#else
+	typedef uint32_t UnsignedAccumulator;
+
+	// 1 << 31 does not fit the signed position accumulator math, keep dividing
+	#define MAX_SHIFT_PRECISION ((uint32_t)1<<30)
+#endif
+
+// log2(precision) for power of two precisions, TMC_RAMP_LINEAR_PRECISION_NO_SHIFT otherwise
+static uint8_t precisionShift(uint32_t precision)
+{
+	if((precision == 0) || (precision & (precision - 1)) || (precision > MAX_SHIFT_PRECISION))
+		return TMC_RAMP_LINEAR_PRECISION_NO_SHIFT;
+
+	return 31 - tmc_math_clz(precision);
+}
+
+#ifdef TMC_RAMP_LINEAR_ACCUMULATOR_64
+// Divide the accumulator by the precision, keep the remainder in the accumulator and return the quotient.
+// The accumulators only leave the 32 bit range for accelerations or velocities close to the
+// 32 bit limits. Otherwise a 32 bit division is used, a single instruction on Cortex-M3 and
+// later instead of the 64 bit division of the runtime library.
+static int32_t divideAccumulator(int64_t *accumulator, uint32_t precision)
+{
+	int32_t quotient;
+
+	if((*accumulator >= INT32_MIN) && (*accumulator <= INT32_MAX) && (precision <= INT32_MAX))
+	{
+		int32_t value = *accumulator;
+
+		quotient = value / (int32_t) precision;
+		*accumulator = value % (int32_t) precision;
+	}
+	else
+	{
+		quotient = *accumulator / (int64_t) precision;
+		*accumulator = *accumulator % (int64_t) precision;
+	}
+
+	return quotient;
+}
+#endif
+
 void tmc_ramp_linear_init(TMC_LinearRamp *linearRamp)
 {
 	linearRamp->maxVelocity         = 0;
@@ -19,10 +72,18 @@ void tmc_ramp_linear_init(TMC_LinearRamp *linearRamp)
 	linearRamp->accumulatorVelocity = 0;
 	linearRamp->accumulatorPosition = 0;
 	linearRamp->rampMode            = TMC_RAMP_LINEAR_MODE_VELOCITY;
+	linearRamp->retarget            = TMC_RAMP_LINEAR_RETARGET_STOP;
 	linearRamp->state               = TMC_RAMP_LINEAR_STATE_IDLE;
+	linearRamp->accelerationSteps   = 0;
+#ifdef TMC_RAMP_LINEAR_PRECISION_SHIFT
+	linearRamp->precision           = (uint32_t)1 << TMC_RAMP_LINEAR_PRECISION_SHIFT;
+#else
 	linearRamp->precision           = TMC_RAMP_LINEAR_DEFAULT_PRECISION;
+#endif
+	linearRamp->precisionShift      = precisionShift(linearRamp->precision);
 	linearRamp->homingDistance      = TMC_RAMP_LINEAR_DEFAULT_HOMING_DISTANCE;
 	linearRamp->stopVelocity        = TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY;
+	linearRamp->encoderSteps        = u16_MAX;
 }
 
 void tmc_ramp_linear_set_enabled(TMC_LinearRamp *linearRamp, bool enabled)
@@ -62,12 +123,33 @@ void tmc_ramp_linear_set_acceleration(TMC_LinearRamp *linearRamp, int32_t accele
 
 void tmc_ramp_linear_set_mode(TMC_LinearRamp *linearRamp, TMC_LinearRamp_Mode mode)
 {
+#ifdef TMC_RAMP_LINEAR_VELOCITY_ONLY
+	UNUSED(linearRamp);
+	UNUSED(mode);
+#else
 	linearRamp->rampMode = mode;
+#endif
+}
+
+// Position mode: With TMC_RAMP_LINEAR_RETARGET_REVERSE a target behind the ramp (or one that
+// can not be stopped at in time) reverses the ramp right away: The velocity runs through zero
+// with the acceleration and continues towards the target, the time optimal transition for a
+// ramp with a single acceleration. TMC_RAMP_LINEAR_RETARGET_STOP brakes to standstill first
+// and starts a new ramp from there, or homes with the stop velocity within the homing distance.
+void tmc_ramp_linear_set_retarget(TMC_LinearRamp *linearRamp, TMC_LinearRamp_Retarget retarget)
+{
+	linearRamp->retarget = retarget;
 }
 
 void tmc_ramp_linear_set_precision(TMC_LinearRamp * linearRamp, uint32_t precision)
 {
-	linearRamp->precision = precision;
+#ifdef TMC_RAMP_LINEAR_PRECISION_SHIFT
+	UNUSED(linearRamp);
+	UNUSED(precision);
+#else
+	linearRamp->precision       = precision;
+	linearRamp->precisionShift  = precisionShift(precision);
+#endif
 }
 
 void tmc_ramp_linear_set_homingDistance(TMC_LinearRamp *linearRamp, uint32_t homingDistance)
@@ -120,25 +202,53 @@ TMC_LinearRamp_State tmc_ramp_linear_get_state(TMC_LinearRamp *linearRamp)
 	return linearRamp->state;
 }
 
+// Ramp phase for the current profile (CurrentProfile.h)
+TMCRampPhase tmc_ramp_linear_get_phase(TMC_LinearRamp *linearRamp)
+{
+	int32_t velocity = linearRamp->rampVelocity;
+	int32_t target = linearRamp->targetVelocity;
+
+	if(velocity == target)
+		return (velocity == 0) ? TMC_RAMP_PHASE_STANDSTILL : TMC_RAMP_PHASE_CRUISE;
+
+	// Towards a higher velocity in the same direction
+	if(((velocity >= 0) == (target >= 0) || (velocity == 0)) && (abs(velocity) < abs(target)))
+		return TMC_RAMP_PHASE_ACCELERATION;
+
+	return TMC_RAMP_PHASE_DECELERATION;
+}
+
 TMC_LinearRamp_Mode tmc_ramp_linear_get_mode(TMC_LinearRamp *linearRamp)
 {
 	return linearRamp->rampMode;
 }
 
+TMC_LinearRamp_Retarget tmc_ramp_linear_get_retarget(TMC_LinearRamp *linearRamp)
+{
+	return linearRamp->retarget;
+}
+
 uint32_t tmc_ramp_linear_get_precision(TMC_LinearRamp *linearRamp)
 {
 	return linearRamp->precision;
 }
 
-// The maximum acceleration depends on the precision value
+// The maximum acceleration depends on the precision value.
+// With 64 bit accumulators only the acceleration value itself is limited.
 uint32_t tmc_ramp_linear_get_acceleration_limit(TMC_LinearRamp *linearRamp)
 {
+#ifdef TMC_RAMP_LINEAR_ACCUMULATOR_64
+	UNUSED(linearRamp);
+	return INT32_MAX;
+#else
 	return (0xFFFFFFFFu / linearRamp->precision) * linearRamp->precision;
+#endif
 }
 
+// At most one step per tick, and the velocity has to fit the ramp velocity
 uint32_t tmc_ramp_linear_get_velocity_limit(TMC_LinearRamp *linearRamp)
 {
-	return linearRamp->precision;
+	return MIN(linearRamp->precision, (uint32_t) INT32_MAX);
 }
 
 uint32_t tmc_ramp_linear_get_homingDistance(TMC_LinearRamp *linearRamp)
@@ -157,6 +267,284 @@ int32_t tmc_ramp_linear_compute(TMC_LinearRamp *linearRamp)
 	return tmc_ramp_linear_compute_velocity(linearRamp);
 }
 
+// Multi-tick advance
+// Within a ramp phase (accelerating, constant velocity or decelerating towards the
+// target velocity) the accumulators can be integrated in closed form. The segment
+// math works on the non-negative values in the direction of motion.
+
+// Maximum amount of ticks integrated at once, keeps the 64 bit sums from overflowing
+#define SEGMENT_MAX_TICKS ((uint32_t)1<<20)
+
+typedef struct
+{
+	uint64_t precision;
+	uint64_t acceleration;
+	uint64_t accumulatorVelocity;
+	uint64_t accumulatorPosition;
+	uint64_t velocity;
+	bool decelerating;
+} RampSegment;
+
+// Sum of floor((a * i + b) / m) for i = 0 .. n-1
+static uint64_t floorSum(uint64_t n, uint64_t m, uint64_t a, uint64_t b)
+{
+	uint64_t sum = 0;
+	uint64_t yMax, tmp;
+
+	while(n > 0)
+	{
+		if(a >= m)
+		{
+			sum += (n * (n - 1) / 2) * (a / m);
+			a %= m;
+		}
+		if(b >= m)
+		{
+			sum += n * (b / m);
+			b %= m;
+		}
+
+		yMax = a * n + b;
+		if(yMax < m)
+			break;
+
+		n   = yMax / m;
+		b   = yMax % m;
+		tmp = m;
+		m   = a;
+		a   = tmp;
+	}
+
+	return sum;
+}
+
+// Velocity change after [ticks] ticks of the segment
+static uint64_t segmentVelocityDelta(const RampSegment *segment, uint64_t ticks)
+{
+	return (segment->accumulatorVelocity + ticks * segment->acceleration) / segment->precision;
+}
+
+// Position accumulator after [ticks] ticks of the segment, before removing the taken steps
+static uint64_t segmentPosition(const RampSegment *segment, uint64_t ticks)
+{
+	// Sum of the velocity changes of every tick in the segment
+	uint64_t dvSum = floorSum(ticks, segment->precision, segment->acceleration, segment->accumulatorVelocity + segment->acceleration);
+	uint64_t x = segment->accumulatorPosition + ticks * segment->velocity;
+
+	return (segment->decelerating) ? x - dvSum : x + dvSum;
+}
+
+// Steps taken within the first [ticks] ticks of the segment.
+// The velocity never exceeds the precision, so every tick moves by at most one step.
+static uint64_t segmentMoves(const RampSegment *segment, uint64_t ticks)
+{
+	return segmentPosition(segment, ticks) / segment->precision;
+}
+
+// accelerationSteps after [moves] ticks with a position change, each changing it by [direction]
+static int32_t countSteps(int32_t steps, int32_t direction, uint64_t moves)
+{
+	if(direction > 0)
+		return steps + moves;
+
+	if(direction < 0)
+		return (moves >= (uint64_t) steps) ? 0 : steps - moves;
+
+	return steps;
+}
+
+// Advance the ramp by up to [ticks] ticks without any phase or state changes.
+// Returns the amount of ticks computed, 0 if the next tick has to be computed on its own.
+static uint32_t advanceSegment(TMC_LinearRamp *linearRamp, uint32_t ticks, int32_t *dxSum)
+{
+	RampSegment segment;
+	int32_t precision = linearRamp->precision;
+	int32_t direction;      // Direction of motion
+	int32_t stepDirection;  // accelerationSteps change per move
+	int32_t diffx = 0;      // Position mode: distance to target
+	uint64_t acceleration, targetVelocity, count, moves;
+
+	if((ticks < 2) || (linearRamp->precision == 0) || (linearRamp->precision > ((uint32_t)1<<30)))
+		return 0;
+
+	if(linearRamp->accelerationSteps < 0)
+		return 0;
+
+	if(linearRamp->rampEnabled)
+	{
+		// The unsigned velocity accumulator division matches the signed math only when nothing is negative
+		if((linearRamp->acceleration < 0) || (linearRamp->accumulatorVelocity < 0) || (linearRamp->accumulatorVelocity >= precision))
+			return 0;
+
+		if(linearRamp->acceleration > INT32_MAX - precision)
+			return 0;
+	}
+	else
+	{
+		// Ramp disabled: constant velocity once the target velocity has been applied
+		if((linearRamp->rampVelocity != linearRamp->targetVelocity) || (linearRamp->accumulatorVelocity != 0))
+			return 0;
+	}
+
+	if((abs(linearRamp->rampVelocity) > precision) || (abs(linearRamp->targetVelocity) > precision))
+		return 0;
+
+	if((linearRamp->accumulatorPosition <= -precision) || (linearRamp->accumulatorPosition >= precision))
+		return 0;
+
+	if(linearRamp->rampEnabled && (linearRamp->rampMode == TMC_RAMP_LINEAR_MODE_POSITION))
+	{
+		switch(linearRamp->state)
+		{
+		case TMC_RAMP_LINEAR_STATE_DRIVING:
+			if(linearRamp->targetPosition == linearRamp->rampPosition)
+				return 0;
+
+			direction = (linearRamp->targetPosition > linearRamp->rampPosition) ? 1 : -1;
+			if((linearRamp->rampVelocity * direction < 0) || (linearRamp->maxVelocity > (uint32_t) precision))
+				return 0;
+
+			// Braking starts this tick?
+			diffx = direction * (linearRamp->targetPosition - linearRamp->rampPosition);
+			if(linearRamp->accelerationSteps + 1 >= diffx)
+				return 0;
+
+			// Done by the position calculation of every tick in the segment
+			linearRamp->targetVelocity = direction * (int32_t) linearRamp->maxVelocity;
+			break;
+		case TMC_RAMP_LINEAR_STATE_BRAKING:
+			if((linearRamp->targetPosition == linearRamp->rampPosition) || (linearRamp->rampVelocity == 0))
+				return 0;
+
+			direction = (linearRamp->rampVelocity > 0) ? 1 : -1;
+			diffx = direction * (linearRamp->targetPosition - linearRamp->rampPosition);
+
+			// Only braking towards the target, without enough space to accelerate again.
+			// The latter stays true while approaching the target.
+			if((diffx <= 0) || (linearRamp->accelerationSteps + 1 < diffx))
+				return 0;
+			break;
+		default:
+			return 0;
+		}
+	}
+	else
+	{
+		direction = ((linearRamp->rampVelocity > 0) || ((linearRamp->rampVelocity == 0) && (linearRamp->targetVelocity >= 0))) ? 1 : -1;
+	}
+
+	if((linearRamp->rampVelocity * direction < 0) || (linearRamp->targetVelocity * direction < 0) || (linearRamp->accumulatorPosition * direction < 0))
+		return 0;
+
+	acceleration                 = (linearRamp->rampEnabled) ? linearRamp->acceleration : 0;
+	segment.precision            = precision;
+	segment.acceleration         = 0; // At the target velocity only the accumulator keeps running
+	segment.accumulatorVelocity  = linearRamp->accumulatorVelocity;
+	segment.accumulatorPosition  = linearRamp->accumulatorPosition * direction;
+	segment.velocity             = linearRamp->rampVelocity * direction;
+	segment.decelerating         = false;
+	targetVelocity               = linearRamp->targetVelocity * direction;
+
+	// Limit the segment to the ticks before reaching the target velocity
+	count = MIN(ticks, SEGMENT_MAX_TICKS);
+	stepDirection = 0;
+	if(segment.velocity != targetVelocity)
+	{
+		uint64_t difference;
+
+		if(segment.velocity < targetVelocity)
+		{
+			difference = targetVelocity - segment.velocity;
+			stepDirection = 1;
+		}
+		else
+		{
+			difference = segment.velocity - targetVelocity;
+			segment.decelerating = true;
+			stepDirection = -1;
+		}
+
+		segment.acceleration = acceleration;
+		if(segment.acceleration > 0)
+			count = MIN(count, (difference * segment.precision - segment.accumulatorVelocity - 1) / segment.acceleration);
+	}
+
+	// Position mode: the state must not change at the start of any tick in the segment
+	if(diffx != 0)
+	{
+		uint64_t low = 1;
+		uint64_t high = count;
+
+		while(low < high)
+		{
+			uint64_t mid = low + (high - low + 1) / 2;
+			moves = segmentMoves(&segment, mid - 1);
+
+			if(linearRamp->state == TMC_RAMP_LINEAR_STATE_DRIVING)
+			{
+				// Distance still larger than the braking distance
+				if((int64_t) diffx - (int64_t) moves - countSteps(linearRamp->accelerationSteps, stepDirection, moves) - 1 > 0)
+					low = mid;
+				else
+					high = mid - 1;
+			}
+			else
+			{
+				// Target position not reached yet
+				if(moves < (uint64_t) diffx)
+					low = mid;
+				else
+					high = mid - 1;
+			}
+		}
+		count = low;
+	}
+
+	if(count < 2)
+		return 0;
+
+	// Apply the segment
+	uint64_t dv = segmentVelocityDelta(&segment, count);
+	uint64_t x  = segmentPosition(&segment, count);
+	moves = x / segment.precision;
+
+	linearRamp->rampVelocity         = direction * (int32_t) ((segment.decelerating) ? segment.velocity - dv : segment.velocity + dv);
+	linearRamp->accumulatorVelocity  = (segment.accumulatorVelocity + count * acceleration) % segment.precision;
+	linearRamp->accumulatorPosition  = direction * (int32_t) (x % segment.precision);
+	linearRamp->rampPosition        += direction * (int32_t) moves;
+#ifndef TMC_RAMP_LINEAR_VELOCITY_ONLY
+	linearRamp->accelerationSteps    = countSteps(linearRamp->accelerationSteps, stepDirection, moves);
+#endif
+
+	*dxSum += direction * (int32_t) moves;
+
+	return count;
+}
+
+// Advance the ramp by [ticks] ticks. Returns the sum of the position differences.
+// The result is identical to calling tmc_ramp_linear_compute() [ticks] times, but
+// acceleration and constant velocity phases are integrated at once. Only the ticks
+// at phase boundaries (and corner cases like velocities above the limit) are computed one by one.
+int32_t tmc_ramp_linear_compute_ticks(TMC_LinearRamp *linearRamp, uint32_t ticks)
+{
+	int32_t dxSum = 0;
+
+	while(ticks > 0)
+	{
+		uint32_t count = advanceSegment(linearRamp, ticks, &dxSum);
+
+		if(count == 0)
+		{
+			dxSum += tmc_ramp_linear_compute(linearRamp);
+			count = 1;
+		}
+
+		ticks -= count;
+	}
+
+	return dxSum;
+}
+
 int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 {
 	bool accelerating = linearRamp->rampVelocity != linearRamp->targetVelocity;
@@ -167,8 +555,22 @@ int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 		linearRamp->accumulatorVelocity += linearRamp->acceleration;
 
 		// Calculate the velocity delta value and keep the remainder of the velocity accumulator
-		int32_t dv = linearRamp->accumulatorVelocity / linearRamp->precision;
-		linearRamp->accumulatorVelocity = linearRamp->accumulatorVelocity % linearRamp->precision;
+		int32_t dv;
+		if(PRECISION_SHIFT(linearRamp) != TMC_RAMP_LINEAR_PRECISION_NO_SHIFT)
+		{
+			// Same result as the unsigned division below
+			dv = (UnsignedAccumulator) linearRamp->accumulatorVelocity >> PRECISION_SHIFT(linearRamp);
+			linearRamp->accumulatorVelocity = (UnsignedAccumulator) linearRamp->accumulatorVelocity & (linearRamp->precision - 1);
+		}
+		else
+		{
+#ifdef TMC_RAMP_LINEAR_ACCUMULATOR_64
+			dv = divideAccumulator(&linearRamp->accumulatorVelocity, linearRamp->precision);
+#else
+			dv = linearRamp->accumulatorVelocity / linearRamp->precision;
+			linearRamp->accumulatorVelocity = linearRamp->accumulatorVelocity % linearRamp->precision;
+#endif
+		}
 
 		// Add dv to rampVelocity, and regulate to target velocity
 		if(linearRamp->rampVelocity < linearRamp->targetVelocity)
@@ -186,8 +588,23 @@ int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 
 	// Calculate the velocity delta value and keep the remainder of the position accumulator
 	linearRamp->accumulatorPosition += linearRamp->rampVelocity;
-	int32_t dx = linearRamp->accumulatorPosition / (int32_t) linearRamp->precision;
-	linearRamp->accumulatorPosition = linearRamp->accumulatorPosition % (int32_t) linearRamp->precision;
+	int32_t dx;
+	if(PRECISION_SHIFT(linearRamp) != TMC_RAMP_LINEAR_PRECISION_NO_SHIFT)
+	{
+		// The signed division rounds towards zero - bias negative values before the arithmetic shift
+		TMC_LinearRamp_Accumulator bias = (linearRamp->accumulatorPosition < 0) ? (TMC_LinearRamp_Accumulator) (linearRamp->precision - 1) : 0;
+		dx = (linearRamp->accumulatorPosition + bias) >> PRECISION_SHIFT(linearRamp);
+		linearRamp->accumulatorPosition -= dx * (TMC_LinearRamp_Accumulator) linearRamp->precision;
+	}
+	else
+	{
+#ifdef TMC_RAMP_LINEAR_ACCUMULATOR_64
+		dx = divideAccumulator(&linearRamp->accumulatorPosition, linearRamp->precision);
+#else
+		dx = linearRamp->accumulatorPosition / (int32_t) linearRamp->precision;
+		linearRamp->accumulatorPosition = linearRamp->accumulatorPosition % (int32_t) linearRamp->precision;
+#endif
+	}
 
 	if(dx == 0)
 		return dx;
@@ -195,16 +612,43 @@ int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp)
 	// Change actual position determined by position change
 	linearRamp->rampPosition += (dx < 0) ? (-1) : (1);
 
-	// Count acceleration steps needed for decelerating later
-	linearRamp->accelerationSteps += (abs(linearRamp->rampVelocity) < abs(linearRamp->targetVelocity)) ? accelerating : -accelerating;
+#ifndef TMC_RAMP_LINEAR_VELOCITY_ONLY
+	// Count acceleration steps needed for decelerating later.
+	// Running towards a target velocity of the other direction decelerates first.
+	bool speedingUp = (abs(linearRamp->rampVelocity) < abs(linearRamp->targetVelocity))
+			&& ((linearRamp->rampVelocity > 0) == (linearRamp->targetVelocity > 0));
+	linearRamp->accelerationSteps += (speedingUp) ? accelerating : -accelerating;
 	if (linearRamp->accelerationSteps < 0)
 		linearRamp->accelerationSteps = 0;
+#else
+	UNUSED(accelerating);
+#endif
 
 	return dx;
 }
 
+#ifndef TMC_RAMP_LINEAR_VELOCITY_ONLY
+// Reverse retargeting with the ramp moving away from the target
+static bool isReversing(TMC_LinearRamp *linearRamp)
+{
+	if(linearRamp->retarget != TMC_RAMP_LINEAR_RETARGET_REVERSE)
+		return false;
+
+	if(linearRamp->rampVelocity > 0)
+		return linearRamp->targetPosition < linearRamp->rampPosition;
+
+	if(linearRamp->rampVelocity < 0)
+		return linearRamp->targetPosition > linearRamp->rampPosition;
+
+	return false;
+}
+#endif
+
 void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 {
+#ifdef TMC_RAMP_LINEAR_VELOCITY_ONLY
+	UNUSED(linearRamp);
+#else
 	if (!linearRamp->rampEnabled)
 		return;
 
@@ -225,6 +669,13 @@ void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 		linearRamp->state = TMC_RAMP_LINEAR_STATE_DRIVING;
 		break;
 	case TMC_RAMP_LINEAR_STATE_DRIVING:
+		// Moving away from the target: Reverse without stopping
+		if(isReversing(linearRamp))
+		{
+			linearRamp->targetVelocity = (linearRamp->targetPosition > linearRamp->rampPosition) ? linearRamp->maxVelocity : -linearRamp->maxVelocity;
+			break;
+		}
+
 		// Calculate distance to target (positive = driving towards target)
 		if(linearRamp->rampVelocity > 0)
 			diffx = linearRamp->targetPosition - linearRamp->rampPosition;
@@ -264,7 +715,12 @@ void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 		}
 		else
 		{	// We're not at the target position
-			if(linearRamp->rampVelocity != 0)
+			if(isReversing(linearRamp))
+			{	// Passed the target (or it moved behind): Reverse without stopping
+				linearRamp->targetVelocity = (linearRamp->targetPosition > linearRamp->rampPosition) ? linearRamp->maxVelocity : -linearRamp->maxVelocity;
+				linearRamp->state = TMC_RAMP_LINEAR_STATE_DRIVING;
+			}
+			else if(linearRamp->rampVelocity != 0)
 			{	// Still decelerating
 
 				// Calculate distance to target (positive = driving towards target)
@@ -297,4 +753,5 @@ void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp)
 		}
 		break;
 	}
+#endif
 }
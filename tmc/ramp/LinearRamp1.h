@@ -16,17 +16,47 @@
 // When using 2**N as precision, this results in N digits of precision.
 #define TMC_RAMP_LINEAR_DEFAULT_PRECISION ((uint32_t)1<<17)
 
+// Power of two precisions use shifts and masks instead of divisions.
+// precisionShift holds log2(precision), or this value for other precisions.
+#define TMC_RAMP_LINEAR_PRECISION_NO_SHIFT 0xFF
+
+// Uncomment to fix the precision of all linear ramps to 1 << N at compile time.
+// The divisions are compiled out completely, tmc_ramp_linear_set_precision() is ignored.
+//#define TMC_RAMP_LINEAR_PRECISION_SHIFT 17
+
+// Uncomment to use 64 bit velocity and position accumulators for all linear ramps.
+// The accumulators then no longer limit the acceleration, and precisions up to 1 << 31
+// can be used. On 32 bit MCUs the accumulator arithmetic costs an extra add-with-carry,
+// divisions stay 32 bit as long as the accumulator fits.
+//#define TMC_RAMP_LINEAR_ACCUMULATOR_64
+
+#ifdef TMC_RAMP_LINEAR_ACCUMULATOR_64
+	typedef int64_t TMC_LinearRamp_Accumulator;
+#else
+	typedef int32_t TMC_LinearRamp_Accumulator;
+#endif
+
+// Uncomment to compile out the position mode (including homing and stop velocity) for
+// velocity-only axes. tmc_ramp_linear_set_mode() is ignored then.
+//#define TMC_RAMP_LINEAR_VELOCITY_ONLY
+
 // Position mode: When hitting the target position a velocity below the V_STOP threshold will be cut off to velocity 0
 #define TMC_RAMP_LINEAR_DEFAULT_HOMING_DISTANCE 5
 
 // Position mode: When barely missing the target position by HOMING_DISTANCE or less, the remainder will be driven with V_STOP velocity
-#define TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY 5
+#define TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY 5
 
 typedef enum {
 	TMC_RAMP_LINEAR_MODE_VELOCITY,
 	TMC_RAMP_LINEAR_MODE_POSITION
 } TMC_LinearRamp_Mode;
 
+// Position mode: Behaviour when the target moves behind the ramp (or too close to stop in front of it)
+typedef enum {
+	TMC_RAMP_LINEAR_RETARGET_STOP,     // Brake to standstill, then start a new ramp towards the target
+	TMC_RAMP_LINEAR_RETARGET_REVERSE   // Reverse through zero velocity with the acceleration, without stopping
+} TMC_LinearRamp_Retarget;
+
 typedef enum {
 	TMC_RAMP_LINEAR_STATE_IDLE,
 	TMC_RAMP_LINEAR_STATE_DRIVING,
@@ -42,18 +72,22 @@ typedef struct
 	int32_t rampVelocity;
 	int32_t acceleration;
 	bool rampEnabled;
-	int32_t accumulatorVelocity;
-	int32_t accumulatorPosition;
+	TMC_LinearRamp_Accumulator accumulatorVelocity;
+	TMC_LinearRamp_Accumulator accumulatorPosition;
 	TMC_LinearRamp_Mode rampMode;
+	TMC_LinearRamp_Retarget retarget;
 	TMC_LinearRamp_State state;
 	int32_t accelerationSteps;
 	uint32_t precision;
 	uint32_t homingDistance;
 	uint32_t stopVelocity;
+	uint8_t precisionShift;
+	uint16_t encoderSteps; // Legacy functions of LinearRamp.h only
 } TMC_LinearRamp;
 
 void tmc_ramp_linear_init(TMC_LinearRamp *linearRamp);
 int32_t tmc_ramp_linear_compute(TMC_LinearRamp *linearRamp);
+int32_t tmc_ramp_linear_compute_ticks(TMC_LinearRamp *linearRamp, uint32_t ticks);
 int32_t tmc_ramp_linear_compute_velocity(TMC_LinearRamp *linearRamp);
 void tmc_ramp_linear_compute_position(TMC_LinearRamp *linearRamp);
 
@@ -65,6 +99,7 @@ void tmc_ramp_linear_set_targetVelocity(TMC_LinearRamp *linearRamp, int32_t targ
 void tmc_ramp_linear_set_rampVelocity(TMC_LinearRamp *linearRamp, int32_t rampVelocity);
 void tmc_ramp_linear_set_acceleration(TMC_LinearRamp *linearRamp, int32_t acceleration);
 void tmc_ramp_linear_set_mode(TMC_LinearRamp *linearRamp, TMC_LinearRamp_Mode mode);
+void tmc_ramp_linear_set_retarget(TMC_LinearRamp *linearRamp, TMC_LinearRamp_Retarget retarget);
 void tmc_ramp_linear_set_precision(TMC_LinearRamp * linearRamp, uint32_t precision);
 void tmc_ramp_linear_set_homingDistance(TMC_LinearRamp *linearRamp, uint32_t homingDistance);
 void tmc_ramp_linear_set_stopVelocity(TMC_LinearRamp *linearRamp, uint32_t stopVelocity);
@@ -77,7 +112,9 @@ int32_t tmc_ramp_linear_get_targetVelocity(TMC_LinearRamp *linearRamp);
 int32_t tmc_ramp_linear_get_rampVelocity(TMC_LinearRamp *linearRamp);
 int32_t tmc_ramp_linear_get_acceleration(TMC_LinearRamp *linearRamp);
 TMC_LinearRamp_State tmc_ramp_linear_get_state(TMC_LinearRamp *linearRamp);
+TMCRampPhase tmc_ramp_linear_get_phase(TMC_LinearRamp *linearRamp);
 TMC_LinearRamp_Mode tmc_ramp_linear_get_mode(TMC_LinearRamp *linearRamp);
+TMC_LinearRamp_Retarget tmc_ramp_linear_get_retarget(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_precision(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_acceleration_limit(TMC_LinearRamp *linearRamp);
 uint32_t tmc_ramp_linear_get_velocity_limit(TMC_LinearRamp *linearRamp);
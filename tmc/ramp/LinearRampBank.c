@@ -0,0 +1,221 @@
+/*
+ * LinearRampBank.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "LinearRampBank.h"
+#include "tmc/helpers/Functions.h"
+
+void tmc_ramp_linear_bank_init(TMC_LinearRampBank *bank, uint8_t count)
+{
+	uint8_t i;
+
+	bank->count           = MIN(count, TMC_RAMP_LINEAR_BANK_AXES);
+	bank->precisionShift  = TMC_RAMP_LINEAR_BANK_DEFAULT_SHIFT;
+	bank->positionMode    = 0;
+	bank->homingDistance  = TMC_RAMP_LINEAR_DEFAULT_HOMING_DISTANCE;
+	bank->stopVelocity    = TMC_RAMP_LINEAR_DEFAULT_STOP_VELOCITY;
+
+	for(i = 0; i < TMC_RAMP_LINEAR_BANK_AXES; i++)
+	{
+		bank->targetVelocity[i]       = 0;
+		bank->rampVelocity[i]         = 0;
+		bank->acceleration[i]         = 0;
+		bank->accumulatorVelocity[i]  = 0;
+		bank->accumulatorPosition[i]  = 0;
+		bank->rampPosition[i]         = 0;
+		bank->accelerationSteps[i]    = 0;
+		bank->positionDelta[i]        = 0;
+		bank->maxVelocity[i]          = 0;
+		bank->targetPosition[i]       = 0;
+		bank->state[i]                = TMC_RAMP_LINEAR_STATE_IDLE;
+	}
+}
+
+// Position mode state machine of one axis, see tmc_ramp_linear_compute_position()
+static void computePosition(TMC_LinearRampBank *bank, uint8_t axis)
+{
+	int32_t rampVelocity = bank->rampVelocity[axis];
+	int32_t distance = bank->targetPosition[axis] - bank->rampPosition[axis];
+
+	// Calculate distance to target (positive = driving towards target)
+	int32_t diffx = (rampVelocity > 0) ? distance : ((rampVelocity < 0) ? -distance : abs(distance));
+
+	switch(bank->state[axis]) {
+	case TMC_RAMP_LINEAR_STATE_IDLE:
+		if(rampVelocity == 0)
+			bank->accelerationSteps[axis] = 0;
+
+		if(distance != 0)
+			bank->state[axis] = TMC_RAMP_LINEAR_STATE_DRIVING;
+		break;
+	case TMC_RAMP_LINEAR_STATE_DRIVING:
+		// Steps left required for braking?
+		// (+ 1 to compensate rounding (flooring) errors of the position accumulator)
+		if(bank->accelerationSteps[axis] + 1 >= diffx)
+		{
+			bank->targetVelocity[axis] = 0;
+			bank->state[axis] = TMC_RAMP_LINEAR_STATE_BRAKING;
+		}
+		else
+		{	// Driving - apply VMAX (this also allows mid-ramp VMAX changes)
+			bank->targetVelocity[axis] = (distance > 0) ? bank->maxVelocity[axis] : -bank->maxVelocity[axis];
+		}
+		break;
+	case TMC_RAMP_LINEAR_STATE_BRAKING:
+		if(distance == 0)
+		{
+			if(abs(rampVelocity) <= bank->stopVelocity)
+			{	// Position reached, velocity within cutoff threshold (or zero)
+				bank->rampVelocity[axis] = 0;
+				bank->targetVelocity[axis] = 0;
+				bank->state[axis] = TMC_RAMP_LINEAR_STATE_IDLE;
+			}
+		}
+		else if(rampVelocity != 0)
+		{	// Still decelerating - enough space to accelerate again?
+			if(bank->accelerationSteps[axis] + 1 < diffx)
+				bank->state[axis] = TMC_RAMP_LINEAR_STATE_DRIVING;
+		}
+		else if(abs(distance) <= bank->homingDistance)
+		{	// Standing still within homing distance - drive with stop velocity
+			bank->targetVelocity[axis] = (distance > 0) ? bank->stopVelocity : -bank->stopVelocity;
+		}
+		else
+		{	// Standing still outside of homing distance - start a new ramp
+			bank->state[axis] = TMC_RAMP_LINEAR_STATE_IDLE;
+		}
+		break;
+	}
+}
+
+void tmc_ramp_linear_bank_compute(TMC_LinearRampBank *bank)
+{
+	uint8_t shift = bank->precisionShift;
+	uint32_t mask = ((uint32_t)1 << shift) - 1;
+	uint32_t positionMode = bank->positionMode;
+	uint8_t i;
+
+	// Position mode axes update their target velocity first
+	for(i = 0; positionMode != 0; i++, positionMode >>= 1)
+	{
+		if(positionMode & 1)
+			computePosition(bank, i);
+	}
+
+	// Velocity and position integration of all axes.
+	// Same arithmetic as the power of two precision path of tmc_ramp_linear_compute_velocity(),
+	// with the branches replaced by selects.
+	for(i = 0; i < bank->count; i++)
+	{
+		int32_t rampVelocity   = bank->rampVelocity[i];
+		int32_t targetVelocity = bank->targetVelocity[i];
+		int32_t accelerating   = rampVelocity != targetVelocity;
+
+		// Add current acceleration to accumulator, split into velocity delta and remainder
+		uint32_t accumulatorVelocity = (uint32_t) bank->accumulatorVelocity[i] + (uint32_t) bank->acceleration[i];
+		int32_t dv = accumulatorVelocity >> shift;
+		bank->accumulatorVelocity[i] = accumulatorVelocity & mask;
+
+		// Add dv to rampVelocity, and regulate to target velocity.
+		// At the target velocity, both candidates equal the target velocity.
+		int32_t up   = MIN(rampVelocity + dv, targetVelocity);
+		int32_t down = MAX(rampVelocity - dv, targetVelocity);
+		rampVelocity = (rampVelocity < targetVelocity) ? up : down;
+		bank->rampVelocity[i] = rampVelocity;
+
+		// Add velocity to accumulator, split into position delta and remainder.
+		// The bias makes the arithmetic shift round towards zero like the division.
+		int32_t accumulatorPosition = bank->accumulatorPosition[i] + rampVelocity;
+		int32_t bias = (accumulatorPosition < 0) ? (int32_t) mask : 0;
+		int32_t dx = (accumulatorPosition + bias) >> shift;
+		bank->accumulatorPosition[i] = accumulatorPosition - (int32_t) ((uint32_t) dx << shift);
+		bank->positionDelta[i] = dx;
+
+		// Change actual position determined by position change
+		bank->rampPosition[i] += (dx > 0) - (dx < 0);
+
+		// Count acceleration steps needed for decelerating later
+		int32_t counted = (dx != 0) & accelerating;
+		int32_t steps = bank->accelerationSteps[i] + ((abs(rampVelocity) < abs(targetVelocity)) ? counted : -counted);
+		bank->accelerationSteps[i] = MAX(steps, 0);
+	}
+}
+
+void tmc_ramp_linear_bank_set_precisionShift(TMC_LinearRampBank *bank, uint8_t shift)
+{
+	// Shifts above 30 do not fit the signed position accumulator math
+	bank->precisionShift = MIN(shift, 30);
+}
+
+void tmc_ramp_linear_bank_set_mode(TMC_LinearRampBank *bank, uint8_t axis, TMC_LinearRamp_Mode mode)
+{
+	if(axis >= TMC_RAMP_LINEAR_BANK_AXES)
+		return;
+
+	if(mode == TMC_RAMP_LINEAR_MODE_POSITION)
+		bank->positionMode |= (uint32_t)1 << axis;
+	else
+		bank->positionMode &= ~((uint32_t)1 << axis);
+}
+
+void tmc_ramp_linear_bank_set_maxVelocity(TMC_LinearRampBank *bank, uint8_t axis, uint32_t maxVelocity)
+{
+	bank->maxVelocity[axis] = maxVelocity;
+}
+
+void tmc_ramp_linear_bank_set_targetPosition(TMC_LinearRampBank *bank, uint8_t axis, int32_t targetPosition)
+{
+	bank->targetPosition[axis] = targetPosition;
+}
+
+void tmc_ramp_linear_bank_set_rampPosition(TMC_LinearRampBank *bank, uint8_t axis, int32_t rampPosition)
+{
+	bank->rampPosition[axis] = rampPosition;
+}
+
+void tmc_ramp_linear_bank_set_targetVelocity(TMC_LinearRampBank *bank, uint8_t axis, int32_t targetVelocity)
+{
+	bank->targetVelocity[axis] = targetVelocity;
+}
+
+void tmc_ramp_linear_bank_set_rampVelocity(TMC_LinearRampBank *bank, uint8_t axis, int32_t rampVelocity)
+{
+	bank->rampVelocity[axis] = rampVelocity;
+}
+
+void tmc_ramp_linear_bank_set_acceleration(TMC_LinearRampBank *bank, uint8_t axis, int32_t acceleration)
+{
+	bank->acceleration[axis] = acceleration;
+}
+
+uint32_t tmc_ramp_linear_bank_get_precision(TMC_LinearRampBank *bank)
+{
+	return (uint32_t)1 << bank->precisionShift;
+}
+
+TMC_LinearRamp_Mode tmc_ramp_linear_bank_get_mode(TMC_LinearRampBank *bank, uint8_t axis)
+{
+	return (bank->positionMode & ((uint32_t)1 << axis)) ? TMC_RAMP_LINEAR_MODE_POSITION : TMC_RAMP_LINEAR_MODE_VELOCITY;
+}
+
+TMC_LinearRamp_State tmc_ramp_linear_bank_get_state(TMC_LinearRampBank *bank, uint8_t axis)
+{
+	return bank->state[axis];
+}
+
+int32_t tmc_ramp_linear_bank_get_rampPosition(TMC_LinearRampBank *bank, uint8_t axis)
+{
+	return bank->rampPosition[axis];
+}
+
+int32_t tmc_ramp_linear_bank_get_rampVelocity(TMC_LinearRampBank *bank, uint8_t axis)
+{
+	return bank->rampVelocity[axis];
+}
+
+int32_t tmc_ramp_linear_bank_get_positionDelta(TMC_LinearRampBank *bank, uint8_t axis)
+{
+	return bank->positionDelta[axis];
+}
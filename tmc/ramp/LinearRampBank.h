@@ -0,0 +1,69 @@
+/*
+ * LinearRampBank.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_LINEARRAMPBANK_H_
+#define TMC_RAMP_LINEARRAMPBANK_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Bank of linear ramps for controllers driving many axes.
+// Computes the same trajectories as one TMC_LinearRamp per axis (with the ramp enabled),
+// but stores every value in a separate array and computes all axes in one pass. The velocity
+// and position integration is a branch free loop over the arrays, which compilers can vectorise.
+// Only the axes in position mode run the position state machine before that loop.
+// All axes share a power of two precision.
+
+// Maximum amount of axes per bank
+#define TMC_RAMP_LINEAR_BANK_AXES 32
+
+// Default precision: 1 << TMC_RAMP_LINEAR_BANK_DEFAULT_SHIFT, see TMC_RAMP_LINEAR_DEFAULT_PRECISION
+#define TMC_RAMP_LINEAR_BANK_DEFAULT_SHIFT 17
+
+typedef struct
+{
+	uint8_t count;
+	uint8_t precisionShift;
+	uint32_t positionMode; // Bit N set: Axis N is in position mode
+
+	int32_t targetVelocity[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t rampVelocity[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t acceleration[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t accumulatorVelocity[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t accumulatorPosition[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t rampPosition[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t accelerationSteps[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t positionDelta[TMC_RAMP_LINEAR_BANK_AXES]; // Result of the last computation
+
+	// Position mode only
+	uint32_t maxVelocity[TMC_RAMP_LINEAR_BANK_AXES];
+	int32_t targetPosition[TMC_RAMP_LINEAR_BANK_AXES];
+	uint8_t state[TMC_RAMP_LINEAR_BANK_AXES]; // TMC_LinearRamp_State
+	uint32_t homingDistance;
+	uint32_t stopVelocity;
+} TMC_LinearRampBank;
+
+void tmc_ramp_linear_bank_init(TMC_LinearRampBank *bank, uint8_t count);
+void tmc_ramp_linear_bank_compute(TMC_LinearRampBank *bank);
+
+void tmc_ramp_linear_bank_set_precisionShift(TMC_LinearRampBank *bank, uint8_t shift);
+void tmc_ramp_linear_bank_set_mode(TMC_LinearRampBank *bank, uint8_t axis, TMC_LinearRamp_Mode mode);
+void tmc_ramp_linear_bank_set_maxVelocity(TMC_LinearRampBank *bank, uint8_t axis, uint32_t maxVelocity);
+void tmc_ramp_linear_bank_set_targetPosition(TMC_LinearRampBank *bank, uint8_t axis, int32_t targetPosition);
+void tmc_ramp_linear_bank_set_rampPosition(TMC_LinearRampBank *bank, uint8_t axis, int32_t rampPosition);
+void tmc_ramp_linear_bank_set_targetVelocity(TMC_LinearRampBank *bank, uint8_t axis, int32_t targetVelocity);
+void tmc_ramp_linear_bank_set_rampVelocity(TMC_LinearRampBank *bank, uint8_t axis, int32_t rampVelocity);
+void tmc_ramp_linear_bank_set_acceleration(TMC_LinearRampBank *bank, uint8_t axis, int32_t acceleration);
+
+uint32_t tmc_ramp_linear_bank_get_precision(TMC_LinearRampBank *bank);
+TMC_LinearRamp_Mode tmc_ramp_linear_bank_get_mode(TMC_LinearRampBank *bank, uint8_t axis);
+TMC_LinearRamp_State tmc_ramp_linear_bank_get_state(TMC_LinearRampBank *bank, uint8_t axis);
+int32_t tmc_ramp_linear_bank_get_rampPosition(TMC_LinearRampBank *bank, uint8_t axis);
+int32_t tmc_ramp_linear_bank_get_rampVelocity(TMC_LinearRampBank *bank, uint8_t axis);
+int32_t tmc_ramp_linear_bank_get_positionDelta(TMC_LinearRampBank *bank, uint8_t axis);
+
+#endif /* TMC_RAMP_LINEARRAMPBANK_H_ */
@@ -0,0 +1,109 @@
+/*
+ * MicrostepScaling.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "MicrostepScaling.h"
+#include "tmc/helpers/Functions.h"
+
+void tmc_ramp_microstep_init(TMC_MicrostepScaling *scaling, TMC_LinearRamp *ramp, tmc_ramp_microstep_setResolution setResolution, void *ic,
+		uint8_t mres, uint8_t coarseShift, uint32_t upperVelocity, uint32_t lowerVelocity)
+{
+	scaling->ramp            = ramp;
+	scaling->setResolution   = setResolution;
+	scaling->ic              = ic;
+	scaling->mres            = mres;
+	scaling->coarseShift     = MIN(coarseShift, 8 - mres);
+	scaling->upperVelocity   = upperVelocity;
+	scaling->lowerVelocity   = lowerVelocity;
+	scaling->shift           = 0;
+	scaling->offset          = 0;
+	scaling->targetPosition  = ramp->targetPosition;
+}
+
+// Switch the ramp to 2^shift microsteps per step
+static void toCoarse(TMC_MicrostepScaling *scaling, uint8_t shift)
+{
+	TMC_LinearRamp *ramp = scaling->ramp;
+	int32_t factor = 1 << shift;
+
+	scaling->targetPosition  = ramp->targetPosition;
+	scaling->offset          = ramp->rampPosition & (factor - 1);
+
+	ramp->rampPosition         = (ramp->rampPosition - scaling->offset) >> shift;
+	ramp->targetPosition       = (ramp->targetPosition - scaling->offset) >> shift;
+	ramp->accumulatorPosition  >>= shift;
+	ramp->rampVelocity         /= factor;
+	ramp->targetVelocity       /= factor;
+	ramp->maxVelocity          >>= shift;
+	ramp->acceleration         /= factor;
+	ramp->accumulatorVelocity  >>= shift;
+	ramp->accelerationSteps    /= factor;
+
+	scaling->shift = shift;
+}
+
+static void toFine(TMC_MicrostepScaling *scaling)
+{
+	TMC_LinearRamp *ramp = scaling->ramp;
+	uint8_t shift = scaling->shift;
+	int32_t precision = ramp->precision;
+	int32_t dx;
+
+	ramp->rampPosition         = ramp->rampPosition * (1 << shift) + scaling->offset;
+	ramp->accumulatorPosition  *= 1 << shift;
+	ramp->rampVelocity         *= 1 << shift;
+	ramp->targetVelocity       *= 1 << shift;
+	ramp->maxVelocity          <<= shift;
+	ramp->acceleration         *= 1 << shift;
+	ramp->accumulatorVelocity  = ((uint32_t) ramp->accumulatorVelocity << shift) % precision;
+	ramp->accelerationSteps    *= 1 << shift;
+
+	// Whole microsteps of the scaled position fraction
+	dx = ramp->accumulatorPosition / precision;
+	ramp->rampPosition         += dx;
+	ramp->accumulatorPosition  -= dx * precision;
+
+	ramp->targetPosition  = scaling->targetPosition;
+	scaling->shift        = 0;
+	scaling->offset       = 0;
+}
+
+bool tmc_ramp_microstep_service(TMC_MicrostepScaling *scaling)
+{
+	uint32_t velocity = abs(tmc_ramp_microstep_get_velocity(scaling));
+
+	if((scaling->shift == 0) && (scaling->coarseShift != 0) && (velocity > scaling->upperVelocity))
+	{
+		toCoarse(scaling, scaling->coarseShift);
+	}
+	else if((scaling->shift != 0) && (velocity < scaling->lowerVelocity))
+	{
+		toFine(scaling);
+	}
+	else
+	{
+		return false;
+	}
+
+	scaling->setResolution(scaling->ic, scaling->mres + scaling->shift);
+
+	return true;
+}
+
+void tmc_ramp_microstep_set_targetPosition(TMC_MicrostepScaling *scaling, int32_t targetPosition)
+{
+	scaling->targetPosition = targetPosition;
+	scaling->ramp->targetPosition = (targetPosition - scaling->offset) >> scaling->shift;
+}
+
+int32_t tmc_ramp_microstep_get_position(TMC_MicrostepScaling *scaling)
+{
+	return scaling->ramp->rampPosition * (1 << scaling->shift) + scaling->offset;
+}
+
+int32_t tmc_ramp_microstep_get_velocity(TMC_MicrostepScaling *scaling)
+{
+	return scaling->ramp->rampVelocity * (1 << scaling->shift);
+}
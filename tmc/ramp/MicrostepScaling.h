@@ -0,0 +1,63 @@
+/*
+ * MicrostepScaling.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_MICROSTEPSCALING_H_
+#define TMC_RAMP_MICROSTEPSCALING_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Microstep resolution switching for STEP/DIR axes driven by a TMC_LinearRamp.
+// The step rate of a ramp is limited to one step per computation. Above upperVelocity the
+// resolution is reduced by 2^shift microsteps per step (CHOPCONF.MRES + shift), so the same
+// motor velocity needs 2^shift times fewer steps. Below lowerVelocity the full resolution is
+// restored. Enable the interpolation of the IC (CHOPCONF.intpol) to keep the motor current
+// at 256 microsteps in both resolutions.
+//
+// The ramp is rescaled at every switch: Positions, velocities and the acceleration are
+// divided by 2^shift, the microsteps below a full coarse step are kept as offset and added
+// again when switching back, so the full resolution position stays exact. The target
+// position is stored in full resolution as well.
+//
+// Call tmc_ramp_microstep_service() between two ramp computations, e.g. from the same interrupt.
+// While the coarse resolution is active, use tmc_ramp_microstep_set_targetPosition() and
+// tmc_ramp_microstep_get_position() instead of accessing the ramp positions directly.
+// A TMC_StepGenerator using the ramp has to be resynchronised after a switch, see
+// tmc_ramp_stepgen_sync().
+
+// Write the microstep resolution (MRES encoding: 0 = 256 microsteps ... 8 = fullstep).
+// The application forwards it to the IC, e.g. with TMC2209_FIELD_WRITE(..., TMC2209_MRES_MASK, ...)
+typedef void (*tmc_ramp_microstep_setResolution)(void *ic, uint8_t mres);
+
+typedef struct
+{
+	TMC_LinearRamp *ramp;
+	tmc_ramp_microstep_setResolution setResolution;
+	void *ic;
+
+	uint8_t mres;           // Full resolution MRES
+	uint8_t coarseShift;    // Resolution reduction above upperVelocity, MRES + coarseShift <= 8
+	uint32_t upperVelocity; // Full resolution velocities, upperVelocity > lowerVelocity
+	uint32_t lowerVelocity;
+
+	uint8_t shift;          // Active resolution reduction, 0 or coarseShift
+	int32_t offset;         // Full resolution microsteps below the coarse position
+	int32_t targetPosition; // Full resolution target position
+} TMC_MicrostepScaling;
+
+void tmc_ramp_microstep_init(TMC_MicrostepScaling *scaling, TMC_LinearRamp *ramp, tmc_ramp_microstep_setResolution setResolution, void *ic,
+		uint8_t mres, uint8_t coarseShift, uint32_t upperVelocity, uint32_t lowerVelocity);
+
+// Switch the resolution if the ramp velocity crossed a threshold.
+// Returns true if the resolution was changed.
+bool tmc_ramp_microstep_service(TMC_MicrostepScaling *scaling);
+
+void tmc_ramp_microstep_set_targetPosition(TMC_MicrostepScaling *scaling, int32_t targetPosition);
+int32_t tmc_ramp_microstep_get_position(TMC_MicrostepScaling *scaling);
+int32_t tmc_ramp_microstep_get_velocity(TMC_MicrostepScaling *scaling);
+
+#endif /* TMC_RAMP_MICROSTEPSCALING_H_ */
@@ -0,0 +1,233 @@
+/*
+ * MotionQueue.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "MotionQueue.h"
+#include "tmc/helpers/Functions.h"
+
+#define QUEUE_MASK (TMC_RAMP_MOTIONQUEUE_SIZE - 1)
+
+void tmc_ramp_motionqueue_init(TMC_MotionQueue *queue, TMC_LinearRamp **axes, uint8_t count, uint32_t junctionJump)
+{
+	uint8_t i;
+
+	tmc_ramp_linear_init(&queue->path);
+
+	queue->count            = MIN(count, TMC_RAMP_MOTIONQUEUE_AXES);
+	queue->junctionJump     = junctionJump;
+	queue->head             = 0;
+	queue->tail             = 0;
+	queue->pathPosition     = 0;
+	queue->segmentPosition  = 0;
+
+	for(i = 0; i < TMC_RAMP_MOTIONQUEUE_AXES; i++)
+	{
+		queue->axes[i]            = (i < queue->count) ? axes[i] : NULL;
+		queue->error[i]           = 0;
+		queue->positionDelta[i]   = 0;
+		queue->queuedPosition[i]  = (i < queue->count) ? axes[i]->rampPosition : 0;
+	}
+}
+
+bool tmc_ramp_motionqueue_enqueue(TMC_MotionQueue *queue, const int32_t *targetPositions, uint32_t maxVelocity, int32_t acceleration)
+{
+	uint8_t tail = queue->tail;
+	bool empty = (queue->head == tail);
+	TMC_MotionSegment *segment = &queue->segments[tail];
+	TMC_MotionSegment *previous = &queue->segments[(tail - 1) & QUEUE_MASK];
+	uint32_t length = 0;
+	uint32_t ratioChange = 0;
+	uint8_t i;
+
+	if(((tail + 1) & QUEUE_MASK) == queue->head)
+		return false;
+
+	// The queue ran empty - continue from the current positions
+	if(empty)
+	{
+		for(i = 0; i < queue->count; i++)
+			queue->queuedPosition[i] = queue->axes[i]->rampPosition;
+	}
+
+	for(i = 0; i < queue->count; i++)
+	{
+		int32_t distance = targetPositions[i] - queue->queuedPosition[i];
+
+		segment->direction[i] = (distance < 0) ? -1 : 1;
+		segment->distance[i]  = (distance < 0) ? -distance : distance;
+		length = MAX(length, segment->distance[i]);
+	}
+
+	// Nothing to move
+	if(length == 0)
+		return true;
+
+	for(i = 0; i < queue->count; i++)
+	{
+		segment->velocityRatio[i] = segment->direction[i] * (int32_t) (((uint64_t) segment->distance[i] << 16) / length);
+
+		// Largest axis velocity change per path velocity at the junction
+		if(!empty)
+			ratioChange = MAX(ratioChange, (uint32_t) abs(segment->velocityRatio[i] - previous->velocityRatio[i]));
+
+		queue->queuedPosition[i] = targetPositions[i];
+	}
+
+	segment->length        = length;
+	segment->maxVelocity   = maxVelocity;
+	segment->acceleration  = acceleration;
+	segment->exitVelocity  = 0;
+
+	// Junction velocity limit, starting from standstill after an empty queue
+	if(empty)
+		segment->entryLimit = 0;
+	else if(ratioChange == 0)
+		segment->entryLimit = UINT32_MAX;
+	else
+		segment->entryLimit = MIN(((uint64_t) queue->junctionJump << 16) / ratioChange, UINT32_MAX);
+
+	// Hand the segment to the computation
+	queue->tail = (tail + 1) & QUEUE_MASK;
+
+	return true;
+}
+
+// Highest velocity at the start of the segment that still allows reaching exitVelocity at its end
+static uint32_t entryVelocity(TMC_MotionSegment *segment, uint32_t exitVelocity)
+{
+	uint32_t velocity = MIN(segment->entryLimit, segment->maxVelocity);
+	uint64_t brakingEnergy;
+
+	if((exitVelocity >= velocity) || (segment->acceleration <= 0))
+		return MIN(exitVelocity, velocity);
+
+	// v_entry^2 = v_exit^2 + 2 * a * s (the precision cancels out)
+	brakingEnergy = 2 * (uint64_t) segment->acceleration * segment->length;
+	if(brakingEnergy >= (uint64_t) velocity * velocity)
+		return velocity;
+
+	return MIN(tmc_sqrti64((uint64_t) exitVelocity * exitVelocity + brakingEnergy), velocity);
+}
+
+void tmc_ramp_motionqueue_plan(TMC_MotionQueue *queue)
+{
+	uint8_t head = queue->head;
+	uint8_t i = queue->tail;
+	uint32_t exitVelocity = 0;
+
+	if(head == i)
+		return;
+
+	// Backward pass: The last queued segment ends at zero velocity, every segment
+	// before ends at the highest velocity the following segments can brake from.
+	// The forward pass (acceleration limit) is done by the path ramp while executing.
+	for(;;)
+	{
+		i = (i - 1) & QUEUE_MASK;
+		queue->segments[i].exitVelocity = exitVelocity;
+
+		if(i == head)
+			break;
+
+		exitVelocity = MIN(entryVelocity(&queue->segments[i], exitVelocity), queue->segments[(i - 1) & QUEUE_MASK].maxVelocity);
+	}
+}
+
+void tmc_ramp_motionqueue_compute(TMC_MotionQueue *queue)
+{
+	TMC_LinearRamp *path = &queue->path;
+	TMC_MotionSegment *segment;
+	uint32_t remaining, exitVelocity;
+	uint64_t brakingEnergy;
+	uint8_t i;
+
+	for(i = 0; i < queue->count; i++)
+		queue->positionDelta[i] = 0;
+
+	if(queue->head == queue->tail)
+		return;
+
+	segment = &queue->segments[queue->head];
+	remaining = segment->length - queue->segmentPosition;
+	exitVelocity = MIN(segment->exitVelocity, segment->maxVelocity);
+
+	// Steps left required for braking to the exit velocity?
+	// (- 1 to compensate rounding (flooring) errors of the position accumulator)
+	brakingEnergy = (uint64_t) exitVelocity * exitVelocity + 2 * (uint64_t) MAX(segment->acceleration, 0) * (remaining - 1);
+	path->targetVelocity = ((uint64_t) path->rampVelocity * path->rampVelocity >= brakingEnergy) ? exitVelocity : segment->maxVelocity;
+
+	// Do not stop before reaching the end of the segment
+	path->targetVelocity = MAX((uint32_t) path->targetVelocity, path->stopVelocity);
+	path->acceleration = segment->acceleration;
+
+	tmc_ramp_linear_compute(path);
+
+	// Distribute the path steps to the axes
+	while((int32_t) (path->rampPosition - queue->pathPosition) > 0)
+	{
+		queue->pathPosition++;
+
+		// Starting a segment - round the axis positions to the nearest step
+		if(queue->segmentPosition == 0)
+		{
+			for(i = 0; i < queue->count; i++)
+				queue->error[i] = segment->length / 2;
+		}
+		queue->segmentPosition++;
+
+		for(i = 0; i < queue->count; i++)
+		{
+			queue->error[i] += segment->distance[i];
+			if(queue->error[i] >= segment->length)
+			{
+				queue->error[i] -= segment->length;
+				queue->positionDelta[i] += segment->direction[i];
+			}
+		}
+
+		if(queue->segmentPosition < segment->length)
+			continue;
+
+		// Segment finished
+		queue->segmentPosition = 0;
+		queue->head = (queue->head + 1) & QUEUE_MASK;
+
+		if(queue->head == queue->tail)
+		{	// End of the path - cut off the remaining (stop) velocity
+			path->rampVelocity         = 0;
+			path->targetVelocity       = 0;
+			path->accumulatorVelocity  = 0;
+			path->accumulatorPosition  = 0;
+			queue->pathPosition        = path->rampPosition;
+			break;
+		}
+
+		segment = &queue->segments[queue->head];
+	}
+
+	for(i = 0; i < queue->count; i++)
+	{
+		TMC_LinearRamp *axis = queue->axes[i];
+
+		axis->rampPosition += queue->positionDelta[i];
+		axis->rampVelocity = (int32_t) (((int64_t) path->rampVelocity * segment->velocityRatio[i]) / 65536);
+		axis->targetVelocity = axis->rampVelocity;
+	}
+}
+
+bool tmc_ramp_motionqueue_is_empty(TMC_MotionQueue *queue)
+{
+	return queue->head == queue->tail;
+}
+
+uint8_t tmc_ramp_motionqueue_get_free(TMC_MotionQueue *queue)
+{
+	return (queue->head - queue->tail - 1) & QUEUE_MASK;
+}
+
+int32_t tmc_ramp_motionqueue_get_positionDelta(TMC_MotionQueue *queue, uint8_t axis)
+{
+	return queue->positionDelta[axis];
+}
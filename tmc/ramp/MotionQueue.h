@@ -0,0 +1,83 @@
+/*
+ * MotionQueue.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_MOTIONQUEUE_H_
+#define TMC_RAMP_MOTIONQUEUE_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Look-ahead motion queue for multi-segment paths.
+// Segments are linear moves of all axes, executed like TMC_LinearInterpolation: The path
+// velocity is the velocity of the axis with the longest distance of each segment.
+// Instead of stopping after each segment, the path velocity at a junction is limited so no
+// axis velocity changes by more than junctionJump. A backward pass over the queued segments
+// makes sure every segment can still decelerate to the following junction velocities and to
+// zero at the end of the last queued segment.
+//
+// Usage:
+// - tmc_ramp_motionqueue_enqueue() adds segments. It runs in constant time and can be called
+//   from a lower priority task than the computation.
+// - tmc_ramp_motionqueue_plan() runs the backward pass. Call it from the same task after
+//   enqueueing one or more segments.
+// - tmc_ramp_motionqueue_compute() computes one tick. Call it periodically, e.g. from an ISR.
+// The queue is a single producer, single consumer ring buffer: The task only writes the tail
+// and the planned velocities, the computation only advances the head.
+
+// Capacity of the queue, must be a power of two
+#define TMC_RAMP_MOTIONQUEUE_SIZE 16
+
+// Maximum amount of axes
+#define TMC_RAMP_MOTIONQUEUE_AXES 4
+
+typedef struct
+{
+	uint32_t length;                                 // Distance of the longest axis
+	uint32_t distance[TMC_RAMP_MOTIONQUEUE_AXES];
+	int8_t direction[TMC_RAMP_MOTIONQUEUE_AXES];
+	int32_t velocityRatio[TMC_RAMP_MOTIONQUEUE_AXES]; // Signed distance / length in 1/65536
+	uint32_t maxVelocity;
+	int32_t acceleration;
+	uint32_t entryLimit;                             // Junction velocity limit
+	volatile uint32_t exitVelocity;                  // Planned velocity at the end of the segment
+} TMC_MotionSegment;
+
+typedef struct
+{
+	TMC_LinearRamp path;
+	uint8_t count;
+	TMC_LinearRamp *axes[TMC_RAMP_MOTIONQUEUE_AXES];
+	uint32_t junctionJump;
+
+	TMC_MotionSegment segments[TMC_RAMP_MOTIONQUEUE_SIZE];
+	volatile uint8_t head; // Segment being executed, advanced by the computation
+	volatile uint8_t tail; // Next free segment, advanced by enqueueing
+
+	// Execution of the head segment
+	int32_t pathPosition;  // Path ramp position of the handed out steps
+	uint32_t segmentPosition;
+	uint32_t error[TMC_RAMP_MOTIONQUEUE_AXES];
+	int32_t positionDelta[TMC_RAMP_MOTIONQUEUE_AXES]; // Result of the last computation
+
+	// Enqueueing
+	int32_t queuedPosition[TMC_RAMP_MOTIONQUEUE_AXES]; // End position of the last queued segment
+} TMC_MotionQueue;
+
+void tmc_ramp_motionqueue_init(TMC_MotionQueue *queue, TMC_LinearRamp **axes, uint8_t count, uint32_t junctionJump);
+
+// Adds a linear move to targetPositions[axis]. The first segment after the queue ran empty
+// starts at the current rampPosition of the axes.
+// Returns false if the queue is full.
+bool tmc_ramp_motionqueue_enqueue(TMC_MotionQueue *queue, const int32_t *targetPositions, uint32_t maxVelocity, int32_t acceleration);
+void tmc_ramp_motionqueue_plan(TMC_MotionQueue *queue);
+void tmc_ramp_motionqueue_compute(TMC_MotionQueue *queue);
+
+bool tmc_ramp_motionqueue_is_empty(TMC_MotionQueue *queue);
+uint8_t tmc_ramp_motionqueue_get_free(TMC_MotionQueue *queue);
+int32_t tmc_ramp_motionqueue_get_positionDelta(TMC_MotionQueue *queue, uint8_t axis);
+
+#endif /* TMC_RAMP_MOTIONQUEUE_H_ */
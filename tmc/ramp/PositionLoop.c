@@ -0,0 +1,64 @@
+/*
+ * PositionLoop.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "PositionLoop.h"
+#include "tmc/helpers/Functions.h"
+
+void tmc_ramp_ploop_init(TMC_PositionLoop *loop, int32_t kp, int32_t ki, int32_t limit, uint16_t interval)
+{
+	loop->kp        = kp;
+	loop->ki        = ki;
+	loop->limit     = abs(limit);
+	loop->interval  = interval;
+	loop->tick      = 0;
+
+	tmc_ramp_ploop_reset(loop);
+}
+
+// Drop the correction, e.g. after homing or setting the ramp position
+void tmc_ramp_ploop_reset(TMC_PositionLoop *loop)
+{
+	loop->integral    = 0;
+	loop->error       = 0;
+	loop->correction  = 0;
+	loop->setpoint    = 0;
+	loop->cycles      = 0;
+	loop->transfers   = 0;
+}
+
+bool tmc_ramp_ploop_isDue(TMC_PositionLoop *loop, uint32_t tick)
+{
+	return (tick - loop->tick) >= loop->interval;
+}
+
+int32_t tmc_ramp_ploop_update(TMC_PositionLoop *loop, int32_t position, int32_t encoder, uint32_t tick)
+{
+	int64_t output;
+
+	loop->error = (position - loop->correction) - encoder;
+	loop->tick = tick;
+	loop->cycles++;
+
+	// Anti windup: the integral part alone never exceeds the limit
+	loop->integral += loop->error;
+	if(loop->ki)
+	{
+		int64_t integralLimit = ((int64_t) loop->limit << 16) / abs(loop->ki);
+		loop->integral = tmc_limitS64(loop->integral, -integralLimit, integralLimit);
+	}
+
+	output = tmc_math_mlal((int64_t) loop->ki * loop->integral, loop->kp, loop->error) / (1 << 16);
+	loop->correction = (int32_t) tmc_limitS64(output, -loop->limit, loop->limit);
+
+	return loop->correction;
+}
+
+void tmc_ramp_ploop_updateLinear(TMC_PositionLoop *loop, TMC_LinearRamp *linearRamp, int32_t target, int32_t encoder, uint32_t tick)
+{
+	loop->setpoint = target + tmc_ramp_ploop_update(loop, tmc_ramp_linear_get_rampPosition(linearRamp), encoder, tick);
+
+	tmc_ramp_linear_set_targetPosition(linearRamp, loop->setpoint);
+}
@@ -0,0 +1,57 @@
+/*
+ * PositionLoop.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_POSITIONLOOP_H_
+#define TMC_RAMP_POSITIONLOOP_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Closed loop position correction with an encoder.
+// The ramp (the internal one of a TMC5xxx, or a TMC_LinearRamp driving a step generator)
+// keeps planning the trajectory open loop. At a fixed rate, the loop compares the
+// commanded position with the encoder position and a PI controller computes a correction
+// in microsteps, which is added to the ramp target. Steps lost during aggressive moves are
+// then driven again, so the axis still ends on target.
+//
+// The commanded position excludes the correction already applied, the loop only sees
+// the position error of the mechanics: error = (rampPosition - correction) - encoderPosition.
+// The encoder has to be scaled to microsteps (ENC_CONST of the TMC5xxx).
+//
+// cycles counts the loop updates, transfers the datagrams they caused. Divide by the
+// elapsed time for the loop rate and the bus cost, with TMC_INSTRUMENTATION the transfers
+// are also counted per register.
+
+typedef struct
+{
+	int32_t kp;          // Proportional gain, Q16
+	int32_t ki;          // Integral gain per update, Q16
+	int32_t limit;       // Largest correction [microsteps]
+	uint16_t interval;   // Ticks between updates
+	uint32_t tick;       // Tick of the last update
+	int64_t integral;    // Sum of the errors, limited to keep ki * integral within limit
+	int32_t error;       // Error of the last update
+	int32_t correction;  // Current correction [microsteps]
+	int32_t setpoint;    // Target including the correction, as last applied to the ramp
+	uint32_t cycles;
+	uint32_t transfers;
+} TMC_PositionLoop;
+
+void tmc_ramp_ploop_init(TMC_PositionLoop *loop, int32_t kp, int32_t ki, int32_t limit, uint16_t interval);
+void tmc_ramp_ploop_reset(TMC_PositionLoop *loop);
+
+// Returns true if [interval] ticks passed since the last update
+bool tmc_ramp_ploop_isDue(TMC_PositionLoop *loop, uint32_t tick);
+
+// One controller update. [position]: ramp position including the correction, [encoder]: encoder position.
+// Returns the new correction.
+int32_t tmc_ramp_ploop_update(TMC_PositionLoop *loop, int32_t position, int32_t encoder, uint32_t tick);
+
+// Software ramp: Update with the position of [linearRamp] and move its target to [target] + correction
+void tmc_ramp_ploop_updateLinear(TMC_PositionLoop *loop, TMC_LinearRamp *linearRamp, int32_t target, int32_t encoder, uint32_t tick);
+
+#endif /* TMC_RAMP_POSITIONLOOP_H_ */
@@ -10,6 +10,9 @@
 void tmc_ramp_init(void *ramp, TMC_RampType type)
 {
 	switch(type) {
+	case TMC_RAMP_TYPE_SCURVE:
+		tmc_ramp_scurve_init((TMC_SCurveRamp *)ramp);
+		break;
 	case TMC_RAMP_TYPE_LINEAR:
 	default:
 		tmc_ramp_linear_init((TMC_LinearRamp *)ramp);
@@ -23,13 +26,16 @@ int32_t tmc_ramp_compute(void *ramp, TMC_RampType type, uint32_t delta)
 	int32_t dxSum = 0;
 
 	switch(type) {
-	case TMC_RAMP_TYPE_LINEAR:
-	default:
+	case TMC_RAMP_TYPE_SCURVE:
 		for (i = 0; i < delta; i++)
 		{
-			dxSum += tmc_ramp_linear_compute((TMC_LinearRamp *)ramp);
+			dxSum += tmc_ramp_scurve_compute((TMC_SCurveRamp *)ramp);
 		}
 		break;
+	case TMC_RAMP_TYPE_LINEAR:
+	default:
+		dxSum = tmc_ramp_linear_compute_ticks((TMC_LinearRamp *)ramp, delta);
+		break;
 	}
 
 	return dxSum;
@@ -42,6 +48,9 @@ int32_t tmc_ramp_get_rampVelocity(void *ramp, TMC_RampType type)
 	case TMC_RAMP_TYPE_LINEAR:
 		v = tmc_ramp_linear_get_rampVelocity((TMC_LinearRamp *)ramp);
 		break;
+	case TMC_RAMP_TYPE_SCURVE:
+		v = tmc_ramp_scurve_get_rampVelocity((TMC_SCurveRamp *)ramp);
+		break;
 	}
 	return v;
 }
@@ -53,6 +62,9 @@ int32_t tmc_ramp_get_rampPosition(void *ramp, TMC_RampType type)
 	case TMC_RAMP_TYPE_LINEAR:
 		x = tmc_ramp_linear_get_rampPosition((TMC_LinearRamp *)ramp);
 		break;
+	case TMC_RAMP_TYPE_SCURVE:
+		x = tmc_ramp_scurve_get_rampPosition((TMC_SCurveRamp *)ramp);
+		break;
 	}
 	return x;
 }
@@ -64,6 +76,9 @@ bool tmc_ramp_get_enabled(void *ramp, TMC_RampType type)
 	case TMC_RAMP_TYPE_LINEAR:
 		enabled = tmc_ramp_linear_get_enabled((TMC_LinearRamp *)ramp);
 		break;
+	case TMC_RAMP_TYPE_SCURVE:
+		enabled = tmc_ramp_scurve_get_enabled((TMC_SCurveRamp *)ramp);
+		break;
 	}
 	return enabled;
 }
@@ -71,6 +86,9 @@ bool tmc_ramp_get_enabled(void *ramp, TMC_RampType type)
 void tmc_ramp_set_enabled(void *ramp, TMC_RampType type, bool enabled)
 {
 	switch(type) {
+	case TMC_RAMP_TYPE_SCURVE:
+		tmc_ramp_scurve_set_enabled((TMC_SCurveRamp *)ramp, enabled);
+		break;
 	case TMC_RAMP_TYPE_LINEAR:
 	default:
 		tmc_ramp_linear_set_enabled((TMC_LinearRamp *)ramp, enabled);
@@ -80,10 +98,5 @@ void tmc_ramp_set_enabled(void *ramp, TMC_RampType type, bool enabled)
 
 void tmc_ramp_toggle_enabled(void *ramp, TMC_RampType type)
 {
-	switch(type) {
-	case TMC_RAMP_TYPE_LINEAR:
-	default:
-		tmc_ramp_linear_set_enabled((TMC_LinearRamp *)ramp, !tmc_ramp_get_enabled(ramp, type));
-		break;
-	}
+	tmc_ramp_set_enabled(ramp, type, !tmc_ramp_get_enabled(ramp, type));
 }
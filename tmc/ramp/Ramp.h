@@ -9,9 +9,11 @@
 #define TMC_RAMP_RAMP_H_
 
 #include "LinearRamp1.h"
+#include "SCurveRamp.h"
 
 typedef enum {
-	TMC_RAMP_TYPE_LINEAR
+	TMC_RAMP_TYPE_LINEAR,
+	TMC_RAMP_TYPE_SCURVE
 } TMC_RampType;
 
 // Initializes ramp parameters for given type
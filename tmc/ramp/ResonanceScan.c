@@ -0,0 +1,218 @@
+/*
+ * ResonanceScan.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "ResonanceScan.h"
+#include "tmc/helpers/Functions.h"
+
+#define Q30_ONE       ((int64_t)1 << 30)
+#define HALF_PI_Q30   1686629713
+
+// Time constant of the DC tracker: 2^OFFSET_SHIFT samples
+#define OFFSET_SHIFT  4
+
+// cos of [r] / 2^30 quarter turns (0 to pi/2), Q30
+static int64_t cosQuarter(int64_t r)
+{
+	int64_t x   = (r * HALF_PI_Q30) >> 30;
+	int64_t x2  = (x * x) >> 30;
+	int64_t c   = Q30_ONE;
+
+	// 1 - x^2/2! (1 - x^2/(3*4) (1 - x^2/(5*6) (1 - x^2/(7*8) (1 - x^2/(9*10)))))
+	c = Q30_ONE - ((x2 * c) >> 30) / 90;
+	c = Q30_ONE - ((x2 * c) >> 30) / 56;
+	c = Q30_ONE - ((x2 * c) >> 30) / 30;
+	c = Q30_ONE - ((x2 * c) >> 30) / 12;
+	c = Q30_ONE - ((x2 * c) >> 30) / 2;
+
+	return c;
+}
+
+// cos of [phase] / 2^32 turns, Q30
+static int64_t cosTurn(uint32_t phase)
+{
+	int64_t r = phase & 0x3FFFFFFF;
+
+	switch(phase >> 30)
+	{
+	case 0:  return  cosQuarter(r);
+	case 1:  return -cosQuarter(Q30_ONE - r);
+	case 2:  return -cosQuarter(r);
+	default: return  cosQuarter(Q30_ONE - r);
+	}
+}
+
+static uint32_t binFrequency(const TMCResonanceScan *scan, uint8_t bin)
+{
+	return scan->frequencyMin + bin * scan->frequencyStep;
+}
+
+void tmc_resonance_init(TMCResonanceScan *scan, uint32_t sampleRate, uint32_t frequencyMin, uint32_t frequencyMax, uint8_t bins, uint16_t samples)
+{
+	bins = MIN(MAX(bins, 1), TMC_RESONANCE_BINS);
+
+	scan->sampleRate     = sampleRate;
+	scan->frequencyMin   = frequencyMin;
+	scan->frequencyStep  = (bins > 1) ? (frequencyMax - frequencyMin) / (bins - 1) : 0;
+	scan->bins           = bins;
+	scan->samples        = MIN(samples, TMC_RESONANCE_MAX_SAMPLES);
+	scan->count          = 0;
+	scan->offset         = 0;
+
+	for(uint8_t i = 0; i < bins; i++)
+	{
+		// Phase per sample: f / fs turns
+		uint32_t phase = (sampleRate) ? (uint32_t) (((uint64_t) binFrequency(scan, i) << 32) / ((uint64_t) sampleRate * 1000)) : 0;
+
+		scan->coefficient[i] = (int32_t) MIN(2 * cosTurn(phase), INT32_MAX);
+		scan->s1[i] = 0;
+		scan->s2[i] = 0;
+	}
+}
+
+bool tmc_resonance_sample(TMCResonanceScan *scan, int32_t value)
+{
+	int64_t x;
+
+	if(scan->count >= scan->samples)
+		return true;
+
+	value = tmc_limitInt(value, INT16_MIN, INT16_MAX);
+
+	// Remove the DC part, it would leak into the low bins
+	if(scan->count == 0)
+		scan->offset = value << 8;
+	else
+		scan->offset += ((value << 8) - scan->offset) >> OFFSET_SHIFT;
+
+	x = value - (scan->offset >> 8);
+
+	for(uint8_t i = 0; i < scan->bins; i++)
+	{
+		int64_t s = x + ((scan->coefficient[i] * scan->s1[i]) >> 30) - scan->s2[i];
+		scan->s2[i] = scan->s1[i];
+		scan->s1[i] = s;
+	}
+
+	return (++scan->count >= scan->samples);
+}
+
+bool tmc_resonance_sampleLoadStream(TMCResonanceScan *scan, TMCLoadStream *stream, uint8_t axis)
+{
+	TMCLoadRecord record;
+	bool done = (scan->count >= scan->samples);
+
+	while(tmc_loadStream_pop(stream, &record))
+	{
+		if(record.axis == axis)
+			done = tmc_resonance_sample(scan, record.sg);
+	}
+
+	return done;
+}
+
+uint64_t tmc_resonance_power(const TMCResonanceScan *scan, uint8_t bin)
+{
+	int64_t s1 = scan->s1[bin];
+	int64_t s2 = scan->s2[bin];
+	int64_t power;
+
+	// |X|^2 = s1^2 + s2^2 - 2cos(w) * s1 * s2
+	power = s1 * s1 + s2 * s2 - s1 * ((scan->coefficient[bin] * s2) >> 30);
+
+	return (power > 0) ? (uint64_t) power : 0;
+}
+
+// Frequency (mHz) where the power crosses [level] between [inside] and the neighbouring bin [outside]
+static uint32_t crossing(const TMCResonanceScan *scan, uint8_t inside, uint8_t outside, uint64_t level)
+{
+	uint64_t pIn = tmc_resonance_power(scan, inside);
+	uint64_t pOut = tmc_resonance_power(scan, outside);
+	uint32_t fIn = binFrequency(scan, inside);
+	uint32_t fOut = binFrequency(scan, outside);
+	uint64_t fraction = (pIn > pOut) ? ((pIn - level) << 16) / (pIn - pOut) : 0;
+
+	if(fOut > fIn)
+		return fIn + (uint32_t) (((uint64_t) (fOut - fIn) * fraction) >> 16);
+
+	return fIn - (uint32_t) (((uint64_t) (fIn - fOut) * fraction) >> 16);
+}
+
+bool tmc_resonance_evaluate(const TMCResonanceScan *scan, TMCResonanceResult *result)
+{
+	uint8_t peak = 0;
+	uint64_t peakPower = 0;
+	int32_t lower = -1;
+	int32_t upper = -1;
+
+	if((scan->count < scan->samples) || (scan->count == 0))
+		return false;
+
+	for(uint8_t i = 0; i < scan->bins; i++)
+	{
+		uint64_t power = tmc_resonance_power(scan, i);
+		if(power > peakPower)
+		{
+			peakPower = power;
+			peak = i;
+		}
+	}
+
+	if(peakPower == 0)
+		return false;
+
+	result->frequency = binFrequency(scan, peak);
+	result->power = peakPower;
+
+	// Parabolic fit through the peak and its neighbours: offset = (p- - p+) / (2 * (p- - 2p + p+)) bins
+	if((peak > 0) && (peak + 1 < scan->bins))
+	{
+		int64_t pLow = tmc_resonance_power(scan, peak - 1) >> 16;
+		int64_t pHigh = tmc_resonance_power(scan, peak + 1) >> 16;
+		int64_t p = peakPower >> 16;
+		int64_t curvature = pLow - 2 * p + pHigh;
+
+		if(curvature < 0)
+		{
+			int64_t offset = ((pLow - pHigh) * (int64_t) scan->frequencyStep) / (2 * curvature);
+			result->frequency = (uint32_t) ((int64_t) result->frequency - offset);
+		}
+	}
+
+	// Half power bandwidth: d = (f2 - f1) / (2 * f)
+	for(int32_t i = peak; i > 0; i--)
+	{
+		if(tmc_resonance_power(scan, i - 1) < peakPower / 2)
+		{
+			lower = i - 1;
+			break;
+		}
+	}
+
+	for(int32_t i = peak; i + 1 < scan->bins; i++)
+	{
+		if(tmc_resonance_power(scan, i + 1) < peakPower / 2)
+		{
+			upper = i + 1;
+			break;
+		}
+	}
+
+	result->dampingValid = (lower >= 0) && (upper >= 0) && (result->frequency > 0);
+
+	if(result->dampingValid)
+	{
+		uint32_t f1 = crossing(scan, lower + 1, lower, peakPower / 2);
+		uint32_t f2 = crossing(scan, upper - 1, upper, peakPower / 2);
+
+		result->damping = (uint32_t) ((((uint64_t) (f2 - f1)) << 15) / result->frequency);
+	}
+	else
+	{
+		result->damping = TMC_RESONANCE_DEFAULT_DAMPING;
+	}
+
+	return true;
+}
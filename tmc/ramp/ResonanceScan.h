@@ -0,0 +1,75 @@
+/*
+ * ResonanceScan.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_RESONANCESCAN_H_
+#define TMC_RAMP_RESONANCESCAN_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "InputShaper.h"
+
+// Resonance identification for commissioning the input shaper.
+// Run a short excitation move on the axis (e.g. a fast back and forth move with the
+// highest acceleration intended for the axis) and sample the load at a fixed rate
+// while it moves and rings out: SG_RESULT from tmc5160_sampleLoad()/tmc2240_sampleLoad()
+// with a decimation of 1, fed with tmc_resonance_sampleLoadStream(), or the torque of
+// tmc4671_readTelemetry(), fed with tmc_resonance_sample().
+//
+// A bank of Goertzel filters measures the power of every frequency bin between the
+// configured limits. After the window, tmc_resonance_evaluate() picks the strongest bin,
+// refines it with a parabolic fit and estimates the damping from the half power bandwidth.
+// The result parameterises tmc_ramp_shaper_init(), tmc_ramp_shaper_get_maxAcceleration()
+// then gives the acceleration limit for an allowed shaping deviation.
+//
+// The bin spacing has to be finer than the resonance bandwidth, and the window longer than
+// sampleRate / binSpacing samples, otherwise the damping estimate only measures the bins.
+
+// Maximum amount of frequency bins
+#define TMC_RESONANCE_BINS 32
+
+// Maximum window length, keeps the filter states in 64 bit
+#define TMC_RESONANCE_MAX_SAMPLES 4096
+
+// Damping reported if the half power points lie outside the scanned range, Q16 (0.1)
+#define TMC_RESONANCE_DEFAULT_DAMPING 6554
+
+typedef struct
+{
+	uint32_t sampleRate;   // Hz
+	uint32_t frequencyMin; // mHz, first bin
+	uint32_t frequencyStep;// mHz between the bins
+	uint8_t bins;
+	uint16_t samples;      // Window length
+	uint16_t count;        // Samples taken
+	int32_t offset;        // DC tracker, Q8
+	int32_t coefficient[TMC_RESONANCE_BINS]; // 2 * cos(w), Q30
+	int64_t s1[TMC_RESONANCE_BINS];
+	int64_t s2[TMC_RESONANCE_BINS];
+} TMCResonanceScan;
+
+typedef struct
+{
+	uint32_t frequency;  // mHz
+	uint32_t damping;    // Q16
+	uint64_t power;      // Power of the strongest bin, relative
+	bool dampingValid;   // Both half power points were found
+} TMCResonanceResult;
+
+// Scan [bins] frequencies from [frequencyMin] to [frequencyMax] (mHz) over [samples] samples taken at [sampleRate] Hz
+void tmc_resonance_init(TMCResonanceScan *scan, uint32_t sampleRate, uint32_t frequencyMin, uint32_t frequencyMax, uint8_t bins, uint16_t samples);
+
+// Add one sample (-32768 to 32767). Returns true once the window is complete, further samples are ignored.
+bool tmc_resonance_sample(TMCResonanceScan *scan, int32_t value);
+
+// Add the SG_RESULT of all records of [axis] in [stream]. Records of other axes are dropped.
+bool tmc_resonance_sampleLoadStream(TMCResonanceScan *scan, TMCLoadStream *stream, uint8_t axis);
+
+uint64_t tmc_resonance_power(const TMCResonanceScan *scan, uint8_t bin);
+
+// Returns false if the window is not complete or no resonance was found
+bool tmc_resonance_evaluate(const TMCResonanceScan *scan, TMCResonanceResult *result);
+
+#endif /* TMC_RAMP_RESONANCESCAN_H_ */
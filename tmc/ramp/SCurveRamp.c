@@ -0,0 +1,426 @@
+/*
+ * SCurveRamp.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "SCurveRamp.h"
+#include "tmc/helpers/Functions.h"
+
+void tmc_ramp_scurve_init(TMC_SCurveRamp *scurveRamp)
+{
+	scurveRamp->maxVelocity             = 0;
+	scurveRamp->maxAcceleration         = 0;
+	scurveRamp->jerk                    = 0;
+	scurveRamp->targetPosition          = 0;
+	scurveRamp->rampPosition            = 0;
+	scurveRamp->targetVelocity          = 0;
+	scurveRamp->rampVelocity            = 0;
+	scurveRamp->rampAcceleration        = 0;
+	scurveRamp->rampEnabled             = true;
+	scurveRamp->accumulatorAcceleration = 0;
+	scurveRamp->accumulatorVelocity     = 0;
+	scurveRamp->accumulatorPosition     = 0;
+	scurveRamp->rampMode                = TMC_RAMP_SCURVE_MODE_VELOCITY;
+	scurveRamp->state                   = TMC_RAMP_SCURVE_STATE_IDLE;
+	scurveRamp->precision               = TMC_RAMP_SCURVE_DEFAULT_PRECISION;
+	scurveRamp->homingDistance          = TMC_RAMP_SCURVE_DEFAULT_HOMING_DISTANCE;
+	scurveRamp->stopVelocity            = TMC_RAMP_SCURVE_DEFAULT_STOP_VELOCITY;
+}
+
+int32_t tmc_ramp_scurve_compute(TMC_SCurveRamp *scurveRamp)
+{
+	tmc_ramp_scurve_compute_position(scurveRamp);
+	return tmc_ramp_scurve_compute_velocity(scurveRamp);
+}
+
+// Velocity change while reducing the acceleration [acceleration] to zero with the jerk limit
+static uint64_t rampDownVelocity(TMC_SCurveRamp *scurveRamp, uint32_t acceleration)
+{
+	return ((uint64_t) acceleration * acceleration) / (2 * (uint64_t) scurveRamp->jerk);
+}
+
+// Steps driven while reducing the current acceleration to zero.
+// Only relevant while the acceleration still increases the absolute velocity.
+static uint64_t rampDownSteps(TMC_SCurveRamp *scurveRamp)
+{
+	uint32_t acceleration;
+	uint64_t ticks, velocity;
+
+	if(scurveRamp->jerk == 0)
+		return 0;
+
+	if((scurveRamp->rampVelocity > 0) && (scurveRamp->rampAcceleration > 0))
+		acceleration = scurveRamp->rampAcceleration;
+	else if((scurveRamp->rampVelocity < 0) && (scurveRamp->rampAcceleration < 0))
+		acceleration = -scurveRamp->rampAcceleration;
+	else
+		return 0;
+
+	// Duration of the acceleration reduction and the mean velocity during it
+	ticks    = ((uint64_t) acceleration * scurveRamp->precision) / scurveRamp->jerk;
+	velocity = abs(scurveRamp->rampVelocity) + rampDownVelocity(scurveRamp, acceleration) * 2 / 3;
+
+	if((ticks > UINT32_MAX) || (velocity > UINT32_MAX))
+		return UINT32_MAX;
+
+	return (ticks * velocity) / scurveRamp->precision;
+}
+
+// Steps needed to stop from the current state
+static uint64_t brakingSteps(TMC_SCurveRamp *scurveRamp)
+{
+	uint64_t steps = rampDownSteps(scurveRamp);
+	uint64_t velocity = abs(scurveRamp->rampVelocity);
+	uint64_t acceleration = MIN(scurveRamp->maxAcceleration, INT32_MAX);
+	uint64_t jerk = scurveRamp->jerk;
+
+	if(acceleration == 0)
+		return UINT32_MAX;
+
+	// Velocity reached after reducing the acceleration to zero
+	if(steps != 0)
+		velocity += rampDownVelocity(scurveRamp, abs(scurveRamp->rampAcceleration));
+
+	if(velocity > INT32_MAX)
+		return UINT32_MAX;
+
+	// The velocity of the symmetric deceleration averages to half the start velocity.
+	// The precision cancels out of the stopping time and distance.
+	if(jerk == 0)
+	{	// No jerk limit - constant deceleration
+		steps += (velocity * velocity) / (2 * acceleration);
+	}
+	else if(velocity * jerk >= acceleration * acceleration)
+	{	// Deceleration reaches the acceleration limit
+		steps += ((velocity * velocity) / acceleration + (velocity * acceleration) / jerk) / 2;
+	}
+	else
+	{	// Deceleration peaks at sqrt(velocity * jerk)
+		steps += (velocity * tmc_sqrti64(velocity * jerk)) / jerk;
+	}
+
+	// + 1 to compensate rounding (flooring) errors of the position accumulator
+	return steps + 1;
+}
+
+// Jerk limited acceleration towards the target velocity
+// [direction]: sign of (targetVelocity - rampVelocity), [difference]: absolute value of it
+static int32_t jerkAcceleration(TMC_SCurveRamp *scurveRamp, int32_t direction, uint32_t difference)
+{
+	// Acceleration in direction of the target velocity
+	int32_t acceleration = direction * scurveRamp->rampAcceleration;
+	int32_t maxAcceleration = MIN(scurveRamp->maxAcceleration, INT32_MAX);
+	int32_t da;
+
+	// No jerk limit - apply the full acceleration directly
+	if(scurveRamp->jerk == 0)
+		return direction * maxAcceleration;
+
+	// Position mode: Stopping at and homing to the target position happens below the
+	// stop velocity. The jerk limit would make these overshoot, so it is skipped there.
+	if((scurveRamp->rampMode == TMC_RAMP_SCURVE_MODE_POSITION)
+	&& (abs(scurveRamp->rampVelocity) <= scurveRamp->stopVelocity)
+	&& (abs(scurveRamp->targetVelocity) <= scurveRamp->stopVelocity))
+	{
+		scurveRamp->accumulatorAcceleration = 0;
+		return direction * maxAcceleration;
+	}
+
+	// Calculate the acceleration delta value and keep the remainder of the acceleration accumulator
+	scurveRamp->accumulatorAcceleration += scurveRamp->jerk;
+	da = scurveRamp->accumulatorAcceleration / (int32_t) scurveRamp->precision;
+	scurveRamp->accumulatorAcceleration = scurveRamp->accumulatorAcceleration % (int32_t) scurveRamp->precision;
+
+	// Start reducing the acceleration early enough to hit the target velocity with zero acceleration
+	if((acceleration > 0) && (rampDownVelocity(scurveRamp, acceleration) >= difference))
+		acceleration = MAX(acceleration - da, 0);
+	else
+		acceleration = MIN(tmc_math_addSat32(acceleration, da), maxAcceleration);
+
+	return direction * acceleration;
+}
+
+int32_t tmc_ramp_scurve_compute_velocity(TMC_SCurveRamp *scurveRamp)
+{
+	if (scurveRamp->rampEnabled)
+	{
+		if(scurveRamp->rampVelocity != scurveRamp->targetVelocity)
+		{
+			int32_t direction = (scurveRamp->targetVelocity > scurveRamp->rampVelocity) ? 1 : -1;
+			uint32_t difference = (direction > 0)
+					? (uint32_t) scurveRamp->targetVelocity - (uint32_t) scurveRamp->rampVelocity
+					: (uint32_t) scurveRamp->rampVelocity - (uint32_t) scurveRamp->targetVelocity;
+
+			scurveRamp->rampAcceleration = jerkAcceleration(scurveRamp, direction, difference);
+		}
+
+		// Add current acceleration to accumulator
+		scurveRamp->accumulatorVelocity += scurveRamp->rampAcceleration;
+
+		// Calculate the velocity delta value and keep the remainder of the velocity accumulator
+		int32_t dv = scurveRamp->accumulatorVelocity / (int32_t) scurveRamp->precision;
+		scurveRamp->accumulatorVelocity = scurveRamp->accumulatorVelocity % (int32_t) scurveRamp->precision;
+
+		// Add dv to rampVelocity, and regulate to target velocity
+		if(scurveRamp->rampVelocity < scurveRamp->targetVelocity)
+			scurveRamp->rampVelocity = MIN(scurveRamp->rampVelocity + dv, scurveRamp->targetVelocity);
+		else if(scurveRamp->rampVelocity > scurveRamp->targetVelocity)
+			scurveRamp->rampVelocity = MAX(scurveRamp->rampVelocity + dv, scurveRamp->targetVelocity);
+
+		// Target velocity reached - stop accelerating
+		if(scurveRamp->rampVelocity == scurveRamp->targetVelocity)
+		{
+			scurveRamp->rampAcceleration = 0;
+			scurveRamp->accumulatorAcceleration = 0;
+		}
+	}
+	else
+	{
+		// use target velocity directly
+		scurveRamp->rampVelocity = scurveRamp->targetVelocity;
+		scurveRamp->rampAcceleration = 0;
+		// Reset accumulators
+		scurveRamp->accumulatorAcceleration = 0;
+		scurveRamp->accumulatorVelocity = 0;
+	}
+
+	// Calculate the position delta value and keep the remainder of the position accumulator
+	scurveRamp->accumulatorPosition += scurveRamp->rampVelocity;
+	int32_t dx = scurveRamp->accumulatorPosition / (int32_t) scurveRamp->precision;
+	scurveRamp->accumulatorPosition = scurveRamp->accumulatorPosition % (int32_t) scurveRamp->precision;
+
+	if(dx == 0)
+		return dx;
+
+	// Change actual position determined by position change
+	scurveRamp->rampPosition += (dx < 0) ? (-1) : (1);
+
+	return dx;
+}
+
+void tmc_ramp_scurve_compute_position(TMC_SCurveRamp *scurveRamp)
+{
+	if (!scurveRamp->rampEnabled)
+		return;
+
+	if (scurveRamp->rampMode != TMC_RAMP_SCURVE_MODE_POSITION)
+		return;
+
+	// Calculate steps needed to target
+	int32_t diffx = 0;
+
+	switch(scurveRamp->state) {
+	case TMC_RAMP_SCURVE_STATE_IDLE:
+		if(scurveRamp->rampPosition == scurveRamp->targetPosition)
+			break;
+
+		scurveRamp->state = TMC_RAMP_SCURVE_STATE_DRIVING;
+		break;
+	case TMC_RAMP_SCURVE_STATE_DRIVING:
+		// Calculate distance to target (positive = driving towards target)
+		if(scurveRamp->rampVelocity > 0)
+			diffx = scurveRamp->targetPosition - scurveRamp->rampPosition;
+		else if(scurveRamp->rampVelocity < 0)
+			diffx = -(scurveRamp->targetPosition - scurveRamp->rampPosition);
+		else
+			diffx = abs(scurveRamp->targetPosition - scurveRamp->rampPosition);
+
+		// Steps left required for braking?
+		// Unlike the linear ramp, the stopping distance is calculated from the current
+		// velocity and acceleration instead of counting the acceleration steps, since the
+		// velocity keeps increasing for a while after starting to brake.
+		if((int64_t) brakingSteps(scurveRamp) >= diffx)
+		{
+			scurveRamp->targetVelocity = 0;
+			scurveRamp->state = TMC_RAMP_SCURVE_STATE_BRAKING;
+		}
+		else
+		{	// Driving - apply VMAX (this also allows mid-ramp VMAX changes)
+			scurveRamp->targetVelocity = (scurveRamp->targetPosition > scurveRamp->rampPosition) ? scurveRamp->maxVelocity : -scurveRamp->maxVelocity;
+		}
+		break;
+	case TMC_RAMP_SCURVE_STATE_BRAKING:
+		if(scurveRamp->targetPosition == scurveRamp->rampPosition)
+		{
+			if(abs(scurveRamp->rampVelocity) <= scurveRamp->stopVelocity)
+			{	// Position reached, velocity within cutoff threshold (or zero)
+				scurveRamp->rampVelocity = 0;
+				scurveRamp->targetVelocity = 0;
+				scurveRamp->rampAcceleration = 0;
+				scurveRamp->accumulatorAcceleration = 0;
+				scurveRamp->state = TMC_RAMP_SCURVE_STATE_IDLE;
+			}
+			else
+			{
+				// We're still too fast, we're going to miss the target position
+				// Let the deceleration continue until velocity is zero, then either
+				// home when within homing distance or start a new ramp (RAMP_DRIVING)
+				// towards the target.
+			}
+		}
+		else
+		{	// We're not at the target position
+			if(scurveRamp->rampVelocity != 0)
+			{	// Still decelerating
+
+				// Calculate distance to target (positive = driving towards target)
+				if(scurveRamp->rampVelocity > 0)
+					diffx = scurveRamp->targetPosition - scurveRamp->rampPosition;
+				else
+					diffx = -(scurveRamp->targetPosition - scurveRamp->rampPosition);
+
+				// Enough space to accelerate again?
+				// (Only once the acceleration has been reduced, otherwise the state toggles
+				// right after starting to brake)
+				if((rampDownSteps(scurveRamp) == 0) && ((int64_t) brakingSteps(scurveRamp) < diffx))
+				{
+					scurveRamp->state = TMC_RAMP_SCURVE_STATE_DRIVING;
+				}
+			}
+			else
+			{	// Standing still (not at the target position)
+				if(abs(scurveRamp->targetPosition - scurveRamp->rampPosition) <= scurveRamp->homingDistance)
+				{	// Within homing distance - drive with stop velocity
+					scurveRamp->targetVelocity = (scurveRamp->targetPosition > scurveRamp->rampPosition)? scurveRamp->stopVelocity : -scurveRamp->stopVelocity;
+				}
+				else
+				{	// Not within homing distance - start a new motion by switching to RAMP_IDLE
+					// Since (targetPosition != actualPosition) a new ramp will be started.
+					scurveRamp->state = TMC_RAMP_SCURVE_STATE_IDLE;
+				}
+			}
+		}
+		break;
+	}
+}
+
+void tmc_ramp_scurve_set_enabled(TMC_SCurveRamp *scurveRamp, bool enabled)
+{
+	scurveRamp->rampEnabled = enabled;
+}
+
+void tmc_ramp_scurve_set_maxVelocity(TMC_SCurveRamp *scurveRamp, uint32_t maxVelocity)
+{
+	scurveRamp->maxVelocity = maxVelocity;
+}
+
+void tmc_ramp_scurve_set_targetPosition(TMC_SCurveRamp *scurveRamp, int32_t targetPosition)
+{
+	scurveRamp->targetPosition = targetPosition;
+}
+
+void tmc_ramp_scurve_set_rampPosition(TMC_SCurveRamp *scurveRamp, int32_t rampPosition)
+{
+	scurveRamp->rampPosition = rampPosition;
+}
+
+void tmc_ramp_scurve_set_targetVelocity(TMC_SCurveRamp *scurveRamp, int32_t targetVelocity)
+{
+	scurveRamp->targetVelocity = targetVelocity;
+}
+
+void tmc_ramp_scurve_set_rampVelocity(TMC_SCurveRamp *scurveRamp, int32_t rampVelocity)
+{
+	scurveRamp->rampVelocity = rampVelocity;
+}
+
+void tmc_ramp_scurve_set_acceleration(TMC_SCurveRamp *scurveRamp, uint32_t maxAcceleration)
+{
+	scurveRamp->maxAcceleration = maxAcceleration;
+}
+
+void tmc_ramp_scurve_set_jerk(TMC_SCurveRamp *scurveRamp, uint32_t jerk)
+{
+	scurveRamp->jerk = jerk;
+}
+
+void tmc_ramp_scurve_set_mode(TMC_SCurveRamp *scurveRamp, TMC_SCurveRamp_Mode mode)
+{
+	scurveRamp->rampMode = mode;
+}
+
+void tmc_ramp_scurve_set_precision(TMC_SCurveRamp *scurveRamp, uint32_t precision)
+{
+	scurveRamp->precision = precision;
+}
+
+void tmc_ramp_scurve_set_homingDistance(TMC_SCurveRamp *scurveRamp, uint32_t homingDistance)
+{
+	scurveRamp->homingDistance = homingDistance;
+}
+
+void tmc_ramp_scurve_set_stopVelocity(TMC_SCurveRamp *scurveRamp, uint32_t stopVelocity)
+{
+	scurveRamp->stopVelocity = stopVelocity;
+}
+
+bool tmc_ramp_scurve_get_enabled(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->rampEnabled;
+}
+
+uint32_t tmc_ramp_scurve_get_maxVelocity(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->maxVelocity;
+}
+
+int32_t tmc_ramp_scurve_get_targetPosition(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->targetPosition;
+}
+
+int32_t tmc_ramp_scurve_get_rampPosition(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->rampPosition;
+}
+
+int32_t tmc_ramp_scurve_get_targetVelocity(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->targetVelocity;
+}
+
+int32_t tmc_ramp_scurve_get_rampVelocity(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->rampVelocity;
+}
+
+int32_t tmc_ramp_scurve_get_rampAcceleration(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->rampAcceleration;
+}
+
+uint32_t tmc_ramp_scurve_get_acceleration(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->maxAcceleration;
+}
+
+uint32_t tmc_ramp_scurve_get_jerk(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->jerk;
+}
+
+TMC_SCurveRamp_State tmc_ramp_scurve_get_state(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->state;
+}
+
+TMC_SCurveRamp_Mode tmc_ramp_scurve_get_mode(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->rampMode;
+}
+
+uint32_t tmc_ramp_scurve_get_precision(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->precision;
+}
+
+uint32_t tmc_ramp_scurve_get_homingDistance(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->homingDistance;
+}
+
+uint32_t tmc_ramp_scurve_get_stopVelocity(TMC_SCurveRamp *scurveRamp)
+{
+	return scurveRamp->stopVelocity;
+}
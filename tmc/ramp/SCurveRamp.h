@@ -0,0 +1,93 @@
+/*
+ * SCurveRamp.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_SCURVERAMP_H_
+#define TMC_RAMP_SCURVERAMP_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "Ramp.h"
+
+// Jerk limited ramp generator. Uses the same fixed-point scheme as TMC_LinearRamp:
+// The acceleration changes by jerk/precision per tick, the velocity by
+// acceleration/precision per tick and the position by velocity/precision per tick.
+// A jerk of 0 disables the jerk limit, the ramp then behaves like a linear ramp.
+
+// Default precision of the calculations, see TMC_RAMP_LINEAR_DEFAULT_PRECISION
+#define TMC_RAMP_SCURVE_DEFAULT_PRECISION ((uint32_t)1<<17)
+
+// Position mode: When hitting the target position a velocity below the V_STOP threshold will be cut off to velocity 0
+#define TMC_RAMP_SCURVE_DEFAULT_HOMING_DISTANCE 5
+
+// Position mode: When barely missing the target position by HOMING_DISTANCE or less, the remainder will be driven with V_STOP velocity
+#define TMC_RAMP_SCURVE_DEFAULT_STOP_VELOCITY 5
+
+typedef enum {
+	TMC_RAMP_SCURVE_MODE_VELOCITY,
+	TMC_RAMP_SCURVE_MODE_POSITION
+} TMC_SCurveRamp_Mode;
+
+typedef enum {
+	TMC_RAMP_SCURVE_STATE_IDLE,
+	TMC_RAMP_SCURVE_STATE_DRIVING,
+	TMC_RAMP_SCURVE_STATE_BRAKING
+} TMC_SCurveRamp_State;
+
+typedef struct
+{
+	uint32_t maxVelocity;
+	uint32_t maxAcceleration;
+	uint32_t jerk;
+	int32_t targetPosition;
+	int32_t rampPosition;
+	int32_t targetVelocity;
+	int32_t rampVelocity;
+	int32_t rampAcceleration;
+	bool rampEnabled;
+	int32_t accumulatorAcceleration;
+	int32_t accumulatorVelocity;
+	int32_t accumulatorPosition;
+	TMC_SCurveRamp_Mode rampMode;
+	TMC_SCurveRamp_State state;
+	uint32_t precision;
+	uint32_t homingDistance;
+	uint32_t stopVelocity;
+} TMC_SCurveRamp;
+
+void tmc_ramp_scurve_init(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_compute(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_compute_velocity(TMC_SCurveRamp *scurveRamp);
+void tmc_ramp_scurve_compute_position(TMC_SCurveRamp *scurveRamp);
+
+void tmc_ramp_scurve_set_enabled(TMC_SCurveRamp *scurveRamp, bool enabled);
+void tmc_ramp_scurve_set_maxVelocity(TMC_SCurveRamp *scurveRamp, uint32_t maxVelocity);
+void tmc_ramp_scurve_set_targetPosition(TMC_SCurveRamp *scurveRamp, int32_t targetPosition);
+void tmc_ramp_scurve_set_rampPosition(TMC_SCurveRamp *scurveRamp, int32_t rampPosition);
+void tmc_ramp_scurve_set_targetVelocity(TMC_SCurveRamp *scurveRamp, int32_t targetVelocity);
+void tmc_ramp_scurve_set_rampVelocity(TMC_SCurveRamp *scurveRamp, int32_t rampVelocity);
+void tmc_ramp_scurve_set_acceleration(TMC_SCurveRamp *scurveRamp, uint32_t maxAcceleration);
+void tmc_ramp_scurve_set_jerk(TMC_SCurveRamp *scurveRamp, uint32_t jerk);
+void tmc_ramp_scurve_set_mode(TMC_SCurveRamp *scurveRamp, TMC_SCurveRamp_Mode mode);
+void tmc_ramp_scurve_set_precision(TMC_SCurveRamp *scurveRamp, uint32_t precision);
+void tmc_ramp_scurve_set_homingDistance(TMC_SCurveRamp *scurveRamp, uint32_t homingDistance);
+void tmc_ramp_scurve_set_stopVelocity(TMC_SCurveRamp *scurveRamp, uint32_t stopVelocity);
+
+bool tmc_ramp_scurve_get_enabled(TMC_SCurveRamp *scurveRamp);
+uint32_t tmc_ramp_scurve_get_maxVelocity(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_get_targetPosition(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_get_rampPosition(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_get_targetVelocity(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_get_rampVelocity(TMC_SCurveRamp *scurveRamp);
+int32_t tmc_ramp_scurve_get_rampAcceleration(TMC_SCurveRamp *scurveRamp);
+uint32_t tmc_ramp_scurve_get_acceleration(TMC_SCurveRamp *scurveRamp);
+uint32_t tmc_ramp_scurve_get_jerk(TMC_SCurveRamp *scurveRamp);
+TMC_SCurveRamp_State tmc_ramp_scurve_get_state(TMC_SCurveRamp *scurveRamp);
+TMC_SCurveRamp_Mode tmc_ramp_scurve_get_mode(TMC_SCurveRamp *scurveRamp);
+uint32_t tmc_ramp_scurve_get_precision(TMC_SCurveRamp *scurveRamp);
+uint32_t tmc_ramp_scurve_get_homingDistance(TMC_SCurveRamp *scurveRamp);
+uint32_t tmc_ramp_scurve_get_stopVelocity(TMC_SCurveRamp *scurveRamp);
+
+#endif /* TMC_RAMP_SCURVERAMP_H_ */
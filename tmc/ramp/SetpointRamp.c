@@ -0,0 +1,139 @@
+/*
+ * SetpointRamp.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "SetpointRamp.h"
+
+void tmc_ramp_setpoint_init(TMC_SetpointRamp *ramp, TMC_SetpointRamp_Mode mode, int32_t acceleration, uint32_t maxVelocity, uint16_t interval)
+{
+	tmc_ramp_linear_init(&ramp->ramp);
+	tmc_ramp_linear_set_mode(&ramp->ramp, TMC_RAMP_LINEAR_MODE_VELOCITY);
+	tmc_ramp_linear_set_precision(&ramp->ramp, TMC_RAMP_SETPOINT_PRECISION);
+
+	ramp->mode      = mode;
+	ramp->interval  = interval;
+	ramp->tick      = 0;
+
+	tmc_ramp_setpoint_set_acceleration(ramp, acceleration);
+	tmc_ramp_setpoint_set_maxVelocity(ramp, maxVelocity);
+	tmc_ramp_setpoint_set_setpoint(ramp, 0);
+}
+
+void tmc_ramp_setpoint_set_setpoint(TMC_SetpointRamp *ramp, int32_t setpoint)
+{
+	int32_t velocity = (ramp->mode == TMC_RAMP_SETPOINT_POSITION) ? 0 : setpoint;
+
+	ramp->setpoint  = setpoint;
+	ramp->target    = setpoint;
+
+	ramp->ramp.targetVelocity       = velocity;
+	ramp->ramp.rampVelocity         = velocity;
+	ramp->ramp.accumulatorVelocity  = 0;
+	ramp->ramp.accumulatorPosition  = 0;
+}
+
+void tmc_ramp_setpoint_set_target(TMC_SetpointRamp *ramp, int32_t target)
+{
+	ramp->target = target;
+
+	// Position mode selects the velocity in tmc_ramp_setpoint_compute()
+	if(ramp->mode != TMC_RAMP_SETPOINT_POSITION)
+		ramp->ramp.targetVelocity = target;
+}
+
+// An acceleration of 0 disables the ramp: the setpoint follows the target directly (torque, velocity)
+// or moves with maxVelocity (position).
+void tmc_ramp_setpoint_set_acceleration(TMC_SetpointRamp *ramp, int32_t acceleration)
+{
+	tmc_ramp_linear_set_acceleration(&ramp->ramp, abs(acceleration));
+	tmc_ramp_linear_set_enabled(&ramp->ramp, acceleration != 0);
+}
+
+void tmc_ramp_setpoint_set_maxVelocity(TMC_SetpointRamp *ramp, uint32_t maxVelocity)
+{
+	tmc_ramp_linear_set_maxVelocity(&ramp->ramp, MIN(maxVelocity, (uint32_t) INT32_MAX));
+}
+
+int32_t tmc_ramp_setpoint_get_setpoint(TMC_SetpointRamp *ramp)
+{
+	return ramp->setpoint;
+}
+
+int32_t tmc_ramp_setpoint_get_target(TMC_SetpointRamp *ramp)
+{
+	return ramp->target;
+}
+
+bool tmc_ramp_setpoint_isDone(TMC_SetpointRamp *ramp)
+{
+	if(ramp->mode == TMC_RAMP_SETPOINT_POSITION)
+		return (ramp->setpoint == ramp->target) && (ramp->ramp.rampVelocity == 0);
+
+	return ramp->setpoint == ramp->target;
+}
+
+bool tmc_ramp_setpoint_isDue(TMC_SetpointRamp *ramp, uint32_t tick)
+{
+	return (tick - ramp->tick) >= ramp->interval;
+}
+
+static void computePosition(TMC_SetpointRamp *ramp)
+{
+	TMC_LinearRamp *linearRamp = &ramp->ramp;
+	int64_t remaining = (int64_t) ramp->target - ramp->setpoint;
+	int64_t velocity = linearRamp->rampVelocity;
+	int64_t braking = 0;
+	int32_t dx;
+
+	if((remaining == 0) && (velocity == 0))
+		return;
+
+	// Both velocity and acceleration carry the precision, it cancels out of v^2 / 2a
+	if(linearRamp->rampEnabled && (linearRamp->acceleration > 0))
+		braking = (velocity * velocity) / (2 * (int64_t) linearRamp->acceleration);
+
+	// Brake when moving towards the target and within the braking distance,
+	// otherwise drive (or turn around) towards the target
+	if(((velocity > 0) && (remaining > 0) && (remaining <= braking))
+	|| ((velocity < 0) && (remaining < 0) && (-remaining <= braking)))
+		linearRamp->targetVelocity = 0;
+	else
+		linearRamp->targetVelocity = (remaining > 0) ? (int32_t) linearRamp->maxVelocity : -(int32_t) linearRamp->maxVelocity;
+
+	dx = tmc_ramp_linear_compute_velocity(linearRamp);
+
+	// Reaching or passing the target ends the move. This also catches the rounding
+	// of the braking distance and velocities too small to move further.
+	if(((remaining >= 0) && (dx >= remaining)) || ((remaining <= 0) && (dx <= remaining)))
+	{
+		ramp->setpoint = ramp->target;
+		linearRamp->targetVelocity       = 0;
+		linearRamp->rampVelocity         = 0;
+		linearRamp->accumulatorVelocity  = 0;
+		linearRamp->accumulatorPosition  = 0;
+		return;
+	}
+
+	ramp->setpoint += dx;
+}
+
+bool tmc_ramp_setpoint_compute(TMC_SetpointRamp *ramp, uint32_t tick)
+{
+	int32_t previous = ramp->setpoint;
+
+	ramp->tick = tick;
+
+	if(ramp->mode == TMC_RAMP_SETPOINT_POSITION)
+	{
+		computePosition(ramp);
+	}
+	else
+	{
+		tmc_ramp_linear_compute_velocity(&ramp->ramp);
+		ramp->setpoint = ramp->ramp.rampVelocity;
+	}
+
+	return ramp->setpoint != previous;
+}
@@ -0,0 +1,62 @@
+/*
+ * SetpointRamp.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_SETPOINTRAMP_H_
+#define TMC_RAMP_SETPOINTRAMP_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// MCU side ramp for the setpoints of servo controllers (TMC4670, TMC4671).
+// Instead of stepping PID_TORQUE_FLUX_TARGET, PID_VELOCITY_TARGET or PID_POSITION_TARGET
+// straight to a new target, the driver writes the intermediate setpoints of this ramp
+// at a fixed rate, so the loops can be tuned without current spikes on setpoint steps.
+//
+// Torque and velocity: The setpoint slews towards the target by acceleration / 2^8 per update
+// (a TMC_LinearRamp in velocity mode, its rampVelocity is the setpoint).
+// Position: Trapezoidal move with up to maxVelocity / 2^8 units per update and acceleration / 2^16
+// units per update^2. The velocity is braked to reach the target without overshoot.
+
+// Precision of the underlying TMC_LinearRamp, see the units above.
+// Not applied when TMC_RAMP_LINEAR_PRECISION_SHIFT fixes the precision of all linear ramps.
+#define TMC_RAMP_SETPOINT_PRECISION ((uint32_t)1<<8)
+
+typedef enum {
+	TMC_RAMP_SETPOINT_TORQUE,
+	TMC_RAMP_SETPOINT_VELOCITY,
+	TMC_RAMP_SETPOINT_POSITION
+} TMC_SetpointRamp_Mode;
+
+typedef struct
+{
+	TMC_LinearRamp ramp;         // Velocity mode, rampVelocity is the setpoint (torque, velocity) or the move velocity (position)
+	TMC_SetpointRamp_Mode mode;
+	int32_t target;
+	int32_t setpoint;            // Last computed setpoint
+	uint16_t interval;           // Ticks between updates
+	uint32_t tick;               // Tick of the last update
+} TMC_SetpointRamp;
+
+void tmc_ramp_setpoint_init(TMC_SetpointRamp *ramp, TMC_SetpointRamp_Mode mode, int32_t acceleration, uint32_t maxVelocity, uint16_t interval);
+
+// Start the ramp from [setpoint] without moving, e.g. with the actual value when taking over a running motor
+void tmc_ramp_setpoint_set_setpoint(TMC_SetpointRamp *ramp, int32_t setpoint);
+void tmc_ramp_setpoint_set_target(TMC_SetpointRamp *ramp, int32_t target);
+void tmc_ramp_setpoint_set_acceleration(TMC_SetpointRamp *ramp, int32_t acceleration);
+void tmc_ramp_setpoint_set_maxVelocity(TMC_SetpointRamp *ramp, uint32_t maxVelocity);
+
+int32_t tmc_ramp_setpoint_get_setpoint(TMC_SetpointRamp *ramp);
+int32_t tmc_ramp_setpoint_get_target(TMC_SetpointRamp *ramp);
+bool tmc_ramp_setpoint_isDone(TMC_SetpointRamp *ramp);
+
+// Returns true if [interval] ticks passed since the last update
+bool tmc_ramp_setpoint_isDue(TMC_SetpointRamp *ramp, uint32_t tick);
+
+// One ramp update. Returns true if the setpoint changed and has to be written.
+bool tmc_ramp_setpoint_compute(TMC_SetpointRamp *ramp, uint32_t tick);
+
+#endif /* TMC_RAMP_SETPOINTRAMP_H_ */
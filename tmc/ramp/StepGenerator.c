@@ -0,0 +1,145 @@
+/*
+ * StepGenerator.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "StepGenerator.h"
+#include "tmc/helpers/Functions.h"
+
+void tmc_ramp_stepgen_init(TMC_StepGenerator *generator, TMC_LinearRamp **axes, uint8_t count,
+		uint32_t timerFrequency, uint32_t rampFrequency, const TMC_StepGeneratorPort *port, uint8_t channel)
+{
+	uint8_t i;
+
+	generator->count           = MIN(count, TMC_RAMP_STEPGEN_AXES);
+	generator->timerFrequency  = timerFrequency;
+	generator->rampFrequency   = rampFrequency;
+	generator->tickPeriod      = timerFrequency / rampFrequency;
+	generator->port            = port;
+	generator->channel         = channel;
+	generator->next            = 0;
+
+	for(i = 0; i < TMC_RAMP_STEPGEN_AXES; i++)
+	{
+		generator->axes[i]      = (i < generator->count) ? axes[i] : NULL;
+		generator->position[i]  = (i < generator->count) ? axes[i]->rampPosition : 0;
+	}
+}
+
+bool tmc_ramp_stepgen_fill(TMC_StepGenerator *generator, TMC_StepBuffer *buffer)
+{
+	uint32_t distance[TMC_RAMP_STEPGEN_AXES];
+	uint32_t error[TMC_RAMP_STEPGEN_AXES];
+	uint32_t steps = 0;
+	uint32_t remainder = 0;
+	bool complete = true;
+	uint8_t i;
+	uint16_t pulse;
+
+	buffer->directionMask = 0;
+
+	for(i = 0; i < generator->count; i++)
+	{
+		int32_t delta = generator->axes[i]->rampPosition - generator->position[i];
+
+		if(delta < 0)
+			buffer->directionMask |= 1 << i;
+
+		distance[i] = (delta < 0) ? -delta : delta;
+		steps = MAX(steps, distance[i]);
+	}
+
+	// More steps than pulses - output as many as fit, carry over the rest
+	if(steps > TMC_RAMP_STEPGEN_BUFFER_SIZE)
+	{
+		for(i = 0; i < generator->count; i++)
+			distance[i] = ((uint64_t) distance[i] * TMC_RAMP_STEPGEN_BUFFER_SIZE) / steps;
+
+		steps = TMC_RAMP_STEPGEN_BUFFER_SIZE;
+		complete = false;
+	}
+
+	// No steps - wait for one tick
+	if(steps == 0)
+	{
+		buffer->count        = 1;
+		buffer->period[0]    = generator->tickPeriod;
+		buffer->stepMask[0]  = 0;
+		return true;
+	}
+
+	// Round the axis steps to the nearest pulse of the longest axis
+	for(i = 0; i < generator->count; i++)
+		error[i] = steps / 2;
+
+	for(pulse = 0; pulse < steps; pulse++)
+	{
+		uint8_t mask = 0;
+
+		// Spread the tick evenly, the periods add up to exactly one tick
+		remainder += generator->tickPeriod;
+		buffer->period[pulse] = remainder / steps;
+		remainder %= steps;
+
+		for(i = 0; i < generator->count; i++)
+		{
+			error[i] += distance[i];
+			if(error[i] >= steps)
+			{
+				error[i] -= steps;
+				mask |= 1 << i;
+			}
+		}
+
+		buffer->stepMask[pulse] = mask;
+	}
+
+	buffer->count = steps;
+
+	for(i = 0; i < generator->count; i++)
+	{
+		if(buffer->directionMask & (1 << i))
+			generator->position[i] -= distance[i];
+		else
+			generator->position[i] += distance[i];
+	}
+
+	return complete;
+}
+
+bool tmc_ramp_stepgen_service(TMC_StepGenerator *generator)
+{
+	TMC_StepBuffer *buffer = &generator->buffers[generator->next];
+	bool complete = tmc_ramp_stepgen_fill(generator, buffer);
+
+	generator->port->submit(generator->channel, buffer);
+	generator->next ^= 1;
+
+	return complete;
+}
+
+uint32_t tmc_ramp_stepgen_period(TMC_StepGenerator *generator, int32_t velocity, uint32_t precision)
+{
+	uint64_t stepRate; // Steps per second in 1/precision
+
+	if(velocity == 0)
+		return 0;
+
+	stepRate = (uint64_t) abs(velocity) * generator->rampFrequency;
+
+	return MIN(((uint64_t) generator->timerFrequency * precision) / stepRate, UINT32_MAX);
+}
+
+void tmc_ramp_stepgen_sync(TMC_StepGenerator *generator)
+{
+	uint8_t i;
+
+	for(i = 0; i < generator->count; i++)
+		generator->position[i] = generator->axes[i]->rampPosition;
+}
+
+int32_t tmc_ramp_stepgen_get_lag(TMC_StepGenerator *generator, uint8_t axis)
+{
+	return generator->axes[axis]->rampPosition - generator->position[axis];
+}
@@ -0,0 +1,92 @@
+/*
+ * StepGenerator.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_STEPGENERATOR_H_
+#define TMC_RAMP_STEPGENERATOR_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Step pulse generation for STEP/DIR drivers (e.g. TMC2209, TMC2226, TMC2130, TMC2160).
+// Turns the positions of software ramps into timer driven step pulses: After every ramp
+// computation, the steps the axes moved during that tick are spread evenly over the tick as a
+// list of timer periods. Multiple axes are coordinated with Bresenham: The axis with the most
+// steps sets the periods, the other axes step at the nearest of its pulses.
+//
+// The list is meant to be sent by DMA, e.g. one stream reloading the timer period register at
+// every update event and one stream writing the step pins. That results in one interrupt per
+// ramp tick instead of one per step. A buffer holds TMC_RAMP_STEPGEN_BUFFER_SIZE pulses per
+// tick, steps beyond that are carried over to the following ticks - with a 1 kHz ramp tick the
+// default allows 64 kHz per axis, larger buffers allow step rates of several 100 kHz.
+//
+// Usage:
+// - Compute the ramps (or a TMC_MotionQueue) once per tick, at the rate given as rampFrequency.
+// - Call tmc_ramp_stepgen_service() right after. It fills the next of the two buffers and hands
+//   it to the port, which starts it when the currently running buffer finished.
+// For a single axis without DMA, tmc_ramp_stepgen_period() converts a ramp velocity into a
+// timer period that can be loaded once per tick instead.
+
+// Maximum amount of pulses per ramp tick
+#ifndef TMC_RAMP_STEPGEN_BUFFER_SIZE
+#define TMC_RAMP_STEPGEN_BUFFER_SIZE 64
+#endif
+
+// Maximum amount of axes
+#define TMC_RAMP_STEPGEN_AXES 4
+
+typedef struct
+{
+	uint16_t count;                                   // Used entries, at least 1
+	uint8_t directionMask;                            // Bit N set: Axis N moves in negative direction
+	uint32_t period[TMC_RAMP_STEPGEN_BUFFER_SIZE];    // Timer counts before each entry
+	uint8_t stepMask[TMC_RAMP_STEPGEN_BUFFER_SIZE];   // Bit N set: Axis N steps at the end of the period
+} TMC_StepBuffer;
+
+// Timer and DMA access of the application
+typedef struct
+{
+	// Queue [buffer] to be output once the running buffer finished. Set the direction
+	// pins to buffer->directionMask when switching to it, before its first period ends.
+	// The generator does not touch the buffer again until the next but one service call.
+	void (*submit)(uint8_t channel, const TMC_StepBuffer *buffer);
+} TMC_StepGeneratorPort;
+
+typedef struct
+{
+	uint8_t count;
+	TMC_LinearRamp *axes[TMC_RAMP_STEPGEN_AXES];
+	int32_t position[TMC_RAMP_STEPGEN_AXES];   // Position handed out as steps
+	uint32_t timerFrequency;                   // Timer clock in Hz
+	uint32_t rampFrequency;                    // Ramp computations per second
+	uint32_t tickPeriod;                       // Timer counts per ramp tick
+
+	const TMC_StepGeneratorPort *port;
+	uint8_t channel;
+	TMC_StepBuffer buffers[2];
+	uint8_t next;                              // Buffer filled by the next service call
+} TMC_StepGenerator;
+
+void tmc_ramp_stepgen_init(TMC_StepGenerator *generator, TMC_LinearRamp **axes, uint8_t count,
+		uint32_t timerFrequency, uint32_t rampFrequency, const TMC_StepGeneratorPort *port, uint8_t channel);
+
+// Fill [buffer] with the pulses of one ramp tick. Returns false if the buffer was too small,
+// the remaining steps are output with the following ticks then.
+bool tmc_ramp_stepgen_fill(TMC_StepGenerator *generator, TMC_StepBuffer *buffer);
+bool tmc_ramp_stepgen_service(TMC_StepGenerator *generator);
+
+// Timer counts per step for [velocity] of a ramp with [precision] that is computed at rampFrequency.
+// Returns 0 for a velocity of 0.
+uint32_t tmc_ramp_stepgen_period(TMC_StepGenerator *generator, int32_t velocity, uint32_t precision);
+
+// Continue from the current ramp positions, dropping steps not handed out yet.
+// Needed after the ramp positions were rescaled, see TMC_MicrostepScaling.
+void tmc_ramp_stepgen_sync(TMC_StepGenerator *generator);
+
+// Difference between the ramp positions and the positions handed out as steps
+int32_t tmc_ramp_stepgen_get_lag(TMC_StepGenerator *generator, uint8_t axis);
+
+#endif /* TMC_RAMP_STEPGENERATOR_H_ */
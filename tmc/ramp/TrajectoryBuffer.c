@@ -0,0 +1,147 @@
+/*
+ * TrajectoryBuffer.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#include "TrajectoryBuffer.h"
+
+#define TRAJECTORY_MASK (TMC_RAMP_TRAJECTORY_SIZE - 1)
+
+static void saveCheckpoint(TMC_TrajectoryBuffer *buffer, uint32_t index)
+{
+	if(buffer->type == TMC_RAMP_TYPE_SCURVE)
+		buffer->checkpoint.scurve = *(TMC_SCurveRamp *) buffer->ramp;
+	else
+		buffer->checkpoint.linear = *(TMC_LinearRamp *) buffer->ramp;
+
+	buffer->checkpointIndex = index;
+}
+
+// Advance the checkpoint to the state before the sample [index]
+static void replayCheckpoint(TMC_TrajectoryBuffer *buffer, uint32_t index)
+{
+	while((int32_t) (index - buffer->checkpointIndex) > 0)
+	{
+		tmc_ramp_compute(&buffer->checkpoint, buffer->type, 1);
+		buffer->checkpointIndex++;
+	}
+}
+
+// Continue the ramp from the checkpoint, keeping its (new) targets and limits
+static void resumeFromCheckpoint(TMC_TrajectoryBuffer *buffer)
+{
+	if(buffer->type == TMC_RAMP_TYPE_SCURVE)
+	{
+		TMC_SCurveRamp *ramp = buffer->ramp;
+		TMC_SCurveRamp *from = &buffer->checkpoint.scurve;
+
+		ramp->rampPosition             = from->rampPosition;
+		ramp->rampVelocity             = from->rampVelocity;
+		ramp->rampAcceleration         = from->rampAcceleration;
+		ramp->accumulatorAcceleration  = from->accumulatorAcceleration;
+		ramp->accumulatorVelocity      = from->accumulatorVelocity;
+		ramp->accumulatorPosition      = from->accumulatorPosition;
+		ramp->state                    = from->state;
+
+		// The position mode derives the target velocity from the ramp state
+		if(ramp->rampMode == TMC_RAMP_SCURVE_MODE_POSITION)
+			ramp->targetVelocity = from->targetVelocity;
+	}
+	else
+	{
+		TMC_LinearRamp *ramp = buffer->ramp;
+		TMC_LinearRamp *from = &buffer->checkpoint.linear;
+
+		ramp->rampPosition         = from->rampPosition;
+		ramp->rampVelocity         = from->rampVelocity;
+		ramp->accumulatorVelocity  = from->accumulatorVelocity;
+		ramp->accumulatorPosition  = from->accumulatorPosition;
+		ramp->accelerationSteps    = from->accelerationSteps;
+		ramp->state                = from->state;
+
+		if(ramp->rampMode == TMC_RAMP_LINEAR_MODE_POSITION)
+			ramp->targetVelocity = from->targetVelocity;
+	}
+}
+
+void tmc_ramp_trajectory_init(TMC_TrajectoryBuffer *buffer, void *ramp, TMC_RampType type, uint32_t lead)
+{
+	buffer->ramp       = ramp;
+	buffer->type       = type;
+	buffer->lead       = MAX(lead, 1);
+	buffer->head       = 0;
+	buffer->tail       = 0;
+	buffer->underruns  = 0;
+
+	buffer->last.position  = tmc_ramp_get_rampPosition(ramp, type);
+	buffer->last.velocity  = tmc_ramp_get_rampVelocity(ramp, type);
+
+	saveCheckpoint(buffer, 0);
+}
+
+uint32_t tmc_ramp_trajectory_fill(TMC_TrajectoryBuffer *buffer)
+{
+	uint32_t head = buffer->head;
+	uint32_t tail = buffer->tail;
+	uint32_t count = 0;
+
+	// Follow the ISR with the checkpoint. Not past the tail, in case the ISR overran it.
+	replayCheckpoint(buffer, ((int32_t) (tail - head) < 0) ? tail : head);
+
+	while((int32_t) (tail - head) < TMC_RAMP_TRAJECTORY_SIZE)
+	{
+		TMC_TrajectorySample *sample = &buffer->samples[tail & TRAJECTORY_MASK];
+
+		tmc_ramp_compute(buffer->ramp, buffer->type, 1);
+		sample->position = tmc_ramp_get_rampPosition(buffer->ramp, buffer->type);
+		sample->velocity = tmc_ramp_get_rampVelocity(buffer->ramp, buffer->type);
+
+		// Publish the sample before the index
+		TMC_MEMORY_BARRIER();
+		buffer->tail = ++tail;
+		count++;
+	}
+
+	return count;
+}
+
+void tmc_ramp_trajectory_invalidate(TMC_TrajectoryBuffer *buffer)
+{
+	uint32_t tail = buffer->tail;
+	uint32_t cut = buffer->head + buffer->lead;
+
+	// Drop the samples behind the lead. The ramp continues from the last kept one.
+	if((int32_t) (tail - cut) > 0)
+	{
+		buffer->tail = cut;
+		replayCheckpoint(buffer, cut);
+		resumeFromCheckpoint(buffer);
+		tail = cut;
+	}
+
+	// From here on the ramp runs with the new targets
+	saveCheckpoint(buffer, tail);
+}
+
+bool tmc_ramp_trajectory_pop(TMC_TrajectoryBuffer *buffer, TMC_TrajectorySample *sample)
+{
+	uint32_t head = buffer->head;
+
+	if((int32_t) (buffer->tail - head) <= 0)
+	{
+		buffer->underruns++;
+		*sample = buffer->last;
+		return false;
+	}
+
+	TMC_MEMORY_BARRIER();
+	buffer->last = buffer->samples[head & TRAJECTORY_MASK];
+	*sample = buffer->last;
+
+	TMC_MEMORY_BARRIER();
+	buffer->head = head + 1;
+
+	return true;
+}
@@ -0,0 +1,78 @@
+/*
+ * TrajectoryBuffer.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_TRAJECTORYBUFFER_H_
+#define TMC_RAMP_TRAJECTORYBUFFER_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "Ramp.h"
+
+// Trajectory buffer decoupling the ramp computation from the real-time ISR.
+// The computation time of a ramp tick depends on the ramp state (braking distance checks,
+// phase changes). A background task computes the ticks ahead into a ring buffer instead,
+// the ISR only takes one precomputed sample per tick, which costs the same every time.
+//
+// Usage:
+// - tmc_ramp_trajectory_fill() computes samples until the buffer is full. Call it from a
+//   task often enough that the buffer never runs empty.
+// - tmc_ramp_trajectory_pop() takes the sample of the current tick. Call it from the ISR.
+// - After changing a target or limit of the ramp, call tmc_ramp_trajectory_invalidate()
+//   from the same task. It discards the samples computed with the old target, except for
+//   [lead] samples the ISR may take while the task refills, and continues the ramp from
+//   the last kept sample. The ramp itself must only be changed by that task.
+// The buffer is a single producer, single consumer ring buffer: The task only writes the
+// tail, the ISR only advances the head.
+//
+// To continue the ramp exactly where the kept samples end, the buffer keeps a checkpoint
+// of the ramp at the head and replays it to the end of the kept samples. Every tick is
+// therefore computed twice by the task, the ISR time does not change.
+//
+// On an underrun the ISR keeps the last sample and counts the underrun.
+
+// Capacity of the buffer, must be a power of two
+#define TMC_RAMP_TRAJECTORY_SIZE 32
+
+typedef struct
+{
+	int32_t position; // Ramp position after the tick
+	int32_t velocity; // Ramp velocity of the tick
+} TMC_TrajectorySample;
+
+typedef struct
+{
+	void *ramp;
+	TMC_RampType type;
+	uint32_t lead; // Samples kept by an invalidation
+
+	TMC_TrajectorySample samples[TMC_RAMP_TRAJECTORY_SIZE];
+	volatile uint32_t head; // Next sample to take, advanced by the ISR
+	volatile uint32_t tail; // Next sample to compute, advanced by the task
+
+	// Ramp state at checkpointIndex, replayed by an invalidation
+	union {
+		TMC_LinearRamp linear;
+		TMC_SCurveRamp scurve;
+	} checkpoint;
+	uint32_t checkpointIndex;
+
+	// ISR side
+	TMC_TrajectorySample last;
+	volatile uint32_t underruns;
+} TMC_TrajectoryBuffer;
+
+// [ramp] of the given [type] has to be initialized and at standstill. [lead] has to cover
+// the ISR ticks between an invalidation and the following fill, at least 1.
+void tmc_ramp_trajectory_init(TMC_TrajectoryBuffer *buffer, void *ramp, TMC_RampType type, uint32_t lead);
+
+// Task side. Returns the amount of computed samples.
+uint32_t tmc_ramp_trajectory_fill(TMC_TrajectoryBuffer *buffer);
+void tmc_ramp_trajectory_invalidate(TMC_TrajectoryBuffer *buffer);
+
+// ISR side. Returns false on an underrun, [sample] holds the last sample then.
+bool tmc_ramp_trajectory_pop(TMC_TrajectoryBuffer *buffer, TMC_TrajectorySample *sample);
+
+#endif /* TMC_RAMP_TRAJECTORYBUFFER_H_ */
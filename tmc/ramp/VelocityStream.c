@@ -0,0 +1,44 @@
+/*
+ * VelocityStream.c
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+#include "VelocityStream.h"
+#include "tmc/helpers/Functions.h"
+
+void tmc_ramp_vstream_init(TMC_VelocityStream *stream, TMC_LinearRamp *ramp, uint32_t rampFrequency, uint32_t clockFrequency)
+{
+	// velocity / precision steps per tick, VACTUAL = steps/s * 2^24 / fCLK
+	uint64_t divisor = (uint64_t) tmc_ramp_linear_get_precision(ramp) * clockFrequency;
+
+	stream->ramp     = ramp;
+	stream->factor   = (divisor) ? ((((uint64_t) rampFrequency << 40) + (divisor / 2)) / divisor) : 0;
+	stream->vactual  = 0;
+}
+
+int32_t tmc_ramp_vstream_vactual(const TMC_VelocityStream *stream, int32_t velocity)
+{
+	uint64_t magnitude = (((uint64_t) abs(velocity) * stream->factor) + (1 << 15)) >> 16;
+
+	magnitude = MIN(magnitude, TMC_RAMP_VSTREAM_VACTUAL_MAX);
+
+	return (velocity < 0) ? -(int32_t) magnitude : (int32_t) magnitude;
+}
+
+bool tmc_ramp_vstream_update(TMC_VelocityStream *stream, uint32_t ticks, int32_t *vactual)
+{
+	int32_t value;
+
+	tmc_ramp_linear_compute_ticks(stream->ramp, ticks);
+	value = tmc_ramp_vstream_vactual(stream, tmc_ramp_linear_get_rampVelocity(stream->ramp));
+
+	*vactual = value;
+
+	if(value == stream->vactual)
+		return false;
+
+	stream->vactual = value;
+
+	return true;
+}
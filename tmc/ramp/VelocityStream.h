@@ -0,0 +1,47 @@
+/*
+ * VelocityStream.h
+ *
+ *  Created on: 14.10.2026
+ *      Author: LK
+ */
+
+#ifndef TMC_RAMP_VELOCITYSTREAM_H_
+#define TMC_RAMP_VELOCITYSTREAM_H_
+
+#include "tmc/helpers/API_Header.h"
+#include "LinearRamp1.h"
+
+// Velocity streaming for drivers with an internal pulse generator (VACTUAL of the
+// TMC2209, TMC2226 and TMC2300). Instead of step pulses, the velocity of a software
+// ramp is written to the driver every few ramp ticks, so no STEP pin has to be toggled.
+//
+// The ramp runs in velocity mode (or position mode, using rampPosition as the position
+// estimate) and is computed by the stream: Every update advances it by the ramp ticks
+// elapsed since the last update and converts its velocity with a factor calculated once
+// at init. VACTUAL only has to be written when the converted value changed, e.g. not
+// during constant velocity phases. The update rate is the rate of the update calls -
+// slower rates give a coarser staircase approximation of the acceleration.
+//
+// VACTUAL = 0 switches the driver back to its STEP input.
+
+// Largest magnitude of VACTUAL (24 bit signed)
+#define TMC_RAMP_VSTREAM_VACTUAL_MAX 0x7FFFFF
+
+typedef struct
+{
+	TMC_LinearRamp *ramp;
+	uint32_t factor;    // VACTUAL per ramp velocity unit, 2^16 fixed point
+	int32_t vactual;    // Last value returned by tmc_ramp_vstream_update()
+} TMC_VelocityStream;
+
+// [rampFrequency]: Ramp ticks per second. [clockFrequency]: Driver clock, 12 MHz for the
+// internal clock of the TMC2209. The ramp precision has to be set before.
+void tmc_ramp_vstream_init(TMC_VelocityStream *stream, TMC_LinearRamp *ramp, uint32_t rampFrequency, uint32_t clockFrequency);
+
+// Convert a velocity of the ramp into VACTUAL, limited to +-TMC_RAMP_VSTREAM_VACTUAL_MAX
+int32_t tmc_ramp_vstream_vactual(const TMC_VelocityStream *stream, int32_t velocity);
+
+// Advance the ramp by [ticks]. Returns true if VACTUAL changed, the new value is stored in [vactual].
+bool tmc_ramp_vstream_update(TMC_VelocityStream *stream, uint32_t ticks, int32_t *vactual);
+
+#endif /* TMC_RAMP_VELOCITYSTREAM_H_ */